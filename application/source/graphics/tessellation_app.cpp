@@ -119,6 +119,11 @@ int gfx_define_tessellation_contents(struct Parse_state *state, void *tessellati
 			refinement_factors_size = Cmiss_tessellation_get_attribute_integer(tessellation,
 				CMISS_TESSELLATION_ATTRIBUTE_REFINEMENT_FACTORS_SIZE);
 		}
+		double screen_error_tolerance = 0.0;
+		if (tessellation)
+		{
+			screen_error_tolerance = Cmiss_tessellation_get_screen_error_tolerance(tessellation);
+		}
 		int *minimum_divisions;
 		int *refinement_factors;
 		ALLOCATE(minimum_divisions, int, minimum_divisions_size);
@@ -142,18 +147,24 @@ int gfx_define_tessellation_contents(struct Parse_state *state, void *tessellati
 			"non-linear basis functions the minimum_divisions is multiplied by "
 			"the refinement_factors to give the refined number of segments. "
 			"Both minimum_divisions and refinement_factors use the last supplied "
-			"number for all higher dimensions, so \"4\" = \"4*4\" and so on.");
+			"number for all higher dimensions, so \"4\" = \"4*4\" and so on. "
+			"A positive screen_error_tolerance in pixels lets graphics use fewer "
+			"of the refinement_factors when elements are small on screen; the "
+			"default of 0 always uses full refinement.");
 		Option_table_add_divisions_entry(option_table, "minimum_divisions",
 			&minimum_divisions, &minimum_divisions_size);
 		Option_table_add_divisions_entry(option_table, "refinement_factors",
 			&refinement_factors, &refinement_factors_size);
+		Option_table_add_non_negative_double_entry(option_table, "screen_error_tolerance",
+			&screen_error_tolerance);
 		return_code = Option_table_multi_parse(option_table,state);
 		DESTROY(Option_table)(&option_table);
 		if (return_code && tessellation)
 		{
 			return_code =
 				Cmiss_tessellation_set_minimum_divisions(tessellation, minimum_divisions_size, minimum_divisions) &&
-				Cmiss_tessellation_set_refinement_factors(tessellation, refinement_factors_size, refinement_factors);
+				Cmiss_tessellation_set_refinement_factors(tessellation, refinement_factors_size, refinement_factors) &&
+				Cmiss_tessellation_set_screen_error_tolerance(tessellation, screen_error_tolerance);
 		}
 		DEALLOCATE(minimum_divisions);
 		DEALLOCATE(refinement_factors);
@@ -305,6 +305,24 @@ ZINC_API int Cmiss_mesh_destroy_elements_conditional(Cmiss_mesh_id mesh,
 ZINC_API Cmiss_element_id Cmiss_mesh_find_element_by_identifier(Cmiss_mesh_id mesh,
 	int identifier);
 
+/***************************************************************************//**
+ * Gets the identifiers of the elements in the mesh which share a face with
+ * element. Requires faces to be defined. Uses an index of face neighbours kept
+ * with the region and updated as elements change, so repeated queries are
+ * cheap. Not to be called concurrently with other queries or changes to the
+ * region.
+ *
+ * @param mesh  Handle to the mesh to query.
+ * @param element  An element in the mesh.
+ * @param size  The size of the identifiers array.
+ * @param identifiers  Array to receive the identifiers in increasing order.
+ * Only the first size identifiers are returned. Can be NULL if size is 0.
+ * @return  The number of adjacent elements, which may exceed size, or 0 if
+ * none or on failure.
+ */
+ZINC_API int Cmiss_mesh_get_adjacent_element_identifiers(Cmiss_mesh_id mesh,
+	Cmiss_element_id element, int size, int *identifiers);
+
 /***************************************************************************//**
  * Returns the differential operator giving a field derivative of the given
  * order with respect to the mesh's chart. The term identifies which of the
@@ -349,6 +367,23 @@ ZINC_API Cmiss_mesh_id Cmiss_mesh_get_master(Cmiss_mesh_id mesh);
  */
 ZINC_API char *Cmiss_mesh_get_name(Cmiss_mesh_id mesh);
 
+/***************************************************************************//**
+ * Gets the identifiers of the elements in the mesh which use node in their
+ * node list. Uses an index of the elements using each node kept with the
+ * region and updated as elements change, so repeated queries are cheap. Not
+ * to be called concurrently with other queries or changes to the region.
+ *
+ * @param mesh  Handle to the mesh to query.
+ * @param node  The node to find elements for.
+ * @param size  The size of the identifiers array.
+ * @param identifiers  Array to receive the identifiers in increasing order.
+ * Only the first size identifiers are returned. Can be NULL if size is 0.
+ * @return  The number of elements using node, which may exceed size, or 0 if
+ * none or on failure.
+ */
+ZINC_API int Cmiss_mesh_get_node_element_identifiers(Cmiss_mesh_id mesh,
+	Cmiss_node_id node, int size, int *identifiers);
+
 /***************************************************************************//**
  * Return the number of elements in the mesh.
  *
@@ -413,6 +448,47 @@ ZINC_C_INLINE Cmiss_mesh_id Cmiss_mesh_group_base_cast(
 ZINC_API int Cmiss_mesh_group_add_element(Cmiss_mesh_group_id mesh_group,
 	Cmiss_element_id element);
 
+/***************************************************************************//**
+ * Add all elements from the master mesh for which the conditional field is
+ * true i.e. non-zero valued in the element. Elements are evaluated in parallel
+ * if zinc is built with OpenMP and the mesh group's number of threads is
+ * greater than 1, each thread with its own field cache, and the group is
+ * changed with a single change notification.
+ * Results are undefined if conditional field is not constant over element.
+ * Note that group and element_group fields are valid conditional fields, and
+ * are added by merging memberships without evaluation.
+ *
+ * @param mesh_group  Handle to the mesh group to add elements to.
+ * @param conditional_field  Field which if non-zero in the element indicates it
+ * is to be added.
+ * @return  Status CMISS_OK on success, any other value on failure.
+ */
+ZINC_API int Cmiss_mesh_group_add_elements_conditional(Cmiss_mesh_group_id mesh_group,
+	Cmiss_field_id conditional_field);
+
+/***************************************************************************//**
+ * Gets the maximum number of threads used to evaluate conditional fields when
+ * adding elements to the mesh group.
+ *
+ * @param mesh_group  Handle to the mesh group.
+ * @return  Number of threads, or 0 if invalid argument.
+ */
+ZINC_API int Cmiss_mesh_group_get_number_of_threads(Cmiss_mesh_group_id mesh_group);
+
+/***************************************************************************//**
+ * Sets the maximum number of threads used to evaluate conditional fields when
+ * adding elements to the mesh group. Threads are only used with at least 256
+ * elements each. Concurrent execution requires zinc to be built with OpenMP,
+ * and conditional fields must be safe for concurrent evaluation with separate
+ * field caches.
+ *
+ * @param mesh_group  Handle to the mesh group.
+ * @param number_of_threads  Positive number of threads. Default is 1.
+ * @return  Status CMISS_OK on success, any other value on failure.
+ */
+ZINC_API int Cmiss_mesh_group_set_number_of_threads(Cmiss_mesh_group_id mesh_group,
+	int number_of_threads);
+
 /***************************************************************************//**
  * Remove all elements from mesh group.
  *
@@ -501,6 +501,23 @@ public:
 			reinterpret_cast<Cmiss_mesh_group_id>(id), element.getId());
 	}
 
+	int addElementsConditional(Field& conditionalField)
+	{
+		return Cmiss_mesh_group_add_elements_conditional(
+			reinterpret_cast<Cmiss_mesh_group_id>(id), conditionalField.getId());
+	}
+
+	int getNumberOfThreads()
+	{
+		return Cmiss_mesh_group_get_number_of_threads(reinterpret_cast<Cmiss_mesh_group_id>(id));
+	}
+
+	int setNumberOfThreads(int numberOfThreads)
+	{
+		return Cmiss_mesh_group_set_number_of_threads(
+			reinterpret_cast<Cmiss_mesh_group_id>(id), numberOfThreads);
+	}
+
 	int removeAllElements()
 	{
 		return Cmiss_mesh_group_remove_all_elements(reinterpret_cast<Cmiss_mesh_group_id>(id));
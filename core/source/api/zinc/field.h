@@ -256,6 +256,51 @@ ZINC_API Cmiss_element_id Cmiss_field_evaluate_mesh_location(Cmiss_field_id fiel
 ZINC_API int Cmiss_field_evaluate_real(Cmiss_field_id field, Cmiss_field_cache_id cache,
 	int number_of_values, double *values);
 
+/***************************************************************************//**
+ * Evaluate real field values at many chart locations in one element. More
+ * efficient than setting each location in the cache and calling
+ * Cmiss_field_evaluate_real, particularly for finite element fields and
+ * expressions built from them. Derivatives are not evaluated.
+ * Note: the cache location and time are unchanged on return.
+ *
+ * @param field  The field to evaluate.
+ * @param cache  Store of time to evaluate at and intermediate field values.
+ * @param element  The element to evaluate in. Must belong to same region as
+ * cache.
+ * @param number_of_points  The number of chart locations to evaluate at.
+ * @param chart_coordinates  Array of number_of_points * element dimension
+ * chart coordinates, with all chart coordinates for each point together.
+ * @param number_of_values  Size of values array. Checked that it equals or
+ * exceeds number_of_points * number of components of field.
+ * @param values  Array of real values to evaluate into, with all components
+ * for each point together.
+ * @return  Status CMISS_OK on success, any other value on failure including if
+ * field is not defined at any of the locations.
+ */
+ZINC_API int Cmiss_field_evaluate_real_batch(Cmiss_field_id field,
+	Cmiss_field_cache_id cache, Cmiss_element_id element, int number_of_points,
+	const double *chart_coordinates, int number_of_values, double *values);
+
+/***************************************************************************//**
+ * Evaluate real field values at many nodes. Derivatives are not evaluated.
+ * Note: the cache location and time are unchanged on return.
+ *
+ * @param field  The field to evaluate.
+ * @param cache  Store of time to evaluate at and intermediate field values.
+ * @param number_of_nodes  The number of nodes to evaluate at.
+ * @param nodes  Array of nodes to evaluate at. Must belong to same region as
+ * cache.
+ * @param number_of_values  Size of values array. Checked that it equals or
+ * exceeds number_of_nodes * number of components of field.
+ * @param values  Array of real values to evaluate into, with all components
+ * for each node together.
+ * @return  Status CMISS_OK on success, any other value on failure including if
+ * field is not defined at any of the nodes.
+ */
+ZINC_API int Cmiss_field_evaluate_real_node_batch(Cmiss_field_id field,
+	Cmiss_field_cache_id cache, int number_of_nodes, const Cmiss_node_id *nodes,
+	int number_of_values, double *values);
+
 /***************************************************************************//**
  * Evaluate field as string at location specified in cache. Numerical valued
  * fields are written to a string with comma separated components.
@@ -445,6 +490,11 @@ ZINC_API int Cmiss_field_is_defined_at_location(Cmiss_field_id field,
 /***************************************************************************//**
  * Creates a field cache for storing a known location and field values and
  * derivatives at that location. Required to evaluate and assign field values.
+ * Field caches are not thread safe, but separate threads may evaluate fields
+ * concurrently if each uses its own field cache, provided the region, its
+ * fields and their finite element definitions are not modified meanwhile.
+ * Fields maintaining internal caches e.g. find mesh location must be evaluated
+ * once in a single thread beforehand to build them.
  *
  * @param field_module  The field module to create a field cache for.
  * @return  New field cache, or NULL if failed.
@@ -540,6 +590,54 @@ ZINC_API int Cmiss_field_cache_set_node(Cmiss_field_cache_id cache, Cmiss_node_i
  */
 ZINC_API int Cmiss_field_cache_set_time(Cmiss_field_cache_id cache, double time);
 
+/***************************************************************************//**
+ * Gets the maximum number of elements for which interpolation data is kept in
+ * the cache for each finite element field. Recalculating this data on changing
+ * element is expensive, so it is retained for the most recently used elements.
+ *
+ * @param cache  The field cache to query.
+ * @return  Maximum number of elements, or 0 if invalid argument.
+ */
+ZINC_API int Cmiss_field_cache_get_element_field_values_cache_size(
+	Cmiss_field_cache_id cache);
+
+/***************************************************************************//**
+ * Sets the maximum number of elements for which interpolation data is kept in
+ * the cache for each finite element field. When full, data for the least
+ * recently used element is discarded. Larger sizes avoid recalculation when
+ * repeatedly sweeping over large meshes, at the cost of memory proportional to
+ * the number of elements, field components and element basis sizes.
+ * Default is 1000.
+ *
+ * @param cache  The field cache to modify.
+ * @param cache_size  Positive maximum number of elements.
+ * @return  Status CMISS_OK on success, any other value on failure.
+ */
+ZINC_API int Cmiss_field_cache_set_element_field_values_cache_size(
+	Cmiss_field_cache_id cache, int cache_size);
+
+/***************************************************************************//**
+ * Gets the number of times element interpolation data for finite element
+ * fields was found in the cache (hits) or had to be calculated (misses) since
+ * the field cache was created or statistics were last reset.
+ *
+ * @param cache  The field cache to query.
+ * @param hits_address  Address of int to receive number of hits.
+ * @param misses_address  Address of int to receive number of misses.
+ * @return  Status CMISS_OK on success, any other value on failure.
+ */
+ZINC_API int Cmiss_field_cache_get_element_field_values_cache_statistics(
+	Cmiss_field_cache_id cache, int *hits_address, int *misses_address);
+
+/***************************************************************************//**
+ * Resets the element field values cache hit and miss counts to zero.
+ *
+ * @param cache  The field cache to modify.
+ * @return  Status CMISS_OK on success, any other value on failure.
+ */
+ZINC_API int Cmiss_field_cache_reset_element_field_values_cache_statistics(
+	Cmiss_field_cache_id cache);
+
 /***************************************************************************//**
  * Destroys this handle to the field_iterator and sets it to NULL.
  *
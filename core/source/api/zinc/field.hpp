@@ -51,6 +51,8 @@ class Element;
 
 class FieldModule;
 
+class Node;
+
 class Field
 {
 protected:
@@ -205,6 +207,12 @@ public:
 
 	int evaluateReal(FieldCache& cache, int numberOfValues, double *outValues);
 
+	int evaluateRealBatch(FieldCache& cache, Element& element, int numberOfPoints,
+		const double *chartCoordinates, int numberOfValues, double *outValues);
+
+	int evaluateRealNodeBatch(FieldCache& cache, int numberOfNodes, Node *nodes,
+		int numberOfValues, double *outValues);
+
 	char *evaluateString(FieldCache& cache);
 
 	int evaluateDerivative(DifferentialOperator& differentialOperator,
@@ -124,6 +124,26 @@ public:
 	{
 		return Cmiss_field_cache_set_time(id, time);
 	}
+
+	int getElementFieldValuesCacheSize()
+	{
+		return Cmiss_field_cache_get_element_field_values_cache_size(id);
+	}
+
+	int setElementFieldValuesCacheSize(int cacheSize)
+	{
+		return Cmiss_field_cache_set_element_field_values_cache_size(id, cacheSize);
+	}
+
+	int getElementFieldValuesCacheStatistics(int& hits, int& misses)
+	{
+		return Cmiss_field_cache_get_element_field_values_cache_statistics(id, &hits, &misses);
+	}
+
+	int resetElementFieldValuesCacheStatistics()
+	{
+		return Cmiss_field_cache_reset_element_field_values_cache_statistics(id);
+	}
 };
 
 inline int Field::assignMeshLocation(FieldCache& cache, Element element,
@@ -156,6 +176,31 @@ inline int Field::evaluateReal(FieldCache& cache, int numberOfValues, double *ou
 	return Cmiss_field_evaluate_real(id, cache.getId(), numberOfValues, outValues);
 }
 
+inline int Field::evaluateRealBatch(FieldCache& cache, Element& element, int numberOfPoints,
+	const double *chartCoordinates, int numberOfValues, double *outValues)
+{
+	return Cmiss_field_evaluate_real_batch(id, cache.getId(), element.getId(),
+		numberOfPoints, chartCoordinates, numberOfValues, outValues);
+}
+
+inline int Field::evaluateRealNodeBatch(FieldCache& cache, int numberOfNodes, Node *nodes,
+	int numberOfValues, double *outValues)
+{
+	Cmiss_node_id *node_ids = 0;
+	if ((numberOfNodes > 0) && nodes)
+	{
+		node_ids = new Cmiss_node_id[numberOfNodes];
+		for (int i = 0; i < numberOfNodes; i++)
+		{
+			node_ids[i] = nodes[i].getId();
+		}
+	}
+	int return_code = Cmiss_field_evaluate_real_node_batch(id, cache.getId(),
+		numberOfNodes, node_ids, numberOfValues, outValues);
+	delete[] node_ids;
+	return return_code;
+}
+
 inline char *Field::evaluateString(FieldCache& cache)
 {
 	return Cmiss_field_evaluate_string(id, cache.getId());
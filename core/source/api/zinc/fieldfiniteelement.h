@@ -48,6 +48,7 @@
 #include "types/fieldfiniteelementid.h"
 #include "types/fieldmoduleid.h"
 #include "types/nodeid.h"
+#include "types/timekeeperid.h"
 
 #include "zinc/zincsharedobject.h"
 
@@ -105,6 +106,54 @@ ZINC_C_INLINE Cmiss_field_id Cmiss_field_finite_element_base_cast(
 ZINC_API int Cmiss_field_finite_element_destroy(
 	Cmiss_field_finite_element_id *finite_element_field_address);
 
+/***************************************************************************//**
+ * Sets the nodal values of the finite_element field from a time series file,
+ * interpolated for the current time of the time keeper and updated whenever
+ * its time changes. The file is memory mapped and only a window of time steps
+ * around the current time is kept in memory, so time series much larger than
+ * memory can be animated. The field must be defined without time at every
+ * node in the file, with the same number of values as were written.
+ *
+ * WARNING: the time series overwrites the stored node values; it does not
+ * make the field time-varying. This has the following limitations:
+ * - Evaluating the field with a field cache whose time differs from the
+ *   time keeper's current time gives values for the time keeper's time, not
+ *   the cache's time. The same applies to fields depending on it.
+ * - Every change of the time keeper's time is a change to the field at all
+ *   nodes in the region: every field, graphic and other client depending on
+ *   it is notified and graphics using it are rebuilt.
+ * - Graphics using the field are not kept in the rendition time cache, and
+ *   filling the cache for other times gives graphics for the current time.
+ * - Only one time keeper drives a field. Setting a time series for the field
+ *   again replaces the previous one, and the field cannot show different
+ *   times in scenes driven by different time keepers.
+ * Use a time-varying field without a time series where these matter.
+ *
+ * @param finite_element_field  The finite_element field to set values of.
+ * @param time_keeper  The time keeper supplying the current time.
+ * @param file_name  Name of a file written by
+ * Cmiss_field_finite_element_write_time_series, or NULL to stop using any
+ * time series for the field.
+ * @param window_size  Number of time steps kept in memory, at least 2.
+ * @return  Status CMISS_OK on success, any other value on failure.
+ */
+ZINC_API int Cmiss_field_finite_element_set_time_series(
+	Cmiss_field_finite_element_id finite_element_field,
+	Cmiss_time_keeper_id time_keeper, const char *file_name, int window_size);
+
+/***************************************************************************//**
+ * Writes the values of the time-varying finite_element field at all nodes it
+ * is defined on to a time series file for use with
+ * Cmiss_field_finite_element_set_time_series. All nodes must have the field
+ * defined with the same times and number of values.
+ *
+ * @param finite_element_field  The time-varying finite_element field.
+ * @param file_name  Name of the file to write.
+ * @return  Status CMISS_OK on success, any other value on failure.
+ */
+ZINC_API int Cmiss_field_finite_element_write_time_series(
+	Cmiss_field_finite_element_id finite_element_field, const char *file_name);
+
 /***************************************************************************//**
  * Creates a field returning a value of a source field at an embedded location.
  * The new field has the same value type as the source field.
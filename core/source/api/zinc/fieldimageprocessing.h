@@ -44,6 +44,8 @@ Implements cmiss fields which deal with image processing
 #if !defined (CMISS_FIELD_IMAGE_PROCESSING_H)
 #define CMISS_FIELD_IMAGE_PROCESSING_H
 
+#include <stddef.h>
+
 #include "types/fieldid.h"
 #include "types/fieldimageprocessingid.h"
 #include "types/fieldmoduleid.h"
@@ -417,6 +419,78 @@ ZINC_API Cmiss_field_id Cmiss_field_module_create_threshold_image_filter(
 */
 ZINC_API Cmiss_field_threshold_image_filter_id Cmiss_field_cast_threshold_image_filter(Cmiss_field_id field);
 
+/***************************************************************************//**
+ * Gets the maximum number of threads used to evaluate the source field into
+ * the input image of an image filter field.
+ *
+ * @param field  Any image filter field.
+ * @return  Number of threads, or 0 if invalid argument.
+ */
+ZINC_API int Cmiss_field_image_filter_get_number_of_threads(Cmiss_field_id field);
+
+/***************************************************************************//**
+ * Sets the maximum number of threads used to evaluate the source field into
+ * the input image of an image filter field. If greater than 1 the image is
+ * split into slabs which are evaluated concurrently, each with its own field
+ * cache. Concurrent execution requires zinc to be built with OpenMP, and
+ * source fields must be safe for concurrent evaluation with separate field
+ * caches. Not needed when the source field is itself an image filter whose
+ * output image is used directly.
+ *
+ * @param field  Any image filter field.
+ * @param number_of_threads  Positive number of threads. Default is 1.
+ * @return  Status CMISS_OK on success, any other value on failure.
+ */
+ZINC_API int Cmiss_field_image_filter_set_number_of_threads(Cmiss_field_id field,
+	int number_of_threads);
+
+/***************************************************************************//**
+ * Gets counters from the most recent update of an image filter field. The
+ * number of pixels evaluated is updated as evaluation proceeds so it may be
+ * polled from another thread to report progress. Pixel counts are size_t as
+ * large 3-D images can exceed the range of int.
+ *
+ * @param field  Any image filter field.
+ * @param number_of_pixels_address  Optional address to return the number of
+ * pixels in the input image, or 0 if the upstream filter output was reused.
+ * @param pixels_evaluated_address  Optional address to return the number of
+ * input image pixels evaluated so far.
+ * @param evaluation_seconds_address  Optional address to return the time
+ * taken to evaluate the input image.
+ * @param filter_seconds_address  Optional address to return the time taken
+ * to update the filter from its input image.
+ * @return  Status CMISS_OK on success, any other value on failure.
+ */
+ZINC_API int Cmiss_field_image_filter_get_statistics(Cmiss_field_id field,
+	size_t *number_of_pixels_address, size_t *pixels_evaluated_address,
+	double *evaluation_seconds_address, double *filter_seconds_address);
+
+/***************************************************************************//**
+ * Gets the memory budget for streaming evaluation of an image filter field.
+ *
+ * @param field  Any image filter field.
+ * @return  Memory budget in bytes, or 0 if not streaming or invalid argument.
+ */
+ZINC_API double Cmiss_field_image_filter_get_memory_budget(Cmiss_field_id field);
+
+/***************************************************************************//**
+ * Sets a memory budget for evaluating an image filter field on images too
+ * large to hold in memory. If positive, the filter is updated only for the
+ * slab of whole slices in the last image dimension containing each pixel
+ * requested, sized so input and output regions fit the budget, and the source
+ * field is evaluated only over the input region the filter needs. Recently
+ * filtered slabs are kept up to half the budget. Filters needing the whole
+ * input image, e.g. fast marching or rescale intensity, still evaluate it all.
+ * Any filtered image held is discarded when the budget changes.
+ *
+ * @param field  Any image filter field.
+ * @param memory_budget  Memory budget in bytes, or 0 to filter the whole
+ * image at once. Default is 0.
+ * @return  Status CMISS_OK on success, any other value on failure.
+ */
+ZINC_API int Cmiss_field_image_filter_set_memory_budget(Cmiss_field_id field,
+	double memory_budget);
+
 #ifdef __cplusplus
 }
 #endif
@@ -114,6 +114,32 @@ ZINC_API Cmiss_field_id Cmiss_field_module_create_nodeset_mean_squares(
 	Cmiss_field_module_id field_module, Cmiss_field_id source_field,
 	Cmiss_nodeset_id nodeset);
 
+/*******************************************************************************
+ * Gets the maximum number of threads used to evaluate the source field at
+ * nodes whose cached values are out of date, for any nodeset operator field.
+ *
+ * @param field  Nodeset sum, mean, sum_squares or mean_squares field.
+ * @return  Number of threads, or 0 if invalid argument.
+ */
+ZINC_API int Cmiss_field_nodeset_operator_get_number_of_threads(Cmiss_field_id field);
+
+/*******************************************************************************
+ * Sets the maximum number of threads used to evaluate the source field at
+ * nodes whose cached values are out of date, for any nodeset operator field.
+ * If greater than 1 the nodes are split into contiguous chunks which are
+ * evaluated concurrently, each with its own field cache. This mainly speeds up
+ * the first evaluation and evaluation after the source field is modified, as
+ * values at nodes are otherwise re-evaluated only when they change.
+ * Concurrent execution requires zinc to be built with OpenMP, and the source
+ * field must be safe for concurrent evaluation with separate field caches.
+ *
+ * @param field  Nodeset sum, mean, sum_squares or mean_squares field.
+ * @param number_of_threads  Positive number of threads. Default is 1.
+ * @return  Status CMISS_OK on success, any other value on failure.
+ */
+ZINC_API int Cmiss_field_nodeset_operator_set_number_of_threads(Cmiss_field_id field,
+	int number_of_threads);
+
 #ifdef __cplusplus
 }
 #endif
@@ -181,6 +181,58 @@ ZINC_API int Cmiss_graphic_set_visibility_flag(Cmiss_graphic_id graphic,
 
 ZINC_API int Cmiss_graphic_set_glyph_type(Cmiss_graphic_id graphic, enum Cmiss_graphic_glyph_type glyph_type);
 
+/***************************************************************************//**
+ * Gets the number of threads used to generate per-element graphics.
+ *
+ * @param graphic  The graphic to query.
+ * @return  Number of threads, or 0 if invalid argument.
+ */
+ZINC_API int Cmiss_graphic_get_number_of_threads(Cmiss_graphic_id graphic);
+
+/***************************************************************************//**
+ * Sets the maximum number of threads used to generate graphics for elements.
+ * If greater than 1, the mesh is partitioned into this many chunks which are
+ * converted to graphics concurrently, each with its own field cache, then
+ * merged in element order so results are identical to serial generation.
+ * Applies to surfaces, cylinders, element points and iso-lines graphics when
+ * fully rebuilt; other graphic types are always generated serially.
+ * Concurrent execution requires zinc to be built with OpenMP.
+ * Note that fields used by the graphic must be safe for concurrent evaluation
+ * with separate field caches: see Cmiss_field_module_create_cache.
+ *
+ * @param graphic  The graphic to modify.
+ * @param number_of_threads  Positive number of threads. Default is 1.
+ * @return  Status CMISS_OK on success, any other value on failure.
+ */
+ZINC_API int Cmiss_graphic_set_number_of_threads(Cmiss_graphic_id graphic,
+	int number_of_threads);
+
+/***************************************************************************//**
+ * Gets whether surfaces graphics share vertices across element boundaries.
+ *
+ * @param graphic  The graphic to query.
+ * @return  1 if vertices are shared, 0 if not or invalid argument.
+ */
+ZINC_API int Cmiss_graphic_get_shared_vertices_flag(Cmiss_graphic_id graphic);
+
+/***************************************************************************//**
+ * Sets whether surfaces graphics are generated as a single indexed triangle
+ * mesh with vertices shared across element boundaries. Shared vertices are
+ * evaluated once, so generation is faster and uses less memory, and smooth
+ * shading is continuous across element boundaries. Vertices are only shared
+ * across line faces which are defined and have the same discretization on
+ * both sides; fields must be continuous across element boundaries for the
+ * result to match per-element surfaces. Only applies to surfaces graphics,
+ * which are then always generated serially.
+ *
+ * @param graphic  The graphic to modify.
+ * @param shared_vertices_flag  Non-zero to share vertices, 0 for separate
+ * surfaces per element (the default).
+ * @return  Status CMISS_OK on success, any other value on failure.
+ */
+ZINC_API int Cmiss_graphic_set_shared_vertices_flag(Cmiss_graphic_id graphic,
+	int shared_vertices_flag);
+
 /***************************************************************************//**
  * Specifying the coordinate system in which to render the coordinates of graphics.
  *
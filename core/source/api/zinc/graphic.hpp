@@ -183,6 +183,26 @@ public:
 		return Cmiss_graphic_set_visibility_flag(id, (int)visibilityFlag);
 	}
 
+	int getNumberOfThreads()
+	{
+		return Cmiss_graphic_get_number_of_threads(id);
+	}
+
+	int setNumberOfThreads(int numberOfThreads)
+	{
+		return Cmiss_graphic_set_number_of_threads(id, numberOfThreads);
+	}
+
+	bool getSharedVerticesFlag()
+	{
+		return (0 != Cmiss_graphic_get_shared_vertices_flag(id));
+	}
+
+	int setSharedVerticesFlag(bool sharedVerticesFlag)
+	{
+		return Cmiss_graphic_set_shared_vertices_flag(id, (int)sharedVerticesFlag);
+	}
+
 	enum CoordinateSystem getCoordinateSystem()
 	{
 		return static_cast<CoordinateSystem>(Cmiss_graphic_get_coordinate_system(id));
@@ -289,6 +289,47 @@ ZINC_C_INLINE Cmiss_nodeset_id Cmiss_nodeset_group_base_cast(
 ZINC_API int Cmiss_nodeset_group_add_node(Cmiss_nodeset_group_id nodeset_group,
 	Cmiss_node_id node);
 
+/***************************************************************************//**
+ * Add all nodes from the master nodeset for which the conditional field is
+ * true i.e. non-zero valued at the node. Nodes are evaluated in batches, and
+ * in parallel if zinc is built with OpenMP and the nodeset group's number of
+ * threads is greater than 1, each thread with its own field cache, and the
+ * group is changed with a single change notification.
+ * Note that group and node_group fields are valid conditional fields, and are
+ * added by merging memberships without evaluation.
+ *
+ * @param nodeset_group  Handle to the nodeset group to add nodes to.
+ * @param conditional_field  Field which if non-zero at the node indicates it
+ * is to be added.
+ * @return  Status CMISS_OK on success, any other value on failure.
+ */
+ZINC_API int Cmiss_nodeset_group_add_nodes_conditional(
+	Cmiss_nodeset_group_id nodeset_group, Cmiss_field_id conditional_field);
+
+/***************************************************************************//**
+ * Gets the maximum number of threads used to evaluate conditional fields when
+ * adding nodes to the nodeset group.
+ *
+ * @param nodeset_group  Handle to the nodeset group.
+ * @return  Number of threads, or 0 if invalid argument.
+ */
+ZINC_API int Cmiss_nodeset_group_get_number_of_threads(
+	Cmiss_nodeset_group_id nodeset_group);
+
+/***************************************************************************//**
+ * Sets the maximum number of threads used to evaluate conditional fields when
+ * adding nodes to the nodeset group. Threads are only used with at least 256
+ * nodes each. Concurrent execution requires zinc to be built with OpenMP, and
+ * conditional fields must be safe for concurrent evaluation with separate
+ * field caches.
+ *
+ * @param nodeset_group  Handle to the nodeset group.
+ * @param number_of_threads  Positive number of threads. Default is 1.
+ * @return  Status CMISS_OK on success, any other value on failure.
+ */
+ZINC_API int Cmiss_nodeset_group_set_number_of_threads(
+	Cmiss_nodeset_group_id nodeset_group, int number_of_threads);
+
 /***************************************************************************//**
  * Remove all nodes from nodeset group.
  *
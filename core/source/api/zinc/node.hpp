@@ -383,6 +383,23 @@ public:
 			reinterpret_cast<Cmiss_nodeset_group_id>(id), node.getId());
 	}
 
+	int addNodesConditional(Field& conditionalField)
+	{
+		return Cmiss_nodeset_group_add_nodes_conditional(
+			reinterpret_cast<Cmiss_nodeset_group_id>(id), conditionalField.getId());
+	}
+
+	int getNumberOfThreads()
+	{
+		return Cmiss_nodeset_group_get_number_of_threads(reinterpret_cast<Cmiss_nodeset_group_id>(id));
+	}
+
+	int setNumberOfThreads(int numberOfThreads)
+	{
+		return Cmiss_nodeset_group_set_number_of_threads(
+			reinterpret_cast<Cmiss_nodeset_group_id>(id), numberOfThreads);
+	}
+
 	int removeAllNodes()
 	{
 		return Cmiss_nodeset_group_remove_all_nodes(
@@ -364,10 +364,20 @@ ZINC_API int Cmiss_region_write(Cmiss_region_id region,
  */
 ZINC_API int Cmiss_region_write_file(Cmiss_region_id region, const char *file_name);
 
+/***************************************************************************//**
+ * Attributes of region stream information and its resources.
+ * TIME: real time at which node values are read or written.
+ * BINARY: if set to a non-zero value, Cmiss_region_write writes EX files with
+ * node values, element nodes and scale factors as native binary blocks, which
+ * are much faster to read and write. Text headers are unchanged. Binary files
+ * are recognised automatically by Cmiss_region_read so this attribute is only
+ * used for writing.
+ */
 enum Cmiss_stream_information_region_attribute
 {
 	CMISS_STREAM_INFORMATION_REGION_ATTRIBUTE_INVALID = 0,
-	CMISS_STREAM_INFORMATION_REGION_ATTRIBUTE_TIME = 1
+	CMISS_STREAM_INFORMATION_REGION_ATTRIBUTE_TIME = 1,
+	CMISS_STREAM_INFORMATION_REGION_ATTRIBUTE_BINARY = 2
 };
 
 /***************************************************************************//**
@@ -233,6 +233,7 @@ public:
 	{
 		REGION_ATTRIBUTE_INVALID = CMISS_STREAM_INFORMATION_REGION_ATTRIBUTE_INVALID ,
 		REGION_ATTRIBUTE_TIME = CMISS_STREAM_INFORMATION_REGION_ATTRIBUTE_TIME,
+		REGION_ATTRIBUTE_BINARY = CMISS_STREAM_INFORMATION_REGION_ATTRIBUTE_BINARY,
 	};
 
 	int hasRegionAttribute(RegionAttribute attribute)
@@ -49,6 +49,7 @@ The public interface to the Cmiss_rendition.
 #include "types/graphicid.h"
 #include "types/regionid.h"
 #include "types/renditionid.h"
+#include "types/sceneid.h"
 #include "types/selectionid.h"
 
 #include "zinc/zincsharedobject.h"
@@ -57,6 +58,16 @@ The public interface to the Cmiss_rendition.
 extern "C" {
 #endif
 
+/***************************************************************************//**
+ * Function called when deferred rebuilds of a rendition's graphics complete.
+ *
+ * @param rendition  Handle to the rendition whose graphics are up to date.
+ * @param user_data  User data passed with the callback.
+ * @return  1 on success, 0 on failure.
+ */
+typedef int (*Cmiss_rendition_rebuild_callback)(Cmiss_rendition_id rendition,
+	void *user_data);
+
 /*******************************************************************************
  * Returns a new reference to the rendition with reference count incremented.
  * Caller is responsible for destroying the new reference.
@@ -227,6 +238,94 @@ ZINC_API int Cmiss_rendition_get_visibility_flag(Cmiss_rendition_id rendition);
 ZINC_API int Cmiss_rendition_set_visibility_flag(Cmiss_rendition_id rendition,
 	int visibility_flag);
 
+/***************************************************************************//**
+ * Sets the memory the rendition may use to keep graphics built for other
+ * times. When set, time-dependent graphics built during playback are kept and
+ * reused when the time returns to them, so repeated loops over an animation
+ * need not regenerate graphics. Cached graphics are discarded when fields or
+ * other attributes they depend on change, and those farthest from the current
+ * time are discarded when the limit is exceeded. Fields whose nodal values are
+ * set from a time series file change at every time, so graphics using them
+ * are never cached.
+ *
+ * @param rendition  The handle to the rendition.
+ * @param memory_limit_megabytes  Approximate memory limit for cached graphics
+ * in megabytes, or 0 to stop caching and release cached graphics.
+ * @return  Status CMISS_OK on success, CMISS_ERROR_ARGUMENT if invalid
+ * argument.
+ */
+ZINC_API int Cmiss_rendition_set_time_cache_memory_limit(
+	Cmiss_rendition_id rendition, int memory_limit_megabytes);
+
+/***************************************************************************//**
+ * Builds and caches the time-dependent graphics of the rendition at evenly
+ * spaced times ahead of playback, within the time cache memory limit, then
+ * restores the graphics for the current time. Times should match those the
+ * time keeper plays through for the cached graphics to be reused.
+ * Without a rebuild time limit this blocks until graphics for all times are
+ * built, which for large models can take a long time.
+ * With a rebuild time limit (see Cmiss_rendition_set_rebuild_time_limit) it
+ * returns immediately, and the times are built a few per build of the scene
+ * once graphics for the current time are complete. Builds stop starting new
+ * times at the limit, but a build with nothing else to do builds at least
+ * one. Each time is built whole, and builds happen only while the scene is
+ * drawn. Calling this again replaces
+ * a fill in progress, and the rebuild callback is called when it finishes.
+ *
+ * @param rendition  The handle to the rendition.
+ * @param scene  Scene whose filter selects the graphics to build.
+ * @param minimum_time  First time to build graphics at.
+ * @param maximum_time  Last time to build graphics at.
+ * @param number_of_times  Number of times to build graphics at, at least 1.
+ * @return  Status CMISS_OK on success, CMISS_ERROR_ARGUMENT if invalid
+ * argument or the time cache memory limit is not set, CMISS_ERROR_GENERAL if
+ * graphics could not be built.
+ */
+ZINC_API int Cmiss_rendition_fill_time_cache(Cmiss_rendition_id rendition,
+	Cmiss_scene_id scene, double minimum_time, double maximum_time,
+	int number_of_times);
+
+/***************************************************************************//**
+ * Sets how long each build of the rendition's graphics may spend on graphics
+ * needing a full rebuild. Once the limit is reached, graphics not yet rebuilt
+ * keep drawing their previous graphics and are rebuilt in following builds,
+ * with clients of the rendition informed of the change so they redraw.
+ * Graphics of lines, cylinders, element points, contour lines and surfaces
+ * other than with shared vertices are built in batches of elements, so the
+ * limit can also stop one of these part way, to continue from the next
+ * element in the following build. Each graphic swaps in its new graphics when
+ * they are complete. This keeps editing of large models responsive, at the
+ * cost of graphics lagging the model by a few builds.
+ * Note the work is only split across builds, not done in the background:
+ * each build runs on the calling thread and the limit is only checked between
+ * graphics and batches of elements, so a build may overrun it by the time to
+ * build one of these. Graphics of other types, such as node points,
+ * streamlines and iso-surfaces, are always built whole.
+ *
+ * @param rendition  The handle to the rendition.
+ * @param time_limit  Time limit in seconds, or 0 to rebuild all graphics in
+ * each build as by default.
+ * @return  Status CMISS_OK on success, CMISS_ERROR_ARGUMENT if invalid
+ * argument.
+ */
+ZINC_API int Cmiss_rendition_set_rebuild_time_limit(Cmiss_rendition_id rendition,
+	double time_limit);
+
+/***************************************************************************//**
+ * Sets a function called at the end of a build which leaves no rebuilds of
+ * the rendition's graphics deferred, after any were deferred or, with a
+ * rebuild time limit, any graphics were rebuilt. The function is called while
+ * the scene is being built so must not modify the rendition's graphics.
+ *
+ * @param rendition  The handle to the rendition.
+ * @param function  Function to call, or NULL to clear.
+ * @param user_data  User data to pass to the function.
+ * @return  Status CMISS_OK on success, CMISS_ERROR_ARGUMENT if invalid
+ * argument.
+ */
+ZINC_API int Cmiss_rendition_set_rebuild_callback(Cmiss_rendition_id rendition,
+	Cmiss_rendition_rebuild_callback function, void *user_data);
+
 /***************************************************************************//**
  * Move an existing graphic in rendition before ref_graphic. Both <graphic> and
  * <ref_graphic> must be from the same region.
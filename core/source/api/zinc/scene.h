@@ -178,6 +178,39 @@ ZINC_API Cmiss_graphics_filter_id Cmiss_scene_get_filter(Cmiss_scene_id scene);
  */
 ZINC_API int Cmiss_scene_set_filter(Cmiss_scene_id scene, Cmiss_graphics_filter_id filter);
 
+/***************************************************************************//**
+ * File formats for writing the triangles of a scene.
+ */
+enum Cmiss_scene_triangle_mesh_format
+{
+	CMISS_SCENE_TRIANGLE_MESH_FORMAT_INVALID = 0,
+	CMISS_SCENE_TRIANGLE_MESH_FORMAT_STL_ASCII = 1,
+	/*!< ASCII STL, one facet per triangle */
+	CMISS_SCENE_TRIANGLE_MESH_FORMAT_STL_BINARY = 2,
+	/*!< little endian binary STL */
+	CMISS_SCENE_TRIANGLE_MESH_FORMAT_OBJ = 3,
+	/*!< Wavefront OBJ with shared vertices, geometry only */
+	CMISS_SCENE_TRIANGLE_MESH_FORMAT_PLY_BINARY = 4
+	/*!< little endian binary PLY with shared vertices */
+};
+
+/***************************************************************************//**
+ * Writes the triangles of the visible surfaces, iso-surfaces and glyphs in the
+ * scene to a file, building any graphics not yet generated.
+ *
+ * @param scene  The scene to write.
+ * @param file_name  The name of the file to write to.
+ * @param format  The format of the file to write.
+ * @param merge_tolerance  For OBJ and PLY formats, vertices within this
+ * distance of each other are merged. 0.0 merges only identical vertices.
+ * Ignored for STL formats. Must be non-negative.
+ * @return  Status CMISS_OK on success, CMISS_ERROR_ARGUMENT for invalid
+ * arguments, or CMISS_ERROR_GENERAL if the file could not be written.
+ */
+ZINC_API int Cmiss_scene_write_triangle_mesh_file(Cmiss_scene_id scene,
+	const char *file_name, enum Cmiss_scene_triangle_mesh_format format,
+	double merge_tolerance);
+
 #ifdef __cplusplus
 }
 #endif
@@ -137,6 +137,22 @@ public:
 		return Cmiss_scene_set_filter(id, filter.getId());
 	}
 
+	enum TriangleMeshFormat
+	{
+		TRIANGLE_MESH_FORMAT_INVALID = CMISS_SCENE_TRIANGLE_MESH_FORMAT_INVALID,
+		TRIANGLE_MESH_FORMAT_STL_ASCII = CMISS_SCENE_TRIANGLE_MESH_FORMAT_STL_ASCII,
+		TRIANGLE_MESH_FORMAT_STL_BINARY = CMISS_SCENE_TRIANGLE_MESH_FORMAT_STL_BINARY,
+		TRIANGLE_MESH_FORMAT_OBJ = CMISS_SCENE_TRIANGLE_MESH_FORMAT_OBJ,
+		TRIANGLE_MESH_FORMAT_PLY_BINARY = CMISS_SCENE_TRIANGLE_MESH_FORMAT_PLY_BINARY
+	};
+
+	int writeTriangleMeshFile(const char *fileName, TriangleMeshFormat format,
+		double mergeTolerance)
+	{
+		return Cmiss_scene_write_triangle_mesh_file(id, fileName,
+			static_cast<Cmiss_scene_triangle_mesh_format>(format), mergeTolerance);
+	}
+
 };
 
 }  // namespace zinc
@@ -770,6 +770,20 @@ If <force_onscreen> is non zero then the pixels will always be grabbed from the
 scene viewer on screen.
 ==============================================================================*/
 
+/***************************************************************************//**
+ * Updates the level of detail of graphics with a screen error tolerance set on
+ * their tessellation to suit the view of this scene viewer as last rendered.
+ * Element surfaces and cylinders whose projected size has changed are
+ * regenerated at the new level on the next redraw; unchanged elements are
+ * kept. Call after changing the view, typically from a transform callback.
+ * @see Cmiss_tessellation_set_screen_error_tolerance
+ *
+ * @param scene_viewer  The scene viewer whose view and size are used.
+ * @return  Status CMISS_OK on success, any other value on failure.
+ */
+ZINC_API int Cmiss_scene_viewer_update_level_of_detail(
+	Cmiss_scene_viewer_id scene_viewer);
+
 ZINC_API int Cmiss_scene_viewer_add_transform_callback(
 	Cmiss_scene_viewer_id scene_viewer,
 	Cmiss_scene_viewer_callback function,void *user_data);
@@ -1013,6 +1027,25 @@ ZINC_API Cmiss_scene_viewer_id Cmiss_scene_viewer_create(
 	enum Cmiss_scene_viewer_buffering_mode buffer_mode,
 	enum Cmiss_scene_viewer_stereo_mode stereo_mode);
 
+/***************************************************************************//**
+ * Creates a scene viewer which renders without a window or windowing system
+ * into its own in-memory buffer, for batch image generation. Retrieve frames
+ * with Cmiss_scene_viewer_get_frame_pixels, whose non-zero width and height
+ * resize the buffer. Each offscreen scene viewer has its own graphics context,
+ * sharing compiled graphics with other offscreen scene viewers from the same
+ * package, so frames from different scene viewers may be rendered on separate
+ * threads once their graphics are up to date.
+ * Requires zinc to be built with USE_OSMESA; returns NULL otherwise.
+ *
+ * @param cmiss_scene_viewer_package  The package the scene viewer belongs to.
+ * @param width  Initial width of the buffer in pixels, greater than zero.
+ * @param height  Initial height of the buffer in pixels, greater than zero.
+ * @return  Handle to the new scene viewer, or NULL on failure.
+ */
+ZINC_API Cmiss_scene_viewer_id Cmiss_scene_viewer_create_offscreen(
+	Cmiss_scene_viewer_package_id cmiss_scene_viewer_package,
+	int width, int height);
+
 ZINC_API Cmiss_scene_viewer_package_id Cmiss_scene_viewer_package_access(Cmiss_scene_viewer_package_id scene_viewer_package);
 ZINC_API int Cmiss_scene_viewer_package_destroy(Cmiss_scene_viewer_package_id *scene_viewer_package_address);
 
@@ -57,11 +57,14 @@ extern "C" {
  * to bring the CMGUI Zinc API in to line with common C API conventions.
  * To maintain your source compatibility through this break please ensure
  * all code checking integer status codes returned by functions compare
- * against enum CMISS_OK, NOT its current literal value
+ * against enum CMISS_OK, NOT its current literal value.
+ * Some newer functions already return the negative-valued error codes below.
  *
  */
 enum Cmiss_status
 {
+	CMISS_ERROR_GENERAL = -2, /*!< unspecified error occurred */
+	CMISS_ERROR_ARGUMENT = -1, /*!< invalid argument(s) passed to API function */
 	CMISS_OK = 1 /*!< value to be returned on success */
 };
 
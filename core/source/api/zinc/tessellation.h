@@ -223,6 +223,36 @@ ZINC_API int Cmiss_tessellation_get_refinement_factors(Cmiss_tessellation_id tes
 ZINC_API int Cmiss_tessellation_set_refinement_factors(Cmiss_tessellation_id tessellation,
 	int size, const int *refinement_factors);
 
+/***************************************************************************//**
+ * Gets the screen error tolerance for adaptive level of detail tessellation.
+ *
+ * @see Cmiss_tessellation_set_screen_error_tolerance
+ * @param tessellation  The tessellation object to query.
+ * @return  The screen error tolerance in pixels, 0 if not adaptive or invalid
+ * tessellation.
+ */
+ZINC_API double Cmiss_tessellation_get_screen_error_tolerance(
+	Cmiss_tessellation_id tessellation);
+
+/***************************************************************************//**
+ * Sets the screen error tolerance in pixels for adaptive level of detail
+ * tessellation. When positive, lines, surfaces and cylinders using this
+ * tessellation in a scene with a level of detail viewer set choose their
+ * divisions per element, between the minimum divisions and the minimum
+ * divisions times the refinement factors, so that the deviation of the
+ * tessellated curves from the element, projected on screen, is within the
+ * tolerance. Small, distant or flat elements then use fewer divisions.
+ * Levels of detail are powers of 2 times the minimum divisions.
+ * The default tolerance of 0 always uses full refinement.
+ *
+ * @see Cmiss_scene_viewer_update_level_of_detail
+ * @param tessellation  The tessellation object to modify.
+ * @param screen_error_tolerance  The tolerance in pixels, >= 0.
+ * @return  Status CMISS_OK on success, any other value on failure.
+ */
+ZINC_API int Cmiss_tessellation_set_screen_error_tolerance(
+	Cmiss_tessellation_id tessellation, double screen_error_tolerance);
+
 #ifdef __cplusplus
 }
 #endif
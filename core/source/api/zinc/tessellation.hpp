@@ -142,6 +142,16 @@ public:
 		return Cmiss_tessellation_set_refinement_factors(id, size, refinementFactors);
 	}
 
+	double getScreenErrorTolerance()
+	{
+		return Cmiss_tessellation_get_screen_error_tolerance(id);
+	}
+
+	int setScreenErrorTolerance(double screenErrorTolerance)
+	{
+		return Cmiss_tessellation_set_screen_error_tolerance(id, screenErrorTolerance);
+	}
+
 };
 
 }  // namespace zinc
@@ -0,0 +1,869 @@
+/***************************************************************************//**
+ * FILE : zinc_benchmarks.cpp
+ *
+ * Benchmark driver timing the core field evaluation, I/O and graphics
+ * generation paths on synthetic block meshes. Results are written to stdout as
+ * one JSON object per line so runs can be compared by scripts.
+ */
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is cmgui.
+ *
+ * The Initial Developer of the Original Code is
+ * Auckland Uniservices Ltd, Auckland, New Zealand.
+ * Portions created by the Initial Developer are Copyright (C) 2012
+ * the Initial Developer. All Rights Reserved.
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "zinc/context.h"
+#include "zinc/core.h"
+#include "zinc/element.h"
+#include "zinc/field.h"
+#include "zinc/fieldarithmeticoperators.h"
+#include "zinc/fieldconstant.h"
+#include "zinc/fieldfiniteelement.h"
+#include "zinc/fieldimage.h"
+#include "zinc/fieldimageprocessing.h"
+#include "zinc/fieldmodule.h"
+#include "zinc/fieldnodesetoperators.h"
+#include "zinc/fieldvectoroperators.h"
+#include "zinc/graphic.h"
+#include "zinc/graphicsmodule.h"
+#include "zinc/node.h"
+#include "zinc/region.h"
+#include "zinc/rendition.h"
+#include "zinc/scene.h"
+#include "zinc/status.h"
+#include "zinc/stream.h"
+#include "general/time.h"
+#include "graphics/graphic.h"
+#include "graphics/graphics_object.h"
+#include "graphics/rendition.h"
+#if defined (UNIX)
+#include <sys/resource.h>
+#endif /* defined (UNIX) */
+
+namespace {
+
+/** Settings from the command line */
+struct Benchmark_options
+{
+	int elements_count; // number of elements in each xi direction of the block
+	int points_count; // number of evaluation points in each xi direction per element
+	int data_points_count; // number of points located with find_mesh_location
+	int repeats; // each benchmark is run this many times and the fastest reported
+	int number_of_threads; // passed to Cmiss_graphic_set_number_of_threads
+};
+
+/** A synthetic block mesh and handles used by the benchmarks */
+struct Benchmark_mesh
+{
+	const char *name;
+	Cmiss_region_id region;
+	Cmiss_field_module_id field_module;
+	Cmiss_field_id coordinates;
+	Cmiss_mesh_id mesh;
+	Cmiss_nodeset_id nodeset;
+	int number_of_elements;
+	int number_of_nodes;
+};
+
+double get_wall_time()
+{
+	struct timeval time_value;
+	gettimeofday(&time_value, NULL);
+	return (double)time_value.tv_sec + 1.0E-6*(double)time_value.tv_usec;
+}
+
+/** @return  Peak resident memory of the process in kilobytes, or -1 if not
+ * available on this platform. */
+long get_peak_memory_kb()
+{
+#if defined (UNIX)
+	struct rusage usage;
+	if (0 == getrusage(RUSAGE_SELF, &usage))
+	{
+#if defined (DARWIN)
+		return (long)(usage.ru_maxrss / 1024);
+#else /* defined (DARWIN) */
+		return (long)usage.ru_maxrss;
+#endif /* defined (DARWIN) */
+	}
+#endif /* defined (UNIX) */
+	return -1;
+}
+
+void report(const char *benchmark_name, const Benchmark_mesh &benchmark_mesh,
+	int number_of_operations, double seconds)
+{
+	printf("{\"benchmark\":\"%s\",\"mesh\":\"%s\",\"elements\":%d,\"nodes\":%d,"
+		"\"operations\":%d,\"seconds\":%.6g,\"operations_per_second\":%.6g,"
+		"\"peak_memory_kb\":%ld}\n", benchmark_name, benchmark_mesh.name,
+		benchmark_mesh.number_of_elements, benchmark_mesh.number_of_nodes,
+		number_of_operations, seconds,
+		(seconds > 0.0) ? ((double)number_of_operations / seconds) : 0.0,
+		get_peak_memory_kb());
+	fflush(stdout);
+}
+
+void report_failure(const char *benchmark_name, const Benchmark_mesh &benchmark_mesh,
+	const char *reason)
+{
+	printf("{\"benchmark\":\"%s\",\"mesh\":\"%s\",\"error\":\"%s\"}\n",
+		benchmark_name, benchmark_mesh.name, reason);
+	fflush(stdout);
+}
+
+/** Deterministic pseudo-random numbers in [0,1) so runs are comparable */
+double next_random(unsigned int &seed)
+{
+	seed = seed*1103515245u + 12345u;
+	return (double)((seed >> 8) & 0xFFFFFF) / (double)0x1000000;
+}
+
+/***************************************************************************//**
+ * Generates EX format text for a unit cube divided into elements_count^3
+ * elements with a 3 component coordinates field. Hermite derivatives are
+ * w.r.t. xi so no scale factors are needed.
+ */
+std::string generate_block_ex(int elements_count, bool cubic_hermite)
+{
+	const int nodes_count = elements_count + 1;
+	const double h = 1.0 / (double)elements_count;
+	const char *component_names[3] = { "x", "y", "z" };
+	std::ostringstream out;
+	out.precision(17);
+	out << " Region: /\n";
+	out << " #Fields=1\n";
+	out << " 1) coordinates, coordinate, rectangular cartesian, #Components=3\n";
+	for (int c = 0; c < 3; c++)
+	{
+		if (cubic_hermite)
+		{
+			out << "   " << component_names[c] << ".  Value index= " << (1 + 8*c)
+				<< ", #Derivatives= 7 (d/ds1,d/ds2,d2/ds1ds2,d/ds3,d2/ds1ds3,d2/ds2ds3,d3/ds1ds2ds3)\n";
+		}
+		else
+		{
+			out << "   " << component_names[c] << ".  Value index= " << (1 + c)
+				<< ", #Derivatives= 0\n";
+		}
+	}
+	int node_identifier = 1;
+	for (int k = 0; k < nodes_count; k++)
+	{
+		for (int j = 0; j < nodes_count; j++)
+		{
+			for (int i = 0; i < nodes_count; i++)
+			{
+				const double x[3] = { i*h, j*h, k*h };
+				out << " Node: " << node_identifier << "\n";
+				for (int c = 0; c < 3; c++)
+				{
+					out << " " << x[c];
+					if (cubic_hermite)
+					{
+						/* order d/ds1 d/ds2 d2/ds1ds2 d/ds3 d2/ds1ds3 d2/ds2ds3 d3/ds1ds2ds3 */
+						out << " " << ((0 == c) ? h : 0.0) << " " << ((1 == c) ? h : 0.0)
+							<< " 0 " << ((2 == c) ? h : 0.0) << " 0 0 0";
+					}
+					out << "\n";
+				}
+				node_identifier++;
+			}
+		}
+	}
+	out << " Shape.  Dimension=3, line*line*line\n";
+	out << " #Scale factor sets= 0\n";
+	out << " #Nodes= 8\n";
+	out << " #Fields=1\n";
+	out << " 1) coordinates, coordinate, rectangular cartesian, #Components=3\n";
+	for (int c = 0; c < 3; c++)
+	{
+		out << "   " << component_names[c] << ".  " << (cubic_hermite ?
+			"c.Hermite*c.Hermite*c.Hermite" : "l.Lagrange*l.Lagrange*l.Lagrange")
+			<< ", no modify, standard node based.\n";
+		out << "     #Nodes= 8\n";
+		for (int n = 1; n <= 8; n++)
+		{
+			if (cubic_hermite)
+			{
+				out << "      " << n << ".  #Values=8\n";
+				out << "       Value indices:     1   2   3   4   5   6   7   8\n";
+				out << "       Scale factor indices:   0   0   0   0   0   0   0   0\n";
+			}
+			else
+			{
+				out << "      " << n << ".  #Values=1\n";
+				out << "       Value indices:     1\n";
+				out << "       Scale factor indices:   0\n";
+			}
+		}
+	}
+	int element_identifier = 1;
+	for (int k = 0; k < elements_count; k++)
+	{
+		for (int j = 0; j < elements_count; j++)
+		{
+			for (int i = 0; i < elements_count; i++)
+			{
+				const int base_node = 1 + i + j*nodes_count + k*nodes_count*nodes_count;
+				out << " Element: " << element_identifier << " 0 0\n";
+				out << "   Nodes:\n";
+				out << "   " << base_node << " " << base_node + 1
+					<< " " << base_node + nodes_count << " " << base_node + nodes_count + 1
+					<< " " << base_node + nodes_count*nodes_count
+					<< " " << base_node + nodes_count*nodes_count + 1
+					<< " " << base_node + nodes_count*nodes_count + nodes_count
+					<< " " << base_node + nodes_count*nodes_count + nodes_count + 1 << "\n";
+				element_identifier++;
+			}
+		}
+	}
+	return out.str();
+}
+
+/** Reads EX data from memory_buffer into region.
+ * @return  Status CMISS_OK on success, any other value on failure. */
+int read_region_from_memory(Cmiss_region_id region, const void *memory_buffer,
+	unsigned int memory_buffer_length)
+{
+	Cmiss_stream_information_id stream_information =
+		Cmiss_region_create_stream_information(region);
+	Cmiss_stream_resource_id resource = Cmiss_stream_information_create_resource_memory_buffer(
+		stream_information, memory_buffer, memory_buffer_length);
+	int return_code = Cmiss_region_read(region, stream_information);
+	Cmiss_stream_resource_destroy(&resource);
+	Cmiss_stream_information_destroy(&stream_information);
+	return return_code;
+}
+
+/** Writes region to a new memory buffer, as binary EX if binary is set.
+ * Caller must free returned buffer with Cmiss_deallocate.
+ * @return  Status CMISS_OK on success, any other value on failure. */
+int write_region_to_memory(Cmiss_region_id region, bool binary,
+	void **memory_buffer_address, unsigned int *memory_buffer_length_address)
+{
+	Cmiss_stream_information_id stream_information =
+		Cmiss_region_create_stream_information(region);
+	Cmiss_stream_resource_id resource =
+		Cmiss_stream_information_create_resource_memory(stream_information);
+	if (binary)
+	{
+		Cmiss_stream_information_region_id stream_information_region =
+			Cmiss_stream_information_cast_region(stream_information);
+		Cmiss_stream_information_region_set_resource_attribute_real(stream_information_region,
+			resource, CMISS_STREAM_INFORMATION_REGION_ATTRIBUTE_BINARY, 1.0);
+		Cmiss_stream_information_region_destroy(&stream_information_region);
+	}
+	int return_code = Cmiss_region_write(region, stream_information);
+	if (CMISS_OK == return_code)
+	{
+		Cmiss_stream_resource_memory_id memory_resource = Cmiss_stream_resource_cast_memory(resource);
+		return_code = Cmiss_stream_resource_memory_get_buffer_copy(memory_resource,
+			memory_buffer_address, memory_buffer_length_address);
+		Cmiss_stream_resource_memory_destroy(&memory_resource);
+	}
+	Cmiss_stream_resource_destroy(&resource);
+	Cmiss_stream_information_destroy(&stream_information);
+	return return_code;
+}
+
+/***************************************************************************//**
+ * Creates a child region of root_region named name and reads the generated
+ * block mesh into it, timing the text read.
+ * @return  true on success.
+ */
+bool create_benchmark_mesh(Cmiss_region_id root_region, const char *name,
+	bool cubic_hermite, const Benchmark_options &options, Benchmark_mesh &benchmark_mesh)
+{
+	benchmark_mesh.name = name;
+	benchmark_mesh.number_of_elements =
+		options.elements_count*options.elements_count*options.elements_count;
+	benchmark_mesh.number_of_nodes =
+		(options.elements_count + 1)*(options.elements_count + 1)*(options.elements_count + 1);
+	std::string ex_text = generate_block_ex(options.elements_count, cubic_hermite);
+	benchmark_mesh.region = Cmiss_region_create_child(root_region, name);
+	double start = get_wall_time();
+	int return_code = read_region_from_memory(benchmark_mesh.region,
+		ex_text.c_str(), (unsigned int)ex_text.size());
+	double seconds = get_wall_time() - start;
+	benchmark_mesh.field_module = Cmiss_region_get_field_module(benchmark_mesh.region);
+	benchmark_mesh.coordinates =
+		Cmiss_field_module_find_field_by_name(benchmark_mesh.field_module, "coordinates");
+	benchmark_mesh.mesh = Cmiss_field_module_find_mesh_by_dimension(benchmark_mesh.field_module, 3);
+	benchmark_mesh.nodeset =
+		Cmiss_field_module_find_nodeset_by_name(benchmark_mesh.field_module, "cmiss_nodes");
+	if ((CMISS_OK != return_code) || (!benchmark_mesh.coordinates) ||
+		(Cmiss_mesh_get_size(benchmark_mesh.mesh) != benchmark_mesh.number_of_elements))
+	{
+		report_failure("exregion_read_text", benchmark_mesh, "could not read generated mesh");
+		return false;
+	}
+	report("exregion_read_text", benchmark_mesh, benchmark_mesh.number_of_elements, seconds);
+	/* faces are needed for surfaces graphics */
+	Cmiss_field_module_define_all_faces(benchmark_mesh.field_module);
+	return true;
+}
+
+void destroy_benchmark_mesh(Benchmark_mesh &benchmark_mesh)
+{
+	Cmiss_nodeset_destroy(&benchmark_mesh.nodeset);
+	Cmiss_mesh_destroy(&benchmark_mesh.mesh);
+	Cmiss_field_destroy(&benchmark_mesh.coordinates);
+	Cmiss_field_module_destroy(&benchmark_mesh.field_module);
+	Cmiss_region_destroy(&benchmark_mesh.region);
+}
+
+/** Times Cmiss_field_evaluate_real of field at a regular lattice of xi points
+ * in every element of the mesh. */
+void benchmark_evaluate_real(const char *benchmark_name, Benchmark_mesh &benchmark_mesh,
+	Cmiss_field_id field, const Benchmark_options &options)
+{
+	const int number_of_components = Cmiss_field_get_number_of_components(field);
+	std::vector<double> values(number_of_components);
+	const int points_count = options.points_count;
+	const double xi_step = 1.0 / (double)points_count;
+	int number_of_operations = 0;
+	double best_seconds = -1.0;
+	bool success = true;
+	for (int r = 0; (r < options.repeats) && success; r++)
+	{
+		Cmiss_field_cache_id field_cache = Cmiss_field_module_create_cache(benchmark_mesh.field_module);
+		Cmiss_element_iterator_id iterator = Cmiss_mesh_create_element_iterator(benchmark_mesh.mesh);
+		Cmiss_element_id element;
+		number_of_operations = 0;
+		double start = get_wall_time();
+		while (success && (0 != (element = Cmiss_element_iterator_next(iterator))))
+		{
+			double xi[3];
+			for (int k = 0; k < points_count; k++)
+			{
+				xi[2] = (k + 0.5)*xi_step;
+				for (int j = 0; j < points_count; j++)
+				{
+					xi[1] = (j + 0.5)*xi_step;
+					for (int i = 0; i < points_count; i++)
+					{
+						xi[0] = (i + 0.5)*xi_step;
+						Cmiss_field_cache_set_mesh_location(field_cache, element, 3, xi);
+						if (CMISS_OK != Cmiss_field_evaluate_real(field, field_cache,
+							number_of_components, &values[0]))
+						{
+							success = false;
+						}
+						number_of_operations++;
+					}
+				}
+			}
+			Cmiss_element_destroy(&element);
+		}
+		double seconds = get_wall_time() - start;
+		Cmiss_element_iterator_destroy(&iterator);
+		Cmiss_field_cache_destroy(&field_cache);
+		if ((best_seconds < 0.0) || (seconds < best_seconds))
+		{
+			best_seconds = seconds;
+		}
+	}
+	if (success)
+	{
+		report(benchmark_name, benchmark_mesh, number_of_operations, best_seconds);
+	}
+	else
+	{
+		report_failure(benchmark_name, benchmark_mesh, "evaluation failed");
+	}
+}
+
+/** Times finding the element and xi of random points inside the block */
+void benchmark_find_mesh_location(Benchmark_mesh &benchmark_mesh,
+	const Benchmark_options &options)
+{
+	Cmiss_field_module_id field_module = benchmark_mesh.field_module;
+	Cmiss_field_module_begin_change(field_module);
+	Cmiss_field_id data_coordinates = Cmiss_field_module_create_finite_element(field_module, 3);
+	Cmiss_field_set_name(data_coordinates, "benchmark_data_coordinates");
+	Cmiss_nodeset_id data_nodeset = Cmiss_field_module_find_nodeset_by_name(field_module, "cmiss_data");
+	Cmiss_node_template_id node_template = Cmiss_nodeset_create_node_template(data_nodeset);
+	Cmiss_node_template_define_field(node_template, data_coordinates);
+	Cmiss_field_cache_id field_cache = Cmiss_field_module_create_cache(field_module);
+	unsigned int seed = 1;
+	for (int i = 1; i <= options.data_points_count; i++)
+	{
+		Cmiss_node_id node = Cmiss_nodeset_create_node(data_nodeset, i, node_template);
+		double x[3];
+		x[0] = next_random(seed);
+		x[1] = next_random(seed);
+		x[2] = next_random(seed);
+		Cmiss_field_cache_set_node(field_cache, node);
+		Cmiss_field_assign_real(data_coordinates, field_cache, 3, x);
+		Cmiss_node_destroy(&node);
+	}
+	Cmiss_field_id find_mesh_location = Cmiss_field_module_create_find_mesh_location(
+		field_module, data_coordinates, benchmark_mesh.coordinates, benchmark_mesh.mesh);
+	Cmiss_field_module_end_change(field_module);
+	int number_found = 0;
+	double best_seconds = -1.0;
+	for (int r = 0; r < options.repeats; r++)
+	{
+		/* new cache each time so no element is remembered between repeats */
+		Cmiss_field_cache_destroy(&field_cache);
+		field_cache = Cmiss_field_module_create_cache(field_module);
+		Cmiss_node_iterator_id iterator = Cmiss_nodeset_create_node_iterator(data_nodeset);
+		Cmiss_node_id node;
+		number_found = 0;
+		double start = get_wall_time();
+		while (0 != (node = Cmiss_node_iterator_next(iterator)))
+		{
+			double xi[3];
+			Cmiss_field_cache_set_node(field_cache, node);
+			Cmiss_element_id element = Cmiss_field_evaluate_mesh_location(find_mesh_location,
+				field_cache, 3, xi);
+			if (element)
+			{
+				number_found++;
+				Cmiss_element_destroy(&element);
+			}
+			Cmiss_node_destroy(&node);
+		}
+		double seconds = get_wall_time() - start;
+		Cmiss_node_iterator_destroy(&iterator);
+		if ((best_seconds < 0.0) || (seconds < best_seconds))
+		{
+			best_seconds = seconds;
+		}
+	}
+	if (number_found == options.data_points_count)
+	{
+		report("find_mesh_location", benchmark_mesh, options.data_points_count, best_seconds);
+	}
+	else
+	{
+		report_failure("find_mesh_location", benchmark_mesh, "not all points were found");
+	}
+	Cmiss_field_destroy(&find_mesh_location);
+	Cmiss_field_cache_destroy(&field_cache);
+	Cmiss_nodeset_destroy_all_nodes(data_nodeset);
+	Cmiss_node_template_destroy(&node_template);
+	Cmiss_nodeset_destroy(&data_nodeset);
+	Cmiss_field_destroy(&data_coordinates);
+}
+
+/** Times repeated evaluation of nodeset sum and mean of the coordinates,
+ * changing the cache location between evaluations so each is recomputed.
+ * Operations are counted as nodes summed. */
+void benchmark_nodeset_operators(Benchmark_mesh &benchmark_mesh,
+	const Benchmark_options &options)
+{
+	const int number_of_evaluations = 100;
+	Cmiss_field_id nodeset_fields[2];
+	const char *benchmark_names[2] = { "nodeset_sum", "nodeset_mean" };
+	nodeset_fields[0] = Cmiss_field_module_create_nodeset_sum(benchmark_mesh.field_module,
+		benchmark_mesh.coordinates, benchmark_mesh.nodeset);
+	nodeset_fields[1] = Cmiss_field_module_create_nodeset_mean(benchmark_mesh.field_module,
+		benchmark_mesh.coordinates, benchmark_mesh.nodeset);
+	Cmiss_element_id element = Cmiss_mesh_find_element_by_identifier(benchmark_mesh.mesh, 1);
+	for (int f = 0; f < 2; f++)
+	{
+		double best_seconds = -1.0;
+		bool success = (0 != nodeset_fields[f]) && (0 != element);
+		for (int r = 0; (r < options.repeats) && success; r++)
+		{
+			Cmiss_field_cache_id field_cache =
+				Cmiss_field_module_create_cache(benchmark_mesh.field_module);
+			double start = get_wall_time();
+			for (int e = 0; e < number_of_evaluations; e++)
+			{
+				double xi[3], values[3];
+				xi[0] = xi[1] = xi[2] = (double)e / (double)number_of_evaluations;
+				Cmiss_field_cache_set_mesh_location(field_cache, element, 3, xi);
+				if (CMISS_OK != Cmiss_field_evaluate_real(nodeset_fields[f], field_cache, 3, values))
+				{
+					success = false;
+					break;
+				}
+			}
+			double seconds = get_wall_time() - start;
+			Cmiss_field_cache_destroy(&field_cache);
+			if ((best_seconds < 0.0) || (seconds < best_seconds))
+			{
+				best_seconds = seconds;
+			}
+		}
+		if (success)
+		{
+			report(benchmark_names[f], benchmark_mesh,
+				number_of_evaluations*benchmark_mesh.number_of_nodes, best_seconds);
+		}
+		else
+		{
+			report_failure(benchmark_names[f], benchmark_mesh, "evaluation failed");
+		}
+		Cmiss_field_destroy(&nodeset_fields[f]);
+	}
+	Cmiss_element_destroy(&element);
+}
+
+/** Reads binary EX memory_buffer into a new region, writes that as text and
+ * checks it matches text_memory_buffer written from the original region.
+ * @return  true if the round trip reproduced the text exactly. */
+bool verify_binary_round_trip(Benchmark_mesh &benchmark_mesh,
+	const void *memory_buffer, unsigned int memory_buffer_length,
+	const void *text_memory_buffer, unsigned int text_memory_buffer_length)
+{
+	bool success = false;
+	Cmiss_region_id read_region = Cmiss_region_create_region(benchmark_mesh.region);
+	if (CMISS_OK == read_region_from_memory(read_region, memory_buffer, memory_buffer_length))
+	{
+		void *round_trip_buffer = NULL;
+		unsigned int round_trip_buffer_length = 0;
+		if (CMISS_OK == write_region_to_memory(read_region, /*binary*/false,
+			&round_trip_buffer, &round_trip_buffer_length))
+		{
+			success = (round_trip_buffer_length == text_memory_buffer_length) &&
+				(0 == memcmp(round_trip_buffer, text_memory_buffer, text_memory_buffer_length));
+			Cmiss_deallocate(round_trip_buffer);
+		}
+	}
+	Cmiss_region_destroy(&read_region);
+	return success;
+}
+
+/** Times writing the region as text and binary EX, and reading binary EX
+ * back into a new region. The binary read is verified by checking it writes
+ * the same text as the original region. */
+void benchmark_exregion_io(Benchmark_mesh &benchmark_mesh, const Benchmark_options &options)
+{
+	void *text_memory_buffer = NULL;
+	unsigned int text_memory_buffer_length = 0;
+	for (int binary = 0; binary < 2; binary++)
+	{
+		const char *write_name = binary ? "exregion_write_binary" : "exregion_write_text";
+		void *memory_buffer = NULL;
+		unsigned int memory_buffer_length = 0;
+		double best_seconds = -1.0;
+		bool success = true;
+		for (int r = 0; (r < options.repeats) && success; r++)
+		{
+			if (memory_buffer)
+			{
+				Cmiss_deallocate(memory_buffer);
+				memory_buffer = NULL;
+			}
+			double start = get_wall_time();
+			success = (CMISS_OK == write_region_to_memory(benchmark_mesh.region,
+				(0 != binary), &memory_buffer, &memory_buffer_length));
+			double seconds = get_wall_time() - start;
+			if ((best_seconds < 0.0) || (seconds < best_seconds))
+			{
+				best_seconds = seconds;
+			}
+		}
+		if (!success)
+		{
+			report_failure(write_name, benchmark_mesh, "write failed");
+			continue;
+		}
+		report(write_name, benchmark_mesh, benchmark_mesh.number_of_elements, best_seconds);
+		if (binary)
+		{
+			best_seconds = -1.0;
+			for (int r = 0; (r < options.repeats) && success; r++)
+			{
+				Cmiss_region_id read_region = Cmiss_region_create_region(benchmark_mesh.region);
+				double start = get_wall_time();
+				success = (CMISS_OK == read_region_from_memory(read_region,
+					memory_buffer, memory_buffer_length));
+				double seconds = get_wall_time() - start;
+				Cmiss_region_destroy(&read_region);
+				if ((best_seconds < 0.0) || (seconds < best_seconds))
+				{
+					best_seconds = seconds;
+				}
+			}
+			if (!success)
+			{
+				report_failure("exregion_read_binary", benchmark_mesh, "read failed");
+			}
+			else if (text_memory_buffer && !verify_binary_round_trip(benchmark_mesh,
+				memory_buffer, memory_buffer_length, text_memory_buffer, text_memory_buffer_length))
+			{
+				report_failure("exregion_read_binary", benchmark_mesh,
+					"binary round trip does not match text");
+			}
+			else
+			{
+				report("exregion_read_binary", benchmark_mesh,
+					benchmark_mesh.number_of_elements, best_seconds);
+			}
+			Cmiss_deallocate(memory_buffer);
+		}
+		else
+		{
+			text_memory_buffer = memory_buffer;
+			text_memory_buffer_length = memory_buffer_length;
+		}
+	}
+	if (text_memory_buffer)
+	{
+		Cmiss_deallocate(text_memory_buffer);
+	}
+}
+
+/***************************************************************************//**
+ * Times building the graphics object for a new graphic of graphic_type.
+ * Graphics objects are only generated when the rendition is compiled, so this
+ * uses the internal Cmiss_rendition_get_range which builds all graphics
+ * objects before computing their range.
+ */
+void benchmark_graphic(const char *benchmark_name, Benchmark_mesh &benchmark_mesh,
+	Cmiss_rendition_id rendition, Cmiss_scene_id scene,
+	enum Cmiss_graphic_type graphic_type, Cmiss_field_id data_field,
+	const Benchmark_options &options)
+{
+	double best_seconds = -1.0;
+	bool success = true;
+	for (int r = 0; (r < options.repeats) && success; r++)
+	{
+		Cmiss_rendition_begin_change(rendition);
+		Cmiss_graphic_id graphic = Cmiss_rendition_create_graphic(rendition, graphic_type);
+		Cmiss_graphic_set_coordinate_field(graphic, benchmark_mesh.coordinates);
+		Cmiss_graphic_set_number_of_threads(graphic, options.number_of_threads);
+		if (CMISS_GRAPHIC_ISO_SURFACES == graphic_type)
+		{
+			double iso_value = 0.8;
+			Cmiss_graphic_set_iso_surface_parameters(graphic, data_field,
+				/*number_of_iso_values*/1, &iso_value, iso_value, iso_value,
+				/*decimation_threshold*/0.0);
+		}
+		else if (CMISS_GRAPHIC_STREAMLINES == graphic_type)
+		{
+			Cmiss_graphic_set_streamline_parameters(graphic, STREAM_LINE, data_field,
+				/*reverse_track*/0, /*streamline_length*/1.0, /*streamline_width*/0.0);
+		}
+		Cmiss_rendition_end_change(rendition);
+		struct Graphics_object_range_struct graphics_object_range;
+		graphics_object_range.first = 1;
+		double start = get_wall_time();
+		Cmiss_rendition_get_range(rendition, scene, &graphics_object_range);
+		double seconds = get_wall_time() - start;
+		success = (0 == graphics_object_range.first);
+		Cmiss_rendition_remove_graphic(rendition, graphic);
+		Cmiss_graphic_destroy(&graphic);
+		if ((best_seconds < 0.0) || (seconds < best_seconds))
+		{
+			best_seconds = seconds;
+		}
+	}
+	if (success)
+	{
+		report(benchmark_name, benchmark_mesh, benchmark_mesh.number_of_elements, best_seconds);
+	}
+	else
+	{
+		report_failure(benchmark_name, benchmark_mesh, "no graphics generated");
+	}
+}
+
+void benchmark_graphics(Benchmark_mesh &benchmark_mesh,
+	Cmiss_graphics_module_id graphics_module, Cmiss_region_id root_region,
+	const Benchmark_options &options)
+{
+	Cmiss_field_module_id field_module = benchmark_mesh.field_module;
+	Cmiss_rendition_id rendition =
+		Cmiss_graphics_module_get_rendition(graphics_module, benchmark_mesh.region);
+	Cmiss_scene_id scene = Cmiss_graphics_module_create_scene(graphics_module);
+	Cmiss_scene_set_region(scene, root_region);
+	/* iso-surface of distance from origin; streamlines swirl about centre line */
+	Cmiss_field_id magnitude = Cmiss_field_module_create_magnitude(field_module,
+		benchmark_mesh.coordinates);
+	const double centre_values[3] = { 0.5, 0.5, 0.0 };
+	const double axis_values[3] = { 0.0, 0.0, 1.0 };
+	Cmiss_field_id centre = Cmiss_field_module_create_constant(field_module, 3, centre_values);
+	Cmiss_field_id axis = Cmiss_field_module_create_constant(field_module, 3, axis_values);
+	Cmiss_field_id offset = Cmiss_field_module_create_subtract(field_module,
+		benchmark_mesh.coordinates, centre);
+	Cmiss_field_id swirl = Cmiss_field_module_create_cross_product_3d(field_module, axis, offset);
+	benchmark_graphic("graphic_surfaces", benchmark_mesh, rendition, scene,
+		CMISS_GRAPHIC_SURFACES, NULL, options);
+	benchmark_graphic("graphic_iso_surfaces", benchmark_mesh, rendition, scene,
+		CMISS_GRAPHIC_ISO_SURFACES, magnitude, options);
+	benchmark_graphic("graphic_streamlines", benchmark_mesh, rendition, scene,
+		CMISS_GRAPHIC_STREAMLINES, swirl, options);
+	Cmiss_field_destroy(&swirl);
+	Cmiss_field_destroy(&offset);
+	Cmiss_field_destroy(&axis);
+	Cmiss_field_destroy(&centre);
+	Cmiss_field_destroy(&magnitude);
+	Cmiss_scene_destroy(&scene);
+	Cmiss_rendition_destroy(&rendition);
+}
+
+#if defined (USE_ITK) && defined (USE_IMAGEMAGICK)
+/***************************************************************************//**
+ * Times a mean image filter over a synthetic 8-bit image read from an in-memory
+ * PGM, including the first evaluation which runs the filter over every pixel.
+ * Operations are counted as pixels.
+ */
+void benchmark_image_filter(Benchmark_mesh &benchmark_mesh, const Benchmark_options &options)
+{
+	const int image_size = 512;
+	std::ostringstream header;
+	header << "P5\n" << image_size << " " << image_size << "\n255\n";
+	std::string pgm = header.str();
+	unsigned int seed = 2;
+	for (int i = 0; i < image_size*image_size; i++)
+	{
+		pgm += (char)(unsigned char)(255.0*next_random(seed));
+	}
+	Cmiss_field_module_id field_module = benchmark_mesh.field_module;
+	Cmiss_field_id image_field = Cmiss_field_module_create_image(field_module, NULL, NULL);
+	Cmiss_field_image_id image = Cmiss_field_cast_image(image_field);
+	Cmiss_stream_information_id stream_information =
+		Cmiss_field_image_create_stream_information(image);
+	Cmiss_stream_resource_id resource = Cmiss_stream_information_create_resource_memory_buffer(
+		stream_information, pgm.c_str(), (unsigned int)pgm.size());
+	bool success = (CMISS_OK == Cmiss_field_image_read(image, stream_information));
+	Cmiss_stream_resource_destroy(&resource);
+	Cmiss_stream_information_destroy(&stream_information);
+	Cmiss_field_image_destroy(&image);
+	double best_seconds = -1.0;
+	Cmiss_element_id element = Cmiss_mesh_find_element_by_identifier(benchmark_mesh.mesh, 1);
+	for (int r = 0; (r < options.repeats) && success; r++)
+	{
+		int radius_sizes[2] = { 2, 2 };
+		double start = get_wall_time();
+		Cmiss_field_id filter = Cmiss_field_module_create_mean_image_filter(field_module,
+			image_field, radius_sizes);
+		Cmiss_field_cache_id field_cache = Cmiss_field_module_create_cache(field_module);
+		double xi[3] = { 0.5, 0.5, 0.5 };
+		double value;
+		Cmiss_field_cache_set_mesh_location(field_cache, element, 3, xi);
+		success = (CMISS_OK == Cmiss_field_evaluate_real(filter, field_cache, 1, &value));
+		double seconds = get_wall_time() - start;
+		Cmiss_field_cache_destroy(&field_cache);
+		Cmiss_field_destroy(&filter);
+		if ((best_seconds < 0.0) || (seconds < best_seconds))
+		{
+			best_seconds = seconds;
+		}
+	}
+	Cmiss_element_destroy(&element);
+	Cmiss_field_destroy(&image_field);
+	if (success)
+	{
+		report("image_mean_filter", benchmark_mesh, image_size*image_size, best_seconds);
+	}
+	else
+	{
+		report_failure("image_mean_filter", benchmark_mesh, "image filter failed");
+	}
+}
+#endif /* defined (USE_ITK) && defined (USE_IMAGEMAGICK) */
+
+void print_usage(const char *program_name)
+{
+	fprintf(stderr,
+		"Usage: %s [--elements N] [--points N] [--data-points N] [--repeats N] [--threads N]\n"
+		"  --elements     elements in each direction of the block mesh (default 8)\n"
+		"  --points       evaluation points in each xi direction per element (default 4)\n"
+		"  --data-points  number of points located with find_mesh_location (default 1000)\n"
+		"  --repeats      runs of each benchmark; the fastest is reported (default 3)\n"
+		"  --threads      threads for graphics generation (default 1)\n"
+		"Results are written to stdout as one JSON object per line.\n", program_name);
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+	Benchmark_options options;
+	options.elements_count = 8;
+	options.points_count = 4;
+	options.data_points_count = 1000;
+	options.repeats = 3;
+	options.number_of_threads = 1;
+	for (int i = 1; i < argc; i++)
+	{
+		int *option_value = NULL;
+		if (0 == strcmp(argv[i], "--elements"))
+			option_value = &options.elements_count;
+		else if (0 == strcmp(argv[i], "--points"))
+			option_value = &options.points_count;
+		else if (0 == strcmp(argv[i], "--data-points"))
+			option_value = &options.data_points_count;
+		else if (0 == strcmp(argv[i], "--repeats"))
+			option_value = &options.repeats;
+		else if (0 == strcmp(argv[i], "--threads"))
+			option_value = &options.number_of_threads;
+		if ((!option_value) || (i + 1 >= argc) || (0 >= (*option_value = atoi(argv[i + 1]))))
+		{
+			print_usage(argv[0]);
+			return 1;
+		}
+		i++;
+	}
+	Cmiss_context_id context = Cmiss_context_create("zinc_benchmarks");
+	Cmiss_region_id root_region = Cmiss_context_get_default_region(context);
+	Cmiss_graphics_module_id graphics_module = Cmiss_context_get_default_graphics_module(context);
+	Cmiss_graphics_module_enable_renditions(graphics_module, root_region);
+	const char *mesh_names[2] = { "linear_lagrange", "cubic_hermite" };
+	int return_code = 0;
+	for (int m = 0; m < 2; m++)
+	{
+		Benchmark_mesh benchmark_mesh;
+		if (create_benchmark_mesh(root_region, mesh_names[m], /*cubic_hermite*/(1 == m),
+			options, benchmark_mesh))
+		{
+			benchmark_evaluate_real("evaluate_real", benchmark_mesh,
+				benchmark_mesh.coordinates, options);
+			benchmark_find_mesh_location(benchmark_mesh, options);
+			benchmark_nodeset_operators(benchmark_mesh, options);
+			benchmark_exregion_io(benchmark_mesh, options);
+			benchmark_graphics(benchmark_mesh, graphics_module, root_region, options);
+#if defined (USE_ITK) && defined (USE_IMAGEMAGICK)
+			benchmark_image_filter(benchmark_mesh, options);
+#endif /* defined (USE_ITK) && defined (USE_IMAGEMAGICK) */
+		}
+		else
+		{
+			return_code = 1;
+		}
+		destroy_benchmark_mesh(benchmark_mesh);
+	}
+	Cmiss_graphics_module_destroy(&graphics_module);
+	Cmiss_region_destroy(&root_region);
+	Cmiss_context_destroy(&context);
+	return return_code;
+}
@@ -8,20 +8,26 @@ SET( FINITE_ELEMENT_CORE_SRCS
 	source/finite_element/finite_element.cpp
 	source/finite_element/finite_element_basis.cpp
 	source/finite_element/finite_element_discretization.cpp
+	source/finite_element/finite_element_face_index.cpp
 	source/finite_element/finite_element_helper.cpp
+	source/finite_element/finite_element_mesh_adjacency.cpp
 	source/finite_element/finite_element_region.cpp
 	source/finite_element/finite_element_time.cpp
+	source/finite_element/finite_element_time_series.cpp
 	source/finite_element/import_finite_element.cpp )
 SET( FINITE_ELEMENT_CORE_HDRS
 	source/finite_element/export_finite_element.h
 	source/finite_element/finite_element_discretization.h
+	source/finite_element/finite_element_face_index.hpp
 	source/finite_element/finite_element_helper.h
+	source/finite_element/finite_element_mesh_adjacency.hpp
 	source/finite_element/finite_element_private.h
 	source/finite_element/finite_element_region.h
 	source/finite_element/finite_element_region_private.h
 	source/finite_element/finite_element.h
 	source/finite_element/finite_element_basis.h
 	source/finite_element/finite_element_time.h
+	source/finite_element/finite_element_time_series.hpp
 	source/finite_element/import_finite_element.h )
 
 SET( FINITE_ELEMENT_GRAPHICS_SRCS
@@ -30,6 +30,7 @@ SET( GENERAL_HDRS
 	source/general/any_object_definition.h
 	source/general/any_object_private.h
 	source/general/any_object_prototype.h
+	source/general/atomic.h
 	source/general/block_array.hpp
 	source/general/callback.h
 	source/general/callback_class.hpp
@@ -63,6 +64,7 @@ SET( GENERAL_HDRS
 	source/general/matrix_vector.h
 	source/general/message.h
 	source/general/multi_range.h
+	source/general/mutex.hpp
 	source/general/myio.h
 	source/general/mystring.h
 	source/general/object.h
@@ -92,6 +92,7 @@ IF( ${GRAPHICS_API} MATCHES OPENGL_GRAPHICS )
 		source/graphics/graphics_filter.cpp
 		source/graphics/graphics_library.cpp
 		source/graphics/graphics_object.cpp
+		source/graphics/graphics_object_pick.cpp
 		source/graphics/light.cpp
 		source/graphics/light_model.cpp
 		source/graphics/render.cpp
@@ -101,6 +102,7 @@ IF( ${GRAPHICS_API} MATCHES OPENGL_GRAPHICS )
 	SET( GRAPHICS_HDRS ${GRAPHICS_HDRS}
 		source/graphics/font.h
 		source/graphics/graphics_library.h
+		source/graphics/graphics_object_pick.hpp
 		source/graphics/light.h
 		source/graphics/light_model.h
 		source/graphics/render.hpp
@@ -507,7 +507,7 @@ Frees memory/deaccess objects in computed_field at <*field_address>.
 	return (return_code);
 } /* DESTROY(Computed_field) */
 
-DECLARE_ACCESS_OBJECT_FUNCTION(Computed_field)
+DECLARE_ATOMIC_ACCESS_OBJECT_FUNCTION(Computed_field)
 
 PROTOTYPE_DEACCESS_OBJECT_FUNCTION(Computed_field)
 {
@@ -517,14 +517,14 @@ PROTOTYPE_DEACCESS_OBJECT_FUNCTION(Computed_field)
 	ENTER(DEACCESS(Computed_field));
 	if (object_address && (object = *object_address))
 	{
-		(object->access_count)--;
-		if (object->access_count <= 0)
+		const int access_count = cmiss_atomic_decrement(&(object->access_count));
+		if (access_count <= 0)
 		{
 			return_code = DESTROY(Computed_field)(object_address);
 		}
 		else if ((0 == (object->attribute_flags & COMPUTED_FIELD_ATTRIBUTE_IS_MANAGED_BIT)) &&
-			(object->manager) && ((1 == object->access_count) ||
-				((2 == object->access_count) &&
+			(object->manager) && ((1 == access_count) ||
+				((2 == access_count) &&
 					(MANAGER_CHANGE_NONE(Computed_field) != object->manager_change_status))) &&
 			object->core->not_in_use())
 		{
@@ -557,7 +557,7 @@ PROTOTYPE_REACCESS_OBJECT_FUNCTION(Computed_field)
 		if (new_object)
 		{
 			/* access the new object */
-			(new_object->access_count)++;
+			cmiss_atomic_increment(&(new_object->access_count));
 		}
 		if (*object_address)
 		{
@@ -1311,8 +1311,6 @@ inline bool Cmiss_field_cache_check(Cmiss_field_id field, Cmiss_field_cache_id c
 
 void Cmiss_field::clearCaches()
 {
-	// some fields (integration, histogram) still have caches in field itself to clear:
-	core->clear_cache();
 	Cmiss_region_id region = this->manager->owner;
 	Cmiss_set_Cmiss_field *all_fields = reinterpret_cast<Cmiss_set_Cmiss_field *>(this->manager->object_list);
 	for (Cmiss_set_Cmiss_field::iterator iter = all_fields->begin(); iter != all_fields->end(); iter++)
@@ -1320,6 +1318,23 @@ void Cmiss_field::clearCaches()
 		Cmiss_field_id field = *iter;
 		if (field->dependsOnField(this))
 		{
+			// some fields (integration, histogram, nodeset operators) have caches in field itself to clear:
+			field->core->clear_cache();
+			Cmiss_region_clear_field_value_caches(region, field);
+		}
+	}
+}
+
+void Cmiss_field::clearCaches(int number_of_nodes, FE_node **nodes)
+{
+	Cmiss_region_id region = this->manager->owner;
+	Cmiss_set_Cmiss_field *all_fields = reinterpret_cast<Cmiss_set_Cmiss_field *>(this->manager->object_list);
+	for (Cmiss_set_Cmiss_field::iterator iter = all_fields->begin(); iter != all_fields->end(); iter++)
+	{
+		Cmiss_field_id field = *iter;
+		if (field->dependsOnField(this))
+		{
+			field->core->clear_cache_for_nodes(number_of_nodes, nodes);
 			Cmiss_region_clear_field_value_caches(region, field);
 		}
 	}
@@ -1374,6 +1389,24 @@ FieldValueCache *Computed_field_core::createValueCache(Cmiss_field_cache& /*pare
 	return new RealFieldValueCache(field->number_of_components);
 }
 
+int Computed_field_core::evaluate_batch(Cmiss_field_cache& cache, RealFieldValueCache& valueCache)
+{
+	const int batchSize = cache.getBatchSize();
+	const int componentCount = field->number_of_components;
+	FE_value *batchValues = valueCache.batchValues;
+	for (int p = 0; p < batchSize; ++p)
+	{
+		cache.setBatchPointLocation(p);
+		RealFieldValueCache *pointValueCache = RealFieldValueCache::cast(field->evaluate(cache));
+		if (!pointValueCache)
+			return 0;
+		for (int i = 0; i < componentCount; ++i)
+			batchValues[i] = pointValueCache->values[i];
+		batchValues += componentCount;
+	}
+	return 1;
+}
+
 /** @return  true if all source fields are defined at cache location */
 bool Computed_field_core::is_defined_at_location(Cmiss_field_cache& cache)
 {
@@ -1649,6 +1682,72 @@ int Cmiss_field_evaluate_real(Cmiss_field_id field, Cmiss_field_cache_id cache,
 	return !CMISS_OK;
 }
 
+namespace {
+
+/**
+ * Evaluates field at batch location already set in cache, copies values out
+ * and clears the batch. The cache's single location and requested
+ * derivatives are restored afterwards.
+ */
+int Cmiss_field_evaluate_real_batch_private(Cmiss_field_id field, Cmiss_field_cache_id cache,
+	int number_of_values, double *values)
+{
+	int return_code = !CMISS_OK;
+	const int requestedDerivatives = cache->getRequestedDerivatives();
+	cache->setRequestedDerivatives(0);
+	Field_location *savedLocation = cache->cloneLocation();
+	RealFieldValueCache *valueCache = field->evaluateBatch(*cache);
+	if (valueCache)
+	{
+		const int count = cache->getBatchSize()*field->number_of_components;
+		if (number_of_values >= count)
+		{
+			const FE_value *batchValues = valueCache->batchValues;
+			for (int i = 0; i < count; ++i)
+				values[i] = batchValues[i];
+			return_code = CMISS_OK;
+		}
+	}
+	cache->clearBatch();
+	cache->setLocation(savedLocation);
+	cache->setRequestedDerivatives(requestedDerivatives);
+	return return_code;
+}
+
+} // anonymous namespace
+
+int Cmiss_field_evaluate_real_batch(Cmiss_field_id field, Cmiss_field_cache_id cache,
+	Cmiss_element_id element, int number_of_points, const double *chart_coordinates,
+	int number_of_values, double *values)
+{
+	if (Cmiss_field_cache_check(field, cache) && element && (0 < number_of_points) &&
+		chart_coordinates && (number_of_values >= number_of_points*field->number_of_components) &&
+		values && field->core->has_numerical_components())
+	{
+		cache->setMeshLocationBatch(element, number_of_points, chart_coordinates);
+		return Cmiss_field_evaluate_real_batch_private(field, cache, number_of_values, values);
+	}
+	return !CMISS_OK;
+}
+
+int Cmiss_field_evaluate_real_node_batch(Cmiss_field_id field, Cmiss_field_cache_id cache,
+	int number_of_nodes, const Cmiss_node_id *nodes, int number_of_values, double *values)
+{
+	if (Cmiss_field_cache_check(field, cache) && (0 < number_of_nodes) && nodes &&
+		(number_of_values >= number_of_nodes*field->number_of_components) && values &&
+		field->core->has_numerical_components())
+	{
+		for (int i = 0; i < number_of_nodes; ++i)
+		{
+			if (!nodes[i])
+				return !CMISS_OK;
+		}
+		cache->setNodeBatch(number_of_nodes, nodes);
+		return Cmiss_field_evaluate_real_batch_private(field, cache, number_of_values, values);
+	}
+	return !CMISS_OK;
+}
+
 // Internal API
 // IMPORTANT: Not yet approved for external API!
 int Cmiss_field_evaluate_real_with_derivatives(Cmiss_field_id field,
@@ -329,6 +329,8 @@ private:
 
 	int evaluate(Cmiss_field_cache& cache, FieldValueCache& inValueCache);
 
+	virtual int evaluate_batch(Cmiss_field_cache& cache, RealFieldValueCache& valueCache);
+
 	int list();
 
 	char* get_command_string();
@@ -374,6 +376,23 @@ int Computed_field_multiply_components::evaluate(Cmiss_field_cache& cache, Field
 	return 0;
 }
 
+int Computed_field_multiply_components::evaluate_batch(Cmiss_field_cache& cache, RealFieldValueCache& valueCache)
+{
+	RealFieldValueCache *source1Cache = getSourceField(0)->evaluateBatch(cache);
+	RealFieldValueCache *source2Cache = getSourceField(1)->evaluateBatch(cache);
+	if (source1Cache && source2Cache)
+	{
+		const int count = cache.getBatchSize()*field->number_of_components;
+		const FE_value *source1Values = source1Cache->batchValues;
+		const FE_value *source2Values = source2Cache->batchValues;
+		FE_value *values = valueCache.batchValues;
+		for (int i = 0; i < count; ++i)
+			values[i] = source1Values[i]*source2Values[i];
+		return 1;
+	}
+	return 0;
+}
+
 int Computed_field_multiply_components::list()
 /*******************************************************************************
 LAST MODIFIED : 24 August 2006
@@ -555,6 +574,8 @@ private:
 
 	int evaluate(Cmiss_field_cache& cache, FieldValueCache& inValueCache);
 
+	virtual int evaluate_batch(Cmiss_field_cache& cache, RealFieldValueCache& valueCache);
+
 	int list();
 
 	char* get_command_string();
@@ -603,6 +624,23 @@ int Computed_field_divide_components::evaluate(Cmiss_field_cache& cache, FieldVa
 	return 0;
 }
 
+int Computed_field_divide_components::evaluate_batch(Cmiss_field_cache& cache, RealFieldValueCache& valueCache)
+{
+	RealFieldValueCache *source1Cache = getSourceField(0)->evaluateBatch(cache);
+	RealFieldValueCache *source2Cache = getSourceField(1)->evaluateBatch(cache);
+	if (source1Cache && source2Cache)
+	{
+		const int count = cache.getBatchSize()*field->number_of_components;
+		const FE_value *source1Values = source1Cache->batchValues;
+		const FE_value *source2Values = source2Cache->batchValues;
+		FE_value *values = valueCache.batchValues;
+		for (int i = 0; i < count; ++i)
+			values[i] = source1Values[i]/source2Values[i];
+		return 1;
+	}
+	return 0;
+}
+
 int Computed_field_divide_components::list()
 /*******************************************************************************
 LAST MODIFIED : 24 August 2006
@@ -784,11 +822,36 @@ private:
 
 	virtual int evaluate(Cmiss_field_cache& cache, FieldValueCache& inValueCache);
 
+	virtual int evaluate_batch(Cmiss_field_cache& cache, RealFieldValueCache& valueCache);
+
+	virtual bool supports_dof_derivatives()
+	{
+		return getSourceField(0)->supportsDofDerivatives() &&
+			getSourceField(1)->supportsDofDerivatives();
+	}
+
+	virtual int evaluate_dof_derivatives(Cmiss_field_cache& cache, const FieldDofMap& dofMap,
+		FieldDofDerivatives& derivatives);
+
 	int list();
 
 	char* get_command_string();
 };
 
+/** Derivatives with respect to DOFs are the weighted sum of those of the sources */
+int Computed_field_add::evaluate_dof_derivatives(Cmiss_field_cache& cache,
+	const FieldDofMap& dofMap, FieldDofDerivatives& derivatives)
+{
+	FieldDofDerivatives sourceDerivatives(field->number_of_components);
+	for (int s = 0; s < 2; ++s)
+	{
+		if (!getSourceField(s)->evaluateDofDerivatives(cache, dofMap, sourceDerivatives))
+			return 0;
+		derivatives.addScaled(sourceDerivatives, field->source_values[s]);
+	}
+	return 1;
+}
+
 int Computed_field_add::evaluate(Cmiss_field_cache& cache, FieldValueCache& inValueCache)
 {
 	RealFieldValueCache &valueCache = RealFieldValueCache::cast(inValueCache);
@@ -826,6 +889,25 @@ int Computed_field_add::evaluate(Cmiss_field_cache& cache, FieldValueCache& inVa
 	return 0;
 }
 
+int Computed_field_add::evaluate_batch(Cmiss_field_cache& cache, RealFieldValueCache& valueCache)
+{
+	RealFieldValueCache *source1Cache = getSourceField(0)->evaluateBatch(cache);
+	RealFieldValueCache *source2Cache = getSourceField(1)->evaluateBatch(cache);
+	if (source1Cache && source2Cache)
+	{
+		const int count = cache.getBatchSize()*field->number_of_components;
+		const FE_value scale1 = field->source_values[0];
+		const FE_value scale2 = field->source_values[1];
+		const FE_value *source1Values = source1Cache->batchValues;
+		const FE_value *source2Values = source2Cache->batchValues;
+		FE_value *values = valueCache.batchValues;
+		for (int i = 0; i < count; ++i)
+			values[i] = scale1*source1Values[i] + scale2*source2Values[i];
+		return 1;
+	}
+	return 0;
+}
+
 int Computed_field_add::list()
 /*******************************************************************************
 LAST MODIFIED : 24 August 2006
@@ -1042,6 +1124,8 @@ private:
 
 	int evaluate(Cmiss_field_cache& cache, FieldValueCache& inValueCache);
 
+	virtual int evaluate_batch(Cmiss_field_cache& cache, RealFieldValueCache& valueCache);
+
 	int list();
 
 	char* get_command_string();
@@ -1159,6 +1243,27 @@ int Computed_field_scale::propagate_find_element_xi(Cmiss_field_cache& field_cac
 	return (return_code);
 } /* Computed_field_scale::propagate_find_element_xi */
 
+int Computed_field_scale::evaluate_batch(Cmiss_field_cache& cache, RealFieldValueCache& valueCache)
+{
+	RealFieldValueCache *sourceCache = getSourceField(0)->evaluateBatch(cache);
+	if (sourceCache)
+	{
+		const int batchSize = cache.getBatchSize();
+		const int componentCount = field->number_of_components;
+		const FE_value *sourceValues = sourceCache->batchValues;
+		FE_value *values = valueCache.batchValues;
+		for (int p = 0; p < batchSize; ++p)
+		{
+			for (int i = 0; i < componentCount; ++i)
+				values[i] = field->source_values[i]*sourceValues[i];
+			sourceValues += componentCount;
+			values += componentCount;
+		}
+		return 1;
+	}
+	return 0;
+}
+
 int Computed_field_scale::list()
 /*******************************************************************************
 LAST MODIFIED : 24 August 2006
@@ -1886,6 +1991,8 @@ private:
 
 	int evaluate(Cmiss_field_cache& cache, FieldValueCache& inValueCache);
 
+	virtual int evaluate_batch(Cmiss_field_cache& cache, RealFieldValueCache& valueCache);
+
 	int list();
 
 	char* get_command_string();
@@ -1986,6 +2093,27 @@ int Computed_field_offset::propagate_find_element_xi(Cmiss_field_cache& field_ca
 	return (return_code);
 } /* Computed_field_offset::propagate_find_element_xi */
 
+int Computed_field_offset::evaluate_batch(Cmiss_field_cache& cache, RealFieldValueCache& valueCache)
+{
+	RealFieldValueCache *sourceCache = getSourceField(0)->evaluateBatch(cache);
+	if (sourceCache)
+	{
+		const int batchSize = cache.getBatchSize();
+		const int componentCount = field->number_of_components;
+		const FE_value *sourceValues = sourceCache->batchValues;
+		FE_value *values = valueCache.batchValues;
+		for (int p = 0; p < batchSize; ++p)
+		{
+			for (int i = 0; i < componentCount; ++i)
+				values[i] = field->source_values[i]+sourceValues[i];
+			sourceValues += componentCount;
+			values += componentCount;
+		}
+		return 1;
+	}
+	return 0;
+}
+
 int Computed_field_offset::list()
 /*******************************************************************************
 LAST MODIFIED : 24 August 2006
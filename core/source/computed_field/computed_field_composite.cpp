@@ -126,6 +126,13 @@ private:
 
 	int evaluate(Cmiss_field_cache& cache, FieldValueCache& inValueCache);
 
+	virtual int evaluate_batch(Cmiss_field_cache& cache, RealFieldValueCache& valueCache);
+
+	virtual bool supports_dof_derivatives();
+
+	virtual int evaluate_dof_derivatives(Cmiss_field_cache& cache, const FieldDofMap& dofMap,
+		FieldDofDerivatives& derivatives);
+
 	int list();
 
 	char* get_command_string();
@@ -474,6 +481,105 @@ If <commands> is set, field/components are made into valid tokens.
 	return (source_string);
 } /* Computed_field_composite_get_source_string */
 
+bool Computed_field_composite::supports_dof_derivatives()
+{
+	for (int s = 0; s < field->number_of_source_fields; ++s)
+	{
+		if (!getSourceField(s)->supportsDofDerivatives())
+			return false;
+	}
+	return true;
+}
+
+/** Gathers derivatives of source field components. Constant components are
+ * DOFs themselves if their storage is in the DOF map, e.g. for constant
+ * independent fields in optimisation. */
+int Computed_field_composite::evaluate_dof_derivatives(Cmiss_field_cache& cache,
+	const FieldDofMap& dofMap, FieldDofDerivatives& derivatives)
+{
+	const int number_of_components = field->number_of_components;
+	FieldDofDerivatives sourceDerivatives;
+	for (int s = 0; s < field->number_of_source_fields; ++s)
+	{
+		if (!getSourceField(s)->evaluateDofDerivatives(cache, dofMap, sourceDerivatives))
+			return 0;
+		const int entryCount = sourceDerivatives.getEntryCount();
+		for (int e = 0; e < entryCount; ++e)
+		{
+			const FE_value *sourceValues = sourceDerivatives.getDerivatives(e);
+			FE_value *destination = derivatives.getDofDerivatives(sourceDerivatives.getDofIndex(e));
+			for (int i = 0; i < number_of_components; ++i)
+			{
+				if (source_field_numbers[i] == s)
+					destination[i] += sourceValues[source_value_numbers[i]];
+			}
+		}
+	}
+	for (int i = 0; i < number_of_components; ++i)
+	{
+		if (source_field_numbers[i] < 0)
+		{
+			const int dofIndex = dofMap.getDofIndex(field->source_values + source_value_numbers[i]);
+			if (0 <= dofIndex)
+				derivatives.getDofDerivatives(dofIndex)[i] += 1.0;
+		}
+	}
+	return 1;
+}
+
+int Computed_field_composite::evaluate_batch(Cmiss_field_cache& cache, RealFieldValueCache& valueCache)
+{
+	// try to avoid allocating cache array
+	const int CacheStackSize = 10;
+	RealFieldValueCache *fixedValueCache[CacheStackSize];
+	RealFieldValueCache **sourceValueCache = (field->number_of_source_fields <= CacheStackSize) ?
+		fixedValueCache : new RealFieldValueCache*[field->number_of_source_fields];
+	int return_code = 1;
+	for (int i = 0; i < field->number_of_source_fields; ++i)
+	{
+		sourceValueCache[i] = getSourceField(i)->evaluateBatch(cache);
+		if (!sourceValueCache[i])
+		{
+			return_code = 0;
+			break;
+		}
+	}
+	if (return_code)
+	{
+		const int batchSize = cache.getBatchSize();
+		const int componentCount = field->number_of_components;
+		// gather one component at a time for contiguous access to sources
+		for (int i = 0; i < componentCount; ++i)
+		{
+			FE_value *destination = valueCache.batchValues + i;
+			if (0 <= source_field_numbers[i])
+			{
+				const RealFieldValueCache *sourceCache = sourceValueCache[source_field_numbers[i]];
+				const int sourceComponentCount = sourceCache->componentCount;
+				const FE_value *source = sourceCache->batchValues + source_value_numbers[i];
+				for (int p = 0; p < batchSize; ++p)
+				{
+					*destination = *source;
+					destination += componentCount;
+					source += sourceComponentCount;
+				}
+			}
+			else
+			{
+				const FE_value value = field->source_values[source_value_numbers[i]];
+				for (int p = 0; p < batchSize; ++p)
+				{
+					*destination = value;
+					destination += componentCount;
+				}
+			}
+		}
+	}
+	if (sourceValueCache != fixedValueCache)
+		delete[] sourceValueCache;
+	return return_code;
+}
+
 int Computed_field_composite::list()
 /*******************************************************************************
 LAST MODIFIED : 24 August 2006
@@ -45,7 +45,9 @@ lookup of the element.
 
 #include <stdio.h>
 #include <math.h>
+#include <algorithm>
 
+#include "zinc/status.h"
 #include "general/debug.h"
 #include "general/matrix_vector.h"
 #include "computed_field/computed_field.h"
@@ -55,9 +57,22 @@ lookup of the element.
 #include "finite_element/finite_element_discretization.h"
 #include "finite_element/finite_element_region.h"
 #include "general/message.h"
+#include "mesh/cmiss_element_private.hpp"
 
 #define MAX_FIND_XI_ITERATIONS 50
 
+/* Only use bounding volume hierarchy for meshes with more elements than this */
+#define FIND_XI_BVH_MINIMUM_MESH_SIZE 16
+/* Maximum number of elements in a bounding volume hierarchy leaf */
+#define FIND_XI_BVH_LEAF_SIZE 4
+/* Fraction of box size added to each side for curvature between sample points
+ * in fields with non-linear bases. A quadratic deviates from the chord between
+ * adjacent samples by at most a quarter of its deviation at the sampled
+ * midpoint, so this covers typical curved elements. It only affects the order
+ * elements are tried in: if no box contains the values, elements of
+ * non-linear fields are still searched nearest box first, so none are missed */
+#define FIND_XI_BVH_NON_LINEAR_MARGIN 0.1
+
 int Computed_field_iterative_element_conditional(struct FE_element *element,
 	struct Computed_field_iterative_find_element_xi_data *data)
 {
@@ -292,6 +307,366 @@ int Computed_field_iterative_element_conditional(struct FE_element *element,
 
 #undef MAX_FIND_XI_ITERATIONS
 
+namespace {
+
+/** Orders element indices by centre of their boxes in one value component */
+class Element_box_centre_less
+{
+	const std::vector<FE_value>& element_boxes;
+	const int number_of_values;
+	const int component;
+
+public:
+	Element_box_centre_less(const std::vector<FE_value>& element_boxes_in,
+			int number_of_values_in, int component_in) :
+		element_boxes(element_boxes_in),
+		number_of_values(number_of_values_in),
+		component(component_in)
+	{
+	}
+
+	bool operator()(int index1, int index2) const
+	{
+		const FE_value *box1 = &(element_boxes[2*number_of_values*index1]);
+		const FE_value *box2 = &(element_boxes[2*number_of_values*index2]);
+		return (box1[component] + box1[number_of_values + component]) <
+			(box2[component] + box2[number_of_values + component]);
+	}
+};
+
+} // anonymous namespace
+
+Computed_field_find_element_xi_bvh::Computed_field_find_element_xi_bvh(
+		Cmiss_mesh_id search_mesh_in, FE_value time_in, int number_of_values_in) :
+	search_mesh(Cmiss_mesh_access(search_mesh_in)),
+	fe_region(ACCESS(FE_region)(Cmiss_mesh_get_FE_region_internal(search_mesh_in))),
+	time(time_in),
+	number_of_values(number_of_values_in),
+	group_change_counter(0),
+	non_linear(0),
+	valid(0)
+{
+	FE_region_add_callback(fe_region,
+		Computed_field_find_element_xi_bvh::FE_region_change, (void *)this);
+}
+
+Computed_field_find_element_xi_bvh::~Computed_field_find_element_xi_bvh()
+{
+	FE_region_remove_callback(fe_region,
+		Computed_field_find_element_xi_bvh::FE_region_change, (void *)this);
+	for (std::vector<struct FE_element *>::iterator iter = elements.begin();
+		iter != elements.end(); ++iter)
+	{
+		DEACCESS(FE_element)(&(*iter));
+	}
+	DEACCESS(FE_region)(&fe_region);
+	Cmiss_mesh_destroy(&search_mesh);
+}
+
+void Computed_field_find_element_xi_bvh::FE_region_change(struct FE_region * /*fe_region*/,
+	struct FE_region_changes *changes, void *bvh_void)
+{
+	Computed_field_find_element_xi_bvh *bvh =
+		static_cast<Computed_field_find_element_xi_bvh *>(bvh_void);
+	if (changes && bvh && bvh->valid)
+	{
+		int change_summary = 0;
+		CHANGE_LOG_GET_CHANGE_SUMMARY(FE_node)(changes->fe_node_changes, &change_summary);
+		for (int dimension = 1; (dimension <= MAXIMUM_ELEMENT_XI_DIMENSIONS) &&
+			(!change_summary); ++dimension)
+		{
+			CHANGE_LOG_GET_CHANGE_SUMMARY(FE_element)(
+				FE_region_changes_get_FE_element_changes(changes, dimension), &change_summary);
+		}
+		if (change_summary)
+		{
+			bvh->valid = 0;
+		}
+	}
+}
+
+bool Computed_field_find_element_xi_bvh::is_valid_for(Cmiss_mesh_id mesh,
+	FE_value time_in) const
+{
+	// changes to the master mesh are caught by FE_region_change
+	return (valid && (time == time_in) && Cmiss_mesh_match(search_mesh, mesh) &&
+		(group_change_counter == Cmiss_mesh_get_group_change_counter_internal(mesh)));
+}
+
+int Computed_field_find_element_xi_bvh::build(struct Computed_field *field,
+	Cmiss_field_cache_id field_cache)
+{
+	for (std::vector<struct FE_element *>::iterator iter = elements.begin();
+		iter != elements.end(); ++iter)
+	{
+		DEACCESS(FE_element)(&(*iter));
+	}
+	elements.clear();
+	element_boxes.clear();
+	nodes.clear();
+	node_boxes.clear();
+	valid = 0;
+	group_change_counter = Cmiss_mesh_get_group_change_counter_internal(search_mesh);
+	/* sample field at corners of elements, plus midpoints if non-linear */
+	non_linear = Computed_field_is_non_linear(field);
+	int number_in_xi[MAXIMUM_ELEMENT_XI_DIMENSIONS];
+	for (int i = 0; i < MAXIMUM_ELEMENT_XI_DIMENSIONS; i++)
+	{
+		number_in_xi[i] = non_linear ? 2 : 1;
+	}
+	std::vector<FE_value> xi;
+	std::vector<FE_value> sample_values;
+	Cmiss_element_iterator_id iterator = Cmiss_mesh_create_element_iterator(search_mesh);
+	Cmiss_element_id element = 0;
+	while (0 != (element = Cmiss_element_iterator_next(iterator)))
+	{
+		struct FE_element_shape *shape = 0;
+		int number_of_xi_points = 0;
+		FE_value_triple *xi_points = 0;
+		const int dimension = get_FE_element_dimension(element);
+		if (get_FE_element_shape(element, &shape) &&
+			FE_element_shape_get_xi_points_cell_corners(shape, number_in_xi,
+				&number_of_xi_points, &xi_points) && (0 < number_of_xi_points))
+		{
+			xi.resize(number_of_xi_points*dimension);
+			for (int p = 0; p < number_of_xi_points; p++)
+			{
+				for (int i = 0; i < dimension; i++)
+				{
+					xi[p*dimension + i] = xi_points[p][i];
+				}
+			}
+			const int size = number_of_xi_points*number_of_values;
+			sample_values.resize(size);
+			/* elements field is not defined on are not searched */
+			if (CMISS_OK == Cmiss_field_evaluate_real_batch(field, field_cache, element,
+				number_of_xi_points, &(xi[0]), size, &(sample_values[0])))
+			{
+				const size_t offset = element_boxes.size();
+				element_boxes.resize(offset + 2*number_of_values);
+				FE_value *minimum = &(element_boxes[offset]);
+				FE_value *maximum = minimum + number_of_values;
+				FE_value max_range = 0.0;
+				for (int k = 0; k < number_of_values; k++)
+				{
+					minimum[k] = maximum[k] = sample_values[k];
+					for (int p = 1; p < number_of_xi_points; p++)
+					{
+						const FE_value value = sample_values[p*number_of_values + k];
+						if (value < minimum[k])
+							minimum[k] = value;
+						else if (value > maximum[k])
+							maximum[k] = value;
+					}
+					if ((maximum[k] - minimum[k]) > max_range)
+						max_range = maximum[k] - minimum[k];
+				}
+				/* tolerance for rounding, plus margin for curvature */
+				const FE_value margin = max_range*(non_linear ?
+					FIND_XI_BVH_NON_LINEAR_MARGIN : 1.0E-6);
+				for (int k = 0; k < number_of_values; k++)
+				{
+					minimum[k] -= margin;
+					maximum[k] += margin;
+				}
+				elements.push_back(ACCESS(FE_element)(element));
+			}
+		}
+		if (xi_points)
+		{
+			DEALLOCATE(xi_points);
+		}
+		Cmiss_element_destroy(&element);
+	}
+	Cmiss_element_iterator_destroy(&iterator);
+	const int number_of_elements = static_cast<int>(elements.size());
+	if (0 < number_of_elements)
+	{
+		std::vector<int> element_order(number_of_elements);
+		for (int i = 0; i < number_of_elements; i++)
+		{
+			element_order[i] = i;
+		}
+		nodes.reserve(2*(number_of_elements/FIND_XI_BVH_LEAF_SIZE + 1));
+		build_node(element_order, 0, number_of_elements);
+		/* reorder elements and their boxes to be contiguous in leaves */
+		std::vector<struct FE_element *> ordered_elements(number_of_elements);
+		std::vector<FE_value> ordered_element_boxes(element_boxes.size());
+		const int box_size = 2*number_of_values;
+		for (int i = 0; i < number_of_elements; i++)
+		{
+			ordered_elements[i] = elements[element_order[i]];
+			std::copy(element_boxes.begin() + element_order[i]*box_size,
+				element_boxes.begin() + (element_order[i] + 1)*box_size,
+				ordered_element_boxes.begin() + i*box_size);
+		}
+		elements.swap(ordered_elements);
+		element_boxes.swap(ordered_element_boxes);
+	}
+	valid = 1;
+	return 1;
+}
+
+/**
+ * Recursively add node enclosing element_order[first..first+count-1],
+ * partitioning at median of box centres along component of greatest extent.
+ * @return  Index of new node.
+ */
+int Computed_field_find_element_xi_bvh::build_node(std::vector<int>& element_order,
+	int first, int count)
+{
+	const int node_index = static_cast<int>(nodes.size());
+	const int box_size = 2*number_of_values;
+	Bvh_node node;
+	nodes.push_back(node);
+	node_boxes.resize(node_boxes.size() + box_size);
+	FE_value *minimum = &(node_boxes[node_index*box_size]);
+	FE_value *maximum = minimum + number_of_values;
+	for (int i = 0; i < count; i++)
+	{
+		const FE_value *element_box = &(element_boxes[element_order[first + i]*box_size]);
+		for (int k = 0; k < number_of_values; k++)
+		{
+			if ((0 == i) || (element_box[k] < minimum[k]))
+				minimum[k] = element_box[k];
+			if ((0 == i) || (element_box[number_of_values + k] > maximum[k]))
+				maximum[k] = element_box[number_of_values + k];
+		}
+	}
+	if (count <= FIND_XI_BVH_LEAF_SIZE)
+	{
+		nodes[node_index].first_element = first;
+		nodes[node_index].number_of_elements = count;
+		nodes[node_index].right_child = -1;
+	}
+	else
+	{
+		int split_component = 0;
+		for (int k = 1; k < number_of_values; k++)
+		{
+			if ((maximum[k] - minimum[k]) >
+				(maximum[split_component] - minimum[split_component]))
+			{
+				split_component = k;
+			}
+		}
+		const int left_count = count/2;
+		std::nth_element(element_order.begin() + first,
+			element_order.begin() + first + left_count,
+			element_order.begin() + first + count,
+			Element_box_centre_less(element_boxes, number_of_values, split_component));
+		build_node(element_order, first, left_count);
+		const int right_child = build_node(element_order, first + left_count, count - left_count);
+		nodes[node_index].first_element = -1;
+		nodes[node_index].number_of_elements = 0;
+		nodes[node_index].right_child = right_child;
+	}
+	return node_index;
+}
+
+/** @return  Square of distance from values to nearest point in box, 0 if inside */
+FE_value Computed_field_find_element_xi_bvh::box_distance_squared(
+	const FE_value *box, const FE_value *values) const
+{
+	FE_value distance_squared = 0.0;
+	for (int k = 0; k < number_of_values; k++)
+	{
+		FE_value delta = 0.0;
+		if (values[k] < box[k])
+			delta = box[k] - values[k];
+		else if (values[k] > box[number_of_values + k])
+			delta = values[k] - box[number_of_values + k];
+		distance_squared += delta*delta;
+	}
+	return distance_squared;
+}
+
+struct FE_element *Computed_field_find_element_xi_bvh::find(
+	Computed_field_iterative_find_element_xi_data& data)
+{
+	if (nodes.empty())
+		return 0;
+	const int box_size = 2*number_of_values;
+	const FE_value *values = data.values;
+	std::vector<int> stack;
+	stack.reserve(64);
+	/* first search only elements whose boxes contain values */
+	std::vector<char> searched(elements.size(), 0);
+	stack.push_back(0);
+	while (!stack.empty())
+	{
+		const int node_index = stack.back();
+		stack.pop_back();
+		if (0.0 < box_distance_squared(&(node_boxes[node_index*box_size]), values))
+			continue;
+		const Bvh_node& node = nodes[node_index];
+		if (node.number_of_elements)
+		{
+			for (int i = node.first_element; i < node.first_element + node.number_of_elements; i++)
+			{
+				if (0.0 < box_distance_squared(&(element_boxes[i*box_size]), values))
+					continue;
+				searched[i] = 1;
+				if (Computed_field_iterative_element_conditional(elements[i], &data))
+					return elements[i];
+			}
+		}
+		else
+		{
+			stack.push_back(node.right_child);
+			stack.push_back(node_index + 1);
+		}
+	}
+	/* boxes of non-linear fields are estimates which may miss curved parts of
+	 * elements, so an exact match may still be in any remaining element */
+	if (!(data.find_nearest_location || non_linear))
+		return 0;
+	/* search remaining elements whose boxes are nearer than nearest so far,
+	 * visiting nearer child first to tighten bound early */
+	stack.push_back(0);
+	while (!stack.empty())
+	{
+		const int node_index = stack.back();
+		stack.pop_back();
+		if (data.nearest_element && (box_distance_squared(&(node_boxes[node_index*box_size]),
+			values) >= data.nearest_element_distance_squared))
+		{
+			continue;
+		}
+		const Bvh_node& node = nodes[node_index];
+		if (node.number_of_elements)
+		{
+			for (int i = node.first_element; i < node.first_element + node.number_of_elements; i++)
+			{
+				if (searched[i] || (data.nearest_element && (box_distance_squared(
+					&(element_boxes[i*box_size]), values) >= data.nearest_element_distance_squared)))
+				{
+					continue;
+				}
+				searched[i] = 1;
+				if (Computed_field_iterative_element_conditional(elements[i], &data))
+					return elements[i];
+			}
+		}
+		else
+		{
+			const int left_child = node_index + 1;
+			if (box_distance_squared(&(node_boxes[left_child*box_size]), values) <
+				box_distance_squared(&(node_boxes[node.right_child*box_size]), values))
+			{
+				stack.push_back(node.right_child);
+				stack.push_back(left_child);
+			}
+			else
+			{
+				stack.push_back(left_child);
+				stack.push_back(node.right_child);
+			}
+		}
+	}
+	return 0;
+}
+
 int Computed_field_perform_find_element_xi(struct Computed_field *field,
 	Cmiss_field_cache_id field_cache,
 	const FE_value *values, int number_of_values,
@@ -457,8 +832,46 @@ int Computed_field_perform_find_element_xi(struct Computed_field *field,
 						}
 						find_element_xi_data.start_with_data_xi = 0;
 					}
+					/* Now try elements near values using bounding volume hierarchy */
+					if ((!*element_address) &&
+						(FIND_XI_BVH_MINIMUM_MESH_SIZE < Cmiss_mesh_get_size(search_mesh)))
+					{
+						const FE_value time = field_cache->getTime();
+						if (!(cache->bvh && cache->bvh->is_valid_for(search_mesh, time)))
+						{
+							delete cache->bvh;
+							cache->bvh = new Computed_field_find_element_xi_bvh(
+								search_mesh, time, number_of_values);
+							if (!cache->bvh->build(field, field_cache))
+							{
+								delete cache->bvh;
+								cache->bvh = 0;
+							}
+						}
+						if (cache->bvh)
+						{
+							*element_address = cache->bvh->find(find_element_xi_data);
+						}
+						else
+						{
+							/* fall back to trying every element */
+							Cmiss_element_iterator_id iterator = Cmiss_mesh_create_element_iterator(search_mesh);
+							Cmiss_element_id element = 0;
+							while (0 != (element = Cmiss_element_iterator_next(iterator)))
+							{
+								if (Computed_field_iterative_element_conditional(element, &find_element_xi_data))
+								{
+									*element_address = element;
+									Cmiss_element_destroy(&element);
+									break;
+								}
+								Cmiss_element_destroy(&element);
+							}
+							Cmiss_element_iterator_destroy(&iterator);
+						}
+					}
 					/* Now try every element */
-					if (!*element_address)
+					else if (!*element_address)
 					{
 						Cmiss_element_iterator_id iterator = Cmiss_mesh_create_element_iterator(search_mesh);
 						Cmiss_element_id element = 0;
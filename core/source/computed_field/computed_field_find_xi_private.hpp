@@ -44,6 +44,69 @@ Data structures and prototype functions needed for all find xi implementations.
 #if !defined (COMPUTED_FIELD_FIND_XI_PRIVATE_HPP)
 #define COMPUTED_FIELD_FIND_XI_PRIVATE_HPP
 
+#include <vector>
+
+struct Computed_field_iterative_find_element_xi_data;
+
+/***************************************************************************//**
+ * Bounding volume hierarchy of axis-aligned boxes enclosing the values of a
+ * field over each element of a search mesh at one time. Limits the elements
+ * find_element_xi must search to those whose boxes contain or are near to the
+ * values sought. Registers for changes to the mesh's FE_region and marks
+ * itself invalid when any nodes or elements change, so is rebuilt on next use.
+ */
+class Computed_field_find_element_xi_bvh
+{
+	struct Bvh_node
+	{
+		int first_element; // index into elements for leaf, -1 for branch
+		int number_of_elements; // 0 for branch
+		int right_child; // index of right child; left child follows branch
+	};
+
+	Cmiss_mesh_id search_mesh;
+	struct FE_region *fe_region;
+	FE_value time;
+	int number_of_values;
+	unsigned int group_change_counter; // of search_mesh when built
+	int non_linear; // if set boxes are estimates and may not enclose elements
+	int valid;
+	std::vector<struct FE_element *> elements; // accessed, reordered for leaves
+	std::vector<FE_value> element_boxes; // min then max of each value per element
+	std::vector<Bvh_node> nodes;
+	std::vector<FE_value> node_boxes; // min then max of each value per node
+
+	static void FE_region_change(struct FE_region *fe_region,
+		struct FE_region_changes *changes, void *bvh_void);
+
+	int build_node(std::vector<int>& element_order, int first, int count);
+
+	FE_value box_distance_squared(const FE_value *box, const FE_value *values) const;
+
+public:
+
+	Computed_field_find_element_xi_bvh(Cmiss_mesh_id search_mesh_in,
+		FE_value time_in, int number_of_values_in);
+
+	~Computed_field_find_element_xi_bvh();
+
+	/** @return  true if built and nothing changed since for mesh at time */
+	bool is_valid_for(Cmiss_mesh_id mesh, FE_value time_in) const;
+
+	/** Evaluates field over all elements of mesh to build hierarchy.
+	 * @return  1 on success, 0 on failure. */
+	int build(struct Computed_field *field, Cmiss_field_cache_id field_cache);
+
+	/**
+	 * Search elements whose boxes contain the values in data, then if
+	 * find_nearest_location is set, other elements which may be nearer than
+	 * the nearest found so far.
+	 * @return  Element with exact match, or NULL if none; nearest location is
+	 * returned in data if requested.
+	 */
+	struct FE_element *find(Computed_field_iterative_find_element_xi_data& data);
+};
+
 class Computed_field_find_element_xi_base_cache
 {
 	Cmiss_mesh_id search_mesh;
@@ -57,7 +120,8 @@ public:
 	int in_perform_find_element_xi;
 	FE_value xi[MAXIMUM_ELEMENT_XI_DIMENSIONS];
 	/* Warn when trying to destroy this cache as it is being filled in */
-	
+	Computed_field_find_element_xi_bvh *bvh;
+
 	Computed_field_find_element_xi_base_cache() :
 		search_mesh(0),
 		element((struct FE_element *)NULL),
@@ -66,12 +130,14 @@ public:
 		time(0),
 		values((FE_value *)NULL),
 		working_values((FE_value *)NULL),
-		in_perform_find_element_xi(0)
+		in_perform_find_element_xi(0),
+		bvh(0)
 	{
 	}
 	
 	virtual ~Computed_field_find_element_xi_base_cache()
 	{
+		delete bvh;
 		if (search_mesh)
 		{
 			Cmiss_mesh_destroy(&search_mesh);
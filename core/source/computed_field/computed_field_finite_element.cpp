@@ -41,6 +41,9 @@ Implements a number of basic component wise operations on computed fields.
  * the terms of any one of the MPL, the GPL or the LGPL.
  *
  * ***** END LICENSE BLOCK ***** */
+#include <algorithm>
+#include <list>
+#include <map>
 #include <math.h>
 #include "zinc/fieldmodule.h"
 #include "zinc/fieldfiniteelement.h"
@@ -61,6 +64,7 @@ Implements a number of basic component wise operations on computed fields.
 #include "computed_field/field_module.hpp"
 #include "general/enumerator_conversion.hpp"
 #include "mesh/cmiss_element_private.hpp"
+#include "time/time_keeper.h"
 
 #if defined (DEBUG_CODE)
 /* SAB This field is useful for debugging when things don't clean up properly
@@ -87,24 +91,109 @@ DESCRIPTION :
 
 namespace {
 
+/***************************************************************************//**
+ * Least-recently-used cache of FE_element_field_values for a single FE_field,
+ * indexed by element. Element field values are expensive to calculate so are
+ * kept for a limited number of elements, discarding the least recently used
+ * values when full.
+ */
+class FE_element_field_values_cache
+{
+	typedef std::pair<FE_element *, FE_element_field_values *> Entry;
+	typedef std::list<Entry> Entry_list;
+	typedef std::map<FE_element *, Entry_list::iterator> Element_map;
+
+	Entry_list entries; // most recently used first
+	Element_map element_map;
+	int number_of_entries; // std::list::size() is not constant time
+
+	void remove_entry(Entry_list::iterator entry)
+	{
+		element_map.erase(entry->first);
+		DESTROY(FE_element_field_values)(&(entry->second));
+		entries.erase(entry);
+		--number_of_entries;
+	}
+
+public:
+
+	FE_element_field_values_cache() :
+		number_of_entries(0)
+	{
+	}
+
+	~FE_element_field_values_cache()
+	{
+		clear();
+	}
+
+	/** @return  Values for element, made most recently used, or 0 if none */
+	FE_element_field_values *find(FE_element *element)
+	{
+		Element_map::iterator iter = element_map.find(element);
+		if (iter == element_map.end())
+			return 0;
+		if (iter->second != entries.begin())
+			entries.splice(entries.begin(), entries, iter->second);
+		return iter->second->second;
+	}
+
+	/** Adds values for element as most recently used, first discarding least
+	 * recently used values so no more than maximumSize are held.
+	 * Cache takes ownership of values. */
+	void add(FE_element *element, FE_element_field_values *values, int maximumSize)
+	{
+		trim((maximumSize > 1) ? (maximumSize - 1) : 0);
+		entries.push_front(Entry(element, values));
+		element_map[element] = entries.begin();
+		++number_of_entries;
+	}
+
+	void remove(FE_element *element)
+	{
+		Element_map::iterator iter = element_map.find(element);
+		if (iter != element_map.end())
+			remove_entry(iter->second);
+	}
+
+	/** Discards least recently used values until no more than maximumSize */
+	void trim(int maximumSize)
+	{
+		while (number_of_entries > maximumSize)
+		{
+			Entry_list::iterator last = entries.end();
+			--last;
+			remove_entry(last);
+		}
+	}
+
+	void clear()
+	{
+		trim(0);
+	}
+
+};
+
 /***************************************************************************//**
  * Establishes the FE_element_field values necessary for evaluating field in
  * element at time, inherited from optional top_level_element. Uses existing
- * values in cache if nothing changed.
+ * values in cache if nothing changed. Records cache hits and misses and limits
+ * size of field_values_cache to the element field values cache size in the
+ * parent field cache.
  * @param calculate_derivatives  Controls whether basis functions for
  * derivatives are also evaluated.
  * @param differential_order  Optional order to differentiate monomials by.
  * @param differential_xi_indices  Which xi indices to differentiate.
  */
-int calculate_FE_element_field_values_for_element(
-	LIST(FE_element_field_values) *field_values_cache,
+int calculate_FE_element_field_values_for_element(Cmiss_field_cache& cache,
+	FE_element_field_values_cache& field_values_cache,
 	FE_element_field_values* &fe_element_field_values,
 	FE_field *fe_field, int calculate_derivatives, struct FE_element *element,
 	FE_value time, struct FE_element *top_level_element, int differential_order = 0,
 	int *differential_xi_indices = 0)
 {
 	int return_code = 1;
-	if (field_values_cache && fe_field && element)
+	if (fe_field && element)
 	{
 		/* ensure we have FE_element_field_values for element, with
 			 derivatives_calculated if requested */
@@ -116,8 +205,7 @@ int calculate_FE_element_field_values_for_element(
 		{
 			int need_update = 0;
 			int need_to_add_to_list = 0;
-			if (!(fe_element_field_values = FIND_BY_IDENTIFIER_IN_LIST(
-				FE_element_field_values, element)(element, field_values_cache)))
+			if (!(fe_element_field_values = field_values_cache.find(element)))
 			{
 				need_update = 1;
 				fe_element_field_values = CREATE(FE_element_field_values)();
@@ -143,6 +231,7 @@ int calculate_FE_element_field_values_for_element(
 			}
 			if (return_code && need_update)
 			{
+				cache.elementFieldValuesCacheMiss();
 				/* note that FE_element_field_values accesses the element */
 				if (calculate_FE_element_field_values(element,fe_field,
 						time,calculate_derivatives,fe_element_field_values,
@@ -157,23 +246,32 @@ int calculate_FE_element_field_values_for_element(
 
 					if (need_to_add_to_list)
 					{
-						/* Set a cache size limit */
-						if (1000 < NUMBER_IN_LIST(FE_element_field_values)(field_values_cache))
-						{
-							REMOVE_ALL_OBJECTS_FROM_LIST(FE_element_field_values)
-								(field_values_cache);
-						}
-						return_code = ADD_OBJECT_TO_LIST(FE_element_field_values)(
-							fe_element_field_values, field_values_cache);
+						field_values_cache.add(element, fe_element_field_values,
+							cache.getElementFieldValuesCacheSize());
 					}
 				}
 				else
 				{
-					/* clear element to indicate that values are clear */
-					clear_FE_element_field_values(fe_element_field_values);
+					if (need_to_add_to_list)
+					{
+						DESTROY(FE_element_field_values)(&fe_element_field_values);
+					}
+					else
+					{
+						field_values_cache.remove(element);
+					}
+					fe_element_field_values = (FE_element_field_values *)NULL;
 					return_code=0;
 				}
 			}
+			else if (return_code)
+			{
+				cache.elementFieldValuesCacheHit();
+			}
+		}
+		else
+		{
+			cache.elementFieldValuesCacheHit();
 		}
 	}
 	else
@@ -183,29 +281,171 @@ int calculate_FE_element_field_values_for_element(
 	return (return_code);
 }
 
+/***************************************************************************//**
+ * Evaluates derivatives of a finite element field in an element with respect
+ * to the DOFs at the element's nodes. Field values are linear in the nodal
+ * parameters, so each derivative is the standard basis evaluated at xi,
+ * weighted by the products of blending matrix and scale factors mapping that
+ * nodal parameter to the basis. These weights are kept for one element at a
+ * time. Nodes are not modified, and component modify functions are ignored as
+ * they do not change derivatives.
+ */
+class FE_element_field_dof_derivatives
+{
+	FE_element *element;
+	FE_element *top_level_element;
+	FE_value time;
+	const FieldDofMap *dofMap;
+	// for each component, NULL if not node-based
+	std::vector<FE_element_field_component_nodal_value_map *> componentMaps;
+	// for each component, DOF index for each nodal value in map, or -1 if not a DOF
+	std::vector<std::vector<int> > componentDofIndexes;
+	std::vector<FE_value> basisValues;
+
+public:
+	FE_element_field_dof_derivatives() :
+		element(0),
+		top_level_element(0),
+		time(0.0),
+		dofMap(0)
+	{
+	}
+
+	~FE_element_field_dof_derivatives()
+	{
+		clear();
+	}
+
+	void clear()
+	{
+		for (std::vector<FE_element_field_component_nodal_value_map *>::iterator iter =
+			componentMaps.begin(); iter != componentMaps.end(); ++iter)
+		{
+			delete *iter;
+		}
+		componentMaps.clear();
+		componentDofIndexes.clear();
+		if (element)
+			DEACCESS(FE_element)(&element);
+		if (top_level_element)
+			DEACCESS(FE_element)(&top_level_element);
+		dofMap = 0;
+	}
+
+	int evaluate(FE_field *fe_field, FE_element *element_in,
+		FE_element *top_level_element_in, FE_value time_in, const FE_value *xi,
+		const FieldDofMap& dofMap_in, FieldDofDerivatives& derivatives);
+
+private:
+	int calculate(FE_field *fe_field, FE_element *element_in,
+		FE_element *top_level_element_in, FE_value time_in, const FieldDofMap& dofMap_in);
+};
+
+/** Calculates nodal value maps for element and the DOF index of each nodal value */
+int FE_element_field_dof_derivatives::calculate(FE_field *fe_field,
+	FE_element *element_in, FE_element *top_level_element_in, FE_value time_in,
+	const FieldDofMap& dofMap_in)
+{
+	clear();
+	if (!calculate_FE_element_field_nodal_value_maps(element_in, fe_field, time_in,
+		top_level_element_in, componentMaps))
+	{
+		return 0;
+	}
+	const size_t componentCount = componentMaps.size();
+	componentDofIndexes.resize(componentCount);
+	for (size_t c = 0; c < componentCount; ++c)
+	{
+		FE_element_field_component_nodal_value_map *componentMap = componentMaps[c];
+		if (componentMap)
+		{
+			const size_t valueCount = componentMap->value_storages.size();
+			std::vector<int>& dofIndexes = componentDofIndexes[c];
+			dofIndexes.resize(valueCount);
+			for (size_t v = 0; v < valueCount; ++v)
+			{
+				dofIndexes[v] = dofMap_in.getDofIndex(componentMap->value_storages[v]);
+			}
+		}
+	}
+	element = ACCESS(FE_element)(element_in);
+	if (top_level_element_in)
+		top_level_element = ACCESS(FE_element)(top_level_element_in);
+	time = time_in;
+	dofMap = &dofMap_in;
+	return 1;
+}
+
+int FE_element_field_dof_derivatives::evaluate(FE_field *fe_field,
+	FE_element *element_in, FE_element *top_level_element_in, FE_value time_in,
+	const FE_value *xi, const FieldDofMap& dofMap_in, FieldDofDerivatives& derivatives)
+{
+	if ((!element) || (element_in != element) ||
+		(top_level_element_in != top_level_element) || (time_in != time) ||
+		(&dofMap_in != dofMap))
+	{
+		if (!calculate(fe_field, element_in, top_level_element_in, time_in, dofMap_in))
+			return 0;
+	}
+	int componentCount = derivatives.getComponentCount();
+	if (componentCount > static_cast<int>(componentMaps.size()))
+		componentCount = static_cast<int>(componentMaps.size());
+	for (int c = 0; c < componentCount; ++c)
+	{
+		FE_element_field_component_nodal_value_map *componentMap = componentMaps[c];
+		if (!componentMap)
+			continue;
+		const int basisCount = componentMap->number_of_basis_values;
+		if (static_cast<int>(basisValues.size()) < basisCount)
+			basisValues.resize(basisCount);
+		if (!componentMap->evaluate_basis(xi, &(basisValues[0])))
+			return 0;
+		const std::vector<int>& dofIndexes = componentDofIndexes[c];
+		const size_t valueCount = dofIndexes.size();
+		const FE_value *weights = (0 < valueCount) ? &(componentMap->weights[0]) : 0;
+		for (size_t v = 0; v < valueCount; ++v, weights += basisCount)
+		{
+			if (dofIndexes[v] < 0)
+				continue;
+			FE_value derivative = 0.0;
+			for (int j = 0; j < basisCount; ++j)
+			{
+				derivative += weights[j]*basisValues[j];
+			}
+			derivatives.getDofDerivatives(dofIndexes[v])[c] += derivative;
+		}
+	}
+	return 1;
+}
+
 class FiniteElementRealFieldValueCache : public RealFieldValueCache
 {
 public:
 	FE_element_field_values* fe_element_field_values; // cache for a single element at one time
 
 	/* Keep a cache of FE_element_field_values as calculation is expensive */
-	LIST(FE_element_field_values) *field_values_cache;
+	FE_element_field_values_cache field_values_cache;
+
+	/* created on demand for evaluating derivatives with respect to DOFs */
+	FE_element_field_dof_derivatives *dofDerivatives;
 
 	FiniteElementRealFieldValueCache(int componentCount) :
 		RealFieldValueCache(componentCount),
 		fe_element_field_values(0),
-		field_values_cache(CREATE(LIST(FE_element_field_values))())
+		dofDerivatives(0)
 	{
 	}
 
 	virtual ~FiniteElementRealFieldValueCache()
 	{
-		DESTROY(LIST(FE_element_field_values))(&field_values_cache);
+		delete dofDerivatives;
 	}
 
 	virtual void clear()
 	{
-		REMOVE_ALL_OBJECTS_FROM_LIST(FE_element_field_values)(field_values_cache);
+		field_values_cache.clear();
+		if (dofDerivatives)
+			dofDerivatives->clear();
 		// Following was a pointer to an object just destroyed, so must clear
 		fe_element_field_values = (FE_element_field_values *)NULL;
 		RealFieldValueCache::clear();
@@ -230,23 +470,21 @@ public:
 	FE_element_field_values* fe_element_field_values; // cache for a single element at one time
 
 	/* Keep a cache of FE_element_field_values as calculation is expensive */
-	LIST(FE_element_field_values) *field_values_cache;
+	FE_element_field_values_cache field_values_cache;
 
 	FiniteElementStringFieldValueCache() :
 		StringFieldValueCache(),
-		fe_element_field_values(0),
-		field_values_cache(CREATE(LIST(FE_element_field_values))())
+		fe_element_field_values(0)
 	{
 	}
 
 	virtual ~FiniteElementStringFieldValueCache()
 	{
-		DESTROY(LIST(FE_element_field_values))(&field_values_cache);
 	}
 
 	virtual void clear()
 	{
-		REMOVE_ALL_OBJECTS_FROM_LIST(FE_element_field_values)(field_values_cache);
+		field_values_cache.clear();
 		// Following was a pointer to an object just destroyed, so must clear
 		fe_element_field_values = (FE_element_field_values *)NULL;
 		StringFieldValueCache::clear();
@@ -313,6 +551,16 @@ private:
 
 	int evaluate(Cmiss_field_cache& cache, FieldValueCache& inValueCache);
 
+	virtual int evaluate_batch(Cmiss_field_cache& cache, RealFieldValueCache& valueCache);
+
+	virtual bool supports_dof_derivatives()
+	{
+		return (FE_VALUE_VALUE == get_FE_field_value_type(fe_field));
+	}
+
+	virtual int evaluate_dof_derivatives(Cmiss_field_cache& cache, const FieldDofMap& dofMap,
+		FieldDofDerivatives& derivatives);
+
 	int list();
 
 	char* get_command_string();
@@ -609,6 +857,79 @@ The FE_field must also not be in use.
 	return (return_code);
 } /* Computed_field_finite_element::not_in_use */
 
+/** Evaluates all points in a mesh location batch from a single lookup of the
+ * element field values; other batches are evaluated point by point. */
+int Computed_field_finite_element::evaluate_batch(Cmiss_field_cache& cache,
+	RealFieldValueCache& valueCache)
+{
+	Cmiss_element_id element = cache.getBatchElement();
+	enum Value_type value_type = get_FE_field_value_type(fe_field);
+	if ((!element) || ((value_type != FE_VALUE_VALUE) && (value_type != SHORT_VALUE)))
+		return Computed_field_core::evaluate_batch(cache, valueCache);
+	FiniteElementRealFieldValueCache& feValueCache = FiniteElementRealFieldValueCache::cast(valueCache);
+	if (!calculate_FE_element_field_values_for_element(cache,
+		feValueCache.field_values_cache, feValueCache.fe_element_field_values,
+		fe_field, /*calculate_derivatives*/0, element, cache.getTime(), /*top_level_element*/0))
+	{
+		return 0;
+	}
+	const int batchSize = cache.getBatchSize();
+	const int dimension = cache.getBatchDimension();
+	const int componentCount = field->number_of_components;
+	const FE_value *xi = cache.getBatchChartCoordinates();
+	FE_value *batchValues = feValueCache.batchValues;
+	for (int p = 0; p < batchSize; ++p)
+	{
+		/* component number -1 = calculate all components */
+		if (!calculate_FE_element_field(-1, feValueCache.fe_element_field_values,
+			xi, batchValues, (FE_value *)NULL))
+		{
+			return 0;
+		}
+		xi += dimension;
+		batchValues += componentCount;
+	}
+	return 1;
+}
+
+/** At nodes, each component value is a DOF. In elements, derivatives are
+ * evaluated from the weights mapping nodal values to the basis */
+int Computed_field_finite_element::evaluate_dof_derivatives(Cmiss_field_cache& cache,
+	const FieldDofMap& dofMap, FieldDofDerivatives& derivatives)
+{
+	Field_element_xi_location* element_xi_location;
+	Field_node_location *node_location;
+	if (0 != (element_xi_location = dynamic_cast<Field_element_xi_location*>(cache.getLocation())))
+	{
+		FiniteElementRealFieldValueCache& feValueCache =
+			FiniteElementRealFieldValueCache::cast(*(field->getValueCache(cache)));
+		if (!feValueCache.dofDerivatives)
+			feValueCache.dofDerivatives = new FE_element_field_dof_derivatives();
+		return feValueCache.dofDerivatives->evaluate(fe_field,
+			element_xi_location->get_element(), element_xi_location->get_top_level_element(),
+			element_xi_location->get_time(), element_xi_location->get_xi(), dofMap, derivatives);
+	}
+	else if (0 != (node_location = dynamic_cast<Field_node_location*>(cache.getLocation())))
+	{
+		FE_node *node = node_location->get_node();
+		if (!FE_field_is_defined_at_node(fe_field, node))
+			return 0;
+		for (int i = 0; i < field->number_of_components; ++i)
+		{
+			FE_value *storage = 0;
+			if (get_FE_nodal_FE_value_storage(node, fe_field, i, /*version_number*/0,
+				FE_NODAL_VALUE, node_location->get_time(), &storage))
+			{
+				const int dofIndex = dofMap.getDofIndex(storage);
+				if (0 <= dofIndex)
+					derivatives.getDofDerivatives(dofIndex)[i] += 1.0;
+			}
+		}
+		return 1;
+	}
+	return 0;
+}
+
 int Computed_field_finite_element::evaluate(Cmiss_field_cache& cache, FieldValueCache& inValueCache)
 {
 	int return_code = 0;
@@ -656,7 +977,7 @@ int Computed_field_finite_element::evaluate(Cmiss_field_cache& cache, FieldValue
 				FE_value time = element_xi_location->get_time();
 				const FE_value* xi = element_xi_location->get_xi();
 
-				return_code = calculate_FE_element_field_values_for_element(
+				return_code = calculate_FE_element_field_values_for_element(cache,
 					feStringValueCache.field_values_cache, feStringValueCache.fe_element_field_values,
 					fe_field, /*number_of_derivatives*/0, element, time, top_level_element);
 				if (return_code)
@@ -679,7 +1000,7 @@ int Computed_field_finite_element::evaluate(Cmiss_field_cache& cache, FieldValue
 				const FE_value* xi = element_xi_location->get_xi();
 				int number_of_derivatives = cache.getRequestedDerivatives();
 
-				return_code = calculate_FE_element_field_values_for_element(
+				return_code = calculate_FE_element_field_values_for_element(cache,
 					feValueCache.field_values_cache, feValueCache.fe_element_field_values,
 					fe_field, (0 < number_of_derivatives), element, time, top_level_element);
 				if (return_code)
@@ -826,7 +1147,7 @@ enum FieldAssignmentResult Computed_field_finite_element::assign(Cmiss_field_cac
 	FieldAssignmentResult result = FIELD_ASSIGNMENT_RESULT_ALL_VALUES_SET;
 	enum Value_type value_type = get_FE_field_value_type(fe_field);
 	Field_element_xi_location *element_xi_location;
-	Field_node_location *node_location;
+	Field_node_location *node_location = 0;
 	element_xi_location = dynamic_cast<Field_element_xi_location*>(cache.getLocation());
 	if (element_xi_location)
 	{
@@ -996,7 +1317,15 @@ enum FieldAssignmentResult Computed_field_finite_element::assign(Cmiss_field_cac
 	if (result != FIELD_ASSIGNMENT_RESULT_FAIL)
 	{
 		// clear this and dependent field caches due to DOFs changing (wasteful if data points changed):
-		field->clearCaches();
+		if (node_location)
+		{
+			FE_node *node = node_location->get_node();
+			field->clearCaches(1, &node);
+		}
+		else
+		{
+			field->clearCaches();
+		}
 		valueCache.derivatives_valid = 0;
 	}
 	return result;
@@ -1339,6 +1668,35 @@ int Cmiss_field_finite_element_destroy(
 	return Cmiss_field_destroy(reinterpret_cast<Cmiss_field_id *>(finite_element_field_address));
 }
 
+int Cmiss_field_finite_element_set_time_series(
+	Cmiss_field_finite_element_id finite_element_field,
+	Cmiss_time_keeper_id time_keeper, const char *file_name, int window_size)
+{
+	Cmiss_field_id field = reinterpret_cast<Cmiss_field_id>(finite_element_field);
+	Computed_field_finite_element *core = (field) ?
+		dynamic_cast<Computed_field_finite_element*>(field->core) : 0;
+	if (core && ((!file_name) || time_keeper))
+	{
+		return FE_region_set_FE_field_time_series(FE_field_get_FE_region(core->fe_field),
+			core->fe_field, time_keeper, file_name, window_size);
+	}
+	return 0;
+}
+
+int Cmiss_field_finite_element_write_time_series(
+	Cmiss_field_finite_element_id finite_element_field, const char *file_name)
+{
+	Cmiss_field_id field = reinterpret_cast<Cmiss_field_id>(finite_element_field);
+	Computed_field_finite_element *core = (field) ?
+		dynamic_cast<Computed_field_finite_element*>(field->core) : 0;
+	if (core && file_name)
+	{
+		return FE_region_write_FE_field_time_series(FE_field_get_FE_region(core->fe_field),
+			core->fe_field, file_name);
+	}
+	return 0;
+}
+
 Cmiss_field_id Cmiss_field_module_create_stored_mesh_location(
 	Cmiss_field_module_id field_module, Cmiss_mesh_id mesh)
 {
@@ -2061,10 +2419,10 @@ enum FieldAssignmentResult Computed_field_node_value::assign(Cmiss_field_cache&
 		{
 			return FIELD_ASSIGNMENT_RESULT_ALL_VALUES_SET;
 		}
+		FE_node *node = node_location->get_node();
 		// clear finite element field cache due to DOFs changing (wasteful if data points changed):
-		finite_element_field->clearCaches();
+		finite_element_field->clearCaches(1, &node);
 		FieldAssignmentResult result = FIELD_ASSIGNMENT_RESULT_ALL_VALUES_SET;
-		FE_node *node = node_location->get_node();
 		FE_value time = node_location->get_time();
 		enum Value_type value_type = get_FE_field_value_type(fe_field);
 		for (int i=0; (i<field->number_of_components); i++)
@@ -2372,6 +2730,16 @@ private:
 
 	int evaluate(Cmiss_field_cache& cache, FieldValueCache& inValueCache);
 
+	/** Only supported for stored mesh locations, which do not depend on DOFs */
+	virtual bool supports_dof_derivatives()
+	{
+		return getSourceField(0)->supportsDofDerivatives() &&
+			Computed_field_is_type_finite_element(getSourceField(1));
+	}
+
+	virtual int evaluate_dof_derivatives(Cmiss_field_cache& cache, const FieldDofMap& dofMap,
+		FieldDofDerivatives& derivatives);
+
 	int list();
 
 	char* get_command_string();
@@ -2423,6 +2791,20 @@ int Computed_field_embedded::evaluate(Cmiss_field_cache& cache, FieldValueCache&
 	return 0;
 }
 
+int Computed_field_embedded::evaluate_dof_derivatives(Cmiss_field_cache& cache,
+	const FieldDofMap& dofMap, FieldDofDerivatives& derivatives)
+{
+	MeshLocationFieldValueCache *meshLocationValueCache = MeshLocationFieldValueCache::cast(getSourceField(1)->evaluate(cache));
+	if (meshLocationValueCache)
+	{
+		Cmiss_field_cache& extraCache = *(field->getValueCache(cache)->getExtraCache());
+		extraCache.setMeshLocation(meshLocationValueCache->element, meshLocationValueCache->xi);
+		extraCache.setTime(cache.getTime());
+		return getSourceField(0)->evaluateDofDerivatives(extraCache, dofMap, derivatives);
+	}
+	return 0;
+}
+
 int Computed_field_embedded::list()
 {
 	int return_code;
@@ -3256,7 +3638,7 @@ int Computed_field_basis_derivative::evaluate(Cmiss_field_cache& cache, FieldVal
 		const FE_value* xi = element_xi_location->get_xi();
 		int number_of_derivatives = cache.getRequestedDerivatives();
 
-		if (calculate_FE_element_field_values_for_element(
+		if (calculate_FE_element_field_values_for_element(cache,
 			feValueCache.field_values_cache, feValueCache.fe_element_field_values,
 			fe_field, /*derivatives_required*/1, element, time, top_level_element, order, xi_indices))
 		{
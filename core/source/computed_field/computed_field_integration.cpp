@@ -58,7 +58,6 @@ and the nodes for 1D elements.
 #include "general/debug.h"
 #include "general/mystring.h"
 #include "general/indexed_list_private.h"
-#include "general/indexed_multi_range.h"
 #include "general/list_private.h"
 #include "general/message.h"
 #include "computed_field/computed_field_integration.h"
@@ -378,7 +377,6 @@ private:
 		Computed_field_element_integration_mapping_fifo **last_to_be_checked,
 		Computed_field *integrand,
 		int magnitude_coordinates, Computed_field *coordinate_field,
-		LIST(Index_multi_range) **node_element_list,
 		LIST(Computed_field_element_integration_mapping) *previous_texture_mapping,
 		ZnReal time_step,
 		LIST(Computed_field_node_integration_mapping) *node_mapping);
@@ -516,7 +514,6 @@ int Computed_field_integration::add_neighbours(Cmiss_field_cache& workingCache,
 	Computed_field_element_integration_mapping_fifo **last_to_be_checked,
 	Computed_field *integrand,
 	int magnitude_coordinates, Computed_field *coordinate_field,
-	LIST(Index_multi_range) **node_element_list,
 	LIST(Computed_field_element_integration_mapping) *previous_texture_mapping,
 	ZnReal time_step,
 	LIST(Computed_field_node_integration_mapping) *node_mapping)
@@ -566,15 +563,10 @@ time is supplied in the workingCache.
 		{
 			if (element_dimension == 1)
 			{
-				if(!(*node_element_list))
-				{
-					/* If we have 1D elements then we use the nodes to get to the
-						adjacent elements, normally use the faces */
-					*node_element_list = create_node_element_list(mesh);
-				}
+				/* If we have 1D elements then we use the nodes to get to the
+					adjacent elements, normally use the faces */
 				if (!(adjacent_FE_element_from_nodes(mapping_item->element, i,
-					&number_of_neighbour_elements, &neighbour_elements, *node_element_list,
-					mesh)))
+					&number_of_neighbour_elements, &neighbour_elements, mesh)))
 				{
 					number_of_neighbour_elements = 0;
 				}
@@ -791,7 +783,6 @@ int Computed_field_integration::calculate_mapping(FE_value time)
 	Computed_field_element_integration_mapping *mapping_item;
 	Computed_field_element_integration_mapping_fifo *fifo_node,
 		*first_to_be_checked, *last_to_be_checked;
-	LIST(Index_multi_range) *node_element_list;
 
 	if (field && (integrand = field->source_fields[0])
 		&& (coordinate_field = field->source_fields[1]))
@@ -803,7 +794,6 @@ int Computed_field_integration::calculate_mapping(FE_value time)
 		return_code = 1;
 		first_to_be_checked=last_to_be_checked=
 			(Computed_field_element_integration_mapping_fifo *)NULL;
-		node_element_list=(LIST(Index_multi_range) *)NULL;
 		if ((texture_mapping = CREATE_LIST(Computed_field_element_integration_mapping)())
 			&& (node_mapping = CREATE_LIST(Computed_field_node_integration_mapping)()))
 		{
@@ -836,7 +826,6 @@ int Computed_field_integration::calculate_mapping(FE_value time)
 						first_to_be_checked->mapping_item, texture_mapping,
 						&last_to_be_checked, integrand,
 						magnitude_coordinates, coordinate_field,
-						&node_element_list,
 						(LIST(Computed_field_element_integration_mapping) *)NULL,
 						0.0, node_mapping);
 
@@ -882,10 +871,6 @@ int Computed_field_integration::calculate_mapping(FE_value time)
 			{
 				DESTROY_LIST(Computed_field_element_integration_mapping)(&texture_mapping);
 			}
-			if (node_element_list)
-			{
-				DESTROY_LIST(Index_multi_range)(&node_element_list);
-			}
 		}
 		else
 		{
@@ -40,17 +40,25 @@
  * ***** END LICENSE BLOCK ***** */
 #include <cmath>
 #include <iostream>
+#include <map>
+#include <vector>
+#include "zinc/zincconfigure.h"
+#if defined (USE_OPENMP)
+#include <omp.h>
+#endif /* defined (USE_OPENMP) */
 #include "computed_field/computed_field_private.hpp"
 #include "computed_field/computed_field_nodeset_operators.hpp"
 #include "computed_field/field_module.hpp"
 #include "mesh/cmiss_node_private.hpp"
 #include "zinc/fieldnodesetoperators.h"
+#include "zinc/status.h"
 #include "computed_field/computed_field.h"
 #include "computed_field/computed_field_set.h"
 #include "region/cmiss_region.h"
 #include "general/debug.h"
 #include "general/mystring.h"
 #include "general/message.h"
+#include "general/mutex.hpp"
 #include "finite_element/finite_element_region.h"
 using namespace std;
 
@@ -62,23 +70,860 @@ namespace {
 
 const char computed_field_nodeset_operator_type_string[] = "nodeset_operator";
 
+/**
+ * @return  true if the value of field at a node depends only on that node's
+ * field values, so a change to other nodes or elements cannot change it.
+ */
+bool Computed_field_is_node_local(Computed_field *field)
+{
+	static const char *node_local_type_strings[] =
+	{
+		"abs", "acos", "add", "and", "asin", "atan", "atan2", "clamp_maximum",
+		"clamp_minimum", "cmiss_number", "composite", "constant",
+		"coordinate_transformation", "cos", "cross_product", "determinant",
+		"divide_components", "dot_product", "edit_mask", "eigenvalues",
+		"eigenvectors", "equal_to", "exp", "finite_element", "greater_than", "if",
+		"is_defined", "less_than", "log", "magnitude", "matrix_invert",
+		"matrix_multiply", "matrix_to_quaternion", "multiply_components",
+		"node_value", "normalise", "not", "offset", "or", "power", "projection",
+		"quaternion_to_matrix", "scale", "sin", "sqrt", "sum_components", "tan",
+		"transpose", "vector_coordinate_transformation", "xor"
+	};
+	const int number_of_node_local_types =
+		sizeof(node_local_type_strings) / sizeof(node_local_type_strings[0]);
+	const char *type_string = field->core->get_type_string();
+	int i;
+	for (i = 0; i < number_of_node_local_types; ++i)
+	{
+		if (0 == strcmp(type_string, node_local_type_strings[i]))
+			break;
+	}
+	if (i == number_of_node_local_types)
+		return false;
+	for (i = 0; i < field->number_of_source_fields; ++i)
+	{
+		if (!Computed_field_is_node_local(field->source_fields[i]))
+			return false;
+	}
+	return true;
+}
+
+/**
+ * @return  true if field or any field it depends on has changes not yet sent
+ * to clients of the field manager, i.e. while field module changes are cached.
+ */
+bool Computed_field_has_pending_changes(Computed_field *field)
+{
+	if (field->manager_change_status != MANAGER_CHANGE_NONE(Computed_field))
+		return true;
+	for (int i = 0; i < field->number_of_source_fields; ++i)
+	{
+		if (Computed_field_has_pending_changes(field->source_fields[i]))
+			return true;
+	}
+	return false;
+}
+
+/**
+ * Evaluates source field at nodes[first] up to but not including nodes[limit]
+ * using field cache. Writes number_of_components values per node to values,
+ * and 1 or 0 to defined for each node to indicate whether it is defined.
+ */
+void Computed_field_evaluate_at_nodes(Computed_field *source_field,
+	Cmiss_field_cache& field_cache, FE_node *const *nodes, size_t first, size_t limit,
+	int number_of_components, FE_value *values, char *defined)
+{
+	for (size_t n = first; n < limit; ++n)
+	{
+		field_cache.setNode(nodes[n]);
+		RealFieldValueCache* sourceValueCache = static_cast<RealFieldValueCache*>(source_field->evaluate(field_cache));
+		FE_value *node_values = values + n*number_of_components;
+		if (sourceValueCache)
+		{
+			for (int i = 0; i < number_of_components; i++)
+			{
+				node_values[i] = sourceValueCache->values[i];
+			}
+		}
+		defined[n] = (0 != sourceValueCache);
+	}
+}
+
+/**
+ * Cache of source field values at the nodes of a nodeset operator, kept up to
+ * date from FE_region change messages so only added or changed nodes are
+ * re-evaluated. For the master nodeset the sums and sums of squares are also
+ * updated incrementally. All terms are discarded when the source field or its
+ * dependencies change, for time-varying source fields at a new time, when the
+ * node change log overflows, and on any region change if the source field is
+ * not node local. DOFs modified directly without notification, e.g. by
+ * optimisation, only invalidate the terms for their nodes when the source
+ * field is node local. Terms are re-evaluated while there are uncommunicated
+ * changes to the region or fields.
+ * Cached terms are shared by evaluations from field caches on any thread and
+ * guarded by a mutex, but the source field is evaluated with the mutex
+ * released. New values are only merged into the cache if no terms were
+ * invalidated meanwhile, as counted by change_counter.
+ * If number_of_threads is greater than 1, terms needing evaluation are split
+ * into contiguous chunks evaluated concurrently, each with its own field cache.
+ */
+class Nodeset_operator_term_cache
+{
+	Cmiss_nodeset_id nodeset; // not accessed: owned by nodeset operator
+	FE_region *fe_region; // nodeset FE_region: data FE_region for data nodesets
+	FE_region *master_fe_region; // only set for data nodesets
+	bool is_master_nodeset;
+	const int number_of_components;
+	// nodes are not accessed; removed nodes are erased in FE_region_change
+	std::map<FE_node *, int> term_indexes;
+	std::vector<FE_value> term_values;
+	std::vector<char> term_defined, term_valid;
+	std::vector<int> free_terms;
+	// invalid nodes not yet updated in master nodeset aggregates
+	std::vector<FE_node *> invalid_nodes;
+	int number_of_changed_nodes;
+	bool tracking; // true if terms are being kept up to date with changes
+	// while valid, aggregates are the sums over all defined terms
+	bool aggregates_valid;
+	bool node_local;
+	bool time_varying;
+	FE_value time;
+	// aggregates over master nodeset
+	std::vector<FE_value> sum, sum_squares;
+	int number_of_terms;
+	int number_of_incremental_updates;
+	// incremented whenever terms are invalidated, removed or cleared
+	unsigned int change_counter;
+	int number_of_threads;
+	Cmiss_mutex mutex;
+
+public:
+	Nodeset_operator_term_cache(Cmiss_nodeset_id nodeset_in, int number_of_components_in) :
+		nodeset(nodeset_in),
+		fe_region(ACCESS(FE_region)(Cmiss_nodeset_get_FE_region_internal(nodeset_in))),
+		master_fe_region(0),
+		is_master_nodeset(false),
+		number_of_components(number_of_components_in),
+		number_of_changed_nodes(0),
+		tracking(false),
+		aggregates_valid(false),
+		node_local(false),
+		time_varying(false),
+		time(0),
+		sum(number_of_components_in),
+		sum_squares(number_of_components_in),
+		number_of_terms(0),
+		number_of_incremental_updates(0),
+		change_counter(0),
+		number_of_threads(1)
+	{
+		Cmiss_nodeset_id master_nodeset = Cmiss_nodeset_get_master(nodeset);
+		is_master_nodeset = Cmiss_nodeset_match(nodeset, master_nodeset);
+		Cmiss_nodeset_destroy(&master_nodeset);
+		FE_region_add_callback(fe_region, Nodeset_operator_term_cache::FE_region_change, (void *)this);
+		if (FE_region_is_data_FE_region(fe_region))
+		{
+			FE_region_get_immediate_master_FE_region(fe_region, &master_fe_region);
+			if (master_fe_region)
+			{
+				ACCESS(FE_region)(master_fe_region);
+				FE_region_add_callback(master_fe_region, Nodeset_operator_term_cache::FE_region_change, (void *)this);
+			}
+		}
+	}
+
+	~Nodeset_operator_term_cache()
+	{
+		if (master_fe_region)
+		{
+			FE_region_remove_callback(master_fe_region, Nodeset_operator_term_cache::FE_region_change, (void *)this);
+			DEACCESS(FE_region)(&master_fe_region);
+		}
+		FE_region_remove_callback(fe_region, Nodeset_operator_term_cache::FE_region_change, (void *)this);
+		DEACCESS(FE_region)(&fe_region);
+	}
+
+	/** Discard all terms, e.g. after change to source field */
+	void invalidate()
+	{
+		Cmiss_mutex_scoped_lock scoped_lock(mutex);
+		clear();
+	}
+
+	void invalidate_nodes(int number_of_nodes, FE_node **nodes);
+
+	int evaluate_sums(Computed_field *source_field, Cmiss_field_cache& extra_cache,
+		FE_value *sum_values, FE_value *sum_squares_values);
+
+	int evaluate_terms(Computed_field *source_field, Cmiss_field_cache& extra_cache,
+		int number_of_values, FE_value *values);
+
+	int get_number_of_threads()
+	{
+		Cmiss_mutex_scoped_lock scoped_lock(mutex);
+		return number_of_threads;
+	}
+
+	void set_number_of_threads(int number_of_threads_in)
+	{
+		Cmiss_mutex_scoped_lock scoped_lock(mutex);
+		number_of_threads = number_of_threads_in;
+	}
+
+private:
+	void clear()
+	{
+		term_indexes.clear();
+		term_values.clear();
+		term_defined.clear();
+		term_valid.clear();
+		free_terms.clear();
+		invalid_nodes.clear();
+		tracking = false;
+		aggregates_valid = false;
+		++change_counter;
+	}
+
+	void prepare(Computed_field *source_field, FE_value time_in);
+
+	int get_term_index(FE_node *node);
+
+	int add_term(FE_node *node);
+
+	void invalidate_term(FE_node *node);
+
+	void remove_term(FE_node *node);
+
+	void store_term(int index, const FE_value *values, char defined);
+
+	void add_term_to_aggregates(int index, FE_value sign);
+
+	void sum_aggregates();
+
+	void get_nodes(std::vector<FE_node *>& nodes);
+
+	void evaluate_nodes(Computed_field *source_field, Cmiss_field_cache& extra_cache,
+		int evaluate_number_of_threads, const std::vector<FE_node *>& nodes,
+		std::vector<FE_value>& values, std::vector<char>& defined);
+
+	void get_node_values(Computed_field *source_field, Cmiss_field_cache& extra_cache,
+		std::vector<FE_value>& values, std::vector<char>& defined);
+
+	static int FE_node_change(FE_node *node, int change, void *term_cache_void);
+
+	static void FE_region_change(FE_region *fe_region_in, FE_region_changes *changes,
+		void *term_cache_void);
+};
+
+/** Discard all terms if they could be out of date */
+void Nodeset_operator_term_cache::prepare(Computed_field *source_field, FE_value time_in)
+{
+	if (FE_region_has_pending_changes(fe_region) ||
+		(master_fe_region && FE_region_has_pending_changes(master_fe_region)) ||
+		Computed_field_has_pending_changes(source_field))
+	{
+		clear();
+	}
+	else if (tracking && time_varying && (time_in != time))
+	{
+		clear();
+	}
+	if (!tracking)
+	{
+		node_local = Computed_field_is_node_local(source_field);
+		time_varying = (0 != Computed_field_has_multiple_times(source_field));
+		time = time_in;
+		tracking = true;
+	}
+}
+
+/**
+ * Marks terms for nodes whose DOFs were modified directly as needing
+ * re-evaluation. All terms are discarded if the source field is not node
+ * local as other terms may depend on those nodes.
+ */
+void Nodeset_operator_term_cache::invalidate_nodes(int number_of_nodes, FE_node **nodes)
+{
+	Cmiss_mutex_scoped_lock scoped_lock(mutex);
+	if (tracking)
+	{
+		if (node_local)
+		{
+			for (int i = 0; i < number_of_nodes; ++i)
+			{
+				if (FE_region_contains_FE_node(fe_region, nodes[i]))
+				{
+					invalidate_term(nodes[i]);
+				}
+			}
+		}
+		else
+		{
+			clear();
+		}
+	}
+}
+
+/** @return  Index of term for node, or -1 if none */
+int Nodeset_operator_term_cache::get_term_index(FE_node *node)
+{
+	std::map<FE_node *, int>::iterator iter = term_indexes.find(node);
+	if (iter != term_indexes.end())
+		return iter->second;
+	return -1;
+}
+
+/** @return  Index of term for node, adding an invalid undefined term if none */
+int Nodeset_operator_term_cache::add_term(FE_node *node)
+{
+	int index = get_term_index(node);
+	if (index < 0)
+	{
+		if (free_terms.empty())
+		{
+			index = static_cast<int>(term_defined.size());
+			term_values.resize(term_values.size() + number_of_components);
+			term_defined.push_back(0);
+			term_valid.push_back(0);
+		}
+		else
+		{
+			index = free_terms.back();
+			free_terms.pop_back();
+			term_defined[index] = 0;
+			term_valid[index] = 0;
+		}
+		term_indexes[node] = index;
+		if (aggregates_valid)
+			invalid_nodes.push_back(node);
+	}
+	return index;
+}
+
+/** Mark term for node as needing re-evaluation, adding it if new */
+void Nodeset_operator_term_cache::invalidate_term(FE_node *node)
+{
+	// always counted so values being evaluated for an invalid term are discarded
+	++change_counter;
+	const int index = add_term(node);
+	if (term_valid[index])
+	{
+		term_valid[index] = 0;
+		if (aggregates_valid)
+			invalid_nodes.push_back(node);
+	}
+}
+
+void Nodeset_operator_term_cache::remove_term(FE_node *node)
+{
+	++change_counter;
+	std::map<FE_node *, int>::iterator iter = term_indexes.find(node);
+	if (iter != term_indexes.end())
+	{
+		const int index = iter->second;
+		if (aggregates_valid && term_defined[index])
+		{
+			add_term_to_aggregates(index, -1.0);
+			--number_of_terms;
+		}
+		free_terms.push_back(index);
+		term_indexes.erase(iter);
+	}
+}
+
+/**
+ * Stores newly evaluated values for term and marks it valid. If aggregates
+ * are valid the old term is subtracted from them and the new term added.
+ * @param values  Source field values, only used if defined.
+ */
+void Nodeset_operator_term_cache::store_term(int index, const FE_value *values, char defined)
+{
+	if (aggregates_valid && term_defined[index])
+	{
+		add_term_to_aggregates(index, -1.0);
+		--number_of_terms;
+	}
+	if (defined)
+	{
+		FE_value *store_values = &(term_values[index*number_of_components]);
+		for (int i = 0; i < number_of_components; i++)
+		{
+			store_values[i] = values[i];
+		}
+	}
+	term_defined[index] = defined;
+	term_valid[index] = 1;
+	if (aggregates_valid)
+	{
+		if (defined)
+		{
+			add_term_to_aggregates(index, 1.0);
+			++number_of_terms;
+		}
+		++number_of_incremental_updates;
+	}
+}
+
+void Nodeset_operator_term_cache::add_term_to_aggregates(int index, FE_value sign)
+{
+	const FE_value *values = &(term_values[index*number_of_components]);
+	for (int i = 0; i < number_of_components; i++)
+	{
+		sum[i] += sign*values[i];
+		sum_squares[i] += sign*values[i]*values[i];
+	}
+}
+
+/** Recalculates aggregates from all defined terms, limiting round-off error
+ * accumulated by incremental updates. */
+void Nodeset_operator_term_cache::sum_aggregates()
+{
+	for (int i = 0; i < number_of_components; i++)
+	{
+		sum[i] = 0.0;
+		sum_squares[i] = 0.0;
+	}
+	number_of_terms = 0;
+	for (std::map<FE_node *, int>::iterator iter = term_indexes.begin();
+		iter != term_indexes.end(); ++iter)
+	{
+		if (term_defined[iter->second])
+		{
+			add_term_to_aggregates(iter->second, 1.0);
+			++number_of_terms;
+		}
+	}
+	number_of_incremental_updates = 0;
+}
+
+/** Gets nodes in nodeset in iteration order. Call without mutex locked. */
+void Nodeset_operator_term_cache::get_nodes(std::vector<FE_node *>& nodes)
+{
+	nodes.clear();
+	Cmiss_node_iterator_id iterator = Cmiss_nodeset_create_node_iterator(nodeset);
+	Cmiss_node_id node = 0;
+	while (0 != (node = Cmiss_node_iterator_next_non_access(iterator)))
+	{
+		nodes.push_back(node);
+	}
+	Cmiss_node_iterator_destroy(&iterator);
+}
+
+/**
+ * Evaluates source field at nodes, in parallel if evaluate_number_of_threads
+ * is greater than 1 and there are enough nodes. Call without mutex locked.
+ * Parallel execution requires build with USE_OPENMP; otherwise chunks are
+ * evaluated serially.
+ * @param values  Resized to receive number_of_components values per node.
+ * @param defined  Resized to receive 1 for nodes source field is defined at,
+ * 0 otherwise.
+ */
+void Nodeset_operator_term_cache::evaluate_nodes(Computed_field *source_field,
+	Cmiss_field_cache& extra_cache, int evaluate_number_of_threads,
+	const std::vector<FE_node *>& nodes, std::vector<FE_value>& values,
+	std::vector<char>& defined)
+{
+	const size_t number_of_nodes = nodes.size();
+	values.resize(number_of_nodes*number_of_components);
+	defined.resize(number_of_nodes);
+	if (0 == number_of_nodes)
+		return;
+	// not worth the overhead of a field cache per chunk for few nodes
+	const size_t minimum_nodes_per_chunk = 64;
+	int number_of_chunks = evaluate_number_of_threads;
+	if (static_cast<size_t>(number_of_chunks) > number_of_nodes / minimum_nodes_per_chunk)
+		number_of_chunks = static_cast<int>(number_of_nodes / minimum_nodes_per_chunk);
+	if (number_of_chunks < 2)
+	{
+		Computed_field_evaluate_at_nodes(source_field, extra_cache, &(nodes[0]), 0,
+			number_of_nodes, number_of_components, &(values[0]), &(defined[0]));
+		return;
+	}
+	// create caches serially as they are registered with the region
+	std::vector<Cmiss_field_cache_id> chunk_caches(number_of_chunks);
+	for (int chunk = 0; chunk < number_of_chunks; ++chunk)
+	{
+		chunk_caches[chunk] = new Cmiss_field_cache(extra_cache.getRegion());
+		chunk_caches[chunk]->setTime(extra_cache.getTime());
+	}
+#if defined (USE_OPENMP)
+#pragma omp parallel for num_threads(number_of_chunks) schedule(static, 1)
+#endif /* defined (USE_OPENMP) */
+	for (int chunk = 0; chunk < number_of_chunks; ++chunk)
+	{
+		const size_t first = (number_of_nodes*chunk) / number_of_chunks;
+		const size_t limit = (number_of_nodes*(chunk + 1)) / number_of_chunks;
+		Computed_field_evaluate_at_nodes(source_field, *(chunk_caches[chunk]), &(nodes[0]),
+			first, limit, number_of_components, &(values[0]), &(defined[0]));
+	}
+	for (int chunk = 0; chunk < number_of_chunks; ++chunk)
+	{
+		Cmiss_field_cache::deaccess(chunk_caches[chunk]);
+	}
+}
+
+/**
+ * Gets values of source field at all nodes in nodeset in iteration order,
+ * using cached terms where valid. Remaining nodes are evaluated with the mutex
+ * released, and stored as terms if no terms were invalidated meanwhile.
+ * @param values  Resized to receive number_of_components values per node.
+ * @param defined  Resized to receive 1 for nodes source field is defined at,
+ * 0 otherwise.
+ */
+void Nodeset_operator_term_cache::get_node_values(Computed_field *source_field,
+	Cmiss_field_cache& extra_cache, std::vector<FE_value>& values,
+	std::vector<char>& defined)
+{
+	std::vector<FE_node *> nodes;
+	get_nodes(nodes);
+	const size_t number_of_nodes = nodes.size();
+	values.resize(number_of_nodes*number_of_components);
+	defined.resize(number_of_nodes);
+	std::vector<size_t> evaluate_node_numbers;
+	std::vector<FE_node *> evaluate_nodes_list;
+	mutex.lock();
+	prepare(source_field, extra_cache.getTime());
+	for (size_t n = 0; n < number_of_nodes; ++n)
+	{
+		const int index = get_term_index(nodes[n]);
+		if ((index >= 0) && term_valid[index])
+		{
+			defined[n] = term_defined[index];
+			if (defined[n])
+			{
+				const FE_value *source_values = &(term_values[index*number_of_components]);
+				FE_value *node_values = &(values[n*number_of_components]);
+				for (int i = 0; i < number_of_components; i++)
+				{
+					node_values[i] = source_values[i];
+				}
+			}
+		}
+		else
+		{
+			evaluate_node_numbers.push_back(n);
+			evaluate_nodes_list.push_back(nodes[n]);
+		}
+	}
+	const unsigned int start_change_counter = change_counter;
+	const int evaluate_number_of_threads = number_of_threads;
+	mutex.unlock();
+	const size_t number_of_evaluate_nodes = evaluate_nodes_list.size();
+	if (0 < number_of_evaluate_nodes)
+	{
+		std::vector<FE_value> evaluate_values;
+		std::vector<char> evaluate_defined;
+		evaluate_nodes(source_field, extra_cache, evaluate_number_of_threads,
+			evaluate_nodes_list, evaluate_values, evaluate_defined);
+		for (size_t e = 0; e < number_of_evaluate_nodes; ++e)
+		{
+			const size_t n = evaluate_node_numbers[e];
+			defined[n] = evaluate_defined[e];
+			if (defined[n])
+			{
+				const FE_value *source_values = &(evaluate_values[e*number_of_components]);
+				FE_value *node_values = &(values[n*number_of_components]);
+				for (int i = 0; i < number_of_components; i++)
+				{
+					node_values[i] = source_values[i];
+				}
+			}
+		}
+		Cmiss_mutex_scoped_lock scoped_lock(mutex);
+		if (change_counter == start_change_counter)
+		{
+			for (size_t e = 0; e < number_of_evaluate_nodes; ++e)
+			{
+				store_term(add_term(evaluate_nodes_list[e]),
+					&(evaluate_values[e*number_of_components]), evaluate_defined[e]);
+			}
+		}
+	}
+}
+
+/**
+ * Evaluates sum and/or sum of squares of source field over nodeset.
+ * @param sum_values  Optional array to receive sums of each component.
+ * @param sum_squares_values  Optional array to receive sums of squares of each
+ * component.
+ * @return  Number of nodes the source field is defined at.
+ */
+int Nodeset_operator_term_cache::evaluate_sums(Computed_field *source_field,
+	Cmiss_field_cache& extra_cache, FE_value *sum_values, FE_value *sum_squares_values)
+{
+	int i;
+	int return_number_of_terms = 0;
+	std::vector<FE_value> values;
+	std::vector<char> defined;
+	bool sum_values_only = true;
+	if (is_master_nodeset)
+	{
+		// bring aggregates up to date, evaluating only invalid terms if they are
+		// valid. Repeat if terms are invalidated while evaluating them, but if
+		// all terms were evaluated just sum them without caching.
+		sum_values_only = false;
+		std::vector<FE_node *> nodes;
+		while (true)
+		{
+			mutex.lock();
+			prepare(source_field, extra_cache.getTime());
+			const bool sum_all = !aggregates_valid;
+			nodes.clear();
+			if (!sum_all)
+			{
+				const size_t number_of_invalid_nodes = invalid_nodes.size();
+				for (size_t n = 0; n < number_of_invalid_nodes; ++n)
+				{
+					const int index = get_term_index(invalid_nodes[n]);
+					if ((index >= 0) && (!term_valid[index]))
+						nodes.push_back(invalid_nodes[n]);
+				}
+			}
+			if (sum_all || (0 < nodes.size()))
+			{
+				const unsigned int start_change_counter = change_counter;
+				const int evaluate_number_of_threads = number_of_threads;
+				mutex.unlock();
+				if (sum_all)
+					get_nodes(nodes);
+				evaluate_nodes(source_field, extra_cache, evaluate_number_of_threads,
+					nodes, values, defined);
+				mutex.lock();
+				if (change_counter != start_change_counter)
+				{
+					mutex.unlock();
+					if (sum_all)
+					{
+						sum_values_only = true;
+						break;
+					}
+					continue;
+				}
+				const size_t number_of_nodes = nodes.size();
+				for (size_t n = 0; n < number_of_nodes; ++n)
+				{
+					store_term(add_term(nodes[n]), &(values[n*number_of_components]), defined[n]);
+				}
+				if (sum_all)
+				{
+					sum_aggregates();
+					aggregates_valid = true;
+				}
+				else if (number_of_incremental_updates > number_of_terms)
+				{
+					sum_aggregates();
+				}
+			}
+			invalid_nodes.clear();
+			for (i = 0; i < number_of_components; i++)
+			{
+				if (sum_values)
+					sum_values[i] = sum[i];
+				if (sum_squares_values)
+					sum_squares_values[i] = sum_squares[i];
+			}
+			return_number_of_terms = number_of_terms;
+			mutex.unlock();
+			break;
+		}
+	}
+	else
+	{
+		// group membership changes are not notified: iterate over current members
+		get_node_values(source_field, extra_cache, values, defined);
+	}
+	if (sum_values_only)
+	{
+		for (i = 0; i < number_of_components; i++)
+		{
+			if (sum_values)
+				sum_values[i] = 0.0;
+			if (sum_squares_values)
+				sum_squares_values[i] = 0.0;
+		}
+		const size_t number_of_nodes = defined.size();
+		for (size_t n = 0; n < number_of_nodes; ++n)
+		{
+			if (defined[n])
+			{
+				const FE_value *node_values = &(values[n*number_of_components]);
+				for (i = 0; i < number_of_components; i++)
+				{
+					if (sum_values)
+						sum_values[i] += node_values[i];
+					if (sum_squares_values)
+						sum_squares_values[i] += node_values[i]*node_values[i];
+				}
+				++return_number_of_terms;
+			}
+		}
+	}
+	return return_number_of_terms;
+}
+
+/**
+ * Gets the values of source field at nodes in nodeset where it is defined, in
+ * nodeset iteration order.
+ * @param number_of_values  Size of values array. Values are only written if
+ * number_of_values is positive.
+ * @param values  Array to receive values of all components at each node.
+ * @return  Number of nodes the source field is defined at.
+ */
+int Nodeset_operator_term_cache::evaluate_terms(Computed_field *source_field,
+	Cmiss_field_cache& extra_cache, int number_of_values, FE_value *values)
+{
+	int return_number_of_terms = 0;
+	const int max_terms = number_of_values / number_of_components;
+	FE_value *value = values;
+	std::vector<FE_value> node_values;
+	std::vector<char> defined;
+	get_node_values(source_field, extra_cache, node_values, defined);
+	const size_t number_of_nodes = defined.size();
+	for (size_t n = 0; n < number_of_nodes; ++n)
+	{
+		if (defined[n])
+		{
+			if (return_number_of_terms < max_terms)
+			{
+				const FE_value *term_values = &(node_values[n*number_of_components]);
+				for (int i = 0; i < number_of_components; i++)
+				{
+					*value = term_values[i];
+					++value;
+				}
+			}
+			++return_number_of_terms;
+		}
+	}
+	return return_number_of_terms;
+}
+
+int Nodeset_operator_term_cache::FE_node_change(FE_node *node, int change,
+	void *term_cache_void)
+{
+	USE_PARAMETER(change);
+	Nodeset_operator_term_cache *term_cache =
+		static_cast<Nodeset_operator_term_cache *>(term_cache_void);
+	++(term_cache->number_of_changed_nodes);
+	if (FE_region_contains_FE_node(term_cache->fe_region, node))
+	{
+		term_cache->invalidate_term(node);
+	}
+	else
+	{
+		term_cache->remove_term(node);
+	}
+	return 1;
+}
+
+void Nodeset_operator_term_cache::FE_region_change(FE_region *fe_region_in,
+	FE_region_changes *changes, void *term_cache_void)
+{
+	Nodeset_operator_term_cache *term_cache =
+		static_cast<Nodeset_operator_term_cache *>(term_cache_void);
+	if (changes && term_cache)
+	{
+		Cmiss_mutex_scoped_lock scoped_lock(term_cache->mutex);
+		if (term_cache->tracking)
+		{
+			int field_change_summary = 0;
+			CHANGE_LOG_GET_CHANGE_SUMMARY(FE_field)(changes->fe_field_changes, &field_change_summary);
+			int node_change_summary = 0;
+			CHANGE_LOG_GET_CHANGE_SUMMARY(FE_node)(changes->fe_node_changes, &node_change_summary);
+			int element_change_summary = 0;
+			for (int dimension = 1; dimension <= MAXIMUM_ELEMENT_XI_DIMENSIONS; ++dimension)
+			{
+				int change_summary = 0;
+				CHANGE_LOG_GET_CHANGE_SUMMARY(FE_element)(
+					FE_region_changes_get_FE_element_changes(changes, dimension), &change_summary);
+				element_change_summary |= change_summary;
+			}
+			if ((field_change_summary & (CHANGE_LOG_OBJECT_ADDED(FE_field) |
+				CHANGE_LOG_OBJECT_REMOVED(FE_field) | CHANGE_LOG_OBJECT_CHANGED(FE_field))) ||
+				((!term_cache->node_local) &&
+					(field_change_summary || node_change_summary || element_change_summary)))
+			{
+				term_cache->clear();
+			}
+			else if (node_change_summary && (fe_region_in == term_cache->fe_region))
+			{
+				term_cache->number_of_changed_nodes = 0;
+				CHANGE_LOG_FOR_EACH_OBJECT(FE_node)(changes->fe_node_changes,
+					Nodeset_operator_term_cache::FE_node_change, term_cache_void);
+				// log only lists nodes if not too many changes: all changed otherwise
+				if (0 == term_cache->number_of_changed_nodes)
+				{
+					term_cache->clear();
+				}
+			}
+		}
+	}
+}
+
 class Computed_field_nodeset_operator : public Computed_field_core
 {
 protected:
 	Cmiss_nodeset_id nodeset;
+	Nodeset_operator_term_cache *term_cache;
 
 public:
 	Computed_field_nodeset_operator(Cmiss_nodeset_id nodeset_in) :
 		Computed_field_core(),
-		nodeset(Cmiss_nodeset_access(nodeset_in))
+		nodeset(Cmiss_nodeset_access(nodeset_in)),
+		term_cache(0)
 	{
 	};
 
 	virtual ~Computed_field_nodeset_operator()
 	{
+		delete term_cache;
 		Cmiss_nodeset_destroy(&nodeset);
 	}
 
+	virtual bool attach_to_field(Computed_field* parent)
+	{
+		if (Computed_field_core::attach_to_field(parent))
+		{
+			term_cache = new Nodeset_operator_term_cache(nodeset, parent->number_of_components);
+			return true;
+		}
+		return false;
+	}
+
+	virtual int check_dependency()
+	{
+		int return_code = Computed_field_core::check_dependency();
+		if (return_code && term_cache)
+		{
+			term_cache->invalidate();
+		}
+		return return_code;
+	}
+
+	/** Called when DOFs the source field depends on are modified directly */
+	virtual int clear_cache()
+	{
+		if (term_cache)
+		{
+			term_cache->invalidate();
+		}
+		return 1;
+	}
+
+	virtual int clear_cache_for_nodes(int number_of_nodes, FE_node **nodes)
+	{
+		if (term_cache)
+		{
+			term_cache->invalidate_nodes(number_of_nodes, nodes);
+		}
+		return 1;
+	}
+
+	virtual bool supports_dof_derivatives()
+	{
+		return getSourceField(0)->supportsDofDerivatives();
+	}
+
 	virtual void inherit_source_field_attributes()
 	{
 		if (field)
@@ -97,6 +942,11 @@ public:
 		return nodeset;
 	}
 
+	Nodeset_operator_term_cache *get_term_cache()
+	{
+		return term_cache;
+	}
+
 	virtual FieldValueCache *createValueCache(Cmiss_field_cache& parentCache)
 	{
 		RealFieldValueCache *valueCache = new RealFieldValueCache(field->number_of_components);
@@ -109,8 +959,96 @@ public:
 	int list();
 
 	char* get_command_string();
+
+protected:
+	int evaluate_sum_dof_derivatives(Cmiss_field_cache& cache, const FieldDofMap& dofMap,
+		FieldDofDerivatives& derivatives, bool sum_squares);
+
+	int evaluate_terms_dof_derivatives(RealFieldValueCache& valueCache,
+		const FieldDofMap& dofMap, int number_of_terms, FieldDofDerivatives *termDerivatives);
 };
 
+/**
+ * Evaluates derivatives of the sum of source field values or their squares
+ * over the nodeset with respect to DOFs.
+ * @param sum_squares  If true get derivatives of sum of squares, otherwise sum.
+ * @return  Number of terms summed, or -1 on failure.
+ */
+int Computed_field_nodeset_operator::evaluate_sum_dof_derivatives(Cmiss_field_cache& cache,
+	const FieldDofMap& dofMap, FieldDofDerivatives& derivatives, bool sum_squares)
+{
+	FieldValueCache &inValueCache = *(field->getValueCache(cache));
+	Cmiss_field_cache& extraCache = *(inValueCache.getExtraCache());
+	extraCache.setTime(cache.getTime());
+	const int number_of_components = field->number_of_components;
+	std::vector<FE_value> scales(number_of_components, 1.0);
+	FieldDofDerivatives nodeDerivatives(number_of_components);
+	Cmiss_field_id sourceField = getSourceField(0);
+	int number_of_terms = 0;
+	Cmiss_node_iterator_id iterator = Cmiss_nodeset_create_node_iterator(nodeset);
+	Cmiss_node_id node = 0;
+	while (0 != (node = Cmiss_node_iterator_next_non_access(iterator)))
+	{
+		extraCache.setNode(node);
+		RealFieldValueCache* sourceValueCache = static_cast<RealFieldValueCache*>(sourceField->evaluate(extraCache));
+		if (sourceValueCache)
+		{
+			if (!sourceField->evaluateDofDerivatives(extraCache, dofMap, nodeDerivatives))
+			{
+				number_of_terms = -1;
+				break;
+			}
+			if (sum_squares)
+			{
+				for (int i = 0; i < number_of_components; i++)
+				{
+					scales[i] = 2.0*sourceValueCache->values[i];
+				}
+			}
+			derivatives.addComponentScaled(nodeDerivatives, &(scales[0]));
+			++number_of_terms;
+		}
+	}
+	Cmiss_node_iterator_destroy(&iterator);
+	return number_of_terms;
+}
+
+/**
+ * Evaluates derivatives of source field values at each node in the nodeset
+ * where it is defined, in the order of evaluate_sum_square_terms.
+ * @return  1 on success, 0 on failure or if number of terms differs.
+ */
+int Computed_field_nodeset_operator::evaluate_terms_dof_derivatives(RealFieldValueCache& valueCache,
+	const FieldDofMap& dofMap, int number_of_terms, FieldDofDerivatives *termDerivatives)
+{
+	Cmiss_field_cache& extraCache = *(valueCache.getExtraCache());
+	Cmiss_field_id sourceField = getSourceField(0);
+	int return_code = 1;
+	int term = 0;
+	Cmiss_node_iterator_id iterator = Cmiss_nodeset_create_node_iterator(nodeset);
+	Cmiss_node_id node = 0;
+	while (0 != (node = Cmiss_node_iterator_next_non_access(iterator)))
+	{
+		extraCache.setNode(node);
+		if (sourceField->evaluate(extraCache))
+		{
+			if ((term >= number_of_terms) ||
+				(!sourceField->evaluateDofDerivatives(extraCache, dofMap, termDerivatives[term])))
+			{
+				return_code = 0;
+				break;
+			}
+			++term;
+		}
+	}
+	Cmiss_node_iterator_destroy(&iterator);
+	if (term != number_of_terms)
+	{
+		return_code = 0;
+	}
+	return return_code;
+}
+
 bool Computed_field_nodeset_operator::is_defined_at_location(Cmiss_field_cache& cache)
 {
 	// Checks if source field is defined at a node in nodeset
@@ -203,6 +1141,12 @@ public:
 		return 1;
 	}
 
+	virtual int evaluate_dof_derivatives(Cmiss_field_cache& cache, const FieldDofMap& dofMap,
+		FieldDofDerivatives& derivatives)
+	{
+		return (0 <= evaluate_sum_dof_derivatives(cache, dofMap, derivatives, /*sum_squares*/false));
+	}
+
 protected:
 	/** @return  number_of_terms summed. 0 is not an error for nodeset_sum, but is for nodeset_mean */
 	int evaluate_sum(Cmiss_field_cache& cache, FieldValueCache& inValueCache);
@@ -213,31 +1157,8 @@ int Computed_field_nodeset_sum::evaluate_sum(Cmiss_field_cache& cache, FieldValu
 	RealFieldValueCache &valueCache = RealFieldValueCache::cast(inValueCache);
 	Cmiss_field_cache& extraCache = *(inValueCache.getExtraCache());
 	extraCache.setTime(cache.getTime());
-	int number_of_terms = 0;
-	const int number_of_components = field->number_of_components;
-	FE_value *values = valueCache.values;
-	Cmiss_field_id sourceField = getSourceField(0);
-	int i;
-	for (i = 0; i < number_of_components; i++)
-	{
-		values[i] = 0;
-	}
-	Cmiss_node_iterator_id iterator = Cmiss_nodeset_create_node_iterator(nodeset);
-	Cmiss_node_id node = 0;
-	while (0 != (node = Cmiss_node_iterator_next_non_access(iterator)))
-	{
-		extraCache.setNode(node);
-		RealFieldValueCache* sourceValueCache = static_cast<RealFieldValueCache*>(sourceField->evaluate(extraCache));
-		if (sourceValueCache)
-		{
-			for (i = 0 ; i < number_of_components ; i++)
-			{
-				values[i] += sourceValueCache->values[i];
-			}
-			++number_of_terms;
-		}
-	}
-	Cmiss_node_iterator_destroy(&iterator);
+	int number_of_terms = term_cache->evaluate_sums(getSourceField(0), extraCache,
+		valueCache.values, /*sum_squares_values*/0);
 	valueCache.derivatives_valid = 0;
 	return number_of_terms;
 }
@@ -273,6 +1194,18 @@ public:
 
 	int evaluate(Cmiss_field_cache& cache, FieldValueCache& inValueCache);
 
+	virtual int evaluate_dof_derivatives(Cmiss_field_cache& cache, const FieldDofMap& dofMap,
+		FieldDofDerivatives& derivatives)
+	{
+		int number_of_terms = evaluate_sum_dof_derivatives(cache, dofMap, derivatives, /*sum_squares*/false);
+		if (number_of_terms > 0)
+		{
+			derivatives.scale(1.0 / (FE_value)number_of_terms);
+			return 1;
+		}
+		return 0;
+	}
+
 };
 
 int Computed_field_nodeset_mean::evaluate(Cmiss_field_cache& cache, FieldValueCache& inValueCache)
@@ -336,6 +1269,20 @@ public:
 		return 1;
 	}
 
+	virtual int evaluate_dof_derivatives(Cmiss_field_cache& cache, const FieldDofMap& dofMap,
+		FieldDofDerivatives& derivatives)
+	{
+		return (0 <= evaluate_sum_dof_derivatives(cache, dofMap, derivatives, /*sum_squares*/true));
+	}
+
+	virtual int evaluate_sum_square_terms_dof_derivatives(Cmiss_field_cache& cache,
+		RealFieldValueCache& valueCache, const FieldDofMap& dofMap,
+		int number_of_terms, FieldDofDerivatives *termDerivatives)
+	{
+		valueCache.getExtraCache()->setTime(cache.getTime());
+		return evaluate_terms_dof_derivatives(valueCache, dofMap, number_of_terms, termDerivatives);
+	}
+
 protected:
 	/** @return  number_of_terms summed. 0 is not an error for nodeset_sum_squares, but is for nodeset_mean_squares */
 	int evaluate_sum_squares(Cmiss_field_cache& cache, FieldValueCache& inValueCache);
@@ -365,40 +1312,13 @@ int Computed_field_nodeset_sum_squares::evaluate_sum_square_terms(
 {
 	Cmiss_field_cache& extraCache = *(valueCache.getExtraCache());
 	extraCache.setTime(cache.getTime());
-	int return_code = 1;
-	int number_of_terms = 0;
-	const int number_of_components = field->number_of_components;
-	const int max_terms = number_of_values / number_of_components;
-	FE_value *value = values;
-	Cmiss_field_id sourceField = getSourceField(0);
-	int i;
-	Cmiss_node_iterator_id iterator = Cmiss_nodeset_create_node_iterator(nodeset);
-	Cmiss_node_id node = 0;
-	while (0 != (node = Cmiss_node_iterator_next_non_access(iterator)))
+	int number_of_terms = term_cache->evaluate_terms(getSourceField(0), extraCache,
+		number_of_values, values);
+	if (number_of_terms*field->number_of_components != number_of_values)
 	{
-		extraCache.setNode(node);
-		RealFieldValueCache* sourceValueCache = static_cast<RealFieldValueCache*>(sourceField->evaluate(extraCache));
-		if (sourceValueCache)
-		{
-			if (number_of_terms >= max_terms)
-			{
-				return_code = 0;
-				break;
-			}
-			for (i = 0 ; i < number_of_components ; i++)
-			{
-				*value = sourceValueCache->values[i];
-				++value;
-			}
-			++number_of_terms;
-		}
-	}
-	Cmiss_node_iterator_destroy(&iterator);
-	if (number_of_terms*number_of_components != number_of_values)
-	{
-		return_code = 0;
+		return 0;
 	}
-	return return_code;
+	return 1;
 }
 
 int Computed_field_nodeset_sum_squares::evaluate_sum_squares(Cmiss_field_cache& cache, FieldValueCache& inValueCache)
@@ -406,31 +1326,8 @@ int Computed_field_nodeset_sum_squares::evaluate_sum_squares(Cmiss_field_cache&
 	RealFieldValueCache &valueCache = RealFieldValueCache::cast(inValueCache);
 	Cmiss_field_cache& extraCache = *(inValueCache.getExtraCache());
 	extraCache.setTime(cache.getTime());
-	int number_of_terms = 0;
-	const int number_of_components = field->number_of_components;
-	FE_value *values = valueCache.values;
-	Cmiss_field_id sourceField = getSourceField(0);
-	int i;
-	for (i = 0; i < number_of_components; i++)
-	{
-		values[i] = 0;
-	}
-	Cmiss_node_iterator_id iterator = Cmiss_nodeset_create_node_iterator(nodeset);
-	Cmiss_node_id node = 0;
-	while (0 != (node = Cmiss_node_iterator_next_non_access(iterator)))
-	{
-		extraCache.setNode(node);
-		RealFieldValueCache* sourceValueCache = static_cast<RealFieldValueCache*>(sourceField->evaluate(extraCache));
-		if (sourceValueCache)
-		{
-			for (i = 0 ; i < number_of_components ; i++)
-			{
-				values[i] += sourceValueCache->values[i]*sourceValueCache->values[i];
-			}
-			++number_of_terms;
-		}
-	}
-	Cmiss_node_iterator_destroy(&iterator);
+	int number_of_terms = term_cache->evaluate_sums(getSourceField(0), extraCache,
+		/*sum_values*/0, valueCache.values);
 	valueCache.derivatives_valid = 0;
 	return number_of_terms;
 }
@@ -469,12 +1366,49 @@ public:
 
 	int evaluate(Cmiss_field_cache& cache, FieldValueCache& inValueCache);
 
+	virtual int evaluate_dof_derivatives(Cmiss_field_cache& cache, const FieldDofMap& dofMap,
+		FieldDofDerivatives& derivatives)
+	{
+		int number_of_terms = evaluate_sum_dof_derivatives(cache, dofMap, derivatives, /*sum_squares*/true);
+		if (number_of_terms > 0)
+		{
+			derivatives.scale(1.0 / (FE_value)number_of_terms);
+			return 1;
+		}
+		return 0;
+	}
+
+	virtual int evaluate_sum_square_terms_dof_derivatives(Cmiss_field_cache& cache,
+		RealFieldValueCache& valueCache, const FieldDofMap& dofMap,
+		int number_of_terms, FieldDofDerivatives *termDerivatives)
+	{
+		int return_code = Computed_field_nodeset_sum_squares::evaluate_sum_square_terms_dof_derivatives(
+			cache, valueCache, dofMap, number_of_terms, termDerivatives);
+		if (return_code)
+		{
+			if (number_of_terms > 0)
+			{
+				FE_value scaling = 1.0 / sqrt((FE_value)number_of_terms);
+				for (int i = 0; i < number_of_terms; i++)
+				{
+					termDerivatives[i].scale(scaling);
+				}
+			}
+			else
+			{
+				return_code = 0;
+			}
+		}
+		return return_code;
+	}
+
 };
 
 int Computed_field_nodeset_mean_squares::evaluate_sum_square_terms(
 	Cmiss_field_cache& cache, RealFieldValueCache& valueCache, int number_of_values, FE_value *values)
 {
-	int return_code = evaluate_sum_square_terms(cache, valueCache, number_of_values, values);
+	int return_code = Computed_field_nodeset_sum_squares::evaluate_sum_square_terms(
+		cache, valueCache, number_of_values, values);
 	if (return_code)
 	{
 		int number_of_terms = number_of_values / field->number_of_components;
@@ -588,3 +1522,26 @@ Cmiss_field_id Cmiss_field_module_create_nodeset_mean_squares(
 	return field;
 }
 
+int Cmiss_field_nodeset_operator_get_number_of_threads(Cmiss_field_id field)
+{
+	Computed_field_nodeset_operator *core = field ?
+		dynamic_cast<Computed_field_nodeset_operator *>(field->core) : 0;
+	if (core && core->get_term_cache())
+		return core->get_term_cache()->get_number_of_threads();
+	return 0;
+}
+
+int Cmiss_field_nodeset_operator_set_number_of_threads(Cmiss_field_id field,
+	int number_of_threads)
+{
+	Computed_field_nodeset_operator *core = field ?
+		dynamic_cast<Computed_field_nodeset_operator *>(field->core) : 0;
+	if (core && core->get_term_cache() && (0 < number_of_threads))
+	{
+		// only affects speed of evaluation so no change notification needed
+		core->get_term_cache()->set_number_of_threads(number_of_threads);
+		return CMISS_OK;
+	}
+	return CMISS_ERROR_ARGUMENT;
+}
+
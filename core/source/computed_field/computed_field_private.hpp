@@ -52,6 +52,7 @@ Types used only internally to computed fields.
 #include "general/cmiss_set.hpp"
 #include "computed_field/field_location.hpp"
 #include "computed_field/field_cache.hpp"
+#include "computed_field/field_dof_derivatives.hpp"
 #include "computed_field/computed_field.h"
 #include "general/debug.h"
 #include "region/cmiss_region.h"
@@ -255,6 +256,13 @@ public:
 		return 1;
 	};
 
+	/** Clear caches in field itself after DOFs at only the listed nodes have
+	 * been modified directly. Default clears the whole cache. */
+	virtual int clear_cache_for_nodes(int /*number_of_nodes*/, FE_node ** /*nodes*/)
+	{
+		return clear_cache();
+	};
+
 	virtual int compare(Computed_field_core* other) = 0;
 
 	/** default implementation returns true if all source fields are defined at location.
@@ -273,6 +281,17 @@ public:
 
 	virtual int evaluate(Cmiss_field_cache& cache, FieldValueCache& valueCache) = 0;
 
+	/**
+	 * Evaluate real values at all points in the batch location of the cache
+	 * into valueCache.batchValues. Default implementation sets each point in
+	 * turn as the cache location and calls evaluate. Override for field types
+	 * able to evaluate the whole batch more efficiently; these should obtain
+	 * source field values with Computed_field::evaluateBatch.
+	 * Derivatives are not evaluated.
+	 * @return  1 on success, 0 if field not defined at any batch point.
+	 */
+	virtual int evaluate_batch(Cmiss_field_cache& cache, RealFieldValueCache& valueCache);
+
 	/** Override & return 1 for field types supporting the sum_square_terms API */
 	virtual int supports_sum_square_terms() const
 	{
@@ -295,6 +314,34 @@ public:
 		return 0;
 	}
 
+	/** Override & return true for field types able to evaluate derivatives of
+	 * their values with respect to DOFs. Overrides must check source fields. */
+	virtual bool supports_dof_derivatives()
+	{
+		return false;
+	}
+
+	/** Override to evaluate sparse derivatives of field values with respect to
+	 * DOFs in dofMap at the location in cache. Derivatives are added to the
+	 * supplied object, which has the number of components of the field.
+	 * @return  1 on success, 0 if failed or field is not defined */
+	virtual int evaluate_dof_derivatives(Cmiss_field_cache& /*cache*/,
+		const FieldDofMap& /*dofMap*/, FieldDofDerivatives& /*derivatives*/)
+	{
+		return 0;
+	}
+
+	/** Override for field types whose value is a sum of squares to get the
+	 * derivatives of each term in evaluate_sum_square_terms with respect to
+	 * DOFs. termDerivatives must have the number of components of the field.
+	 * @return  1 on success, 0 if failed or number of terms differs */
+	virtual int evaluate_sum_square_terms_dof_derivatives(Cmiss_field_cache&,
+		RealFieldValueCache&, const FieldDofMap& /*dofMap*/,
+		int /*number_of_terms*/, FieldDofDerivatives* /*termDerivatives*/)
+	{
+		return 0;
+	}
+
 	virtual enum FieldAssignmentResult assign(Cmiss_field_cache& /*cache*/, MeshLocationFieldValueCache& /*valueCache*/)
 	{
 		return FIELD_ASSIGNMENT_RESULT_FAIL;
@@ -460,7 +507,7 @@ DESCRIPTION :
 
 	inline Computed_field *access()
 	{
-		++access_count;
+		cmiss_atomic_increment(&access_count);
 		return this;
 	}
 
@@ -474,6 +521,11 @@ DESCRIPTION :
 	 */
 	void clearCaches();
 
+	/** Variant of clearCaches for when only DOFs at the listed nodes have
+	 * changed, letting fields keep cached data for other nodes.
+	 */
+	void clearCaches(int number_of_nodes, FE_node **nodes);
+
 	inline FieldValueCache *getValueCache(Cmiss_field_cache& cache)
 	{
 		FieldValueCache *valueCache = cache.getValueCache(cache_index);
@@ -518,6 +570,23 @@ DESCRIPTION :
 		return valueCache;
 	}
 
+	/** Evaluate real field at all points in batch location of cache.
+	 * Caller must ensure field is numerical and no derivatives are requested.
+	 * @return  Value cache with valid batchValues, or 0 if failed at any point. */
+	inline RealFieldValueCache *evaluateBatch(Cmiss_field_cache& cache)
+	{
+		RealFieldValueCache *valueCache = RealFieldValueCache::cast(getValueCache(cache));
+		if (valueCache->batchEvaluationCounter < cache.getBatchCounter())
+		{
+			valueCache->reserveBatch(cache.getBatchSize());
+			if (core->evaluate_batch(cache, *valueCache))
+				valueCache->batchEvaluationCounter = cache.getBatchCounter();
+			else
+				valueCache = 0;
+		}
+		return valueCache;
+	}
+
 	/** @param numberOfDerivatives  positive number of xi dimension of element location */
 	inline RealFieldValueCache *evaluateWithDerivatives(Cmiss_field_cache& cache, int numberOfDerivatives)
 	{
@@ -574,6 +643,34 @@ DESCRIPTION :
 		return 0;
 	}
 
+	bool supportsDofDerivatives()
+	{
+		return core->supports_dof_derivatives();
+	}
+
+	/** Evaluate sparse derivatives of field with respect to DOFs at location in
+	 * cache. Clears derivatives first. */
+	int evaluateDofDerivatives(Cmiss_field_cache& cache, const FieldDofMap& dofMap,
+		FieldDofDerivatives& derivatives)
+	{
+		derivatives.clear(number_of_components);
+		return core->evaluate_dof_derivatives(cache, dofMap, derivatives);
+	}
+
+	int evaluateSumSquareTermsDofDerivatives(Cmiss_field_cache& cache,
+		const FieldDofMap& dofMap, int number_of_terms, FieldDofDerivatives *termDerivatives)
+	{
+		if ((0 <= number_of_terms) && termDerivatives)
+		{
+			for (int i = 0; i < number_of_terms; ++i)
+				termDerivatives[i].clear(number_of_components);
+			RealFieldValueCache *valueCache = RealFieldValueCache::cast(getValueCache(cache));
+			return core->evaluate_sum_square_terms_dof_derivatives(cache, *valueCache,
+				dofMap, number_of_terms, termDerivatives);
+		}
+		return 0;
+	}
+
 
 }; /* struct Computed_field */
 
@@ -39,10 +39,16 @@
 *
 * ***** END LICENSE BLOCK ***** */
 #include <stdlib.h>
+#include <vector>
+#include "zinc/zincconfigure.h"
+#if defined (USE_OPENMP)
+#include <omp.h>
+#endif /* defined (USE_OPENMP) */
 #include "zinc/element.h"
 #include "zinc/node.h"
 #include "zinc/fieldmodule.h"
 #include "zinc/fieldsubobjectgroup.h"
+#include "zinc/status.h"
 #include "computed_field/computed_field.h"
 #if defined (USE_OPENCASCADE)
 #include "zinc/fieldcad.h"
@@ -83,38 +89,176 @@ public:
 	}
 };
 
-struct Cmiss_element_field_is_true_iterator_data
+/**
+ * @param maximum_number_of_threads  Number of threads set for the group.
+ * @return  Number of threads to evaluate conditional fields over number of
+ * objects: up to the maximum set for the group and the OpenMP maximum if built
+ * with USE_OPENMP, but not so many that threads have few objects each.
+ */
+int get_conditional_number_of_threads(int maximum_number_of_threads, int number_of_objects)
 {
-	Cmiss_field_cache_id cache;
-	Cmiss_field_id field;
-};
+	int number_of_threads = 1;
+#if defined (USE_OPENMP)
+	number_of_threads = omp_get_max_threads();
+	if (number_of_threads > maximum_number_of_threads)
+		number_of_threads = maximum_number_of_threads;
+#else
+	USE_PARAMETER(maximum_number_of_threads);
+#endif /* defined (USE_OPENMP) */
+	const int minimum_objects_per_thread = 256;
+	if (number_of_threads*minimum_objects_per_thread > number_of_objects)
+		number_of_threads = number_of_objects / minimum_objects_per_thread;
+	if (number_of_threads < 1)
+		number_of_threads = 1;
+	return number_of_threads;
+}
 
-int Cmiss_element_field_is_true_iterator(Cmiss_element_id element, void *data_void)
+/**
+ * Creates a field cache per thread. Must be done serially.
+ * @return  1 on success, 0 if any cache could not be created.
+ */
+int create_conditional_caches(Cmiss_field_module_id field_module,
+	std::vector<Cmiss_field_cache_id>& caches)
 {
-	Cmiss_element_field_is_true_iterator_data *data =
-		reinterpret_cast<Cmiss_element_field_is_true_iterator_data *>(data_void);
-	Cmiss_field_cache_set_element(data->cache, element);
-	return Cmiss_field_evaluate_boolean(data->field, data->cache);
+	int return_code = 1;
+	for (size_t i = 0; i < caches.size(); ++i)
+	{
+		caches[i] = Cmiss_field_module_create_cache(field_module);
+		if (!caches[i])
+			return_code = 0;
+	}
+	return return_code;
 }
 
-struct Cmiss_node_field_is_true_iterator_data
+void destroy_conditional_caches(std::vector<Cmiss_field_cache_id>& caches)
 {
-	Cmiss_field_cache_id cache;
-	Cmiss_field_id field;
-};
+	for (size_t i = 0; i < caches.size(); ++i)
+	{
+		if (caches[i])
+			Cmiss_field_cache_destroy(&(caches[i]));
+	}
+}
 
-int Cmiss_node_field_is_true_iterator(Cmiss_node_id node, void *data_void)
+/**
+ * Evaluates conditional field in each element, in contiguous chunks each with
+ * its own field cache, in parallel if built with USE_OPENMP. The first element
+ * is evaluated serially so fields can build any internal caches first.
+ * @param maximum_number_of_threads  Number of threads set for the group.
+ * @param is_true  Set to 1 for elements in which field is true, 0 otherwise.
+ * @return  1 on success, 0 if failed to create caches.
+ */
+int Cmiss_field_evaluate_boolean_in_elements(Cmiss_field_module_id field_module,
+	Cmiss_field_id conditional_field, const std::vector<Cmiss_element_id>& elements,
+	int maximum_number_of_threads, std::vector<char>& is_true)
 {
-	Cmiss_node_field_is_true_iterator_data *data =
-		reinterpret_cast<Cmiss_node_field_is_true_iterator_data *>(data_void);
-	Cmiss_field_cache_set_node(data->cache, node);
-	return Cmiss_field_evaluate_boolean(data->field, data->cache);
+	const int number_of_elements = static_cast<int>(elements.size());
+	is_true.assign(number_of_elements, 0);
+	if (0 == number_of_elements)
+		return 1;
+	const int number_of_threads = get_conditional_number_of_threads(
+		maximum_number_of_threads, number_of_elements);
+	std::vector<Cmiss_field_cache_id> caches(number_of_threads, static_cast<Cmiss_field_cache_id>(0));
+	int return_code = create_conditional_caches(field_module, caches);
+	if (return_code)
+	{
+		Cmiss_field_cache_set_element(caches[0], elements[0]);
+		is_true[0] = static_cast<char>(Cmiss_field_evaluate_boolean(conditional_field, caches[0]));
+#if defined (USE_OPENMP)
+#pragma omp parallel for num_threads(number_of_threads) schedule(static, 1)
+#endif /* defined (USE_OPENMP) */
+		for (int chunk = 0; chunk < number_of_threads; ++chunk)
+		{
+			Cmiss_field_cache_id cache = caches[chunk];
+			const int first = static_cast<int>((static_cast<long>(number_of_elements)*chunk) / number_of_threads);
+			const int limit = static_cast<int>((static_cast<long>(number_of_elements)*(chunk + 1)) / number_of_threads);
+			for (int i = (first > 0) ? first : 1; i < limit; ++i)
+			{
+				Cmiss_field_cache_set_element(cache, elements[i]);
+				is_true[i] = static_cast<char>(Cmiss_field_evaluate_boolean(conditional_field, cache));
+			}
+		}
+	}
+	destroy_conditional_caches(caches);
+	return return_code;
+}
+
+/**
+ * Evaluates conditional field at each node, in contiguous chunks each with its
+ * own field cache, in parallel if built with USE_OPENMP. Each chunk evaluates
+ * nodes in batches, falling back to evaluating nodes individually if batch
+ * evaluation fails e.g. because the field is not defined at all nodes in it.
+ * The first node is evaluated serially so fields can build any internal
+ * caches first.
+ * @param maximum_number_of_threads  Number of threads set for the group.
+ * @param is_true  Set to 1 for nodes at which field is true, 0 otherwise.
+ * @return  1 on success, 0 if failed to create caches.
+ */
+int Cmiss_field_evaluate_boolean_at_nodes(Cmiss_field_module_id field_module,
+	Cmiss_field_id conditional_field, const std::vector<Cmiss_node_id>& nodes,
+	int maximum_number_of_threads, std::vector<char>& is_true)
+{
+	const int number_of_nodes = static_cast<int>(nodes.size());
+	is_true.assign(number_of_nodes, 0);
+	if (0 == number_of_nodes)
+		return 1;
+	const int number_of_threads = get_conditional_number_of_threads(
+		maximum_number_of_threads, number_of_nodes);
+	const int number_of_components = Cmiss_field_get_number_of_components(conditional_field);
+	const int batch_size = 256;
+	const double zero_tolerance = 1e-6;
+	std::vector<Cmiss_field_cache_id> caches(number_of_threads, static_cast<Cmiss_field_cache_id>(0));
+	int return_code = create_conditional_caches(field_module, caches);
+	if (return_code)
+	{
+		Cmiss_field_cache_set_node(caches[0], nodes[0]);
+		Cmiss_field_evaluate_boolean(conditional_field, caches[0]);
+#if defined (USE_OPENMP)
+#pragma omp parallel for num_threads(number_of_threads) schedule(static, 1)
+#endif /* defined (USE_OPENMP) */
+		for (int chunk = 0; chunk < number_of_threads; ++chunk)
+		{
+			Cmiss_field_cache_id cache = caches[chunk];
+			const int first = static_cast<int>((static_cast<long>(number_of_nodes)*chunk) / number_of_threads);
+			const int limit = static_cast<int>((static_cast<long>(number_of_nodes)*(chunk + 1)) / number_of_threads);
+			std::vector<double> values(batch_size*number_of_components);
+			for (int start = first; start < limit; start += batch_size)
+			{
+				const int count = ((limit - start) < batch_size) ? (limit - start) : batch_size;
+				if (CMISS_OK == Cmiss_field_evaluate_real_node_batch(conditional_field, cache,
+					count, &(nodes[start]), count*number_of_components, &(values[0])))
+				{
+					const double *value = &(values[0]);
+					for (int i = 0; i < count; ++i)
+					{
+						for (int c = 0; c < number_of_components; ++c)
+						{
+							if ((value[c] < -zero_tolerance) || (value[c] > zero_tolerance))
+							{
+								is_true[start + i] = 1;
+								break;
+							}
+						}
+						value += number_of_components;
+					}
+				}
+				else
+				{
+					for (int i = start; i < start + count; ++i)
+					{
+						Cmiss_field_cache_set_node(cache, nodes[i]);
+						is_true[i] = static_cast<char>(Cmiss_field_evaluate_boolean(conditional_field, cache));
+					}
+				}
+			}
+		}
+	}
+	destroy_conditional_caches(caches);
+	return return_code;
 }
 
 }
 
-/** remove objects from the group if they are in the supplied list */
-int Computed_field_element_group::removeElementsConditional(Cmiss_field_id conditional_field)
+int Computed_field_element_group::addElementsConditional(Cmiss_field_id conditional_field)
 {
 	if (!conditional_field)
 		return 0;
@@ -133,85 +277,164 @@ int Computed_field_element_group::removeElementsConditional(Cmiss_field_id condi
 	{
 		other_element_group = dynamic_cast<Computed_field_element_group *>(conditional_field->core);
 	}
-	int return_code = 0;
-	const int old_size = NUMBER_IN_LIST(FE_element)(object_list);
-	if (other_element_group)
-	{
-		if (other_element_group->field == field)
-			return clear();
-		if (other_element_group->getSize() < getSize())
+	if (other_element_group && Cmiss_mesh_match(master_mesh, other_element_group->master_mesh))
+		return addElementsInGroup(other_element_group);
+	// only evaluate elements not already in group
+	std::vector<Cmiss_element_id> elements;
+	Cmiss_element_iterator_id iter = Cmiss_mesh_create_element_iterator(master_mesh);
+	Cmiss_element_id element = 0;
+	while (0 != (element = Cmiss_element_iterator_next_non_access(iter)))
+	{
+		if (!hasIdentifier(FE_element_get_cm_number(element)))
+			elements.push_back(element);
+	}
+	Cmiss_element_iterator_destroy(&iter);
+	Cmiss_region_id region = Cmiss_mesh_get_master_region_internal(master_mesh);
+	Cmiss_field_module_id field_module = Cmiss_region_get_field_module(region);
+	std::vector<char> is_true;
+	int return_code = Cmiss_field_evaluate_boolean_in_elements(field_module, conditional_field, elements,
+		number_of_threads, is_true);
+	Cmiss_field_module_destroy(&field_module);
+	const int old_size = size;
+	if (return_code)
+	{
+		const int number_of_elements = static_cast<int>(elements.size());
+		for (int i = 0; i < number_of_elements; ++i)
 		{
-			Cmiss_element_iterator_id iter = CREATE_LIST_ITERATOR(FE_element)(other_element_group->object_list);
-			Cmiss_element_id element = 0;
-			while (0 != (element = Cmiss_element_iterator_next_non_access(iter)))
-			{
-				if (IS_OBJECT_IN_LIST(FE_element)(element, object_list))
-					REMOVE_OBJECT_FROM_LIST(FE_element)(element, object_list);
-			}
-			Cmiss_element_iterator_destroy(&iter);
+			if (is_true[i])
+				addIdentifier(FE_element_get_cm_number(elements[i]));
 		}
-		else
+	}
+	bulk_change(old_size);
+	return return_code;
+}
+
+int Computed_field_element_group::removeElementsConditional(Cmiss_field_id conditional_field)
+{
+	if (!conditional_field)
+		return 0;
+	Computed_field_element_group *other_element_group = 0;
+	Cmiss_field_group_id group = Cmiss_field_cast_group(conditional_field);
+	if (group)
+	{
+		Cmiss_field_element_group_id element_group = Cmiss_field_group_get_element_group(group, master_mesh);
+		Cmiss_field_group_destroy(&group);
+		if (!element_group)
+			return 1;
+		other_element_group = Computed_field_element_group_core_cast(element_group);
+		Cmiss_field_element_group_destroy(&element_group);
+	}
+	else
+	{
+		other_element_group = dynamic_cast<Computed_field_element_group *>(conditional_field->core);
+	}
+	if (other_element_group && Cmiss_mesh_match(master_mesh, other_element_group->master_mesh))
+		return removeElementsInGroup(other_element_group);
+	std::vector<Cmiss_element_id> elements;
+	elements.reserve(size);
+	Cmiss_element_iterator_id iter = createIterator();
+	Cmiss_element_id element = 0;
+	while (0 != (element = Cmiss_element_iterator_next_non_access(iter)))
+		elements.push_back(element);
+	Cmiss_element_iterator_destroy(&iter);
+	Cmiss_region_id region = Cmiss_mesh_get_master_region_internal(master_mesh);
+	Cmiss_field_module_id field_module = Cmiss_region_get_field_module(region);
+	std::vector<char> is_true;
+	int return_code = Cmiss_field_evaluate_boolean_in_elements(field_module, conditional_field, elements,
+		number_of_threads, is_true);
+	Cmiss_field_module_destroy(&field_module);
+	const int old_size = size;
+	if (return_code)
+	{
+		const int number_of_elements = static_cast<int>(elements.size());
+		for (int i = 0; i < number_of_elements; ++i)
 		{
-			return_code = REMOVE_OBJECTS_FROM_LIST_THAT(FE_element)(
-				FE_element_is_in_list, (void *)other_element_group->object_list, object_list);
+			if (is_true[i])
+				removeIdentifier(FE_element_get_cm_number(elements[i]));
 		}
 	}
-	else
+	bulk_change(old_size);
+	return return_code;
+}
+
+int Computed_field_element_group::addElementsInGroup(Computed_field_element_group *other_group)
+{
+	if ((!other_group) || (!Cmiss_mesh_match(master_mesh, other_group->master_mesh)))
+		return 0;
+	if (other_group == this)
+		return 1;
+	const int old_size = size;
+	int return_code = identifiers->unionWith(*(other_group->identifiers)) ? 1 : 0;
+	size = identifiers->getTrueCount();
+	bulk_change(old_size);
+	return return_code;
+}
+
+int Computed_field_element_group::removeElementsInGroup(Computed_field_element_group *other_group)
+{
+	if ((!other_group) || (!Cmiss_mesh_match(master_mesh, other_group->master_mesh)))
+		return 0;
+	if (other_group == this)
+		return clear();
+	const int old_size = size;
+	identifiers->subtract(*(other_group->identifiers));
+	size = identifiers->getTrueCount();
+	bulk_change(old_size);
+	return 1;
+}
+
+int Computed_field_element_group::removeElementsNotInGroup(Computed_field_element_group *other_group)
+{
+	if ((!other_group) || (!Cmiss_mesh_match(master_mesh, other_group->master_mesh)))
+		return 0;
+	if (other_group == this)
+		return 1;
+	const int old_size = size;
+	identifiers->intersectWith(*(other_group->identifiers));
+	size = identifiers->getTrueCount();
+	bulk_change(old_size);
+	return 1;
+}
+
+void Computed_field_element_group::bulk_change(int old_size)
+{
+	// bulk operations only add or only remove, so a change in size is a change
+	if (size > old_size)
 	{
-		Cmiss_region_id region = Cmiss_mesh_get_master_region_internal(master_mesh);
-		Cmiss_field_module_id field_module = Cmiss_region_get_field_module(region);
-		Cmiss_field_cache_id cache = Cmiss_field_module_create_cache(field_module);
-		Cmiss_element_field_is_true_iterator_data data = { cache, conditional_field };
-		return_code = REMOVE_OBJECTS_FROM_LIST_THAT(FE_element)(
-			Cmiss_element_field_is_true_iterator, (void *)&data, object_list);
-		Cmiss_field_cache_destroy(&cache);
-		Cmiss_field_module_destroy(&field_module);
+		change_detail.changeAdd();
+		update();
 	}
-	const int new_size = NUMBER_IN_LIST(FE_element)(object_list);
-	if (new_size != old_size)
+	else if (size < old_size)
 	{
-		if (new_size == 0)
+		if (0 == size)
 			change_detail.changeClear();
 		else
 			change_detail.changeRemove();
 		update();
 	}
-	return return_code;
+}
+
+void Computed_field_element_group::write_statistics() const
+{
+	display_message(INFORMATION_MESSAGE,
+		"Element group: %d elements recorded as identifier bits\n", size);
 }
 
 int Computed_field_element_group::addElementFaces(Cmiss_element_id parent)
 {
 	if (!isParentElementCompatible(parent))
 		return 0;
-	int return_code = 1;
 	int number_of_faces = 0;
 	get_FE_element_number_of_faces(parent, &number_of_faces);
 	Cmiss_element_id face = 0;
-	int number_added = 0;
+	const int old_size = size;
 	for (int i = 0; i < number_of_faces; i++)
 	{
 		if (get_FE_element_face(parent, i, &face) && face)
-		{
-			if (!IS_OBJECT_IN_LIST(FE_element)(face, object_list))
-			{
-				if (ADD_OBJECT_TO_LIST(FE_element)(face, object_list))
-				{
-					++number_added;
-				}
-				else
-				{
-					return_code = 0;
-					break;
-				}
-			}
-		}
-	}
-	if (number_added)
-	{
-		change_detail.changeAdd();
-		update();
+			addIdentifier(FE_element_get_cm_number(face));
 	}
-	return return_code;
+	bulk_change(old_size);
+	return 1;
 };
 
 int Computed_field_element_group::removeElementFaces(Cmiss_element_id parent)
@@ -221,30 +444,17 @@ int Computed_field_element_group::removeElementFaces(Cmiss_element_id parent)
 	int number_of_faces = 0;
 	get_FE_element_number_of_faces(parent, &number_of_faces);
 	Cmiss_element_id face = 0;
-	int number_removed = 0;
+	const int old_size = size;
 	for (int i = 0; i < number_of_faces; i++)
 	{
 		if (get_FE_element_face(parent, i, &face) && face)
-		{
-			if (IS_OBJECT_IN_LIST(FE_element)(face, object_list))
-			{
-				REMOVE_OBJECT_FROM_LIST(FE_element)(face, object_list);
-				++number_removed;
-			}
-		}
-	}
-	if (number_removed)
-	{
-		if (NUMBER_IN_LIST(FE_element)(object_list) == 0)
-			change_detail.changeClear();
-		else
-			change_detail.changeRemove();
-		update();
+			removeIdentifier(FE_element_get_cm_number(face));
 	}
+	bulk_change(old_size);
 	return 1;
 };
 
-int Computed_field_node_group::removeNodesConditional(Cmiss_field_id conditional_field)
+int Computed_field_node_group::addNodesConditional(Cmiss_field_id conditional_field)
 {
 	if (!conditional_field)
 		return 0;
@@ -263,81 +473,164 @@ int Computed_field_node_group::removeNodesConditional(Cmiss_field_id conditional
 	{
 		other_node_group = dynamic_cast<Computed_field_node_group *>(conditional_field->core);
 	}
-	int return_code = 0;
-	const int old_size = NUMBER_IN_LIST(FE_node)(object_list);
-	if (other_node_group)
-	{
-		if (other_node_group->field == field)
-			return clear();
-		if (other_node_group->getSize() < getSize())
+	if (other_node_group && Cmiss_nodeset_match(master_nodeset, other_node_group->master_nodeset))
+		return addNodesInGroup(other_node_group);
+	// only evaluate nodes not already in group
+	std::vector<Cmiss_node_id> nodes;
+	Cmiss_node_iterator_id iter = Cmiss_nodeset_create_node_iterator(master_nodeset);
+	Cmiss_node_id node = 0;
+	while (0 != (node = Cmiss_node_iterator_next_non_access(iter)))
+	{
+		if (!hasIdentifier(get_FE_node_identifier(node)))
+			nodes.push_back(node);
+	}
+	Cmiss_node_iterator_destroy(&iter);
+	Cmiss_region_id region = Cmiss_nodeset_get_master_region_internal(master_nodeset);
+	Cmiss_field_module_id field_module = Cmiss_region_get_field_module(region);
+	std::vector<char> is_true;
+	int return_code = Cmiss_field_evaluate_boolean_at_nodes(field_module, conditional_field, nodes,
+		number_of_threads, is_true);
+	Cmiss_field_module_destroy(&field_module);
+	const int old_size = size;
+	if (return_code)
+	{
+		const int number_of_nodes = static_cast<int>(nodes.size());
+		for (int i = 0; i < number_of_nodes; ++i)
 		{
-			Cmiss_node_iterator_id iter = CREATE_LIST_ITERATOR(FE_node)(other_node_group->object_list);
-			Cmiss_node_id node = 0;
-			while (0 != (node = Cmiss_node_iterator_next_non_access(iter)))
-			{
-				if (IS_OBJECT_IN_LIST(FE_node)(node, object_list))
-					REMOVE_OBJECT_FROM_LIST(FE_node)(node, object_list);
-			}
-			Cmiss_node_iterator_destroy(&iter);
+			if (is_true[i])
+				addIdentifier(get_FE_node_identifier(nodes[i]));
 		}
-		else
+	}
+	bulk_change(old_size);
+	return return_code;
+}
+
+int Computed_field_node_group::removeNodesConditional(Cmiss_field_id conditional_field)
+{
+	if (!conditional_field)
+		return 0;
+	Computed_field_node_group *other_node_group = 0;
+	Cmiss_field_group_id group = Cmiss_field_cast_group(conditional_field);
+	if (group)
+	{
+		Cmiss_field_node_group_id node_group = Cmiss_field_group_get_node_group(group, master_nodeset);
+		Cmiss_field_group_destroy(&group);
+		if (!node_group)
+			return 1;
+		other_node_group = Computed_field_node_group_core_cast(node_group);
+		Cmiss_field_node_group_destroy(&node_group);
+	}
+	else
+	{
+		other_node_group = dynamic_cast<Computed_field_node_group *>(conditional_field->core);
+	}
+	if (other_node_group && Cmiss_nodeset_match(master_nodeset, other_node_group->master_nodeset))
+		return removeNodesInGroup(other_node_group);
+	std::vector<Cmiss_node_id> nodes;
+	nodes.reserve(size);
+	Cmiss_node_iterator_id iter = createIterator();
+	Cmiss_node_id node = 0;
+	while (0 != (node = Cmiss_node_iterator_next_non_access(iter)))
+		nodes.push_back(node);
+	Cmiss_node_iterator_destroy(&iter);
+	Cmiss_region_id region = Cmiss_nodeset_get_master_region_internal(master_nodeset);
+	Cmiss_field_module_id field_module = Cmiss_region_get_field_module(region);
+	std::vector<char> is_true;
+	int return_code = Cmiss_field_evaluate_boolean_at_nodes(field_module, conditional_field, nodes,
+		number_of_threads, is_true);
+	Cmiss_field_module_destroy(&field_module);
+	const int old_size = size;
+	if (return_code)
+	{
+		const int number_of_nodes = static_cast<int>(nodes.size());
+		for (int i = 0; i < number_of_nodes; ++i)
 		{
-			return_code = REMOVE_OBJECTS_FROM_LIST_THAT(FE_node)(
-				FE_node_is_in_list, (void *)other_node_group->object_list, object_list);
+			if (is_true[i])
+				removeIdentifier(get_FE_node_identifier(nodes[i]));
 		}
 	}
-	else
+	bulk_change(old_size);
+	return return_code;
+}
+
+int Computed_field_node_group::addNodesInGroup(Computed_field_node_group *other_group)
+{
+	if ((!other_group) || (!Cmiss_nodeset_match(master_nodeset, other_group->master_nodeset)))
+		return 0;
+	if (other_group == this)
+		return 1;
+	const int old_size = size;
+	int return_code = identifiers->unionWith(*(other_group->identifiers)) ? 1 : 0;
+	size = identifiers->getTrueCount();
+	bulk_change(old_size);
+	return return_code;
+}
+
+int Computed_field_node_group::removeNodesInGroup(Computed_field_node_group *other_group)
+{
+	if ((!other_group) || (!Cmiss_nodeset_match(master_nodeset, other_group->master_nodeset)))
+		return 0;
+	if (other_group == this)
+		return clear();
+	const int old_size = size;
+	identifiers->subtract(*(other_group->identifiers));
+	size = identifiers->getTrueCount();
+	bulk_change(old_size);
+	return 1;
+}
+
+int Computed_field_node_group::removeNodesNotInGroup(Computed_field_node_group *other_group)
+{
+	if ((!other_group) || (!Cmiss_nodeset_match(master_nodeset, other_group->master_nodeset)))
+		return 0;
+	if (other_group == this)
+		return 1;
+	const int old_size = size;
+	identifiers->intersectWith(*(other_group->identifiers));
+	size = identifiers->getTrueCount();
+	bulk_change(old_size);
+	return 1;
+}
+
+void Computed_field_node_group::bulk_change(int old_size)
+{
+	// bulk operations only add or only remove, so a change in size is a change
+	if (size > old_size)
 	{
-		Cmiss_region_id region = Cmiss_nodeset_get_master_region_internal(master_nodeset);
-		Cmiss_field_module_id field_module = Cmiss_region_get_field_module(region);
-		Cmiss_field_cache_id cache = Cmiss_field_module_create_cache(field_module);
-		Cmiss_node_field_is_true_iterator_data data = { cache, conditional_field };
-		return_code = REMOVE_OBJECTS_FROM_LIST_THAT(FE_node)(
-			Cmiss_node_field_is_true_iterator, (void *)&data, object_list);
-		Cmiss_field_cache_destroy(&cache);
-		Cmiss_field_module_destroy(&field_module);
+		change_detail.changeAdd();
+		update();
 	}
-	const int new_size = NUMBER_IN_LIST(FE_node)(object_list);
-	if (new_size != old_size)
+	else if (size < old_size)
 	{
-		if (new_size == 0)
+		if (0 == size)
 			change_detail.changeClear();
 		else
 			change_detail.changeRemove();
 		update();
 	}
-	return return_code;
+}
+
+void Computed_field_node_group::write_statistics() const
+{
+	display_message(INFORMATION_MESSAGE,
+		"Node group: %d nodes recorded as identifier bits\n", size);
 }
 
 int Computed_field_node_group::addElementNodes(Cmiss_element_id element)
 {
 	if (!isParentElementCompatible(element))
 		return 0;
-	int return_code = 1;
 	int number_of_nodes = 0;
 	int number_of_parents = 0;
 	get_FE_element_number_of_nodes(element, &number_of_nodes);
 	Cmiss_node_id node = 0;
-	int number_added = 0;
+	const int old_size = size;
 	if (number_of_nodes)
 	{
 		for (int i = 0; i < number_of_nodes; i++)
 		{
 			if (get_FE_element_node(element, i, &node) && node)
-			{
-				if (!IS_OBJECT_IN_LIST(FE_node)(node, object_list))
-				{
-					if (ADD_OBJECT_TO_LIST(FE_node)(node, object_list))
-					{
-						++number_added;
-					}
-					else
-					{
-						return_code = 0;
-						break;
-					}
-				}
-			}
+				addIdentifier(get_FE_node_identifier(node));
 		}
 	}
 	else if (get_FE_element_number_of_parents(element, &number_of_parents) &&
@@ -354,54 +647,32 @@ int Computed_field_node_group::addElementNodes(Cmiss_element_id element)
 				node = element_field_nodes_array[i];
 				if (node)
 				{
-					if (!IS_OBJECT_IN_LIST(FE_node)(node, object_list))
-					{
-						if (ADD_OBJECT_TO_LIST(FE_node)(node, object_list))
-						{
-							++number_added;
-						}
-						else
-						{
-							display_message(ERROR_MESSAGE, "Could not add node");
-							return_code = 0;
-						}
-					}
+					addIdentifier(get_FE_node_identifier(node));
 					Cmiss_node_destroy(&node);
 				}
 			}
 			DEALLOCATE(element_field_nodes_array);
 		}
 	}
-	if (number_added)
-	{
-		change_detail.changeAdd();
-		update();
-	}
-	return return_code;
+	bulk_change(old_size);
+	return 1;
 };
 
 int Computed_field_node_group::removeElementNodes(Cmiss_element_id element)
 {
 	if (!isParentElementCompatible(element))
 		return 0;
-	int return_code = 1;
 	int number_of_nodes = 0;
 	int number_of_parents = 0;
 	get_FE_element_number_of_nodes(element, &number_of_nodes);
 	Cmiss_node_id node = 0;
-	int number_removed = 0;
+	const int old_size = size;
 	if (number_of_nodes)
 	{
 		for (int i = 0; i < number_of_nodes; i++)
 		{
 			if (get_FE_element_node(element, i, &node) && node)
-			{
-				if (IS_OBJECT_IN_LIST(FE_node)(node, object_list))
-				{
-					REMOVE_OBJECT_FROM_LIST(FE_node)(node, object_list);
-					++number_removed;
-				}
-			}
+				removeIdentifier(get_FE_node_identifier(node));
 		}
 	}
 	else if (get_FE_element_number_of_parents(element, &number_of_parents) &&
@@ -418,26 +689,15 @@ int Computed_field_node_group::removeElementNodes(Cmiss_element_id element)
 				node = element_field_nodes_array[i];
 				if (node)
 				{
-					if (IS_OBJECT_IN_LIST(FE_node)(node, object_list))
-					{
-						REMOVE_OBJECT_FROM_LIST(FE_node)(node, object_list);
-						++number_removed;
-					}
+					removeIdentifier(get_FE_node_identifier(node));
 					Cmiss_node_destroy(&node);
 				}
 			}
 			DEALLOCATE(element_field_nodes_array);
 		}
 	}
-	if (number_removed)
-	{
-		if (NUMBER_IN_LIST(FE_node)(object_list) == 0)
-			change_detail.changeClear();
-		else
-			change_detail.changeRemove();
-		update();
-	}
-	return return_code;
+	bulk_change(old_size);
+	return 1;
 };
 
 Cmiss_field_node_group *Cmiss_field_cast_node_group(Cmiss_field_id field)
@@ -546,7 +806,7 @@ void Cmiss_field_node_group_list_btree_statistics(
 	Computed_field_node_group *node_group_core = Computed_field_node_group_core_cast(node_group);
 	if (node_group_core)
 	{
-		node_group_core->write_btree_statistics();
+		node_group_core->write_statistics();
 	}
 }
 
@@ -556,7 +816,7 @@ void Cmiss_field_element_group_list_btree_statistics(
 	Computed_field_element_group *element_group_core = Computed_field_element_group_core_cast(element_group);
 	if (element_group_core)
 	{
-		element_group_core->write_btree_statistics();
+		element_group_core->write_statistics();
 	}
 }
 
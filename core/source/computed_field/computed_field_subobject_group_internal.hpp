@@ -45,13 +45,13 @@
 #include "zinc/fieldsubobjectgroup.h"
 
 /***************************************************************************//**
- * List statistics about btree structure of node_group.
+ * List statistics about storage of node_group.
  */
 void Cmiss_field_node_group_list_btree_statistics(
 	Cmiss_field_node_group_id node_group);
 
 /***************************************************************************//**
- * List statistics about btree structure of element_group.
+ * List statistics about storage of element_group.
  */
 void Cmiss_field_element_group_list_btree_statistics(
 	Cmiss_field_element_group_id element_group);
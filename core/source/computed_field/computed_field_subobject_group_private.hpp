@@ -48,6 +48,7 @@
 #include "finite_element/finite_element_region.h"
 #include "computed_field/computed_field_group_base.hpp"
 #include "computed_field/computed_field_private.hpp"
+#include "general/block_array.hpp"
 #include "general/cmiss_set.hpp"
 #include "general/debug.h"
 #include "region/cmiss_region.h"
@@ -131,11 +132,30 @@ public:
 
 class Computed_field_subobject_group : public Computed_field_group_base
 {
+protected:
+	// maximum threads for evaluating conditional fields over master objects
+	int number_of_threads;
+
 public:
 
 	Computed_field_subobject_group() :
-		Computed_field_group_base()
+		Computed_field_group_base(),
+		number_of_threads(1)
+	{
+	}
+
+	int getNumberOfThreads() const
+	{
+		return number_of_threads;
+	}
+
+	/** only affects speed of evaluation so no change notification needed */
+	int setNumberOfThreads(int number_of_threads_in)
 	{
+		if (number_of_threads_in < 1)
+			return 0;
+		number_of_threads = number_of_threads_in;
+		return 1;
 	}
 
 	const char* get_type_string()
@@ -344,14 +364,29 @@ public:
 
 	};
 
-	class Computed_field_element_group : public Computed_field_subobject_group
+	/**
+	 * Group of elements of one dimension from a master mesh. Membership is
+	 * recorded only as a bit per element identifier, shared with iterators over
+	 * the group and kept consistent with element removals and renumbering in
+	 * the master FE_region as they happen. Elements with negative identifiers
+	 * cannot be added.
+	 */
+	class Computed_field_element_group : public Computed_field_subobject_group,
+		public FE_region_identifier_observer
 	{
 	private:
 
 		Cmiss_mesh_id master_mesh;
 		const int dimension;
-		struct LIST(FE_element) *object_list;
+		identifier_bool_array *identifiers;
+		int size; // number of true identifiers
 		Cmiss_field_subobject_group_change_detail change_detail;
+		/* incremented on every change so caches built from the group contents
+			can tell whether they are out of date */
+		unsigned int change_counter;
+		/* set when elements removed from the master FE_region are removed from
+			the group, to notify field clients from its next change callback */
+		bool fe_region_change_pending;
 
 	public:
 
@@ -360,17 +395,22 @@ public:
 			// don't want element_groups based on group region FE_region so get master:
 			master_mesh(Cmiss_mesh_get_master(mesh)),
 			dimension(Cmiss_mesh_get_dimension(master_mesh)),
-			object_list(Cmiss_mesh_create_element_list_internal(master_mesh))
+			identifiers(identifier_bool_array::create()),
+			size(0),
+			change_counter(0),
+			fe_region_change_pending(false)
 		{
 			FE_region *fe_region = Cmiss_mesh_get_FE_region_internal(master_mesh);
 			FE_region_add_callback(fe_region, Computed_field_element_group::fe_region_change, (void *)this);
+			FE_region_add_identifier_observer(fe_region, this);
 		}
 
 		~Computed_field_element_group()
 		{
 			FE_region *fe_region = Cmiss_mesh_get_FE_region_internal(master_mesh);
+			FE_region_remove_identifier_observer(fe_region, this);
 			FE_region_remove_callback(fe_region, Computed_field_element_group::fe_region_change, (void *)this);
-			DESTROY(LIST(FE_element))(&object_list);
+			identifier_bool_array::deaccess(identifiers);
 			Cmiss_mesh_destroy(&master_mesh);
 		}
 
@@ -386,9 +426,7 @@ public:
 
 		inline int addObject(FE_element *object)
 		{
-			if (isElementCompatible(object) &&
-				(!IS_OBJECT_IN_LIST(FE_element)(object, object_list)) &&
-				ADD_OBJECT_TO_LIST(FE_element)(object, object_list))
+			if (isElementCompatible(object) && addIdentifier(FE_element_get_cm_number(object)))
 			{
 				change_detail.changeAdd();
 				update();
@@ -399,10 +437,9 @@ public:
 
 		inline int removeObject(FE_element *object)
 		{
-			if (IS_OBJECT_IN_LIST(FE_element)(object, object_list))
+			if (isElementCompatible(object) && removeIdentifier(FE_element_get_cm_number(object)))
 			{
-				REMOVE_OBJECT_FROM_LIST(FE_element)(object, object_list);
-				if (0 == NUMBER_IN_LIST(FE_element)(object_list))
+				if (0 == size)
 				{
 					change_detail.changeClear();
 				}
@@ -416,14 +453,18 @@ public:
 			return 0;
 		};
 
+		/** add all elements from master for which conditional_field is true */
+		int addElementsConditional(Cmiss_field_id conditional_field);
+
 		/** remove all elements for which conditional_field is true */
 		int removeElementsConditional(Cmiss_field_id conditional_field);
 
 		virtual int clear()
 		{
-			if (NUMBER_IN_LIST(FE_element)(object_list))
+			if (size)
 			{
-				REMOVE_ALL_OBJECTS_FROM_LIST(FE_element)(object_list);
+				identifiers->clear();
+				size = 0;
 				change_detail.changeClear();
 				update();
 			}
@@ -432,51 +473,60 @@ public:
 
 		int containsObject(FE_element *object)
 		{
-			int return_code = 0;
-			if (IS_OBJECT_IN_LIST(FE_element)(object, object_list))
-			{
-				return_code = 1;
-			}
-			else
-			{
-				return_code = 0;
-			}
-
-			return (return_code);
+			return (isElementCompatible(object) &&
+				hasIdentifier(FE_element_get_cm_number(object))) ? 1 : 0;
 		};
 
 		Cmiss_element_iterator_id createIterator()
 		{
-			return CREATE_LIST_ITERATOR(FE_element)(object_list);
+			return FE_region_create_element_identifier_iterator(
+				Cmiss_mesh_get_FE_region_internal(master_mesh), dimension, identifiers);
 		}
 
 		/** @return  non-accessed element with that identifier, or 0 if none */
 		inline Cmiss_element_id findElementByIdentifier(int identifier)
 		{
-			struct CM_element_information cm;
-			cm.type = ((dimension == 3) ? CM_ELEMENT : ((dimension == 2) ? CM_FACE : CM_LINE));
-			cm.number = identifier;
-			return FIND_BY_IDENTIFIER_IN_LIST(FE_element,identifier)(&cm, object_list);
+			if (hasIdentifier(identifier))
+			{
+				return FE_region_get_FE_element_from_identifier(
+					Cmiss_mesh_get_FE_region_internal(master_mesh), dimension, identifier);
+			}
+			return 0;
 		}
 
 		int getSize()
 		{
-			return NUMBER_IN_LIST(FE_element)(object_list);
+			return size;
+		}
+
+		/** @return  Counter incremented whenever the group changes */
+		unsigned int getChangeCounter() const
+		{
+			return change_counter;
 		}
 
 		virtual int isEmpty() const
 		{
-			if (NUMBER_IN_LIST(FE_element)(object_list))
-				return 0;
-			else
-				return 1;
+			return (0 == size);
 		}
 
 		virtual int isIdentifierInList(int identifier)
 		{
-			return (0 != findElementByIdentifier(identifier));
+			return hasIdentifier(identifier);
 		}
 
+		/** Add all elements in other group, which must have the same master.
+		 * Single change notification. */
+		int addElementsInGroup(Computed_field_element_group *other_group);
+
+		/** Remove all elements in other group, which must have the same master.
+		 * Single change notification. */
+		int removeElementsInGroup(Computed_field_element_group *other_group);
+
+		/** Remove all elements not in other group, which must have the same
+		 * master, i.e. intersect with it. Single change notification. */
+		int removeElementsNotInGroup(Computed_field_element_group *other_group);
+
 		virtual Cmiss_field_change_detail *extract_change_detail()
 		{
 			if (change_detail.getChange() == CMISS_FIELD_GROUP_NO_CHANGE)
@@ -493,10 +543,7 @@ public:
 			return &change_detail;
 		}
 
-		void write_btree_statistics() const
-		{
-			FE_element_list_write_btree_statistics(object_list);
-		}
+		void write_statistics() const;
 
 		/** ensure parent element's faces are in element group */
 		int addElementFaces(Cmiss_element_id parent);
@@ -504,6 +551,30 @@ public:
 		/** ensure parent element's faces are not in element group */
 		int removeElementFaces(Cmiss_element_id parent);
 
+		virtual void elementRemoved(int element_dimension, int identifier)
+		{
+			if ((element_dimension == dimension) && removeIdentifier(identifier))
+			{
+				fe_region_removed_elements();
+			}
+		}
+
+		virtual void elementIdentifierChanged(int element_dimension,
+			int old_identifier, int new_identifier)
+		{
+			if ((element_dimension == dimension) && removeIdentifier(old_identifier))
+			{
+				if (addIdentifier(new_identifier))
+				{
+					++change_counter;
+				}
+				else
+				{
+					fe_region_removed_elements();
+				}
+			}
+		}
+
 	private:
 
 		Computed_field_core* copy()
@@ -556,47 +627,71 @@ public:
 
 		inline void update()
 		{
+			++change_counter;
 			Computed_field_changed(field);
 		}
 
-		/** remove objects from the group if they are in the supplied list */
-		int removeObjectsNotInFeRegion(struct FE_region *fe_region)
+		inline bool hasIdentifier(int identifier) const
 		{
-			const int old_size = NUMBER_IN_LIST(FE_element)(object_list);
-			int return_code = REMOVE_OBJECTS_FROM_LIST_THAT(FE_element)(
-				FE_element_is_not_in_FE_region, (void *)fe_region, object_list);
-			const int new_size = NUMBER_IN_LIST(FE_element)(object_list);
-			if (new_size != old_size)
+			return (0 <= identifier) && identifiers->getBool(identifier);
+		}
+
+		/** @return  true if identifier added, false if already in group or
+		 * invalid. Caller handles change notification. */
+		inline bool addIdentifier(int identifier)
+		{
+			bool oldValue;
+			if ((0 <= identifier) && identifiers->setBool(identifier, true, oldValue) && !oldValue)
 			{
-				if (new_size == 0)
-					change_detail.changeClear();
-				else
-					change_detail.changeRemove();
-				update();
+				++size;
+				return true;
 			}
-			return return_code;
+			return false;
+		}
+
+		/** @return  true if identifier removed, false if not in group. Caller
+		 * handles change notification. */
+		inline bool removeIdentifier(int identifier)
+		{
+			bool oldValue;
+			if ((0 <= identifier) && identifiers->setBool(identifier, false, oldValue) && oldValue)
+			{
+				--size;
+				return true;
+			}
+			return false;
+		}
+
+		/** Records change after bulk operations on identifiers which may have
+		 * changed membership from old_size */
+		void bulk_change(int old_size);
+
+		/** Records removal of elements by the master FE_region. Field clients are
+		 * told from the next change callback as the region is mid-change. */
+		void fe_region_removed_elements()
+		{
+			if (0 == size)
+				change_detail.changeClear();
+			else
+				change_detail.changeRemove();
+			++change_counter;
+			fe_region_change_pending = true;
 		}
 
 		/***************************************************************************//**
-		 * Callback from <fe_region> with its <changes>. Remove any destroyed elements.
+		 * Callback from <fe_region> with its <changes>. Notifies clients of
+		 * elements removed from the group by the region since the last callback.
 		 */
 		static void fe_region_change(struct FE_region *fe_region,
 			struct FE_region_changes *changes, void *element_group_void)
 		{
 			Computed_field_element_group *element_group =
 				reinterpret_cast<Computed_field_element_group *>(element_group_void);
-			if (fe_region && changes && element_group)
+			if (fe_region && changes && element_group &&
+				element_group->fe_region_change_pending)
 			{
-				int fe_element_change_summary;
-				if (CHANGE_LOG_GET_CHANGE_SUMMARY(FE_element)(
-					changes->fe_element_changes[element_group->dimension - 1], &fe_element_change_summary))
-				{
-					/* remove elements removed from this fe_region */
-					if (fe_element_change_summary & CHANGE_LOG_OBJECT_REMOVED(FE_element))
-					{
-						element_group->removeObjectsNotInFeRegion(fe_region);
-					}
-				}
+				element_group->fe_region_change_pending = false;
+				Computed_field_changed(element_group->field);
 			}
 		}
 
@@ -620,13 +715,24 @@ public:
 
 	};
 
-	class Computed_field_node_group : public Computed_field_subobject_group
+	/**
+	 * Group of nodes from a master nodeset. Membership is recorded only as a
+	 * bit per node identifier, shared with iterators over the group and kept
+	 * consistent with node removals and renumbering in the master FE_region as
+	 * they happen. Nodes with negative identifiers cannot be added.
+	 */
+	class Computed_field_node_group : public Computed_field_subobject_group,
+		public FE_region_identifier_observer
 	{
 	private:
 
 		Cmiss_nodeset_id master_nodeset;
-		struct LIST(FE_node) *object_list;
+		identifier_bool_array *identifiers;
+		int size; // number of true identifiers
 		Cmiss_field_subobject_group_change_detail change_detail;
+		/* set when nodes removed from the master FE_region are removed from the
+			group, to notify field clients from its next change callback */
+		bool fe_region_change_pending;
 
 	public:
 
@@ -634,17 +740,21 @@ public:
 			Computed_field_subobject_group(),
 			// don't want node_groups based on group region FE_region so get master:
 			master_nodeset(Cmiss_nodeset_get_master(nodeset)),
-			object_list(Cmiss_nodeset_create_node_list_internal(master_nodeset))
+			identifiers(identifier_bool_array::create()),
+			size(0),
+			fe_region_change_pending(false)
 		{
 			FE_region *fe_region = Cmiss_nodeset_get_FE_region_internal(master_nodeset);
 			FE_region_add_callback(fe_region, Computed_field_node_group::fe_region_change, (void *)this);
+			FE_region_add_identifier_observer(fe_region, this);
 		}
 
 		~Computed_field_node_group()
 		{
 			FE_region *fe_region = Cmiss_nodeset_get_FE_region_internal(master_nodeset);
+			FE_region_remove_identifier_observer(fe_region, this);
 			FE_region_remove_callback(fe_region, Computed_field_node_group::fe_region_change, (void *)this);
-			DESTROY(LIST(FE_node))(&object_list);
+			identifier_bool_array::deaccess(identifiers);
 			Cmiss_nodeset_destroy(&master_nodeset);
 		}
 
@@ -655,9 +765,7 @@ public:
 
 		inline int addObject(FE_node *object)
 		{
-			if (isNodeCompatible(object) &&
-				(!IS_OBJECT_IN_LIST(FE_node)(object, object_list)) &&
-				ADD_OBJECT_TO_LIST(FE_node)(object, object_list))
+			if (isNodeCompatible(object) && addIdentifier(get_FE_node_identifier(object)))
 			{
 				change_detail.changeAdd();
 				update();
@@ -668,10 +776,9 @@ public:
 
 		inline int removeObject(FE_node *object)
 		{
-			if (IS_OBJECT_IN_LIST(FE_node)(object, object_list))
+			if (isNodeCompatible(object) && removeIdentifier(get_FE_node_identifier(object)))
 			{
-				REMOVE_OBJECT_FROM_LIST(FE_node)(object, object_list);
-				if (0 == NUMBER_IN_LIST(FE_node)(object_list))
+				if (0 == size)
 				{
 					change_detail.changeClear();
 				}
@@ -685,14 +792,18 @@ public:
 			return 0;
 		};
 
+		/** add all nodes from master for which conditional_field is true */
+		int addNodesConditional(Cmiss_field_id conditional_field);
+
 		/** remove all nodes for which conditional_field is true */
 		int removeNodesConditional(Cmiss_field_id conditional_field);
 
 		virtual int clear()
 		{
-			if (NUMBER_IN_LIST(FE_node)(object_list))
+			if (size)
 			{
-				REMOVE_ALL_OBJECTS_FROM_LIST(FE_node)(object_list);
+				identifiers->clear();
+				size = 0;
 				change_detail.changeClear();
 				update();
 			}
@@ -701,38 +812,54 @@ public:
 
 		int containsObject(FE_node *object)
 		{
-			return IS_OBJECT_IN_LIST(FE_node)(object, object_list);
+			return (isNodeCompatible(object) &&
+				hasIdentifier(get_FE_node_identifier(object))) ? 1 : 0;
 		};
 
 		Cmiss_node_iterator_id createIterator()
 		{
-			return CREATE_LIST_ITERATOR(FE_node)(object_list);
+			return FE_region_create_node_identifier_iterator(
+				Cmiss_nodeset_get_FE_region_internal(master_nodeset), identifiers);
 		}
 
 		/** @return  non-accessed node with that identifier, or 0 if none */
 		inline Cmiss_node_id findNodeByIdentifier(int identifier)
 		{
-			return FIND_BY_IDENTIFIER_IN_LIST(FE_node,cm_node_identifier)(identifier, object_list);
+			if (hasIdentifier(identifier))
+			{
+				return FE_region_get_FE_node_from_identifier(
+					Cmiss_nodeset_get_FE_region_internal(master_nodeset), identifier);
+			}
+			return 0;
 		}
 
 		int getSize()
 		{
-			return NUMBER_IN_LIST(FE_node)(object_list);
+			return size;
 		}
 
 		virtual int isEmpty() const
 		{
-			if (NUMBER_IN_LIST(FE_node)(object_list))
-				return 0;
-			else
-				return 1;
+			return (0 == size);
 		}
 
 		virtual int isIdentifierInList(int identifier)
 		{
-			return (0 != findNodeByIdentifier(identifier));
+			return hasIdentifier(identifier);
 		}
 
+		/** Add all nodes in other group, which must have the same master.
+		 * Single change notification. */
+		int addNodesInGroup(Computed_field_node_group *other_group);
+
+		/** Remove all nodes in other group, which must have the same master.
+		 * Single change notification. */
+		int removeNodesInGroup(Computed_field_node_group *other_group);
+
+		/** Remove all nodes not in other group, which must have the same
+		 * master, i.e. intersect with it. Single change notification. */
+		int removeNodesNotInGroup(Computed_field_node_group *other_group);
+
 		virtual Cmiss_field_change_detail *extract_change_detail()
 		{
 			if (change_detail.getChange() == CMISS_FIELD_GROUP_NO_CHANGE)
@@ -749,10 +876,7 @@ public:
 			return &change_detail;
 		}
 
-		void write_btree_statistics() const
-		{
-			FE_node_list_write_btree_statistics(object_list);
-		}
+		void write_statistics() const;
 
 		/** ensure element's nodes are in node group */
 		int addElementNodes(Cmiss_element_id element);
@@ -760,6 +884,22 @@ public:
 		/** ensure element's nodes are not in node group */
 		int removeElementNodes(Cmiss_element_id element);
 
+		virtual void nodeRemoved(int identifier)
+		{
+			if (removeIdentifier(identifier))
+			{
+				fe_region_removed_nodes();
+			}
+		}
+
+		virtual void nodeIdentifierChanged(int old_identifier, int new_identifier)
+		{
+			if (removeIdentifier(old_identifier) && (!addIdentifier(new_identifier)))
+			{
+				fe_region_removed_nodes();
+			}
+		}
+
 	private:
 
 		Computed_field_core* copy()
@@ -808,43 +948,66 @@ public:
 			Computed_field_changed(field);
 		}
 
-		/** remove objects from the group if they are in the supplied list */
-		int removeObjectsNotInFeRegion(struct FE_region *fe_region)
+		inline bool hasIdentifier(int identifier) const
 		{
-			const int old_size = NUMBER_IN_LIST(FE_node)(object_list);
-			int return_code = REMOVE_OBJECTS_FROM_LIST_THAT(FE_node)(
-				FE_node_is_not_in_FE_region, (void *)fe_region, object_list);
-			const int new_size = NUMBER_IN_LIST(FE_node)(object_list);
-			if (new_size != old_size)
+			return (0 <= identifier) && identifiers->getBool(identifier);
+		}
+
+		/** @return  true if identifier added, false if already in group or
+		 * invalid. Caller handles change notification. */
+		inline bool addIdentifier(int identifier)
+		{
+			bool oldValue;
+			if ((0 <= identifier) && identifiers->setBool(identifier, true, oldValue) && !oldValue)
 			{
-				if (new_size == 0)
-					change_detail.changeClear();
-				else
-					change_detail.changeRemove();
-				update();
+				++size;
+				return true;
 			}
-			return return_code;
+			return false;
+		}
+
+		/** @return  true if identifier removed, false if not in group. Caller
+		 * handles change notification. */
+		inline bool removeIdentifier(int identifier)
+		{
+			bool oldValue;
+			if ((0 <= identifier) && identifiers->setBool(identifier, false, oldValue) && oldValue)
+			{
+				--size;
+				return true;
+			}
+			return false;
+		}
+
+		/** Records change after bulk operations on identifiers which may have
+		 * changed membership from old_size */
+		void bulk_change(int old_size);
+
+		/** Records removal of nodes by the master FE_region. Field clients are
+		 * told from the next change callback as the region is mid-change. */
+		void fe_region_removed_nodes()
+		{
+			if (0 == size)
+				change_detail.changeClear();
+			else
+				change_detail.changeRemove();
+			fe_region_change_pending = true;
 		}
 
 		/***************************************************************************//**
-		 * Callback from <fe_region> with its <changes>. Remove any destroyed nodes.
+		 * Callback from <fe_region> with its <changes>. Notifies clients of nodes
+		 * removed from the group by the region since the last callback.
 		 */
 		static void fe_region_change(struct FE_region *fe_region,
 			struct FE_region_changes *changes, void *node_group_void)
 		{
 			Computed_field_node_group *node_group =
 				reinterpret_cast<Computed_field_node_group *>(node_group_void);
-			if (fe_region && changes && node_group)
+			if (fe_region && changes && node_group &&
+				node_group->fe_region_change_pending)
 			{
-				int fe_node_change_summary;
-				if (CHANGE_LOG_GET_CHANGE_SUMMARY(FE_node)(changes->fe_node_changes, &fe_node_change_summary))
-				{
-					/* remove nodes removed from this fe_region */
-					if (fe_node_change_summary & CHANGE_LOG_OBJECT_REMOVED(FE_node))
-					{
-						node_group->removeObjectsNotInFeRegion(fe_region);
-					}
-				}
+				node_group->fe_region_change_pending = false;
+				Computed_field_changed(node_group->field);
 			}
 		}
 
@@ -39,6 +39,7 @@
 
 #include <cstdio>
 #include "zinc/field.h"
+#include "zinc/status.h"
 #include "computed_field/computed_field_find_xi.h"
 #include "finite_element/finite_element.h"
 #include "general/mystring.h"
@@ -66,6 +67,7 @@ RealFieldValueCache::~RealFieldValueCache()
 	}
 	delete[] values;
 	delete[] derivatives;
+	delete[] batchValues;
 }
 
 void RealFieldValueCache::clear()
@@ -221,6 +223,47 @@ int Cmiss_field_cache_set_time(Cmiss_field_cache_id cache, double time)
 	return 1;
 }
 
+int Cmiss_field_cache_get_element_field_values_cache_size(Cmiss_field_cache_id cache)
+{
+	if (cache)
+		return cache->getElementFieldValuesCacheSize();
+	return 0;
+}
+
+int Cmiss_field_cache_set_element_field_values_cache_size(Cmiss_field_cache_id cache,
+	int cache_size)
+{
+	if (cache && (0 < cache_size))
+	{
+		cache->setElementFieldValuesCacheSize(cache_size);
+		return CMISS_OK;
+	}
+	return 0;
+}
+
+int Cmiss_field_cache_get_element_field_values_cache_statistics(
+	Cmiss_field_cache_id cache, int *hits_address, int *misses_address)
+{
+	if (cache && hits_address && misses_address)
+	{
+		*hits_address = cache->getElementFieldValuesCacheHits();
+		*misses_address = cache->getElementFieldValuesCacheMisses();
+		return CMISS_OK;
+	}
+	return 0;
+}
+
+int Cmiss_field_cache_reset_element_field_values_cache_statistics(
+	Cmiss_field_cache_id cache)
+{
+	if (cache)
+	{
+		cache->resetElementFieldValuesCacheStatistics();
+		return CMISS_OK;
+	}
+	return 0;
+}
+
 int Cmiss_field_cache_set_element(Cmiss_field_cache_id cache,
 	Cmiss_element_id element)
 {
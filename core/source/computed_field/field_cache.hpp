@@ -72,11 +72,13 @@ private:
 
 public:
 	int evaluationCounter; // set to Cmiss_field_cache::locationCounter when field evaluated
+	int batchEvaluationCounter; // set to Cmiss_field_cache::batchCounter when field batch evaluated
 	int derivatives_valid; // only relevant to real caches, but having here saves a virtual function call
 
 	FieldValueCache() :
 		extraCache(0),
 		evaluationCounter(-1),
+		batchEvaluationCounter(-1),
 		derivatives_valid(0)
 	{
 	}
@@ -86,6 +88,7 @@ public:
 	void resetEvaluationCounter()
 	{
 		evaluationCounter = -1;
+		batchEvaluationCounter = -1;
 	}
 
 	/** override to clear type-specific buffer information & call this */
@@ -124,6 +127,15 @@ private:
 	ValueCacheVector valueCaches;
 	bool assignInCache;
 	int access_count;
+	int batchCounter; // incremented whenever batch of locations changes
+	int batchSize;
+	Cmiss_element_id batchElement; // not accessed: batch valid only until clearBatch()
+	int batchDimension;
+	const FE_value *batchChartCoordinates; // not owned
+	const Cmiss_node_id *batchNodes; // not owned
+	int elementFieldValuesCacheSize; // maximum elements with interpolation data kept per FE field
+	int elementFieldValuesCacheHits;
+	int elementFieldValuesCacheMisses;
 
 	/** call whenever location changes to increment location counter */
 	void locationChanged()
@@ -142,6 +154,21 @@ private:
 		}
 	}
 
+	/** call whenever batch locations change to increment batch counter */
+	void batchChanged()
+	{
+		++batchCounter;
+		if (batchCounter < 0)
+		{
+			batchCounter = 0;
+			for (unsigned int i = 0; i < valueCaches.size(); ++i)
+			{
+				if (valueCaches[i])
+					valueCaches[i]->resetEvaluationCounter();
+			}
+		}
+	}
+
 public:
 
 	Cmiss_field_cache(Cmiss_region_id region) :
@@ -151,7 +178,16 @@ public:
 		requestedDerivatives(0),
 		valueCaches(Cmiss_region_get_field_cache_size(region), (FieldValueCache*)0),
 		assignInCache(false),
-		access_count(1)
+		access_count(1),
+		batchCounter(0),
+		batchSize(0),
+		batchElement(0),
+		batchDimension(0),
+		batchChartCoordinates(0),
+		batchNodes(0),
+		elementFieldValuesCacheSize(1000),
+		elementFieldValuesCacheHits(0),
+		elementFieldValuesCacheMisses(0)
 	{
 		Cmiss_region_add_field_cache(region, this);
 	}
@@ -220,6 +256,45 @@ public:
 		}
 	}
 
+	int getElementFieldValuesCacheSize() const
+	{
+		return elementFieldValuesCacheSize;
+	}
+
+	/** Note: existing finite element field value caches are trimmed on next use */
+	void setElementFieldValuesCacheSize(int cacheSize)
+	{
+		elementFieldValuesCacheSize = cacheSize;
+	}
+
+	int getElementFieldValuesCacheHits() const
+	{
+		return elementFieldValuesCacheHits;
+	}
+
+	int getElementFieldValuesCacheMisses() const
+	{
+		return elementFieldValuesCacheMisses;
+	}
+
+	/** call when element field values are found in cache for a finite element field */
+	void elementFieldValuesCacheHit()
+	{
+		++elementFieldValuesCacheHits;
+	}
+
+	/** call when element field values must be calculated for a finite element field */
+	void elementFieldValuesCacheMiss()
+	{
+		++elementFieldValuesCacheMisses;
+	}
+
+	void resetElementFieldValuesCacheStatistics()
+	{
+		elementFieldValuesCacheHits = 0;
+		elementFieldValuesCacheMisses = 0;
+	}
+
 	int getRequestedDerivatives()
 	{
 		return requestedDerivatives;
@@ -237,22 +312,124 @@ public:
 	int setMeshLocation(Cmiss_element_id element, const double *chart_coordinates,
 		Cmiss_element_id top_level_element = 0)
 	{
-		FE_value time = location->get_time();
-		delete location;
-		location = new Field_element_xi_location(element, chart_coordinates, time, top_level_element);
+		// reuse existing element_xi location to avoid heap allocation per point
+		Field_element_xi_location *element_xi_location = dynamic_cast<Field_element_xi_location*>(location);
+		if (element_xi_location && chart_coordinates)
+		{
+			element_xi_location->set_element_xi(element, MAXIMUM_ELEMENT_XI_DIMENSIONS,
+				chart_coordinates, top_level_element);
+			element_xi_location->set_number_of_derivatives(0);
+		}
+		else
+		{
+			FE_value time = location->get_time();
+			delete location;
+			location = new Field_element_xi_location(element, chart_coordinates, time, top_level_element);
+		}
 		locationChanged();
 		return 1;
 	}
 
 	int setNode(Cmiss_node_id node)
 	{
-		FE_value time = location->get_time();
-		delete location;
-		location = new Field_node_location(node, time);
+		Field_node_location *node_location = dynamic_cast<Field_node_location*>(location);
+		if (node_location)
+		{
+			node_location->set_node(node);
+			node_location->set_number_of_derivatives(0);
+		}
+		else
+		{
+			FE_value time = location->get_time();
+			delete location;
+			location = new Field_node_location(node, time);
+		}
 		locationChanged();
 		return 1;
 	}
 
+	/**
+	 * Prescribe a batch of chart locations in a single element for subsequent
+	 * batch evaluation. Arrays are not copied so caller must keep them valid
+	 * until clearBatch() is called.
+	 * @param chartCoordinates  Array of numberOfPoints*element dimension values.
+	 */
+	void setMeshLocationBatch(Cmiss_element_id element, int numberOfPoints,
+		const FE_value *chartCoordinates)
+	{
+		batchElement = element;
+		batchDimension = get_FE_element_dimension(element);
+		batchSize = numberOfPoints;
+		batchChartCoordinates = chartCoordinates;
+		batchNodes = 0;
+		batchChanged();
+	}
+
+	/**
+	 * Prescribe a batch of node locations for subsequent batch evaluation.
+	 * Array is not copied so caller must keep it valid until clearBatch().
+	 */
+	void setNodeBatch(int numberOfNodes, const Cmiss_node_id *nodes)
+	{
+		batchElement = 0;
+		batchDimension = 0;
+		batchSize = numberOfNodes;
+		batchChartCoordinates = 0;
+		batchNodes = nodes;
+		batchChanged();
+	}
+
+	void clearBatch()
+	{
+		batchElement = 0;
+		batchDimension = 0;
+		batchSize = 0;
+		batchChartCoordinates = 0;
+		batchNodes = 0;
+		batchChanged();
+	}
+
+	int getBatchCounter() const
+	{
+		return batchCounter;
+	}
+
+	int getBatchSize() const
+	{
+		return batchSize;
+	}
+
+	/** @return  Element for mesh location batch, or NULL if node batch */
+	Cmiss_element_id getBatchElement() const
+	{
+		return batchElement;
+	}
+
+	/** @return  Chart coordinates for mesh location batch, stride = element dimension */
+	const FE_value *getBatchChartCoordinates() const
+	{
+		return batchChartCoordinates;
+	}
+
+	int getBatchDimension() const
+	{
+		return batchDimension;
+	}
+
+	/** @return  Nodes for node batch, or NULL if mesh location batch */
+	const Cmiss_node_id *getBatchNodes() const
+	{
+		return batchNodes;
+	}
+
+	/** Set single location to point at index in batch, for per-point evaluation */
+	int setBatchPointLocation(int index)
+	{
+		if (batchElement)
+			return setMeshLocation(batchElement, batchChartCoordinates + index*batchDimension);
+		return setNode(batchNodes[index]);
+	}
+
 	int setFieldReal(Cmiss_field_id field, int numberOfValues, const double *values);
 
 	int setFieldRealWithDerivatives(Cmiss_field_id field, int numberOfValues, const double *values,
@@ -264,7 +441,7 @@ public:
 	}
 
 	/** call if new field added to initialise value cache, and when cache created for field */
-	// NOT THREAD SAFE
+	// NOT THREAD SAFE: must not be called while another thread evaluates with this cache
 	void setValueCache(int cacheIndex, FieldValueCache* valueCache)
 	{
 		if (cacheIndex < static_cast<int>(valueCaches.size()))
@@ -316,13 +493,17 @@ public:
 	int componentCount;
 	FE_value *values, *derivatives;
 	Computed_field_find_element_xi_cache *find_element_xi_cache;
+	int batchCapacity; // number of points batchValues is allocated for
+	FE_value *batchValues; // values at batch points: [point*componentCount + component]
 
 	RealFieldValueCache(int componentCount) :
 		FieldValueCache(),
 		componentCount(componentCount),
 		values(new FE_value[componentCount]),
 		derivatives(new FE_value[componentCount*MAXIMUM_ELEMENT_XI_DIMENSIONS]),
-		find_element_xi_cache(0)
+		find_element_xi_cache(0),
+		batchCapacity(0),
+		batchValues(0)
 	{
 	}
 
@@ -380,6 +561,17 @@ public:
 
 	virtual char *getAsString();
 
+	/** Ensure batchValues has space for numberOfPoints. Existing values are lost. */
+	void reserveBatch(int numberOfPoints)
+	{
+		if (numberOfPoints > batchCapacity)
+		{
+			delete[] batchValues;
+			batchValues = new FE_value[numberOfPoints*componentCount];
+			batchCapacity = numberOfPoints;
+		}
+	}
+
 	void setValues(const FE_value *values_in)
 	{
 		for (int i = 0; i < componentCount; ++i)
@@ -0,0 +1,202 @@
+/***************************************************************************//**
+ * FILE : field_dof_derivatives.hpp
+ *
+ * Internal classes for evaluating sparse derivatives of field values with
+ * respect to degrees of freedom (DOFs) e.g. nodal parameters being optimised.
+ */
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is cmgui.
+ *
+ * The Initial Developer of the Original Code is
+ * Auckland Uniservices Ltd, Auckland, New Zealand.
+ * Portions created by the Initial Developer are Copyright (C) 2013
+ * the Initial Developer. All Rights Reserved.
+ *
+ * Contributor(s):
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+#if !defined (FIELD_DOF_DERIVATIVES_HPP)
+#define FIELD_DOF_DERIVATIVES_HPP
+
+#include <map>
+#include <vector>
+#include "general/value.h"
+
+/**
+ * Maps the storage addresses of DOFs, i.e. nodal parameters and constant field
+ * values, to their index in the vector of DOFs being solved for.
+ */
+class FieldDofMap
+{
+	std::map<const FE_value *, int> dofIndexes;
+
+public:
+	void clear()
+	{
+		dofIndexes.clear();
+	}
+
+	void addDof(const FE_value *storage, int dofIndex)
+	{
+		dofIndexes[storage] = dofIndex;
+	}
+
+	/** @return  Index of DOF with storage at address, or -1 if not a DOF */
+	int getDofIndex(const FE_value *storage) const
+	{
+		std::map<const FE_value *, int>::const_iterator iter = dofIndexes.find(storage);
+		if (iter != dofIndexes.end())
+			return iter->second;
+		return -1;
+	}
+
+	bool isEmpty() const
+	{
+		return dofIndexes.empty();
+	}
+};
+
+/**
+ * Sparse derivatives of all components of a field value with respect to DOFs.
+ * Each entry holds a DOF index and the derivative of each component with
+ * respect to it, with at most one entry per DOF.
+ */
+class FieldDofDerivatives
+{
+	int componentCount;
+	std::vector<int> dofIndexes;
+	std::vector<FE_value> derivatives;
+	std::map<int, int> entryIndexes; // map from DOF index to entry
+
+public:
+	FieldDofDerivatives(int componentCountIn = 1) :
+		componentCount(componentCountIn)
+	{
+	}
+
+	/** Clear all entries and optionally change the number of components */
+	void clear(int componentCountIn = 0)
+	{
+		if (componentCountIn > 0)
+			componentCount = componentCountIn;
+		dofIndexes.clear();
+		derivatives.clear();
+		entryIndexes.clear();
+	}
+
+	int getComponentCount() const
+	{
+		return componentCount;
+	}
+
+	int getEntryCount() const
+	{
+		return static_cast<int>(dofIndexes.size());
+	}
+
+	int getDofIndex(int entry) const
+	{
+		return dofIndexes[entry];
+	}
+
+	const FE_value *getDerivatives(int entry) const
+	{
+		return &(derivatives[entry*componentCount]);
+	}
+
+	/** Get component derivatives for DOF, adding them with zero values if not
+	 * already present. Pointer is invalidated by adding further DOFs. */
+	FE_value *getDofDerivatives(int dofIndex)
+	{
+		std::map<int, int>::iterator iter = entryIndexes.find(dofIndex);
+		int entry;
+		if (iter != entryIndexes.end())
+		{
+			entry = iter->second;
+		}
+		else
+		{
+			entry = static_cast<int>(dofIndexes.size());
+			entryIndexes[dofIndex] = entry;
+			dofIndexes.push_back(dofIndex);
+			derivatives.resize(derivatives.size() + componentCount, 0.0);
+		}
+		return &(derivatives[entry*componentCount]);
+	}
+
+	/** Multiply all derivatives by scale */
+	void scale(FE_value scaleFactor)
+	{
+		for (std::vector<FE_value>::iterator iter = derivatives.begin(); iter != derivatives.end(); ++iter)
+			*iter *= scaleFactor;
+	}
+
+	/** Add derivatives from source with the same number of components, each
+	 * multiplied by scale. */
+	void addScaled(const FieldDofDerivatives& source, FE_value scaleFactor)
+	{
+		const int sourceEntryCount = source.getEntryCount();
+		for (int s = 0; s < sourceEntryCount; ++s)
+		{
+			FE_value *destination = getDofDerivatives(source.getDofIndex(s));
+			const FE_value *sourceDerivatives = source.getDerivatives(s);
+			for (int i = 0; i < componentCount; ++i)
+				destination[i] += scaleFactor*sourceDerivatives[i];
+		}
+	}
+
+	/** Add derivatives from source with the same number of components, each
+	 * multiplied by the scale for its component. */
+	void addComponentScaled(const FieldDofDerivatives& source, const FE_value *componentScales)
+	{
+		const int sourceEntryCount = source.getEntryCount();
+		for (int s = 0; s < sourceEntryCount; ++s)
+		{
+			FE_value *destination = getDofDerivatives(source.getDofIndex(s));
+			const FE_value *sourceDerivatives = source.getDerivatives(s);
+			for (int i = 0; i < componentCount; ++i)
+				destination[i] += componentScales[i]*sourceDerivatives[i];
+		}
+	}
+
+	/** Add derivative of the sum of all components, multiplied by scale, to
+	 * dense array indexed by DOF index. */
+	void accumulateSum(FE_value scaleFactor, FE_value *dofValues) const
+	{
+		const int entryCount = getEntryCount();
+		for (int e = 0; e < entryCount; ++e)
+		{
+			const FE_value *entryDerivatives = getDerivatives(e);
+			FE_value sum = 0.0;
+			for (int i = 0; i < componentCount; ++i)
+				sum += entryDerivatives[i];
+			dofValues[dofIndexes[e]] += scaleFactor*sum;
+		}
+	}
+};
+
+#endif /* !defined (FIELD_DOF_DERIVATIVES_HPP) */
@@ -28,6 +28,8 @@
 #cmakedefine USE_GLEW
 #cmakedefine USE_PNG
 #cmakedefine USE_TIFF
+#cmakedefine USE_OPENMP
+#cmakedefine USE_OSMESA
 
 // Miscellaneous defines
 #cmakedefine HAVE_VFSCANF
@@ -59,6 +59,7 @@ Functions for exporting finite element data to a file.
 #include "general/object.h"
 #include "region/cmiss_region_write_info.h"
 #include "general/message.h"
+#include <cstring>
 #include <iostream>
 #include <sstream>
 #include <fstream>
@@ -84,6 +85,7 @@ struct Write_FE_region_element_data
 	struct FE_element *last_element;
 	struct FE_region *fe_region;
 	FE_value time;
+	int binary_values;
 }; /* struct Write_FE_region_element_data */
 
 struct Write_FE_node_field_values
@@ -92,6 +94,7 @@ struct Write_FE_node_field_values
 	/* store number of values for writing nodal values in columns */
 	int number_of_values;
 	FE_value time;
+	int binary_values;
 };
 
 struct Write_FE_node_field_info_sub
@@ -110,6 +113,7 @@ struct Write_FE_region_node_data
 	struct FE_field_order_info *field_order_info;
 	struct FE_node *last_node;
 	FE_value time;
+	int binary_values;
 }; /* struct Write_FE_region_node_data */
 
 /*
@@ -117,6 +121,20 @@ Module functions
 ----------------
 */
 
+/***************************************************************************//**
+ * Writes a block of <number_of_values> values of <value_size> bytes in native
+ * binary form. The block is introduced by a '<' marker so the reader can find
+ * its exact start after skipping white space, and is followed by a newline.
+ */
+static void write_binary_values(ostream *output_file, const void *values,
+	size_t value_size, int number_of_values)
+{
+	(*output_file) << " <";
+	output_file->write(static_cast<const char *>(values),
+		static_cast<streamsize>(value_size*number_of_values));
+	(*output_file) << "\n";
+}
+
 static int write_element_xi_value(ostream *output_file,struct FE_element *element,
 	FE_value *xi)
 /*******************************************************************************
@@ -1404,7 +1422,8 @@ Writes grid-based values stored with the element.
 static int write_FE_element(ostream *output_file,struct FE_element *element,
 	struct FE_field_order_info *field_order_info,
 	int output_number_of_nodes,int *output_node_indices,
-	int output_number_of_scale_factors,int *output_scale_factor_indices)
+	int output_number_of_scale_factors,int *output_scale_factor_indices,
+	int binary_values)
 /*******************************************************************************
 LAST MODIFIED : 20 March 2003
 
@@ -1437,6 +1456,8 @@ Notes:
 - If <field_order_info> is specified then only values for the listed fields
   are output.
 - Function uses output_* parameters set up by write_FE_element_field_info.
+- If <binary_values> is set, the nodes and scale factors are each written as a
+  single binary block following their token.
 ==============================================================================*/
 {
 	FE_value scale_factor;
@@ -1515,7 +1536,42 @@ Notes:
 			/* write the nodes */
 			if (get_FE_element_number_of_nodes(element, &number_of_nodes))
 			{
-				if (0 < number_of_nodes)
+				if ((0 < number_of_nodes) && binary_values)
+				{
+					(*output_file) << " Nodes:";
+					int *node_numbers;
+					if (ALLOCATE(node_numbers, int, number_of_nodes))
+					{
+						int number_of_output_nodes = 0;
+						for (i = 0; i < number_of_nodes; i++)
+						{
+							if (0 <= output_node_indices[i])
+							{
+								if (get_FE_element_node(element, i, &node) && node)
+								{
+									node_numbers[number_of_output_nodes] = get_FE_node_identifier(node);
+									number_of_output_nodes++;
+								}
+								else
+								{
+									display_message(ERROR_MESSAGE,
+										"write_FE_element.  Missing node");
+									return_code = 0;
+								}
+							}
+						}
+						write_binary_values(output_file, node_numbers, sizeof(int),
+							number_of_output_nodes);
+						DEALLOCATE(node_numbers);
+					}
+					else
+					{
+						display_message(ERROR_MESSAGE,
+							"write_FE_element.  Could not allocate node numbers");
+						return_code = 0;
+					}
+				}
+				else if (0 < number_of_nodes)
 				{
 					(*output_file) << " Nodes:\n";
 					for (i = 0; i < number_of_nodes; i++)
@@ -1549,7 +1605,34 @@ Notes:
 			if (get_FE_element_number_of_scale_factors(element,
 				&total_number_of_scale_factors))
 			{
-				if (0 < total_number_of_scale_factors)
+				if ((0 < total_number_of_scale_factors) && binary_values)
+				{
+					(*output_file) << " Scale factors:";
+					FE_value *scale_factors;
+					if (ALLOCATE(scale_factors, FE_value, total_number_of_scale_factors))
+					{
+						number_of_scale_factors = 0;
+						for (i = 0; i < total_number_of_scale_factors; i++)
+						{
+							if (0 <= output_scale_factor_indices[i])
+							{
+								get_FE_element_scale_factor(element, i,
+									&(scale_factors[number_of_scale_factors]));
+								number_of_scale_factors++;
+							}
+						}
+						write_binary_values(output_file, scale_factors, sizeof(FE_value),
+							number_of_scale_factors);
+						DEALLOCATE(scale_factors);
+					}
+					else
+					{
+						display_message(ERROR_MESSAGE,
+							"write_FE_element.  Could not allocate scale factors");
+						return_code = 0;
+					}
+				}
+				else if (0 < total_number_of_scale_factors)
 				{
 					(*output_file) << " Scale factors:\n";
 					number_of_scale_factors=0;
@@ -1824,7 +1907,8 @@ in the header.
 					write_elements_data->output_number_of_nodes,
 					write_elements_data->output_node_indices,
 					write_elements_data->output_number_of_scale_factors,
-					write_elements_data->output_scale_factor_indices);
+					write_elements_data->output_scale_factor_indices,
+					write_elements_data->binary_values);
 				write_elements_data->last_element = element;
 			}
 			else
@@ -2017,24 +2101,32 @@ Writes out the nodal values. Each component or version starts on a new line.
 					if (get_FE_nodal_field_FE_value_values(field,node,&number_of_values,
 							values_data->time, &values))
 					{
-						value=values;
-						for (i=0;i<number_of_components;i++)
+						if (values_data->binary_values)
 						{
-							number_of_versions=
-								get_FE_node_field_component_number_of_versions(node,field,i);
-							number_of_derivatives=
-								get_FE_node_field_component_number_of_derivatives(node,field,i);
-							for (j=number_of_versions;0<j;j--)
+							write_binary_values(output_file, values, sizeof(FE_value),
+								number_of_values);
+						}
+						else
+						{
+							value=values;
+							for (i=0;i<number_of_components;i++)
 							{
-								for (k=0;k<=number_of_derivatives;k++)
+								number_of_versions=
+									get_FE_node_field_component_number_of_versions(node,field,i);
+								number_of_derivatives=
+									get_FE_node_field_component_number_of_derivatives(node,field,i);
+								for (j=number_of_versions;0<j;j--)
 								{
-									char num_string[100];
-									sprintf(num_string, "%"FE_VALUE_STRING, *value);
+									for (k=0;k<=number_of_derivatives;k++)
+									{
+										char num_string[100];
+										sprintf(num_string, "%"FE_VALUE_STRING, *value);
 
-									(*output_file) << " " << num_string;
-									value++;
+										(*output_file) << " " << num_string;
+										value++;
+									}
+									(*output_file) << "\n";
 								}
-								(*output_file) << "\n";
 							}
 						}
 						DEALLOCATE(values);
@@ -2047,21 +2139,29 @@ Writes out the nodal values. Each component or version starts on a new line.
 					if (get_FE_nodal_field_int_values(field,node,&number_of_values,
 							values_data->time, &values))
 					{
-						value=values;
-						for (i=0;i<number_of_components;i++)
+						if (values_data->binary_values)
+						{
+							write_binary_values(output_file, values, sizeof(int),
+								number_of_values);
+						}
+						else
 						{
-							number_of_derivatives=
-								get_FE_node_field_component_number_of_derivatives(node,field,i);
-							number_of_versions=
-								get_FE_node_field_component_number_of_versions(node,field,i);
-							for (j=number_of_versions;0<j;j--)
+							value=values;
+							for (i=0;i<number_of_components;i++)
 							{
-								for (k=0;k<=number_of_derivatives;k++)
+								number_of_derivatives=
+									get_FE_node_field_component_number_of_derivatives(node,field,i);
+								number_of_versions=
+									get_FE_node_field_component_number_of_versions(node,field,i);
+								for (j=number_of_versions;0<j;j--)
 								{
-									(*output_file) << " " << *value;
-									value++;
+									for (k=0;k<=number_of_derivatives;k++)
+									{
+										(*output_file) << " " << *value;
+										value++;
+									}
+									(*output_file) << "\n";
 								}
-								(*output_file) << "\n";
 							}
 						}
 						DEALLOCATE(values);
@@ -2119,14 +2219,16 @@ Writes out the nodal values. Each component or version starts on a new line.
 } /* write_FE_node_field_values */
 
 static int write_FE_node(ostream *output_file,struct FE_node *node,
-	struct FE_field_order_info *field_order_info, FE_value time)
+	struct FE_field_order_info *field_order_info, FE_value time,
+	int binary_values)
 /*******************************************************************************
 LAST MODIFIED : 27 February 2003
 
 DESCRIPTION :
 Writes out a node to an <output_file>. Unless <field_order_info> is non-NULL and
 contains the fields to be written if defined, all fields defined at the node are
-written.
+written. If <binary_values> is set, real and integer values are written as
+binary blocks.
 ==============================================================================*/
 {
 	int i, number_of_fields, return_code;
@@ -2140,6 +2242,7 @@ written.
 		values_data.output_file = output_file;
 		values_data.number_of_values = 0;
 		values_data.time = time;
+		values_data.binary_values = binary_values;
 		if (field_order_info)
 		{
 			number_of_fields =
@@ -2405,7 +2508,8 @@ has been selected for output) then the header is written out.
 					}
 				}
 			}
-			write_FE_node(output_file, node, field_order_info, write_nodes_data->time);
+			write_FE_node(output_file, node, field_order_info, write_nodes_data->time,
+				write_nodes_data->binary_values);
 			/* remember the last node to check if header needs to be re-output */
 			write_nodes_data->last_node = node;
 		}
@@ -2427,7 +2531,8 @@ static int write_Cmiss_region_content(ostream *output_file,
 	enum FE_write_fields_mode write_fields_mode,
 	int number_of_field_names, char **field_names, int *field_names_counter,
 	FE_value time,
-	enum FE_write_criterion write_criterion)
+	enum FE_write_criterion write_criterion,
+	enum FE_write_format write_format)
 /*******************************************************************************
 LAST MODIFIED : 27 February 2003
 
@@ -2497,6 +2602,7 @@ FE_WRITE_WITH_ANY_LISTED_FIELDS =
 				write_nodes_data.field_order_info = field_order_info;
 				write_nodes_data.last_node = (struct FE_node *)NULL;
 				write_nodes_data.time = time;
+				write_nodes_data.binary_values = (write_format == FE_WRITE_FORMAT_BINARY);
 				Cmiss_nodeset_id nodeset = Cmiss_field_module_find_nodeset_by_name(field_module,
 					write_data ? "cmiss_data" : "cmiss_nodes");
 				if (group)
@@ -2535,6 +2641,7 @@ FE_WRITE_WITH_ANY_LISTED_FIELDS =
 				write_elements_data.fe_region = fe_region;
 				write_elements_data.last_element = (struct FE_element *)NULL;
 				write_elements_data.time = time;
+				write_elements_data.binary_values = (write_format == FE_WRITE_FORMAT_BINARY);
 				/* write 1-D, 2-D then 3-D so lines and faces precede elements */
 				for (int dimension = 1; dimension <= 3; dimension++)
 				{
@@ -2618,6 +2725,7 @@ FE_WRITE_WITH_ANY_LISTED_FIELDS =
  *   limit output to nodes or objects with any or all listed fields defined.
  * @param write_recursion  Controls whether sub-regions and sub-groups are
  *   recursively written.
+ * @param write_format  Controls whether values are written as text or binary.
  */
 static int write_Cmiss_region(ostream *output_file,
 	struct Cmiss_region *region, Cmiss_field_group_id group,
@@ -2627,7 +2735,8 @@ static int write_Cmiss_region(ostream *output_file,
 	int number_of_field_names, char **field_names, int *field_names_counter,
 	FE_value time,
 	enum FE_write_criterion write_criterion,
-	enum FE_write_recursion write_recursion)
+	enum FE_write_recursion write_recursion,
+	enum FE_write_format write_format)
 {
 	int return_code;
 
@@ -2661,7 +2770,7 @@ static int write_Cmiss_region(ostream *output_file,
 			return_code = write_Cmiss_region_content(output_file, region, group,
 				write_elements, write_nodes, write_data,
 				write_fields_mode, number_of_field_names, field_names,
-				field_names_counter, time, write_criterion);
+				field_names_counter, time, write_criterion, write_format);
 		}
 
 		if (return_code && !group && ((write_recursion == FE_WRITE_RECURSIVE) ||
@@ -2682,7 +2791,7 @@ static int write_Cmiss_region(ostream *output_file,
 					return_code = write_Cmiss_region_content(output_file, region, output_group,
 						write_elements, write_nodes, write_data,
 						FE_WRITE_NO_FIELDS, number_of_field_names, field_names,
-						field_names_counter, time, write_criterion);
+						field_names_counter, time, write_criterion, write_format);
 					Cmiss_field_group_destroy(&output_group);
 				}
 			}
@@ -2704,7 +2813,8 @@ static int write_Cmiss_region(ostream *output_file,
 						child_region, child_group, root_region,
 						write_elements, write_nodes, write_data,
 						write_fields_mode, number_of_field_names, field_names,
-						field_names_counter, time, write_criterion, write_recursion);
+						field_names_counter, time, write_criterion, write_recursion,
+						write_format);
 					if (child_group)
 						Cmiss_field_group_destroy(&child_group);
 				}
@@ -2822,6 +2932,9 @@ DEFINE_DEFAULT_ENUMERATOR_FUNCTIONS(FE_write_recursion)
  *   limit output to nodes or objects with any or all listed fields defined.
  * @param write_recursion  Controls whether sub-regions and sub-groups are
  *   recursively written.
+ * @param write_format  Controls whether values are written as text or binary.
+ *   Binary files start with a version line which the reader uses to detect
+ *   them.
  */
 int write_exregion_file(ostream *output_file,
 	struct Cmiss_region *region, Cmiss_field_group_id group,
@@ -2830,7 +2943,8 @@ int write_exregion_file(ostream *output_file,
 	enum FE_write_fields_mode write_fields_mode,
 	int number_of_field_names, char **field_names, FE_value time,
 	enum FE_write_criterion write_criterion,
-	enum FE_write_recursion write_recursion)
+	enum FE_write_recursion write_recursion,
+	enum FE_write_format write_format)
 {
 	int return_code;
 
@@ -2854,11 +2968,21 @@ int write_exregion_file(ostream *output_file,
 					}
 				}
 			}
+			if (write_format == FE_WRITE_FORMAT_BINARY)
+			{
+				/* binary values are native: record the layout for the reader */
+				const int endian_test = 1;
+				(*output_file) << "Binary values: version=" << EX_BINARY_VALUES_VERSION
+					<< ", byte_order=" <<
+					((1 == *(reinterpret_cast<const char *>(&endian_test))) ? "little" : "big")
+					<< ", real_size=" << sizeof(FE_value)
+					<< ", integer_size=" << sizeof(int) << "\n";
+			}
 			return_code = write_Cmiss_region(output_file,
 				region, group, root_region,
 				write_elements, write_nodes, write_data,
 				write_fields_mode, number_of_field_names, field_names, field_names_counter,
-				time, write_criterion, write_recursion);
+				time, write_criterion, write_recursion, write_format);
 			if (field_names_counter)
 			{
 				if (write_fields_mode == FE_WRITE_LISTED_FIELDS)
@@ -2906,7 +3030,8 @@ int write_exregion_file_of_name(const char *file_name,
 	enum FE_write_fields_mode write_fields_mode,
 	int number_of_field_names, char **field_names, FE_value time,
 	enum FE_write_criterion write_criterion,
-	enum FE_write_recursion write_recursion)	
+	enum FE_write_recursion write_recursion,
+	enum FE_write_format write_format)
 {
 	int return_code;
 
@@ -2914,13 +3039,20 @@ int write_exregion_file_of_name(const char *file_name,
 	if (file_name)
 	{
 		ofstream output_file;
-		output_file.open(file_name, ios::out);
+		if (write_format == FE_WRITE_FORMAT_BINARY)
+		{
+			output_file.open(file_name, ios::out | ios::binary);
+		}
+		else
+		{
+			output_file.open(file_name, ios::out);
+		}
 		if (output_file.is_open())
 		{
 			return_code = write_exregion_file(&output_file, region, group, root_region,
 				write_elements, write_nodes, write_data,
 				write_fields_mode, number_of_field_names, field_names, time,
-				write_criterion, write_recursion);
+				write_criterion, write_recursion, write_format);
 			output_file.close();
 		}
 		else
@@ -2949,6 +3081,7 @@ int write_exregion_file_to_memory_block(
 	int number_of_field_names, char **field_names, FE_value time,
 	enum FE_write_criterion write_criterion,
 	enum FE_write_recursion write_recursion,
+	enum FE_write_format write_format,
 	void **memory_block, unsigned int *memory_block_length)
 {
 	int return_code;
@@ -2962,10 +3095,21 @@ int write_exregion_file_to_memory_block(
 			return_code = write_exregion_file(&stringStream, region, group, root_region,
 				write_elements, write_nodes, write_data,
 				write_fields_mode, number_of_field_names, field_names, time,
-				write_criterion, write_recursion);
+				write_criterion, write_recursion, write_format);
 			string sstring = stringStream.str();
-			*memory_block_length = sstring.size();
-			*memory_block = duplicate_string(sstring.c_str());
+			/* copy by length as binary values may contain null characters */
+			char *memory_string = NULL;
+			if (ALLOCATE(memory_string, char, sstring.size() + 1))
+			{
+				memcpy(memory_string, sstring.data(), sstring.size());
+				memory_string[sstring.size()] = '\0';
+				*memory_block_length = sstring.size();
+				*memory_block = memory_string;
+			}
+			else
+			{
+				return_code = 0;
+			}
 		}
 		else
 		{
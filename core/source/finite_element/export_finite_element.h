@@ -87,6 +87,20 @@ enum FE_write_recursion
 	FE_WRITE_NON_RECURSIVE /**< write only the selected region with no sub-groups */
 };
 
+/**
+ * Enumeration controlling how numerical values are written to the EX file.
+ */
+enum FE_write_format
+{
+	FE_WRITE_FORMAT_TEXT, /**< write all values as text */
+	FE_WRITE_FORMAT_BINARY /**< write node values, element nodes and scale factors
+		as blocks of native binary values. Headers remain text */
+};
+
+/** Version of binary value blocks written with FE_WRITE_FORMAT_BINARY. Readers
+ * must reject files with a later version. */
+#define EX_BINARY_VALUES_VERSION 1
+
 /*
 Global/Public functions
 -----------------------
@@ -103,6 +117,8 @@ PROTOTYPE_ENUMERATOR_FUNCTIONS(FE_write_recursion);
  * @param group  Optional subgroup to output.
  * @param root_region  The root region output paths are relative to.
  * @param file_name  Name of file. 
+ * @param write_format  Whether values are written as text or binary. Binary
+ *   files are opened in binary mode.
  * @see write_exregion_file.
  */
 int write_exregion_file_of_name(const char *file_name,
@@ -112,7 +128,8 @@ int write_exregion_file_of_name(const char *file_name,
 	enum FE_write_fields_mode write_fields_mode,
 	int number_of_field_names, char **field_names, FE_value time,
 	enum FE_write_criterion write_criterion,
-	enum FE_write_recursion write_recursion);
+	enum FE_write_recursion write_recursion,
+	enum FE_write_format write_format);
 
 int write_exregion_file_to_memory_block(
 	struct Cmiss_region *region, Cmiss_field_group_id group,
@@ -122,6 +139,7 @@ int write_exregion_file_to_memory_block(
 	int number_of_field_names, char **field_names, FE_value time,
 	enum FE_write_criterion write_criterion,
 	enum FE_write_recursion write_recursion,
+	enum FE_write_format write_format,
 	void **memory_block, unsigned int *memory_block_length);
 
 #endif /* !defined (EXPORT_FINITE_ELEMENT_H) */
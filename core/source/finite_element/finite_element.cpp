@@ -53,10 +53,13 @@ Functions for manipulating finite element structures.
 /*???DB.  Testing */
 #define DOUBLE_FOR_DOT_PRODUCT
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdlib>
 #include <cstdio>
+#include <vector>
 #include "general/cmiss_set.hpp"
+#include "general/block_array.hpp"
 #include "general/indexed_list_stl_private.hpp"
 #include "general/list_btree_private.hpp"
 #include <math.h>
@@ -171,7 +174,7 @@ the point and the Xi coordinates of the point within the element.
 
 	inline FE_field *access()
 	{
-		++access_count;
+		cmiss_atomic_increment(&access_count);
 		return this;
 	}
 
@@ -329,7 +332,7 @@ DESCRIPTION :
 
 	inline FE_node *access()
 	{
-		++access_count;
+		cmiss_atomic_increment(&access_count);
 		return this;
 	}
 
@@ -407,15 +410,51 @@ const int CMISS_NODE_BTREE_ORDER = 10;
 
 typedef Cmiss_btree<Cmiss_node,int,CMISS_NODE_BTREE_ORDER> Cmiss_set_Cmiss_node;
 
+/**
+ * Iterates over all nodes in the container, or if identifiers are supplied
+ * just those with a true identifier, found in the container as the iterator
+ * advances.
+ */
 struct Cmiss_node_iterator : public Cmiss_set_Cmiss_node::ext_iterator
 {
 	int access_count;
-	Cmiss_node_iterator(Cmiss_set_Cmiss_node *container) :
+	identifier_bool_array *identifiers;
+	int next_identifier;
+
+	Cmiss_node_iterator(Cmiss_set_Cmiss_node *container,
+			identifier_bool_array *identifiers_in = 0) :
 		Cmiss_set_Cmiss_node::ext_iterator(container),
-		access_count(1)
+		access_count(1),
+		identifiers(identifiers_in ? identifiers_in->access() : 0),
+		next_identifier(0)
 	{
 	}
 
+	~Cmiss_node_iterator()
+	{
+		identifier_bool_array::deaccess(identifiers);
+	}
+
+	Cmiss_node *next_non_access()
+	{
+		if (!identifiers)
+			return Cmiss_set_Cmiss_node::ext_iterator::next_non_access();
+		while ((0 <= next_identifier) && identifiers->updateNextTrueIndex(next_identifier))
+		{
+			Cmiss_node *node = this->container->find_object_by_identifier(next_identifier);
+			++next_identifier;
+			if (node)
+				return node;
+		}
+		return 0;
+	}
+
+	Cmiss_node *next()
+	{
+		Cmiss_node *node = next_non_access();
+		return node ? node->access() : 0;
+	}
+
 	Cmiss_node_iterator_id access()
 	{
 		++access_count;
@@ -872,7 +911,7 @@ variables.
 
 	inline FE_element *access()
 	{
-		++access_count;
+		cmiss_atomic_increment(&access_count);
 		return this;
 	}
 
@@ -966,14 +1005,51 @@ const int CMISS_ELEMENT_BTREE_ORDER = 10;
 
 typedef Cmiss_btree<Cmiss_element,const CM_element_information *,CMISS_ELEMENT_BTREE_ORDER,Cmiss_element_identifier_less> Cmiss_set_Cmiss_element;
 
+/**
+ * Iterates over all elements in the container, or if identifiers are supplied
+ * just those with a true identifier, found in the container as the iterator
+ * advances.
+ */
 struct Cmiss_element_iterator : public Cmiss_set_Cmiss_element::ext_iterator
 {
 	int access_count;
+	identifier_bool_array *identifiers;
+	CM_element_information next_identifier;
 
-	Cmiss_element_iterator(Cmiss_set_Cmiss_element *container) :
+	Cmiss_element_iterator(Cmiss_set_Cmiss_element *container,
+			identifier_bool_array *identifiers_in = 0, CM_element_type type = CM_ELEMENT) :
 		Cmiss_set_Cmiss_element::ext_iterator(container),
-		access_count(1)
+		access_count(1),
+		identifiers(identifiers_in ? identifiers_in->access() : 0)
+	{
+		next_identifier.type = type;
+		next_identifier.number = 0;
+	}
+
+	~Cmiss_element_iterator()
+	{
+		identifier_bool_array::deaccess(identifiers);
+	}
+
+	Cmiss_element *next_non_access()
+	{
+		if (!identifiers)
+			return Cmiss_set_Cmiss_element::ext_iterator::next_non_access();
+		while ((0 <= next_identifier.number) &&
+			identifiers->updateNextTrueIndex(next_identifier.number))
+		{
+			Cmiss_element *element = this->container->find_object_by_identifier(&next_identifier);
+			++(next_identifier.number);
+			if (element)
+				return element;
+		}
+		return 0;
+	}
+
+	Cmiss_element *next()
 	{
+		Cmiss_element *element = next_non_access();
+		return element ? element->access() : 0;
 	}
 
 	Cmiss_element_iterator_id access()
@@ -4169,7 +4245,7 @@ for the information and sets <*node_field_info_address> to NULL.
 	return (return_code);
 } /* DESTROY(FE_node_field_info) */
 
-DECLARE_ACCESS_OBJECT_FUNCTION(FE_node_field_info)
+DECLARE_ATOMIC_ACCESS_OBJECT_FUNCTION(FE_node_field_info)
 
 PROTOTYPE_DEACCESS_OBJECT_FUNCTION(FE_node_field_info)
 /*******************************************************************************
@@ -4189,11 +4265,11 @@ deaccesses the info, it is destroyed in this function.
 	ENTER(DEACCESS(FE_node_field_info));
 	if (object_address && (object = *object_address))
 	{
-		(object->access_count)--;
+		const int access_count = cmiss_atomic_decrement(&(object->access_count));
 		return_code = 1;
-		if (object->access_count <= 1)
+		if (access_count <= 1)
 		{
-			if (1 == object->access_count)
+			if (1 == access_count)
 			{
 				if (object->fe_region)
 				{
@@ -4239,15 +4315,15 @@ deaccesses the info, it is destroyed in this function.
 		if (new_object)
 		{
 			/* access the new object */
-			(new_object->access_count)++;
+			cmiss_atomic_increment(&(new_object->access_count));
 		}
 		if (NULL != (current_object = *object_address))
 		{
 			/* deaccess the current object */
-			(current_object->access_count)--;
-			if (current_object->access_count <= 1)
+			const int access_count = cmiss_atomic_decrement(&(current_object->access_count));
+			if (access_count <= 1)
 			{
-				if (1 == current_object->access_count)
+				if (1 == access_count)
 				{
 					if (current_object->fe_region)
 					{
@@ -6976,6 +7052,33 @@ function fails if two faces have the same shape and share the same nodes.
 	return (return_code);
 } /* FE_element_face_line_to_element_type_node_sequence_list */
 
+int FE_element_get_coordinate_node_identifiers(struct FE_element *element,
+	std::vector<int>& node_identifiers)
+{
+	int number_of_nodes = 0;
+	struct FE_node **nodes_in_element = (struct FE_node **)NULL;
+	node_identifiers.clear();
+	if (element && calculate_FE_element_field_nodes(element, (struct FE_field *)NULL,
+		&number_of_nodes, &nodes_in_element,
+		/*top_level_element*/(struct FE_element *)NULL))
+	{
+		for (int i = 0; i < number_of_nodes; i++)
+		{
+			node_identifiers.push_back(nodes_in_element[i]->cm_node_identifier);
+			DEACCESS(FE_node)(nodes_in_element + i);
+		}
+		DEALLOCATE(nodes_in_element);
+		std::sort(node_identifiers.begin(), node_identifiers.end());
+	}
+	if (0 == node_identifiers.size())
+	{
+		display_message(ERROR_MESSAGE, "FE_element_get_coordinate_node_identifiers.  "
+			"Could not get nodes in element");
+		return 0;
+	}
+	return 1;
+}
+
 static int node_on_axis(struct FE_node *node,struct FE_field *field,
 	FE_value time, enum Coordinate_system_type coordinate_system_type)
 /*******************************************************************************
@@ -7759,7 +7862,7 @@ Outputs the information contained in <field>.
 	return (return_code);
 } /* list_FE_field */
 
-DECLARE_OBJECT_FUNCTIONS(FE_field)
+DECLARE_ATOMIC_OBJECT_FUNCTIONS(FE_field)
 
 DECLARE_DEFAULT_GET_OBJECT_NAME_FUNCTION(FE_field)
 
@@ -10759,7 +10862,7 @@ Frees the memory for the node, sets <*node_address> to NULL.
 	return (return_code);
 } /* DESTROY(FE_node) */
 
-DECLARE_OBJECT_FUNCTIONS(FE_node)
+DECLARE_ATOMIC_OBJECT_FUNCTIONS(FE_node)
 
 PROTOTYPE_COPY_OBJECT_FUNCTION(FE_node)
 /*******************************************************************************
@@ -14961,6 +15064,15 @@ DECLARE_FIND_BY_IDENTIFIER_IN_INDEXED_LIST_BTREE_FUNCTION(FE_node,cm_node_identi
 DECLARE_INDEXED_LIST_BTREE_IDENTIFIER_CHANGE_FUNCTIONS(FE_node,cm_node_identifier)
 DECLARE_CREATE_INDEXED_LIST_BTREE_ITERATOR_FUNCTION(FE_node,Cmiss_node_iterator)
 
+Cmiss_node_iterator_id FE_node_list_create_identifier_iterator(
+	struct LIST(FE_node) *node_list, identifier_bool_array *identifiers)
+{
+	Cmiss_set_Cmiss_node *container = reinterpret_cast<Cmiss_set_Cmiss_node *>(node_list);
+	if (container && identifiers)
+		return new Cmiss_node_iterator(container, identifiers);
+	return 0;
+}
+
 Cmiss_node_iterator_id Cmiss_node_iterator_access(Cmiss_node_iterator_id node_iterator)
 {
 	return node_iterator->access();
@@ -18850,7 +18962,7 @@ memory for the information and sets <*element_field_info_address> to NULL.
 	return (return_code);
 } /* DESTROY(FE_element_field_info) */
 
-DECLARE_ACCESS_OBJECT_FUNCTION(FE_element_field_info)
+DECLARE_ATOMIC_ACCESS_OBJECT_FUNCTION(FE_element_field_info)
 
 PROTOTYPE_DEACCESS_OBJECT_FUNCTION(FE_element_field_info)
 /*******************************************************************************
@@ -18871,11 +18983,11 @@ deaccesses the info, it is destroyed in this function.
 	ENTER(DEACCESS(FE_element_field_info));
 	if (object_address && (object = *object_address))
 	{
-		(object->access_count)--;
+		const int access_count = cmiss_atomic_decrement(&(object->access_count));
 		return_code = 1;
-		if (object->access_count <= 1)
+		if (access_count <= 1)
 		{
-			if (1 == object->access_count)
+			if (1 == access_count)
 			{
 				if (object->fe_region)
 				{
@@ -18922,15 +19034,15 @@ deaccesses the info, it is destroyed in this function.
 		if (new_object)
 		{
 			/* access the new object */
-			(new_object->access_count)++;
+			cmiss_atomic_increment(&(new_object->access_count));
 		}
 		if (NULL != (current_object = *object_address))
 		{
 			/* deaccess the current object */
-			(current_object->access_count)--;
-			if (current_object->access_count <= 1)
+			const int access_count = cmiss_atomic_decrement(&(current_object->access_count));
+			if (access_count <= 1)
 			{
-				if (1 == current_object->access_count)
+				if (1 == access_count)
 				{
 					if (current_object->fe_region)
 					{
@@ -21396,7 +21508,7 @@ sets <*element_shape_address> to NULL.
 	return (return_code);
 } /* DESTROY(FE_element_shape) */
 
-DECLARE_OBJECT_FUNCTIONS(FE_element_shape)
+DECLARE_ATOMIC_OBJECT_FUNCTIONS(FE_element_shape)
 DECLARE_LIST_FUNCTIONS(FE_element_shape)
 
 #if (MAXIMUM_ELEMENT_XI_DIMENSIONS > 3)
@@ -21894,6 +22006,13 @@ If fails, puts zero at <dimension_address>.
 	return (return_code);
 } /* get_FE_element_shape_dimension */
 
+int FE_element_shape_get_number_of_faces(struct FE_element_shape *element_shape)
+{
+	if (element_shape)
+		return element_shape->number_of_faces;
+	return 0;
+}
+
 int FE_element_shape_find_face_number_for_xi(struct FE_element_shape *shape,
 	FE_value *xi, int *face_number)
 /*******************************************************************************
@@ -22690,13 +22809,28 @@ Frees the memory for the element, sets <*element_address> to NULL.
 	return (return_code);
 } /* DESTROY(FE_element) */
 
-DECLARE_OBJECT_FUNCTIONS(FE_element)
+DECLARE_ATOMIC_OBJECT_FUNCTIONS(FE_element)
 
 DECLARE_INDEXED_LIST_BTREE_FUNCTIONS(FE_element)
 DECLARE_FIND_BY_IDENTIFIER_IN_INDEXED_LIST_BTREE_FUNCTION(FE_element,identifier,const CM_element_information *)
 DECLARE_INDEXED_LIST_BTREE_IDENTIFIER_CHANGE_FUNCTIONS(FE_element,identifier)
 DECLARE_CREATE_INDEXED_LIST_BTREE_ITERATOR_FUNCTION(FE_element,Cmiss_element_iterator)
 
+Cmiss_element_iterator_id FE_element_list_create_identifier_iterator(
+	struct LIST(FE_element) *element_list, int dimension,
+	identifier_bool_array *identifiers)
+{
+	Cmiss_set_Cmiss_element *container = reinterpret_cast<Cmiss_set_Cmiss_element *>(element_list);
+	if (container && (1 <= dimension) &&
+		(dimension <= MAXIMUM_ELEMENT_XI_DIMENSIONS) && identifiers)
+	{
+		const CM_element_type type = (dimension == 3) ? CM_ELEMENT :
+			((dimension == 2) ? CM_FACE : CM_LINE);
+		return new Cmiss_element_iterator(container, identifiers, type);
+	}
+	return 0;
+}
+
 Cmiss_element_iterator_id Cmiss_element_iterator_access(Cmiss_element_iterator_id element_iterator)
 {
 	return element_iterator->access();
@@ -24623,6 +24757,434 @@ NB.  The nodes need to be DEACCESS'd before the nodes array is DEALLOCATE'd.
 	return (return_code);
 } /* calculate_FE_element_field_nodes */
 
+FE_element_field_component_nodal_value_map::~FE_element_field_component_nodal_value_map()
+{
+	DEALLOCATE(standard_basis_arguments);
+}
+
+namespace {
+
+/** Nodal value storage contributing to an element value, and its coefficient */
+struct FE_element_value_term
+{
+	int element_value_index;
+	FE_value *value_storage;
+	FE_value coefficient;
+};
+
+/**
+ * Adds term for nodal value <value_index> of <global_values>. For time-varying
+ * values adds terms for the two times interpolated between.
+ */
+void FE_element_value_terms_add(std::vector<FE_element_value_term>& terms,
+	int element_value_index, Value_storage *global_values, int value_index,
+	FE_value coefficient, struct FE_time_sequence *time_sequence,
+	int time_index_one, int time_index_two, FE_value time_xi)
+{
+	FE_element_value_term term;
+	term.element_value_index = element_value_index;
+	if (time_sequence)
+	{
+		FE_value *array = *((FE_value **)global_values + value_index);
+		term.value_storage = array + time_index_one;
+		term.coefficient = (1.0 - time_xi)*coefficient;
+		terms.push_back(term);
+		term.value_storage = array + time_index_two;
+		term.coefficient = time_xi*coefficient;
+	}
+	else
+	{
+		term.value_storage = (FE_value *)global_values + value_index;
+		term.coefficient = coefficient;
+	}
+	terms.push_back(term);
+}
+
+} // anonymous namespace
+
+/**
+ * Gets the nodal value storage each element value of a node-based component
+ * of <element_field> is calculated from, with its coefficient, as used by
+ * global_to_element_map_values. Element values are not modified or blended.
+ * @param number_of_element_values_address  Receives number of element values.
+ * @return  1 on success, 0 on failure.
+ */
+static int global_to_element_map_value_terms(struct FE_element *element,
+	struct FE_element_field *element_field, FE_value time, int component_number,
+	int *number_of_element_values_address, std::vector<FE_element_value_term>& terms)
+{
+	terms.clear();
+	struct FE_field *field = element_field->field;
+	struct FE_element_field_component *component = element_field->components[component_number];
+	if (!(element->information && element->information->nodes &&
+		(FE_VALUE_VALUE == field->value_type) && component &&
+		((STANDARD_NODE_TO_ELEMENT_MAP == component->type) ||
+			(GENERAL_NODE_TO_ELEMENT_MAP == component->type))))
+	{
+		display_message(ERROR_MESSAGE, "global_to_element_map_value_terms.  Invalid argument(s)");
+		return 0;
+	}
+	struct FE_node **nodes = element->information->nodes;
+	const int number_of_element_nodes = element->information->number_of_nodes;
+	const FE_value *scale_factors = element->information->scale_factors;
+	const int number_of_scale_factors = (scale_factors) ?
+		element->information->number_of_scale_factors : 0;
+	const bool standard = (STANDARD_NODE_TO_ELEMENT_MAP == component->type);
+	const int number_of_maps = (standard) ?
+		component->map.standard_node_based.number_of_nodes :
+		component->map.general_node_based.number_of_nodes;
+	int element_value_index = 0;
+	for (int m = 0; m < number_of_maps; ++m)
+	{
+		struct Standard_node_to_element_map *standard_node_map = 0;
+		struct General_node_to_element_map *general_node_map = 0;
+		int node_index = -1;
+		int number_of_nodal_values = 0;
+		if (standard)
+		{
+			standard_node_map = component->map.standard_node_based.node_to_element_maps[m];
+			if (standard_node_map && standard_node_map->nodal_value_indices &&
+				standard_node_map->scale_factor_indices)
+			{
+				node_index = standard_node_map->node_index;
+				number_of_nodal_values = standard_node_map->number_of_nodal_values;
+			}
+		}
+		else
+		{
+			general_node_map = component->map.general_node_based.node_to_element_maps[m];
+			if (general_node_map && general_node_map->element_values)
+			{
+				node_index = general_node_map->node_index;
+				number_of_nodal_values = general_node_map->number_of_nodal_values;
+			}
+		}
+		struct FE_node *node = ((0 <= node_index) && (node_index < number_of_element_nodes)) ?
+			nodes[node_index] : 0;
+		struct FE_node_field *node_field = (node && node->fields) ?
+			FIND_BY_IDENTIFIER_IN_LIST(FE_node_field,field)(field, node->fields->node_field_list) : 0;
+		if (!((0 < number_of_nodal_values) && node_field && node_field->components &&
+			node->values_storage))
+		{
+			display_message(ERROR_MESSAGE, "global_to_element_map_value_terms.  "
+				"Invalid node to element map or field %s not defined at node for element %d",
+				field->name, element->identifier.number);
+			return 0;
+		}
+		const int number_of_global_values = node->fields->number_of_values;
+		Value_storage *global_values = node->values_storage +
+			node_field->components[component_number].value;
+		if (standard)
+		{
+			struct FE_time_sequence *time_sequence = node_field->time_sequence;
+			int time_index_one = 0, time_index_two = 0;
+			FE_value time_xi = 0.0;
+			if (time_sequence)
+			{
+				FE_time_sequence_get_interpolation_for_time(time_sequence, time,
+					&time_index_one, &time_index_two, &time_xi);
+			}
+			for (int k = 0; k < number_of_nodal_values; ++k)
+			{
+				/* no nodal value gives 0; no scale factor gives 1 */
+				const int value_index = standard_node_map->nodal_value_indices[k];
+				if ((0 <= value_index) && (value_index < number_of_global_values))
+				{
+					const int scale_index = standard_node_map->scale_factor_indices[k];
+					const FE_value scale_factor = ((0 <= scale_index) &&
+						(scale_index < number_of_scale_factors)) ? scale_factors[scale_index] : 1.0;
+					FE_element_value_terms_add(terms, element_value_index, global_values,
+						value_index, scale_factor, time_sequence, time_index_one, time_index_two, time_xi);
+				}
+				++element_value_index;
+			}
+		}
+		else
+		{
+			/* as for global_to_element_map_values, time is ignored */
+			for (int k = 0; k < number_of_nodal_values; ++k)
+			{
+				struct Linear_combination_of_global_values *linear_combination =
+					general_node_map->element_values[k];
+				if (!(linear_combination && linear_combination->global_value_indices &&
+					linear_combination->coefficient_indices))
+				{
+					display_message(ERROR_MESSAGE,
+						"global_to_element_map_value_terms.  Missing linear combination");
+					return 0;
+				}
+				for (int l = 0; l < linear_combination->number_of_global_values; ++l)
+				{
+					const int value_index = linear_combination->global_value_indices[l];
+					if ((0 <= value_index) && (value_index < number_of_global_values))
+					{
+						const int scale_index = linear_combination->coefficient_indices[l];
+						const FE_value coefficient = ((0 <= scale_index) &&
+							(scale_index < number_of_scale_factors)) ? scale_factors[scale_index] : 1.0;
+						FE_element_value_terms_add(terms, element_value_index, global_values,
+							value_index, coefficient, (struct FE_time_sequence *)NULL, 0, 0, 0.0);
+					}
+				}
+				++element_value_index;
+			}
+		}
+	}
+	*number_of_element_values_address = element_value_index;
+	return 1;
+}
+
+int calculate_FE_element_field_nodal_value_maps(struct FE_element *element,
+	struct FE_field *field, FE_value time, struct FE_element *top_level_element,
+	std::vector<FE_element_field_component_nodal_value_map *>& component_maps)
+{
+	component_maps.clear();
+	if (!(element && element->shape && field))
+	{
+		display_message(ERROR_MESSAGE,
+			"calculate_FE_element_field_nodal_value_maps.  Invalid argument(s)");
+		return 0;
+	}
+	const int number_of_components = field->number_of_components;
+	component_maps.resize(number_of_components, (FE_element_field_component_nodal_value_map *)NULL);
+	if (GENERAL_FE_FIELD != field->fe_field_type)
+		return 1;
+	struct FE_element_field *element_field = (struct FE_element_field *)NULL;
+	struct FE_element *field_element = (struct FE_element *)NULL;
+	FE_value *coordinate_transformation = (FE_value *)NULL;
+	if (!(inherit_FE_element_field(element, field, &element_field, &field_element,
+		&coordinate_transformation, top_level_element) && element_field))
+	{
+		display_message(ERROR_MESSAGE,
+			"calculate_FE_element_field_nodal_value_maps.  %s not defined for element %d",
+			field->name, element->identifier.number);
+		return 0;
+	}
+	int return_code = 1;
+	const int element_dimension = element->shape->dimension;
+	std::vector<FE_element_value_term> terms;
+	for (int c = 0; (c < number_of_components) && return_code; ++c)
+	{
+		struct FE_element_field_component *component = element_field->components[c];
+		if (!((STANDARD_NODE_TO_ELEMENT_MAP == component->type) ||
+			(GENERAL_NODE_TO_ELEMENT_MAP == component->type)))
+		{
+			continue;
+		}
+		int number_of_element_values = 0;
+		if (!global_to_element_map_value_terms(field_element, element_field, time, c,
+			&number_of_element_values, terms))
+		{
+			return_code = 0;
+			break;
+		}
+		struct FE_basis *basis = component->basis;
+		if (FE_basis_get_number_of_functions(basis) != number_of_element_values)
+		{
+			display_message(ERROR_MESSAGE,
+				"calculate_FE_element_field_nodal_value_maps.  Invalid basis");
+			return_code = 0;
+			break;
+		}
+		FE_element_field_component_nodal_value_map *component_map =
+			new FE_element_field_component_nodal_value_map();
+		component_maps[c] = component_map;
+		FE_value *blending_matrix = (FE_value *)NULL;
+		if (!calculate_standard_basis_transformation(basis, coordinate_transformation,
+			element_dimension, &(component_map->standard_basis_arguments),
+			&(component_map->number_of_basis_values),
+			&(component_map->standard_basis_function), &blending_matrix))
+		{
+			return_code = 0;
+			break;
+		}
+		const int number_of_basis_values = component_map->number_of_basis_values;
+		const int number_of_blended_values = FE_basis_get_number_of_blended_functions(basis);
+		if (number_of_blended_values > 0)
+		{
+			FE_value *combined_blending_matrix = FE_basis_calculate_combined_blending_matrix(
+				basis, number_of_blended_values, number_of_basis_values, blending_matrix);
+			DEALLOCATE(blending_matrix);
+			blending_matrix = combined_blending_matrix;
+			if (!blending_matrix)
+			{
+				display_message(ERROR_MESSAGE, "calculate_FE_element_field_nodal_value_maps.  "
+					"Could not allocate combined_blending_matrix");
+				return_code = 0;
+				break;
+			}
+		}
+		/* blending matrix has a row of basis weights for each element value */
+		const size_t number_of_terms = terms.size();
+		component_map->value_storages.resize(number_of_terms);
+		component_map->weights.resize(number_of_terms*number_of_basis_values);
+		FE_value *weight = (0 < number_of_terms) ? &(component_map->weights[0]) : 0;
+		for (size_t t = 0; t < number_of_terms; ++t)
+		{
+			component_map->value_storages[t] = terms[t].value_storage;
+			const FE_value *transformation =
+				blending_matrix + terms[t].element_value_index*number_of_basis_values;
+			for (int j = 0; j < number_of_basis_values; ++j)
+			{
+				*weight = terms[t].coefficient*transformation[j];
+				++weight;
+			}
+		}
+		DEALLOCATE(blending_matrix);
+	}
+	DEALLOCATE(coordinate_transformation);
+	if (!return_code)
+	{
+		for (int c = 0; c < number_of_components; ++c)
+		{
+			delete component_maps[c];
+		}
+		component_maps.clear();
+	}
+	return return_code;
+}
+
+int FE_element_get_face_node_identifiers(struct FE_element *element,
+	int face_number, struct FE_element_shape *face_shape, int line_number,
+	std::vector<int>& node_identifiers)
+{
+	node_identifiers.clear();
+	if (!(element && element->shape && element->shape->face_to_element &&
+		element->fields && element->information &&
+		(0 <= face_number) && (face_number < element->shape->number_of_faces)))
+	{
+		return 0;
+	}
+	/* only the coordinate field defined on element itself, as inherited by a
+		new face whose only parent is element */
+	struct FE_field *field = (struct FE_field *)NULL;
+	FOR_EACH_OBJECT_IN_LIST(FE_element_field)(
+		FE_element_field_get_first_coordinate_field, (void *)&field,
+		element->fields->element_field_list);
+	struct FE_element_field *element_field = (field) ? FIND_BY_IDENTIFIER_IN_LIST(
+		FE_element_field, field)(field, element->fields->element_field_list) : 0;
+	if (!element_field)
+	{
+		return 0;
+	}
+	const int dimension = element->shape->dimension;
+	const FE_value *face_to_element =
+		element->shape->face_to_element + face_number*dimension*dimension;
+	FE_value coordinate_transformation[MAXIMUM_ELEMENT_XI_DIMENSIONS*MAXIMUM_ELEMENT_XI_DIMENSIONS];
+	int sub_dimension = dimension - 1;
+	if (line_number < 0)
+	{
+		for (int i = 0; i < dimension*dimension; ++i)
+		{
+			coordinate_transformation[i] = face_to_element[i];
+		}
+	}
+	else
+	{
+		if (!(face_shape && face_shape->face_to_element &&
+			(face_shape->dimension == sub_dimension) &&
+			(line_number < face_shape->number_of_faces)))
+		{
+			return 0;
+		}
+		/* incorporate the line to face map as inherit_FE_element_field does */
+		const FE_value *line_to_face =
+			face_shape->face_to_element + line_number*sub_dimension*sub_dimension;
+		FE_value *transformation_value = coordinate_transformation;
+		for (int i = 0; i < dimension; ++i)
+		{
+			const FE_value *face_row = face_to_element + i*dimension;
+			for (int j = 0; j < sub_dimension; ++j)
+			{
+				double sum = (0 == j) ? (double)face_row[0] : 0.0;
+				for (int k = 0; k < sub_dimension; ++k)
+				{
+					sum += (double)face_row[k + 1]*(double)line_to_face[k*sub_dimension + j];
+				}
+				*transformation_value = (FE_value)sum;
+				++transformation_value;
+			}
+		}
+		--sub_dimension;
+	}
+	int return_code = 1;
+	const int number_of_components = element_field->field->number_of_components;
+	for (int component_number = 0; return_code && (component_number < number_of_components);
+		++component_number)
+	{
+		struct FE_element_field_component *component = element_field->components[component_number];
+		if ((STANDARD_NODE_TO_ELEMENT_MAP != component->type) &&
+			(GENERAL_NODE_TO_ELEMENT_MAP != component->type))
+		{
+			continue;
+		}
+		int number_of_element_values = 0;
+		struct FE_node **element_values = (struct FE_node **)NULL;
+		/* silently give up on any failure: creating the face reports it */
+		if (!(global_to_element_map_nodes(component, element, element_field->field,
+			&number_of_element_values, &element_values) && element_values))
+		{
+			return_code = 0;
+			break;
+		}
+		struct FE_basis *basis = component->basis;
+		int *inherited_basis_arguments = (int *)NULL;
+		int number_of_inherited_values = 0;
+		Standard_basis_function *standard_basis_function;
+		FE_value *blending_matrix = (FE_value *)NULL;
+		if ((FE_basis_get_number_of_functions(basis) == number_of_element_values) &&
+			calculate_standard_basis_transformation(basis, coordinate_transformation,
+				sub_dimension, &inherited_basis_arguments, &number_of_inherited_values,
+				&standard_basis_function, &blending_matrix))
+		{
+			const int number_of_blended_values = FE_basis_get_number_of_blended_functions(basis);
+			if (number_of_blended_values > 0)
+			{
+				FE_value *combined_blending_matrix = FE_basis_calculate_combined_blending_matrix(
+					basis, number_of_blended_values, number_of_inherited_values, blending_matrix);
+				DEALLOCATE(blending_matrix);
+				blending_matrix = combined_blending_matrix;
+			}
+			if (blending_matrix)
+			{
+				/* nodes whose row in the blending matrix is not zero are on the face */
+				const FE_value *transformation = blending_matrix;
+				for (int i = 0; i < number_of_element_values; ++i)
+				{
+					for (int j = 0; j < number_of_inherited_values; ++j)
+					{
+						if (1.e-8 < fabs(transformation[j]))
+						{
+							node_identifiers.push_back(element_values[i]->cm_node_identifier);
+							break;
+						}
+					}
+					transformation += number_of_inherited_values;
+				}
+			}
+			else
+			{
+				return_code = 0;
+			}
+			DEALLOCATE(blending_matrix);
+			DEALLOCATE(inherited_basis_arguments);
+		}
+		else
+		{
+			return_code = 0;
+		}
+		DEALLOCATE(element_values);
+	}
+	std::sort(node_identifiers.begin(), node_identifiers.end());
+	node_identifiers.erase(std::unique(node_identifiers.begin(), node_identifiers.end()),
+		node_identifiers.end());
+	if ((!return_code) || (0 == node_identifiers.size()))
+	{
+		node_identifiers.clear();
+		return_code = 0;
+	}
+	return (return_code);
+}
+
 int calculate_FE_element_field(int component_number,
 	struct FE_element_field_values *element_field_values,
 	const FE_value *xi_coordinates, FE_value *values, FE_value *jacobian)
@@ -26271,6 +26833,26 @@ there is no face. Element must have a shape and face.
 	return (return_code);
 } /* get_FE_element_face */
 
+int FE_element_get_face_to_element(struct FE_element *element, int face_number,
+	struct FE_element **face_element_address, FE_value *face_to_element)
+{
+	if (element && element->shape && element->shape->face_to_element &&
+		(0 <= face_number) && (face_number < element->shape->number_of_faces) &&
+		face_element_address && face_to_element)
+	{
+		*face_element_address = (element->faces) ? element->faces[face_number] : 0;
+		const int dimension = element->shape->dimension;
+		const int size = dimension*dimension;
+		const FE_value *source = element->shape->face_to_element + face_number*size;
+		for (int i = 0; i < size; i++)
+		{
+			face_to_element[i] = source[i];
+		}
+		return 1;
+	}
+	return 0;
+}
+
 int set_FE_element_face(struct FE_element *element,int face_number,
 	struct FE_element *face_element)
 /*******************************************************************************
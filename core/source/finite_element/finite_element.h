@@ -45,6 +45,7 @@ interface to CMISS.
 #if !defined (FINITE_ELEMENT_H)
 #define FINITE_ELEMENT_H
 
+#include <vector>
 #include "zinc/node.h"
 #include "zinc/element.h"
 #include "finite_element/finite_element_basis.h"
@@ -72,6 +73,8 @@ them. Only the FE_field has a direct pointer; the other two include it via their
 field_info structure.
 ==============================================================================*/
 
+class identifier_bool_array;
+
 enum CM_field_type
 /*******************************************************************************
 LAST MODIFIED : 30 August 2001
@@ -1299,6 +1302,19 @@ PROTOTYPE_FIND_BY_IDENTIFIER_IN_LIST_FUNCTION(FE_node,cm_node_identifier,int);
 
 PROTOTYPE_CREATE_LIST_ITERATOR_FUNCTION(FE_node,Cmiss_node_iterator);
 
+/***************************************************************************//**
+ * Create an iterator over the nodes in node_list whose identifiers are true in
+ * identifiers, from lowest to highest identifier. Identifiers are read as the
+ * iterator advances so it remains valid if they change.
+ *
+ * @param node_list  List the nodes are found in.
+ * @param identifiers  Identifiers of nodes to iterate over. Accessed by the
+ * iterator.
+ * @return  Handle to node_iterator at position before first, or NULL if error.
+ */
+Cmiss_node_iterator_id FE_node_list_create_identifier_iterator(
+	struct LIST(FE_node) *node_list, identifier_bool_array *identifiers);
+
 /***************************************************************************//**
  * Internal variant of public Cmiss_node_iterator_next() which does not access
  * the returned node, for more efficient if less safe usage.
@@ -1785,6 +1801,59 @@ The optional <top_level_element> forces inheritance from it as needed.
 NB.  The nodes need to be DEACCESS'd before the nodes array is DEALLOCATE'd.
 ==============================================================================*/
 
+/***************************************************************************//**
+ * Linear map from the nodal values a node-based component of an element field
+ * depends on to its standard basis, allowing the component's derivatives with
+ * respect to nodal values to be evaluated at any xi without modifying nodes.
+ * The derivative with respect to the nodal value stored at value_storages[k]
+ * is the sum over j of weights[k*number_of_basis_values + j] times the j-th
+ * standard basis function value. Weights combine scale factors, the basis
+ * blending matrix, any inheritance transformation onto faces or lines, and
+ * time interpolation weights. The same storage may appear more than once, in
+ * which case its contributions are summed.
+ */
+struct FE_element_field_component_nodal_value_map
+{
+	Standard_basis_function *standard_basis_function;
+	int *standard_basis_arguments;
+	int number_of_basis_values;
+	std::vector<FE_value *> value_storages;
+	std::vector<FE_value> weights;
+
+	FE_element_field_component_nodal_value_map() :
+		standard_basis_function(0),
+		standard_basis_arguments(0),
+		number_of_basis_values(0)
+	{
+	}
+
+	~FE_element_field_component_nodal_value_map();
+
+	/** @param basis_values  Array of size number_of_basis_values to fill.
+	 * @return  1 on success, 0 on failure. */
+	int evaluate_basis(const FE_value *xi, FE_value *basis_values)
+	{
+		return (standard_basis_function)(standard_basis_arguments, xi, basis_values);
+	}
+
+private:
+	FE_element_field_component_nodal_value_map(const FE_element_field_component_nodal_value_map&);
+	FE_element_field_component_nodal_value_map& operator=(const FE_element_field_component_nodal_value_map&);
+};
+
+/***************************************************************************//**
+ * Calculates the nodal value map for each component of <field> on <element>,
+ * inheriting from <top_level_element> if needed. Entries are NULL for
+ * components that are not node-based, and all are NULL for constant and
+ * indexed fields. Only FE_value nodal values are supported.
+ * Caller must delete the maps.
+ * @param component_maps  Vector resized to number of field components.
+ * @return  1 on success, 0 on failure.
+ */
+int calculate_FE_element_field_nodal_value_maps(struct FE_element *element,
+	struct FE_field *field, FE_value time, struct FE_element *top_level_element,
+	std::vector<FE_element_field_component_nodal_value_map *>& component_maps);
+
 int calculate_FE_element_field(int component_number,
 	struct FE_element_field_values *element_field_values,
 	const FE_value *xi_coordinates, FE_value *values, FE_value *jacobian);
@@ -1965,6 +2034,11 @@ Returns the dimension of <element_shape>.
 If fails, puts zero at <dimension_address>.
 ==============================================================================*/
 
+/***************************************************************************//**
+ * @return  The number of faces of <element_shape>, or 0 if invalid.
+ */
+int FE_element_shape_get_number_of_faces(struct FE_element_shape *element_shape);
+
 int get_FE_element_shape_xi_linkage_number(
 	struct FE_element_shape *element_shape, int xi_number1, int xi_number2,
 	int *xi_linkage_number_address);
@@ -2254,6 +2328,22 @@ Returns the <face_element> for face <face_number> of <element>, where NULL means
 there is no face. Element must have a shape and face.
 ==============================================================================*/
 
+/***************************************************************************//**
+ * Gets the face element on <face_number> of <element>, and the matrix for
+ * converting xi in the face to xi in <element>. Unlike get_FE_element_face,
+ * an element without faces is not an error; a NULL face is returned.
+ * The matrix is the face_to_element of the element shape, giving the
+ * transformation xi(element) = b + A xi(face), where b is in the first column
+ * of the matrix and the rest of the matrix is A.
+ *
+ * @param face_element_address  On success, set to the face element or NULL.
+ * @param face_to_element  Preallocated to hold dimension*dimension values,
+ * where dimension is that of <element>.
+ * @return  1 on success, 0 if invalid arguments.
+ */
+int FE_element_get_face_to_element(struct FE_element *element, int face_number,
+	struct FE_element **face_element_address, FE_value *face_to_element);
+
 int set_FE_element_face(struct FE_element *element,int face_number,
 	struct FE_element *face_element);
 /*******************************************************************************
@@ -2638,6 +2728,22 @@ PROTOTYPE_FIND_BY_IDENTIFIER_IN_LIST_FUNCTION(FE_element,identifier, \
 
 PROTOTYPE_CREATE_LIST_ITERATOR_FUNCTION(FE_element,Cmiss_element_iterator);
 
+/***************************************************************************//**
+ * Create an iterator over the elements in element_list whose identifiers are
+ * true in identifiers, from lowest to highest identifier. Identifiers are read
+ * as the iterator advances so it remains valid if they change.
+ *
+ * @param element_list  List the elements are found in.
+ * @param dimension  Dimension of the elements in element_list, 1 to 3.
+ * @param identifiers  Identifiers of elements to iterate over. Accessed by the
+ * iterator.
+ * @return  Handle to element_iterator at position before first, or NULL if
+ * error.
+ */
+Cmiss_element_iterator_id FE_element_list_create_identifier_iterator(
+	struct LIST(FE_element) *element_list, int dimension,
+	identifier_bool_array *identifiers);
+
 /***************************************************************************//**
  * Internal variant of public Cmiss_element_iterator_next() which does not
  * access the returned element, for more efficient if less safe usage.
@@ -47,7 +47,6 @@ indexed_multi_range.
 #define FINITE_ELEMENT_ADJACENT_ELEMENTS_H
 
 #include "zinc/element.h"
-#include "general/indexed_multi_range.h"
 
 int adjacent_FE_element(struct FE_element *element,
 	int face_number, int *number_of_adjacent_elements, 
@@ -63,9 +62,7 @@ correct size and should be DEALLOCATED when finished with.
 
 int adjacent_FE_element_from_nodes(struct FE_element *element,
 	int node_index, int *number_of_adjacent_elements, 
-	struct FE_element ***adjacent_elements, 
-	struct LIST(Index_multi_range) *node_element_list,
-	Cmiss_mesh_id mesh);
+	struct FE_element ***adjacent_elements, Cmiss_mesh_id mesh);
 /*******************************************************************************
 LAST MODIFIED : 13 March 2003
 
@@ -75,12 +72,8 @@ For a 1D top level element this routine will return the list of
 <node_index>.  <adjacent_elements> is ALLOCATED to the 
 correct size and should be DEALLOCATED when calls to this function are finished.
 Note elements in adjacent_elements array are not accessed.
+Elements sharing the node are found from the node-to-element index kept by the
+FE_region of <mesh>, so repeated calls do not rebuild it.
 ==============================================================================*/
 
-/***************************************************************************//**
- * Creates a list indexed by node identifying elements which refer to each node.
- * @param mesh  Mesh to which elements must belong.
- */
-struct LIST(Index_multi_range) *create_node_element_list(Cmiss_mesh_id mesh);
-
 #endif /* !defined (FINITE_ELEMENT_ADJACENT_ELEMENTS_H) */
@@ -2952,7 +2952,7 @@ and adds it to the manager.
 	return (basis);
 } /* make_FE_basis */
 
-DECLARE_OBJECT_FUNCTIONS(FE_basis)
+DECLARE_ATOMIC_OBJECT_FUNCTIONS(FE_basis)
 
 DECLARE_INDEXED_LIST_FUNCTIONS(FE_basis)
 
@@ -0,0 +1,400 @@
+/*******************************************************************************
+FILE : finite_element_face_index.cpp
+
+DESCRIPTION :
+Hash index of the faces and lines of an FE_region by their nodes, and node
+sequences of the faces of elements found in parallel, for defining faces.
+==============================================================================*/
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is cmgui.
+ *
+ * The Initial Developer of the Original Code is
+ * Auckland Uniservices Ltd, Auckland, New Zealand.
+ * Portions created by the Initial Developer are Copyright (C) 2012
+ * the Initial Developer. All Rights Reserved.
+ *
+ * Contributor(s):
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+#include <map>
+#include <vector>
+#include "zinc/zincconfigure.h"
+#if defined (USE_OPENMP)
+#include <omp.h>
+#endif /* defined (USE_OPENMP) */
+#include "general/debug.h"
+#include "general/message.h"
+#include "finite_element/finite_element.h"
+#include "finite_element/finite_element_face_index.hpp"
+#include "finite_element/finite_element_private.h"
+
+namespace {
+
+typedef std::map<struct FE_element_shape *, std::vector<struct FE_element_shape *> >
+	Face_shapes_map;
+
+/* blocks are not made smaller than this so threads have enough work */
+const int minimum_elements_per_block = 256;
+
+/** FNV-1a hash of dimension and node identifiers */
+unsigned int FE_face_node_sequence_hash(int dimension, int number_of_nodes,
+	const int *node_identifiers)
+{
+	unsigned int hash = 2166136261u;
+	hash = (hash ^ static_cast<unsigned int>(dimension))*16777619u;
+	for (int i = 0; i < number_of_nodes; ++i)
+	{
+		unsigned int value = static_cast<unsigned int>(node_identifiers[i]);
+		for (int b = 0; b < 4; ++b)
+		{
+			hash = (hash ^ (value & 0xFF))*16777619u;
+			value >>= 8;
+		}
+	}
+	return hash;
+}
+
+} // anonymous namespace
+
+FE_face_index::FE_face_index() :
+	slots(1024, 0)
+{
+}
+
+FE_face_index::~FE_face_index()
+{
+	for (std::vector<Entry>::iterator iter = entries.begin(); iter != entries.end(); ++iter)
+	{
+		DEACCESS(FE_element)(&(iter->face));
+	}
+}
+
+/** @return  Slot holding the entry with the same dimension and nodes, or the
+ * first empty slot found by linear probing from the hash. */
+int FE_face_index::find_slot(unsigned int hash, int dimension,
+	int number_of_nodes, const int *node_identifiers_in) const
+{
+	const size_t mask = slots.size() - 1;
+	size_t slot = hash & mask;
+	while (slots[slot])
+	{
+		const Entry& entry = entries[slots[slot] - 1];
+		if ((entry.hash == hash) && (entry.dimension == dimension) &&
+			(entry.number_of_nodes == number_of_nodes))
+		{
+			const int *entry_node_identifiers = &(node_identifiers[entry.node_start]);
+			int i = 0;
+			while ((i < number_of_nodes) && (entry_node_identifiers[i] == node_identifiers_in[i]))
+			{
+				++i;
+			}
+			if (i == number_of_nodes)
+			{
+				break;
+			}
+		}
+		slot = (slot + 1) & mask;
+	}
+	return static_cast<int>(slot);
+}
+
+/** Doubles the number of slots and re-inserts the entries. */
+void FE_face_index::grow_slots()
+{
+	std::vector<int> new_slots(2*slots.size(), 0);
+	const size_t mask = new_slots.size() - 1;
+	const int number_of_entries = static_cast<int>(entries.size());
+	for (int i = 0; i < number_of_entries; ++i)
+	{
+		size_t slot = entries[i].hash & mask;
+		while (new_slots[slot])
+		{
+			slot = (slot + 1) & mask;
+		}
+		new_slots[slot] = i + 1;
+	}
+	slots.swap(new_slots);
+}
+
+struct FE_element *FE_face_index::find_face(int dimension, int number_of_nodes,
+	const int *node_identifiers_in) const
+{
+	const unsigned int hash = FE_face_node_sequence_hash(dimension, number_of_nodes,
+		node_identifiers_in);
+	const int slot = find_slot(hash, dimension, number_of_nodes, node_identifiers_in);
+	if (slots[slot])
+	{
+		return entries[slots[slot] - 1].face;
+	}
+	return 0;
+}
+
+int FE_face_index::add_face(struct FE_element *face, int dimension,
+	int number_of_nodes, const int *node_identifiers_in)
+{
+	if (!(face && (0 < number_of_nodes) && node_identifiers_in))
+	{
+		display_message(ERROR_MESSAGE, "FE_face_index::add_face.  Invalid argument(s)");
+		return 0;
+	}
+	const unsigned int hash = FE_face_node_sequence_hash(dimension, number_of_nodes,
+		node_identifiers_in);
+	int slot = find_slot(hash, dimension, number_of_nodes, node_identifiers_in);
+	if (slots[slot])
+	{
+		return 0;
+	}
+	Entry entry;
+	entry.face = ACCESS(FE_element)(face);
+	entry.hash = hash;
+	entry.dimension = dimension;
+	entry.number_of_nodes = number_of_nodes;
+	entry.node_start = node_identifiers.size();
+	node_identifiers.insert(node_identifiers.end(), node_identifiers_in,
+		node_identifiers_in + number_of_nodes);
+	entries.push_back(entry);
+	slots[slot] = static_cast<int>(entries.size());
+	/* keep at most half the slots filled so probes stay short */
+	if (2*entries.size() > slots.size())
+	{
+		grow_slots();
+	}
+	return 1;
+}
+
+/**
+ * Node sequences for a contiguous range of the elements. Sequences for the
+ * faces of each element are consecutive, and are followed by the sequences
+ * for the faces of each face found.
+ */
+class FE_element_face_node_sequences::Block
+{
+public:
+	const int first_element, limit_element;
+
+private:
+	/* first sequence for each element, or -1 if none */
+	std::vector<int> element_starts;
+	std::vector<FE_face_node_sequence> sequences;
+	/* offsets converted to pointers in sequences once all are found */
+	std::vector<int> node_starts;
+	std::vector<int> face_starts;
+	std::vector<int> node_identifiers;
+
+public:
+	Block(int first_element_in, int limit_element_in) :
+		first_element(first_element_in),
+		limit_element(limit_element_in),
+		element_starts(limit_element_in - first_element_in, -1)
+	{
+	}
+
+	const FE_face_node_sequence *get_element_face_sequences(int index) const
+	{
+		const int start = element_starts[index - first_element];
+		return (0 <= start) ? &(sequences[start]) : 0;
+	}
+
+	/** Finds sequences for the elements in the block. Must not create or
+	 * modify any objects as blocks are found concurrently. */
+	void find_sequences(const std::vector<struct FE_element *>& elements,
+		const Face_shapes_map& face_shapes, bool define_faces, bool define_face_faces)
+	{
+		if (!define_faces)
+		{
+			return;
+		}
+		std::vector<int> face_node_identifiers;
+		FE_value face_to_element[MAXIMUM_ELEMENT_XI_DIMENSIONS*MAXIMUM_ELEMENT_XI_DIMENSIONS];
+		for (int index = first_element; index < limit_element; ++index)
+		{
+			struct FE_element *element = elements[index];
+			struct FE_element_shape *element_shape = 0;
+			get_FE_element_shape(element, &element_shape);
+			const int number_of_faces = FE_element_shape_get_number_of_faces(element_shape);
+			Face_shapes_map::const_iterator face_shapes_iter = face_shapes.find(element_shape);
+			if ((0 == number_of_faces) || (face_shapes_iter == face_shapes.end()))
+			{
+				continue;
+			}
+			const int face_dimension = get_FE_element_dimension(element) - 1;
+			const int start = add_sequences(number_of_faces);
+			element_starts[index - first_element] = start;
+			for (int face_number = 0; face_number < number_of_faces; ++face_number)
+			{
+				struct FE_element *face = 0;
+				if (!(FE_element_get_face_to_element(element, face_number, &face, face_to_element) &&
+					(!face) && FE_element_get_face_node_identifiers(element, face_number,
+						/*face_shape*/0, /*line_number*/-1, face_node_identifiers)))
+				{
+					continue;
+				}
+				set_sequence(start + face_number, face_node_identifiers);
+				struct FE_element_shape *face_shape = face_shapes_iter->second[face_number];
+				const int number_of_lines = FE_element_shape_get_number_of_faces(face_shape);
+				if (define_face_faces && (0 < number_of_lines) &&
+					!FE_face_index::is_collapsed(face_dimension, static_cast<int>(face_node_identifiers.size())))
+				{
+					const int line_start = add_sequences(number_of_lines);
+					face_starts[start + face_number] = line_start;
+					for (int line_number = 0; line_number < number_of_lines; ++line_number)
+					{
+						if (FE_element_get_face_node_identifiers(element, face_number,
+							face_shape, line_number, face_node_identifiers))
+						{
+							set_sequence(line_start + line_number, face_node_identifiers);
+						}
+					}
+				}
+			}
+		}
+		const int number_of_sequences = static_cast<int>(sequences.size());
+		for (int i = 0; i < number_of_sequences; ++i)
+		{
+			if (0 <= node_starts[i])
+			{
+				sequences[i].node_identifiers = &(node_identifiers[node_starts[i]]);
+			}
+			if (0 <= face_starts[i])
+			{
+				sequences[i].faces = &(sequences[face_starts[i]]);
+			}
+		}
+	}
+
+private:
+	/** Adds count sequences not found in advance. @return  First new index. */
+	int add_sequences(int count)
+	{
+		const int start = static_cast<int>(sequences.size());
+		FE_face_node_sequence sequence = { -1, 0, 0 };
+		sequences.resize(start + count, sequence);
+		node_starts.resize(start + count, -1);
+		face_starts.resize(start + count, -1);
+		return start;
+	}
+
+	void set_sequence(int index, const std::vector<int>& sequence_node_identifiers)
+	{
+		sequences[index].number_of_nodes = static_cast<int>(sequence_node_identifiers.size());
+		node_starts[index] = static_cast<int>(node_identifiers.size());
+		node_identifiers.insert(node_identifiers.end(), sequence_node_identifiers.begin(),
+			sequence_node_identifiers.end());
+	}
+};
+
+FE_element_face_node_sequences::FE_element_face_node_sequences(
+	struct FE_region *fe_region, const std::vector<struct FE_element *>& elements,
+	bool define_faces, bool define_face_faces)
+{
+	const int number_of_elements = static_cast<int>(elements.size());
+	if (!(fe_region && define_faces && (0 < number_of_elements)))
+	{
+		return;
+	}
+	/* face shapes are found or created in the FE_region, so get them first */
+	Face_shapes_map face_shapes;
+	for (int index = 0; index < number_of_elements; ++index)
+	{
+		struct FE_element_shape *element_shape = 0;
+		if (get_FE_element_shape(elements[index], &element_shape) && element_shape &&
+			(face_shapes.find(element_shape) == face_shapes.end()))
+		{
+			std::vector<struct FE_element_shape *>& shapes = face_shapes[element_shape];
+			const int number_of_faces = FE_element_shape_get_number_of_faces(element_shape);
+			for (int face_number = 0; face_number < number_of_faces; ++face_number)
+			{
+				struct FE_element_shape *face_shape = (define_face_faces) ?
+					get_FE_element_shape_of_face(element_shape, face_number, fe_region) : 0;
+				shapes.push_back((face_shape) ? ACCESS(FE_element_shape)(face_shape) : 0);
+			}
+		}
+	}
+	int number_of_blocks = 1;
+#if defined (USE_OPENMP)
+	number_of_blocks = omp_get_max_threads();
+#endif /* defined (USE_OPENMP) */
+	if (number_of_blocks*minimum_elements_per_block > number_of_elements)
+		number_of_blocks = number_of_elements / minimum_elements_per_block;
+	if (number_of_blocks < 1)
+		number_of_blocks = 1;
+	for (int b = 0; b < number_of_blocks; ++b)
+	{
+		const int first = static_cast<int>((static_cast<long>(number_of_elements)*b) / number_of_blocks);
+		const int limit = static_cast<int>((static_cast<long>(number_of_elements)*(b + 1)) / number_of_blocks);
+		blocks.push_back(new Block(first, limit));
+	}
+#if defined (USE_OPENMP)
+#pragma omp parallel for num_threads(number_of_blocks) schedule(static, 1)
+#endif /* defined (USE_OPENMP) */
+	for (int b = 0; b < number_of_blocks; ++b)
+	{
+		blocks[b]->find_sequences(elements, face_shapes, define_faces, define_face_faces);
+	}
+	for (Face_shapes_map::iterator iter = face_shapes.begin(); iter != face_shapes.end(); ++iter)
+	{
+		for (size_t i = 0; i < iter->second.size(); ++i)
+		{
+			if (iter->second[i])
+			{
+				DEACCESS(FE_element_shape)(&(iter->second[i]));
+			}
+		}
+	}
+}
+
+FE_element_face_node_sequences::~FE_element_face_node_sequences()
+{
+	for (std::vector<Block *>::iterator iter = blocks.begin(); iter != blocks.end(); ++iter)
+	{
+		delete *iter;
+	}
+}
+
+const FE_face_node_sequence *FE_element_face_node_sequences::get_element_face_sequences(
+	int index) const
+{
+	int low = 0;
+	int high = static_cast<int>(blocks.size());
+	while (low < high)
+	{
+		const int middle = (low + high) / 2;
+		if (index < blocks[middle]->first_element)
+		{
+			high = middle;
+		}
+		else if (index >= blocks[middle]->limit_element)
+		{
+			low = middle + 1;
+		}
+		else
+		{
+			return blocks[middle]->get_element_face_sequences(index);
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,150 @@
+/*******************************************************************************
+FILE : finite_element_face_index.hpp
+
+DESCRIPTION :
+Hash index of the faces and lines of an FE_region by their nodes, and node
+sequences of the faces of elements found in parallel, for defining faces.
+==============================================================================*/
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is cmgui.
+ *
+ * The Initial Developer of the Original Code is
+ * Auckland Uniservices Ltd, Auckland, New Zealand.
+ * Portions created by the Initial Developer are Copyright (C) 2012
+ * the Initial Developer. All Rights Reserved.
+ *
+ * Contributor(s):
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+#if !defined (FINITE_ELEMENT_FACE_INDEX_HPP)
+#define FINITE_ELEMENT_FACE_INDEX_HPP
+
+#include <vector>
+
+struct FE_element;
+struct FE_region;
+
+/**
+ * Sorted identifiers of the nodes on a face of an element which is not yet
+ * defined, and the sequences for the faces of that face.
+ */
+struct FE_face_node_sequence
+{
+	/* number of node identifiers, or -1 if not found in advance */
+	int number_of_nodes;
+	const int *node_identifiers;
+	/* sequences for the faces of this face, or NULL if not found in advance */
+	const FE_face_node_sequence *faces;
+};
+
+/**
+ * Faces and lines of a master FE_region keyed by dimension and sorted node
+ * identifiers, in a flat open addressing hash table. Replaces the list of
+ * FE_element_type_node_sequence for matching new faces to existing ones while
+ * defining faces. Faces are accessed while in the index.
+ */
+class FE_face_index
+{
+	struct Entry
+	{
+		struct FE_element *face;
+		unsigned int hash;
+		int dimension;
+		int number_of_nodes;
+		size_t node_start;
+	};
+
+	std::vector<Entry> entries;
+	std::vector<int> node_identifiers;
+	/* entry number + 1 in each slot, 0 if empty; size is a power of 2 */
+	std::vector<int> slots;
+
+public:
+	FE_face_index();
+
+	~FE_face_index();
+
+	/** @return  True if a face or line with number_of_nodes distinct nodes is
+	 * collapsed and is not created, as for FE_element_type_node_sequence. */
+	static bool is_collapsed(int dimension, int number_of_nodes)
+	{
+		return ((2 == dimension) && (2 >= number_of_nodes)) ||
+			((1 == dimension) && (1 == number_of_nodes));
+	}
+
+	/** @return  The face of dimension with the sorted node identifiers, or
+	 * NULL if none. */
+	struct FE_element *find_face(int dimension, int number_of_nodes,
+		const int *node_identifiers_in) const;
+
+	/**
+	 * Adds face of dimension with the sorted node identifiers.
+	 * @return  1 on success, 0 if a face of the same dimension and nodes is
+	 * already in the index.
+	 */
+	int add_face(struct FE_element *face, int dimension, int number_of_nodes,
+		const int *node_identifiers_in);
+
+private:
+	int find_slot(unsigned int hash, int dimension, int number_of_nodes,
+		const int *node_identifiers_in) const;
+
+	void grow_slots();
+};
+
+/**
+ * Node sequences of the undefined faces of an array of elements, and of the
+ * faces of those faces, found using FE_element_get_face_node_identifiers in
+ * contiguous blocks of elements, in parallel if built with USE_OPENMP. The
+ * faces can then be created serially in the usual order, with the usual
+ * identifiers, only needing to look up the sequences in an FE_face_index.
+ * Faces of elements which do not define the coordinate field themselves are
+ * not found in advance.
+ */
+class FE_element_face_node_sequences
+{
+	class Block;
+
+	std::vector<Block *> blocks;
+
+public:
+	/**
+	 * @param fe_region  Region owning face shapes.
+	 * @param define_faces  Whether faces of the elements are to be defined.
+	 * @param define_face_faces  Whether faces of faces are to be defined.
+	 */
+	FE_element_face_node_sequences(struct FE_region *fe_region,
+		const std::vector<struct FE_element *>& elements, bool define_faces,
+		bool define_face_faces);
+
+	~FE_element_face_node_sequences();
+
+	/** @return  Sequences for each face of elements[index], or NULL if none. */
+	const FE_face_node_sequence *get_element_face_sequences(int index) const;
+};
+
+#endif /* !defined (FINITE_ELEMENT_FACE_INDEX_HPP) */
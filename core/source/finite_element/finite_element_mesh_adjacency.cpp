@@ -0,0 +1,469 @@
+/*******************************************************************************
+FILE : finite_element_mesh_adjacency.cpp
+
+DESCRIPTION :
+Node-to-element and face neighbour index for the elements of an FE_region,
+built on demand and kept up to date from the FE_region's element changes.
+==============================================================================*/
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is cmgui.
+ *
+ * The Initial Developer of the Original Code is
+ * Auckland Uniservices Ltd, Auckland, New Zealand.
+ * Portions created by the Initial Developer are Copyright (C) 2012
+ * the Initial Developer. All Rights Reserved.
+ *
+ * Contributor(s):
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+#include <algorithm>
+#include <map>
+#include <set>
+#include <vector>
+#include "general/debug.h"
+#include "general/message.h"
+#include "finite_element/finite_element.h"
+#include "finite_element/finite_element_region.h"
+#include "finite_element/finite_element_mesh_adjacency.hpp"
+
+namespace {
+
+typedef FE_mesh_adjacency::Element_vector Element_vector;
+typedef std::vector<struct FE_node *> Node_vector;
+/* neighbours of an element through each of its faces */
+typedef std::vector<Element_vector> Face_neighbours;
+
+/* overrides allowed before the arrays are rebuilt, plus a quarter of the mesh */
+const size_t minimum_changes_before_rebuild = 16;
+
+/** Orders elements of one dimension by identifier */
+bool FE_element_identifier_less(struct FE_element *element1,
+	struct FE_element *element2)
+{
+	struct CM_element_information identifier1, identifier2;
+	get_FE_element_identifier(element1, &identifier1);
+	get_FE_element_identifier(element2, &identifier2);
+	return identifier1.number < identifier2.number;
+}
+
+/** Gets the distinct nodes element refers to, in address order */
+void FE_element_get_distinct_nodes(struct FE_element *element, Node_vector& nodes)
+{
+	nodes.clear();
+	int number_of_nodes = 0;
+	if (get_FE_element_number_of_nodes(element, &number_of_nodes))
+	{
+		for (int i = 0; i < number_of_nodes; ++i)
+		{
+			struct FE_node *node = 0;
+			if (get_FE_element_node(element, i, &node) && node)
+			{
+				nodes.push_back(node);
+			}
+		}
+	}
+	std::sort(nodes.begin(), nodes.end());
+	nodes.erase(std::unique(nodes.begin(), nodes.end()), nodes.end());
+}
+
+int FE_element_add_to_vector(struct FE_element *element, void *elements_void)
+{
+	static_cast<Element_vector *>(elements_void)->push_back(element);
+	return 1;
+}
+
+} // anonymous namespace
+
+/**
+ * Adjacency of the elements of one dimension. The arrays give, in address
+ * order of the indexed elements, the range of face slots of each element,
+ * and for each face slot the range of its neighbours; and, in address order
+ * of the nodes, the range of elements using each node. Rows for elements
+ * changed since then are superseded by the override maps.
+ */
+class FE_mesh_adjacency::Mesh_index
+{
+	struct FE_region *fe_region;
+	Element_vector elements;
+	std::vector<int> element_face_starts;
+	std::vector<int> face_neighbour_starts;
+	Element_vector face_neighbours;
+	Node_vector nodes;
+	std::vector<int> node_element_starts;
+	Element_vector node_elements;
+
+	/* elements whose rows in the arrays are out of date */
+	std::set<struct FE_element *> stale_elements;
+	/* current rows for changed elements and their neighbours */
+	std::map<struct FE_element *, Face_neighbours> changed_face_neighbours;
+	std::map<struct FE_element *, Node_vector> changed_element_nodes;
+	std::map<struct FE_node *, Element_vector> changed_node_elements;
+	/* ACCESSed elements reported by the FE_region and not yet applied */
+	std::set<struct FE_element *> pending_elements;
+
+public:
+
+	Mesh_index(struct FE_region *fe_region_in, int dimension) :
+		fe_region(fe_region_in)
+	{
+		FE_region_for_each_FE_element_of_dimension(fe_region, dimension,
+			FE_element_add_to_vector, static_cast<void *>(&elements));
+		std::sort(elements.begin(), elements.end());
+		const size_t number_of_elements = elements.size();
+		std::vector<std::pair<struct FE_node *, struct FE_element *> > node_element_pairs;
+		Node_vector element_nodes;
+		Face_neighbours neighbours;
+		element_face_starts.reserve(number_of_elements + 1);
+		element_face_starts.push_back(0);
+		face_neighbour_starts.push_back(0);
+		for (size_t i = 0; i < number_of_elements; ++i)
+		{
+			struct FE_element *element = elements[i];
+			FE_element_get_distinct_nodes(element, element_nodes);
+			for (Node_vector::iterator iter = element_nodes.begin();
+				iter != element_nodes.end(); ++iter)
+			{
+				node_element_pairs.push_back(std::make_pair(*iter, element));
+			}
+			calculate_face_neighbours(element, neighbours);
+			for (Face_neighbours::iterator face_iter = neighbours.begin();
+				face_iter != neighbours.end(); ++face_iter)
+			{
+				face_neighbours.insert(face_neighbours.end(), face_iter->begin(), face_iter->end());
+				face_neighbour_starts.push_back(static_cast<int>(face_neighbours.size()));
+			}
+			element_face_starts.push_back(static_cast<int>(face_neighbour_starts.size() - 1));
+		}
+		std::sort(node_element_pairs.begin(), node_element_pairs.end());
+		node_elements.reserve(node_element_pairs.size());
+		for (size_t i = 0; i < node_element_pairs.size(); ++i)
+		{
+			if ((0 == i) || (node_element_pairs[i].first != node_element_pairs[i - 1].first))
+			{
+				nodes.push_back(node_element_pairs[i].first);
+				node_element_starts.push_back(static_cast<int>(i));
+			}
+			node_elements.push_back(node_element_pairs[i].second);
+		}
+		node_element_starts.push_back(static_cast<int>(node_elements.size()));
+	}
+
+	~Mesh_index()
+	{
+		for (std::set<struct FE_element *>::iterator iter = pending_elements.begin();
+			iter != pending_elements.end(); ++iter)
+		{
+			struct FE_element *element = *iter;
+			DEACCESS(FE_element)(&element);
+		}
+	}
+
+	void add_pending_element(struct FE_element *element)
+	{
+		if (pending_elements.insert(element).second)
+		{
+			ACCESS(FE_element)(element);
+		}
+	}
+
+	/** @return  true if so much has changed that rebuilding is quicker */
+	bool needs_rebuild() const
+	{
+		return (stale_elements.size() + changed_face_neighbours.size() +
+			pending_elements.size()) >
+			(minimum_changes_before_rebuild + elements.size()/4);
+	}
+
+	/** Brings the overrides up to date with the pending elements */
+	void apply_pending_elements()
+	{
+		std::set<struct FE_element *> applied_elements;
+		applied_elements.swap(pending_elements);
+		for (std::set<struct FE_element *>::iterator iter = applied_elements.begin();
+			iter != applied_elements.end(); ++iter)
+		{
+			update_element(*iter);
+		}
+		/* removed elements may be destroyed here */
+		for (std::set<struct FE_element *>::iterator iter = applied_elements.begin();
+			iter != applied_elements.end(); ++iter)
+		{
+			struct FE_element *element = *iter;
+			DEACCESS(FE_element)(&element);
+		}
+	}
+
+	void get_elements_using_node(struct FE_node *node, Element_vector& node_elements_out) const
+	{
+		node_elements_out.clear();
+		Node_vector::const_iterator node_iter =
+			std::lower_bound(nodes.begin(), nodes.end(), node);
+		if ((node_iter != nodes.end()) && (*node_iter == node))
+		{
+			const size_t node_index = node_iter - nodes.begin();
+			for (int i = node_element_starts[node_index];
+				i < node_element_starts[node_index + 1]; ++i)
+			{
+				if (0 == stale_elements.count(node_elements[i]))
+				{
+					node_elements_out.push_back(node_elements[i]);
+				}
+			}
+		}
+		std::map<struct FE_node *, Element_vector>::const_iterator changed_iter =
+			changed_node_elements.find(node);
+		if (changed_iter != changed_node_elements.end())
+		{
+			node_elements_out.insert(node_elements_out.end(),
+				changed_iter->second.begin(), changed_iter->second.end());
+		}
+		std::sort(node_elements_out.begin(), node_elements_out.end(),
+			FE_element_identifier_less);
+	}
+
+	/** Gets the indexed neighbours of element through each face; empty if
+	 * element is not in the mesh */
+	void get_face_neighbours(struct FE_element *element, Face_neighbours& neighbours) const
+	{
+		neighbours.clear();
+		std::map<struct FE_element *, Face_neighbours>::const_iterator changed_iter =
+			changed_face_neighbours.find(element);
+		if (changed_iter != changed_face_neighbours.end())
+		{
+			neighbours = changed_iter->second;
+		}
+		else if (0 == stale_elements.count(element))
+		{
+			Element_vector::const_iterator element_iter =
+				std::lower_bound(elements.begin(), elements.end(), element);
+			if ((element_iter != elements.end()) && (*element_iter == element))
+			{
+				const size_t element_index = element_iter - elements.begin();
+				for (int face_slot = element_face_starts[element_index];
+					face_slot < element_face_starts[element_index + 1]; ++face_slot)
+				{
+					neighbours.push_back(Element_vector(
+						face_neighbours.begin() + face_neighbour_starts[face_slot],
+						face_neighbours.begin() + face_neighbour_starts[face_slot + 1]));
+				}
+			}
+		}
+	}
+
+private:
+
+	/** Finds the other parents of each face of element which are in the
+	 * FE_region, ordered by identifier */
+	void calculate_face_neighbours(struct FE_element *element,
+		Face_neighbours& neighbours) const
+	{
+		int number_of_faces = 0;
+		get_FE_element_number_of_faces(element, &number_of_faces);
+		neighbours.assign(number_of_faces, Element_vector());
+		for (int face_number = 0; face_number < number_of_faces; ++face_number)
+		{
+			int number_of_adjacent_elements = 0;
+			struct FE_element **adjacent_elements = 0;
+			if (adjacent_FE_element(element, face_number, &number_of_adjacent_elements,
+				&adjacent_elements))
+			{
+				Element_vector& face_row = neighbours[face_number];
+				for (int i = 0; i < number_of_adjacent_elements; ++i)
+				{
+					if (FE_region_contains_FE_element(fe_region, adjacent_elements[i]))
+					{
+						face_row.push_back(adjacent_elements[i]);
+					}
+				}
+				std::sort(face_row.begin(), face_row.end(), FE_element_identifier_less);
+				DEALLOCATE(adjacent_elements);
+			}
+		}
+	}
+
+	/** Replaces the rows for element and its old and new neighbours with
+	 * overrides calculated from its current nodes and faces */
+	void update_element(struct FE_element *element)
+	{
+		std::map<struct FE_element *, Node_vector>::iterator changed_nodes_iter =
+			changed_element_nodes.find(element);
+		if (changed_nodes_iter != changed_element_nodes.end())
+		{
+			for (Node_vector::iterator node_iter = changed_nodes_iter->second.begin();
+				node_iter != changed_nodes_iter->second.end(); ++node_iter)
+			{
+				std::map<struct FE_node *, Element_vector>::iterator row_iter =
+					changed_node_elements.find(*node_iter);
+				if (row_iter != changed_node_elements.end())
+				{
+					row_iter->second.erase(std::remove(row_iter->second.begin(),
+						row_iter->second.end(), element), row_iter->second.end());
+					if (row_iter->second.empty())
+					{
+						changed_node_elements.erase(row_iter);
+					}
+				}
+			}
+			changed_element_nodes.erase(changed_nodes_iter);
+		}
+		std::set<struct FE_element *> affected_elements;
+		Face_neighbours neighbours;
+		get_face_neighbours(element, neighbours);
+		for (Face_neighbours::iterator face_iter = neighbours.begin();
+			face_iter != neighbours.end(); ++face_iter)
+		{
+			affected_elements.insert(face_iter->begin(), face_iter->end());
+		}
+		stale_elements.insert(element);
+		if (FE_region_contains_FE_element(fe_region, element))
+		{
+			Node_vector& element_nodes = changed_element_nodes[element];
+			FE_element_get_distinct_nodes(element, element_nodes);
+			for (Node_vector::iterator node_iter = element_nodes.begin();
+				node_iter != element_nodes.end(); ++node_iter)
+			{
+				changed_node_elements[*node_iter].push_back(element);
+			}
+			Face_neighbours& new_neighbours = changed_face_neighbours[element];
+			calculate_face_neighbours(element, new_neighbours);
+			for (Face_neighbours::iterator face_iter = new_neighbours.begin();
+				face_iter != new_neighbours.end(); ++face_iter)
+			{
+				affected_elements.insert(face_iter->begin(), face_iter->end());
+			}
+		}
+		else
+		{
+			changed_face_neighbours.erase(element);
+		}
+		affected_elements.erase(element);
+		for (std::set<struct FE_element *>::iterator iter = affected_elements.begin();
+			iter != affected_elements.end(); ++iter)
+		{
+			if (FE_region_contains_FE_element(fe_region, *iter))
+			{
+				calculate_face_neighbours(*iter, changed_face_neighbours[*iter]);
+			}
+		}
+	}
+};
+
+FE_mesh_adjacency::FE_mesh_adjacency(struct FE_region *fe_region_in) :
+	fe_region(fe_region_in)
+{
+	for (int dim = 0; dim < MAXIMUM_ELEMENT_XI_DIMENSIONS; ++dim)
+	{
+		mesh_indexes[dim] = 0;
+	}
+}
+
+FE_mesh_adjacency::~FE_mesh_adjacency()
+{
+	for (int dim = 0; dim < MAXIMUM_ELEMENT_XI_DIMENSIONS; ++dim)
+	{
+		delete mesh_indexes[dim];
+	}
+}
+
+void FE_mesh_adjacency::element_changed(struct FE_element *element)
+{
+	const int dimension = get_FE_element_dimension(element);
+	if ((1 <= dimension) && (dimension <= MAXIMUM_ELEMENT_XI_DIMENSIONS) &&
+		mesh_indexes[dimension - 1])
+	{
+		Mesh_index *mesh_index = mesh_indexes[dimension - 1];
+		mesh_index->add_pending_element(element);
+		/* don't hold on to many changes that may never be queried */
+		if (mesh_index->needs_rebuild())
+		{
+			delete mesh_index;
+			mesh_indexes[dimension - 1] = 0;
+		}
+	}
+}
+
+FE_mesh_adjacency::Mesh_index *FE_mesh_adjacency::get_mesh_index(int dimension)
+{
+	if ((dimension < 1) || (MAXIMUM_ELEMENT_XI_DIMENSIONS < dimension))
+	{
+		return 0;
+	}
+	Mesh_index *mesh_index = mesh_indexes[dimension - 1];
+	if (mesh_index)
+	{
+		mesh_index->apply_pending_elements();
+		if (mesh_index->needs_rebuild())
+		{
+			delete mesh_index;
+			mesh_index = 0;
+		}
+	}
+	if (!mesh_index)
+	{
+		mesh_index = new Mesh_index(fe_region, dimension);
+		mesh_indexes[dimension - 1] = mesh_index;
+	}
+	return mesh_index;
+}
+
+int FE_mesh_adjacency::get_elements_using_node(int dimension,
+	struct FE_node *node, Element_vector& elements)
+{
+	Mesh_index *mesh_index = get_mesh_index(dimension);
+	if (mesh_index && node)
+	{
+		mesh_index->get_elements_using_node(node, elements);
+		return 1;
+	}
+	display_message(ERROR_MESSAGE,
+		"FE_mesh_adjacency::get_elements_using_node.  Invalid argument(s)");
+	return 0;
+}
+
+int FE_mesh_adjacency::get_adjacent_elements(struct FE_element *element,
+	int face_number, Element_vector& elements)
+{
+	Mesh_index *mesh_index = element ?
+		get_mesh_index(get_FE_element_dimension(element)) : 0;
+	if (mesh_index && (0 <= face_number))
+	{
+		Face_neighbours neighbours;
+		mesh_index->get_face_neighbours(element, neighbours);
+		if (face_number < static_cast<int>(neighbours.size()))
+		{
+			elements.swap(neighbours[face_number]);
+		}
+		else
+		{
+			elements.clear();
+		}
+		return 1;
+	}
+	display_message(ERROR_MESSAGE,
+		"FE_mesh_adjacency::get_adjacent_elements.  Invalid argument(s)");
+	return 0;
+}
@@ -0,0 +1,104 @@
+/*******************************************************************************
+FILE : finite_element_mesh_adjacency.hpp
+
+DESCRIPTION :
+Node-to-element and face neighbour index for the elements of an FE_region,
+built on demand and kept up to date from the FE_region's element changes.
+==============================================================================*/
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is cmgui.
+ *
+ * The Initial Developer of the Original Code is
+ * Auckland Uniservices Ltd, Auckland, New Zealand.
+ * Portions created by the Initial Developer are Copyright (C) 2012
+ * the Initial Developer. All Rights Reserved.
+ *
+ * Contributor(s):
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+#if !defined (FINITE_ELEMENT_MESH_ADJACENCY_HPP)
+#define FINITE_ELEMENT_MESH_ADJACENCY_HPP
+
+#include <vector>
+#include "general/value.h"
+
+struct FE_element;
+struct FE_node;
+struct FE_region;
+
+/**
+ * Adjacency of the elements in a master FE_region. The elements of each
+ * dimension are indexed by the first query for that dimension, storing the
+ * elements using each node and the neighbours sharing each face in compressed
+ * row arrays. The FE_region reports every element it adds, removes or changes
+ * with element_changed, and these are patched into small per-element overrides
+ * of the rows on the next query. The arrays are rebuilt once the overrides
+ * reach a quarter of the mesh. Elements are held in the index without access
+ * counts, apart from changed elements waiting to be applied.
+ * Queries update the index so must not be made concurrently.
+ */
+class FE_mesh_adjacency
+{
+public:
+	typedef std::vector<struct FE_element *> Element_vector;
+
+private:
+	class Mesh_index;
+
+	/* not accessed: the adjacency is owned by the FE_region */
+	struct FE_region *fe_region;
+	Mesh_index *mesh_indexes[MAXIMUM_ELEMENT_XI_DIMENSIONS];
+
+public:
+	FE_mesh_adjacency(struct FE_region *fe_region_in);
+
+	~FE_mesh_adjacency();
+
+	/** Records that element was added to, removed from or changed in the
+	 * FE_region, if its dimension has been indexed. */
+	void element_changed(struct FE_element *element);
+
+	/**
+	 * Gets the elements of dimension which use node, ordered by identifier.
+	 * @return  1 on success, 0 on failure.
+	 */
+	int get_elements_using_node(int dimension, struct FE_node *node,
+		Element_vector& elements);
+
+	/**
+	 * Gets the other elements sharing face face_number of element, ordered by
+	 * identifier. Empty if the face is not defined or is on the boundary.
+	 * @return  1 on success, 0 on failure.
+	 */
+	int get_adjacent_elements(struct FE_element *element, int face_number,
+		Element_vector& elements);
+
+private:
+	Mesh_index *get_mesh_index(int dimension);
+};
+
+#endif /* !defined (FINITE_ELEMENT_MESH_ADJACENCY_HPP) */
@@ -45,6 +45,7 @@ modules such as finite_element_region.c.
 #if !defined (FINITE_ELEMENT_PRIVATE_H)
 #define FINITE_ELEMENT_PRIVATE_H
 
+#include <vector>
 #include "finite_element/finite_element.h"
 #include "general/indexed_list_private.h"
 #include "general/indexed_list_stl_private.hpp"
@@ -610,6 +611,32 @@ FE_element_type_node_sequence for it and adds it to the given list. Note that
 function fails if two faces have the same shape and share the same nodes.
 ==============================================================================*/
 
+/***************************************************************************//**
+ * Gets the identifiers of the distinct nodes used by the default coordinate
+ * field in <element>, inherited from its parents as needed, in ascending
+ * order. These are the node numbers of CREATE(FE_element_type_node_sequence).
+ * @return  1 on success, 0 with error if element has no coordinate nodes.
+ */
+int FE_element_get_coordinate_node_identifiers(struct FE_element *element,
+	std::vector<int>& node_identifiers);
+
+/***************************************************************************//**
+ * Gets the identifiers of the distinct nodes which the coordinate field
+ * defined on <element> itself uses on face <face_number>, or on a line of
+ * that face, in ascending order. These are the node numbers a new face or
+ * line with <element> as its only ancestor would have, found without
+ * creating it. Does not access or modify any objects so may be called
+ * concurrently for different elements.
+ * @param face_shape  Shape of the face; only needed with a line_number.
+ * @param line_number  Face of face_shape to get nodes for, or -1 to get nodes
+ * for the face itself.
+ * @return  1 on success, 0 without error if element does not define a node
+ * based coordinate field itself, or the face has no nodes.
+ */
+int FE_element_get_face_node_identifiers(struct FE_element *element,
+	int face_number, struct FE_element_shape *face_shape, int line_number,
+	std::vector<int>& node_identifiers);
+
 PROTOTYPE_OBJECT_FUNCTIONS(FE_element_type_node_sequence);
 
 PROTOTYPE_LIST_FUNCTIONS(FE_element_type_node_sequence);
@@ -43,12 +43,18 @@ finite element fields defined on or interpolated over them.
  *
  * ***** END LICENSE BLOCK ***** */
 
+#include <algorithm>
 #include <cstdlib>
 #include <cstdio>
+#include <map>
+#include <vector>
 #include "finite_element/finite_element.h"
+#include "finite_element/finite_element_face_index.hpp"
+#include "finite_element/finite_element_mesh_adjacency.hpp"
 #include "finite_element/finite_element_private.h"
 #include "finite_element/finite_element_region.h"
 #include "finite_element/finite_element_region_private.h"
+#include "finite_element/finite_element_time_series.hpp"
 #include "general/callback_private.h"
 #include "general/compare.h"
 #include "general/debug.h"
@@ -142,11 +148,22 @@ DESCRIPTION :
 	struct FE_element_field_info *last_fe_element_field_info;
 
 	/* information for defining faces */
-	/* existence of element_type_node_sequence_list can tell us whether faces
-		 are being defined */
-	struct LIST(FE_element_type_node_sequence) *element_type_node_sequence_list;
+	/* existence of face_index can tell us whether faces are being defined */
+	FE_face_index *face_index;
 	int define_faces_of_dimension[MAXIMUM_ELEMENT_XI_DIMENSIONS];
 
+	/* node-to-element and face neighbour index, created on first use in a
+		 master FE_region and told of every element change */
+	FE_mesh_adjacency *adjacency;
+
+	/* out-of-core time series setting the values of fields at nodes, keyed by
+		 field; created on demand */
+	std::map<struct FE_field *, FE_nodal_time_series *> *field_time_series;
+
+	/* not accessed; told of node and element removals and identifier changes
+		 as they happen. Created on demand */
+	std::vector<FE_region_identifier_observer *> *identifier_observers;
+
 	/* Keep a record of where we got to searching for valid identifiers.
 		We reset the cache if we delete any items */
 	int next_fe_node_identifier_cache;
@@ -297,8 +314,13 @@ When a element is added or removed, the same element is used for <element> and \
 <field_info_element>. For changes to the contents of <element>,
 <field_info_element> should contain the changed fields, consistent with \
 merging it into <element>. \
+Changes are recorded in the adjacency index whether or not there are clients. \
 ============================================================================*/ \
 FE_ELEMENT_IDENTIFIER_CACHE_UPDATE_ ## change \
+if (fe_region->adjacency) \
+{ \
+	fe_region->adjacency->element_changed(element); \
+} \
 if (0 < fe_region->number_of_clients) \
 { \
 	int dimension = get_FE_element_dimension(element); \
@@ -326,6 +348,10 @@ If <fe_region> has clients for its change messages, records the <change> to \
 had a RELATED_OBJECT_CHANGED. If the cache_level is zero, sends an update. \
 Made into a macro for consistency/efficency/inlining. \
 ============================================================================*/ \
+if (fe_region->adjacency) \
+{ \
+	fe_region->adjacency->element_changed(element); \
+} \
 if (0 < fe_region->number_of_clients) \
 { \
 	int dimension = get_FE_element_dimension(element); \
@@ -415,6 +441,69 @@ static struct LIST(FE_element) *FE_region_get_element_list(
 	return 0;
 }
 
+/** Tells identifier observers of fe_region that node has been removed from it */
+static void FE_region_notify_FE_node_removed(struct FE_region *fe_region,
+	struct FE_node *node)
+{
+	if (fe_region->identifier_observers)
+	{
+		const int identifier = get_FE_node_identifier(node);
+		for (std::vector<FE_region_identifier_observer *>::iterator iter =
+			fe_region->identifier_observers->begin();
+			iter != fe_region->identifier_observers->end(); ++iter)
+		{
+			(*iter)->nodeRemoved(identifier);
+		}
+	}
+}
+
+static void FE_region_notify_FE_node_identifier_change(
+	struct FE_region *fe_region, int old_identifier, int new_identifier)
+{
+	if (fe_region->identifier_observers)
+	{
+		for (std::vector<FE_region_identifier_observer *>::iterator iter =
+			fe_region->identifier_observers->begin();
+			iter != fe_region->identifier_observers->end(); ++iter)
+		{
+			(*iter)->nodeIdentifierChanged(old_identifier, new_identifier);
+		}
+	}
+}
+
+/** Tells identifier observers of fe_region that element has been removed from
+ * it */
+static void FE_region_notify_FE_element_removed(struct FE_region *fe_region,
+	struct FE_element *element)
+{
+	if (fe_region->identifier_observers)
+	{
+		const int dimension = get_FE_element_dimension(element);
+		const int identifier = FE_element_get_cm_number(element);
+		for (std::vector<FE_region_identifier_observer *>::iterator iter =
+			fe_region->identifier_observers->begin();
+			iter != fe_region->identifier_observers->end(); ++iter)
+		{
+			(*iter)->elementRemoved(dimension, identifier);
+		}
+	}
+}
+
+static void FE_region_notify_FE_element_identifier_change(
+	struct FE_region *fe_region, int dimension, int old_identifier,
+	int new_identifier)
+{
+	if (fe_region->identifier_observers)
+	{
+		for (std::vector<FE_region_identifier_observer *>::iterator iter =
+			fe_region->identifier_observers->begin();
+			iter != fe_region->identifier_observers->end(); ++iter)
+		{
+			(*iter)->elementIdentifierChanged(dimension, old_identifier, new_identifier);
+		}
+	}
+}
+
 static int FE_region_create_change_logs(struct FE_region *fe_region)
 /*******************************************************************************
 LAST MODIFIED : 25 March 2003
@@ -1171,8 +1260,12 @@ them to be specified allows sharing across regions).
 		FE_region_create_change_logs(fe_region);
 
 		/* information for defining faces */
-		fe_region->element_type_node_sequence_list =
-			(struct LIST(FE_element_type_node_sequence) *)NULL;
+		fe_region->face_index = (FE_face_index *)NULL;
+		fe_region->adjacency = (FE_mesh_adjacency *)NULL;
+		fe_region->field_time_series =
+			(std::map<struct FE_field *, FE_nodal_time_series *> *)NULL;
+		fe_region->identifier_observers =
+			(std::vector<FE_region_identifier_observer *> *)NULL;
 
 		fe_region->next_fe_node_identifier_cache = 0;
 		for (int dim = 0; dim < MAXIMUM_ELEMENT_XI_DIMENSIONS; ++dim)
@@ -1242,6 +1335,26 @@ Frees the memory for the FE_region and sets <*fe_region_address> to NULL.
 				FE_node_list_clear_embedded_locations(fe_region->fe_node_list, fe_region->fe_field_list, fe_region);
 				FE_region_end_change(fe_region);
 			}
+			delete fe_region->adjacency;
+			fe_region->adjacency = (FE_mesh_adjacency *)NULL;
+			delete fe_region->face_index;
+			fe_region->face_index = (FE_face_index *)NULL;
+			if (fe_region->field_time_series)
+			{
+				/* time series access nodes so must go before the node list */
+				for (std::map<struct FE_field *, FE_nodal_time_series *>::iterator iter =
+					fe_region->field_time_series->begin();
+					iter != fe_region->field_time_series->end(); ++iter)
+				{
+					delete iter->second;
+				}
+				delete fe_region->field_time_series;
+				fe_region->field_time_series =
+					(std::map<struct FE_field *, FE_nodal_time_series *> *)NULL;
+			}
+			delete fe_region->identifier_observers;
+			fe_region->identifier_observers =
+				(std::vector<FE_region_identifier_observer *> *)NULL;
 			if (fe_region->data_fe_region)
 			{
 				DEACCESS(FE_region)(&fe_region->data_fe_region);
@@ -1470,6 +1583,33 @@ Automatically calls the same function for any master_FE_region.
 	return (return_code);
 } /* FE_region_end_change */
 
+int FE_region_has_pending_changes(struct FE_region *fe_region)
+{
+	if (fe_region && (0 < fe_region->change_level))
+	{
+		int number_of_changes = 0;
+		if ((CHANGE_LOG_GET_NUMBER_OF_CHANGES(FE_field)(
+			fe_region->fe_field_changes, &number_of_changes) &&
+			(0 < number_of_changes)) ||
+			(CHANGE_LOG_GET_NUMBER_OF_CHANGES(FE_node)(
+				fe_region->fe_node_changes, &number_of_changes) &&
+				(0 < number_of_changes)))
+		{
+			return 1;
+		}
+		for (int dim = 0; dim < MAXIMUM_ELEMENT_XI_DIMENSIONS; ++dim)
+		{
+			if (CHANGE_LOG_GET_NUMBER_OF_CHANGES(FE_element)(
+				fe_region->fe_element_changes[dim], &number_of_changes) &&
+				(0 < number_of_changes))
+			{
+				return 1;
+			}
+		}
+	}
+	return 0;
+}
+
 int FE_region_add_callback(struct FE_region *fe_region,
 	CMISS_CALLBACK_FUNCTION(FE_region_change) *function, void *user_data)
 /*******************************************************************************
@@ -1551,6 +1691,40 @@ Removes the callback calling <function> with <user_data> from <region>.
 	return (return_code);
 } /* FE_region_remove_callback */
 
+int FE_region_add_identifier_observer(struct FE_region *fe_region,
+	FE_region_identifier_observer *observer)
+{
+	if (fe_region && observer)
+	{
+		if (!fe_region->identifier_observers)
+			fe_region->identifier_observers = new std::vector<FE_region_identifier_observer *>();
+		fe_region->identifier_observers->push_back(observer);
+		return 1;
+	}
+	display_message(ERROR_MESSAGE,
+		"FE_region_add_identifier_observer.  Invalid argument(s)");
+	return 0;
+}
+
+int FE_region_remove_identifier_observer(struct FE_region *fe_region,
+	FE_region_identifier_observer *observer)
+{
+	if (fe_region && observer && fe_region->identifier_observers)
+	{
+		std::vector<FE_region_identifier_observer *>::iterator iter =
+			std::find(fe_region->identifier_observers->begin(),
+				fe_region->identifier_observers->end(), observer);
+		if (iter != fe_region->identifier_observers->end())
+		{
+			fe_region->identifier_observers->erase(iter);
+			return 1;
+		}
+	}
+	display_message(ERROR_MESSAGE,
+		"FE_region_remove_identifier_observer.  Invalid argument(s)");
+	return 0;
+}
+
 static int FE_region_remove_FE_element_private(struct FE_region *fe_region,
 	struct FE_element *element)
 /*******************************************************************************
@@ -1618,6 +1792,7 @@ This function is recursive.
 				}
 				FE_REGION_FE_ELEMENT_CHANGE(fe_region, element,
 					CHANGE_LOG_OBJECT_REMOVED(FE_element), element);
+				FE_region_notify_FE_element_removed(fe_region, element);
 			}
 			DEACCESS(FE_element)(&element);
 		}
@@ -2488,6 +2663,7 @@ in use by an node in the same ultimate master FE_region.
 			}
 			else
 			{
+				const int old_identifier = get_FE_node_identifier(node);
 				// this temporarily removes the object from all indexed lists
 				if (LIST_BEGIN_IDENTIFIER_CHANGE(FE_node,cm_node_identifier)(
 					master_fe_region->fe_node_list, node))
@@ -2498,6 +2674,8 @@ in use by an node in the same ultimate master FE_region.
 					if (return_code)
 					{
 						FE_REGION_FE_NODE_IDENTIFIER_CHANGE(master_fe_region, node);
+						FE_region_notify_FE_node_identifier_change(master_fe_region,
+							old_identifier, new_identifier);
 					}
 				}
 				else
@@ -3419,6 +3597,14 @@ Cmiss_node_iterator_id FE_region_create_node_iterator(
 	return 0;
 }
 
+Cmiss_node_iterator_id FE_region_create_node_identifier_iterator(
+	struct FE_region *fe_region, identifier_bool_array *identifiers)
+{
+	if (fe_region)
+		return FE_node_list_create_identifier_iterator(fe_region->fe_node_list, identifiers);
+	return 0;
+}
+
 int FE_region_remove_FE_node(struct FE_region *fe_region,
 	struct FE_node *node)
 /*******************************************************************************
@@ -3484,6 +3670,7 @@ one node.
 				{
 					FE_REGION_FE_NODE_CHANGE(fe_region, node,
 						CHANGE_LOG_OBJECT_REMOVED(FE_node), node);
+					FE_region_notify_FE_node_removed(fe_region, node);
 				}
 				DEACCESS(FE_node)(&node);
 			}
@@ -3554,6 +3741,7 @@ FE_region_begin_change and FE_region_end_change to minimise messages.
 				{
 					FE_REGION_FE_NODE_CHANGE(fe_region, node,
 						CHANGE_LOG_OBJECT_REMOVED(FE_node), node);
+					FE_region_notify_FE_node_removed(fe_region, node);
 				}
 			}
 		}
@@ -3925,6 +4113,7 @@ int FE_region_change_FE_element_identifier(
 				{
 					CM_element_information cm;
 					get_FE_element_identifier(element, &cm);
+					const int old_identifier = cm.number;
 					cm.number = new_identifier;
 					return_code = set_FE_element_identifier(element, &cm);
 					LIST_END_IDENTIFIER_CHANGE(FE_element,identifier)(
@@ -3932,6 +4121,8 @@ int FE_region_change_FE_element_identifier(
 					if (return_code)
 					{
 						FE_REGION_FE_ELEMENT_IDENTIFIER_CHANGE(master_fe_region, element);
+						FE_region_notify_FE_element_identifier_change(master_fe_region,
+							dimension, old_identifier, new_identifier);
 					}
 				}
 				else
@@ -4273,6 +4464,110 @@ int FE_region_contains_FE_element_conditional(struct FE_element *element,
 	return FE_region_contains_FE_element((struct FE_region *)fe_region_void, element);
 }
 
+/***************************************************************************//**
+ * Returns the adjacency index of the master of fe_region, creating it if
+ * needed.
+ */
+static FE_mesh_adjacency *FE_region_get_adjacency(struct FE_region *fe_region)
+{
+	struct FE_region *master_fe_region = fe_region;
+	FE_region_get_ultimate_master_FE_region(fe_region, &master_fe_region);
+	if (!master_fe_region->adjacency)
+	{
+		master_fe_region->adjacency = new FE_mesh_adjacency(master_fe_region);
+	}
+	return master_fe_region->adjacency;
+}
+
+/***************************************************************************//**
+ * Copies those elements which are in fe_region to a new ALLOCATED array.
+ */
+static int FE_region_get_FE_element_array(struct FE_region *fe_region,
+	const FE_mesh_adjacency::Element_vector& elements,
+	int *number_of_elements_address, struct FE_element ***elements_address)
+{
+	struct FE_region *master_fe_region = fe_region;
+	FE_region_get_ultimate_master_FE_region(fe_region, &master_fe_region);
+	*number_of_elements_address = 0;
+	*elements_address = (struct FE_element **)NULL;
+	if (elements.empty())
+	{
+		return 1;
+	}
+	if (!ALLOCATE(*elements_address, struct FE_element *, elements.size()))
+	{
+		display_message(ERROR_MESSAGE,
+			"FE_region_get_FE_element_array.  Unable to allocate array");
+		return 0;
+	}
+	int number_of_elements = 0;
+	for (FE_mesh_adjacency::Element_vector::const_iterator iter = elements.begin();
+		iter != elements.end(); ++iter)
+	{
+		if ((fe_region == master_fe_region) ||
+			FE_region_contains_FE_element(fe_region, *iter))
+		{
+			(*elements_address)[number_of_elements] = *iter;
+			++number_of_elements;
+		}
+	}
+	if (0 == number_of_elements)
+	{
+		DEALLOCATE(*elements_address);
+	}
+	*number_of_elements_address = number_of_elements;
+	return 1;
+}
+
+int FE_region_get_FE_elements_using_FE_node(struct FE_region *fe_region,
+	int dimension, struct FE_node *node, int *number_of_elements_address,
+	struct FE_element ***elements_address)
+{
+	int return_code = 0;
+	if (fe_region && (1 <= dimension) && (dimension <= MAXIMUM_ELEMENT_XI_DIMENSIONS) &&
+		node && number_of_elements_address && elements_address)
+	{
+		FE_mesh_adjacency::Element_vector elements;
+		if (FE_region_get_adjacency(fe_region)->get_elements_using_node(
+			dimension, node, elements))
+		{
+			return_code = FE_region_get_FE_element_array(fe_region, elements,
+				number_of_elements_address, elements_address);
+		}
+	}
+	else
+	{
+		display_message(ERROR_MESSAGE,
+			"FE_region_get_FE_elements_using_FE_node.  Invalid argument(s)");
+	}
+	return (return_code);
+}
+
+int FE_region_get_adjacent_FE_elements(struct FE_region *fe_region,
+	struct FE_element *element, int face_number,
+	int *number_of_adjacent_elements_address,
+	struct FE_element ***adjacent_elements_address)
+{
+	int return_code = 0;
+	if (fe_region && element && (0 <= face_number) &&
+		number_of_adjacent_elements_address && adjacent_elements_address)
+	{
+		FE_mesh_adjacency::Element_vector elements;
+		if (FE_region_get_adjacency(fe_region)->get_adjacent_elements(
+			element, face_number, elements))
+		{
+			return_code = FE_region_get_FE_element_array(fe_region, elements,
+				number_of_adjacent_elements_address, adjacent_elements_address);
+		}
+	}
+	else
+	{
+		display_message(ERROR_MESSAGE,
+			"FE_region_get_adjacent_FE_elements.  Invalid argument(s)");
+	}
+	return (return_code);
+}
+
 int FE_element_is_not_in_FE_region(struct FE_element *element,
 	void *fe_region_void)
 {
@@ -4660,6 +4955,35 @@ Iterator version of <FE_region_merge_FE_element>.
 	return (return_code);
 } /* FE_region_merge_FE_element_iterator */
 
+/**
+ * Iterator function adding <element> to the FE_face_index if it is a face or
+ * line, keyed by its coordinate field nodes.
+ */
+static int FE_element_add_to_FE_face_index(struct FE_element *element,
+	void *face_index_void)
+{
+	FE_face_index *face_index = static_cast<FE_face_index *>(face_index_void);
+	struct CM_element_information identifier;
+	if (!(element && face_index && get_FE_element_identifier(element, &identifier)))
+		return 0;
+	if ((identifier.type == CM_LINE) || (identifier.type == CM_FACE))
+	{
+		std::vector<int> node_identifiers;
+		if (!FE_element_get_coordinate_node_identifiers(element, node_identifiers))
+			return 0;
+		if (!face_index->add_face(element, get_FE_element_dimension(element),
+			static_cast<int>(node_identifiers.size()), &(node_identifiers[0])))
+		{
+			display_message(ERROR_MESSAGE,
+				"FE_element_add_to_FE_face_index.  Element %s %d has the same "
+				"dimension and nodes as another", CM_element_type_string(identifier.type),
+				identifier.number);
+			return 0;
+		}
+	}
+	return 1;
+}
+
 int FE_region_begin_define_faces(struct FE_region *fe_region, int face_dimension)
 {
 	int return_code;
@@ -4672,56 +4996,46 @@ int FE_region_begin_define_faces(struct FE_region *fe_region, int face_dimension
 		FE_region_get_ultimate_master_FE_region(fe_region, &master_fe_region) &&
 		(-1 <= face_dimension) && (face_dimension < MAXIMUM_ELEMENT_XI_DIMENSIONS))
 	{
-		if (master_fe_region->element_type_node_sequence_list)
+		if (master_fe_region->face_index)
 		{
 			display_message(ERROR_MESSAGE,
 				"FE_region_begin_define_faces.  Already defining faces");
 		}
 		else
 		{
-			master_fe_region->element_type_node_sequence_list =
-				CREATE(LIST(FE_element_type_node_sequence))();
-			if (master_fe_region->element_type_node_sequence_list)
+			master_fe_region->face_index = new FE_face_index();
+			for (int dim = 0; dim < MAXIMUM_ELEMENT_XI_DIMENSIONS; dim++)
 			{
-				for (int dim = 0; dim < MAXIMUM_ELEMENT_XI_DIMENSIONS; dim++)
-				{
-					fe_region->define_faces_of_dimension[dim] = 0;
-				}
-				if (face_dimension <= 0)
-				{
-					fe_region->define_faces_of_dimension[0] = 1;
-				}
-				int max_dimension = (face_dimension == -1) ? MAXIMUM_ELEMENT_XI_DIMENSIONS - 1 : face_dimension;
-				int min_dimension = (face_dimension == -1) ? 1 : face_dimension;
-				for (int dimension = max_dimension; min_dimension <= dimension; --dimension)
+				fe_region->define_faces_of_dimension[dim] = 0;
+			}
+			if (face_dimension <= 0)
+			{
+				fe_region->define_faces_of_dimension[0] = 1;
+			}
+			int max_dimension = (face_dimension == -1) ? MAXIMUM_ELEMENT_XI_DIMENSIONS - 1 : face_dimension;
+			int min_dimension = (face_dimension == -1) ? 1 : face_dimension;
+			for (int dimension = max_dimension; min_dimension <= dimension; --dimension)
+			{
+				fe_region->define_faces_of_dimension[dimension] = 1;
+				struct LIST(FE_element) *element_list =
+					FE_region_get_element_list(master_fe_region, dimension);
+				if (0 < NUMBER_IN_LIST(FE_element)(element_list))
 				{
-					fe_region->define_faces_of_dimension[dimension] = 1;
-					struct LIST(FE_element) *element_list =
-						FE_region_get_element_list(master_fe_region, dimension);
-					if (0 < NUMBER_IN_LIST(FE_element)(element_list))
+					if (FOR_EACH_OBJECT_IN_LIST(FE_element)(
+						FE_element_add_to_FE_face_index,
+						(void *)(master_fe_region->face_index), element_list))
 					{
-						if (FOR_EACH_OBJECT_IN_LIST(FE_element)(
-							FE_element_face_line_to_element_type_node_sequence_list,
-							(void *)(master_fe_region->element_type_node_sequence_list),
-							element_list))
-						{
-							return_code = 1;
-						}
-						else
-						{
-							display_message(ERROR_MESSAGE,
-								"FE_region_begin_define_faces.  "
-								"May not be able to share faces properly - perhaps "
-								"2 existing faces have same shape and node list?");
-						}
+						return_code = 1;
+					}
+					else
+					{
+						display_message(ERROR_MESSAGE,
+							"FE_region_begin_define_faces.  "
+							"May not be able to share faces properly - perhaps "
+							"2 existing faces have same shape and node list?");
 					}
 				}
 			}
-			else
-			{
-				display_message(ERROR_MESSAGE,
-					"FE_region_begin_define_faces.  Could not create node sequence list");
-			}
 		}
 	}
 	else
@@ -4745,10 +5059,10 @@ int FE_region_end_define_faces(struct FE_region *fe_region)
 	if (fe_region && (!fe_region->base_fe_region) &&
 		FE_region_get_ultimate_master_FE_region(fe_region, &master_fe_region))
 	{
-		if (master_fe_region->element_type_node_sequence_list)
+		if (master_fe_region->face_index)
 		{
-			DESTROY(LIST(FE_element_type_node_sequence))(
-				&master_fe_region->element_type_node_sequence_list);
+			delete master_fe_region->face_index;
+			master_fe_region->face_index = (FE_face_index *)NULL;
 			return_code = 1;
 		}
 		else
@@ -4857,8 +5171,44 @@ If the element has no parent, merges nodes directly referenced by <element>.
 	return (return_code);
 } /* FE_region_merge_FE_element_nodes */
 
+/**
+ * Creates a new face of <element> on <face_number> with the next free
+ * identifier of its dimension, and sets it in <element> so it inherits fields.
+ * The face is not merged into <fe_region>.
+ * @return  The new face, or NULL on failure.
+ */
+static struct FE_element *FE_region_create_FE_element_face(
+	struct FE_region *fe_region, struct FE_element *element,
+	struct FE_element_shape *element_shape, int face_number)
+{
+	struct FE_element *face = (struct FE_element *)NULL;
+	struct FE_region *master_fe_region = (struct FE_region *)NULL;
+	struct FE_element_shape *face_shape =
+		get_FE_element_shape_of_face(element_shape, face_number, fe_region);
+	if (face_shape && FE_region_get_ultimate_master_FE_region(fe_region, &master_fe_region))
+	{
+		ACCESS(FE_element_shape)(face_shape);
+		int face_dimension = 0;
+		get_FE_element_shape_dimension(face_shape, &face_dimension);
+		int new_face_number = FE_region_get_next_FE_element_identifier(
+			fe_region, face_dimension, 0);
+		struct CM_element_information face_identifier =
+			{ DIMENSION_TO_CM_ELEMENT_TYPE(face_dimension), new_face_number };
+		face = CREATE(FE_element)(&face_identifier, face_shape, master_fe_region,
+			(struct FE_element *)NULL);
+		if (face)
+		{
+			/* must put the face in the element to inherit fields */
+			set_FE_element_face(element, face_number, face);
+		}
+		DEACCESS(FE_element_shape)(&face_shape);
+	}
+	return face;
+}
+
 static int FE_region_merge_FE_element_and_faces_private(
-	struct FE_region *fe_region, struct FE_element *element)
+	struct FE_region *fe_region, struct FE_element *element,
+	const FE_face_node_sequence *face_sequences)
 /*******************************************************************************
 LAST MODIFIED : 14 May 2003
 
@@ -4880,6 +5230,9 @@ If calls to this function are placed between FE_region_begin/end_define_faces,
 then any missing faces are created and also merged into <fe_region>.
 Function ensures that elements share existing faces and lines in preference to
 creating new ones if they have matching shape and nodes.
+Optional <face_sequences> give the nodes of each face of <element> found in
+advance by FE_element_face_node_sequences, so faces which match existing ones
+or are collapsed need not be created first.
 
 ???RC Can only match faces correctly for coordinate fields with standard node
 to element maps and no versions. A grid-based coordinate field would fail
@@ -4893,9 +5246,7 @@ against.
 {
 	int face_number, number_of_faces, return_code;
 	struct FE_element *face;
-	struct FE_element_shape *element_shape, *face_shape;
-	struct FE_element_type_node_sequence *element_type_node_sequence,
-		*existing_element_type_node_sequence;
+	struct FE_element_shape *element_shape;
 	struct FE_region *master_fe_region;
 
 	ENTER(FE_region_merge_FE_element_and_faces_private);
@@ -4908,38 +5259,68 @@ against.
 		return_code = 1;
 		int number_of_new_faces = 0;
 		int face_dimension = get_FE_element_dimension(element) - 1;
-		int define_new_faces = (0 != master_fe_region->element_type_node_sequence_list) &&
+		FE_face_index *face_index = master_fe_region->face_index;
+		int define_new_faces = (0 != face_index) &&
 			fe_region->define_faces_of_dimension[face_dimension];
+		std::vector<int> node_identifiers;
 		for (face_number = 0; (face_number < number_of_faces) && return_code;
 			face_number++)
 		{
 			face = (struct FE_element *)NULL;
+			const FE_face_node_sequence *face_face_sequences = (const FE_face_node_sequence *)NULL;
 			if ((return_code = get_FE_element_face(element, face_number, &face)) &&
 				(!face) && define_new_faces)
 			{
-				face_shape = get_FE_element_shape_of_face(element_shape, face_number, fe_region);
-				if (face_shape)
+				const FE_face_node_sequence *face_sequence = (face_sequences &&
+					(0 <= face_sequences[face_number].number_of_nodes)) ?
+					(face_sequences + face_number) : (const FE_face_node_sequence *)NULL;
+				if (face_sequence)
 				{
-					ACCESS(FE_element_shape)(face_shape);
-					get_FE_element_shape_dimension(face_shape, &face_dimension);
-					int new_face_number = FE_region_get_next_FE_element_identifier(
-						fe_region, face_dimension, 0);
-					struct CM_element_information face_identifier =
-						{ DIMENSION_TO_CM_ELEMENT_TYPE(face_dimension), new_face_number };
-					face = CREATE(FE_element)(&face_identifier, face_shape,	master_fe_region, (struct FE_element *)NULL);
+					/* nodes were found in advance: only create the face if it is not
+						 collapsed and there is no existing face with the same nodes */
+					if (!FE_face_index::is_collapsed(face_dimension,
+						face_sequence->number_of_nodes))
+					{
+						face = face_index->find_face(face_dimension,
+							face_sequence->number_of_nodes, face_sequence->node_identifiers);
+						if (face)
+						{
+							set_FE_element_face(element, face_number, face);
+						}
+						else
+						{
+							face = FE_region_create_FE_element_face(fe_region,
+								element, element_shape, face_number);
+							if (face)
+							{
+								face_index->add_face(face, face_dimension,
+									face_sequence->number_of_nodes, face_sequence->node_identifiers);
+								face_face_sequences = face_sequence->faces;
+							}
+							else
+							{
+								return_code = 0;
+							}
+						}
+						if (face)
+						{
+							number_of_new_faces++;
+						}
+					}
+				}
+				else
+				{
+					face = FE_region_create_FE_element_face(fe_region,
+						element, element_shape, face_number);
 					if (face)
 					{
-						/* must put the face in the element to inherit fields */
-						set_FE_element_face(element, face_number, face);
 						number_of_new_faces++;
 						/* try to find an existing face in the FE_region with the same
 							 shape and the same nodes as face */
-						element_type_node_sequence = CREATE(FE_element_type_node_sequence)(face);
-						if (element_type_node_sequence)
+						if (FE_element_get_coordinate_node_identifiers(face, node_identifiers))
 						{
-							ACCESS(FE_element_type_node_sequence)(element_type_node_sequence);
-							if (FE_element_type_node_sequence_is_collapsed(
-								element_type_node_sequence))
+							const int number_of_nodes = static_cast<int>(node_identifiers.size());
+							if (FE_face_index::is_collapsed(face_dimension, number_of_nodes))
 							{
 								/* clear the face */
 								set_FE_element_face(element, face_number,
@@ -4949,27 +5330,20 @@ against.
 							}
 							else
 							{
-								existing_element_type_node_sequence =
-									FIND_BY_IDENTIFIER_IN_LIST(FE_element_type_node_sequence,
-										identifier)(FE_element_type_node_sequence_get_identifier(
-											element_type_node_sequence),
-											master_fe_region->element_type_node_sequence_list);
-								if (existing_element_type_node_sequence)
+								struct FE_element *existing_face = face_index->find_face(
+									face_dimension, number_of_nodes, &(node_identifiers[0]));
+								if (existing_face)
 								{
-									face = FE_element_type_node_sequence_get_FE_element(
-										existing_element_type_node_sequence);
+									face = existing_face;
 									set_FE_element_face(element, face_number, face);
 								}
 								else
 								{
-									/* remember this sequence */
-									ADD_OBJECT_TO_LIST(FE_element_type_node_sequence)(
-										element_type_node_sequence,
-										master_fe_region->element_type_node_sequence_list);
+									/* remember this face */
+									face_index->add_face(face, face_dimension, number_of_nodes,
+										&(node_identifiers[0]));
 								}
 							}
-							DEACCESS(FE_element_type_node_sequence)(
-								&element_type_node_sequence);
 						}
 						else
 						{
@@ -4985,19 +5359,13 @@ against.
 					{
 						return_code = 0;
 					}
-					DEACCESS(FE_element_shape)(&face_shape);
-				}
-				else
-				{
-					/* could not get face_shape */
-					return_code = 0;
 				}
 			}
 			if (face)
 			{
 				/* ensure the face and its lines are in the fe_region */
-				return_code =
-					FE_region_merge_FE_element_and_faces_private(fe_region, face);
+				return_code = FE_region_merge_FE_element_and_faces_private(
+					fe_region, face, face_face_sequences);
 			}
 		} /* loop over faces */
 		if (return_code)
@@ -5084,7 +5452,7 @@ against.
 		if (FE_region_merge_FE_element_nodes(fe_region, element))
 		{
 			if (!FE_region_merge_FE_element_and_faces_private(
-				fe_region, element))
+				fe_region, element, /*face_sequences*/(const FE_face_node_sequence *)NULL))
 			{
 				display_message(ERROR_MESSAGE,
 					"FE_region_merge_FE_element_and_faces_and_nodes.  "
@@ -5121,18 +5489,35 @@ int FE_region_define_faces(struct FE_region *fe_region)
 		FE_region_begin_define_faces(fe_region, /*all dimensions*/-1);
 		for (int dimension = MAXIMUM_ELEMENT_XI_DIMENSIONS; (2 <= dimension) && return_code; --dimension)
 		{
+			/* copy the elements as faces are added to the lists while defining */
+			std::vector<struct FE_element *> elements;
 			LIST(FE_element) *element_list = FE_region_get_element_list(fe_region, dimension);
 			Cmiss_element_iterator_id iter = CREATE_LIST_ITERATOR(FE_element)(element_list);
 			Cmiss_element_id element = 0;
 			while (0 != (element = Cmiss_element_iterator_next_non_access(iter)))
 			{
-				if (!FE_region_merge_FE_element_and_faces_and_nodes(fe_region, element))
+				elements.push_back(element);
+			}
+			Cmiss_element_iterator_destroy(&iter);
+			/* find nodes of faces and their lines in parallel, then create faces
+				 serially in element order so face identifiers are as before */
+			const int face_dimension = dimension - 1;
+			FE_element_face_node_sequences face_node_sequences(fe_region, elements,
+				0 != fe_region->define_faces_of_dimension[face_dimension],
+				(2 <= face_dimension) && fe_region->define_faces_of_dimension[face_dimension - 1]);
+			const int number_of_elements = static_cast<int>(elements.size());
+			for (int i = 0; i < number_of_elements; ++i)
+			{
+				if (!(FE_region_merge_FE_element_nodes(fe_region, elements[i]) &&
+					FE_region_merge_FE_element_and_faces_private(fe_region, elements[i],
+						face_node_sequences.get_element_face_sequences(i))))
 				{
+					display_message(ERROR_MESSAGE,
+						"FE_region_define_faces.  Could not merge element and faces");
 					return_code = 0;
 					break;
 				}
 			}
-			Cmiss_element_iterator_destroy(&iter);
 		}
 		FE_region_end_define_faces(fe_region);
 		FE_region_end_change(fe_region);
@@ -5505,6 +5890,16 @@ Cmiss_element_iterator_id FE_region_create_element_iterator(
 	return 0;
 }
 
+Cmiss_element_iterator_id FE_region_create_element_identifier_iterator(
+	struct FE_region *fe_region, int dimension,
+	identifier_bool_array *identifiers)
+{
+	if (fe_region)
+		return FE_element_list_create_identifier_iterator(
+			FE_region_get_element_list(fe_region, dimension), dimension, identifiers);
+	return 0;
+}
+
 struct FE_element *FE_region_element_string_to_FE_element(
 	struct FE_region *fe_region, const char *name)
 {
@@ -6537,7 +6932,8 @@ plus nodes from <fe_region> of the same number as those currently used.
 				{
 					return_code = 0;
 				}
-				if (!FE_region_merge_FE_element_and_faces_private(data->fe_region, element))
+				if (!FE_region_merge_FE_element_and_faces_private(data->fe_region, element,
+					/*face_sequences*/(const FE_face_node_sequence *)NULL))
 				{
 					return_code = 0;
 				}
@@ -6990,6 +7386,67 @@ struct LIST(FE_node) *FE_region_create_related_node_list(struct FE_region *fe_re
 	return fe_node_list;
 }
 
+int FE_region_set_FE_field_time_series(struct FE_region *fe_region,
+	struct FE_field *field, struct Time_keeper *time_keeper,
+	const char *file_name, int window_size)
+{
+	if (!(fe_region && field && ((!file_name) || time_keeper)))
+	{
+		display_message(ERROR_MESSAGE,
+			"FE_region_set_FE_field_time_series.  Invalid argument(s)");
+		return 0;
+	}
+	if (!FE_region_contains_FE_field(fe_region, field))
+	{
+		display_message(ERROR_MESSAGE,
+			"FE_region_set_FE_field_time_series.  Field is not from this region");
+		return 0;
+	}
+	FE_nodal_time_series *time_series = (FE_nodal_time_series *)NULL;
+	if (file_name)
+	{
+		time_series = FE_nodal_time_series::create(fe_region, field,
+			time_keeper, file_name, window_size);
+		if (!time_series)
+		{
+			return 0;
+		}
+	}
+	if (fe_region->field_time_series)
+	{
+		std::map<struct FE_field *, FE_nodal_time_series *>::iterator iter =
+			fe_region->field_time_series->find(field);
+		if (iter != fe_region->field_time_series->end())
+		{
+			delete iter->second;
+			fe_region->field_time_series->erase(iter);
+		}
+	}
+	if (time_series)
+	{
+		if (!fe_region->field_time_series)
+		{
+			fe_region->field_time_series =
+				new std::map<struct FE_field *, FE_nodal_time_series *>();
+		}
+		(*(fe_region->field_time_series))[field] = time_series;
+	}
+	return 1;
+}
+
+int FE_region_write_FE_field_time_series(struct FE_region *fe_region,
+	struct FE_field *field, const char *file_name)
+{
+	if (!(fe_region && field && file_name &&
+		FE_region_contains_FE_field(fe_region, field)))
+	{
+		display_message(ERROR_MESSAGE,
+			"FE_region_write_FE_field_time_series.  Invalid argument(s)");
+		return 0;
+	}
+	return FE_nodal_time_series::write(fe_region, field, file_name);
+}
+
 void FE_region_list_btree_statistics(struct FE_region *fe_region)
 {
 	if (fe_region)
@@ -50,8 +50,10 @@ finite element fields defined on or interpolated over them.
 #include "general/any_object_prototype.h"
 #include "general/callback.h"
 #include "general/change_log.h"
+#include "general/debug.h"
 #include "general/object.h"
 #include "region/cmiss_region.h"
+#include "time/time_keeper.h"
 
 /*
 Global types
@@ -80,6 +82,52 @@ the changes are limited to the fields listed in the <fe_field_changes>.
 DECLARE_CMISS_CALLBACK_TYPES(FE_region_change, \
 	struct FE_region *, struct FE_region_changes *, void);
 
+/***************************************************************************//**
+ * Told of node and element removals and identifier changes in an FE_region as
+ * they happen, rather than collated in the next change callback. For clients
+ * recording objects by identifier, e.g. group membership, which need the
+ * identifier an object had when it was removed and the old identifier of a
+ * renumbered object, neither of which the change logs keep.
+ * Observers must not modify the FE_region or send change messages.
+ */
+class FE_region_identifier_observer
+{
+public:
+	virtual ~FE_region_identifier_observer()
+	{
+	}
+
+	/** Called after node with identifier is removed from the FE_region */
+	virtual void nodeRemoved(int identifier)
+	{
+		USE_PARAMETER(identifier);
+	}
+
+	/** Called after a node in the FE_region is given a new identifier */
+	virtual void nodeIdentifierChanged(int old_identifier, int new_identifier)
+	{
+		USE_PARAMETER(old_identifier);
+		USE_PARAMETER(new_identifier);
+	}
+
+	/** Called after element with dimension and identifier is removed from the
+	 * FE_region */
+	virtual void elementRemoved(int dimension, int identifier)
+	{
+		USE_PARAMETER(dimension);
+		USE_PARAMETER(identifier);
+	}
+
+	/** Called after an element in the FE_region is given a new identifier */
+	virtual void elementIdentifierChanged(int dimension, int old_identifier,
+		int new_identifier)
+	{
+		USE_PARAMETER(dimension);
+		USE_PARAMETER(old_identifier);
+		USE_PARAMETER(new_identifier);
+	}
+};
+
 /*
 Global macros
 -------------
@@ -223,6 +271,14 @@ change counter is restored to zero by this function.
 Automatically calls the same function for any master_FE_region.
 ==============================================================================*/
 
+/***************************************************************************//**
+ * Determines whether fe_region is in a change cache with changes recorded
+ * which have not yet been sent to clients. Note changes are only recorded while
+ * fe_region has clients.
+ * @return  1 if fe_region has changes pending, 0 if not.
+ */
+int FE_region_has_pending_changes(struct FE_region *fe_region);
+
 int FE_region_add_callback(struct FE_region *fe_region,
 	CMISS_CALLBACK_FUNCTION(FE_region_change) *function, void *user_data);
 /*******************************************************************************
@@ -243,6 +299,21 @@ DESCRIPTION :
 Removes the callback calling <function> with <user_data> from <region>.
 ==============================================================================*/
 
+/***************************************************************************//**
+ * Adds observer to be told of node and element removals and identifier
+ * changes in fe_region as they happen. Observers are not accessed and must be
+ * removed before they are destroyed.
+ * @see FE_region_identifier_observer
+ */
+int FE_region_add_identifier_observer(struct FE_region *fe_region,
+	FE_region_identifier_observer *observer);
+
+/***************************************************************************//**
+ * Removes observer added with FE_region_add_identifier_observer.
+ */
+int FE_region_remove_identifier_observer(struct FE_region *fe_region,
+	FE_region_identifier_observer *observer);
+
 int FE_region_clear(struct FE_region *fe_region, int destroy_in_master);
 /*******************************************************************************
 LAST MODIFIED : 13 May 2003
@@ -651,6 +722,18 @@ For each FE_node in <fe_region> satisfying <conditional_function> with
 Cmiss_node_iterator_id FE_region_create_node_iterator(
 	struct FE_region *fe_region);
 
+/***************************************************************************//**
+ * Create a node iterator over the nodes in fe_region whose identifiers are
+ * true in identifiers, from lowest to highest identifier.
+ * @see FE_node_list_create_identifier_iterator
+ *
+ * @param fe_region  The region the nodes are in.
+ * @param identifiers  Identifiers of nodes to iterate over.
+ * @return  Handle to node_iterator at position before first, or NULL if error.
+ */
+Cmiss_node_iterator_id FE_region_create_node_identifier_iterator(
+	struct FE_region *fe_region, identifier_bool_array *identifiers);
+
 int FE_region_remove_FE_node(struct FE_region *fe_region,
 	struct FE_node *node);
 /*******************************************************************************
@@ -842,6 +925,43 @@ FE_element conditional function version of FE_region_contains_FE_element.
 Returns true if <element> is in <fe_region>.
 ==============================================================================*/
 
+/***************************************************************************//**
+ * Gets the elements of the given dimension in fe_region which use node, from
+ * the node-to-element index kept by the master FE_region. The index is built
+ * on first use and updated as elements change, so repeated calls are cheap.
+ * Not to be called concurrently for the same master FE_region.
+ *
+ * @param dimension  The dimension of elements to get, from 1 to 3.
+ * @param number_of_elements_address  On success, receives the number of
+ * elements, ordered by identifier.
+ * @param elements_address  On success, receives an ALLOCATED array of the
+ * elements which the caller must DEALLOCATE, or NULL if there are none.
+ * Elements are not accessed.
+ * @return  1 on success, 0 on failure.
+ */
+int FE_region_get_FE_elements_using_FE_node(struct FE_region *fe_region,
+	int dimension, struct FE_node *node, int *number_of_elements_address,
+	struct FE_element ***elements_address);
+
+/***************************************************************************//**
+ * Gets the other elements in fe_region which share face <face_number> of
+ * element, from the face neighbour index kept by the master FE_region.
+ * Unlike adjacent_FE_element, only elements in fe_region are returned.
+ * Not to be called concurrently for the same master FE_region.
+ *
+ * @param number_of_adjacent_elements_address  On success, receives the number
+ * of adjacent elements, ordered by identifier; zero if the face is not defined
+ * or is on the boundary.
+ * @param adjacent_elements_address  On success, receives an ALLOCATED array of
+ * the elements which the caller must DEALLOCATE, or NULL if there are none.
+ * Elements are not accessed.
+ * @return  1 on success, 0 on failure.
+ */
+int FE_region_get_adjacent_FE_elements(struct FE_region *fe_region,
+	struct FE_element *element, int face_number,
+	int *number_of_adjacent_elements_address,
+	struct FE_element ***adjacent_elements_address);
+
 int FE_element_is_not_in_FE_region(struct FE_element *element,
 	void *fe_region_void);
 /*******************************************************************************
@@ -1091,6 +1211,22 @@ int FE_region_for_each_FE_element_of_dimension_conditional(
 Cmiss_element_iterator_id FE_region_create_element_iterator(
 	struct FE_region *fe_region, int dimension);
 
+/***************************************************************************//**
+ * Create an element iterator over the elements of dimension in fe_region
+ * whose identifiers are true in identifiers, from lowest to highest
+ * identifier.
+ * @see FE_element_list_create_identifier_iterator
+ *
+ * @param fe_region  The region the elements are in.
+ * @param dimension  The dimension of elements to iterate over.
+ * @param identifiers  Identifiers of elements to iterate over.
+ * @return  Handle to element_iterator at position before first, or NULL if
+ * error.
+ */
+Cmiss_element_iterator_id FE_region_create_element_identifier_iterator(
+	struct FE_region *fe_region, int dimension,
+	identifier_bool_array *identifiers);
+
 /***************************************************************************//**
  * @return  Element from highest dimension mesh in region with identifier equal
  * to number in string name.
@@ -1189,6 +1325,29 @@ struct LIST(FE_element) *FE_region_create_related_element_list_for_dimension(
 
 struct LIST(FE_node) *FE_region_create_related_node_list(struct FE_region *fe_region);
 
+/***************************************************************************//**
+ * Sets the values of <field> at nodes in <fe_region> from a time series file
+ * for the current time of <time_keeper>, updating them whenever it changes.
+ * The file is memory mapped and only <window_size> time steps around the
+ * current time are kept resident, so the series may be larger than memory.
+ * The field must be defined without time at the nodes in the file.
+ * @param file_name  Time series file written by
+ * FE_region_write_FE_field_time_series, or NULL to stop using any series.
+ * @param window_size  Number of time steps kept in memory, at least 2.
+ * @return  1 on success, 0 on failure.
+ */
+int FE_region_set_FE_field_time_series(struct FE_region *fe_region,
+	struct FE_field *field, struct Time_keeper *time_keeper,
+	const char *file_name, int window_size);
+
+/***************************************************************************//**
+ * Writes the values of time-varying <field> at all nodes in <fe_region> where
+ * it is defined to a time series file. All the nodes must use the same times.
+ * @return  1 on success, 0 on failure.
+ */
+int FE_region_write_FE_field_time_series(struct FE_region *fe_region,
+	struct FE_field *field, const char *file_name);
+
 /***************************************************************************//**
  * List statistics about btree structures storing a region's nodes and elements.
  */
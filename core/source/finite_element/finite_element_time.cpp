@@ -347,7 +347,7 @@ Frees memory/deaccess objects in fe_time_sequence at <*fe_time_sequence_address>
 	return (return_code);
 } /* DESTROY(FE_time_sequence) */
 
-DECLARE_OBJECT_FUNCTIONS(FE_time_sequence)
+DECLARE_ATOMIC_OBJECT_FUNCTIONS(FE_time_sequence)
 
 DECLARE_INDEXED_LIST_FUNCTIONS(FE_time_sequence)
 
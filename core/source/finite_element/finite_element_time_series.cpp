@@ -0,0 +1,626 @@
+/*******************************************************************************
+FILE : finite_element_time_series.cpp
+
+DESCRIPTION :
+Out-of-core time series of the values of a finite element field at nodes, held
+in a memory mapped columnar file and paged in around the current time.
+==============================================================================*/
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is cmgui.
+ *
+ * The Initial Developer of the Original Code is
+ * Auckland Uniservices Ltd, Auckland, New Zealand.
+ * Portions created by the Initial Developer are Copyright (C) 2012
+ * the Initial Developer. All Rights Reserved.
+ *
+ * Contributor(s):
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+#include <algorithm>
+#include <cstring>
+#include "zinc/zincconfigure.h"
+#if defined (UNIX)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif /* defined (UNIX) */
+#include "general/debug.h"
+#include "general/message.h"
+#include "finite_element/finite_element.h"
+#include "finite_element/finite_element_region.h"
+#include "finite_element/finite_element_time.h"
+#include "finite_element/finite_element_time_series.hpp"
+#include "time/time.h"
+#include "time/time_keeper.h"
+
+namespace {
+
+const char time_series_magic[8] = { 'Z', 'N', 'T', 'S', 'E', 'R', '0', '1' };
+const size_t time_series_header_size = 8 + 4*sizeof(int);
+
+/** @return  size rounded up to a multiple of 8 bytes so columns of doubles
+ * are aligned. */
+size_t align_to_double(size_t size)
+{
+	return (size + 7) & ~static_cast<size_t>(7);
+}
+
+struct FE_node_field_defined_data
+{
+	struct FE_field *field;
+	std::vector<struct FE_node *> *nodes;
+};
+
+int FE_node_add_to_vector_if_field_defined(struct FE_node *node, void *data_void)
+{
+	FE_node_field_defined_data *data = static_cast<FE_node_field_defined_data *>(data_void);
+	if (FE_field_is_defined_at_node(data->field, node))
+	{
+		data->nodes->push_back(node);
+	}
+	return 1;
+}
+
+} // anonymous namespace
+
+FE_nodal_time_series::FE_nodal_time_series(struct FE_region *fe_region_in,
+	struct FE_field *field_in, int window_size_in) :
+	fe_region(fe_region_in),
+	field(ACCESS(FE_field)(field_in)),
+	time_object((struct Time_object *)NULL),
+	number_of_values_per_node(0),
+	data_offset(0),
+	window_size((window_size_in < 2) ? 2 : window_size_in),
+	window_first(-1),
+	last_time_index_one(-1),
+	last_time_index_two(-1),
+	last_xi(0.0),
+#if defined (UNIX)
+	file_descriptor(-1),
+	mapping((const unsigned char *)NULL),
+	mapping_size(0)
+#else /* defined (UNIX) */
+	file((FILE *)NULL)
+#endif /* defined (UNIX) */
+{
+}
+
+FE_nodal_time_series::~FE_nodal_time_series()
+{
+	if (time_object)
+	{
+		Time_object_remove_callback(time_object, FE_nodal_time_series::time_callback, this);
+		struct Time_keeper *time_keeper = Time_object_get_time_keeper(time_object);
+		if (time_keeper)
+		{
+			Time_keeper_remove_time_object(time_keeper, time_object);
+		}
+		DEACCESS(Time_object)(&time_object);
+	}
+	for (std::vector<struct FE_node *>::iterator iter = nodes.begin(); iter != nodes.end(); ++iter)
+	{
+		DEACCESS(FE_node)(&(*iter));
+	}
+	DEACCESS(FE_field)(&field);
+	close();
+}
+
+FE_nodal_time_series *FE_nodal_time_series::create(struct FE_region *fe_region,
+	struct FE_field *field, struct Time_keeper *time_keeper,
+	const char *file_name, int window_size)
+{
+	if (!(fe_region && field && time_keeper && file_name))
+	{
+		display_message(ERROR_MESSAGE, "FE_nodal_time_series::create.  Invalid argument(s)");
+		return 0;
+	}
+	FE_nodal_time_series *time_series = new FE_nodal_time_series(fe_region, field, window_size);
+	std::vector<int> node_identifiers;
+	int return_code = time_series->open(file_name, node_identifiers);
+	const int number_of_nodes = static_cast<int>(node_identifiers.size());
+	Value_slots slots;
+	for (int n = 0; return_code && (n < number_of_nodes); ++n)
+	{
+		struct FE_node *node = FE_region_get_FE_node_from_identifier(fe_region, node_identifiers[n]);
+		if (!(node && FE_field_is_defined_at_node(field, node) &&
+			get_node_value_slots(node, field, slots) &&
+			(static_cast<int>(slots.size()) == time_series->number_of_values_per_node)))
+		{
+			display_message(ERROR_MESSAGE, "FE_nodal_time_series::create.  "
+				"Node %d in time series %s is missing or does not have %d values of the field",
+				node_identifiers[n], file_name, time_series->number_of_values_per_node);
+			return_code = 0;
+			break;
+		}
+		/* nodes with the same field definition share value slots */
+		int slots_index = static_cast<int>(time_series->value_slots.size()) - 1;
+		while ((0 <= slots_index) && !(time_series->value_slots[slots_index] == slots))
+		{
+			--slots_index;
+		}
+		if (slots_index < 0)
+		{
+			slots_index = static_cast<int>(time_series->value_slots.size());
+			time_series->value_slots.push_back(slots);
+		}
+		time_series->nodes.push_back(ACCESS(FE_node)(node));
+		time_series->node_value_slots.push_back(slots_index);
+	}
+	if (return_code)
+	{
+		time_series->time_object = Time_object_create_regular(
+			/*update_frequency*/10.0, /*time_offset*/0.0);
+		if (time_series->time_object &&
+			Time_keeper_add_time_object(time_keeper, time_series->time_object) &&
+			Time_object_add_callback(time_series->time_object,
+				FE_nodal_time_series::time_callback, time_series))
+		{
+			return_code = time_series->set_time(Time_keeper_get_time(time_keeper));
+		}
+		else
+		{
+			return_code = 0;
+		}
+	}
+	if (!return_code)
+	{
+		display_message(ERROR_MESSAGE, "FE_nodal_time_series::create.  "
+			"Could not use time series %s", file_name);
+		delete time_series;
+		time_series = 0;
+	}
+	return time_series;
+}
+
+int FE_nodal_time_series::get_node_value_slots(struct FE_node *node,
+	struct FE_field *field, Value_slots& slots)
+{
+	slots.clear();
+	const int number_of_components = get_FE_field_number_of_components(field);
+	for (int c = 0; c < number_of_components; ++c)
+	{
+		const int number_of_versions = get_FE_node_field_component_number_of_versions(node, field, c);
+		const int number_of_derivatives = get_FE_node_field_component_number_of_derivatives(node, field, c);
+		enum FE_nodal_value_type *types = get_FE_node_field_component_nodal_value_types(node, field, c);
+		if (!types)
+		{
+			return 0;
+		}
+		for (int v = 0; v < number_of_versions; ++v)
+		{
+			for (int d = 0; d <= number_of_derivatives; ++d)
+			{
+				Value_slot slot = { c, v, types[d] };
+				slots.push_back(slot);
+			}
+		}
+		DEALLOCATE(types);
+	}
+	return 1;
+}
+
+int FE_nodal_time_series::open(const char *file_name, std::vector<int>& node_identifiers)
+{
+	size_t file_size = 0;
+#if defined (UNIX)
+	file_descriptor = ::open(file_name, O_RDONLY);
+	struct stat file_status;
+	if ((0 <= file_descriptor) && (0 == fstat(file_descriptor, &file_status)) &&
+		(time_series_header_size <= static_cast<size_t>(file_status.st_size)))
+	{
+		file_size = static_cast<size_t>(file_status.st_size);
+		void *address = mmap(0, file_size, PROT_READ, MAP_SHARED, file_descriptor, 0);
+		if (MAP_FAILED != address)
+		{
+			mapping = static_cast<const unsigned char *>(address);
+			mapping_size = file_size;
+		}
+	}
+	if (!mapping)
+	{
+		display_message(ERROR_MESSAGE,
+			"FE_nodal_time_series::open.  Could not map file %s", file_name);
+		close();
+		return 0;
+	}
+#else /* defined (UNIX) */
+	file = fopen(file_name, "rb");
+	if (file && (0 == fseek(file, 0, SEEK_END)))
+	{
+		long end = ftell(file);
+		if (0 < end)
+		{
+			file_size = static_cast<size_t>(end);
+		}
+	}
+	if (!(file && (time_series_header_size <= file_size)))
+	{
+		display_message(ERROR_MESSAGE,
+			"FE_nodal_time_series::open.  Could not open file %s", file_name);
+		close();
+		return 0;
+	}
+#endif /* defined (UNIX) */
+	char magic[8];
+	int header[4];
+	int return_code = read_bytes(0, sizeof(magic), magic) &&
+		(0 == memcmp(magic, time_series_magic, sizeof(magic))) &&
+		read_bytes(sizeof(magic), sizeof(header), header) &&
+		(0 < header[0]) && (0 < header[1]) && (0 < header[2]);
+	if (return_code)
+	{
+		const int number_of_times = header[0];
+		const int number_of_nodes = header[1];
+		number_of_values_per_node = header[2];
+		times.resize(number_of_times);
+		node_identifiers.resize(number_of_nodes);
+		const size_t times_offset = time_series_header_size;
+		const size_t nodes_offset = times_offset + number_of_times*sizeof(double);
+		data_offset = align_to_double(nodes_offset + number_of_nodes*sizeof(int));
+		const size_t column_size = static_cast<size_t>(number_of_nodes)*
+			number_of_values_per_node*sizeof(double);
+		return_code = ((data_offset + number_of_times*column_size) <= file_size) &&
+			read_bytes(times_offset, number_of_times*sizeof(double), &(times[0])) &&
+			read_bytes(nodes_offset, number_of_nodes*sizeof(int), &(node_identifiers[0]));
+		for (int i = 1; return_code && (i < number_of_times); ++i)
+		{
+			if (times[i] <= times[i - 1])
+			{
+				return_code = 0;
+			}
+		}
+	}
+	if (!return_code)
+	{
+		display_message(ERROR_MESSAGE,
+			"FE_nodal_time_series::open.  %s is not a valid time series file", file_name);
+		node_identifiers.clear();
+		close();
+	}
+	return return_code;
+}
+
+void FE_nodal_time_series::close()
+{
+#if defined (UNIX)
+	if (mapping)
+	{
+		munmap(const_cast<unsigned char *>(mapping), mapping_size);
+		mapping = 0;
+		mapping_size = 0;
+	}
+	if (0 <= file_descriptor)
+	{
+		::close(file_descriptor);
+		file_descriptor = -1;
+	}
+#else /* defined (UNIX) */
+	if (file)
+	{
+		fclose(file);
+		file = 0;
+	}
+	resident_columns.clear();
+#endif /* defined (UNIX) */
+	window_first = -1;
+}
+
+int FE_nodal_time_series::read_bytes(size_t offset, size_t size, void *destination)
+{
+#if defined (UNIX)
+	if (mapping && ((offset + size) <= mapping_size))
+	{
+		memcpy(destination, mapping + offset, size);
+		return 1;
+	}
+#else /* defined (UNIX) */
+#if defined (_MSC_VER)
+	if (file && (0 == _fseeki64(file, static_cast<__int64>(offset), SEEK_SET)) &&
+#else /* defined (_MSC_VER) */
+	if (file && (0 == fseek(file, static_cast<long>(offset), SEEK_SET)) &&
+#endif /* defined (_MSC_VER) */
+		(size == fread(destination, 1, size, file)))
+	{
+		return 1;
+	}
+#endif /* defined (UNIX) */
+	return 0;
+}
+
+const double *FE_nodal_time_series::get_column(int time_index)
+{
+	const size_t column_size = nodes.size()*number_of_values_per_node;
+#if defined (UNIX)
+	return reinterpret_cast<const double *>(mapping + data_offset +
+		time_index*column_size*sizeof(double));
+#else /* defined (UNIX) */
+	std::map<int, std::vector<double> >::iterator iter = resident_columns.find(time_index);
+	if (iter == resident_columns.end())
+	{
+		std::vector<double>& column = resident_columns[time_index];
+		column.resize(column_size);
+		if (!read_bytes(data_offset + time_index*column_size*sizeof(double),
+			column_size*sizeof(double), &(column[0])))
+		{
+			display_message(ERROR_MESSAGE, "FE_nodal_time_series::get_column.  "
+				"Could not read time %d", time_index);
+			resident_columns.erase(time_index);
+			return 0;
+		}
+		return &(column[0]);
+	}
+	return &(iter->second[0]);
+#endif /* defined (UNIX) */
+}
+
+/**
+ * Moves the window of time steps kept in memory to start at first. On UNIX
+ * the pages of time steps leaving the window are released and those entering
+ * it are read ahead; otherwise columns leaving the window are freed and are
+ * read when next needed.
+ */
+void FE_nodal_time_series::set_window(int first)
+{
+	if (first == window_first)
+	{
+		return;
+	}
+	const int number_of_times = static_cast<int>(times.size());
+#if defined (UNIX)
+	const size_t column_bytes = nodes.size()*number_of_values_per_node*sizeof(double);
+	const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+	for (int pass = 0; pass < 2; ++pass)
+	{
+		/* pass 0 releases the old window outside the new one, pass 1 reads ahead */
+		const int range_first = (0 == pass) ? window_first : first;
+		const int other_first = (0 == pass) ? first : window_first;
+		if (range_first < 0)
+		{
+			continue;
+		}
+		for (int t = range_first; (t < range_first + window_size) && (t < number_of_times); ++t)
+		{
+			if ((0 <= other_first) && (other_first <= t) && (t < other_first + window_size))
+			{
+				continue;
+			}
+			const size_t start = data_offset + t*column_bytes;
+			const size_t page_start = start - (start % page_size);
+			madvise(const_cast<unsigned char *>(mapping) + page_start,
+				start + column_bytes - page_start, (0 == pass) ? MADV_DONTNEED : MADV_WILLNEED);
+		}
+	}
+#else /* defined (UNIX) */
+	std::map<int, std::vector<double> >::iterator iter = resident_columns.begin();
+	while (iter != resident_columns.end())
+	{
+		if ((iter->first < first) || (iter->first >= first + window_size))
+		{
+			resident_columns.erase(iter++);
+		}
+		else
+		{
+			++iter;
+		}
+	}
+	USE_PARAMETER(number_of_times);
+#endif /* defined (UNIX) */
+	window_first = first;
+}
+
+int FE_nodal_time_series::set_time(double time)
+{
+	const int number_of_times = static_cast<int>(times.size());
+	if (0 == number_of_times)
+	{
+		return 0;
+	}
+	/* clamp to the first and last times, as FE_time_sequence does */
+	int time_index_one = 0;
+	int time_index_two = 0;
+	double xi = 0.0;
+	if (time >= times[number_of_times - 1])
+	{
+		time_index_one = time_index_two = number_of_times - 1;
+	}
+	else if (time > times[0])
+	{
+		time_index_two = static_cast<int>(
+			std::upper_bound(times.begin(), times.end(), time) - times.begin());
+		time_index_one = time_index_two - 1;
+		xi = (time - times[time_index_one]) / (times[time_index_two] - times[time_index_one]);
+	}
+	if ((time_index_one == last_time_index_one) &&
+		(time_index_two == last_time_index_two) && (xi == last_xi))
+	{
+		return 1;
+	}
+	/* keep window around the current times, with both in it */
+	int first = time_index_one - (window_size - 2)/2;
+	if (first > number_of_times - window_size)
+	{
+		first = number_of_times - window_size;
+	}
+	if (first < 0)
+	{
+		first = 0;
+	}
+	set_window(first);
+	const double *column_one = get_column(time_index_one);
+	const double *column_two = get_column(time_index_two);
+	if (!(column_one && column_two))
+	{
+		return 0;
+	}
+	int return_code = 1;
+	FE_region_begin_change(fe_region);
+	const int number_of_nodes = static_cast<int>(nodes.size());
+	for (int n = 0; return_code && (n < number_of_nodes); ++n)
+	{
+		const Value_slots& slots = value_slots[node_value_slots[n]];
+		const size_t start = static_cast<size_t>(n)*number_of_values_per_node;
+		for (int s = 0; s < number_of_values_per_node; ++s)
+		{
+			const FE_value value = static_cast<FE_value>(
+				(1.0 - xi)*column_one[start + s] + xi*column_two[start + s]);
+			if (!set_FE_nodal_FE_value_value(nodes[n], field, slots[s].component_number,
+				slots[s].version, slots[s].type, static_cast<FE_value>(time), value))
+			{
+				return_code = 0;
+				break;
+			}
+		}
+	}
+	FE_region_end_change(fe_region);
+	if (return_code)
+	{
+		last_time_index_one = time_index_one;
+		last_time_index_two = time_index_two;
+		last_xi = xi;
+	}
+	else
+	{
+		display_message(ERROR_MESSAGE, "FE_nodal_time_series::set_time.  "
+			"Could not set field values at nodes");
+	}
+	return return_code;
+}
+
+int FE_nodal_time_series::time_callback(struct Time_object * /*time_object*/,
+	double current_time, void *time_series_void)
+{
+	FE_nodal_time_series *time_series = static_cast<FE_nodal_time_series *>(time_series_void);
+	if (time_series)
+	{
+		return time_series->set_time(current_time);
+	}
+	return 0;
+}
+
+int FE_nodal_time_series::write(struct FE_region *fe_region,
+	struct FE_field *field, const char *file_name)
+{
+	if (!(fe_region && field && file_name))
+	{
+		display_message(ERROR_MESSAGE, "FE_nodal_time_series::write.  Invalid argument(s)");
+		return 0;
+	}
+	std::vector<struct FE_node *> nodes;
+	FE_node_field_defined_data data = { field, &nodes };
+	FE_region_for_each_FE_node(fe_region, FE_node_add_to_vector_if_field_defined, &data);
+	struct FE_time_sequence *time_sequence = (nodes.size()) ?
+		get_FE_node_field_FE_time_sequence(nodes[0], field) : 0;
+	if (!time_sequence)
+	{
+		display_message(ERROR_MESSAGE, "FE_nodal_time_series::write.  "
+			"Field is not defined with time at any node");
+		return 0;
+	}
+	const int number_of_times = FE_time_sequence_get_number_of_times(time_sequence);
+	const int number_of_nodes = static_cast<int>(nodes.size());
+	std::vector<double> times(number_of_times);
+	for (int t = 0; t < number_of_times; ++t)
+	{
+		FE_value time = 0.0;
+		FE_time_sequence_get_time_for_index(time_sequence, t, &time);
+		times[t] = static_cast<double>(time);
+	}
+	/* all nodes must have the same times and number of values */
+	std::vector<Value_slots> value_slots(number_of_nodes);
+	std::vector<int> node_identifiers(number_of_nodes);
+	int return_code = 1;
+	for (int n = 0; return_code && (n < number_of_nodes); ++n)
+	{
+		node_identifiers[n] = get_FE_node_identifier(nodes[n]);
+		if (!((get_FE_node_field_FE_time_sequence(nodes[n], field) == time_sequence) &&
+			get_node_value_slots(nodes[n], field, value_slots[n]) &&
+			(value_slots[n].size() == value_slots[0].size())))
+		{
+			display_message(ERROR_MESSAGE, "FE_nodal_time_series::write.  "
+				"Node %d does not have the same times and number of values as node %d",
+				node_identifiers[n], node_identifiers[0]);
+			return_code = 0;
+		}
+	}
+	if (!return_code)
+	{
+		return 0;
+	}
+	const int number_of_values_per_node = static_cast<int>(value_slots[0].size());
+	FILE *file = fopen(file_name, "wb");
+	if (!file)
+	{
+		display_message(ERROR_MESSAGE, "FE_nodal_time_series::write.  "
+			"Could not open %s for writing", file_name);
+		return 0;
+	}
+	int header[4] = { number_of_times, number_of_nodes, number_of_values_per_node, 0 };
+	const size_t nodes_end = time_series_header_size + number_of_times*sizeof(double) +
+		number_of_nodes*sizeof(int);
+	const char padding[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+	const size_t padding_size = align_to_double(nodes_end) - nodes_end;
+	return_code = (1 == fwrite(time_series_magic, sizeof(time_series_magic), 1, file)) &&
+		(1 == fwrite(header, sizeof(header), 1, file)) &&
+		(static_cast<size_t>(number_of_times) == fwrite(&(times[0]), sizeof(double), number_of_times, file)) &&
+		(static_cast<size_t>(number_of_nodes) == fwrite(&(node_identifiers[0]), sizeof(int), number_of_nodes, file)) &&
+		(padding_size == fwrite(padding, 1, padding_size, file));
+	std::vector<double> column(static_cast<size_t>(number_of_nodes)*number_of_values_per_node);
+	for (int t = 0; return_code && (t < number_of_times); ++t)
+	{
+		size_t k = 0;
+		for (int n = 0; return_code && (n < number_of_nodes); ++n)
+		{
+			const Value_slots& slots = value_slots[n];
+			for (int s = 0; s < number_of_values_per_node; ++s)
+			{
+				FE_value value = 0.0;
+				if (!get_FE_nodal_FE_value_value(nodes[n], field, slots[s].component_number,
+					slots[s].version, slots[s].type, static_cast<FE_value>(times[t]), &value))
+				{
+					return_code = 0;
+					break;
+				}
+				column[k++] = static_cast<double>(value);
+			}
+		}
+		if (return_code && (column.size() != fwrite(&(column[0]), sizeof(double), column.size(), file)))
+		{
+			return_code = 0;
+		}
+	}
+	if (0 != fclose(file))
+	{
+		return_code = 0;
+	}
+	if (!return_code)
+	{
+		display_message(ERROR_MESSAGE, "FE_nodal_time_series::write.  "
+			"Failed to write %s", file_name);
+	}
+	return return_code;
+}
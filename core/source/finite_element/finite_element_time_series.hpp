@@ -0,0 +1,170 @@
+/*******************************************************************************
+FILE : finite_element_time_series.hpp
+
+DESCRIPTION :
+Out-of-core time series of the values of a finite element field at nodes, held
+in a memory mapped columnar file and paged in around the current time.
+==============================================================================*/
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is cmgui.
+ *
+ * The Initial Developer of the Original Code is
+ * Auckland Uniservices Ltd, Auckland, New Zealand.
+ * Portions created by the Initial Developer are Copyright (C) 2012
+ * the Initial Developer. All Rights Reserved.
+ *
+ * Contributor(s):
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+#if !defined (FINITE_ELEMENT_TIME_SERIES_HPP)
+#define FINITE_ELEMENT_TIME_SERIES_HPP
+
+#include <cstdio>
+#include <map>
+#include <vector>
+#include "zinc/zincconfigure.h"
+#include "finite_element/finite_element.h"
+#include "time/time_keeper.h"
+
+struct FE_region;
+
+/**
+ * Values of an FE_field at the nodes of an FE_region for many times, read
+ * from a columnar file holding all node values for each time together. The
+ * file is memory mapped on UNIX, otherwise read with stdio, and only a window
+ * of time steps around the current time of a Time_keeper is kept in memory,
+ * so the series may be much larger than memory. Whenever the time changes
+ * the field values at the nodes are set by interpolating the two nearest
+ * times, so the field should be defined at the nodes without time.
+ * All values for a time are set within one FE_region change, so clients are
+ * notified once per time. Each notification is an ordinary field change, so
+ * it also discards graphics cached for other times: the field is not time
+ * dependent as far as evaluation and graphics time caches are concerned.
+ * Values are not paged in for the time of a field cache, so evaluation at any
+ * other time gives values for the time keeper's time, and one series (one
+ * time keeper) per field is supported.
+ *
+ * File layout, in native byte order:
+ *   char magic[8] = "ZNTSER01";
+ *   int number_of_times, number_of_nodes, number_of_values_per_node, 0;
+ *   double times[number_of_times], in increasing order;
+ *   int node_identifiers[number_of_nodes], padded to a multiple of 8 bytes;
+ *   double values[number_of_times][number_of_nodes][number_of_values_per_node].
+ * Values at each node are ordered by component, version and then nodal value
+ * type as returned by get_FE_node_field_component_nodal_value_types.
+ */
+class FE_nodal_time_series
+{
+	struct Value_slot
+	{
+		int component_number;
+		int version;
+		enum FE_nodal_value_type type;
+
+		bool operator==(const Value_slot& other) const
+		{
+			return (component_number == other.component_number) &&
+				(version == other.version) && (type == other.type);
+		}
+	};
+	typedef std::vector<Value_slot> Value_slots;
+
+	/* not accessed: the time series is owned by the FE_region */
+	struct FE_region *fe_region;
+	struct FE_field *field;
+	struct Time_object *time_object;
+	int number_of_values_per_node;
+	std::vector<double> times;
+	/* accessed nodes in file order, and index of the value slots of each */
+	std::vector<struct FE_node *> nodes;
+	std::vector<int> node_value_slots;
+	std::vector<Value_slots> value_slots;
+	size_t data_offset;
+	/* first of window_size time steps kept in memory */
+	int window_size;
+	int window_first;
+	int last_time_index_one, last_time_index_two;
+	double last_xi;
+#if defined (UNIX)
+	int file_descriptor;
+	const unsigned char *mapping;
+	size_t mapping_size;
+#else /* defined (UNIX) */
+	FILE *file;
+	std::map<int, std::vector<double> > resident_columns;
+#endif /* defined (UNIX) */
+
+	FE_nodal_time_series(struct FE_region *fe_region_in, struct FE_field *field_in,
+		int window_size_in);
+
+public:
+	/**
+	 * Opens the time series file and finds its nodes and their values in
+	 * fe_region, then sets the field values for the current time of
+	 * time_keeper and for every later change of time.
+	 * @param window_size  Number of time steps to keep in memory; at least 2.
+	 * @return  New time series, or NULL on failure.
+	 */
+	static FE_nodal_time_series *create(struct FE_region *fe_region,
+		struct FE_field *field, struct Time_keeper *time_keeper,
+		const char *file_name, int window_size);
+
+	~FE_nodal_time_series();
+
+	/**
+	 * Writes the values of time varying field at all nodes of fe_region where
+	 * it is defined to a time series file. Nodes must have the same times and
+	 * the same number of values.
+	 * @return  1 on success, 0 on failure.
+	 */
+	static int write(struct FE_region *fe_region, struct FE_field *field,
+		const char *file_name);
+
+	/** Sets the field values at the nodes interpolated for time.
+	 * @return  1 on success, 0 on failure. */
+	int set_time(double time);
+
+private:
+	/** Maps or opens the file and reads its times and node identifiers. */
+	int open(const char *file_name, std::vector<int>& node_identifiers);
+
+	void close();
+
+	int read_bytes(size_t offset, size_t size, void *destination);
+
+	const double *get_column(int time_index);
+
+	void set_window(int first);
+
+	static int time_callback(struct Time_object *time_object,
+		double current_time, void *time_series_void);
+
+	static int get_node_value_slots(struct FE_node *node, struct FE_field *field,
+		Value_slots& slots);
+};
+
+#endif /* !defined (FINITE_ELEMENT_TIME_SERIES_HPP) */
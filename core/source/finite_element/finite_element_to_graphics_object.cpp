@@ -42,6 +42,8 @@ The functions for creating graphical objects from finite elements.
 #include <limits.h>
 #include <cmath>
 #include <cstdlib>
+#include <map>
+#include <vector>
 #include "zinc/differentialoperator.h"
 #include "zinc/element.h"
 #include "computed_field/computed_field.h"
@@ -2379,6 +2381,532 @@ struct GT_surface *create_GT_surface_from_FE_element(
 	return (surface);
 } /* create_GT_surface_from_FE_element */
 
+namespace {
+
+/**
+ * Identifies a surface graphics vertex on the boundary of a 2-D element by the
+ * line (face) element it lies on and its point index along the line in the
+ * line's own xi direction. The number of points along the line is included so
+ * that only points from matching discretizations are shared.
+ */
+struct FE_surface_mesh_edge_point
+{
+	struct FE_element *line;
+	int point_index;
+	int number_of_points;
+
+	bool operator<(const FE_surface_mesh_edge_point& other) const
+	{
+		if (line != other.line)
+			return line < other.line;
+		if (number_of_points != other.number_of_points)
+			return number_of_points < other.number_of_points;
+		return point_index < other.point_index;
+	}
+};
+
+}
+
+/**
+ * Accumulates surface graphics for many 2-D elements into a single indexed
+ * triangle mesh. Points on element boundaries are keyed by the line faces of
+ * the elements so they are evaluated only once and shared by all elements
+ * using them. Vertices on corners where several lines meet may be found to be
+ * the same after they have been created; these are merged when the mesh is
+ * output.
+ */
+struct FE_surface_mesh_builder
+{
+	Cmiss_differential_operator_id d_dxi1, d_dxi2;
+	struct Computed_field *coordinate_field, *texture_coordinate_field, *data_field;
+	int coordinate_dimension, texture_coordinate_dimension, number_of_data_components;
+	char reverse_normals;
+	std::vector<GLfloat> positions, normals, texture_coordinates, data;
+	/* union-find parent of each vertex, for merging vertices found to be shared */
+	std::vector<int> vertex_parents;
+	std::map<FE_surface_mesh_edge_point, int> edge_point_vertices;
+	std::vector<unsigned int> triangle_indices;
+	/* identifier, first triangle index and number of triangle indices per element */
+	std::vector<int> element_identifiers;
+	std::vector<unsigned int> element_index_starts, element_index_counts;
+
+	FE_surface_mesh_builder(Cmiss_mesh_id surface_mesh,
+			struct Computed_field *coordinate_field_in,
+			struct Computed_field *texture_coordinate_field_in,
+			struct Computed_field *data_field_in, char reverse_normals_in) :
+		d_dxi1(Cmiss_mesh_get_chart_differential_operator(surface_mesh, /*order*/1, 1)),
+		d_dxi2(Cmiss_mesh_get_chart_differential_operator(surface_mesh, /*order*/1, 2)),
+		coordinate_field(coordinate_field_in),
+		texture_coordinate_field(texture_coordinate_field_in),
+		data_field(data_field_in),
+		coordinate_dimension(Computed_field_get_number_of_components(coordinate_field_in)),
+		texture_coordinate_dimension(texture_coordinate_field_in ?
+			Computed_field_get_number_of_components(texture_coordinate_field_in) : 0),
+		number_of_data_components(data_field_in ?
+			Computed_field_get_number_of_components(data_field_in) : 0),
+		reverse_normals(reverse_normals_in)
+	{
+	}
+
+	~FE_surface_mesh_builder()
+	{
+		Cmiss_differential_operator_destroy(&d_dxi1);
+		Cmiss_differential_operator_destroy(&d_dxi2);
+	}
+
+	int find_vertex(int vertex)
+	{
+		while (vertex_parents[vertex] != vertex)
+		{
+			vertex_parents[vertex] = vertex_parents[vertex_parents[vertex]];
+			vertex = vertex_parents[vertex];
+		}
+		return vertex;
+	}
+
+	int merge_vertices(int vertex1, int vertex2)
+	{
+		vertex1 = find_vertex(vertex1);
+		vertex2 = find_vertex(vertex2);
+		if (vertex2 < vertex1)
+		{
+			vertex_parents[vertex1] = vertex2;
+			return vertex2;
+		}
+		vertex_parents[vertex2] = vertex1;
+		return vertex1;
+	}
+
+	int evaluate_vertex(Cmiss_field_cache_id field_cache, struct FE_element *element,
+		FE_value *xi, struct FE_element *top_level_element, char modified_reverse_normals);
+
+	int add_element(struct FE_element *element, Cmiss_field_cache_id field_cache,
+		int number_of_segments_in_xi1_requested, int number_of_segments_in_xi2_requested,
+		struct FE_element *top_level_element, FE_value time);
+
+	int add_to_vertex_array(struct Graphics_vertex_array *array);
+};
+
+/**
+ * Evaluates the fields at xi in element and adds them as a new vertex.
+ * @return  Index of new vertex, or -1 if failed.
+ */
+int FE_surface_mesh_builder::evaluate_vertex(Cmiss_field_cache_id field_cache,
+	struct FE_element *element, FE_value *xi, struct FE_element *top_level_element,
+	char modified_reverse_normals)
+{
+	FE_value coordinates[3], derivative_xi1[3], derivative_xi2[3], texture_values[3];
+	for (int i = 0; i < 3; i++)
+	{
+		coordinates[i] = 0.0;
+		derivative_xi1[i] = 0.0;
+		derivative_xi2[i] = 0.0;
+		texture_values[i] = 0.0;
+	}
+	FE_value *data_values = (number_of_data_components > 0) ?
+		new FE_value[number_of_data_components] : 0;
+	int return_code = Cmiss_field_cache_set_mesh_location_with_parent(
+		field_cache, element, /*dimension*/2, xi, top_level_element) &&
+		Cmiss_field_evaluate_derivative(coordinate_field,
+			d_dxi1, field_cache, coordinate_dimension, derivative_xi1) &&
+		Cmiss_field_evaluate_derivative(coordinate_field,
+			d_dxi2, field_cache, coordinate_dimension, derivative_xi2) &&
+		Cmiss_field_evaluate_real(coordinate_field, field_cache,
+			coordinate_dimension, coordinates) &&
+		((!data_field) || Cmiss_field_evaluate_real(data_field, field_cache,
+			number_of_data_components, data_values)) &&
+		((!texture_coordinate_field) || Cmiss_field_evaluate_real(texture_coordinate_field,
+			field_cache, texture_coordinate_dimension, texture_values));
+	int vertex = -1;
+	if (return_code)
+	{
+		vertex = static_cast<int>(vertex_parents.size());
+		vertex_parents.push_back(vertex);
+		for (int i = 0; i < 3; i++)
+		{
+			positions.push_back(static_cast<GLfloat>(coordinates[i]));
+		}
+		/* normal = d/d_xi1 x d/d_xi2; normalized when output */
+		const FE_value sign = modified_reverse_normals ? -1.0 : 1.0;
+		normals.push_back(static_cast<GLfloat>(sign*(derivative_xi1[1]*derivative_xi2[2] - derivative_xi2[1]*derivative_xi1[2])));
+		normals.push_back(static_cast<GLfloat>(sign*(derivative_xi1[2]*derivative_xi2[0] - derivative_xi2[2]*derivative_xi1[0])));
+		normals.push_back(static_cast<GLfloat>(sign*(derivative_xi1[0]*derivative_xi2[1] - derivative_xi2[0]*derivative_xi1[1])));
+		for (int i = 0; i < number_of_data_components; i++)
+		{
+			data.push_back(static_cast<GLfloat>(data_values[i]));
+		}
+		if (texture_coordinate_field)
+		{
+			for (int i = 0; i < 3; i++)
+			{
+				texture_coordinates.push_back(static_cast<GLfloat>(texture_values[i]));
+			}
+		}
+	}
+	delete[] data_values;
+	return vertex;
+}
+
+int FE_surface_mesh_builder::add_element(struct FE_element *element,
+	Cmiss_field_cache_id field_cache,
+	int number_of_segments_in_xi1_requested, int number_of_segments_in_xi2_requested,
+	struct FE_element *top_level_element, FE_value time)
+{
+	enum Collapsed_element_type collapsed_element;
+	enum FE_element_shape_type shape_type;
+	gtPolygonType polygon_type;
+	int number_of_points, number_of_points_in_xi1, number_of_points_in_xi2,
+		number_of_polygon_vertices;
+	if (!get_surface_element_segmentation(element,
+		number_of_segments_in_xi1_requested, number_of_segments_in_xi2_requested,
+		&number_of_points_in_xi1, &number_of_points_in_xi2,
+		&number_of_points, &number_of_polygon_vertices, &polygon_type,
+		&collapsed_element, &shape_type))
+	{
+		return 0;
+	}
+	const bool simplex = (SIMPLEX_SHAPE == shape_type);
+	const int reverse_winding = FE_element_is_exterior_face_with_inward_normal(element);
+	const char modified_reverse_normals = reverse_winding ? !reverse_normals : reverse_normals;
+	/* grid points are stored in rows of increasing xi2, each row of increasing
+	 * xi1; for simplex row j has number_of_points_in_xi1 - j points */
+	std::vector<FE_value> xi_points(2*number_of_points);
+	std::vector<int> row_starts(number_of_points_in_xi2 + 1);
+	const FE_value xi_distance1 = (FE_value)(number_of_points_in_xi1 - 1);
+	const FE_value xi_distance2 = (FE_value)(number_of_points_in_xi2 - 1);
+	int point = 0;
+	for (int j = 0; j < number_of_points_in_xi2; j++)
+	{
+		row_starts[j] = point;
+		const int row_length = simplex ? (number_of_points_in_xi1 - j) : number_of_points_in_xi1;
+		for (int i = 0; i < row_length; i++)
+		{
+			xi_points[point*2] = (FE_value)i/xi_distance1;
+			xi_points[point*2 + 1] = (FE_value)j/xi_distance2;
+			point++;
+		}
+	}
+	row_starts[number_of_points_in_xi2] = point;
+	/* find points on the line faces of the element */
+	std::vector< std::vector<FE_surface_mesh_edge_point> > point_keys(number_of_points);
+	int number_of_faces = 0;
+	get_FE_element_number_of_faces(element, &number_of_faces);
+	const FE_value tolerance = 1.0E-6;
+	std::vector<int> face_points;
+	std::vector<FE_value> face_xi;
+	for (int f = 0; f < number_of_faces; f++)
+	{
+		struct FE_element *line = 0;
+		FE_value face_to_element[4];
+		if (!(FE_element_get_face_to_element(element, f, &line, face_to_element) && line &&
+			(1 == get_FE_element_dimension(line))))
+		{
+			continue;
+		}
+		/* xi1 = b1 + a1*s, xi2 = b2 + a2*s */
+		const FE_value b1 = face_to_element[0], a1 = face_to_element[1];
+		const FE_value b2 = face_to_element[2], a2 = face_to_element[3];
+		const bool use_xi1 = fabs(a1) >= fabs(a2);
+		face_points.clear();
+		face_xi.clear();
+		for (point = 0; point < number_of_points; point++)
+		{
+			const FE_value *xi = &(xi_points[point*2]);
+			const FE_value s = use_xi1 ? ((xi[0] - b1)/a1) : ((xi[1] - b2)/a2);
+			if ((s > -tolerance) && (s < 1.0 + tolerance) &&
+				(fabs(b1 + a1*s - xi[0]) < tolerance) && (fabs(b2 + a2*s - xi[1]) < tolerance))
+			{
+				face_points.push_back(point);
+				face_xi.push_back(s);
+			}
+		}
+		const int number_of_face_points = static_cast<int>(face_points.size());
+		if (1 < number_of_face_points)
+		{
+			FE_surface_mesh_edge_point key;
+			key.line = line;
+			key.number_of_points = number_of_face_points;
+			for (int p = 0; p < number_of_face_points; p++)
+			{
+				key.point_index = static_cast<int>(floor(face_xi[p]*(number_of_face_points - 1) + 0.5));
+				point_keys[face_points[p]].push_back(key);
+			}
+		}
+	}
+	/* get or evaluate vertices */
+	Cmiss_field_cache_set_time(field_cache, time);
+	std::vector<int> point_vertices(number_of_points);
+	for (point = 0; point < number_of_points; point++)
+	{
+		std::vector<FE_surface_mesh_edge_point>& keys = point_keys[point];
+		const size_t number_of_keys = keys.size();
+		int vertex = -1;
+		for (size_t k = 0; k < number_of_keys; k++)
+		{
+			std::map<FE_surface_mesh_edge_point, int>::iterator iter = edge_point_vertices.find(keys[k]);
+			if (iter != edge_point_vertices.end())
+			{
+				vertex = (vertex < 0) ? find_vertex(iter->second) : merge_vertices(vertex, iter->second);
+			}
+		}
+		if (vertex < 0)
+		{
+			vertex = evaluate_vertex(field_cache, element, &(xi_points[point*2]),
+				top_level_element, modified_reverse_normals);
+			if (vertex < 0)
+			{
+				return 0;
+			}
+		}
+		for (size_t k = 0; k < number_of_keys; k++)
+		{
+			edge_point_vertices[keys[k]] = vertex;
+		}
+		point_vertices[point] = vertex;
+	}
+	/* add triangles, reversing winding if needed to match normals */
+	struct CM_element_information cm;
+	get_FE_element_identifier(element, &cm);
+	element_identifiers.push_back(cm.number);
+	element_index_starts.push_back(static_cast<unsigned int>(triangle_indices.size()));
+	const int second = reverse_winding ? 2 : 1;
+	const int third = reverse_winding ? 1 : 2;
+	unsigned int triangle[3];
+	for (int j = 0; j < number_of_points_in_xi2 - 1; j++)
+	{
+		const int row_length = row_starts[j + 1] - row_starts[j];
+		for (int i = 0; i < row_length - 1; i++)
+		{
+			const int p00 = row_starts[j] + i;
+			const int p10 = p00 + 1;
+			const int p01 = row_starts[j + 1] + i;
+			triangle[0] = point_vertices[p00];
+			triangle[second] = point_vertices[p10];
+			triangle[third] = point_vertices[p01];
+			triangle_indices.insert(triangle_indices.end(), triangle, triangle + 3);
+			if ((!simplex) || (i < row_length - 2))
+			{
+				const int p11 = p01 + 1;
+				triangle[0] = point_vertices[p10];
+				triangle[second] = point_vertices[p11];
+				triangle[third] = point_vertices[p01];
+				triangle_indices.insert(triangle_indices.end(), triangle, triangle + 3);
+			}
+		}
+	}
+	element_index_counts.push_back(static_cast<unsigned int>(triangle_indices.size()) -
+		element_index_starts.back());
+	return 1;
+}
+
+int FE_surface_mesh_builder::add_to_vertex_array(struct Graphics_vertex_array *array)
+{
+	const int number_of_vertices = static_cast<int>(vertex_parents.size());
+	/* compact merged vertices, keeping them in order of creation */
+	std::vector<unsigned int> new_vertex(number_of_vertices);
+	std::vector<int> old_vertex;
+	old_vertex.reserve(number_of_vertices);
+	for (int v = 0; v < number_of_vertices; v++)
+	{
+		const int root = find_vertex(v);
+		if (root == v)
+		{
+			new_vertex[v] = static_cast<unsigned int>(old_vertex.size());
+			old_vertex.push_back(v);
+		}
+		else
+		{
+			new_vertex[v] = new_vertex[root];
+		}
+	}
+	const int number_of_new_vertices = static_cast<int>(old_vertex.size());
+	/* remap triangles, removing those made degenerate by collapsed edges */
+	std::vector<unsigned int> indices;
+	indices.reserve(triangle_indices.size());
+	const size_t number_of_elements = element_identifiers.size();
+	for (size_t e = 0; e < number_of_elements; e++)
+	{
+		const unsigned int number_of_triangles = element_index_counts[e]/3;
+		const unsigned int *triangle = (0 < number_of_triangles) ?
+			&(triangle_indices[element_index_starts[e]]) : 0;
+		element_index_starts[e] = static_cast<unsigned int>(indices.size());
+		for (unsigned int t = number_of_triangles; t > 0; t--)
+		{
+			const unsigned int v0 = new_vertex[triangle[0]];
+			const unsigned int v1 = new_vertex[triangle[1]];
+			const unsigned int v2 = new_vertex[triangle[2]];
+			if ((v0 != v1) && (v1 != v2) && (v2 != v0))
+			{
+				indices.push_back(v0);
+				indices.push_back(v1);
+				indices.push_back(v2);
+			}
+			triangle += 3;
+		}
+		element_index_counts[e] = static_cast<unsigned int>(indices.size()) - element_index_starts[e];
+	}
+	/* gather vertex values and normalize normals. Normals which vanish, e.g. on
+	 * collapsed element edges, are replaced by the sum of adjacent triangle normals */
+	std::vector<GLfloat> new_positions(3*number_of_new_vertices), new_normals(3*number_of_new_vertices);
+	std::vector<GLfloat> new_texture_coordinates(texture_coordinate_field ? 3*number_of_new_vertices : 0);
+	std::vector<GLfloat> new_data(number_of_data_components*number_of_new_vertices);
+	std::vector<bool> normal_vanishes(number_of_new_vertices, false);
+	bool any_normal_vanishes = false;
+	for (int n = 0; n < number_of_new_vertices; n++)
+	{
+		const int v = old_vertex[n];
+		for (int i = 0; i < 3; i++)
+		{
+			new_positions[3*n + i] = positions[3*v + i];
+			new_normals[3*n + i] = normals[3*v + i];
+			if (texture_coordinate_field)
+			{
+				new_texture_coordinates[3*n + i] = texture_coordinates[3*v + i];
+			}
+		}
+		for (int i = 0; i < number_of_data_components; i++)
+		{
+			new_data[number_of_data_components*n + i] = data[number_of_data_components*v + i];
+		}
+		const GLfloat *normal = &(new_normals[3*n]);
+		if (!(0.0 < normal[0]*normal[0] + normal[1]*normal[1] + normal[2]*normal[2]))
+		{
+			normal_vanishes[n] = true;
+			any_normal_vanishes = true;
+		}
+	}
+	if (any_normal_vanishes)
+	{
+		const size_t number_of_indices = indices.size();
+		for (size_t t = 0; t < number_of_indices; t += 3)
+		{
+			const GLfloat *x0 = &(new_positions[3*indices[t]]);
+			const GLfloat *x1 = &(new_positions[3*indices[t + 1]]);
+			const GLfloat *x2 = &(new_positions[3*indices[t + 2]]);
+			GLfloat d1[3], d2[3], cross[3];
+			for (int i = 0; i < 3; i++)
+			{
+				d1[i] = x1[i] - x0[i];
+				d2[i] = x2[i] - x0[i];
+			}
+			cross[0] = d1[1]*d2[2] - d2[1]*d1[2];
+			cross[1] = d1[2]*d2[0] - d2[2]*d1[0];
+			cross[2] = d1[0]*d2[1] - d2[0]*d1[1];
+			for (int k = 0; k < 3; k++)
+			{
+				if (normal_vanishes[indices[t + k]])
+				{
+					GLfloat *normal = &(new_normals[3*indices[t + k]]);
+					normal[0] += cross[0];
+					normal[1] += cross[1];
+					normal[2] += cross[2];
+				}
+			}
+		}
+	}
+	for (int n = 0; n < number_of_new_vertices; n++)
+	{
+		GLfloat *normal = &(new_normals[3*n]);
+		const GLfloat distance = sqrt(normal[0]*normal[0] + normal[1]*normal[1] + normal[2]*normal[2]);
+		if (0.0 < distance)
+		{
+			normal[0] /= distance;
+			normal[1] /= distance;
+			normal[2] /= distance;
+		}
+	}
+	int return_code = 1;
+	if (0 < number_of_new_vertices)
+	{
+		return_code = array->add_float_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_POSITION,
+				3, number_of_new_vertices, &(new_positions[0])) &&
+			array->add_float_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_NORMAL,
+				3, number_of_new_vertices, &(new_normals[0])) &&
+			((!data_field) || array->add_float_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_DATA,
+				number_of_data_components, number_of_new_vertices, &(new_data[0]))) &&
+			((!texture_coordinate_field) || array->add_float_attribute(
+				GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_TEXTURE_COORDINATE_ZERO,
+				3, number_of_new_vertices, &(new_texture_coordinates[0])));
+	}
+	if (return_code && (0 < indices.size()))
+	{
+		return_code = array->add_unsigned_integer_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_INDEX,
+			1, static_cast<unsigned int>(indices.size()), &(indices[0]));
+	}
+	for (size_t e = 0; return_code && (e < number_of_elements); e++)
+	{
+		if (0 < element_index_counts[e])
+		{
+			return_code = array->add_integer_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_ID,
+					1, 1, &(element_identifiers[e])) &&
+				array->add_unsigned_integer_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_ELEMENT_INDEX_START,
+					1, 1, &(element_index_starts[e])) &&
+				array->add_unsigned_integer_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_ELEMENT_INDEX_COUNT,
+					1, 1, &(element_index_counts[e]));
+		}
+	}
+	return return_code;
+}
+
+struct FE_surface_mesh_builder *FE_surface_mesh_builder_create(
+	Cmiss_mesh_id surface_mesh, struct Computed_field *coordinate_field,
+	struct Computed_field *texture_coordinate_field,
+	struct Computed_field *data_field, char reverse_normals)
+{
+	const int coordinate_dimension = coordinate_field ?
+		Computed_field_get_number_of_components(coordinate_field) : 0;
+	if (surface_mesh && (0 < coordinate_dimension) && (3 >= coordinate_dimension) &&
+		((!texture_coordinate_field) ||
+			(3 >= Computed_field_get_number_of_components(texture_coordinate_field))))
+	{
+		return new FE_surface_mesh_builder(surface_mesh, coordinate_field,
+			texture_coordinate_field, data_field, reverse_normals);
+	}
+	display_message(ERROR_MESSAGE,
+		"FE_surface_mesh_builder_create.  Invalid argument(s)");
+	return 0;
+}
+
+int FE_surface_mesh_builder_destroy(struct FE_surface_mesh_builder **builder_address)
+{
+	if (builder_address && *builder_address)
+	{
+		delete *builder_address;
+		*builder_address = 0;
+		return 1;
+	}
+	return 0;
+}
+
+int FE_element_add_surface_to_mesh_builder(struct FE_element *element,
+	Cmiss_field_cache_id field_cache, struct FE_surface_mesh_builder *builder,
+	int number_of_segments_in_xi1_requested, int number_of_segments_in_xi2_requested,
+	struct FE_element *top_level_element, FE_value time)
+{
+	if (element && field_cache && builder && (2 == get_FE_element_dimension(element)) &&
+		(0 < number_of_segments_in_xi1_requested) && (0 < number_of_segments_in_xi2_requested))
+	{
+		return builder->add_element(element, field_cache,
+			number_of_segments_in_xi1_requested, number_of_segments_in_xi2_requested,
+			top_level_element, time);
+	}
+	display_message(ERROR_MESSAGE,
+		"FE_element_add_surface_to_mesh_builder.  Invalid argument(s)");
+	return 0;
+}
+
+int FE_surface_mesh_builder_add_to_vertex_array(
+	struct FE_surface_mesh_builder *builder, struct Graphics_vertex_array *array)
+{
+	if (builder && array)
+	{
+		return builder->add_to_vertex_array(array);
+	}
+	display_message(ERROR_MESSAGE,
+		"FE_surface_mesh_builder_add_to_vertex_array.  Invalid argument(s)");
+	return 0;
+}
+
 int Set_element_and_local_xi(struct FE_element **element_block,
 	int *n_xi, FE_value *xi, struct FE_element **element)
 /*******************************************************************************
@@ -55,6 +55,9 @@ The function prototypes for creating graphical objects from finite elements.
 Global types
 ------------
 */
+
+struct FE_surface_mesh_builder;
+
 enum Use_element_type
 /*******************************************************************************
 LAST MODIFIED : 20 March 2001
@@ -329,4 +332,48 @@ struct GT_surface *create_GT_surface_from_FE_element(
 	struct FE_element *top_level_element,
 	enum Cmiss_graphics_render_type render_type, FE_value time);
 
+/***************************************************************************//**
+ * Creates a builder for accumulating the surfaces of many 2-D elements into a
+ * single indexed triangle mesh in which vertices on element boundaries are
+ * shared. Boundary points are identified by the line faces of the elements,
+ * so they are only shared if faces are defined, and are evaluated once on the
+ * first element using them. Fields should therefore be continuous across
+ * element boundaries.
+ * @param surface_mesh  2-D surface mesh being converted to surface graphics.
+ * @param coordinate_field  Rectangular cartesian coordinate field with up to 3
+ * components.
+ * @param texture_coordinate_field  Optional texture coordinate field with up
+ * to 3 components.
+ * @param data_field  Optional data field for colouring by a spectrum.
+ * @param reverse_normals  Set to reverse normals from their usual direction.
+ * @return  New builder, or NULL if invalid arguments.
+ */
+struct FE_surface_mesh_builder *FE_surface_mesh_builder_create(
+	Cmiss_mesh_id surface_mesh, struct Computed_field *coordinate_field,
+	struct Computed_field *texture_coordinate_field,
+	struct Computed_field *data_field, char reverse_normals);
+
+int FE_surface_mesh_builder_destroy(struct FE_surface_mesh_builder **builder_address);
+
+/***************************************************************************//**
+ * Adds the surface of the 2-D <element> to the <builder>, segmented as for
+ * create_GT_surface_from_FE_element and triangulated. Vertices shared with
+ * elements already added are not re-evaluated.
+ * @param top_level_element  Optional clue to computed fields to say which
+ * parent element they should be evaluated on as necessary.
+ */
+int FE_element_add_surface_to_mesh_builder(struct FE_element *element,
+	Cmiss_field_cache_id field_cache, struct FE_surface_mesh_builder *builder,
+	int number_of_segments_in_xi1_requested, int number_of_segments_in_xi2_requested,
+	struct FE_element *top_level_element, FE_value time);
+
+/***************************************************************************//**
+ * Adds the vertices and triangles accumulated in the builder to the vertex
+ * array: position, normal, optional data and texture coordinates per vertex,
+ * triangle vertex indices, and per element an identifier with the range of
+ * its triangle indices.
+ */
+int FE_surface_mesh_builder_add_to_vertex_array(
+	struct FE_surface_mesh_builder *builder, struct Graphics_vertex_array *array);
+
 #endif /* !defined (FINITE_ELEMENT_TO_GRAPHICAL_OBJECT_H) */
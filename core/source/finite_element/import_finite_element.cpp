@@ -43,12 +43,18 @@ interface to CMISS.
  *
  * ***** END LICENSE BLOCK ***** */
 #include <cmath>
+#include <vector>
+#include "zinc/zincconfigure.h"
+#if defined (USE_OPENMP)
+#include <omp.h>
+#endif /* defined (USE_OPENMP) */
 #include "zinc/fieldgroup.h"
 #include "zinc/fieldmodule.h"
 #include "zinc/fieldsubobjectgroup.h"
 #include "finite_element/finite_element.h"
 #include "finite_element/finite_element_region.h"
 #include "finite_element/finite_element_time.h"
+#include "finite_element/export_finite_element.h"
 #include "finite_element/import_finite_element.h"
 #include "general/debug.h"
 #include "general/math.h"
@@ -63,11 +69,150 @@ Module types
 ------------
 */
 
+/***************************************************************************//**
+ * Layout of binary value blocks, read from the "Binary values:" line at the
+ * start of files written with FE_WRITE_FORMAT_BINARY.
+ */
+struct EX_binary_values_format
+{
+	/* set if values must be converted from the other byte order */
+	int swap_bytes;
+};
+
 /*
 Module functions
 ----------------
 */
 
+/***************************************************************************//**
+ * Reads a block of <number_of_values> binary values each of <value_size>
+ * bytes, as written by write_binary_values, into <values>. Skips white space
+ * to the '<' marker introducing the block, then reads the values directly.
+ *
+ * @return  1 on success, 0 if the marker or any values are missing.
+ */
+static int read_binary_values(struct IO_stream *input_file,
+	const struct EX_binary_values_format *binary_format, void *values,
+	size_t value_size, int number_of_values)
+{
+	char test_string[5];
+	int return_code = 0;
+	if (input_file && binary_format && values && (0 < number_of_values))
+	{
+		/* Use a %1[<] so that a successful read will return 1 */
+		if ((1 == IO_stream_scan(input_file, " %1[<]", test_string)) &&
+			(number_of_values == IO_stream_fread(input_file, values, value_size,
+				(size_t)number_of_values)))
+		{
+			if (binary_format->swap_bytes)
+			{
+				unsigned char *value_bytes = static_cast<unsigned char *>(values);
+				for (int i = 0; i < number_of_values; i++)
+				{
+					for (size_t j = 0; j < value_size/2; j++)
+					{
+						unsigned char temp = value_bytes[j];
+						value_bytes[j] = value_bytes[value_size - 1 - j];
+						value_bytes[value_size - 1 - j] = temp;
+					}
+					value_bytes += value_size;
+				}
+			}
+			return_code = 1;
+		}
+	}
+	return (return_code);
+}
+
+/***************************************************************************//**
+ * Reads <number_of_values> text real values from <input_file> with the fast
+ * block reader instead of scanning each value.
+ *
+ * @return  1 if all values were read, 0 otherwise.
+ */
+static int read_FE_value_values(struct IO_stream *input_file,
+	int number_of_values, FE_value *values)
+{
+	if (sizeof(FE_value) == sizeof(double))
+	{
+		return (number_of_values == IO_stream_read_double_values(input_file,
+			number_of_values, reinterpret_cast<double *>(values)));
+	}
+	double value;
+	for (int i = 0; i < number_of_values; i++)
+	{
+		if (1 != IO_stream_read_double_values(input_file, 1, &value))
+		{
+			return (0);
+		}
+		values[i] = (FE_value)value;
+	}
+	return (1);
+}
+
+/***************************************************************************//**
+ * Reads the remainder of a "Binary values:" line and checks the version and
+ * value sizes are readable by this program.
+ *
+ * @return  1 on success with <binary_format> filled in, 0 on failure.
+ */
+static int read_binary_values_format(struct IO_stream *input_file,
+	struct EX_binary_values_format *binary_format)
+{
+	char byte_order[10], *location;
+	int integer_size, real_size, return_code, version;
+
+	return_code = 0;
+	if (input_file && binary_format)
+	{
+		if (4 == IO_stream_scan(input_file,
+			"inary values : version=%d , byte_order=%9[a-z] , real_size=%d , integer_size=%d",
+			&version, byte_order, &real_size, &integer_size))
+		{
+			const int endian_test = 1;
+			const char *native_byte_order =
+				(1 == *(reinterpret_cast<const char *>(&endian_test))) ? "little" : "big";
+			if (version > EX_BINARY_VALUES_VERSION)
+			{
+				location = IO_stream_get_location_string(input_file);
+				display_message(ERROR_MESSAGE,
+					"Binary EX file version %d is newer than supported version %d.  %s",
+					version, EX_BINARY_VALUES_VERSION, location);
+				DEALLOCATE(location);
+			}
+			else if ((real_size != (int)sizeof(FE_value)) ||
+				(integer_size != (int)sizeof(int)))
+			{
+				location = IO_stream_get_location_string(input_file);
+				display_message(ERROR_MESSAGE,
+					"Binary EX file real size %d or integer size %d not supported.  %s",
+					real_size, integer_size, location);
+				DEALLOCATE(location);
+			}
+			else if (strcmp(byte_order, "little") && strcmp(byte_order, "big"))
+			{
+				location = IO_stream_get_location_string(input_file);
+				display_message(ERROR_MESSAGE,
+					"Unknown byte order '%s' in binary EX file.  %s", byte_order, location);
+				DEALLOCATE(location);
+			}
+			else
+			{
+				binary_format->swap_bytes = (0 != strcmp(byte_order, native_byte_order));
+				return_code = 1;
+			}
+		}
+		else
+		{
+			location = IO_stream_get_location_string(input_file);
+			display_message(ERROR_MESSAGE,
+				"Truncated \'Binary values:\' line in EX file.  %s", location);
+			DEALLOCATE(location);
+		}
+	}
+	return (return_code);
+}
+
 static int read_element_xi_value(struct IO_stream *input_file,
 	struct Cmiss_region *root_region, struct Cmiss_region *current_region,
 	struct FE_element **element_address, FE_value *xi)
@@ -1374,7 +1519,8 @@ static struct FE_node *read_FE_node(struct IO_stream *input_file,
 	struct FE_node *template_node, struct FE_region *fe_region,
 	Cmiss_region_id root_region, Cmiss_region_id region,
 	struct FE_field_order_info *field_order_info,
-	struct FE_import_time_index *time_index)
+	struct FE_import_time_index *time_index,
+	const struct EX_binary_values_format *binary_format)
 {
 	char *location;
 	enum Value_type value_type;
@@ -1457,18 +1603,19 @@ static struct FE_node *read_FE_node(struct IO_stream *input_file,
 
 										if (ALLOCATE(values, FE_value, number_of_values))
 										{
+											if (binary_format ? (!read_binary_values(input_file,
+												binary_format, values, sizeof(FE_value), number_of_values)) :
+												(!read_FE_value_values(input_file, number_of_values, values)))
+											{
+												location = IO_stream_get_location_string(input_file);
+												display_message(ERROR_MESSAGE,
+													"Error reading nodal value from file.  %s",
+													location);
+												DEALLOCATE(location);
+												return_code = 0;
+											}
 											for (k = 0; (k < number_of_values) && return_code; k++)
 											{
-												if (1 != IO_stream_scan(input_file, FE_VALUE_INPUT_STRING,
-													&(values[k])))
-												{
-													location = IO_stream_get_location_string(input_file);
-													display_message(ERROR_MESSAGE,
-														"Error reading nodal value from file.  %s",
-														location);
-													DEALLOCATE(location);
-													return_code = 0;
-												}
 												if (!finite(values[k]))
 												{
 													location = IO_stream_get_location_string(input_file);
@@ -1535,17 +1682,17 @@ static struct FE_node *read_FE_node(struct IO_stream *input_file,
 
 										if (ALLOCATE(values,int,number_of_values))
 										{
-											for (k = 0; (k < number_of_values) && return_code; k++)
+											if (binary_format ? (!read_binary_values(input_file,
+												binary_format, values, sizeof(int), number_of_values)) :
+												(number_of_values != IO_stream_read_int_values(input_file,
+													number_of_values, values)))
 											{
-												if (1 != IO_stream_scan(input_file, "%d", &(values[k])))
-												{
-													location = IO_stream_get_location_string(input_file);
-													display_message(ERROR_MESSAGE,
-														"Error reading nodal value from file.  %s",
-														location);
-													DEALLOCATE(location);
-													return_code = 0;
-												}
+												location = IO_stream_get_location_string(input_file);
+												display_message(ERROR_MESSAGE,
+													"Error reading nodal value from file.  %s",
+													location);
+												DEALLOCATE(location);
+												return_code = 0;
 											}
 											if (return_code)
 											{
@@ -1683,6 +1830,332 @@ static struct FE_node *read_FE_node(struct IO_stream *input_file,
 	return (node);
 } /* read_FE_node */
 
+/***************************************************************************//**
+ * Merges <node> read from an EX file into <fe_region> and, if reading into
+ * <group>, adds it to the group's nodeset group, getting or creating it in
+ * *<nodeset_group_address> on first use.
+ *
+ * @return  1 on success, 0 on failure.
+ */
+static int merge_read_FE_node(struct FE_region *fe_region, struct FE_node *node,
+	Cmiss_region_id region, Cmiss_field_group_id group, int use_data,
+	Cmiss_nodeset_group_id *nodeset_group_address)
+{
+	if (!FE_region_merge_FE_node(fe_region, node))
+	{
+		display_message(ERROR_MESSAGE,
+			"read_exregion_file.  Could not merge node into region");
+		return 0;
+	}
+	if (group && (!*nodeset_group_address))
+	{
+		Cmiss_field_module_id field_module = Cmiss_region_get_field_module(region);
+		Cmiss_nodeset_id nodeset = Cmiss_field_module_find_nodeset_by_name(field_module,
+			use_data ? "cmiss_data" : "cmiss_nodes");
+		Cmiss_field_node_group_id node_group = Cmiss_field_group_get_node_group(group, nodeset);
+		if (!node_group)
+		{
+			node_group = Cmiss_field_group_create_node_group(group, nodeset);
+		}
+		*nodeset_group_address = Cmiss_field_node_group_get_nodeset(node_group);
+		Cmiss_field_node_group_destroy(&node_group);
+		Cmiss_nodeset_destroy(&nodeset);
+		Cmiss_field_module_destroy(&field_module);
+	}
+	if (*nodeset_group_address)
+	{
+		Cmiss_nodeset_group_add_node(*nodeset_group_address, node);
+	}
+	return 1;
+}
+
+/* Maximum number of nodes tokenised at once by read_FE_node_block, which
+	bounds the memory used for their text */
+#define EX_NODE_BLOCK_MAXIMUM_NODES 16384
+/* Minimum number of values converted by each thread in read_FE_node_block */
+#define EX_NODE_BLOCK_MINIMUM_VALUES_PER_THREAD 4096
+
+/** A field with values stored at nodes and the number of values per node */
+struct EX_node_field_layout
+{
+	struct FE_field *field;
+	enum Value_type value_type;
+	int number_of_values;
+};
+
+/***************************************************************************//**
+ * Gets the fields with values stored at nodes using <template_node> and the
+ * number of values of each, in file order.
+ *
+ * @return  1 if all values are real or integer so nodes can be read with
+ * read_FE_node_block, otherwise 0.
+ */
+static int get_FE_node_numeric_layout(struct FE_node *template_node,
+	struct FE_field_order_info *field_order_info,
+	std::vector<EX_node_field_layout>& layout)
+{
+	layout.clear();
+	const int number_of_fields = get_FE_field_order_info_number_of_fields(field_order_info);
+	for (int i = 0; i < number_of_fields; i++)
+	{
+		struct FE_field *field = get_FE_field_order_info_field(field_order_info, i);
+		if (!field)
+		{
+			return 0;
+		}
+		/* only GENERAL_FE_FIELD can store values at nodes */
+		if (GENERAL_FE_FIELD != get_FE_field_FE_field_type(field))
+		{
+			continue;
+		}
+		EX_node_field_layout field_layout;
+		field_layout.field = field;
+		field_layout.value_type = get_FE_field_value_type(field);
+		if ((FE_VALUE_VALUE != field_layout.value_type) &&
+			(INT_VALUE != field_layout.value_type))
+		{
+			return 0;
+		}
+		field_layout.number_of_values = 0;
+		const int number_of_components = get_FE_field_number_of_components(field);
+		for (int j = 0; j < number_of_components; j++)
+		{
+			field_layout.number_of_values +=
+				get_FE_node_field_component_number_of_versions(template_node, field, j)*
+				(1 + get_FE_node_field_component_number_of_derivatives(template_node, field, j));
+		}
+		/* read_FE_node reports fields without values */
+		if (0 == field_layout.number_of_values)
+		{
+			return 0;
+		}
+		layout.push_back(field_layout);
+	}
+	return 1;
+}
+
+/***************************************************************************//**
+ * Reads the node whose initial 'N' has been read from <input_file> and all
+ * nodes immediately following it in text format, which use <template_node>
+ * with the real and integer values in <layout>. The values of the whole block
+ * are tokenised serially, converted to numbers in parallel if built with
+ * USE_OPENMP and there are enough of them, then nodes are created and merged
+ * in file order with merge_read_FE_node, within the caller's change cache.
+ *
+ * @return  1 on success, 0 on failure.
+ */
+static int read_FE_node_block(struct IO_stream *input_file,
+	struct FE_node *template_node, const std::vector<EX_node_field_layout>& layout,
+	struct FE_region *fe_region, Cmiss_region_id region, Cmiss_field_group_id group,
+	int use_data, Cmiss_nodeset_group_id *nodeset_group_address,
+	struct FE_import_time_index *time_index)
+{
+	char *location;
+	int return_code = 1;
+	const int number_of_fields = static_cast<int>(layout.size());
+	int real_values_per_node = 0;
+	int int_values_per_node = 0;
+	for (int f = 0; f < number_of_fields; f++)
+	{
+		if (FE_VALUE_VALUE == layout[f].value_type)
+		{
+			real_values_per_node += layout[f].number_of_values;
+		}
+		else
+		{
+			int_values_per_node += layout[f].number_of_values;
+		}
+	}
+	const int values_per_node = real_values_per_node + int_values_per_node;
+	/* tokenise serially as node numbers and values interleave */
+	std::vector<int> node_numbers;
+	std::vector<int> token_offsets;
+	char *text = (char *)NULL;
+	int text_size = 0;
+	int text_length = 0;
+	while (return_code)
+	{
+		int node_number;
+		if (1 != IO_stream_scan(input_file, "ode :%d", &node_number))
+		{
+			location = IO_stream_get_location_string(input_file);
+			display_message(ERROR_MESSAGE,
+				"read_FE_node.  Error reading node number from file.  %s", location);
+			DEALLOCATE(location);
+			return_code = 0;
+			break;
+		}
+		node_numbers.push_back(node_number);
+		const size_t offset = token_offsets.size();
+		token_offsets.resize(offset + values_per_node);
+		if ((0 < values_per_node) && (values_per_node != IO_stream_read_number_tokens(
+			input_file, values_per_node, &text, &text_size, &text_length, &(token_offsets[offset]))))
+		{
+			location = IO_stream_get_location_string(input_file);
+			display_message(ERROR_MESSAGE,
+				"Error reading nodal value from file.  %s", location);
+			DEALLOCATE(location);
+			return_code = 0;
+			break;
+		}
+		if (EX_NODE_BLOCK_MAXIMUM_NODES <= node_numbers.size())
+		{
+			break;
+		}
+		/* continue while the next token is another node */
+		IO_stream_scan(input_file, " ");
+		if ('N' != IO_stream_peek_character(input_file))
+		{
+			break;
+		}
+		IO_stream_getc(input_file);
+	}
+	const int number_of_nodes = static_cast<int>(node_numbers.size());
+	/* convert to numbers, recording 1 for nodes with unreadable values and 2
+		for infinite or NaN values */
+	std::vector<FE_value> real_values(number_of_nodes*real_values_per_node + 1);
+	std::vector<int> int_values(number_of_nodes*int_values_per_node + 1);
+	std::vector<char> node_errors(number_of_nodes + 1, 0);
+	if (return_code)
+	{
+#if defined (USE_OPENMP)
+		int number_of_threads = omp_get_max_threads();
+		const int maximum_number_of_threads = (number_of_nodes*values_per_node) /
+			EX_NODE_BLOCK_MINIMUM_VALUES_PER_THREAD;
+		if (number_of_threads > maximum_number_of_threads)
+		{
+			number_of_threads = maximum_number_of_threads;
+		}
+		if (number_of_threads < 1)
+		{
+			number_of_threads = 1;
+		}
+#pragma omp parallel for num_threads(number_of_threads) schedule(static)
+#endif /* defined (USE_OPENMP) */
+		for (int n = 0; n < number_of_nodes; n++)
+		{
+			const int *node_token_offsets = &(token_offsets[0]) + n*values_per_node;
+			FE_value *node_real_values = &(real_values[0]) + n*real_values_per_node;
+			int *node_int_values = &(int_values[0]) + n*int_values_per_node;
+			int t = 0;
+			for (int f = 0; (f < number_of_fields) && (!node_errors[n]); f++)
+			{
+				const int number_of_values = layout[f].number_of_values;
+				if (FE_VALUE_VALUE == layout[f].value_type)
+				{
+					for (int k = 0; k < number_of_values; k++)
+					{
+						double value;
+						if (!IO_stream_parse_double_token(text + node_token_offsets[t++], &value))
+						{
+							node_errors[n] = 1;
+							break;
+						}
+						if (!finite(value))
+						{
+							node_errors[n] = 2;
+							break;
+						}
+						*node_real_values = (FE_value)value;
+						node_real_values++;
+					}
+				}
+				else
+				{
+					for (int k = 0; k < number_of_values; k++)
+					{
+						if (!IO_stream_parse_int_token(text + node_token_offsets[t++], node_int_values))
+						{
+							node_errors[n] = 1;
+							break;
+						}
+						node_int_values++;
+					}
+				}
+			}
+		}
+	}
+	if (text)
+	{
+		DEALLOCATE(text);
+	}
+	/* create and merge nodes in file order */
+	for (int n = 0; (n < number_of_nodes) && return_code; n++)
+	{
+		if (node_errors[n])
+		{
+			location = IO_stream_get_location_string(input_file);
+			display_message(ERROR_MESSAGE, (1 == node_errors[n]) ?
+				"Error reading nodal value for node %d from file.  %s" :
+				"Infinity or NAN read from node file for node %d.  %s",
+				node_numbers[n], location);
+			DEALLOCATE(location);
+			return_code = 0;
+			break;
+		}
+		struct FE_node *node = CREATE(FE_node)(node_numbers[n],
+			(struct FE_region *)NULL, template_node);
+		if (!node)
+		{
+			location = IO_stream_get_location_string(input_file);
+			display_message(ERROR_MESSAGE,
+				"read_FE_node.  Could not create node.  %s", location);
+			DEALLOCATE(location);
+			return_code = 0;
+			break;
+		}
+		ACCESS(FE_node)(node);
+		FE_value *node_real_values = &(real_values[0]) + n*real_values_per_node;
+		int *node_int_values = &(int_values[0]) + n*int_values_per_node;
+		for (int f = 0; (f < number_of_fields) && return_code; f++)
+		{
+			int length = 0;
+			if (FE_VALUE_VALUE == layout[f].value_type)
+			{
+				if (time_index)
+				{
+					return_code = set_FE_nodal_field_FE_values_at_time(layout[f].field,
+						node, node_real_values, &length, time_index->time);
+				}
+				else
+				{
+					return_code = set_FE_nodal_field_FE_value_values(layout[f].field,
+						node, node_real_values, &length);
+				}
+				node_real_values += layout[f].number_of_values;
+			}
+			else
+			{
+				return_code = set_FE_nodal_field_int_values(layout[f].field,
+					node, node_int_values, &length);
+				node_int_values += layout[f].number_of_values;
+			}
+			if (return_code && (length != layout[f].number_of_values))
+			{
+				location = IO_stream_get_location_string(input_file);
+				display_message(ERROR_MESSAGE,
+					"node %d field '%s' took %d values from %d expected.  %s",
+					node_numbers[n], get_FE_field_name(layout[f].field), length,
+					layout[f].number_of_values, location);
+				DEALLOCATE(location);
+				return_code = 0;
+			}
+		}
+		if (return_code)
+		{
+			return_code = merge_read_FE_node(fe_region, node, region, group, use_data,
+				nodeset_group_address);
+		}
+		else
+		{
+			display_message(ERROR_MESSAGE,
+				"read_exregion_file.  Error reading node");
+		}
+		DEACCESS(FE_node)(&node);
+	}
+	return (return_code);
+}
+
 static int read_FE_element_shape(struct IO_stream *input_file,
 	struct FE_element_shape **element_shape_address, struct FE_region *fe_region)
 /*******************************************************************************
@@ -2829,7 +3302,8 @@ from a previous call to this function.
 
 static struct FE_element *read_FE_element(struct IO_stream *input_file,
 	struct FE_element *template_element, struct FE_region *fe_region,
-	struct FE_field_order_info *field_order_info)
+	struct FE_field_order_info *field_order_info,
+	const struct EX_binary_values_format *binary_format)
 /*******************************************************************************
 LAST MODIFIED : 27 May 2003
 
@@ -2837,6 +3311,8 @@ DESCRIPTION :
 Reads in an element from an <input_file>.
 Element info may now have no nodes and no scale factors - eg. for reading
 in a grid field.
+If <binary_format> is supplied, nodes and scale factors are read as binary
+blocks.
 ==============================================================================*/
 {
 	char *location, test_string[5];
@@ -3021,18 +3497,18 @@ in a grid field.
 													return_code = 0;
 												}
 											}
+											if (return_code &&
+												!read_FE_value_values(input_file, number_of_values, values))
+											{
+												location = IO_stream_get_location_string(input_file);
+												display_message(ERROR_MESSAGE,
+													"Error reading grid FE_value value from file.  %s",
+													location);
+												DEALLOCATE(location);
+												return_code = 0;
+											}
 											for (k = 0; (k < number_of_values) && return_code; k++)
 											{
-												if (1 != IO_stream_scan(input_file, FE_VALUE_INPUT_STRING,
-													&(values[k])))
-												{
-													location = IO_stream_get_location_string(input_file);
-													display_message(ERROR_MESSAGE,
-														"Error reading grid FE_value value from file.  %s",
-														location);
-													DEALLOCATE(location);
-													return_code = 0;
-												}
 												if (!finite(values[k]))
 												{
 													location = IO_stream_get_location_string(input_file);
@@ -3079,17 +3555,15 @@ in a grid field.
 													return_code = 0;
 												}
 											}
-											for (k = 0; (k < number_of_values) && return_code; k++)
+											if (return_code && (number_of_values !=
+												IO_stream_read_int_values(input_file, number_of_values, values)))
 											{
-												if (1 != IO_stream_scan(input_file, "%d", &(values[k])))
-												{
-													location = IO_stream_get_location_string(input_file);
-													display_message(ERROR_MESSAGE,
-														"Error reading grid int value from file.  %s",
-														location);
-													DEALLOCATE(location);
-													return_code = 0;
-												}
+												location = IO_stream_get_location_string(input_file);
+												display_message(ERROR_MESSAGE,
+													"Error reading grid int value from file.  %s",
+													location);
+												DEALLOCATE(location);
+												return_code = 0;
 											}
 											if (return_code)
 											{
@@ -3137,28 +3611,33 @@ in a grid field.
 									"Truncated read of required \" Nodes:\" token in element file.  %s", location);
 								DEALLOCATE(location);
 							}
+							/* read all node numbers in one block */
+							int *node_numbers = NULL;
+							if (!(ALLOCATE(node_numbers, int, number_of_nodes) &&
+								(binary_format ? read_binary_values(input_file, binary_format,
+									node_numbers, sizeof(int), number_of_nodes) :
+								(number_of_nodes == IO_stream_read_int_values(input_file,
+									number_of_nodes, node_numbers)))))
+							{
+								location = IO_stream_get_location_string(input_file);
+								display_message(ERROR_MESSAGE,
+									"Error reading node number from file.  %s",
+									location);
+								DEALLOCATE(location);
+								return_code = 0;
+							}
 							for (i = 0; (i < number_of_nodes) && return_code; i++)
 							{
-								if (1 == IO_stream_scan(input_file, "%d", &node_number))
+								node_number = node_numbers[i];
+								/* get or create node with node_number */
+								if (NULL != (node = FE_region_get_or_create_FE_node_with_identifier(
+									fe_region, node_number)))
 								{
-									/* get or create node with node_number */
-									if (NULL != (node = FE_region_get_or_create_FE_node_with_identifier(
-										fe_region, node_number)))
-									{
-										if (!set_FE_element_node(element, i, node))
-										{
-											location = IO_stream_get_location_string(input_file);
-											display_message(ERROR_MESSAGE,
-												"read_FE_element.  Could not set node");
-											DEALLOCATE(location);
-											return_code = 0;
-										}
-									}
-									else
+									if (!set_FE_element_node(element, i, node))
 									{
 										location = IO_stream_get_location_string(input_file);
 										display_message(ERROR_MESSAGE,
-											"read_FE_element.  Could not get or create node");
+											"read_FE_element.  Could not set node");
 										DEALLOCATE(location);
 										return_code = 0;
 									}
@@ -3167,12 +3646,12 @@ in a grid field.
 								{
 									location = IO_stream_get_location_string(input_file);
 									display_message(ERROR_MESSAGE,
-										"Error reading node number from file.  %s",
-										location);
+										"read_FE_element.  Could not get or create node");
 									DEALLOCATE(location);
 									return_code = 0;
 								}
 							}
+							DEALLOCATE(node_numbers);
 						}
 					}
 					else
@@ -3201,29 +3680,32 @@ in a grid field.
 								display_message(WARNING_MESSAGE,
 									"Truncated read of required \" Scale factors:\" token in element file.");
 							}
+							/* read all scale factors in one block */
+							FE_value *scale_factors = NULL;
+							if (!(ALLOCATE(scale_factors, FE_value, number_of_scale_factors) &&
+								(binary_format ? read_binary_values(input_file, binary_format,
+									scale_factors, sizeof(FE_value), number_of_scale_factors) :
+								read_FE_value_values(input_file, number_of_scale_factors,
+									scale_factors))))
+							{
+								location = IO_stream_get_location_string(input_file);
+								display_message(ERROR_MESSAGE,
+									"Error reading scale factor from file.  %s",
+									location);
+								DEALLOCATE(location);
+								return_code = 0;
+							}
 							for (i = 0; (i < number_of_scale_factors) && return_code; i++)
 							{
-								if (1 == IO_stream_scan(input_file,FE_VALUE_INPUT_STRING,
-									&scale_factor))
+								scale_factor = scale_factors[i];
+								if (finite(scale_factor))
 								{
-									if (finite(scale_factor))
-									{
-										if (!set_FE_element_scale_factor(element, i, scale_factor))
-										{
-											location = IO_stream_get_location_string(input_file);
-											display_message(ERROR_MESSAGE,
-												"Error setting scale factor.  %s",
-												location);
-											DEALLOCATE(location);
-											return_code = 0;
-										}
-									}
-									else
+									if (!set_FE_element_scale_factor(element, i, scale_factor))
 									{
 										location = IO_stream_get_location_string(input_file);
 										display_message(ERROR_MESSAGE,
-											"Infinity or NAN scale factor read from element file.  "
-											"%s", location);
+											"Error setting scale factor.  %s",
+											location);
 										DEALLOCATE(location);
 										return_code = 0;
 									}
@@ -3232,12 +3714,13 @@ in a grid field.
 								{
 									location = IO_stream_get_location_string(input_file);
 									display_message(ERROR_MESSAGE,
-										"Error reading scale factor from file.  %s",
-										location);
+										"Infinity or NAN scale factor read from element file.  "
+										"%s", location);
 									DEALLOCATE(location);
 									return_code = 0;
 								}
 							}
+							DEALLOCATE(scale_factors);
 						}
 					}
 					else
@@ -3312,6 +3795,7 @@ static int read_exregion_file_private(struct Cmiss_region *root_region,
 	struct FE_element_shape *element_shape;
 	struct FE_field_order_info *field_order_info;
 	struct FE_node *node, *template_node;
+	struct EX_binary_values_format binary_format_value, *binary_format;
 
 	ENTER(read_exregion_file);
 	return_code = 0;
@@ -3329,6 +3813,8 @@ static int read_exregion_file_private(struct Cmiss_region *root_region,
 		template_node = (struct FE_node *)NULL;
 		template_element = (struct FE_element *)NULL;
 		element_shape = (struct FE_element_shape *)NULL;
+		/* text values unless file starts with a "Binary values:" line */
+		binary_format = (struct EX_binary_values_format *)NULL;
 		input_result = 1;
 		return_code = 1;
 		while (return_code && (1 == input_result))
@@ -3573,6 +4059,17 @@ static int read_exregion_file_private(struct Cmiss_region *root_region,
 						}
 						Cmiss_mesh_group_destroy(&mesh_group);
 					} break;
+					case 'B': /* Binary values: version=#, byte_order=~, real_size=#, integer_size=# */
+					{
+						if (read_binary_values_format(input_file, &binary_format_value))
+						{
+							binary_format = &binary_format_value;
+						}
+						else
+						{
+							return_code = 0;
+						}
+					} break;
 					case '!': /* ! Comment ignored to end of line */
 					{
 						char *comment = NULL;
@@ -3644,37 +4141,23 @@ static int read_exregion_file_private(struct Cmiss_region *root_region,
 							/* ensure we have node field information */
 							if (template_node)
 							{
-								/* read node */
-								if (NULL != (node = read_FE_node(input_file, template_node, fe_region,
-									root_region, region, field_order_info, time_index)))
+								/* read text nodes with only real and integer values in
+									blocks converted in parallel, others singly */
+								std::vector<EX_node_field_layout> layout;
+								if ((!binary_format) && get_FE_node_numeric_layout(template_node,
+									field_order_info, layout))
+								{
+									return_code = read_FE_node_block(input_file, template_node,
+										layout, fe_region, region, group, use_data, &nodeset_group,
+										time_index);
+								}
+								else if (NULL != (node = read_FE_node(input_file, template_node, fe_region,
+									root_region, region, field_order_info, time_index, binary_format)))
 								{
 									ACCESS(FE_node)(node);
-									if (FE_region_merge_FE_node(fe_region, node))
-									{
-										if (group && (!nodeset_group))
-										{
-											Cmiss_field_module_id field_module = Cmiss_region_get_field_module(region);
-											Cmiss_nodeset_id nodeset = Cmiss_field_module_find_nodeset_by_name(field_module,
-												use_data ? "cmiss_data" : "cmiss_nodes");
-											Cmiss_field_node_group_id node_group = Cmiss_field_group_get_node_group(group, nodeset);
-											if (!node_group)
-											{
-												node_group = Cmiss_field_group_create_node_group(group, nodeset);
-											}
-											nodeset_group = Cmiss_field_node_group_get_nodeset(node_group);
-											Cmiss_field_node_group_destroy(&node_group);
-											Cmiss_nodeset_destroy(&nodeset);
-											Cmiss_field_module_destroy(&field_module);
-										}
-										if (nodeset_group)
-										{
-											Cmiss_nodeset_group_add_node(nodeset_group, node);
-										}
-									}
-									else
+									if (!merge_read_FE_node(fe_region, node, region, group, use_data,
+										&nodeset_group))
 									{
-										display_message(ERROR_MESSAGE,
-											"read_exregion_file.  Could not merge node into region");
 										return_code = 0;
 									}
 									DEACCESS(FE_node)(&node);
@@ -3712,7 +4195,7 @@ static int read_exregion_file_private(struct Cmiss_region *root_region,
 							{
 								/* read element */
 								if (NULL != (element = read_FE_element(input_file, template_element,
-									fe_region, field_order_info)))
+									fe_region, field_order_info, binary_format)))
 								{
 									ACCESS(FE_element)(element);
 									if (FE_region_merge_FE_element(fe_region, element))
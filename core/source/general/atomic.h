@@ -0,0 +1,149 @@
+/***************************************************************************//**
+ * FILE : atomic.h
+ *
+ * Minimal atomic integer operations and spin lock used to make object access
+ * counting and small shared lists safe for concurrent use from several threads.
+ */
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is cmgui.
+ *
+ * The Initial Developer of the Original Code is
+ * Auckland Uniservices Ltd, Auckland, New Zealand.
+ * Portions created by the Initial Developer are Copyright (C) 2012
+ * the Initial Developer. All Rights Reserved.
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+#if !defined (ATOMIC_H)
+#define ATOMIC_H
+
+#include <stddef.h>
+
+#if defined (_MSC_VER)
+#include <intrin.h>
+#pragma intrinsic(_InterlockedIncrement, _InterlockedDecrement, _InterlockedExchange, _InterlockedExchangeAdd)
+#if defined (_WIN64)
+#pragma intrinsic(_InterlockedExchangeAdd64)
+#endif /* defined (_WIN64) */
+#endif /* defined (_MSC_VER) */
+
+/***************************************************************************//**
+ * Atomically increments the integer at <value_address> by 1.
+ * @return  The incremented value.
+ */
+static inline int cmiss_atomic_increment(volatile int *value_address)
+{
+#if defined (_MSC_VER)
+	return static_cast<int>(_InterlockedIncrement(reinterpret_cast<volatile long *>(value_address)));
+#else
+	return __sync_add_and_fetch(value_address, 1);
+#endif
+}
+
+/***************************************************************************//**
+ * Atomically decrements the integer at <value_address> by 1.
+ * @return  The decremented value.
+ */
+static inline int cmiss_atomic_decrement(volatile int *value_address)
+{
+#if defined (_MSC_VER)
+	return static_cast<int>(_InterlockedDecrement(reinterpret_cast<volatile long *>(value_address)));
+#else
+	return __sync_sub_and_fetch(value_address, 1);
+#endif
+}
+
+/***************************************************************************//**
+ * Atomically adds <increment> to the integer at <value_address>.
+ * @return  The new value.
+ */
+static inline int cmiss_atomic_add(volatile int *value_address, int increment)
+{
+#if defined (_MSC_VER)
+	return static_cast<int>(_InterlockedExchangeAdd(reinterpret_cast<volatile long *>(value_address),
+		static_cast<long>(increment))) + increment;
+#else
+	return __sync_add_and_fetch(value_address, increment);
+#endif
+}
+
+/***************************************************************************//**
+ * Atomically adds <increment> to the size_t at <value_address>, for counts
+ * which may exceed the range of int.
+ * @return  The new value.
+ */
+static inline size_t cmiss_atomic_add_size(volatile size_t *value_address, size_t increment)
+{
+#if defined (_MSC_VER)
+#if defined (_WIN64)
+	return static_cast<size_t>(_InterlockedExchangeAdd64(reinterpret_cast<volatile __int64 *>(value_address),
+		static_cast<__int64>(increment))) + increment;
+#else
+	return static_cast<size_t>(_InterlockedExchangeAdd(reinterpret_cast<volatile long *>(value_address),
+		static_cast<long>(increment))) + increment;
+#endif
+#else
+	return __sync_add_and_fetch(value_address, increment);
+#endif
+}
+
+/***************************************************************************//**
+ * Acquires the spin lock held in the integer at <lock_address>, which must be
+ * initialised to 0. Only intended for guarding very short critical sections.
+ */
+static inline void cmiss_spin_lock(volatile int *lock_address)
+{
+#if defined (_MSC_VER)
+	while (_InterlockedExchange(reinterpret_cast<volatile long *>(lock_address), 1L))
+	{
+		while (*lock_address)
+		{
+		}
+	}
+#else
+	while (__sync_lock_test_and_set(lock_address, 1))
+	{
+		while (*lock_address)
+		{
+		}
+	}
+#endif
+}
+
+/***************************************************************************//**
+ * Releases the spin lock held in the integer at <lock_address>.
+ */
+static inline void cmiss_spin_unlock(volatile int *lock_address)
+{
+#if defined (_MSC_VER)
+	_InterlockedExchange(reinterpret_cast<volatile long *>(lock_address), 0L);
+#else
+	__sync_lock_release(lock_address);
+#endif
+}
+
+#endif /* !defined (ATOMIC_H) */
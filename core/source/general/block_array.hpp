@@ -50,6 +50,19 @@ private:
 	EntryType **blocks;
 	IndexType blockCount;
 
+protected:
+
+	IndexType getBlockCount() const
+	{
+		return blockCount;
+	}
+
+	/** @return  Block at blockIndex or NULL if none. */
+	EntryType* getBlock(IndexType blockIndex) const
+	{
+		return (blockIndex < blockCount) ? blocks[blockIndex] : NULL;
+	}
+
 	EntryType* getOrCreateBlock(IndexType blockIndex)
 	{
 		if (blockIndex >= blockCount)
@@ -261,6 +274,121 @@ public:
 		return false;
 	}
 
+	/**
+	 * Fast search skipping whole words and blocks with no true values.
+	 * @param nextTrueIndex  Updated to equal or next higher index with true
+	 * value.
+	 * @return  true if found, false if none.
+	 */
+	bool updateNextTrueIndex(IndexType& nextTrueIndex) const
+	{
+		if (nextTrueIndex < 0)
+			nextTrueIndex = 0;
+		const IndexType blockCount = this->getBlockCount();
+		IndexType intIndex = nextTrueIndex >> 5;
+		IndexType blockIndex = intIndex / intBlockLength;
+		IndexType entryIndex = intIndex % intBlockLength;
+		int bitIndex = nextTrueIndex & 0x1F;
+		while (blockIndex < blockCount)
+		{
+			const unsigned int *block = this->getBlock(blockIndex);
+			if (block)
+			{
+				for (; entryIndex < intBlockLength; ++entryIndex)
+				{
+					unsigned int intValue = block[entryIndex] >> bitIndex;
+					if (intValue)
+					{
+						while (0 == (intValue & 1))
+						{
+							intValue >>= 1;
+							++bitIndex;
+						}
+						nextTrueIndex = ((blockIndex*intBlockLength + entryIndex) << 5) + bitIndex;
+						return true;
+					}
+					bitIndex = 0;
+				}
+			}
+			++blockIndex;
+			entryIndex = 0;
+			bitIndex = 0;
+		}
+		return false;
+	}
+
+	/** @return  Number of true values. */
+	IndexType getTrueCount() const
+	{
+		IndexType trueCount = 0;
+		const IndexType blockCount = this->getBlockCount();
+		for (IndexType blockIndex = 0; blockIndex < blockCount; ++blockIndex)
+		{
+			const unsigned int *block = this->getBlock(blockIndex);
+			if (block)
+			{
+				for (IndexType i = 0; i < intBlockLength; ++i)
+				{
+					for (unsigned int intValue = block[i]; intValue; intValue &= intValue - 1)
+						++trueCount;
+				}
+			}
+		}
+		return trueCount;
+	}
+
+	/** Sets values true wherever they are true in other, 32 at a time.
+	 * @return  true if completely successful, false otherwise */
+	bool unionWith(const bool_array& other)
+	{
+		const IndexType otherBlockCount = other.getBlockCount();
+		for (IndexType blockIndex = 0; blockIndex < otherBlockCount; ++blockIndex)
+		{
+			const unsigned int *otherBlock = other.getBlock(blockIndex);
+			if (otherBlock)
+			{
+				unsigned int *block = this->getOrCreateBlock(blockIndex);
+				if (!block)
+					return false;
+				for (IndexType i = 0; i < intBlockLength; ++i)
+					block[i] |= otherBlock[i];
+			}
+		}
+		return true;
+	}
+
+	/** Sets values false wherever they are false in other, 32 at a time. */
+	void intersectWith(const bool_array& other)
+	{
+		const IndexType blockCount = this->getBlockCount();
+		for (IndexType blockIndex = 0; blockIndex < blockCount; ++blockIndex)
+		{
+			unsigned int *block = this->getBlock(blockIndex);
+			if (block)
+			{
+				const unsigned int *otherBlock = other.getBlock(blockIndex);
+				for (IndexType i = 0; i < intBlockLength; ++i)
+					block[i] = otherBlock ? (block[i] & otherBlock[i]) : 0;
+			}
+		}
+	}
+
+	/** Sets values false wherever they are true in other, 32 at a time. */
+	void subtract(const bool_array& other)
+	{
+		const IndexType blockCount = this->getBlockCount();
+		for (IndexType blockIndex = 0; blockIndex < blockCount; ++blockIndex)
+		{
+			unsigned int *block = this->getBlock(blockIndex);
+			const unsigned int *otherBlock = other.getBlock(blockIndex);
+			if (block && otherBlock)
+			{
+				for (IndexType i = 0; i < intBlockLength; ++i)
+					block[i] &= ~otherBlock[i];
+			}
+		}
+	}
+
 	/** Sets all entries from index 0..indexCount-1 to true.
 	 * @return  true if completely successful, false otherwise */
 	bool setAllTrue(IndexType indexCount)
@@ -280,4 +408,47 @@ public:
 	}
 };
 
+/**
+ * Access counted bool_array indexed by object identifier, for sets of objects
+ * such as group membership which are shared with iterators over them.
+ */
+class identifier_bool_array : public bool_array<int>
+{
+private:
+	int access_count;
+
+	identifier_bool_array() :
+		access_count(1)
+	{
+	}
+
+	~identifier_bool_array()
+	{
+	}
+
+public:
+
+	static identifier_bool_array *create()
+	{
+		return new identifier_bool_array();
+	}
+
+	identifier_bool_array *access()
+	{
+		++access_count;
+		return this;
+	}
+
+	static int deaccess(identifier_bool_array* &identifiers)
+	{
+		if (!identifiers)
+			return 0;
+		--(identifiers->access_count);
+		if (identifiers->access_count <= 0)
+			delete identifiers;
+		identifiers = 0;
+		return 1;
+	}
+};
+
 #endif /* !defined (BLOCK_ARRAY_HPP) */
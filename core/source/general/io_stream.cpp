@@ -51,6 +51,8 @@ streams.
 	to be sufficient for the cross compiler so I am specifying it here too. */
 #  define _ISOC99_SOURCE
 #endif /* defined (GENERIC_PC) && defined (UNIX) */
+#include <ctype.h>
+#include <limits.h>
 #include <stddef.h>
 #include <stdio.h>
 #include <stdarg.h>
@@ -638,7 +640,7 @@ DESCRIPTION :
 				else
 #endif /* defined (HAVE_BZLIB) */
 				{
-					stream->file_handle = fopen(filename, "r");
+					stream->file_handle = fopen(filename, "rb");
 					if (NULL != stream->file_handle)
 					{
 						stream->type = IO_STREAM_FILE_TYPE;
@@ -1182,6 +1184,401 @@ Equivalent to a standard C fgetc on the stream.
 	return (return_code);
 } /* IO_stream_getc */
 
+int IO_stream_peek_character(struct IO_stream *stream)
+/*******************************************************************************
+DESCRIPTION :
+Returns the next character in the <stream> without consuming it, or EOF at the
+end of the stream.
+==============================================================================*/
+{
+	int return_code;
+
+	ENTER(IO_stream_peek_character);
+	return_code = EOF;
+	if (stream)
+	{
+		switch (stream->type)
+		{
+			case IO_STREAM_FILE_TYPE:
+			{
+				return_code = getc(stream->file_handle);
+				if (EOF != return_code)
+				{
+					ungetc(return_code, stream->file_handle);
+				}
+			} break;
+			case IO_STREAM_MEMORY_TYPE:
+			case IO_STREAM_GZIP_FILE_TYPE:
+			case IO_STREAM_BZ2_FILE_TYPE:
+			case IO_STREAM_BZ2_MEMORY_TYPE:
+			{
+				IO_stream_read_to_internal_buffer(stream);
+				if (stream->buffer_index < stream->buffer_valid_index)
+				{
+					return_code = (unsigned char)(stream->buffer[stream->buffer_index]);
+				}
+			} break;
+			default:
+			{
+				display_message(ERROR_MESSAGE,
+					"IO_stream_peek_character. IO stream invalid or type not implemented.");
+			} break;
+		}
+	}
+	else
+	{
+		display_message(ERROR_MESSAGE,
+			"IO_stream_peek_character. Invalid arguments.");
+	}
+	LEAVE;
+
+	return (return_code);
+}
+
+/* maximum characters in a single numeric token read by IO_stream_read_*_values */
+#define IO_STREAM_MAXIMUM_NUMBER_TOKEN_LENGTH 64
+
+static int IO_stream_read_number_token(struct IO_stream *stream, char *token)
+/*******************************************************************************
+DESCRIPTION :
+Skips white space then copies the next white space delimited token from the
+<stream> into <token>, which must have space for
+IO_STREAM_MAXIMUM_NUMBER_TOKEN_LENGTH characters. Buffered streams are read
+directly from the internal buffer; plain files use getc on the stdio buffer.
+Returns the length of the token, or 0 at end of stream or if it is too long.
+==============================================================================*/
+{
+	int c, length;
+
+	length = 0;
+	switch (stream->type)
+	{
+		case IO_STREAM_FILE_TYPE:
+		{
+			do
+			{
+				c = getc(stream->file_handle);
+			} while ((' ' == c) || ('\n' == c) || ('\r' == c) || ('\t' == c) ||
+				('\f' == c) || ('\v' == c));
+			while ((EOF != c) && (' ' != c) && ('\n' != c) && ('\r' != c) &&
+				('\t' != c) && ('\f' != c) && ('\v' != c))
+			{
+				if (length >= IO_STREAM_MAXIMUM_NUMBER_TOKEN_LENGTH - 1)
+				{
+					return (0);
+				}
+				token[length] = (char)c;
+				length++;
+				c = getc(stream->file_handle);
+			}
+			if (EOF != c)
+			{
+				ungetc(c, stream->file_handle);
+			}
+		} break;
+		case IO_STREAM_MEMORY_TYPE:
+		case IO_STREAM_GZIP_FILE_TYPE:
+		case IO_STREAM_BZ2_FILE_TYPE:
+		case IO_STREAM_BZ2_MEMORY_TYPE:
+		{
+			int skipping = 1;
+			while (skipping)
+			{
+				/* refills the buffer when less than a chunk remains, which is
+					 always enough for a complete token */
+				IO_stream_read_to_internal_buffer(stream);
+				if (stream->buffer_index >= stream->buffer_valid_index)
+				{
+					return (0);
+				}
+				while ((stream->buffer_index < stream->buffer_valid_index) &&
+					isspace((unsigned char)stream->buffer[stream->buffer_index]))
+				{
+					stream->buffer_index++;
+				}
+				skipping = (stream->buffer_index >= stream->buffer_valid_index);
+			}
+			/* ensure a token straddling the end of the buffer is complete */
+			IO_stream_read_to_internal_buffer(stream);
+			while ((stream->buffer_index < stream->buffer_valid_index) &&
+				stream->buffer[stream->buffer_index] &&
+				!isspace((unsigned char)stream->buffer[stream->buffer_index]))
+			{
+				if (length >= IO_STREAM_MAXIMUM_NUMBER_TOKEN_LENGTH - 1)
+				{
+					return (0);
+				}
+				token[length] = stream->buffer[stream->buffer_index];
+				length++;
+				stream->buffer_index++;
+			}
+		} break;
+		default:
+		{
+			display_message(ERROR_MESSAGE,
+				"IO_stream_read_number_token. IO stream invalid or type not implemented.");
+		} break;
+	}
+	token[length] = '\0';
+
+	return (length);
+}
+
+int IO_stream_parse_double_token(const char *token, double *value)
+/*******************************************************************************
+DESCRIPTION :
+Converts the complete <token> to a double. Decimal numbers whose significant
+digits fit exactly in a double and with a small power of ten are converted
+exactly with a single multiplication or division by an exactly representable
+power of ten. Anything else falls back to strtod so results always match it.
+==============================================================================*/
+{
+	static const double powers_of_ten[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6,
+		1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18,
+		1e19, 1e20, 1e21, 1e22 };
+	const char *c = token;
+	char *end;
+	int digits, exponent, exponent_value, negative, negative_exponent;
+	unsigned long long mantissa;
+
+	negative = 0;
+	if (('-' == *c) || ('+' == *c))
+	{
+		negative = ('-' == *c);
+		c++;
+	}
+	mantissa = 0;
+	digits = 0;
+	exponent = 0;
+	/* skip leading zeros so they do not count as significant digits */
+	while ('0' == *c)
+	{
+		c++;
+		digits = -1;
+	}
+	while (('0' <= *c) && (*c <= '9'))
+	{
+		mantissa = mantissa*10 + (*c - '0');
+		digits = (digits < 0) ? 1 : digits + 1;
+		c++;
+	}
+	if ('.' == *c)
+	{
+		c++;
+		while (('0' <= *c) && (*c <= '9'))
+		{
+			if ((0 == mantissa) && ('0' == *c))
+			{
+				digits = -1;
+			}
+			else
+			{
+				mantissa = mantissa*10 + (*c - '0');
+				digits = (digits < 0) ? 1 : digits + 1;
+			}
+			exponent--;
+			c++;
+		}
+	}
+	if ((0 != digits) && (('e' == *c) || ('E' == *c)))
+	{
+		c++;
+		negative_exponent = 0;
+		if (('-' == *c) || ('+' == *c))
+		{
+			negative_exponent = ('-' == *c);
+			c++;
+		}
+		if (!(('0' <= *c) && (*c <= '9')))
+		{
+			digits = 0;
+		}
+		exponent_value = 0;
+		while (('0' <= *c) && (*c <= '9') && (exponent_value < 10000))
+		{
+			exponent_value = exponent_value*10 + (*c - '0');
+			c++;
+		}
+		exponent += negative_exponent ? -exponent_value : exponent_value;
+	}
+	if ((0 != digits) && ('\0' == *c) && (digits <= 19) &&
+		(mantissa <= (1ULL << 53)) && (-22 <= exponent) && (exponent <= 22))
+	{
+		*value = (double)mantissa;
+		if (exponent < 0)
+		{
+			*value /= powers_of_ten[-exponent];
+		}
+		else
+		{
+			*value *= powers_of_ten[exponent];
+		}
+		if (negative)
+		{
+			*value = -*value;
+		}
+		return (1);
+	}
+	*value = strtod(token, &end);
+	return ((end != token) && ('\0' == *end));
+}
+
+int IO_stream_parse_int_token(const char *token, int *value)
+/*******************************************************************************
+DESCRIPTION :
+Converts the complete <token> to an int. Short decimal integers are converted
+by hand; anything else falls back to strtol with a range check.
+==============================================================================*/
+{
+	const char *c;
+	char *end;
+	int negative;
+	long long_value;
+
+	c = token;
+	negative = 0;
+	if (('-' == *c) || ('+' == *c))
+	{
+		negative = ('-' == *c);
+		c++;
+	}
+	long_value = 0;
+	/* 9 digits cannot overflow an int; longer tokens use strtol */
+	while (('0' <= *c) && (*c <= '9') && (c - token < 10))
+	{
+		long_value = long_value*10 + (*c - '0');
+		c++;
+	}
+	if ((c != token) && ('\0' == *c) && ('0' <= *(c - 1)) && (*(c - 1) <= '9'))
+	{
+		*value = (int)(negative ? -long_value : long_value);
+		return (1);
+	}
+	long_value = strtol(token, &end, 10);
+	if ((end == token) || ('\0' != *end) || (long_value > INT_MAX) ||
+		(long_value < INT_MIN))
+	{
+		return (0);
+	}
+	*value = (int)long_value;
+	return (1);
+}
+
+int IO_stream_read_number_tokens(struct IO_stream *stream, int number_of_tokens,
+	char **text_address, int *text_size_address, int *text_length_address,
+	int *token_offsets)
+/*******************************************************************************
+DESCRIPTION :
+Reads up to <number_of_tokens> white space delimited numeric tokens from the
+<stream>, appending each null terminated at *<text_length_address> in the text
+at *<text_address>, which is reallocated as needed with its allocated size in
+*<text_size_address>. The offset of each token in the text is returned in
+<token_offsets>. Returns the number of tokens read.
+==============================================================================*/
+{
+	char token[IO_STREAM_MAXIMUM_NUMBER_TOKEN_LENGTH], *new_text;
+	int i, length, new_size;
+
+	ENTER(IO_stream_read_number_tokens);
+	i = 0;
+	if (stream && (0 <= number_of_tokens) && text_address && text_size_address &&
+		text_length_address && token_offsets)
+	{
+		while ((i < number_of_tokens) &&
+			(0 < (length = IO_stream_read_number_token(stream, token))))
+		{
+			if (*text_length_address + length + 1 > *text_size_address)
+			{
+				new_size = 2*(*text_size_address) + 16*IO_STREAM_MAXIMUM_NUMBER_TOKEN_LENGTH;
+				if (!REALLOCATE(new_text, *text_address, char, new_size))
+				{
+					display_message(ERROR_MESSAGE,
+						"IO_stream_read_number_tokens.  Insufficient memory.");
+					break;
+				}
+				*text_address = new_text;
+				*text_size_address = new_size;
+			}
+			token_offsets[i] = *text_length_address;
+			memcpy(*text_address + *text_length_address, token, length + 1);
+			*text_length_address += length + 1;
+			i++;
+		}
+	}
+	else
+	{
+		display_message(ERROR_MESSAGE,
+			"IO_stream_read_number_tokens.  Invalid arguments.");
+	}
+	LEAVE;
+
+	return (i);
+}
+
+int IO_stream_read_double_values(struct IO_stream *stream, int number_of_values,
+	double *values)
+/*******************************************************************************
+DESCRIPTION :
+Reads up to <number_of_values> white space separated real numbers from the
+<stream> into <values> without going through IO_stream_scan. Returns the number
+of values successfully read.
+==============================================================================*/
+{
+	char token[IO_STREAM_MAXIMUM_NUMBER_TOKEN_LENGTH];
+	int i;
+
+	ENTER(IO_stream_read_double_values);
+	i = 0;
+	if (stream && (0 <= number_of_values) && values)
+	{
+		while ((i < number_of_values) && IO_stream_read_number_token(stream, token) &&
+			IO_stream_parse_double_token(token, values + i))
+		{
+			i++;
+		}
+	}
+	else
+	{
+		display_message(ERROR_MESSAGE,
+			"IO_stream_read_double_values.  Invalid arguments.");
+	}
+	LEAVE;
+
+	return (i);
+}
+
+int IO_stream_read_int_values(struct IO_stream *stream, int number_of_values,
+	int *values)
+/*******************************************************************************
+DESCRIPTION :
+Reads up to <number_of_values> white space separated integers from the <stream>
+into <values> without going through IO_stream_scan. Returns the number of values
+successfully read.
+==============================================================================*/
+{
+	char token[IO_STREAM_MAXIMUM_NUMBER_TOKEN_LENGTH];
+	int i;
+
+	ENTER(IO_stream_read_int_values);
+	i = 0;
+	if (stream && (0 <= number_of_values) && values)
+	{
+		while ((i < number_of_values) && IO_stream_read_number_token(stream, token) &&
+			IO_stream_parse_int_token(token, values + i))
+		{
+			i++;
+		}
+	}
+	else
+	{
+		display_message(ERROR_MESSAGE,
+			"IO_stream_read_int_values.  Invalid arguments.");
+	}
+	LEAVE;
+
+	return (i);
+}
+
 int IO_stream_fread(struct IO_stream *stream, void *ptr, size_t size, size_t nmemb)
 /*******************************************************************************
 LAST MODIFIED : 28 March 2007
@@ -1192,7 +1589,8 @@ parameters so the stream is first).
 ==============================================================================*/
 {
 	char *memptr;
-	int bytes_this_copy, eof, items_to_read, items_this_copy, return_code;
+	int bytes_available, bytes_this_copy, eof, items_to_read, items_this_copy,
+		previous_bytes_available, return_code;
 
 	ENTER(IO_stream_fread);
 
@@ -1214,19 +1612,22 @@ parameters so the stream is first).
 				memptr = (char *)ptr;
 				while (items_to_read && !eof)
 				{
+					previous_bytes_available = (stream->buffer) ?
+						(stream->buffer_valid_index - stream->buffer_index) : 0;
 					IO_stream_read_to_internal_buffer(stream);
-					if (stream->buffer_valid_index > stream->buffer_index)
+					bytes_available = stream->buffer_valid_index - stream->buffer_index;
+					/* stop if the refill added nothing and less than a whole item remains,
+						 otherwise a truncated stream would loop forever */
+					if ((0 < bytes_available) && (((unsigned)bytes_available >= size) ||
+						(bytes_available > previous_bytes_available)))
 					{
-
-						if ((unsigned)(stream->buffer_valid_index - stream->buffer_index) >=
-							(size * items_to_read))
+						if ((unsigned)bytes_available >= (size * items_to_read))
 						{
 							items_this_copy = items_to_read;
 						}
 						else
 						{
-							items_this_copy =
-								(stream->buffer_valid_index - stream->buffer_index) / size;
+							items_this_copy = bytes_available / size;
 						}
 						bytes_this_copy = items_this_copy * size;
 						memcpy(memptr, stream->buffer + stream->buffer_index,
@@ -140,6 +140,53 @@ Equivalent to a standard C fread on the stream (although I have reordered the
 parameters so the stream is first).
 ==============================================================================*/
 
+int IO_stream_read_double_values(struct IO_stream *stream, int number_of_values,
+	double *values);
+/*******************************************************************************
+DESCRIPTION :
+Reads up to <number_of_values> white space separated real numbers from the
+<stream> into <values>. Much faster than calling IO_stream_scan for each value
+as numbers are tokenised from the stream buffer and converted by hand, with
+results identical to strtod. Returns the number of values successfully read.
+==============================================================================*/
+
+int IO_stream_read_int_values(struct IO_stream *stream, int number_of_values,
+	int *values);
+/*******************************************************************************
+DESCRIPTION :
+Reads up to <number_of_values> white space separated integers from the <stream>
+into <values>. Returns the number of values successfully read.
+==============================================================================*/
+
+int IO_stream_read_number_tokens(struct IO_stream *stream, int number_of_tokens,
+	char **text_address, int *text_size_address, int *text_length_address,
+	int *token_offsets);
+/*******************************************************************************
+DESCRIPTION :
+Reads up to <number_of_tokens> white space delimited numeric tokens from the
+<stream>, appending each null terminated at *<text_length_address> in the text
+at *<text_address>, which is reallocated as needed with its allocated size in
+*<text_size_address>. The offset of each token in the text is returned in
+<token_offsets>. Lets large blocks of values be tokenised serially then
+converted with IO_stream_parse_double_token or IO_stream_parse_int_token in
+parallel. Returns the number of tokens read.
+==============================================================================*/
+
+int IO_stream_parse_double_token(const char *token, double *value);
+/*******************************************************************************
+DESCRIPTION :
+Converts the complete <token> to a double with results identical to strtod.
+Safe to call from several threads. Returns 1 on success, 0 if the token is not
+entirely a real number.
+==============================================================================*/
+
+int IO_stream_parse_int_token(const char *token, int *value);
+/*******************************************************************************
+DESCRIPTION :
+Converts the complete <token> to an int. Safe to call from several threads.
+Returns 1 on success, 0 if the token is not entirely an integer in range.
+==============================================================================*/
+
 int IO_stream_getc(struct IO_stream *stream);
 /*******************************************************************************
 LAST MODIFIED : 23 August 2004
@@ -148,6 +195,13 @@ DESCRIPTION :
 Equivalent to a standard C fgetc on the stream.
 ==============================================================================*/
 
+int IO_stream_peek_character(struct IO_stream *stream);
+/*******************************************************************************
+DESCRIPTION :
+Returns the next character in the <stream> without consuming it, or EOF at the
+end of the stream.
+==============================================================================*/
+
 int IO_stream_read_string(struct IO_stream *stream,const char *format,char **string_read);
 /******************************************************************************
 LAST MODIFIED : 23 August 2004
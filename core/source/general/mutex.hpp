@@ -0,0 +1,134 @@
+/***************************************************************************//**
+ * FILE : mutex.hpp
+ *
+ * Portable mutual exclusion lock for data shared between threads.
+ */
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is cmgui.
+ *
+ * The Initial Developer of the Original Code is
+ * Auckland Uniservices Ltd, Auckland, New Zealand.
+ * Portions created by the Initial Developer are Copyright (C) 2013
+ * the Initial Developer. All Rights Reserved.
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+#if !defined (MUTEX_HPP)
+#define MUTEX_HPP
+
+#include "zinc/zincconfigure.h"
+
+#if defined (WIN32_SYSTEM)
+#if !defined (NOMINMAX)
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif /* defined (WIN32_SYSTEM) */
+
+/***************************************************************************//**
+ * Non-recursive mutex. Unlike cmiss_spin_lock, threads waiting on it are
+ * suspended by the operating system so it may be held while doing work that
+ * is not trivially short. Must not be locked again by the thread holding it.
+ */
+class Cmiss_mutex
+{
+private:
+#if defined (WIN32_SYSTEM)
+	CRITICAL_SECTION critical_section;
+#else
+	pthread_mutex_t mutex;
+#endif /* defined (WIN32_SYSTEM) */
+
+	Cmiss_mutex(const Cmiss_mutex&); // not implemented
+	Cmiss_mutex& operator=(const Cmiss_mutex&); // not implemented
+
+public:
+	Cmiss_mutex()
+	{
+#if defined (WIN32_SYSTEM)
+		InitializeCriticalSection(&critical_section);
+#else
+		pthread_mutex_init(&mutex, 0);
+#endif /* defined (WIN32_SYSTEM) */
+	}
+
+	~Cmiss_mutex()
+	{
+#if defined (WIN32_SYSTEM)
+		DeleteCriticalSection(&critical_section);
+#else
+		pthread_mutex_destroy(&mutex);
+#endif /* defined (WIN32_SYSTEM) */
+	}
+
+	void lock()
+	{
+#if defined (WIN32_SYSTEM)
+		EnterCriticalSection(&critical_section);
+#else
+		pthread_mutex_lock(&mutex);
+#endif /* defined (WIN32_SYSTEM) */
+	}
+
+	void unlock()
+	{
+#if defined (WIN32_SYSTEM)
+		LeaveCriticalSection(&critical_section);
+#else
+		pthread_mutex_unlock(&mutex);
+#endif /* defined (WIN32_SYSTEM) */
+	}
+};
+
+/***************************************************************************//**
+ * Locks mutex for the lifetime of this object, so it is released on every
+ * return path from the enclosing scope.
+ */
+class Cmiss_mutex_scoped_lock
+{
+private:
+	Cmiss_mutex& mutex;
+
+	Cmiss_mutex_scoped_lock(const Cmiss_mutex_scoped_lock&); // not implemented
+	Cmiss_mutex_scoped_lock& operator=(const Cmiss_mutex_scoped_lock&); // not implemented
+
+public:
+	explicit Cmiss_mutex_scoped_lock(Cmiss_mutex& mutex_in) :
+		mutex(mutex_in)
+	{
+		mutex.lock();
+	}
+
+	~Cmiss_mutex_scoped_lock()
+	{
+		mutex.unlock();
+	}
+};
+
+#endif /* !defined (MUTEX_HPP) */
@@ -59,6 +59,7 @@ TO DO :
 #define OBJECT_H
 
 #include <string.h>
+#include "general/atomic.h"
 /* this is needed for the default copy object method, which uses memcpy */
 
 /*
@@ -364,4 +365,96 @@ DECLARE_ACCESS_OBJECT_FUNCTION(object_type) \
 DECLARE_DEACCESS_OBJECT_FUNCTION(object_type) \
 DECLARE_REACCESS_OBJECT_FUNCTION(object_type)
 
+/* Atomic variants of the above, for objects whose access_count may be changed
+ * concurrently from several threads e.g. during multithreaded field evaluation.
+ * The access_count member must be a plain int. */
+
+#define DECLARE_ATOMIC_ACCESS_OBJECT_FUNCTION( object_type ) \
+PROTOTYPE_ACCESS_OBJECT_FUNCTION(object_type) \
+{ \
+	ENTER(ACCESS(object_type)); \
+	if (object) \
+	{ \
+		cmiss_atomic_increment(&(object->access_count)); \
+	} \
+	else \
+	{ \
+		display_message(ERROR_MESSAGE, \
+			"ACCESS(" #object_type ").  Invalid argument"); \
+	} \
+	LEAVE; \
+\
+	return (object); \
+} /* ACCESS(object_type) */
+
+#define DECLARE_ATOMIC_DEACCESS_OBJECT_FUNCTION( object_type ) \
+PROTOTYPE_DEACCESS_OBJECT_FUNCTION(object_type) \
+{ \
+	int return_code; \
+	struct object_type *object; \
+\
+	ENTER(DEACCESS(object_type)); \
+	if (object_address && (object = *object_address)) \
+	{ \
+		if (cmiss_atomic_decrement(&(object->access_count)) <= 0) \
+		{ \
+			return_code = DESTROY(object_type)(object_address); \
+		} \
+		else \
+		{ \
+			return_code = 1; \
+		} \
+		*object_address = (struct object_type *)NULL; \
+	} \
+	else \
+	{ \
+		return_code = 0; \
+	} \
+	LEAVE; \
+\
+	return (return_code); \
+} /* DEACCESS(object_type) */
+
+#define DECLARE_ATOMIC_REACCESS_OBJECT_FUNCTION( object_type ) \
+PROTOTYPE_REACCESS_OBJECT_FUNCTION(object_type) \
+{ \
+	int return_code; \
+	struct object_type *current_object; \
+\
+	ENTER(REACCESS(object_type)); \
+	if (object_address) \
+	{ \
+		return_code = 1; \
+		if (new_object) \
+		{ \
+			/* access the new object */ \
+			cmiss_atomic_increment(&(new_object->access_count)); \
+		} \
+		if (NULL != (current_object = *object_address)) \
+		{ \
+			/* deaccess the current object */ \
+			if (cmiss_atomic_decrement(&(current_object->access_count)) <= 0) \
+			{ \
+				DESTROY(object_type)(object_address); \
+			} \
+		} \
+		/* point to the new object */ \
+		*object_address = new_object; \
+	} \
+	else \
+	{ \
+		display_message(ERROR_MESSAGE, \
+			"REACCESS(" #object_type ").  Invalid argument"); \
+		return_code = 0; \
+	} \
+	LEAVE; \
+\
+	return (return_code); \
+} /* REACCESS(object_type) */
+
+#define DECLARE_ATOMIC_OBJECT_FUNCTIONS( object_type ) \
+DECLARE_ATOMIC_ACCESS_OBJECT_FUNCTION(object_type) \
+DECLARE_ATOMIC_DEACCESS_OBJECT_FUNCTION(object_type) \
+DECLARE_ATOMIC_REACCESS_OBJECT_FUNCTION(object_type)
+
 #endif
@@ -244,7 +244,7 @@ DESCRIPTION :
 Creates a font called <name> with the user interface dependent <font_string>.
 ==============================================================================*/
 
-DECLARE_OBJECT_FUNCTIONS(Cmiss_graphics_font)
+DECLARE_ATOMIC_OBJECT_FUNCTIONS(Cmiss_graphics_font)
 DECLARE_DEFAULT_GET_OBJECT_NAME_FUNCTION(Cmiss_graphics_font)
 
 struct Cmiss_graphics_font *CREATE(Cmiss_graphics_font)(const char *name)
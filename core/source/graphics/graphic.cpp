@@ -41,6 +41,7 @@ DESCRIPTION :
  *
  * ***** END LICENSE BLOCK ***** */
 #include <string>
+#include <vector>
 
 #include "zinc/zincconfigure.h"
 
@@ -53,6 +54,7 @@ DESCRIPTION :
 #include "zinc/graphicsfilter.h"
 #include "zinc/fieldsubobjectgroup.h"
 #include "zinc/node.h"
+#include "zinc/status.h"
 #include "general/debug.h"
 #include "general/enumerator_private.hpp"
 #include "general/indexed_list_private.h"
@@ -81,6 +83,8 @@ DESCRIPTION :
 #include "general/message.h"
 #include "general/enumerator_conversion.hpp"
 #include "graphics/graphics_coordinate_system.hpp"
+#include "graphics/graphics_object.hpp"
+#include "graphics/graphics_object_pick.hpp"
 #include "graphics/render_gl.h"
 #include "graphics/tessellation.hpp"
 #include "computed_field/computed_field_subobject_group_private.hpp"
@@ -101,6 +105,217 @@ struct Cmiss_graphic_select_graphics_data
 	struct Cmiss_graphic *graphic;
 };
 
+/***************************************************************************//**
+ * Level of detail state for a graphic whose tessellation has a screen error
+ * tolerance: the projection from local coordinates to pixels in the level of
+ * detail viewer, the level chosen for each element when last built, and the
+ * surfaces of elements at levels no longer drawn, so they are not regenerated
+ * if the view returns to them.
+ */
+struct Cmiss_graphic_level_of_detail
+{
+	typedef std::map<std::pair<int, int>, GT_surface *> Surface_cache;
+
+	double local_to_pixel[16];
+	/* false if the last build did not vary levels, e.g. for linear elements */
+	bool levels_in_use;
+	std::map<int, int> element_levels;
+	/* keyed by level then element number */
+	Surface_cache cached_surfaces;
+
+	Cmiss_graphic_level_of_detail(const double *local_to_pixel_in) :
+		levels_in_use(true)
+	{
+		memcpy(local_to_pixel, local_to_pixel_in, 16*sizeof(double));
+	}
+
+	~Cmiss_graphic_level_of_detail()
+	{
+		clear_cache();
+	}
+
+	void clear_cache()
+	{
+		for (Surface_cache::iterator iter = cached_surfaces.begin();
+			iter != cached_surfaces.end(); ++iter)
+		{
+			DESTROY(GT_surface)(&(iter->second));
+		}
+		cached_surfaces.clear();
+	}
+
+	void clear()
+	{
+		clear_cache();
+		element_levels.clear();
+	}
+
+	/** Caches surface for element at level, replacing any already cached */
+	void cache_surface(int level, int element_number, GT_surface *surface)
+	{
+		GT_surface *&cached_surface = cached_surfaces[std::make_pair(level, element_number)];
+		if (cached_surface)
+		{
+			DESTROY(GT_surface)(&cached_surface);
+		}
+		cached_surface = surface;
+	}
+
+	/** @return  Surface cached for element at level, removed from cache, or NULL */
+	GT_surface *take_cached_surface(int level, int element_number)
+	{
+		GT_surface *surface = 0;
+		Surface_cache::iterator iter = cached_surfaces.find(std::make_pair(level, element_number));
+		if (iter != cached_surfaces.end())
+		{
+			surface = iter->second;
+			cached_surfaces.erase(iter);
+		}
+		return surface;
+	}
+};
+
+/***************************************************************************//**
+ * Graphics objects built for a time-dependent graphic at previous times, so
+ * playing through the same times again reuses them instead of regenerating
+ * the graphics. Times closer than a small relative tolerance are treated as
+ * the same so times reached by different routes match.
+ */
+struct Cmiss_graphic_time_cache
+{
+	struct Entry
+	{
+		GT_object *graphics_object;
+		size_t memory_size;
+		/* set if the display list needs recompiling when next used, e.g. after
+			the selection changes */
+		bool recompile;
+	};
+	typedef std::map<double, Entry> Entry_map;
+
+	Entry_map entries;
+	size_t memory_size;
+
+	Cmiss_graphic_time_cache() :
+		memory_size(0)
+	{
+	}
+
+	~Cmiss_graphic_time_cache()
+	{
+		clear();
+	}
+
+	static double tolerance(double time)
+	{
+		return 1.0E-9*(1.0 + fabs(time));
+	}
+
+	void clear()
+	{
+		for (Entry_map::iterator iter = entries.begin(); iter != entries.end(); ++iter)
+		{
+			DEACCESS(GT_object)(&(iter->second.graphics_object));
+		}
+		entries.clear();
+		memory_size = 0;
+	}
+
+	/** @return  Iterator for entry at time, or entries.end() if none */
+	Entry_map::iterator find(double time)
+	{
+		Entry_map::iterator iter = entries.lower_bound(time - tolerance(time));
+		if ((iter != entries.end()) && (iter->first <= (time + tolerance(time))))
+		{
+			return iter;
+		}
+		return entries.end();
+	}
+
+	/** Caches graphics_object for time, replacing any already cached */
+	void add(double time, GT_object *graphics_object)
+	{
+		Entry_map::iterator iter = find(time);
+		if (iter != entries.end())
+		{
+			if (iter->second.graphics_object == graphics_object)
+			{
+				return;
+			}
+			remove(iter);
+		}
+		Entry entry = { ACCESS(GT_object)(graphics_object),
+			GT_object_get_memory_size(graphics_object), false };
+		entries[time] = entry;
+		memory_size += entry.memory_size;
+	}
+
+	void remove(Entry_map::iterator iter)
+	{
+		memory_size -= iter->second.memory_size;
+		DEACCESS(GT_object)(&(iter->second.graphics_object));
+		entries.erase(iter);
+	}
+
+	void set_recompile()
+	{
+		for (Entry_map::iterator iter = entries.begin(); iter != entries.end(); ++iter)
+		{
+			iter->second.recompile = true;
+		}
+	}
+
+	/** @return  Iterator for entry farthest from time, excluding any at time,
+	 * or entries.end() if none */
+	Entry_map::iterator find_farthest(double time)
+	{
+		if (entries.empty())
+		{
+			return entries.end();
+		}
+		Entry_map::iterator first = entries.begin();
+		Entry_map::iterator last = entries.end();
+		--last;
+		Entry_map::iterator farthest =
+			((time - first->first) > (last->first - time)) ? first : last;
+		if (fabs(farthest->first - time) <= tolerance(time))
+		{
+			return entries.end();
+		}
+		return farthest;
+	}
+};
+
+/***************************************************************************//**
+ * @return  The graphics object to draw for the graphic: its current one, or
+ * while waiting for a deferred or incomplete rebuild the complete one it is
+ * replacing. Partly built graphics are drawn if there is none to replace.
+ */
+static struct GT_object *Cmiss_graphic_get_drawn_graphics_object(
+	struct Cmiss_graphic *graphic)
+{
+	if (graphic->graphics_incomplete && graphic->previous_graphics_object)
+	{
+		return graphic->previous_graphics_object;
+	}
+	return (graphic->graphics_object) ? graphic->graphics_object :
+		graphic->previous_graphics_object;
+}
+
+/***************************************************************************//**
+ * Discards the graphic's partly built graphics object, if any, so its build
+ * restarts from the first element. Any previous graphics are drawn meanwhile.
+ */
+static void Cmiss_graphic_discard_incomplete_graphics_object(
+	struct Cmiss_graphic *graphic)
+{
+	if (graphic->graphics_incomplete)
+	{
+		DEACCESS(GT_object)(&(graphic->graphics_object));
+		graphic->graphics_incomplete = 0;
+	}
+}
+
 enum Cmiss_graphic_change
 {
 	CMISS_GRAPHIC_CHANGE_NONE = 0,
@@ -129,13 +344,38 @@ static int Cmiss_graphic_changed(struct Cmiss_graphic *graphic,
 		case CMISS_GRAPHIC_CHANGE_RECOMPILE:
 		case CMISS_GRAPHIC_CHANGE_SELECTION:
 			graphic->selected_graphics_changed = 1;
+			if (graphic->time_cache)
+			{
+				graphic->time_cache->set_recompile();
+			}
 			break;
 		case CMISS_GRAPHIC_CHANGE_PARTIAL_REBUILD:
 			// partial removal of graphics should have been done by caller
+			// but elements not built yet would be missed, so start again
+			Cmiss_graphic_discard_incomplete_graphics_object(graphic);
 			graphic->graphics_changed = 1;
+			// graphics cached for other times are out of date
+			if (graphic->time_cache)
+			{
+				graphic->time_cache->clear();
+			}
+			// cached surfaces at other levels of detail may be for changed elements
+			if (graphic->level_of_detail)
+			{
+				graphic->level_of_detail->clear_cache();
+			}
 			break;
 		case CMISS_GRAPHIC_CHANGE_FULL_REBUILD:
+			Cmiss_graphic_discard_incomplete_graphics_object(graphic);
 			graphic->graphics_changed = 1;
+			if (graphic->level_of_detail)
+			{
+				graphic->level_of_detail->clear();
+			}
+			if (graphic->time_cache)
+			{
+				graphic->time_cache->clear();
+			}
 			if (graphic->graphics_object)
 			{
 				// Following cannot handle change of GT_object type for isosurface, streamline
@@ -143,7 +383,20 @@ static int Cmiss_graphic_changed(struct Cmiss_graphic *graphic,
 				//	graphic->graphics_object, /*time*/0.0,
 				//	(GT_object_primitive_object_name_conditional_function *)NULL,
 				//	(void *)NULL);
-				DEACCESS(GT_object)(&(graphic->graphics_object));
+				if (Cmiss_rendition_defers_rebuilds(graphic->rendition))
+				{
+					/* keep drawing the old graphics until rebuilt */
+					if (graphic->previous_graphics_object)
+					{
+						DEACCESS(GT_object)(&(graphic->previous_graphics_object));
+					}
+					graphic->previous_graphics_object = graphic->graphics_object;
+					graphic->graphics_object = (struct GT_object *)NULL;
+				}
+				else
+				{
+					DEACCESS(GT_object)(&(graphic->graphics_object));
+				}
 			}
 			break;
 		default:
@@ -454,9 +707,17 @@ Allocates memory for a Cmiss_graphic and initialises its members.
 
 			/* rendering information defaults */
 			graphic->graphics_object = (struct GT_object *)NULL;
+			graphic->previous_graphics_object = (struct GT_object *)NULL;
+			graphic->graphics_incomplete = 0;
+			graphic->resume_element_identifier = 0;
 			graphic->graphics_changed = 1;
 			graphic->selected_graphics_changed = 0;
 			graphic->time_dependent = 0;
+			graphic->number_of_threads = 1;
+			graphic->shared_vertices = 0;
+			graphic->level_of_detail = NULL;
+			graphic->graphics_object_time = 0.0;
+			graphic->time_cache = NULL;
 
 			graphic->access_count=1;
 		}
@@ -564,6 +825,12 @@ int DESTROY(Cmiss_graphic)(
 		{
 			DEACCESS(Cmiss_tessellation)(&(graphic->tessellation));
 		}
+		delete graphic->level_of_detail;
+		delete graphic->time_cache;
+		if (graphic->previous_graphics_object)
+		{
+			DEACCESS(GT_object)(&(graphic->previous_graphics_object));
+		}
 		if (graphic->stream_vector_field)
 		{
 			DEACCESS(Computed_field)(&(graphic->stream_vector_field));
@@ -701,6 +968,98 @@ int Cmiss_element_conditional_field_is_true(Cmiss_element_id element,
 	return 0;
 }
 
+/***************************************************************************//**
+ * @return  1 if the graphic chooses element divisions from the level of detail
+ * viewer, i.e. it is a line, surface or cylinder in local or world coordinates
+ * with a tessellation having a screen error tolerance, otherwise 0.
+ */
+static int Cmiss_graphic_uses_level_of_detail(struct Cmiss_graphic *graphic)
+{
+	return ((CMISS_GRAPHIC_LINES == graphic->graphic_type) ||
+			(CMISS_GRAPHIC_SURFACES == graphic->graphic_type) ||
+			(CMISS_GRAPHIC_CYLINDERS == graphic->graphic_type)) &&
+		((CMISS_GRAPHICS_COORDINATE_SYSTEM_LOCAL == graphic->coordinate_system) ||
+			(CMISS_GRAPHICS_COORDINATE_SYSTEM_WORLD == graphic->coordinate_system)) &&
+		graphic->tessellation &&
+		(0.0 < Cmiss_tessellation_get_screen_error_tolerance(graphic->tessellation));
+}
+
+/***************************************************************************//**
+ * @return  1 if the graphic's elements are each drawn as separate surfaces so
+ * that only those changing level of detail need be regenerated. Surfaces
+ * packed into a vertex array are not cached per level so are fully rebuilt.
+ */
+static int Cmiss_graphic_edits_level_of_detail(struct Cmiss_graphic *graphic)
+{
+	return (CMISS_GRAPHIC_CYLINDERS == graphic->graphic_type) ||
+		((CMISS_GRAPHIC_SURFACES == graphic->graphic_type) && graphic->graphics_object &&
+			(g_SURFACE == GT_object_get_type(graphic->graphics_object)));
+}
+
+/***************************************************************************//**
+ * Chooses the level of detail for element from the projected deviation of the
+ * coordinate field along the centre line in each xi direction from the chord
+ * between its ends. Parts behind the viewer get the finest level.
+ * @return  Level of detail >= 1.
+ */
+static int FE_element_get_level_of_detail(struct FE_element *element,
+	Cmiss_graphic_to_graphics_object_data *graphic_to_object_data)
+{
+	const double *projection = graphic_to_object_data->level_of_detail_projection;
+	const int element_dimension = get_FE_element_dimension(element);
+	int number_of_components = Cmiss_field_get_number_of_components(
+		graphic_to_object_data->rc_coordinate_field);
+	if (number_of_components > 3)
+	{
+		number_of_components = 3;
+	}
+	double screen_errors[MAXIMUM_ELEMENT_XI_DIMENSIONS];
+	for (int i = 0; i < element_dimension; i++)
+	{
+		FE_value xi[MAXIMUM_ELEMENT_XI_DIMENSIONS];
+		for (int j = 0; j < element_dimension; j++)
+		{
+			xi[j] = 0.5;
+		}
+		double pixel[3][2];
+		screen_errors[i] = 0.0;
+		for (int p = 0; p < 3; p++)
+		{
+			xi[i] = 0.5*(FE_value)p;
+			FE_value coordinates[3] = { 0.0, 0.0, 0.0 };
+			if (!(Cmiss_field_cache_set_mesh_location(graphic_to_object_data->field_cache,
+					element, element_dimension, xi) &&
+				Cmiss_field_evaluate_real(graphic_to_object_data->rc_coordinate_field,
+					graphic_to_object_data->field_cache, number_of_components, coordinates)))
+			{
+				// can't measure: let the tessellation use full refinement
+				screen_errors[i] = HUGE_VAL;
+				break;
+			}
+			const double w = projection[12]*coordinates[0] + projection[13]*coordinates[1] +
+				projection[14]*coordinates[2] + projection[15];
+			if (w <= 0.0)
+			{
+				screen_errors[i] = HUGE_VAL;
+				break;
+			}
+			for (int k = 0; k < 2; k++)
+			{
+				pixel[p][k] = (projection[k*4]*coordinates[0] + projection[k*4 + 1]*coordinates[1] +
+					projection[k*4 + 2]*coordinates[2] + projection[k*4 + 3]) / w;
+			}
+		}
+		if (0.0 == screen_errors[i])
+		{
+			const double dx = pixel[1][0] - 0.5*(pixel[0][0] + pixel[2][0]);
+			const double dy = pixel[1][1] - 0.5*(pixel[0][1] + pixel[2][1]);
+			screen_errors[i] = sqrt(dx*dx + dy*dy);
+		}
+	}
+	return Cmiss_tessellation_get_level_of_detail(graphic_to_object_data->graphic->tessellation,
+		element_dimension, screen_errors);
+}
+
 /***************************************************************************//**
  * Converts a finite element into a graphics object with the supplied graphic.
  * @param element  The Cmiss_element.
@@ -732,14 +1091,16 @@ static int FE_element_to_graphics_object(struct FE_element *element,
 	ENTER(FE_element_to_graphics_object);
 	if (element && graphic_to_object_data &&
 		(NULL != (graphic = graphic_to_object_data->graphic)) &&
-		graphic->graphics_object)
+		graphic_to_object_data->graphics_object)
 	{
 		element_dimension = get_FE_element_dimension(element);
 		return_code = 1;
 		get_FE_element_identifier(element, &cm);
 		element_graphics_name = cm.number;
-		/* proceed only if graphic uses this element */
-		int draw_element = 1;
+		/* proceed only if graphic uses this element and its graphics were not
+			kept from the previous build */
+		int draw_element = !(graphic_to_object_data->existing_element_names &&
+			(0 < graphic_to_object_data->existing_element_names->count(element_graphics_name)));
 		Cmiss_element_conditional_field_data conditional_field_data = { graphic_to_object_data->field_cache, graphic->subgroup_field };
 		if (draw_element)
 		{
@@ -774,6 +1135,8 @@ static int FE_element_to_graphics_object(struct FE_element *element,
 		}
 		if (draw_element)
 		{
+			/* g_element renditions use only one time = 0.0. Must take care. */
+			time = 0.0;
 			/* determine discretization of element for graphic */
 			// copy top_level_number_in_xi since scaled by native_discretization in
 			// get_FE_element_discretization
@@ -782,6 +1145,47 @@ static int FE_element_to_graphics_object(struct FE_element *element,
 			{
 				top_level_number_in_xi[dim] = graphic_to_object_data->top_level_number_in_xi[dim];
 			}
+			/* surface of element at its new level of detail cached from an earlier view */
+			struct GT_surface *level_of_detail_surface = (struct GT_surface *)NULL;
+			if (graphic_to_object_data->level_of_detail_projection)
+			{
+				const int level = FE_element_get_level_of_detail(element, graphic_to_object_data);
+				for (int dim = 0; dim < MAXIMUM_ELEMENT_XI_DIMENSIONS; dim++)
+				{
+					top_level_number_in_xi[dim] = graphic_to_object_data->minimum_number_in_xi[dim]*
+						((level < graphic_to_object_data->refinement_factors[dim]) ?
+							level : graphic_to_object_data->refinement_factors[dim]);
+				}
+				std::map<int, int>::iterator level_iter =
+					graphic_to_object_data->element_levels->find(element_graphics_name);
+				if (graphic_to_object_data->existing_graphics &&
+					Cmiss_graphic_edits_level_of_detail(graphic) &&
+					((level_iter == graphic_to_object_data->element_levels->end()) ||
+						(level_iter->second != level)))
+				{
+					/* existing surfaces are in element order, so any for this element
+						are first; move them to the cache if their level is known */
+					struct GT_surface *old_surface =
+						GT_OBJECT_EXTRACT_FIRST_PRIMITIVES_AT_TIME(GT_surface)(
+							graphic_to_object_data->existing_graphics, time,
+							element_graphics_name);
+					if (old_surface)
+					{
+						if (level_iter != graphic_to_object_data->element_levels->end())
+						{
+							graphic->level_of_detail->cache_surface(level_iter->second,
+								element_graphics_name, old_surface);
+						}
+						else
+						{
+							DESTROY(GT_surface)(&old_surface);
+						}
+					}
+					level_of_detail_surface = graphic->level_of_detail->take_cached_surface(
+						level, element_graphics_name);
+				}
+				(*(graphic_to_object_data->element_levels))[element_graphics_name] = level;
+			}
 			top_level_element = (struct FE_element *)NULL;
 			native_discretization_field = graphic->native_discretization_field;
 
@@ -791,21 +1195,15 @@ static int FE_element_to_graphics_object(struct FE_element *element,
 				graphic->face, native_discretization_field, top_level_number_in_xi,
 				&top_level_element, number_in_xi))
 			{
-				/* g_element renditions use only one time = 0.0. Must take care. */
-				time = 0.0;
 				switch (graphic->graphic_type)
 				{
 					case CMISS_GRAPHIC_LINES:
 					{
-						if (graphic_to_object_data->existing_graphics)
-						{
-							/* So far ignore these */
-						}
 						if (draw_element)
 						{
 							return_code = FE_element_add_line_to_vertex_array(
 								element, graphic_to_object_data->field_cache,
-								GT_object_get_vertex_set(graphic->graphics_object),
+								GT_object_get_vertex_set(graphic_to_object_data->graphics_object),
 								graphic_to_object_data->rc_coordinate_field,
 								graphic->data_field,
 								graphic_to_object_data->number_of_data_values,
@@ -817,7 +1215,12 @@ static int FE_element_to_graphics_object(struct FE_element *element,
 					} break;
 					case CMISS_GRAPHIC_CYLINDERS:
 					{
-						if (graphic_to_object_data->existing_graphics)
+						if (level_of_detail_surface)
+						{
+							surface = level_of_detail_surface;
+							level_of_detail_surface = (struct GT_surface *)NULL;
+						}
+						else if (graphic_to_object_data->existing_graphics)
 						{
 							surface = GT_OBJECT_EXTRACT_FIRST_PRIMITIVES_AT_TIME(GT_surface)
 								(graphic_to_object_data->existing_graphics, time,
@@ -843,7 +1246,7 @@ static int FE_element_to_graphics_object(struct FE_element *element,
 									graphic_to_object_data->time)))
 							{
 								if (!GT_OBJECT_ADD(GT_surface)(
-									graphic->graphics_object, time, surface))
+									graphic_to_object_data->graphics_object, time, surface))
 								{
 									DESTROY(GT_surface)(&surface);
 									return_code = 0;
@@ -864,7 +1267,25 @@ static int FE_element_to_graphics_object(struct FE_element *element,
 					} break;
 					case CMISS_GRAPHIC_SURFACES:
 					{
-						if (graphic_to_object_data->existing_graphics)
+						if (graphic_to_object_data->surface_mesh_builder)
+						{
+							/* shared vertex surfaces are always fully rebuilt */
+							if (draw_element)
+							{
+								return_code = FE_element_add_surface_to_mesh_builder(
+									element, graphic_to_object_data->field_cache,
+									graphic_to_object_data->surface_mesh_builder,
+									number_in_xi[0], number_in_xi[1], top_level_element,
+									graphic_to_object_data->time);
+							}
+							break;
+						}
+						if (level_of_detail_surface)
+						{
+							surface = level_of_detail_surface;
+							level_of_detail_surface = (struct GT_surface *)NULL;
+						}
+						else if (graphic_to_object_data->existing_graphics)
 						{
 							surface = GT_OBJECT_EXTRACT_FIRST_PRIMITIVES_AT_TIME(GT_surface)
 								(graphic_to_object_data->existing_graphics, time,
@@ -886,8 +1307,19 @@ static int FE_element_to_graphics_object(struct FE_element *element,
 									/*reverse_normals*/0, top_level_element,graphic->render_type,
 									graphic_to_object_data->time)))
 							{
-								if (!GT_OBJECT_ADD(GT_surface)(
-									graphic->graphics_object, time, surface))
+								if (g_SURFACE_VERTEX_BUFFERS ==
+									GT_object_get_type(graphic_to_object_data->graphics_object))
+								{
+									/* pack into the element's range of the vertex array */
+									if (!GT_object_add_surface_to_vertex_array(
+										graphic_to_object_data->graphics_object, surface))
+									{
+										return_code = 0;
+									}
+									DESTROY(GT_surface)(&surface);
+								}
+								else if (!GT_OBJECT_ADD(GT_surface)(
+									graphic_to_object_data->graphics_object, time, surface))
 								{
 									DESTROY(GT_surface)(&surface);
 									return_code = 0;
@@ -908,7 +1340,7 @@ static int FE_element_to_graphics_object(struct FE_element *element,
 					} break;
 					case CMISS_GRAPHIC_ISO_SURFACES:
 					{
-						switch (GT_object_get_type(graphic->graphics_object))
+						switch (GT_object_get_type(graphic_to_object_data->graphics_object))
 						{
 							case g_SURFACE:
 							{
@@ -929,7 +1361,7 @@ static int FE_element_to_graphics_object(struct FE_element *element,
 										if (NULL != surface)
 										{
 											if (!GT_OBJECT_ADD(GT_surface)(
-												graphic->graphics_object, time, surface))
+												graphic_to_object_data->graphics_object, time, surface))
 											{
 												DESTROY(GT_surface)(&surface);
 												return_code = 0;
@@ -942,7 +1374,7 @@ static int FE_element_to_graphics_object(struct FE_element *element,
 												graphic_to_object_data->master_mesh,
 												graphic_to_object_data->time, number_in_xi,
 												graphic_to_object_data->iso_surface_specification,
-												graphic->graphics_object,
+												graphic_to_object_data->graphics_object,
 												graphic->render_type);
 										}
 									}
@@ -975,7 +1407,7 @@ static int FE_element_to_graphics_object(struct FE_element *element,
 										if (polyline)
 										{
 											if (!GT_OBJECT_ADD(GT_polyline)(
-												graphic->graphics_object, time, polyline))
+												graphic_to_object_data->graphics_object, time, polyline))
 											{
 												DESTROY(GT_polyline)(&polyline);
 												return_code = 0;
@@ -992,7 +1424,7 @@ static int FE_element_to_graphics_object(struct FE_element *element,
 														graphic_to_object_data->rc_coordinate_field,
 														graphic->iso_scalar_field, graphic->iso_values[i],
 														graphic->data_field, number_in_xi[0], number_in_xi[1],
-														top_level_element, graphic->graphics_object,
+														top_level_element, graphic_to_object_data->graphics_object,
 														graphic->line_width);
 												}
 											}
@@ -1019,7 +1451,7 @@ static int FE_element_to_graphics_object(struct FE_element *element,
 														graphic_to_object_data->rc_coordinate_field,
 														graphic->iso_scalar_field, iso_value,
 														graphic->data_field, number_in_xi[0], number_in_xi[1],
-														top_level_element, graphic->graphics_object,
+														top_level_element, graphic_to_object_data->graphics_object,
 														graphic->line_width);
 												}
 											}
@@ -1156,7 +1588,7 @@ static int FE_element_to_graphics_object(struct FE_element *element,
 							if (glyph_set)
 							{
 								if (!GT_OBJECT_ADD(GT_glyph_set)(
-									graphic->graphics_object,time,glyph_set))
+									graphic_to_object_data->graphics_object,time,glyph_set))
 								{
 									DESTROY(GT_glyph_set)(&glyph_set);
 									return_code = 0;
@@ -1205,7 +1637,7 @@ static int FE_element_to_graphics_object(struct FE_element *element,
 											graphic->streamline_data_type, graphic->data_field,
 											graphic_to_object_data->fe_region)))
 									{
-										if (!GT_OBJECT_ADD(GT_polyline)(graphic->graphics_object,
+										if (!GT_OBJECT_ADD(GT_polyline)(graphic_to_object_data->graphics_object,
 											time, polyline))
 										{
 											DESTROY(GT_polyline)(&polyline);
@@ -1232,7 +1664,7 @@ static int FE_element_to_graphics_object(struct FE_element *element,
 											graphic->streamline_data_type, graphic->data_field,
 											graphic_to_object_data->fe_region)))
 									{
-										if (!GT_OBJECT_ADD(GT_surface)(graphic->graphics_object,
+										if (!GT_OBJECT_ADD(GT_surface)(graphic_to_object_data->graphics_object,
 											time, surface))
 										{
 											DESTROY(GT_surface)(&surface);
@@ -1268,6 +1700,10 @@ static int FE_element_to_graphics_object(struct FE_element *element,
 					"FE_element_to_graphics_object.  Could not get discretization");
 				return_code = 0;
 			}
+			if (level_of_detail_surface)
+			{
+				DESTROY(GT_surface)(&level_of_detail_surface);
+			}
 		}
 	}
 	else
@@ -1997,17 +2433,19 @@ int Cmiss_graphic_update_non_trivial_GT_objects(struct Cmiss_graphic *graphic)
 	int return_code = 0;
 
 	ENTER(Cmiss_graphic_update_non_trivial_GT_objects);
-	if (graphic && graphic->graphics_object)
+	struct GT_object *graphics_object = (graphic) ?
+		Cmiss_graphic_get_drawn_graphics_object(graphic) : (struct GT_object *)NULL;
+	if (graphics_object)
 	{
-		set_GT_object_default_material(graphic->graphics_object,
+		set_GT_object_default_material(graphics_object,
 			graphic->material);
-		set_GT_object_secondary_material(graphic->graphics_object,
+		set_GT_object_secondary_material(graphics_object,
 			graphic->secondary_material);
-		set_GT_object_selected_material(graphic->graphics_object,
+		set_GT_object_selected_material(graphics_object,
 			graphic->selected_material);
 		if (graphic->data_field && graphic->spectrum)
 		{
-			set_GT_object_Spectrum(graphic->graphics_object,
+			set_GT_object_Spectrum(graphics_object,
 				(void *)graphic->spectrum);
 		}
 		return_code = 1;
@@ -2913,11 +3351,34 @@ static int Cad_shape_to_graphics_object(struct Computed_field *field,
 				{
 					return_code = 1;
 				}
+				const bool vertex_buffers =
+					(g_SURFACE_VERTEX_BUFFERS == GT_object_get_type(graphic->graphics_object));
+				if (vertex_buffers && return_code)
+				{
+					/* cad surfaces are not named by element so are always fully rebuilt */
+					GT_object_remove_primitives_at_time(graphic->graphics_object, time,
+						(GT_object_primitive_object_name_conditional_function *)NULL, (void *)NULL);
+					GT_surface_vertex_buffers *surfaces = CREATE(GT_surface_vertex_buffers)(
+						g_SHADED_TEXMAP, graphic->render_type);
+					if (!GT_OBJECT_ADD(GT_surface_vertex_buffers)(graphic->graphics_object, surfaces))
+					{
+						if (surfaces)
+						{
+							DESTROY(GT_surface_vertex_buffers)(&surfaces);
+						}
+						return_code = 0;
+					}
+				}
 				for (int i = 0; i < surface_count && return_code; i++)
 				{
 					Cmiss_cad_surface_identifier identifier = i;
 					struct GT_surface *surface = create_surface_from_cad_shape(cad_topology, graphic_to_object_data->field_cache, graphic_to_object_data->rc_coordinate_field, graphic->data_field, graphic->render_type, identifier);
-					if (surface && GT_OBJECT_ADD(GT_surface)(graphic->graphics_object, time, surface))
+					if (surface && vertex_buffers)
+					{
+						return_code = GT_object_add_surface_to_vertex_array(graphic->graphics_object, surface);
+						DESTROY(GT_surface)(&surface);
+					}
+					else if (surface && GT_OBJECT_ADD(GT_surface)(graphic->graphics_object, time, surface))
 					{
 						//printf( "Surface added to graphics object\n" );
 						return_code = 1;
@@ -2937,6 +3398,9 @@ static int Cad_shape_to_graphics_object(struct Computed_field *field,
 					CREATE(GT_polyline_vertex_buffers)(
 					g_PLAIN, settings->line_width);
 				*/
+				/* cad curves are not named by element so are always fully rebuilt */
+				GT_object_remove_primitives_at_time(graphic->graphics_object, time,
+					(GT_object_primitive_object_name_conditional_function *)NULL, (void *)NULL);
 				GT_polyline_vertex_buffers *lines = create_curves_from_cad_shape(cad_topology, graphic_to_object_data->field_cache, graphic_to_object_data->rc_coordinate_field, graphic->data_field, graphic->graphics_object);
 				if (lines && GT_OBJECT_ADD(GT_polyline_vertex_buffers)(
 					graphic->graphics_object, lines))
@@ -3327,6 +3791,243 @@ static int Cmiss_mesh_to_graphics(Cmiss_mesh_id mesh, Cmiss_graphic_to_graphics_
 	return return_code;
 }
 
+/***************************************************************************//**
+ * Converts the elements to graphics, splitting them into contiguous chunks
+ * which are generated in parallel, each with its own field cache and
+ * temporary graphics object. Chunk primitives are then appended to the
+ * graphic's graphics object in element order, giving the same result as
+ * converting them serially. Only valid for graphic types which add independent
+ * primitives per element, and when not editing existing graphics.
+ * Parallel execution requires build with USE_OPENMP; otherwise chunks are
+ * generated serially.
+ * @param elements  Array of the elements to convert.
+ * @param number_of_elements  Size of the elements array.
+ * @param graphic_to_object_data  Data for converting finite element to graphics.
+ * @param number_of_threads  Maximum number of chunks/threads to use.
+ * @return  1 on success, 0 on failure.
+ */
+static int Cmiss_elements_to_graphics_parallel(Cmiss_element_id *elements,
+	int number_of_elements, Cmiss_graphic_to_graphics_object_data *graphic_to_object_data,
+	int number_of_threads)
+{
+	if (number_of_threads > number_of_elements)
+	{
+		number_of_threads = number_of_elements;
+	}
+	if (number_of_threads < 2)
+	{
+		for (int i = 0; i < number_of_elements; ++i)
+		{
+			if (!FE_element_to_graphics_object(elements[i], graphic_to_object_data))
+			{
+				return 0;
+			}
+		}
+		return 1;
+	}
+	int return_code = 1;
+	GT_object *graphics_object = graphic_to_object_data->graphics_object;
+	std::vector<Cmiss_graphic_to_graphics_object_data> chunk_data(number_of_threads, *graphic_to_object_data);
+	std::vector<int> chunk_return_code(number_of_threads, 1);
+	// each chunk records element levels of detail separately for merging after
+	std::vector<std::map<int, int> > chunk_element_levels(number_of_threads);
+	if (graphic_to_object_data->element_levels)
+	{
+		for (int chunk = 0; chunk < number_of_threads; ++chunk)
+		{
+			chunk_data[chunk].element_levels = &(chunk_element_levels[chunk]);
+		}
+	}
+	// create caches and graphics objects serially as they are registered with shared objects
+	for (int chunk = 0; chunk < number_of_threads; ++chunk)
+	{
+		chunk_data[chunk].field_cache = Cmiss_field_module_create_cache(graphic_to_object_data->field_module);
+		Cmiss_field_cache_set_time(chunk_data[chunk].field_cache, graphic_to_object_data->time);
+		chunk_data[chunk].graphics_object = CREATE(GT_object)("chunk",
+			GT_object_get_type(graphics_object), get_GT_object_default_material(graphics_object));
+		if (!(chunk_data[chunk].field_cache && chunk_data[chunk].graphics_object))
+		{
+			return_code = 0;
+		}
+	}
+	if (return_code)
+	{
+#if defined (USE_OPENMP)
+#pragma omp parallel for num_threads(number_of_threads) schedule(static, 1)
+#endif /* defined (USE_OPENMP) */
+		for (int chunk = 0; chunk < number_of_threads; ++chunk)
+		{
+			const int first = static_cast<int>((static_cast<long>(number_of_elements)*chunk) / number_of_threads);
+			const int limit = static_cast<int>((static_cast<long>(number_of_elements)*(chunk + 1)) / number_of_threads);
+			for (int i = first; i < limit; ++i)
+			{
+				if (!FE_element_to_graphics_object(elements[i], &(chunk_data[chunk])))
+				{
+					chunk_return_code[chunk] = 0;
+					break;
+				}
+			}
+		}
+	}
+	/* all primitives added at time 0.0 */
+	const ZnReal time = 0.0;
+	for (int chunk = 0; chunk < number_of_threads; ++chunk)
+	{
+		if (!chunk_return_code[chunk])
+		{
+			return_code = 0;
+		}
+		if (graphic_to_object_data->element_levels)
+		{
+			graphic_to_object_data->element_levels->insert(
+				chunk_element_levels[chunk].begin(), chunk_element_levels[chunk].end());
+		}
+		if (chunk_data[chunk].graphics_object)
+		{
+			if (return_code && GT_object_has_primitives_at_time(chunk_data[chunk].graphics_object, time))
+			{
+				if (!GT_object_transfer_primitives_at_time(graphics_object, chunk_data[chunk].graphics_object, time))
+				{
+					return_code = 0;
+				}
+			}
+			DESTROY(GT_object)(&(chunk_data[chunk].graphics_object));
+		}
+		if (chunk_data[chunk].field_cache)
+		{
+			Cmiss_field_cache_destroy(&(chunk_data[chunk].field_cache));
+		}
+	}
+	return return_code;
+}
+
+/***************************************************************************//**
+ * @return  New set of the identifiers of the primitives in the vertex array of
+ * graphics_object, i.e. the names of the elements whose graphics it holds.
+ * Caller must delete.
+ */
+static std::set<int> *GT_object_create_vertex_array_identifier_set(
+	struct GT_object *graphics_object)
+{
+	std::set<int> *identifiers = new std::set<int>();
+	int *identifier_buffer = 0;
+	unsigned int values_per_vertex = 0, number_of_identifiers = 0;
+	Graphics_vertex_array *vertex_array = GT_object_get_vertex_set(graphics_object);
+	if (vertex_array && vertex_array->get_integer_vertex_buffer(
+		GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_ID, &identifier_buffer,
+		&values_per_vertex, &number_of_identifiers))
+	{
+		for (unsigned int i = 0; i < number_of_identifiers; ++i)
+		{
+			identifiers->insert(identifier_buffer[i*values_per_vertex]);
+		}
+	}
+	return identifiers;
+}
+
+int Cmiss_graphic_to_graphics_object_data_time_expired(
+	struct Cmiss_graphic_to_graphics_object_data *graphic_to_object_data)
+{
+	if ((!graphic_to_object_data->defer_full_rebuilds) &&
+		(0.0 < graphic_to_object_data->build_time_limit) &&
+		(0 < graphic_to_object_data->build_progress))
+	{
+		struct timeval time;
+		gettimeofday(&time, NULL);
+		const double elapsed_time =
+			static_cast<double>(time.tv_sec - graphic_to_object_data->build_start_time.tv_sec) +
+			1.0E-6*static_cast<double>(time.tv_usec - graphic_to_object_data->build_start_time.tv_usec);
+		if (elapsed_time >= graphic_to_object_data->build_time_limit)
+		{
+			graphic_to_object_data->defer_full_rebuilds = 1;
+		}
+	}
+	return graphic_to_object_data->defer_full_rebuilds;
+}
+
+/***************************************************************************//**
+ * Converts the elements of the iteration mesh to graphics for a full rebuild,
+ * continuing after the elements built before an earlier build ran out of
+ * time. Elements are built in batches, in parallel if the graphic has
+ * multiple threads set. If the build time limit is reached with elements
+ * remaining, the graphic is left incomplete to resume in the next build.
+ */
+static int Cmiss_graphic_mesh_to_graphics_within_time_limit(
+	Cmiss_graphic_to_graphics_object_data *graphic_to_object_data)
+{
+	Cmiss_graphic *graphic = graphic_to_object_data->graphic;
+	std::vector<Cmiss_element_id> elements;
+	Cmiss_element_iterator_id iterator =
+		Cmiss_mesh_create_element_iterator(graphic_to_object_data->iteration_mesh);
+	Cmiss_element_id element = 0;
+	while (0 != (element = Cmiss_element_iterator_next_non_access(iterator)))
+	{
+		/* elements are iterated in identifier order */
+		if ((!graphic->graphics_incomplete) ||
+			(Cmiss_element_get_identifier(element) >= graphic->resume_element_identifier))
+		{
+			elements.push_back(element);
+		}
+	}
+	Cmiss_element_iterator_destroy(&iterator);
+	graphic->graphics_incomplete = 0;
+	const int number_of_elements = static_cast<int>(elements.size());
+	const int batch_size = 16*((1 < graphic->number_of_threads) ? graphic->number_of_threads : 1);
+	int return_code = 1;
+	for (int first = 0; first < number_of_elements; first += batch_size)
+	{
+		if (Cmiss_graphic_to_graphics_object_data_time_expired(graphic_to_object_data))
+		{
+			graphic->graphics_incomplete = 1;
+			graphic->resume_element_identifier = Cmiss_element_get_identifier(elements[first]);
+			++(graphic_to_object_data->number_of_deferred_rebuilds);
+			break;
+		}
+		const int batch_number_of_elements = (first + batch_size <= number_of_elements) ?
+			batch_size : number_of_elements - first;
+		if (!Cmiss_elements_to_graphics_parallel(&(elements[first]), batch_number_of_elements,
+			graphic_to_object_data, graphic->number_of_threads))
+		{
+			return_code = 0;
+			break;
+		}
+		graphic_to_object_data->build_progress += batch_number_of_elements;
+	}
+	return return_code;
+}
+
+/***************************************************************************//**
+ * Converts the elements of the iteration mesh to graphics, in parallel if the
+ * graphic has multiple threads set and there are no existing graphics being
+ * edited. Full rebuilds with a build time limit, or continuing an incomplete
+ * one, may stop part way through the elements.
+ */
+static int Cmiss_graphic_mesh_to_graphics(Cmiss_graphic_to_graphics_object_data *graphic_to_object_data)
+{
+	Cmiss_graphic *graphic = graphic_to_object_data->graphic;
+	if ((!(graphic_to_object_data->existing_graphics ||
+			graphic_to_object_data->existing_element_names)) &&
+		(graphic->graphics_incomplete || (0.0 < graphic_to_object_data->build_time_limit)))
+	{
+		return Cmiss_graphic_mesh_to_graphics_within_time_limit(graphic_to_object_data);
+	}
+	if ((1 < graphic->number_of_threads) && (!graphic_to_object_data->existing_graphics))
+	{
+		std::vector<Cmiss_element_id> elements;
+		Cmiss_element_iterator_id iterator =
+			Cmiss_mesh_create_element_iterator(graphic_to_object_data->iteration_mesh);
+		Cmiss_element_id element = 0;
+		while (0 != (element = Cmiss_element_iterator_next_non_access(iterator)))
+		{
+			elements.push_back(element);
+		}
+		Cmiss_element_iterator_destroy(&iterator);
+		return (elements.empty()) ? 1 : Cmiss_elements_to_graphics_parallel(&(elements[0]),
+			static_cast<int>(elements.size()), graphic_to_object_data, graphic->number_of_threads);
+	}
+	return Cmiss_mesh_to_graphics(graphic_to_object_data->iteration_mesh, graphic_to_object_data);
+}
+
 int Cmiss_graphic_to_graphics_object(
 	struct Cmiss_graphic *graphic,void *graphic_to_object_data_void)
 {
@@ -3357,7 +4058,15 @@ int Cmiss_graphic_to_graphics_object(
 			if (Cmiss_graphics_filter_evaluate_graphic(filter, graphic) &&
 				  Cmiss_graphic_has_all_compulsory_attributes(graphic))
 			{
-				if (graphic->graphics_changed)
+				/* partial rebuilds are quick so only full rebuilds are deferred */
+				const int defer_rebuild = graphic->graphics_changed &&
+					((!graphic->graphics_object) || graphic->graphics_incomplete) &&
+					Cmiss_graphic_to_graphics_object_data_time_expired(graphic_to_object_data);
+				if (defer_rebuild)
+				{
+					++(graphic_to_object_data->number_of_deferred_rebuilds);
+				}
+				if (graphic->graphics_changed && !defer_rebuild)
 				{
 					Computed_field *coordinate_field = graphic->coordinate_field;
 					if (coordinate_field ||
@@ -3417,6 +4126,7 @@ int Cmiss_graphic_to_graphics_object(
 								MAXIMUM_ELEMENT_XI_DIMENSIONS, graphic_to_object_data->top_level_number_in_xi);
 							graphic_to_object_data->existing_graphics =
 								(struct GT_object *)NULL;
+							graphic_to_object_data->existing_element_names = NULL;
 							/* work out the name the graphics object is to have */
 							char *graphics_object_name = Cmiss_graphic_get_graphics_object_name(graphic, graphic_to_object_data->name_prefix);
 							if (graphics_object_name)
@@ -3426,12 +4136,25 @@ int Cmiss_graphic_to_graphics_object(
 									/* replace the graphics object name */
 									GT_object_set_name(graphic->graphics_object,
 										graphics_object_name);
-									if (GT_object_has_primitives_at_time(graphic->graphics_object,
-										time))
+									/* incomplete graphics are continued, not edited */
+									if ((!graphic->graphics_incomplete) &&
+										GT_object_has_primitives_at_time(graphic->graphics_object, time))
 									{
 #if defined (DEBUG_CODE)
 										/*???debug*/printf("  EDIT EXISTING GRAPHICS!\n");
 #endif /* defined (DEBUG_CODE) */
+										const enum GT_object_type existing_type =
+											GT_object_get_type(graphic->graphics_object);
+										if ((g_POLYLINE_VERTEX_BUFFERS == existing_type) ||
+											(g_SURFACE_VERTEX_BUFFERS == existing_type))
+										{
+											/* primitives of unchanged elements stay in their ranges
+												of the vertex array; only build missing elements */
+											graphic_to_object_data->existing_element_names =
+												GT_object_create_vertex_array_identifier_set(graphic->graphics_object);
+										}
+										else
+										{
 										GET_NAME(GT_object)(graphic->graphics_object, &existing_name);
 										graphic_to_object_data->existing_graphics =
 											CREATE(GT_object)(existing_name,
@@ -3441,6 +4164,7 @@ int Cmiss_graphic_to_graphics_object(
 										GT_object_transfer_primitives_at_time(
 											graphic_to_object_data->existing_graphics,
 											graphic->graphics_object, time);
+										}
 									}
 								}
 								else
@@ -3452,10 +4176,18 @@ int Cmiss_graphic_to_graphics_object(
 											graphics_object_type = g_POLYLINE_VERTEX_BUFFERS;
 										} break;
 										case CMISS_GRAPHIC_CYLINDERS:
-										case CMISS_GRAPHIC_SURFACES:
 										{
 											graphics_object_type = g_SURFACE;
 										} break;
+										case CMISS_GRAPHIC_SURFACES:
+										{
+											/* texture coordinates may need tangents, and levels of
+												detail are cached per element, so keep surface lists */
+											graphics_object_type = (graphic->shared_vertices ||
+												((!graphic->texture_coordinate_field) &&
+													(!Cmiss_graphic_uses_level_of_detail(graphic)))) ?
+												g_SURFACE_VERTEX_BUFFERS : g_SURFACE;
+										} break;
 										case CMISS_GRAPHIC_ISO_SURFACES:
 										{
 											switch (dimension)
@@ -3552,6 +4284,43 @@ int Cmiss_graphic_to_graphics_object(
 								graphic->selected_graphics_changed=1;
 								/* need graphic for FE_element_to_graphics_object routine */
 								graphic_to_object_data->graphic=graphic;
+								graphic_to_object_data->graphics_object = graphic->graphics_object;
+								/* choose element divisions from the level of detail viewer
+									if the tessellation refines the elements */
+								graphic_to_object_data->level_of_detail_projection = NULL;
+								graphic_to_object_data->element_levels = NULL;
+								if (graphic->level_of_detail)
+								{
+									if (!(graphic_to_object_data->existing_graphics ||
+										graphic_to_object_data->existing_element_names ||
+										graphic->graphics_incomplete))
+									{
+										graphic->level_of_detail->clear();
+									}
+									graphic->level_of_detail->levels_in_use = false;
+									if (Cmiss_graphic_uses_level_of_detail(graphic) &&
+										Cmiss_tessellation_get_minimum_divisions(graphic->tessellation,
+											MAXIMUM_ELEMENT_XI_DIMENSIONS, graphic_to_object_data->minimum_number_in_xi))
+									{
+										for (int dim = 0; dim < MAXIMUM_ELEMENT_XI_DIMENSIONS; dim++)
+										{
+											graphic_to_object_data->refinement_factors[dim] =
+												graphic_to_object_data->top_level_number_in_xi[dim] /
+												graphic_to_object_data->minimum_number_in_xi[dim];
+											if (1 < graphic_to_object_data->refinement_factors[dim])
+											{
+												graphic->level_of_detail->levels_in_use = true;
+											}
+										}
+										if (graphic->level_of_detail->levels_in_use)
+										{
+											graphic_to_object_data->level_of_detail_projection =
+												graphic->level_of_detail->local_to_pixel;
+											graphic_to_object_data->element_levels =
+												&(graphic->level_of_detail->element_levels);
+										}
+									}
+								}
 								Cmiss_graphic_get_iteration_domain(graphic, graphic_to_object_data);
 								switch (graphic->graphic_type)
 								{
@@ -3671,21 +4440,25 @@ int Cmiss_graphic_to_graphics_object(
 										if ( domain_field_list )
 											DESTROY_LIST(Computed_field)(&domain_field_list);
 #endif /* defined(USE_OPENCASCADE) */
-										GT_polyline_vertex_buffers *lines =
-											CREATE(GT_polyline_vertex_buffers)(
-												g_PLAIN, graphic->line_width);
-										if (GT_OBJECT_ADD(GT_polyline_vertex_buffers)(
-											graphic->graphics_object, lines))
+										/* lines of unchanged elements are kept when editing */
+										if (0 == GT_object_get_number_of_times(graphic->graphics_object))
 										{
-											if (graphic_to_object_data->iteration_mesh)
+											GT_polyline_vertex_buffers *lines =
+												CREATE(GT_polyline_vertex_buffers)(
+													g_PLAIN, graphic->line_width);
+											if (!GT_OBJECT_ADD(GT_polyline_vertex_buffers)(
+												graphic->graphics_object, lines))
 											{
-												return_code = Cmiss_mesh_to_graphics(graphic_to_object_data->iteration_mesh, graphic_to_object_data);
+												if (lines)
+												{
+													DESTROY(GT_polyline_vertex_buffers)(&lines);
+												}
+												return_code = 0;
 											}
 										}
-										else
+										if (return_code && graphic_to_object_data->iteration_mesh)
 										{
-											//DESTROY(GT_polyline_vertex_buffers)(&lines);
-											return_code = 0;
+											return_code = Cmiss_graphic_mesh_to_graphics(graphic_to_object_data);
 										}
 									} break;
 									case CMISS_GRAPHIC_SURFACES:
@@ -3718,11 +4491,64 @@ int Cmiss_graphic_to_graphics_object(
 												DESTROY_LIST(Computed_field)(&domain_field_list);
 										}
 #endif /* defined(USE_OPENCASCADE) */
-										if (!cad_surfaces)
+										if ((!cad_surfaces) &&
+											(g_SURFACE_VERTEX_BUFFERS == GT_object_get_type(graphic->graphics_object)))
+										{
+											if (graphic->shared_vertices)
+											{
+												/* shared vertex surfaces are always fully rebuilt */
+												GT_object_remove_primitives_at_time(graphic->graphics_object, time,
+													(GT_object_primitive_object_name_conditional_function *)NULL,
+													(void *)NULL);
+											}
+											/* surfaces of unchanged elements are kept when editing */
+											if (0 == GT_object_get_number_of_times(graphic->graphics_object))
+											{
+												GT_surface_vertex_buffers *surfaces =
+													CREATE(GT_surface_vertex_buffers)(g_SHADED_TEXMAP,
+														graphic->render_type);
+												if (!GT_OBJECT_ADD(GT_surface_vertex_buffers)(
+													graphic->graphics_object, surfaces))
+												{
+													if (surfaces)
+													{
+														DESTROY(GT_surface_vertex_buffers)(&surfaces);
+													}
+													return_code = 0;
+												}
+											}
+											if (return_code && graphic_to_object_data->iteration_mesh)
+											{
+												if (graphic->shared_vertices)
+												{
+													graphic_to_object_data->surface_mesh_builder =
+														FE_surface_mesh_builder_create(graphic_to_object_data->master_mesh,
+															graphic_to_object_data->rc_coordinate_field,
+															graphic->texture_coordinate_field, graphic->data_field,
+															/*reverse_normals*/0);
+													// builder merges vertices in element order: keep serial
+													return_code = (0 != graphic_to_object_data->surface_mesh_builder) &&
+														Cmiss_mesh_to_graphics(graphic_to_object_data->iteration_mesh, graphic_to_object_data) &&
+														FE_surface_mesh_builder_add_to_vertex_array(
+															graphic_to_object_data->surface_mesh_builder,
+															GT_object_get_vertex_set(graphic->graphics_object));
+													if (graphic_to_object_data->surface_mesh_builder)
+													{
+														FE_surface_mesh_builder_destroy(&graphic_to_object_data->surface_mesh_builder);
+													}
+												}
+												else
+												{
+													/* each element packed into its own vertex range */
+													return_code = Cmiss_graphic_mesh_to_graphics(graphic_to_object_data);
+												}
+											}
+										}
+										else if (!cad_surfaces)
 										{
 											if (graphic_to_object_data->iteration_mesh)
 											{
-												return_code = Cmiss_mesh_to_graphics(graphic_to_object_data->iteration_mesh, graphic_to_object_data);
+												return_code = Cmiss_graphic_mesh_to_graphics(graphic_to_object_data);
 											}
 										}
 									} break;
@@ -3731,7 +4557,7 @@ int Cmiss_graphic_to_graphics_object(
 									{
 										if (graphic_to_object_data->iteration_mesh)
 										{
-											return_code = Cmiss_mesh_to_graphics(graphic_to_object_data->iteration_mesh, graphic_to_object_data);
+											return_code = Cmiss_graphic_mesh_to_graphics(graphic_to_object_data);
 										}
 									} break;
 									case CMISS_GRAPHIC_ISO_SURFACES:
@@ -3752,7 +4578,15 @@ int Cmiss_graphic_to_graphics_object(
 											}
 											if (graphic_to_object_data->iteration_mesh)
 											{
-												return_code = Cmiss_mesh_to_graphics(graphic_to_object_data->iteration_mesh, graphic_to_object_data);
+												if (g_POLYLINE == GT_object_get_type(graphic->graphics_object))
+												{
+													return_code = Cmiss_graphic_mesh_to_graphics(graphic_to_object_data);
+												}
+												else
+												{
+													// iso-surface generation uses static working storage: keep serial
+													return_code = Cmiss_mesh_to_graphics(graphic_to_object_data->iteration_mesh, graphic_to_object_data);
+												}
 											}
 											if (g_SURFACE == GT_object_get_type(graphic->graphics_object))
 											{
@@ -3835,9 +4669,28 @@ int Cmiss_graphic_to_graphics_object(
 										set_GT_object_Spectrum(graphic->graphics_object,
 											(void *)(graphic->spectrum));
 									}
-									/* mark display list as needing updating */
-									graphic->graphics_changed = 0;
-									GT_object_changed(graphic->graphics_object);
+									if (graphic->graphics_incomplete)
+									{
+										/* continued in the next build; partly built graphics
+											are only drawn if there are none to replace */
+										if (!graphic->previous_graphics_object)
+										{
+											GT_object_changed(graphic->graphics_object);
+										}
+									}
+									else
+									{
+										/* mark display list as needing updating */
+										graphic->graphics_changed = 0;
+										graphic->graphics_object_time = graphic_to_object_data->time;
+										GT_object_changed(graphic->graphics_object);
+										/* swap: stop drawing the graphics it replaces */
+										if (graphic->previous_graphics_object)
+										{
+											DEACCESS(GT_object)(&(graphic->previous_graphics_object));
+										}
+										++(graphic_to_object_data->build_progress);
+									}
 								}
 								else
 								{
@@ -3862,6 +4715,11 @@ int Cmiss_graphic_to_graphics_object(
 							{
 								DESTROY(GT_object)(&(graphic_to_object_data->existing_graphics));
 							}
+							if (graphic_to_object_data->existing_element_names)
+							{
+								delete graphic_to_object_data->existing_element_names;
+								graphic_to_object_data->existing_element_names = NULL;
+							}
 							if (graphic->data_field)
 							{
 								graphic_to_object_data->number_of_data_values = 0;
@@ -3884,8 +4742,9 @@ int Cmiss_graphic_to_graphics_object(
 				}
 				if (graphic->selected_graphics_changed)
 				{
-					if (graphic->graphics_object)
-						GT_object_changed(graphic->graphics_object);
+					struct GT_object *graphics_object = Cmiss_graphic_get_drawn_graphics_object(graphic);
+					if (graphics_object)
+						GT_object_changed(graphics_object);
 					graphic->selected_graphics_changed = 0;
 				}
 			}
@@ -3914,7 +4773,8 @@ int Cmiss_graphic_compile_visible_graphic(
 	if (graphic && (renderer = static_cast<Render_graphics *>(renderer_void)))
 	{
 		return_code = 1;
-		if (graphic->graphics_object)
+		struct GT_object *graphics_object = Cmiss_graphic_get_drawn_graphics_object(graphic);
+		if (graphics_object)
 		{
 			Cmiss_graphics_filter_id filter = Cmiss_scene_get_filter(renderer->get_Scene());
 			if (filter)
@@ -3922,7 +4782,7 @@ int Cmiss_graphic_compile_visible_graphic(
 				if (Cmiss_graphics_filter_evaluate_graphic(filter, graphic))
 				{
 					Cmiss_graphic_set_renderer_highlight_functor(graphic, renderer);
-					return_code = renderer->Graphics_object_compile(graphic->graphics_object);
+					return_code = renderer->Graphics_object_compile(graphics_object);
 					Cmiss_graphic_remove_renderer_highlight_functor(graphic, renderer);
 				}
 				Cmiss_graphics_filter_destroy(&filter);
@@ -3976,7 +4836,8 @@ int Cmiss_graphic_execute_visible_graphic(
 			(renderer_void)))
 	{
 		return_code = 1;
-		if (graphic->graphics_object)
+		struct GT_object *graphics_object = Cmiss_graphic_get_drawn_graphics_object(graphic);
+		if (graphics_object)
 		{
 			Cmiss_graphics_filter_id filter = Cmiss_scene_get_filter(renderer->get_Scene());
 			if (filter)
@@ -3991,7 +4852,7 @@ int Cmiss_graphic_execute_visible_graphic(
 							/* use position in list as name for GL picking */
 							glLoadName((GLuint)graphic->position);
 #endif /* defined (OPENGL_API) */
-							return_code = renderer->Graphics_object_execute(graphic->graphics_object);
+							return_code = renderer->Graphics_object_execute(graphics_object);
 							renderer->end_coordinate_system(graphic->coordinate_system);
 						}
 					}
@@ -4012,6 +4873,104 @@ int Cmiss_graphic_execute_visible_graphic(
 	return (return_code);
 } /* Cmiss_graphic_execute_visible_graphic */
 
+int Cmiss_graphic_set_level_of_detail_projection(struct Cmiss_graphic *graphic,
+	void *level_of_detail_data_void)
+{
+	if (!graphic)
+	{
+		display_message(ERROR_MESSAGE,
+			"Cmiss_graphic_set_level_of_detail_projection.  Invalid argument(s)");
+		return 0;
+	}
+	Cmiss_graphic_level_of_detail_data *level_of_detail_data =
+		static_cast<Cmiss_graphic_level_of_detail_data *>(level_of_detail_data_void);
+	const double *local_to_pixel = 0;
+	if (level_of_detail_data)
+	{
+		local_to_pixel = (CMISS_GRAPHICS_COORDINATE_SYSTEM_WORLD == graphic->coordinate_system) ?
+			level_of_detail_data->world_to_pixel : level_of_detail_data->local_to_pixel;
+	}
+	if (!local_to_pixel)
+	{
+		if (graphic->level_of_detail)
+		{
+			const bool levels_in_use = graphic->level_of_detail->levels_in_use;
+			delete graphic->level_of_detail;
+			graphic->level_of_detail = NULL;
+			if (levels_in_use)
+			{
+				Cmiss_graphic_changed(graphic, CMISS_GRAPHIC_CHANGE_FULL_REBUILD);
+			}
+		}
+		return 1;
+	}
+	if (graphic->level_of_detail)
+	{
+		if (0 == memcmp(graphic->level_of_detail->local_to_pixel, local_to_pixel, 16*sizeof(double)))
+		{
+			return 1;
+		}
+		memcpy(graphic->level_of_detail->local_to_pixel, local_to_pixel, 16*sizeof(double));
+	}
+	else
+	{
+		graphic->level_of_detail = new Cmiss_graphic_level_of_detail(local_to_pixel);
+	}
+	/* rebuild if using level of detail, or not yet built to know */
+	if (graphic->graphics_object && graphic->level_of_detail->levels_in_use &&
+		Cmiss_graphic_uses_level_of_detail(graphic))
+	{
+		if (Cmiss_graphic_edits_level_of_detail(graphic))
+		{
+			/* partial rebuild regenerating only elements changing level; not via
+				Cmiss_graphic_changed as that clears cached levels */
+			graphic->graphics_changed = 1;
+			if (graphic->time_cache)
+			{
+				graphic->time_cache->clear();
+			}
+			Cmiss_rendition_graphic_changed_private(graphic->rendition, graphic);
+		}
+		else
+		{
+			Cmiss_graphic_changed(graphic, CMISS_GRAPHIC_CHANGE_FULL_REBUILD);
+		}
+	}
+	return 1;
+}
+
+int Cmiss_graphic_pick_visible_graphic(struct Cmiss_graphic *graphic,
+	void *pick_context_void)
+{
+	int return_code = 1;
+	Scene_pick_context *pick_context =
+		static_cast<Scene_pick_context *>(pick_context_void);
+	if (graphic && pick_context)
+	{
+		struct GT_object *graphics_object = Cmiss_graphic_get_drawn_graphics_object(graphic);
+		if (graphics_object)
+		{
+			Cmiss_graphics_filter_id filter = Cmiss_scene_get_filter(pick_context->get_scene());
+			if (filter)
+			{
+				if (Cmiss_graphics_filter_evaluate_graphic(filter, graphic) &&
+					pick_context->begin_graphic(graphic->position, graphic->coordinate_system))
+				{
+					return_code = pick_context->pick_graphics_object(graphics_object);
+				}
+				Cmiss_graphics_filter_destroy(&filter);
+			}
+		}
+	}
+	else
+	{
+		display_message(ERROR_MESSAGE,
+			"Cmiss_graphic_pick_visible_graphic.  Invalid argument(s)");
+		return_code = 0;
+	}
+	return (return_code);
+}
+
 static int Cmiss_graphic_Computed_field_or_ancestor_satisfies_condition(
 	struct Cmiss_graphic *graphic,
 	LIST_CONDITIONAL_FUNCTION(Computed_field) *conditional_function,
@@ -4181,7 +5140,7 @@ int Cmiss_graphic_Computed_field_change(
 		{
 			Cmiss_graphic_changed(graphic, CMISS_GRAPHIC_CHANGE_FULL_REBUILD);
 		}
-		if (change_data->selection_changed && graphic->graphics_object &&
+		if (change_data->selection_changed && Cmiss_graphic_get_drawn_graphics_object(graphic) &&
 			(CMISS_GRAPHIC_POINT != graphic->graphic_type) &&
 			(CMISS_GRAPHIC_STREAMLINES != graphic->graphic_type))
 		{
@@ -4210,7 +5169,8 @@ int Cmiss_graphic_get_visible_graphics_object_range(
 
 	if (graphic && graphic_range && graphic_range->graphics_object_range)
 	{
-		if (graphic->graphics_object &&
+		struct GT_object *graphics_object = Cmiss_graphic_get_drawn_graphics_object(graphic);
+		if (graphics_object &&
 			(graphic->coordinate_system == graphic_range->coordinate_system))
 		{
 			Cmiss_graphics_filter_id filter = Cmiss_scene_get_filter(
@@ -4219,7 +5179,7 @@ int Cmiss_graphic_get_visible_graphics_object_range(
 			{
 				if (Cmiss_graphics_filter_evaluate_graphic(filter, graphic))
 				{
-					return_code=get_graphics_object_range(graphic->graphics_object,
+					return_code=get_graphics_object_range(graphics_object,
 						(void *)graphic_range->graphics_object_range);
 				}
 				Cmiss_graphics_filter_destroy(&filter);
@@ -4246,7 +5206,7 @@ struct GT_object *Cmiss_graphic_get_graphics_object(
 	ENTER(Cmiss_graphic_get_graphics_object);
 	if (graphic)
 	{
-		graphics_object=graphic->graphics_object;
+		graphics_object = Cmiss_graphic_get_drawn_graphics_object(graphic);
 	}
 	else
 	{
@@ -5047,6 +6007,8 @@ int Cmiss_graphic_copy_without_graphics_object(
 		/* for all graphic types */
 		destination->visibility_flag = source->visibility_flag;
 		destination->line_width = source->line_width;
+		destination->number_of_threads = source->number_of_threads;
+		destination->shared_vertices = source->shared_vertices;
 		REACCESS(Graphical_material)(&(destination->material),source->material);
 		REACCESS(Graphical_material)(&(destination->secondary_material),
 			source->secondary_material);
@@ -5069,6 +6031,11 @@ int Cmiss_graphic_copy_without_graphics_object(
 		/* ensure destination graphics object is cleared */
 		REACCESS(GT_object)(&(destination->graphics_object),
 			(struct GT_object *)NULL);
+		REACCESS(GT_object)(&(destination->previous_graphics_object),
+			(struct GT_object *)NULL);
+		destination->graphics_incomplete = 0;
+		delete destination->time_cache;
+		destination->time_cache = NULL;
 		destination->graphics_changed = 1;
 		destination->selected_graphics_changed = 1;
 
@@ -5471,6 +6438,11 @@ int Cmiss_graphic_same_geometry(struct Cmiss_graphic *graphic,
 				}
 			}
 		}
+		/* for surfaces only */
+		if (return_code&&(CMISS_GRAPHIC_SURFACES==graphic->graphic_type))
+		{
+			return_code=(graphic->shared_vertices==second_graphic->shared_vertices);
+		}
 		/* for node_points, data_points and element_points only */
 		if (return_code&&
 			((CMISS_GRAPHIC_NODE_POINTS==graphic->graphic_type)||
@@ -5916,6 +6888,21 @@ int Cmiss_graphic_extract_graphics_object_from_list(
 				graphic->graphics_changed = matching_graphic->graphics_changed;
 				graphic->selected_graphics_changed =
 					matching_graphic->selected_graphics_changed;
+				/* an incomplete build continues with the graphics it replaces */
+				graphic->graphics_incomplete = matching_graphic->graphics_incomplete;
+				graphic->resume_element_identifier = matching_graphic->resume_element_identifier;
+				REACCESS(GT_object)(&(graphic->previous_graphics_object),
+					matching_graphic->previous_graphics_object);
+				matching_graphic->graphics_incomplete = 0;
+				/* levels of detail describe the graphics object so go with it */
+				delete graphic->level_of_detail;
+				graphic->level_of_detail = matching_graphic->level_of_detail;
+				matching_graphic->level_of_detail = NULL;
+				/* as do graphics cached for other times */
+				graphic->graphics_object_time = matching_graphic->graphics_object_time;
+				delete graphic->time_cache;
+				graphic->time_cache = matching_graphic->time_cache;
+				matching_graphic->time_cache = NULL;
 // 				graphic->overlay_flag = matching_graphic->overlay_flag;
 // 				graphic->overlay_order = matching_graphic->overlay_order;
 				/* reset graphics_object and flags in matching_graphic */
@@ -6435,6 +7422,51 @@ int Cmiss_graphic_set_line_width(struct Cmiss_graphic *graphic, int line_width)
 	return (return_code);
 } /* Cmiss_graphic_set_line_width */
 
+int Cmiss_graphic_get_number_of_threads(Cmiss_graphic_id graphic)
+{
+	if (graphic)
+		return graphic->number_of_threads;
+	return 0;
+}
+
+int Cmiss_graphic_set_number_of_threads(Cmiss_graphic_id graphic,
+	int number_of_threads)
+{
+	if (graphic && (0 < number_of_threads))
+	{
+		// only affects speed of generation so no rebuild needed
+		graphic->number_of_threads = number_of_threads;
+		return CMISS_OK;
+	}
+	return 0;
+}
+
+int Cmiss_graphic_get_shared_vertices_flag(Cmiss_graphic_id graphic)
+{
+	if (graphic)
+		return graphic->shared_vertices;
+	return 0;
+}
+
+int Cmiss_graphic_set_shared_vertices_flag(Cmiss_graphic_id graphic,
+	int shared_vertices_flag)
+{
+	if (graphic)
+	{
+		const int shared_vertices = shared_vertices_flag ? 1 : 0;
+		if (shared_vertices != graphic->shared_vertices)
+		{
+			graphic->shared_vertices = shared_vertices;
+			if (CMISS_GRAPHIC_SURFACES == graphic->graphic_type)
+			{
+				Cmiss_graphic_changed(graphic, CMISS_GRAPHIC_CHANGE_FULL_REBUILD);
+			}
+		}
+		return CMISS_OK;
+	}
+	return 0;
+}
+
 int Cmiss_graphic_get_data_spectrum_parameters_streamlines(
 	struct Cmiss_graphic *graphic,
 	enum Streamline_data_type *streamline_data_type,
@@ -6576,12 +7608,13 @@ int Cmiss_graphic_get_face(struct Cmiss_graphic *graphic,int *face)
 } /* Cmiss_graphic_get_face */
 
 int Cmiss_graphic_time_change(
-	struct Cmiss_graphic *graphic,void *dummy_void)
+	struct Cmiss_graphic *graphic,void *time_change_data_void)
 {
 	int return_code;
 
 	ENTER(Cmiss_graphic_time_change);
-	USE_PARAMETER(dummy_void);
+	struct Cmiss_graphic_time_change_data *time_change_data =
+		static_cast<struct Cmiss_graphic_time_change_data *>(time_change_data_void);
 	if (graphic)
 	{
 		return_code = 1;
@@ -6591,7 +7624,54 @@ int Cmiss_graphic_time_change(
 		}
 		if (graphic->time_dependent)
 		{
-			Cmiss_graphic_changed(graphic, CMISS_GRAPHIC_CHANGE_FULL_REBUILD);
+			if (time_change_data && time_change_data->use_time_cache)
+			{
+				if (!graphic->time_cache)
+				{
+					graphic->time_cache = new Cmiss_graphic_time_cache();
+				}
+				/* keep complete graphics for the time they were built at */
+				if (graphic->graphics_object && !graphic->graphics_changed)
+				{
+					graphic->time_cache->add(graphic->graphics_object_time,
+						graphic->graphics_object);
+				}
+				Cmiss_graphic_time_cache::Entry_map::iterator iter =
+					graphic->time_cache->find(time_change_data->time);
+				if (iter != graphic->time_cache->entries.end())
+				{
+					REACCESS(GT_object)(&(graphic->graphics_object), iter->second.graphics_object);
+					REACCESS(GT_object)(&(graphic->previous_graphics_object), (struct GT_object *)NULL);
+					graphic->graphics_incomplete = 0;
+					graphic->graphics_object_time = iter->first;
+					graphic->graphics_changed = 0;
+					if (iter->second.recompile)
+					{
+						graphic->selected_graphics_changed = 1;
+						iter->second.recompile = false;
+					}
+					/* materials and spectrum may have changed since it was cached */
+					Cmiss_graphic_update_non_trivial_GT_objects(graphic);
+					Cmiss_graphic_changed(graphic, CMISS_GRAPHIC_CHANGE_REDRAW);
+				}
+				else
+				{
+					/* rebuild without clearing graphics cached for other times */
+					Cmiss_graphic_time_cache *time_cache = graphic->time_cache;
+					graphic->time_cache = NULL;
+					Cmiss_graphic_changed(graphic, CMISS_GRAPHIC_CHANGE_FULL_REBUILD);
+					graphic->time_cache = time_cache;
+				}
+			}
+			else
+			{
+				if (graphic->time_cache)
+				{
+					delete graphic->time_cache;
+					graphic->time_cache = NULL;
+				}
+				Cmiss_graphic_changed(graphic, CMISS_GRAPHIC_CHANGE_FULL_REBUILD);
+			}
 		}
 	}
 	else
@@ -6605,6 +7685,64 @@ int Cmiss_graphic_time_change(
 	return (return_code);
 } /* Cmiss_graphic_time_change */
 
+int Cmiss_graphic_time_cache_find_farthest(struct Cmiss_graphic *graphic,
+	void *trim_data_void)
+{
+	struct Cmiss_graphic_time_cache_trim_data *trim_data =
+		static_cast<struct Cmiss_graphic_time_cache_trim_data *>(trim_data_void);
+	if (!(graphic && trim_data))
+	{
+		display_message(ERROR_MESSAGE,
+			"Cmiss_graphic_time_cache_find_farthest.  Invalid argument(s)");
+		return 0;
+	}
+	if (graphic->time_cache)
+	{
+		trim_data->memory_size += graphic->time_cache->memory_size;
+		Cmiss_graphic_time_cache::Entry_map::iterator iter =
+			graphic->time_cache->find_farthest(trim_data->time);
+		if (iter != graphic->time_cache->entries.end())
+		{
+			const double distance = fabs(iter->first - trim_data->time);
+			if ((!trim_data->farthest_graphic) || (distance > trim_data->farthest_distance))
+			{
+				trim_data->farthest_graphic = graphic;
+				trim_data->farthest_distance = distance;
+			}
+		}
+	}
+	return 1;
+}
+
+int Cmiss_graphic_time_cache_remove_farthest(struct Cmiss_graphic *graphic,
+	double time)
+{
+	if (graphic && graphic->time_cache)
+	{
+		Cmiss_graphic_time_cache::Entry_map::iterator iter =
+			graphic->time_cache->find_farthest(time);
+		if (iter != graphic->time_cache->entries.end())
+		{
+			graphic->time_cache->remove(iter);
+			return 1;
+		}
+	}
+	return 0;
+}
+
+int Cmiss_graphic_clear_time_cache(struct Cmiss_graphic *graphic,
+	void *dummy_void)
+{
+	USE_PARAMETER(dummy_void);
+	if (graphic)
+	{
+		delete graphic->time_cache;
+		graphic->time_cache = NULL;
+		return 1;
+	}
+	return 0;
+}
+
 int Cmiss_graphic_update_time_behaviour(
 	struct Cmiss_graphic *graphic, void *update_time_behaviour_void)
 {
@@ -6745,9 +7883,10 @@ int Cmiss_graphics_material_change(
 		}
 		if (material_change)
 		{
-			if (graphic->graphics_object)
+			struct GT_object *graphics_object = Cmiss_graphic_get_drawn_graphics_object(graphic);
+			if (graphics_object)
 			{
-				GT_object_Graphical_material_change(graphic->graphics_object,
+				GT_object_Graphical_material_change(graphics_object,
 					(struct LIST(Graphical_material) *)NULL);
 			}
 			/* need a way to tell either graphic is used in any scene or not */
@@ -6778,9 +7917,10 @@ int Cmiss_graphic_spectrum_change(
 				spectrum_change_data->manager_message, graphic->spectrum);
 			if (change_flags & MANAGER_CHANGE_RESULT(Spectrum))
 			{
-				if (graphic->graphics_object)
+				struct GT_object *graphics_object = Cmiss_graphic_get_drawn_graphics_object(graphic);
+				if (graphics_object)
 				{
-					GT_object_Spectrum_change(graphic->graphics_object,
+					GT_object_Spectrum_change(graphics_object,
 						(struct LIST(Spectrum) *)NULL);
 				}
 				/* need a way to tell either graphic is used in any scene or not */
@@ -6797,9 +7937,10 @@ int Cmiss_graphic_spectrum_change(
 				spectrum_change_data->manager_message, colour_lookup);
 			if (change_flags & MANAGER_CHANGE_RESULT(Spectrum))
 			{
-				if (graphic->graphics_object)
+				struct GT_object *graphics_object = Cmiss_graphic_get_drawn_graphics_object(graphic);
+				if (graphics_object)
 				{
-					GT_object_Graphical_material_change(graphic->graphics_object,
+					GT_object_Graphical_material_change(graphics_object,
 						(struct LIST(Graphical_material) *)NULL);
 				}
 				/* need a way to tell either graphic is used in any scene or not */
@@ -7012,7 +8153,7 @@ Must call Cmiss_graphic_to_graphics_object afterwards to complete.
 	if (graphic)
 	{
 		return_code=1;
-		if (graphic->graphics_object&&
+		if (Cmiss_graphic_get_drawn_graphics_object(graphic) &&
 			(CMISS_GRAPHIC_ELEMENT_POINTS==graphic->graphic_type))
 		{
 			Cmiss_graphic_update_selected(graphic, (void *)NULL);
@@ -40,6 +40,8 @@
 #if !defined (CMISS_GRAPHIC_H)
 #define CMISS_GRAPHIC_H
 
+#include <map>
+#include <set>
 #include "zinc/fieldgroup.h"
 #include "zinc/graphic.h"
 #include "computed_field/computed_field.h"
@@ -51,6 +53,7 @@
 #include "graphics/graphics_object.h"
 #include "general/enumerator.h"
 #include "general/list.h"
+#include "general/time.h"
 #include "graphics/material.h"
 #include "graphics/spectrum.h"
 #include "graphics/volume_texture.h"
@@ -73,6 +76,9 @@ enum Graphic_glyph_scaling_mode
 	GRAPHIC_GLYPH_SCALING_GENERAL
 }; /* enum Glyph_scaling_mode */
 
+struct Cmiss_graphic_level_of_detail;
+struct Cmiss_graphic_time_cache;
+
 struct Cmiss_graphic
 /*******************************************************************************
 LAST MODIFIED : 14 March 2003
@@ -172,6 +178,14 @@ finite element group rendition.
 	/* rendering information */
 	/* the graphics_object generated for this settings */
 	struct GT_object *graphics_object, *customised_graphics_object;
+	/* complete graphics object drawn while graphics_object awaits a deferred
+		rebuild or is incomplete, or NULL */
+	struct GT_object *previous_graphics_object;
+	/* set while graphics_object is only partly built because a build with a
+		time limit ran out of time; the next build continues from element
+		resume_element_identifier */
+	int graphics_incomplete;
+	int resume_element_identifier;
 	/* flag indicating the graphics_object needs rebuilding */
 	int graphics_changed;
 	/* flag indicating that selected graphics have changed */
@@ -179,6 +193,18 @@ finite element group rendition.
 	/* flag indicating that this settings needs to be regenerated when time
 		changes */
 	int time_dependent;
+	/* number of threads to generate per-element graphics with; 1 = serial */
+	int number_of_threads;
+	/* flag set if surfaces share vertices across element boundaries */
+	int shared_vertices;
+	/* view projection and per-element levels of detail for adaptive
+		tessellation, or NULL if not in use */
+	struct Cmiss_graphic_level_of_detail *level_of_detail;
+	/* time graphics_object was built for */
+	double graphics_object_time;
+	/* graphics objects built at other times for reuse in time-dependent
+		graphics, or NULL if not in use */
+	struct Cmiss_graphic_time_cache *time_cache;
 	enum Cmiss_graphics_coordinate_system coordinate_system;
 // 	/* for accessing objects */
 	int access_count;
@@ -271,6 +297,10 @@ struct Cmiss_graphic_to_graphics_object_data
 		 relies on them being stored in the same order as the new additions.
 		 Set to NULL to turn off */
 	struct GT_object *existing_graphics;
+	/* names of elements whose graphics are kept in the vertex array of the
+		 graphics object being edited, so they are not regenerated.
+		 Set to NULL to turn off */
+	std::set<int> *existing_element_names;
 	/* for highlighting of selected objects */
 	struct LIST(Element_point_ranges) *selected_element_point_ranges_list;
 	/** The number of components in the data field */
@@ -282,7 +312,42 @@ struct Cmiss_graphic_to_graphics_object_data
 	struct Cmiss_scene *scene;
 	/* additional values for passing to element_to_graphics_object */
 	struct Cmiss_graphic *graphic;
+	/* graphics object element primitives are added to: the graphic's own or a
+		 temporary one for a chunk of elements being generated in parallel */
+	struct GT_object *graphics_object;
+	/* if set, surface elements are accumulated into this shared-vertex mesh */
+	struct FE_surface_mesh_builder *surface_mesh_builder;
 	int top_level_number_in_xi[MAXIMUM_ELEMENT_XI_DIMENSIONS];
+	/* if set, local to pixel projection from which the level of detail of each
+		element is chosen, scaling minimum_number_in_xi by up to
+		refinement_factors */
+	const double *level_of_detail_projection;
+	int minimum_number_in_xi[MAXIMUM_ELEMENT_XI_DIMENSIONS];
+	int refinement_factors[MAXIMUM_ELEMENT_XI_DIMENSIONS];
+	/* level of detail chosen for each element, by element number */
+	std::map<int, int> *element_levels;
+	/* if set, graphics needing a full rebuild are left for a later build,
+		drawing their previous graphics object meanwhile */
+	int defer_full_rebuilds;
+	/* number of rebuilds deferred or left incomplete in this build */
+	int number_of_deferred_rebuilds;
+	/* if positive, seconds from build_start_time after which full rebuilds
+		are deferred, and full rebuilds of per-element graphics in progress stop
+		after the current batch of elements, to continue in the next build */
+	double build_time_limit;
+	struct timeval build_start_time;
+	/* number of graphics and elements built so far in this build */
+	int build_progress;
+};
+
+/***************************************************************************//**
+ * Projections from the local and world coordinates of a rendition to pixels
+ * in the level of detail viewer, for Cmiss_graphic_set_level_of_detail_projection.
+ */
+struct Cmiss_graphic_level_of_detail_data
+{
+	const double *local_to_pixel;
+	const double *world_to_pixel;
 };
 
 struct Modify_rendition_data
@@ -480,6 +545,15 @@ int Cmiss_graphic_set_subgroup_field(
 int Cmiss_graphic_to_graphics_object(
 	struct Cmiss_graphic *graphic,void *graphic_to_object_data_void);
 
+/***************************************************************************//**
+ * Checks whether the build time limit in graphic_to_object_data has been
+ * reached, and if so sets defer_full_rebuilds. Never reached before anything
+ * has been built, so every build makes progress however slow it is.
+ * @return  1 if full rebuilds are to be deferred, otherwise 0.
+ */
+int Cmiss_graphic_to_graphics_object_data_time_expired(
+	struct Cmiss_graphic_to_graphics_object_data *graphic_to_object_data);
+
 /***************************************************************************//**
  * If the settings visibility flag is set and it has a graphics_object, the
  * graphics_object is compiled.
@@ -507,9 +581,40 @@ int Cmiss_graphic_glyph_change(
 int Cmiss_graphic_execute_visible_graphic(
 	struct Cmiss_graphic *graphic, void *renderer_void);
 
+/***************************************************************************//**
+ * Sets the projection to pixels from which lines, surfaces and cylinders
+ * using a tessellation with a screen error tolerance choose the divisions of
+ * each element. If the projection has changed, surfaces and cylinders
+ * regenerate only the elements whose level of detail changes, reusing
+ * primitives cached from earlier levels where possible; other graphics are
+ * rebuilt.
+ * @param graphic  The graphic to update.
+ * @param level_of_detail_data_void  Void pointer to
+ * struct Cmiss_graphic_level_of_detail_data, or NULL to stop using level of
+ * detail.
+ * @return  1 on success, 0 on failure.
+ */
+int Cmiss_graphic_set_level_of_detail_projection(struct Cmiss_graphic *graphic,
+	void *level_of_detail_data_void);
+
+/***************************************************************************//**
+ * If the graphic passes the scene filter and has a graphics_object, adds hits
+ * on the graphics_object to the pick context, named by the position of the
+ * graphic in the list as for OpenGL picking.
+ * @param graphic  The graphic to pick.
+ * @param pick_context_void  Void pointer to Scene_pick_context.
+ * @return  1 on success, 0 on failure.
+ */
+int Cmiss_graphic_pick_visible_graphic(struct Cmiss_graphic *graphic,
+	void *pick_context_void);
+
 int Cmiss_graphic_get_visible_graphics_object_range(
 	struct Cmiss_graphic *graphic,void *graphic_range_void);
 
+/***************************************************************************//**
+ * @return  The graphics object drawn for the graphic, which while a rebuild is
+ * deferred is the previous complete graphics object. Not accessed.
+ */
 struct GT_object *Cmiss_graphic_get_graphics_object(
 	struct Cmiss_graphic *graphic);
 
@@ -905,8 +1010,54 @@ int Cmiss_graphic_set_volume_texture(struct Cmiss_graphic *graphic,
  */
 char *Cmiss_graphic_get_name_internal(struct Cmiss_graphic *graphic);
 
+struct Cmiss_graphic_time_change_data
+{
+	double time;
+	/* if set, graphics built for other times are cached and reused */
+	int use_time_cache;
+};
+
+/***************************************************************************//**
+ * List iterator updating the graphic for a change of time. Time-dependent
+ * graphics are rebuilt unless the time cache is in use and has graphics
+ * for the new time.
+ * @param time_change_data_void  Optional struct Cmiss_graphic_time_change_data.
+ * If NULL, time-dependent graphics are always rebuilt.
+ */
 int Cmiss_graphic_time_change(
-	struct Cmiss_graphic *graphic,void *dummy_void);
+	struct Cmiss_graphic *graphic,void *time_change_data_void);
+
+struct Cmiss_graphic_time_cache_trim_data
+{
+	double time;
+	/* total size of the time caches of all graphics visited */
+	size_t memory_size;
+	/* graphic with the cached time farthest from time, or NULL if none */
+	struct Cmiss_graphic *farthest_graphic;
+	double farthest_distance;
+};
+
+/***************************************************************************//**
+ * List iterator adding the memory used by the graphic's time cache to the
+ * Cmiss_graphic_time_cache_trim_data and noting the graphic if it has the
+ * cached time farthest from the current time.
+ */
+int Cmiss_graphic_time_cache_find_farthest(struct Cmiss_graphic *graphic,
+	void *trim_data_void);
+
+/***************************************************************************//**
+ * Removes the graphics cached for the time farthest from <time>, but never
+ * for <time> itself.
+ * @return  1 if graphics were removed, 0 if none.
+ */
+int Cmiss_graphic_time_cache_remove_farthest(struct Cmiss_graphic *graphic,
+	double time);
+
+/***************************************************************************//**
+ * List iterator removing all graphics cached for other times.
+ */
+int Cmiss_graphic_clear_time_cache(struct Cmiss_graphic *graphic,
+	void *dummy_void);
 
 int Cmiss_graphic_update_time_behaviour(
 	struct Cmiss_graphic *graphic, void *update_time_behaviour_void);
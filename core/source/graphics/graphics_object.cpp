@@ -48,6 +48,7 @@ gtObject/gtWindow management routines.
  *
  * ***** END LICENSE BLOCK ***** */
 #include <iostream>
+#include <vector>
 #include <stdlib.h>
 #include <stdio.h>
 #include <math.h>
@@ -80,6 +81,7 @@ gtObject/gtWindow management routines.
 #include "graphics/render_gl.h"
 #include "graphics/graphics_object.hpp"
 #include "graphics/graphics_object_highlight.hpp"
+#include "graphics/graphics_object_pick.hpp"
 #include "graphics/graphics_object_private.hpp"
 #include "computed_field/computed_field_subobject_group_private.hpp"
 /*
@@ -127,6 +129,7 @@ Module functions
 */
 
 int DESTROY(GT_polyline_vertex_buffers)(struct GT_polyline_vertex_buffers **polyline);
+int DESTROY(GT_surface_vertex_buffers)(struct GT_surface_vertex_buffers **surface);
 
 PROTOTYPE_DEFAULT_DESTROY_OBJECT_FUNCTION(Graphics_vertex_buffer);
 PROTOTYPE_OBJECT_FUNCTIONS(Graphics_vertex_buffer);
@@ -592,6 +595,17 @@ from the conditional_function causes the primitive to be removed.
 			} break;
 			case g_POLYLINE_VERTEX_BUFFERS:
 			{
+				/* remove only the ranges of matching primitives if possible,
+					otherwise all primitives */
+				if (conditional_function && graphics_object->vertex_array &&
+					graphics_object->vertex_array->remove_primitives(
+						conditional_function, user_data) &&
+					(0 < graphics_object->vertex_array->get_number_of_vertices(
+						GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_ID)))
+				{
+					return_code = 1;
+					break;
+				}
 				if (graphics_object->number_of_times &&
 					graphics_object->primitive_lists)
 				{
@@ -607,6 +621,33 @@ from the conditional_function causes the primitive to be removed.
 				}
 				return_code = 1;
 			} break;
+			case g_SURFACE_VERTEX_BUFFERS:
+			{
+				/* shared vertex surfaces have no vertex ranges so are all removed */
+				if (conditional_function && graphics_object->vertex_array &&
+					graphics_object->vertex_array->remove_primitives(
+						conditional_function, user_data) &&
+					(0 < graphics_object->vertex_array->get_number_of_vertices(
+						GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_ID)))
+				{
+					return_code = 1;
+					break;
+				}
+				if (graphics_object->number_of_times &&
+					graphics_object->primitive_lists)
+				{
+					graphics_object->number_of_times = 0;
+					DESTROY(GT_surface_vertex_buffers)(
+						&graphics_object->primitive_lists->gt_surface_vertex_buffers);
+					DEALLOCATE(graphics_object->primitive_lists);
+					DEALLOCATE(graphics_object->times);
+				}
+				if (graphics_object->vertex_array)
+				{
+					graphics_object->vertex_array->clear_buffers();
+				}
+				return_code = 1;
+			} break;
 			case g_SURFACE:
 			{
 				return_code=GT_OBJECT_REMOVE_PRIMITIVES_AT_TIME_NUMBER(GT_surface)(
@@ -815,6 +856,10 @@ Returns a string describing the object type, suitable for writing to file
 		{
 			type_string="POLYLINE_VERTEX_BUFFERS";
 		} break;
+		case g_SURFACE_VERTEX_BUFFERS:
+		{
+			type_string="SURFACE_VERTEX_BUFFERS";
+		} break;
 		default:
 		{
 			display_message(ERROR_MESSAGE,
@@ -2328,7 +2373,7 @@ Normals are not updated (wavefront export doesn't use normals anyway).
 	return (graphics_object);
 } /* transform_GT_object */
 
-DECLARE_OBJECT_FUNCTIONS(GT_object)
+DECLARE_ATOMIC_OBJECT_FUNCTIONS(GT_object)
 DECLARE_DEFAULT_GET_OBJECT_NAME_FUNCTION(GT_object)
 DECLARE_LOCAL_MANAGER_FUNCTIONS(GT_object)
 
@@ -3289,6 +3334,50 @@ int DESTROY(GT_polyline_vertex_buffers)(GT_polyline_vertex_buffers **polyline)
 	return (return_code);
 } /* DESTROY(GT_polyline_vertex_buffers) */
 
+GT_surface_vertex_buffers *CREATE(GT_surface_vertex_buffers)(
+	GT_surface_type surface_type, Cmiss_graphics_render_type render_type)
+{
+	struct GT_surface_vertex_buffers *surface;
+
+	ENTER(CREATE(GT_surface_vertex_buffers));
+	if (ALLOCATE(surface,struct GT_surface_vertex_buffers,1))
+	{
+		surface->surface_type=surface_type;
+		surface->render_type=render_type;
+	}
+	else
+	{
+		display_message(ERROR_MESSAGE,"CREATE(GT_surface_vertex_buffers).  Not enough memory");
+	}
+	LEAVE;
+
+	return (surface);
+} /* CREATE(GT_surface_vertex_buffers) */
+
+/***************************************************************************//**
+ * Destroys the surface rendition information.
+ */
+int DESTROY(GT_surface_vertex_buffers)(GT_surface_vertex_buffers **surface)
+{
+	int return_code;
+
+	ENTER(DESTROY(GT_surface_vertex_buffers));
+	if (surface && *surface)
+	{
+		DEALLOCATE(*surface);
+		return_code=1;
+	}
+	else
+	{
+		display_message(ERROR_MESSAGE,"DESTROY(GT_surface_vertex_buffers).  "
+			"Invalid argument");
+		return_code=0;
+	}
+	LEAVE;
+
+	return (return_code);
+} /* DESTROY(GT_surface_vertex_buffers) */
+
 int GT_polyline_set_integer_identifier(struct GT_polyline *polyline,
 	int identifier)
 /*******************************************************************************
@@ -3750,6 +3839,8 @@ Allocates memory and assigns fields for a graphics object.
 			object->glyph_labels_function = (Graphics_object_glyph_labels_function)NULL;
 			object->texture_tiling = (struct Texture_tiling *)NULL;
 			object->vertex_array = (Graphics_vertex_array *)NULL;
+			object->vertex_array_packed = 0;
+			object->pick_bvh = (Graphics_object_bvh *)NULL;
 			object->access_count = 0;
 			object->manager = NULL;
 			return_code = 1;
@@ -3767,6 +3858,7 @@ Allocates memory and assigns fields for a graphics object.
 					/* these are valid object_types */
 				} break;
 				case g_POLYLINE_VERTEX_BUFFERS:
+				case g_SURFACE_VERTEX_BUFFERS:
 				{
 					object->vertex_array = new Graphics_vertex_array
 						(GRAPHICS_VERTEX_ARRAY_TYPE_FLOAT_SEPARATE_DRAW_ARRAYS);
@@ -3899,6 +3991,7 @@ and sets <*object> to NULL.
 			{
 				delete object->vertex_array;
 			}
+			Graphics_object_bvh_destroy(&(object->pick_bvh));
 			callback_data = object->update_callback_list;
 			while(callback_data)
 			{
@@ -4031,6 +4124,14 @@ objects interested in this GT_object will be notified that is has changed.
 			GT_object_changed(graphics_object->nextobject);
 		}
 		graphics_object->compile_status = GRAPHICS_NOT_COMPILED;
+		graphics_object->vertex_array_packed = 0;
+		if ((g_SURFACE == graphics_object->object_type) && graphics_object->vertex_array)
+		{
+			/* packed surfaces are rebuilt from the primitives when next needed */
+			delete graphics_object->vertex_array;
+			graphics_object->vertex_array = (Graphics_vertex_array *)NULL;
+		}
+		Graphics_object_bvh_destroy(&(graphics_object->pick_bvh));
 		if (graphics_object->manager)
 		{
 			MANAGED_OBJECT_CHANGE(GT_object)(graphics_object,
@@ -4315,7 +4416,17 @@ Returns true if <graphics_object> has primitives stored exactly at <time>.
 	return_code = 0;
 	if (graphics_object)
 	{
-		if (graphics_object->times && graphics_object->primitive_lists)
+		if ((g_POLYLINE_VERTEX_BUFFERS == graphics_object->object_type) ||
+			(g_SURFACE_VERTEX_BUFFERS == graphics_object->object_type))
+		{
+			/* vertex array primitives are at all times */
+			if (graphics_object->vertex_array && (0 < graphics_object->vertex_array->
+				get_number_of_vertices(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_ID)))
+			{
+				return_code = 1;
+			}
+		}
+		else if (graphics_object->times && graphics_object->primitive_lists)
 		{
 			if (0 < (time_number = GT_object_get_time_number(graphics_object, time)))
 			{
@@ -4427,6 +4538,108 @@ Returns the number of times/primitive lists in the graphics_object.
 	return (number_of_times);
 } /* GT_object_get_number_of_times */
 
+size_t GT_object_get_memory_size(struct GT_object *graphics_object)
+{
+	if (!graphics_object)
+	{
+		display_message(ERROR_MESSAGE,
+			"GT_object_get_memory_size.  Invalid argument");
+		return 0;
+	}
+	size_t memory_size = sizeof(struct GT_object) +
+		graphics_object->number_of_times*(sizeof(ZnReal) + sizeof(union GT_primitive_list));
+	if (graphics_object->vertex_array)
+	{
+		memory_size += graphics_object->vertex_array->get_memory_size();
+	}
+	for (int i = 0; i < graphics_object->number_of_times; ++i)
+	{
+		union GT_primitive_list *primitive_list = graphics_object->primitive_lists + i;
+		switch (graphics_object->object_type)
+		{
+			case g_GLYPH_SET:
+			{
+				for (struct GT_glyph_set *glyph_set = primitive_list->gt_glyph_set.first;
+					glyph_set; glyph_set = glyph_set->ptrnext)
+				{
+					memory_size += sizeof(struct GT_glyph_set) + glyph_set->number_of_points*
+						(6*sizeof(Triple) + sizeof(int) + glyph_set->n_data_components*sizeof(GLfloat));
+				}
+			} break;
+			case g_NURBS:
+			{
+				for (struct GT_nurbs *nurbs = primitive_list->gt_nurbs.first;
+					nurbs; nurbs = nurbs->ptrnext)
+				{
+					memory_size += sizeof(struct GT_nurbs);
+				}
+			} break;
+			case g_POINT:
+			{
+				for (struct GT_point *point = primitive_list->gt_point.first;
+					point; point = point->ptrnext)
+				{
+					memory_size += sizeof(struct GT_point) + sizeof(Triple) +
+						point->n_data_components*sizeof(GLfloat);
+				}
+			} break;
+			case g_POINTSET:
+			{
+				for (struct GT_pointset *pointset = primitive_list->gt_pointset.first;
+					pointset; pointset = pointset->ptrnext)
+				{
+					memory_size += sizeof(struct GT_pointset) + pointset->n_pts*
+						(sizeof(Triple) + sizeof(int) + pointset->n_data_components*sizeof(GLfloat));
+				}
+			} break;
+			case g_POLYLINE:
+			{
+				for (struct GT_polyline *polyline = primitive_list->gt_polyline.first;
+					polyline; polyline = polyline->ptrnext)
+				{
+					memory_size += sizeof(struct GT_polyline) + polyline->n_pts*
+						(((polyline->normallist) ? 2 : 1)*sizeof(Triple) +
+						polyline->n_data_components*sizeof(GLfloat));
+				}
+			} break;
+			case g_SURFACE:
+			{
+				for (struct GT_surface *surface = primitive_list->gt_surface.first;
+					surface; surface = surface->ptrnext)
+				{
+					const int number_of_lists = 1 + ((surface->normallist) ? 1 : 0) +
+						((surface->tangentlist) ? 1 : 0) + ((surface->texturelist) ? 1 : 0);
+					memory_size += sizeof(struct GT_surface) + surface->n_pts1*surface->n_pts2*
+						(number_of_lists*sizeof(Triple) + surface->n_data_components*sizeof(GLfloat));
+				}
+			} break;
+			case g_USERDEF:
+			{
+				for (struct GT_userdef *userdef = primitive_list->gt_userdef.first;
+					userdef; userdef = userdef->ptrnext)
+				{
+					memory_size += sizeof(struct GT_userdef);
+				}
+			} break;
+			case g_VOLTEX:
+			{
+				for (struct GT_voltex *voltex = primitive_list->gt_voltex.first;
+					voltex; voltex = voltex->ptrnext)
+				{
+					memory_size += sizeof(struct GT_voltex) +
+						voltex->number_of_vertices*(sizeof(struct VT_iso_vertex) + sizeof(void *)) +
+						voltex->number_of_triangles*(sizeof(struct VT_iso_triangle) + sizeof(void *));
+				}
+			} break;
+			default:
+			{
+				/* packed vertex buffer types are counted in the vertex_array */
+			} break;
+		}
+	}
+	return memory_size;
+}
+
 Graphics_vertex_array *
 	GT_object_get_vertex_set(GT_object *graphics_object)
 {
@@ -4448,6 +4661,447 @@ Graphics_vertex_array *
 	return (set);
 } /* GT_object_get_vertex_set */
 
+int GT_surface_add_triangle_indices(struct GT_surface *surface,
+	unsigned int first_vertex, std::vector<unsigned int>& triangles)
+{
+	const unsigned int n1 = static_cast<unsigned int>(surface->n_pts1);
+	const unsigned int n2 = static_cast<unsigned int>(surface->n_pts2);
+	unsigned int i, j;
+	switch (surface->surface_type)
+	{
+		case g_SHADED:
+		case g_SHADED_TEXMAP:
+		{
+			if (g_QUADRILATERAL == surface->polygon)
+			{
+				/* grid of n1 x n2 points varying fastest in xi1 */
+				for (j = 0; (j + 1) < n2; j++)
+				{
+					for (i = 0; (i + 1) < n1; i++)
+					{
+						const unsigned int p00 = first_vertex + j*n1 + i;
+						const unsigned int p10 = p00 + 1;
+						const unsigned int p01 = p00 + n1;
+						const unsigned int p11 = p01 + 1;
+						triangles.push_back(p00);
+						triangles.push_back(p10);
+						triangles.push_back(p01);
+						triangles.push_back(p10);
+						triangles.push_back(p11);
+						triangles.push_back(p01);
+					}
+				}
+			}
+			else if (g_TRIANGLE == surface->polygon)
+			{
+				/* rows of n1, n1 - 1, ... 1 points */
+				unsigned int row_start = first_vertex;
+				for (j = 0; (j + 1) < n1; j++)
+				{
+					const unsigned int row_length = n1 - j;
+					const unsigned int next_row_start = row_start + row_length;
+					for (i = 0; (i + 1) < row_length; i++)
+					{
+						triangles.push_back(row_start + i);
+						triangles.push_back(row_start + i + 1);
+						triangles.push_back(next_row_start + i);
+						if ((i + 2) < row_length)
+						{
+							triangles.push_back(row_start + i + 1);
+							triangles.push_back(next_row_start + i + 1);
+							triangles.push_back(next_row_start + i);
+						}
+					}
+					row_start = next_row_start;
+				}
+			}
+			else
+			{
+				return 0;
+			}
+		} break;
+		case g_SH_DISCONTINUOUS:
+		case g_SH_DISCONTINUOUS_TEXMAP:
+		{
+			/* n1 polygons of n2 vertices */
+			for (i = 0; i < n1; i++)
+			{
+				const unsigned int start = first_vertex + i*n2;
+				if ((g_TRIANGLE == surface->polygon) && (0 == (n2 % 3)))
+				{
+					for (j = 0; j < n2; j++)
+					{
+						triangles.push_back(start + j);
+					}
+				}
+				else if ((g_QUADRILATERAL == surface->polygon) && (0 == (n2 % 4)))
+				{
+					for (j = 0; j < n2; j += 4)
+					{
+						triangles.push_back(start + j);
+						triangles.push_back(start + j + 1);
+						triangles.push_back(start + j + 2);
+						triangles.push_back(start + j);
+						triangles.push_back(start + j + 2);
+						triangles.push_back(start + j + 3);
+					}
+				}
+				else
+				{
+					/* fan triangulation of convex polygon */
+					for (j = 1; (j + 1) < n2; j++)
+					{
+						triangles.push_back(start);
+						triangles.push_back(start + j);
+						triangles.push_back(start + j + 1);
+					}
+				}
+			}
+		} break;
+		case g_SH_DISCONTINUOUS_STRIP:
+		case g_SH_DISCONTINUOUS_STRIP_TEXMAP:
+		{
+			/* n1 strips of n2 vertices */
+			for (i = 0; i < n1; i++)
+			{
+				const unsigned int start = first_vertex + i*n2;
+				if (g_TRIANGLE == surface->polygon)
+				{
+					for (j = 0; (j + 2) < n2; j++)
+					{
+						/* alternate triangles are reversed in a strip */
+						triangles.push_back(start + j + (j & 1));
+						triangles.push_back(start + j + 1 - (j & 1));
+						triangles.push_back(start + j + 2);
+					}
+				}
+				else if (g_QUADRILATERAL == surface->polygon)
+				{
+					for (j = 0; (j + 3) < n2; j += 2)
+					{
+						triangles.push_back(start + j);
+						triangles.push_back(start + j + 1);
+						triangles.push_back(start + j + 2);
+						triangles.push_back(start + j + 1);
+						triangles.push_back(start + j + 3);
+						triangles.push_back(start + j + 2);
+					}
+				}
+				else
+				{
+					return 0;
+				}
+			}
+		} break;
+		default:
+		{
+			return 0;
+		} break;
+	}
+	return 1;
+}
+
+/**
+ * Appends the vertices and triangles of <surface> to <array> as one primitive
+ * identified by the surface's object_name, with its own range of vertices so
+ * it can later be removed individually.
+ * @return  1 on success, 0 if the surface layout is not supported or its
+ * vertex attributes differ from those of the primitives already in <array>.
+ */
+static int Graphics_vertex_array_add_GT_surface(Graphics_vertex_array *array,
+	struct GT_surface *surface)
+{
+	if (surface->tangentlist)
+	{
+		return 0;
+	}
+	unsigned int first_vertex = array->get_number_of_vertices(
+		GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_POSITION);
+	const int number_of_data_components = surface->data ? surface->n_data_components : 0;
+	if ((array->get_number_of_vertices(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_NORMAL) !=
+			(surface->normallist ? first_vertex : 0)) ||
+		(array->get_number_of_vertices(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_TEXTURE_COORDINATE_ZERO) !=
+			(surface->texturelist ? first_vertex : 0)) ||
+		(array->get_number_of_vertices(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_DATA) !=
+			((0 < number_of_data_components) ? first_vertex : 0)))
+	{
+		return 0;
+	}
+	unsigned int number_of_vertices = ((g_TRIANGLE == surface->polygon) &&
+		((g_SHADED == surface->surface_type) || (g_SHADED_TEXMAP == surface->surface_type))) ?
+		static_cast<unsigned int>((surface->n_pts1*(surface->n_pts1 + 1))/2) :
+		static_cast<unsigned int>(surface->n_pts1*surface->n_pts2);
+	std::vector<unsigned int> triangles;
+	if ((0 == number_of_vertices) ||
+		(!GT_surface_add_triangle_indices(surface, first_vertex, triangles)))
+	{
+		return 0;
+	}
+	unsigned int index_start = array->get_number_of_vertices(
+		GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_INDEX);
+	unsigned int index_count = static_cast<unsigned int>(triangles.size());
+	int object_name = surface->object_name;
+	return array->add_float_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_POSITION,
+			3, number_of_vertices, &(surface->pointlist[0][0])) &&
+		((!surface->normallist) || array->add_float_attribute(
+			GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_NORMAL,
+			3, number_of_vertices, &(surface->normallist[0][0]))) &&
+		((!surface->texturelist) || array->add_float_attribute(
+			GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_TEXTURE_COORDINATE_ZERO,
+			3, number_of_vertices, &(surface->texturelist[0][0]))) &&
+		((0 == number_of_data_components) || array->add_float_attribute(
+			GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_DATA,
+			number_of_data_components, number_of_vertices, surface->data)) &&
+		((0 == index_count) || array->add_unsigned_integer_attribute(
+			GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_INDEX, 1, index_count, &(triangles[0]))) &&
+		array->add_integer_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_ID,
+			1, 1, &object_name) &&
+		array->add_unsigned_integer_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_ELEMENT_INDEX_START,
+			1, 1, &index_start) &&
+		array->add_unsigned_integer_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_ELEMENT_INDEX_COUNT,
+			1, 1, &index_count) &&
+		array->add_unsigned_integer_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_ELEMENT_VERTEX_START,
+			1, 1, &first_vertex) &&
+		array->add_unsigned_integer_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_ELEMENT_VERTEX_COUNT,
+			1, 1, &number_of_vertices);
+}
+
+/**
+ * Packs the surface primitives of g_SURFACE <graphics_object> into <array>,
+ * replacing any values it held.
+ * @return  1 on success, 0 if the surfaces cannot be packed.
+ */
+static int GT_object_pack_surfaces(struct GT_object *graphics_object,
+	Graphics_vertex_array *array)
+{
+	/* only pack static surfaces without texture tiling, all drawn with the same
+		render type */
+	struct GT_surface *first_surface = (1 == graphics_object->number_of_times) ?
+		graphics_object->primitive_lists[0].gt_surface.first : 0;
+	if ((!first_surface) || graphics_object->texture_tiling)
+	{
+		return 0;
+	}
+	array->clear_buffers();
+	for (struct GT_surface *surface = first_surface; surface; surface = surface->ptrnext)
+	{
+		if ((surface->render_type != first_surface->render_type) ||
+			(!Graphics_vertex_array_add_GT_surface(array, surface)))
+		{
+			array->clear_buffers();
+			return 0;
+		}
+	}
+	return 1;
+}
+
+int GT_object_add_surface_to_vertex_array(struct GT_object *graphics_object,
+	struct GT_surface *surface)
+{
+	if (graphics_object && (g_SURFACE_VERTEX_BUFFERS == graphics_object->object_type) &&
+		graphics_object->vertex_array && surface)
+	{
+		if (Graphics_vertex_array_add_GT_surface(graphics_object->vertex_array, surface))
+		{
+			return 1;
+		}
+		display_message(ERROR_MESSAGE, "GT_object_add_surface_to_vertex_array.  "
+			"Surface layout or vertex attributes not supported");
+	}
+	else
+	{
+		display_message(ERROR_MESSAGE,
+			"GT_object_add_surface_to_vertex_array.  Invalid argument(s)");
+	}
+	return 0;
+}
+
+struct GT_object *GT_object_create_surfaces_from_vertex_array(
+	struct GT_object *graphics_object)
+{
+	if (!(graphics_object && (g_SURFACE_VERTEX_BUFFERS == graphics_object->object_type) &&
+		graphics_object->vertex_array && graphics_object->primitive_lists))
+	{
+		display_message(ERROR_MESSAGE,
+			"GT_object_create_surfaces_from_vertex_array.  Invalid argument(s)");
+		return 0;
+	}
+	Graphics_vertex_array *array = graphics_object->vertex_array;
+	GLfloat *position_buffer = 0, *normal_buffer = 0, *texture_coordinate_buffer = 0,
+		*data_buffer = 0;
+	unsigned int *index_buffer = 0;
+	unsigned int position_values_per_vertex = 0, normal_values_per_vertex = 0,
+		texture_coordinate_values_per_vertex = 0, data_values_per_vertex = 0,
+		index_values_per_vertex = 0, number_of_vertices = 0, number_of_values = 0;
+	array->get_float_vertex_buffer(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_POSITION,
+		&position_buffer, &position_values_per_vertex, &number_of_vertices);
+	array->get_float_vertex_buffer(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_NORMAL,
+		&normal_buffer, &normal_values_per_vertex, &number_of_values);
+	if (number_of_values != number_of_vertices)
+	{
+		normal_buffer = 0;
+	}
+	array->get_float_vertex_buffer(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_TEXTURE_COORDINATE_ZERO,
+		&texture_coordinate_buffer, &texture_coordinate_values_per_vertex, &number_of_values);
+	if (number_of_values != number_of_vertices)
+	{
+		texture_coordinate_buffer = 0;
+	}
+	array->get_float_vertex_buffer(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_DATA,
+		&data_buffer, &data_values_per_vertex, &number_of_values);
+	if (number_of_values != number_of_vertices)
+	{
+		data_buffer = 0;
+	}
+	array->get_unsigned_integer_vertex_buffer(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_INDEX,
+		&index_buffer, &index_values_per_vertex, &number_of_values);
+	const unsigned int number_of_primitives = array->get_number_of_vertices(
+		GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_ID);
+	const enum Cmiss_graphics_render_type render_type =
+		graphics_object->primitive_lists->gt_surface_vertex_buffers ?
+		graphics_object->primitive_lists->gt_surface_vertex_buffers->render_type :
+		CMISS_GRAPHICS_RENDER_TYPE_SHADED;
+	const enum GT_surface_type surface_type = texture_coordinate_buffer ?
+		g_SH_DISCONTINUOUS_TEXMAP : g_SH_DISCONTINUOUS;
+	struct GT_object *surfaces = CREATE(GT_object)(graphics_object->name, g_SURFACE,
+		graphics_object->default_material);
+	int return_code = (0 != surfaces);
+	for (unsigned int p = 0; return_code && (p < number_of_primitives); ++p)
+	{
+		int object_name = 0;
+		unsigned int index_start = 0, index_count = 0;
+		array->get_integer_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_ID,
+			p, 1, &object_name);
+		array->get_unsigned_integer_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_ELEMENT_INDEX_START,
+			p, 1, &index_start);
+		array->get_unsigned_integer_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_ELEMENT_INDEX_COUNT,
+			p, 1, &index_count);
+		const int number_of_triangles = static_cast<int>(index_count/3);
+		if ((!index_buffer) || (0 == number_of_triangles))
+		{
+			continue;
+		}
+		const int number_of_points = 3*number_of_triangles;
+		Triple *points = 0, *normals = 0, *texture_coordinates = 0;
+		GLfloat *data = 0;
+		if (ALLOCATE(points, Triple, number_of_points) &&
+			((!normal_buffer) || ALLOCATE(normals, Triple, number_of_points)) &&
+			((!texture_coordinate_buffer) || ALLOCATE(texture_coordinates, Triple, number_of_points)) &&
+			((!data_buffer) || ALLOCATE(data, GLfloat, data_values_per_vertex*number_of_points)))
+		{
+			for (int i = 0; i < number_of_points; ++i)
+			{
+				const unsigned int vertex = index_buffer[index_start + i];
+				for (int j = 0; j < 3; ++j)
+				{
+					points[i][j] = (j < static_cast<int>(position_values_per_vertex)) ?
+						position_buffer[vertex*position_values_per_vertex + j] : 0.0f;
+					if (normals)
+					{
+						normals[i][j] = normal_buffer[vertex*normal_values_per_vertex + j];
+					}
+					if (texture_coordinates)
+					{
+						texture_coordinates[i][j] = (j < static_cast<int>(texture_coordinate_values_per_vertex)) ?
+							texture_coordinate_buffer[vertex*texture_coordinate_values_per_vertex + j] : 0.0f;
+					}
+				}
+				if (data)
+				{
+					memcpy(data + i*data_values_per_vertex, data_buffer + vertex*data_values_per_vertex,
+						data_values_per_vertex*sizeof(GLfloat));
+				}
+			}
+			struct GT_surface *surface = CREATE(GT_surface)(surface_type, render_type,
+				g_TRIANGLE, number_of_triangles, 3, points, normals, /*tangentlist*/0,
+				texture_coordinates, data ? static_cast<int>(data_values_per_vertex) : 0, data);
+			if (surface)
+			{
+				GT_surface_set_integer_identifier(surface, object_name);
+				if (!GT_OBJECT_ADD(GT_surface)(surfaces, /*time*/0.0, surface))
+				{
+					DESTROY(GT_surface)(&surface);
+					return_code = 0;
+				}
+				continue;
+			}
+		}
+		DEALLOCATE(points);
+		DEALLOCATE(normals);
+		DEALLOCATE(texture_coordinates);
+		DEALLOCATE(data);
+		return_code = 0;
+	}
+	if (!return_code)
+	{
+		display_message(ERROR_MESSAGE,
+			"GT_object_create_surfaces_from_vertex_array.  Failed");
+		if (surfaces)
+		{
+			DESTROY(GT_object)(&surfaces);
+		}
+	}
+	return surfaces;
+}
+
+Graphics_vertex_array *GT_object_create_packed_surface_vertex_array(
+	struct GT_object *graphics_object)
+{
+	if (!(graphics_object && (g_SURFACE == graphics_object->object_type)))
+	{
+		return 0;
+	}
+	Graphics_vertex_array *array = new Graphics_vertex_array(
+		GRAPHICS_VERTEX_ARRAY_TYPE_FLOAT_SEPARATE_DRAW_ARRAYS);
+	if (!GT_object_pack_surfaces(graphics_object, array))
+	{
+		delete array;
+		array = 0;
+	}
+	return array;
+}
+
+Graphics_vertex_array *GT_object_get_packed_surface_vertex_array(
+	struct GT_object *graphics_object)
+{
+	if (!(graphics_object && (g_SURFACE == graphics_object->object_type)))
+	{
+		return 0;
+	}
+	if (1 == graphics_object->vertex_array_packed)
+	{
+		return graphics_object->vertex_array;
+	}
+	if (!graphics_object->vertex_array)
+	{
+		graphics_object->vertex_array = new Graphics_vertex_array(
+			GRAPHICS_VERTEX_ARRAY_TYPE_FLOAT_SEPARATE_DRAW_ARRAYS);
+	}
+	if (!GT_object_pack_surfaces(graphics_object, graphics_object->vertex_array))
+	{
+		graphics_object->vertex_array_packed = 0;
+		return 0;
+	}
+	graphics_object->vertex_array_packed = 1;
+	return graphics_object->vertex_array;
+}
+
+int GT_object_release_packed_surface_vertices(struct GT_object *graphics_object)
+{
+	if (graphics_object && (g_SURFACE == graphics_object->object_type) &&
+		graphics_object->vertex_array && graphics_object->vertex_array_packed)
+	{
+		Graphics_vertex_array *array = graphics_object->vertex_array;
+		array->free_buffer(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_POSITION);
+		array->free_buffer(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_NORMAL);
+		array->free_buffer(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_TEXTURE_COORDINATE_ZERO);
+		array->free_buffer(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_DATA);
+		graphics_object->vertex_array_packed = 2;
+		return 1;
+	}
+	return 0;
+}
+
 ZnReal GT_object_get_time(struct GT_object *graphics_object,int time_number)
 /*******************************************************************************
 LAST MODIFIED : 18 June 1998
@@ -4886,6 +5540,7 @@ will produce the range of all the graphics objects.
 						}
 					} break;
 					case g_POLYLINE_VERTEX_BUFFERS:
+					case g_SURFACE_VERTEX_BUFFERS:
 					{
 						GLfloat *vertex_buffer;
 						unsigned int values_per_vertex, vertex_count;
@@ -5259,6 +5914,7 @@ valid.
 						}
 					} break;
 					case g_POLYLINE_VERTEX_BUFFERS:
+					case g_SURFACE_VERTEX_BUFFERS:
 					{
 						GLfloat *vertex_buffer = NULL;
 						unsigned int values_per_vertex = 0, vertex_count = 0;
@@ -5655,6 +6311,26 @@ int GT_OBJECT_ADD(GT_polyline_vertex_buffers)(
 	return (return_code);
 }
 
+int GT_OBJECT_ADD(GT_surface_vertex_buffers)(
+	struct GT_object *graphics_object, struct GT_surface_vertex_buffers *primitive)
+{
+	int return_code = 0;
+
+	if (graphics_object && (g_SURFACE_VERTEX_BUFFERS == graphics_object->object_type) &&
+		!graphics_object->primitive_lists)
+	{
+		if (ALLOCATE(graphics_object->primitive_lists, union GT_primitive_list, 1) &&
+			ALLOCATE(graphics_object->times, ZnReal, 1))
+		{
+			graphics_object->primitive_lists->gt_surface_vertex_buffers = primitive;
+			graphics_object->times[0] = 0.0;
+			graphics_object->number_of_times = 1;
+			return_code = 1;
+		}
+	}
+	return (return_code);
+}
+
 #define DECLARE_GT_OBJECT_GET_FUNCTION(primitive_type, \
 	gt_object_type,primitive_var) \
 PROTOTYPE_GT_OBJECT_GET_FUNCTION(primitive_type) \
@@ -5725,21 +6401,12 @@ from the conditional_function causes the primitive to be removed.
 	ENTER(GT_object_remove_primitives_at_time);
 	if (graphics_object)
 	{
-		if (graphics_object->object_type == g_POLYLINE_VERTEX_BUFFERS)
+		if ((graphics_object->object_type == g_POLYLINE_VERTEX_BUFFERS) ||
+			(graphics_object->object_type == g_SURFACE_VERTEX_BUFFERS))
 		{
-			if (graphics_object->number_of_times &&
-				graphics_object->primitive_lists)
-			{
-				graphics_object->number_of_times = 0;
-				DESTROY(GT_polyline_vertex_buffers)(
-					&graphics_object->primitive_lists->gt_polyline_vertex_buffers);
-				DEALLOCATE(graphics_object->primitive_lists);
-				DEALLOCATE(graphics_object->times);
-			}
-			if (graphics_object->vertex_array)
-			{
-				graphics_object->vertex_array->clear_buffers();
-			}
+			/* all primitives are in one vertex array at a single time */
+			return_code = GT_object_remove_primitives_at_time_number(
+				graphics_object, /*time_number*/1, conditional_function, user_data);
 		}
 		else
 		{
@@ -5846,6 +6513,58 @@ Primitives are added after any in <destination> at <time>.
 	ENTER(GT_object_transfer_primitives_at_time);
 	return_code = 0;
 	if (destination && source &&
+		(destination->object_type == source->object_type) &&
+		((g_POLYLINE_VERTEX_BUFFERS == source->object_type) ||
+			(g_SURFACE_VERTEX_BUFFERS == source->object_type)))
+	{
+		/* append vertex array primitives, which are at all times */
+		return_code = 1;
+		if (!destination->primitive_lists && source->primitive_lists)
+		{
+			/* copy the rendition information to an empty destination */
+			if (g_POLYLINE_VERTEX_BUFFERS == source->object_type)
+			{
+				GT_polyline_vertex_buffers *source_lines =
+					source->primitive_lists->gt_polyline_vertex_buffers;
+				GT_polyline_vertex_buffers *lines = CREATE(GT_polyline_vertex_buffers)(
+					source_lines->polyline_type, source_lines->line_width);
+				if (!(lines && GT_OBJECT_ADD(GT_polyline_vertex_buffers)(destination, lines)))
+				{
+					if (lines)
+						DESTROY(GT_polyline_vertex_buffers)(&lines);
+					return_code = 0;
+				}
+			}
+			else
+			{
+				GT_surface_vertex_buffers *source_surfaces =
+					source->primitive_lists->gt_surface_vertex_buffers;
+				GT_surface_vertex_buffers *surfaces = CREATE(GT_surface_vertex_buffers)(
+					source_surfaces->surface_type, source_surfaces->render_type);
+				if (!(surfaces && GT_OBJECT_ADD(GT_surface_vertex_buffers)(destination, surfaces)))
+				{
+					if (surfaces)
+						DESTROY(GT_surface_vertex_buffers)(&surfaces);
+					return_code = 0;
+				}
+			}
+		}
+		if (return_code && destination->vertex_array && source->vertex_array &&
+			destination->vertex_array->append_primitives(*(source->vertex_array)))
+		{
+			source->vertex_array->clear_buffers();
+			GT_object_changed(source);
+			GT_object_changed(destination);
+			return_code = 1;
+		}
+		else
+		{
+			display_message(ERROR_MESSAGE,
+				"GT_object_transfer_primitives_at_time.  Could not append vertex arrays");
+			return_code = 0;
+		}
+	}
+	else if (destination && source &&
 		(destination->object_type == source->object_type) && source->times &&
 		(0 < (time_number = GT_object_get_time_number(source, time))) &&
 		(source->times[time_number - 1] == time))
@@ -7663,6 +8382,248 @@ int Graphics_vertex_array::get_integer_attribute(
 		vertex_index, number_of_values, values);
 }
 
+int Graphics_vertex_array::get_integer_vertex_buffer(
+		Graphics_vertex_array_attribute_type vertex_buffer_type,
+		int **vertex_buffer, unsigned int *values_per_vertex,
+		unsigned int *vertex_count)
+{
+	return internal->get_vertex_buffer(vertex_buffer_type,
+		vertex_buffer, values_per_vertex, vertex_count);
+}
+
+/* attributes with values for each vertex, which are all 4 byte values */
+static const Graphics_vertex_array_attribute_type
+	Graphics_vertex_array_per_vertex_attributes[] =
+{
+	GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_POSITION,
+	GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_NORMAL,
+	GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_COLOUR,
+	GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_DATA,
+	GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_TEXTURE_COORDINATE_ZERO
+};
+
+static const int Graphics_vertex_array_number_of_per_vertex_attributes =
+	sizeof(Graphics_vertex_array_per_vertex_attributes) /
+	sizeof(Graphics_vertex_array_attribute_type);
+
+int Graphics_vertex_array::remove_primitives(
+	int (*conditional_function)(int identifier, void *user_data), void *user_data)
+{
+	if (!conditional_function)
+	{
+		return 0;
+	}
+	Graphics_vertex_buffer *id_buffer =
+		internal->get_vertex_buffer(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_ID);
+	if ((!id_buffer) || (0 == id_buffer->vertex_count))
+	{
+		return 1;
+	}
+	const unsigned int number_of_primitives = id_buffer->vertex_count;
+	Graphics_vertex_buffer *index_start_buffer =
+		internal->get_vertex_buffer(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_ELEMENT_INDEX_START);
+	Graphics_vertex_buffer *index_count_buffer =
+		internal->get_vertex_buffer(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_ELEMENT_INDEX_COUNT);
+	Graphics_vertex_buffer *index_buffer =
+		internal->get_vertex_buffer(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_INDEX);
+	/* unindexed primitives use the vertices in their index range */
+	Graphics_vertex_buffer *vertex_start_buffer = index_buffer ?
+		internal->get_vertex_buffer(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_ELEMENT_VERTEX_START) :
+		index_start_buffer;
+	Graphics_vertex_buffer *vertex_count_buffer = index_buffer ?
+		internal->get_vertex_buffer(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_ELEMENT_VERTEX_COUNT) :
+		index_count_buffer;
+	if (!(index_start_buffer && (index_start_buffer->vertex_count == number_of_primitives) &&
+		index_count_buffer && (index_count_buffer->vertex_count == number_of_primitives) &&
+		vertex_start_buffer && (vertex_start_buffer->vertex_count == number_of_primitives) &&
+		vertex_count_buffer && (vertex_count_buffer->vertex_count == number_of_primitives)))
+	{
+		return 0;
+	}
+	const unsigned int number_of_vertices = get_number_of_vertices(
+		GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_POSITION);
+	Graphics_vertex_buffer *vertex_buffers[
+		sizeof(Graphics_vertex_array_per_vertex_attributes) /
+		sizeof(Graphics_vertex_array_attribute_type)];
+	int number_of_vertex_buffers = 0;
+	for (int a = 0; a < Graphics_vertex_array_number_of_per_vertex_attributes; ++a)
+	{
+		Graphics_vertex_buffer *buffer =
+			internal->get_vertex_buffer(Graphics_vertex_array_per_vertex_attributes[a]);
+		if (buffer && (0 < buffer->vertex_count))
+		{
+			if (buffer->vertex_count != number_of_vertices)
+			{
+				return 0;
+			}
+			vertex_buffers[number_of_vertex_buffers++] = buffer;
+		}
+	}
+	int *identifiers = static_cast<int *>(id_buffer->memory);
+	unsigned int *index_starts = static_cast<unsigned int *>(index_start_buffer->memory);
+	unsigned int *index_counts = static_cast<unsigned int *>(index_count_buffer->memory);
+	unsigned int *vertex_starts = static_cast<unsigned int *>(vertex_start_buffer->memory);
+	unsigned int *vertex_counts = static_cast<unsigned int *>(vertex_count_buffer->memory);
+	unsigned int *indices = index_buffer ?
+		static_cast<unsigned int *>(index_buffer->memory) : 0;
+	const unsigned int number_of_indices = index_buffer ? index_buffer->vertex_count : 0;
+	/* check ranges are in order and indexed primitives only use their own
+		vertices, so they can be moved down in place */
+	unsigned int p, i;
+	unsigned int vertex_end = 0, index_end = 0;
+	for (p = 0; p < number_of_primitives; ++p)
+	{
+		if ((vertex_starts[p] < vertex_end) ||
+			(number_of_vertices - vertex_starts[p] < vertex_counts[p]))
+		{
+			return 0;
+		}
+		vertex_end = vertex_starts[p] + vertex_counts[p];
+		if (indices)
+		{
+			if ((index_starts[p] < index_end) ||
+				(number_of_indices - index_starts[p] < index_counts[p]))
+			{
+				return 0;
+			}
+			index_end = index_starts[p] + index_counts[p];
+			for (i = index_starts[p]; i < index_end; ++i)
+			{
+				if ((indices[i] < vertex_starts[p]) || (vertex_end <= indices[i]))
+				{
+					return 0;
+				}
+			}
+		}
+	}
+	unsigned int kept_primitives = 0, kept_vertices = 0, kept_indices = 0;
+	for (p = 0; p < number_of_primitives; ++p)
+	{
+		if ((conditional_function)(identifiers[p], user_data))
+		{
+			continue;
+		}
+		const unsigned int vertex_start = vertex_starts[p];
+		const unsigned int primitive_vertices = vertex_counts[p];
+		if (vertex_start != kept_vertices)
+		{
+			for (int b = 0; b < number_of_vertex_buffers; ++b)
+			{
+				const size_t vertex_size = vertex_buffers[b]->values_per_vertex*sizeof(GLfloat);
+				char *memory = static_cast<char *>(vertex_buffers[b]->memory);
+				memmove(memory + kept_vertices*vertex_size, memory + vertex_start*vertex_size,
+					primitive_vertices*vertex_size);
+			}
+		}
+		if (indices)
+		{
+			const unsigned int index_start = index_starts[p];
+			const unsigned int primitive_indices = index_counts[p];
+			for (i = 0; i < primitive_indices; ++i)
+			{
+				indices[kept_indices + i] = indices[index_start + i] - vertex_start + kept_vertices;
+			}
+			index_starts[kept_primitives] = kept_indices;
+			index_counts[kept_primitives] = primitive_indices;
+			vertex_starts[kept_primitives] = kept_vertices;
+			vertex_counts[kept_primitives] = primitive_vertices;
+			kept_indices += primitive_indices;
+		}
+		else
+		{
+			index_starts[kept_primitives] = kept_vertices;
+			index_counts[kept_primitives] = primitive_vertices;
+		}
+		identifiers[kept_primitives] = identifiers[p];
+		kept_vertices += primitive_vertices;
+		++kept_primitives;
+	}
+	for (int b = 0; b < number_of_vertex_buffers; ++b)
+	{
+		vertex_buffers[b]->vertex_count = kept_vertices;
+	}
+	if (index_buffer)
+	{
+		index_buffer->vertex_count = kept_indices;
+	}
+	id_buffer->vertex_count = kept_primitives;
+	index_start_buffer->vertex_count = kept_primitives;
+	index_count_buffer->vertex_count = kept_primitives;
+	vertex_start_buffer->vertex_count = kept_primitives;
+	vertex_count_buffer->vertex_count = kept_primitives;
+	return 1;
+}
+
+/**
+ * Appends the unsigned integer values of the source_type buffer of source to
+ * the buffer of the same type in array, adding offset to each value.
+ */
+static int Graphics_vertex_array_append_offset_values(Graphics_vertex_array *array,
+	Graphics_vertex_array *source, Graphics_vertex_array_attribute_type source_type,
+	unsigned int offset)
+{
+	unsigned int *values = 0;
+	unsigned int values_per_vertex = 0, number_of_values = 0;
+	if (!(source->get_unsigned_integer_vertex_buffer(source_type, &values,
+		&values_per_vertex, &number_of_values) && (0 < number_of_values)))
+	{
+		return 1;
+	}
+	std::vector<unsigned int> offset_values(values, values + values_per_vertex*number_of_values);
+	for (size_t i = 0; i < offset_values.size(); ++i)
+	{
+		offset_values[i] += offset;
+	}
+	return array->add_unsigned_integer_attribute(source_type, values_per_vertex,
+		number_of_values, &(offset_values[0]));
+}
+
+int Graphics_vertex_array::append_primitives(Graphics_vertex_array& source)
+{
+	Graphics_vertex_buffer *source_id_buffer =
+		source.internal->get_vertex_buffer(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_ID);
+	if ((!source_id_buffer) || (0 == source_id_buffer->vertex_count))
+	{
+		return 1;
+	}
+	const unsigned int first_vertex = get_number_of_vertices(
+		GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_POSITION);
+	const unsigned int first_index = get_number_of_vertices(
+		GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_INDEX);
+	const bool indexed = (0 != source.internal->get_vertex_buffer(
+		GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_INDEX));
+	int return_code = 1;
+	for (int a = 0; return_code && (a < Graphics_vertex_array_number_of_per_vertex_attributes); ++a)
+	{
+		Graphics_vertex_buffer *buffer = source.internal->get_vertex_buffer(
+			Graphics_vertex_array_per_vertex_attributes[a]);
+		if (buffer && (0 < buffer->vertex_count))
+		{
+			return_code = internal->add_attribute(Graphics_vertex_array_per_vertex_attributes[a],
+				buffer->values_per_vertex, buffer->vertex_count,
+				static_cast<const GLfloat *>(buffer->memory));
+		}
+	}
+	if (return_code)
+	{
+		return_code = internal->add_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_ID,
+				source_id_buffer->values_per_vertex, source_id_buffer->vertex_count,
+				static_cast<const int *>(source_id_buffer->memory)) &&
+			Graphics_vertex_array_append_offset_values(this, &source,
+				GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_INDEX, first_vertex) &&
+			Graphics_vertex_array_append_offset_values(this, &source,
+				GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_ELEMENT_INDEX_START,
+				indexed ? first_index : first_vertex) &&
+			Graphics_vertex_array_append_offset_values(this, &source,
+				GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_ELEMENT_INDEX_COUNT, 0) &&
+			Graphics_vertex_array_append_offset_values(this, &source,
+				GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_ELEMENT_VERTEX_START, first_vertex) &&
+			Graphics_vertex_array_append_offset_values(this, &source,
+				GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_ELEMENT_VERTEX_COUNT, 0);
+	}
+	return return_code;
+}
+
 unsigned int Graphics_vertex_array::get_number_of_vertices(
 	Graphics_vertex_array_attribute_type vertex_buffer_type)
 {
@@ -7681,6 +8642,32 @@ unsigned int Graphics_vertex_array::get_number_of_vertices(
 	return vertex_count;
 }
 
+/**
+ * Adds the bytes allocated for buffer to the size_t at memory_size_void.
+ */
+static int Graphics_vertex_buffer_add_memory_size(
+	struct Graphics_vertex_buffer *buffer, void *memory_size_void)
+{
+	size_t *memory_size = static_cast<size_t *>(memory_size_void);
+	if (buffer && memory_size)
+	{
+		/* float, integer and unsigned integer values are all 4 bytes */
+		*memory_size += sizeof(struct Graphics_vertex_buffer) +
+			static_cast<size_t>(buffer->max_vertex_count)*buffer->values_per_vertex*sizeof(GLfloat);
+		return 1;
+	}
+	return 0;
+}
+
+size_t Graphics_vertex_array::get_memory_size()
+{
+	size_t memory_size = 0;
+	FOR_EACH_OBJECT_IN_LIST(Graphics_vertex_buffer)(
+		Graphics_vertex_buffer_add_memory_size, static_cast<void *>(&memory_size),
+		internal->buffer_list);
+	return memory_size;
+}
+
 /*****************************************************************************//**
  * Resets the number of vertices defined in the buffer to zero.  Does not actually
  * reset the allocated memory to zero as it is anticipated that the buffer will
@@ -7710,6 +8697,19 @@ int Graphics_vertex_array::clear_buffers()
 		Graphics_vertex_buffer_clear, NULL, internal->buffer_list);
 }
 
+int Graphics_vertex_array::free_buffer(
+	Graphics_vertex_array_attribute_type vertex_type)
+{
+	Graphics_vertex_buffer *buffer =
+		internal->get_vertex_buffer_for_attribute(vertex_type);
+	if (buffer)
+	{
+		return REMOVE_OBJECT_FROM_LIST(Graphics_vertex_buffer)(buffer,
+			internal->buffer_list);
+	}
+	return 1;
+}
+
 Graphics_vertex_array::~Graphics_vertex_array()
 {
 	delete internal;
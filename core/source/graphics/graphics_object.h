@@ -129,6 +129,7 @@ without knowing which order the types are in.
 	g_USERDEF,
 	g_VOLTEX,
 	g_POLYLINE_VERTEX_BUFFERS,
+	g_SURFACE_VERTEX_BUFFERS,
 	g_OBJECT_TYPE_AFTER_LAST
 };
 
@@ -300,6 +301,7 @@ struct GT_pointset;
 struct GT_polyline;
 struct GT_polyline_vertex_buffers;
 struct GT_surface;
+struct GT_surface_vertex_buffers;
 struct GT_userdef;
 struct GT_voltex;
 
@@ -800,6 +802,11 @@ Frees the memory for <**polyline> and its fields and sets <*polyline> to NULL.
 struct GT_polyline_vertex_buffers *CREATE(GT_polyline_vertex_buffers)(
 	enum GT_polyline_type polyline_type, int line_width);
 
+/***************************************************************************//**
+ * Destroys the polyline rendition information.
+ */
+int DESTROY(GT_polyline_vertex_buffers)(struct GT_polyline_vertex_buffers **polyline);
+
 int GT_polyline_set_integer_identifier(struct GT_polyline *polyline,
 	int identifier);
 /*******************************************************************************
@@ -829,6 +836,16 @@ DESCRIPTION :
 Frees the memory for <**surface> and sets <*surface> to NULL.
 ==============================================================================*/
 
+/***************************************************************************//**
+ * Creates the shared rendition information for a GT_surface_vertex_buffers,
+ * an indexed triangle mesh whose vertices and triangle indices are stored in
+ * the graphics object's vertex array.
+ */
+struct GT_surface_vertex_buffers *CREATE(GT_surface_vertex_buffers)(
+	enum GT_surface_type surface_type, enum Cmiss_graphics_render_type render_type);
+
+int DESTROY(GT_surface_vertex_buffers)(struct GT_surface_vertex_buffers **surface);
+
 int GT_surface_set_integer_identifier(struct GT_surface *surface,
 	int identifier);
 /*******************************************************************************
@@ -1028,6 +1045,57 @@ Returns true if <graphics_object> has primitives stored exactly at <time>.
  */
 struct Graphics_vertex_array *GT_object_get_vertex_set(struct GT_object *graphics_object);
 
+/***************************************************************************//**
+ * Creates a new vertex set holding the surface primitives of a g_SURFACE
+ * graphics object packed into contiguous arrays: positions, normals, texture
+ * coordinates and data per vertex, triangle vertex indices, and per primitive
+ * its object name and range of triangle indices. Only surfaces at a single
+ * time, without texture tiling or tangents and with the same vertex
+ * attributes in all primitives can be packed.
+ * @return  New vertex set which the caller must delete, or NULL if the
+ * surfaces cannot be packed.
+ */
+struct Graphics_vertex_array *GT_object_create_packed_surface_vertex_array(
+	struct GT_object *graphics_object);
+
+/***************************************************************************//**
+ * Packs the surface primitives of a g_SURFACE graphics object into its own
+ * vertex set as for GT_object_create_packed_surface_vertex_array, for uploading
+ * to the graphics card. The packed arrays are kept until the graphics object
+ * next changes or GT_object_release_packed_surface_vertices is called.
+ * @return  The packed vertex set, or NULL if the surfaces cannot be packed.
+ */
+struct Graphics_vertex_array *GT_object_get_packed_surface_vertex_array(
+	struct GT_object *graphics_object);
+
+/***************************************************************************//**
+ * Frees the per-vertex values of the packed surfaces of the graphics object
+ * once they have been uploaded, keeping the triangle indices and object names
+ * needed to draw them so the values are not held twice alongside the
+ * primitives.
+ * @return  1 if values were released, 0 if the surfaces are not packed.
+ */
+int GT_object_release_packed_surface_vertices(struct GT_object *graphics_object);
+
+/***************************************************************************//**
+ * Appends the triangles of <surface> to the vertex array of a
+ * g_SURFACE_VERTEX_BUFFERS graphics object as one primitive with its own
+ * vertex range, identified by the surface object_name, so it can later be
+ * removed individually. The surface is not kept; caller must destroy it.
+ * @return  1 on success, 0 if the surface has tangents or cannot be packed.
+ */
+int GT_object_add_surface_to_vertex_array(struct GT_object *graphics_object,
+	struct GT_surface *surface);
+
+/***************************************************************************//**
+ * Creates a g_SURFACE graphics object with one discontinuous triangle
+ * GT_surface per primitive in the vertex array of a g_SURFACE_VERTEX_BUFFERS
+ * graphics object, for exporters which only handle surface primitives.
+ * @return  New graphics object, or NULL on failure. Caller must destroy.
+ */
+struct GT_object *GT_object_create_surfaces_from_vertex_array(
+	struct GT_object *graphics_object);
+
 int GT_object_get_number_of_times(struct GT_object *graphics_object);
 /*******************************************************************************
 LAST MODIFIED : 18 June 1998
@@ -1036,6 +1104,14 @@ DESCRIPTION :
 Returns the number of times/primitive lists in the graphics_object.
 ==============================================================================*/
 
+/***************************************************************************//**
+ * Estimates the memory used by the primitives and vertex buffers of the
+ * graphics object at all its times, excluding glyphs, materials and display
+ * lists shared with other objects.
+ * @return  Approximate size in bytes.
+ */
+size_t GT_object_get_memory_size(struct GT_object *graphics_object);
+
 ZnReal GT_object_get_time(struct GT_object *graphics_object,int time_no);
 /*******************************************************************************
 LAST MODIFIED : 18 June 1998
@@ -1126,6 +1202,13 @@ PROTOTYPE_GT_OBJECT_ADD_FUNCTION(GT_voltex);
 int GT_OBJECT_ADD(GT_polyline_vertex_buffers)(
 	struct GT_object *graphics_object, struct GT_polyline_vertex_buffers *primitive);
 
+/*************************************************************************//**
+ * Adds <primitive> to <graphics_object>.  There can be only one time for this
+ * type
+ */
+int GT_OBJECT_ADD(GT_surface_vertex_buffers)(
+	struct GT_object *graphics_object, struct GT_surface_vertex_buffers *primitive);
+
 #if ! defined (SHORT_NAMES)
 #define GT_OBJECT_GET_(primitive_type) GT_object_get_ ## primitive_type
 #else
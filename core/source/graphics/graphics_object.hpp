@@ -49,7 +49,17 @@ enum Graphics_vertex_array_attribute_type
 	/** Specifies that the index of the first vertex for a primitive. */
 	GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_ELEMENT_INDEX_START,
 	/** Records the identifier of a particular primitive for selection and editing. */
-	GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_ID
+	GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_ID,
+	/** Vertex indices for indexed primitives, e.g. 3 per triangle, allowing
+	 * vertices to be shared. For these primitives ELEMENT_INDEX_START and
+	 * ELEMENT_INDEX_COUNT refer to positions in this array. */
+	GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_INDEX,
+	/** Specifies the first vertex used by an indexed primitive whose vertices
+	 * are not shared with any other primitive. */
+	GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_ELEMENT_VERTEX_START,
+	/** Specifies the number of vertices used by an indexed primitive whose
+	 * vertices are not shared with any other primitive. */
+	GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_ELEMENT_VERTEX_COUNT
 	/* Complex types might be like this...
 	 * GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_VERTEX3_NORMAL3
 	 * and element_array indices might be supported with an DRAW_ELEMENTS set
@@ -188,6 +198,41 @@ public:
 		Graphics_vertex_array_attribute_type vertex_type,
 		unsigned int vertex_index,	unsigned int number_of_values, int *values);
 
+	/*****************************************************************************//**
+	 * Retrieve pointer to integer value buffer from set.
+	 * @see get_unsigned_integer_vertex_buffer
+	*/
+	int get_integer_vertex_buffer(
+		Graphics_vertex_array_attribute_type vertex_buffer_type,
+		int **vertex_buffer, unsigned int *values_per_vertex,
+		unsigned int *vertex_count);
+
+	/*****************************************************************************//**
+	 * Removes the primitives whose identifier satisfies the conditional function,
+	 * moving the vertices and indices of the remaining primitives down to keep
+	 * all buffers contiguous. Each primitive's vertices must form a range
+	 * following those of the previous primitive: for unindexed primitives the
+	 * range given by ELEMENT_INDEX_START/COUNT, for indexed primitives the range
+	 * given by ELEMENT_VERTEX_START/COUNT.
+	 *
+	 * @param conditional_function  Called with the ID of each primitive and
+	 * user_data; returns true if the primitive is to be removed.
+	 * @return return_code. 1 for Success, 0 if the primitives cannot be removed
+	 * individually, e.g. indexed primitives sharing vertices, in which case the
+	 * array is unchanged.
+	*/
+	int remove_primitives(int (*conditional_function)(int identifier, void *user_data),
+		void *user_data);
+
+	/*****************************************************************************//**
+	 * Appends all vertices, indices and primitives of source to this array,
+	 * offsetting indices and ranges of the appended primitives. Both arrays must
+	 * have the same vertex attributes.
+	 *
+	 * @return return_code. 1 for Success, 0 for failure.
+	*/
+	int append_primitives(Graphics_vertex_array& source);
+
 	/*****************************************************************************//**
 	 * Gets the current size of specified buffer.
 	 * 
@@ -198,6 +243,11 @@ public:
 	unsigned int get_number_of_vertices(
 		Graphics_vertex_array_attribute_type vertex_type);
 
+	/**
+	 * @return  Number of bytes allocated for all the buffers in the array.
+	 */
+	size_t get_memory_size();
+
 	/**
 	 * Free any unused memory at the end of a buffer
 	 */
@@ -211,6 +261,14 @@ public:
 	*/
 	int clear_buffers();
 
+	/**
+	 * Frees the buffer holding values of the attribute vertex_type, releasing
+	 * its memory.
+	 *
+	 * @return return_code. 1 for Success, 0 for failure.
+	*/
+	int free_buffer(Graphics_vertex_array_attribute_type vertex_type);
+
 };
 
 typedef int (*Graphics_object_glyph_labels_function)(Triple *coordinate_scaling,
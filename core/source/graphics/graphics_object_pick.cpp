@@ -0,0 +1,1057 @@
+/*******************************************************************************
+FILE : graphics_object_pick.cpp
+
+DESCRIPTION :
+Picking of graphics objects on the CPU without OpenGL select mode, using a
+bounding volume hierarchy of the primitives in each GT_object.
+==============================================================================*/
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is cmgui.
+ *
+ * The Initial Developer of the Original Code is
+ * Auckland Uniservices Ltd, Auckland, New Zealand.
+ * Portions created by the Initial Developer are Copyright (C) 2012
+ * the Initial Developer. All Rights Reserved.
+ *
+ * Contributor(s):
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+#include <algorithm>
+#include <map>
+#include <vector>
+#include <float.h>
+#include "zinc/zincconfigure.h"
+#include "general/debug.h"
+#include "general/message.h"
+#include "graphics/graphics_object.h"
+#include "graphics/scene.h"
+#include "interaction/interaction_volume.h"
+#include "graphics/graphics_object_private.hpp"
+#include "graphics/graphics_object_pick.hpp"
+
+namespace {
+
+/* OpenGL select mode returns depths scaled to the full unsigned 32-bit range;
+	 hits are given the same scale so existing comparisons are unchanged */
+const double select_depth_scale = 4294967295.0;
+
+/* number of primitives below which a node is not split */
+const unsigned int bvh_leaf_size = 4;
+
+/** Transforms x,y,z by the 4x4 matrix m, values across rows fastest, giving
+ * homogeneous coordinates h */
+inline void transform_homogeneous(const double *m, const double *x, double *h)
+{
+	for (int i = 0; i < 4; ++i)
+	{
+		h[i] = m[i*4]*x[0] + m[i*4 + 1]*x[1] + m[i*4 + 2]*x[2] + m[i*4 + 3];
+	}
+}
+
+/** Distance of homogeneous point inside clip plane p = 0..5 for
+ * -x, +x, -y, +y, -z, +z; negative if outside */
+inline double clip_plane_distance(const double *h, int p)
+{
+	return (p & 1) ? (h[3] - h[p/2]) : (h[3] + h[p/2]);
+}
+
+/**
+ * Clips a point, line segment or triangle in homogeneous coordinates against
+ * the normalised volume -1 to +1 in x, y and z.
+ * @param near_z, far_z  On success, range of normalised z over clipped part.
+ * @return  true if any part of primitive is inside the volume.
+ */
+bool clip_primitive(int vertex_count, double (*h)[4], double& near_z, double& far_z)
+{
+	/* clipping a triangle by 6 planes gives at most 9 vertices */
+	double buffer[2][9][4];
+	int count = vertex_count;
+	int in = 0;
+	for (int i = 0; i < count; ++i)
+	{
+		for (int j = 0; j < 4; ++j)
+		{
+			buffer[0][i][j] = h[i][j];
+		}
+	}
+	for (int p = 0; p < 6; ++p)
+	{
+		double (*source)[4] = buffer[in];
+		double (*target)[4] = buffer[1 - in];
+		int target_count = 0;
+		if (1 == count)
+		{
+			if (clip_plane_distance(source[0], p) < 0.0)
+			{
+				return false;
+			}
+			continue;
+		}
+		const int edge_count = (2 == count) ? 1 : count;
+		for (int i = 0; i < edge_count; ++i)
+		{
+			const double *a = source[i];
+			const double *b = source[(i + 1) % count];
+			const double da = clip_plane_distance(a, p);
+			const double db = clip_plane_distance(b, p);
+			if (0.0 <= da)
+			{
+				for (int j = 0; j < 4; ++j)
+				{
+					target[target_count][j] = a[j];
+				}
+				++target_count;
+			}
+			if ((0.0 <= da) != (0.0 <= db))
+			{
+				const double t = da/(da - db);
+				for (int j = 0; j < 4; ++j)
+				{
+					target[target_count][j] = a[j] + t*(b[j] - a[j]);
+				}
+				++target_count;
+			}
+			if ((2 == count) && (0.0 <= db))
+			{
+				for (int j = 0; j < 4; ++j)
+				{
+					target[target_count][j] = b[j];
+				}
+				++target_count;
+			}
+		}
+		if (0 == target_count)
+		{
+			return false;
+		}
+		count = target_count;
+		in = 1 - in;
+	}
+	near_z = 1.0;
+	far_z = -1.0;
+	for (int i = 0; i < count; ++i)
+	{
+		const double w = buffer[in][i][3];
+		if (0.0 < w)
+		{
+			const double z = buffer[in][i][2]/w;
+			if (z < near_z)
+			{
+				near_z = z;
+			}
+			if (z > far_z)
+			{
+				far_z = z;
+			}
+		}
+	}
+	return (near_z <= far_z);
+}
+
+/**
+ * Conservative test of an axis-aligned box against the normalised volume.
+ * @param near_z  Set to lower bound of normalised z in box if it is
+ * entirely in front of the eye, otherwise -1.
+ * @return  true if box is entirely outside the volume.
+ */
+bool box_outside_volume(const double *m, const double *minimum,
+	const double *maximum, double& near_z)
+{
+	double h[8][4];
+	for (int c = 0; c < 8; ++c)
+	{
+		double x[3];
+		x[0] = (c & 1) ? maximum[0] : minimum[0];
+		x[1] = (c & 2) ? maximum[1] : minimum[1];
+		x[2] = (c & 4) ? maximum[2] : minimum[2];
+		transform_homogeneous(m, x, h[c]);
+	}
+	for (int p = 0; p < 6; ++p)
+	{
+		int c;
+		for (c = 0; c < 8; ++c)
+		{
+			if (0.0 <= clip_plane_distance(h[c], p))
+			{
+				break;
+			}
+		}
+		if (8 == c)
+		{
+			return true;
+		}
+	}
+	near_z = 1.0;
+	for (int c = 0; c < 8; ++c)
+	{
+		if (h[c][3] <= 0.0)
+		{
+			near_z = -1.0;
+			break;
+		}
+		const double z = h[c][2]/h[c][3];
+		if (z < near_z)
+		{
+			near_z = z;
+		}
+	}
+	return false;
+}
+
+/** @return  Number of primitive list with time not greater than time */
+int GT_object_get_pick_time_number(struct GT_object *graphics_object, ZnReal time)
+{
+	int time_number = 0;
+	if (graphics_object->times)
+	{
+		while (((time_number + 1) < graphics_object->number_of_times) &&
+			(graphics_object->times[time_number + 1] <= time))
+		{
+			++time_number;
+		}
+	}
+	return time_number;
+}
+
+} // anonymous namespace
+
+class Graphics_object_bvh
+{
+private:
+	struct Primitive
+	{
+		unsigned int first_vertex;
+		int vertex_count;
+		int number_of_names;
+		int names[2];
+	};
+
+	/* leaf if count > 0 with primitives first..first+count-1, otherwise
+		 children are the next node and node number first */
+	struct Node
+	{
+		double minimum[3], maximum[3];
+		unsigned int first, count;
+	};
+
+	int time_number;
+	std::vector<double> vertices;
+	std::vector<Primitive> primitives;
+	std::vector<Node> nodes;
+
+	template <typename Coordinate> void add_vertex(const Coordinate *x)
+	{
+		vertices.push_back(static_cast<double>(x[0]));
+		vertices.push_back(static_cast<double>(x[1]));
+		vertices.push_back(static_cast<double>(x[2]));
+	}
+
+	void begin_primitive(int vertex_count, int number_of_names, int name1, int name2)
+	{
+		Primitive primitive;
+		primitive.first_vertex = static_cast<unsigned int>(vertices.size()/3);
+		primitive.vertex_count = vertex_count;
+		primitive.number_of_names = number_of_names;
+		primitive.names[0] = name1;
+		primitive.names[1] = name2;
+		primitives.push_back(primitive);
+	}
+
+	template <typename Coordinate> void add_point(const Coordinate *x,
+		int number_of_names, int name1 = 0, int name2 = 0)
+	{
+		begin_primitive(1, number_of_names, name1, name2);
+		add_vertex(x);
+	}
+
+	template <typename Coordinate> void add_line(const Coordinate *x1,
+		const Coordinate *x2, int number_of_names, int name1 = 0)
+	{
+		begin_primitive(2, number_of_names, name1, 0);
+		add_vertex(x1);
+		add_vertex(x2);
+	}
+
+	template <typename Coordinate> void add_triangle(const Coordinate *x1,
+		const Coordinate *x2, const Coordinate *x3, int number_of_names,
+		int name1 = 0, int name2 = 0)
+	{
+		begin_primitive(3, number_of_names, name1, name2);
+		add_vertex(x1);
+		add_vertex(x2);
+		add_vertex(x3);
+	}
+
+	void add_glyph_set(struct GT_glyph_set *glyph_set);
+
+	void add_vertex_array_primitives(Graphics_vertex_array *vertex_array,
+		bool lines, bool discontinuous);
+
+	void get_primitive_range(const Primitive& primitive, double *minimum,
+		double *maximum) const;
+
+	unsigned int build_node(std::vector<unsigned int>& order, unsigned int begin,
+		unsigned int end, const std::vector<double>& centres);
+
+public:
+	Graphics_object_bvh(struct GT_object *graphics_object, int time_number_in);
+
+	int get_time_number() const
+	{
+		return time_number;
+	}
+
+	void pick(Scene_pick_context& pick_context, const double *local_to_normalised,
+		int number_of_prefix_names, const int *prefix_names, bool use_names) const;
+};
+
+Graphics_object_bvh::Graphics_object_bvh(struct GT_object *graphics_object,
+	int time_number_in) :
+	time_number(time_number_in)
+{
+	union GT_primitive_list *primitive_list = graphics_object->primitive_lists ?
+		graphics_object->primitive_lists + time_number : 0;
+	if (primitive_list)
+	{
+		switch (graphics_object->object_type)
+		{
+			case g_GLYPH_SET:
+			{
+				for (GT_glyph_set *glyph_set = primitive_list->gt_glyph_set.first;
+					glyph_set; glyph_set = glyph_set->ptrnext)
+				{
+					add_glyph_set(glyph_set);
+				}
+			} break;
+			case g_POINT:
+			{
+				for (GT_point *point = primitive_list->gt_point.first; point;
+					point = point->ptrnext)
+				{
+					if (point->position)
+					{
+						add_point(*(point->position), /*number_of_names*/0);
+					}
+				}
+			} break;
+			case g_POINTSET:
+			{
+				for (GT_pointset *point_set = primitive_list->gt_pointset.first;
+					point_set; point_set = point_set->ptrnext)
+				{
+					/* as in draw_pointsetGL, points are only picked if named */
+					Triple *point = point_set->pointlist;
+					if (!(point && point_set->names))
+					{
+						continue;
+					}
+					for (int i = 0; i < point_set->n_pts; ++i)
+					{
+						const int name = point_set->names[i];
+						add_point(*point, 1, name);
+						++point;
+						if (g_DERIVATIVE_MARKER == point_set->marker_type)
+						{
+							/* derivative end points are named 1, 2, 3 below the point */
+							for (int j = 1; j <= 3; ++j)
+							{
+								if (((*point)[0] != point[-j][0]) || ((*point)[1] != point[-j][1]) ||
+									((*point)[2] != point[-j][2]))
+								{
+									add_point(*point, 2, name, j);
+								}
+								++point;
+							}
+						}
+					}
+				}
+			} break;
+			case g_POLYLINE:
+			{
+				for (GT_polyline *line = primitive_list->gt_polyline.first; line;
+					line = line->ptrnext)
+				{
+					Triple *point = line->pointlist;
+					if (!point)
+					{
+						continue;
+					}
+					if ((g_PLAIN_DISCONTINUOUS == line->polyline_type) ||
+						(g_NORMAL_DISCONTINUOUS == line->polyline_type))
+					{
+						for (int i = 0; i < line->n_pts; ++i)
+						{
+							add_line(point[2*i], point[2*i + 1], 1, line->object_name);
+						}
+					}
+					else
+					{
+						for (int i = 1; i < line->n_pts; ++i)
+						{
+							add_line(point[i - 1], point[i], 1, line->object_name);
+						}
+					}
+				}
+			} break;
+			case g_POLYLINE_VERTEX_BUFFERS:
+			{
+				GT_polyline_vertex_buffers *line = primitive_list->gt_polyline_vertex_buffers;
+				if (line)
+				{
+					add_vertex_array_primitives(graphics_object->vertex_array, /*lines*/true,
+						(g_PLAIN_DISCONTINUOUS == line->polyline_type) ||
+						(g_NORMAL_DISCONTINUOUS == line->polyline_type));
+				}
+			} break;
+			case g_SURFACE:
+			{
+				std::vector<unsigned int> triangles;
+				for (GT_surface *surface = primitive_list->gt_surface.first; surface;
+					surface = surface->ptrnext)
+				{
+					triangles.clear();
+					if (surface->pointlist &&
+						GT_surface_add_triangle_indices(surface, /*first_vertex*/0, triangles))
+					{
+						Triple *point = surface->pointlist;
+						for (size_t i = 0; (i + 2) < triangles.size(); i += 3)
+						{
+							add_triangle(point[triangles[i]], point[triangles[i + 1]],
+								point[triangles[i + 2]], 1, surface->object_name);
+						}
+					}
+				}
+			} break;
+			case g_SURFACE_VERTEX_BUFFERS:
+			{
+				add_vertex_array_primitives(graphics_object->vertex_array, /*lines*/false,
+					/*discontinuous*/false);
+			} break;
+			case g_VOLTEX:
+			{
+				for (GT_voltex *voltex = primitive_list->gt_voltex.first; voltex;
+					voltex = voltex->ptrnext)
+				{
+					for (int i = 0; i < voltex->number_of_triangles; ++i)
+					{
+						VT_iso_vertex **triangle_vertices = voltex->triangle_list[i]->vertices;
+						add_triangle(triangle_vertices[0]->coordinates,
+							triangle_vertices[1]->coordinates, triangle_vertices[2]->coordinates,
+							1, voltex->object_name);
+					}
+				}
+			} break;
+			default:
+			{
+				/* nurbs and user defined objects are not pickable */
+			} break;
+		}
+	}
+	const unsigned int number_of_primitives = static_cast<unsigned int>(primitives.size());
+	if (0 < number_of_primitives)
+	{
+		std::vector<unsigned int> order(number_of_primitives);
+		std::vector<double> centres(3*number_of_primitives);
+		double minimum[3], maximum[3];
+		for (unsigned int i = 0; i < number_of_primitives; ++i)
+		{
+			order[i] = i;
+			get_primitive_range(primitives[i], minimum, maximum);
+			for (int j = 0; j < 3; ++j)
+			{
+				centres[3*i + j] = 0.5*(minimum[j] + maximum[j]);
+			}
+		}
+		nodes.reserve(2*(number_of_primitives/bvh_leaf_size) + 1);
+		build_node(order, 0, number_of_primitives, centres);
+		/* store primitives in leaf order */
+		std::vector<Primitive> ordered_primitives(number_of_primitives);
+		for (unsigned int i = 0; i < number_of_primitives; ++i)
+		{
+			ordered_primitives[i] = primitives[order[i]];
+		}
+		primitives.swap(ordered_primitives);
+	}
+}
+
+/**
+ * Adds the bounding box of each glyph in the set as 12 triangles, or the point
+ * itself if there is no glyph. Names match those loaded by draw_glyphsetGL.
+ */
+void Graphics_object_bvh::add_glyph_set(struct GT_glyph_set *glyph_set)
+{
+	if (!(glyph_set->point_list && glyph_set->axis1_list && glyph_set->axis2_list &&
+		glyph_set->axis3_list && glyph_set->scale_list))
+	{
+		return;
+	}
+	const int number_of_names = glyph_set->names ? 2 : 1;
+	if (!glyph_set->glyph)
+	{
+		for (int i = 0; i < glyph_set->number_of_points; ++i)
+		{
+			add_point(glyph_set->point_list[i], number_of_names, glyph_set->object_name,
+				glyph_set->names ? glyph_set->names[i] : 0);
+		}
+		return;
+	}
+	struct Graphics_object_range_struct range;
+	range.first = 1;
+	range.scene = 0;
+	for (GT_object *glyph = glyph_set->glyph; glyph; glyph = glyph->nextobject)
+	{
+		get_graphics_object_range(glyph, static_cast<void *>(&range));
+	}
+	if (range.first)
+	{
+		/* glyph with no extent, eg. labels only: use unit box about origin */
+		for (int j = 0; j < 3; ++j)
+		{
+			range.minimum[j] = -0.5;
+			range.maximum[j] = 0.5;
+		}
+	}
+	/* corner c of box has coordinate maximum in direction j if bit j set */
+	static const int box_triangles[12][3] =
+	{
+		{ 0, 2, 1 }, { 1, 2, 3 }, { 4, 5, 6 }, { 5, 7, 6 },
+		{ 0, 1, 4 }, { 1, 5, 4 }, { 2, 6, 3 }, { 3, 6, 7 },
+		{ 0, 4, 2 }, { 2, 4, 6 }, { 1, 3, 5 }, { 3, 7, 5 }
+	};
+	const int mirror_mode = GT_object_get_glyph_mirror_mode(glyph_set->glyph);
+	const int number_of_glyphs = mirror_mode ? 2 : 1;
+	for (int i = 0; i < glyph_set->number_of_points; ++i)
+	{
+		const int name = glyph_set->names ? glyph_set->names[i] : 0;
+		for (int m = 0; m < number_of_glyphs; ++m)
+		{
+			Triple point, axis1, axis2, axis3;
+			resolve_glyph_axes(glyph_set->point_list[i], glyph_set->axis1_list[i],
+				glyph_set->axis2_list[i], glyph_set->axis3_list[i], glyph_set->scale_list[i],
+				/*mirror*/m, /*reverse*/mirror_mode, point, axis1, axis2, axis3);
+			double corners[8][3];
+			for (int c = 0; c < 8; ++c)
+			{
+				const double x1 = (c & 1) ? range.maximum[0] : range.minimum[0];
+				const double x2 = (c & 2) ? range.maximum[1] : range.minimum[1];
+				const double x3 = (c & 4) ? range.maximum[2] : range.minimum[2];
+				for (int j = 0; j < 3; ++j)
+				{
+					corners[c][j] = point[j] + x1*axis1[j] + x2*axis2[j] + x3*axis3[j];
+				}
+			}
+			for (int t = 0; t < 12; ++t)
+			{
+				add_triangle(corners[box_triangles[t][0]], corners[box_triangles[t][1]],
+					corners[box_triangles[t][2]], number_of_names, glyph_set->object_name, name);
+			}
+		}
+	}
+}
+
+/**
+ * Adds the primitives in a surface or polyline vertex array, named by the
+ * ID of each primitive.
+ */
+void Graphics_object_bvh::add_vertex_array_primitives(
+	Graphics_vertex_array *vertex_array, bool lines, bool discontinuous)
+{
+	GLfloat *position_buffer = 0;
+	unsigned int position_values_per_vertex = 0, position_vertex_count = 0;
+	if (!(vertex_array && vertex_array->get_float_vertex_buffer(
+		GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_POSITION, &position_buffer,
+		&position_values_per_vertex, &position_vertex_count) &&
+		(3 <= position_values_per_vertex)))
+	{
+		return;
+	}
+	unsigned int *index_buffer = 0;
+	unsigned int index_values_per_vertex = 0, index_count_total = 0;
+	if (!lines)
+	{
+		vertex_array->get_unsigned_integer_vertex_buffer(
+			GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_INDEX,
+			&index_buffer, &index_values_per_vertex, &index_count_total);
+		if (!index_buffer)
+		{
+			return;
+		}
+	}
+	const unsigned int primitive_count = vertex_array->get_number_of_vertices(
+		GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_ELEMENT_INDEX_START);
+	for (unsigned int p = 0; p < primitive_count; ++p)
+	{
+		int object_name = 0;
+		unsigned int index_start = 0, index_count = 0;
+		vertex_array->get_integer_attribute(GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_ID,
+			p, 1, &object_name);
+		vertex_array->get_unsigned_integer_attribute(
+			GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_ELEMENT_INDEX_START, p, 1, &index_start);
+		vertex_array->get_unsigned_integer_attribute(
+			GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_ELEMENT_INDEX_COUNT, p, 1, &index_count);
+		if (lines)
+		{
+			if ((index_start + index_count) > position_vertex_count)
+			{
+				continue;
+			}
+			const GLfloat *position = position_buffer + index_start*position_values_per_vertex;
+			const unsigned int step = discontinuous ? 2 : 1;
+			for (unsigned int i = 1; i < index_count; i += step)
+			{
+				add_line(position + (i - 1)*position_values_per_vertex,
+					position + i*position_values_per_vertex, 1, object_name);
+			}
+		}
+		else
+		{
+			if ((index_start + index_count) > index_count_total)
+			{
+				continue;
+			}
+			const unsigned int *index = index_buffer + index_start;
+			for (unsigned int i = 0; (i + 2) < index_count; i += 3)
+			{
+				add_triangle(position_buffer + index[i]*position_values_per_vertex,
+					position_buffer + index[i + 1]*position_values_per_vertex,
+					position_buffer + index[i + 2]*position_values_per_vertex, 1, object_name);
+			}
+		}
+	}
+}
+
+void Graphics_object_bvh::get_primitive_range(const Primitive& primitive,
+	double *minimum, double *maximum) const
+{
+	const double *x = &(vertices[3*primitive.first_vertex]);
+	for (int j = 0; j < 3; ++j)
+	{
+		minimum[j] = maximum[j] = x[j];
+	}
+	for (int i = 1; i < primitive.vertex_count; ++i)
+	{
+		x += 3;
+		for (int j = 0; j < 3; ++j)
+		{
+			if (x[j] < minimum[j])
+			{
+				minimum[j] = x[j];
+			}
+			else if (x[j] > maximum[j])
+			{
+				maximum[j] = x[j];
+			}
+		}
+	}
+}
+
+namespace {
+
+class Primitive_centre_less
+{
+	const std::vector<double>& centres;
+	int axis;
+
+public:
+	Primitive_centre_less(const std::vector<double>& centres_in, int axis_in) :
+		centres(centres_in),
+		axis(axis_in)
+	{
+	}
+
+	bool operator()(unsigned int a, unsigned int b) const
+	{
+		return centres[3*a + axis] < centres[3*b + axis];
+	}
+};
+
+} // anonymous namespace
+
+/**
+ * Builds node for primitives order[begin..end-1], splitting at the median
+ * centre along the longest axis of the node.
+ * @return  Index of the new node.
+ */
+unsigned int Graphics_object_bvh::build_node(std::vector<unsigned int>& order,
+	unsigned int begin, unsigned int end, const std::vector<double>& centres)
+{
+	const unsigned int node_index = static_cast<unsigned int>(nodes.size());
+	nodes.push_back(Node());
+	double minimum[3], maximum[3];
+	double centre_minimum[3], centre_maximum[3];
+	for (unsigned int i = begin; i < end; ++i)
+	{
+		double primitive_minimum[3], primitive_maximum[3];
+		get_primitive_range(primitives[order[i]], primitive_minimum, primitive_maximum);
+		const double *centre = &(centres[3*order[i]]);
+		for (int j = 0; j < 3; ++j)
+		{
+			if ((i == begin) || (primitive_minimum[j] < minimum[j]))
+				minimum[j] = primitive_minimum[j];
+			if ((i == begin) || (primitive_maximum[j] > maximum[j]))
+				maximum[j] = primitive_maximum[j];
+			if ((i == begin) || (centre[j] < centre_minimum[j]))
+				centre_minimum[j] = centre[j];
+			if ((i == begin) || (centre[j] > centre_maximum[j]))
+				centre_maximum[j] = centre[j];
+		}
+	}
+	for (int j = 0; j < 3; ++j)
+	{
+		nodes[node_index].minimum[j] = minimum[j];
+		nodes[node_index].maximum[j] = maximum[j];
+	}
+	int axis = 0;
+	for (int j = 1; j < 3; ++j)
+	{
+		if ((centre_maximum[j] - centre_minimum[j]) >
+			(centre_maximum[axis] - centre_minimum[axis]))
+		{
+			axis = j;
+		}
+	}
+	if (((end - begin) <= bvh_leaf_size) ||
+		(centre_maximum[axis] <= centre_minimum[axis]))
+	{
+		nodes[node_index].first = begin;
+		nodes[node_index].count = end - begin;
+	}
+	else
+	{
+		const unsigned int middle = begin + (end - begin)/2;
+		std::nth_element(order.begin() + begin, order.begin() + middle,
+			order.begin() + end, Primitive_centre_less(centres, axis));
+		build_node(order, begin, middle, centres);
+		const unsigned int right_index = build_node(order, middle, end, centres);
+		nodes[node_index].first = right_index;
+		nodes[node_index].count = 0;
+	}
+	return node_index;
+}
+
+void Graphics_object_bvh::pick(Scene_pick_context& pick_context,
+	const double *local_to_normalised, int number_of_prefix_names,
+	const int *prefix_names, bool use_names) const
+{
+	if (nodes.empty())
+	{
+		return;
+	}
+	int names[4];
+	for (int i = 0; i < number_of_prefix_names; ++i)
+	{
+		names[i] = prefix_names[i];
+	}
+	std::vector<unsigned int> stack;
+	stack.push_back(0);
+	while (!stack.empty())
+	{
+		const Node& node = nodes[stack.back()];
+		const unsigned int node_index = stack.back();
+		stack.pop_back();
+		double near_z;
+		if (box_outside_volume(local_to_normalised, node.minimum, node.maximum, near_z) ||
+			(!pick_context.could_hit(near_z)))
+		{
+			continue;
+		}
+		if (0 == node.count)
+		{
+			stack.push_back(node.first);
+			stack.push_back(node_index + 1);
+			continue;
+		}
+		for (unsigned int p = node.first; p < (node.first + node.count); ++p)
+		{
+			const Primitive& primitive = primitives[p];
+			double h[3][4];
+			for (int i = 0; i < primitive.vertex_count; ++i)
+			{
+				transform_homogeneous(local_to_normalised,
+					&(vertices[3*(primitive.first_vertex + i)]), h[i]);
+			}
+			double far_z;
+			if (clip_primitive(primitive.vertex_count, h, near_z, far_z))
+			{
+				int number_of_names = number_of_prefix_names;
+				if (use_names)
+				{
+					for (int i = 0; i < primitive.number_of_names; ++i)
+					{
+						names[number_of_names++] = primitive.names[i];
+					}
+				}
+				pick_context.add_hit(number_of_names, names, near_z, far_z);
+			}
+		}
+	}
+}
+
+void Graphics_object_bvh_destroy(Graphics_object_bvh **bvh_address)
+{
+	if (bvh_address)
+	{
+		delete *bvh_address;
+		*bvh_address = 0;
+	}
+}
+
+bool Scene_pick_context::Hit_key::operator<(const Hit_key& other) const
+{
+	if (rendition != other.rendition)
+	{
+		return (rendition < other.rendition);
+	}
+	if (number_of_names != other.number_of_names)
+	{
+		return (number_of_names < other.number_of_names);
+	}
+	for (int i = 0; i < number_of_names; ++i)
+	{
+		if (names[i] != other.names[i])
+		{
+			return (names[i] < other.names[i]);
+		}
+	}
+	return false;
+}
+
+Scene_pick_context::Scene_pick_context(struct Cmiss_scene *scene_in,
+	struct Interaction_volume *interaction_volume, bool nearest_only_in) :
+	scene(scene_in),
+	nearest_only(nearest_only_in),
+	rendition(0),
+	time(0.0),
+	graphic_position(0),
+	graphic_to_normalised(0),
+	nearest_depth(DBL_MAX)
+{
+	double modelview_matrix[16], projection_matrix[16];
+	Interaction_volume_get_modelview_matrix(interaction_volume, modelview_matrix);
+	Interaction_volume_get_projection_matrix(interaction_volume, projection_matrix);
+	for (int i = 0; i < 4; ++i)
+	{
+		for (int j = 0; j < 4; ++j)
+		{
+			double sum = 0.0;
+			for (int k = 0; k < 4; ++k)
+			{
+				sum += projection_matrix[i*4 + k]*modelview_matrix[k*4 + j];
+			}
+			world_to_normalised[i*4 + j] = sum;
+		}
+	}
+	local_to_normalised_stack.push_back(
+		std::vector<double>(world_to_normalised, world_to_normalised + 16));
+}
+
+void Scene_pick_context::push_transformation(gtMatrix *transformation)
+{
+	std::vector<double> matrix(local_to_normalised_stack.back());
+	if (transformation)
+	{
+		/* gtMatrix is stored as for OpenGL: (*transformation)[column][row] */
+		const std::vector<double>& parent = local_to_normalised_stack.back();
+		for (int i = 0; i < 4; ++i)
+		{
+			for (int j = 0; j < 4; ++j)
+			{
+				double sum = 0.0;
+				for (int k = 0; k < 4; ++k)
+				{
+					sum += parent[i*4 + k]*(*transformation)[j][k];
+				}
+				matrix[i*4 + j] = sum;
+			}
+		}
+	}
+	local_to_normalised_stack.push_back(matrix);
+}
+
+void Scene_pick_context::pop_transformation()
+{
+	if (1 < local_to_normalised_stack.size())
+	{
+		local_to_normalised_stack.pop_back();
+	}
+	else
+	{
+		display_message(ERROR_MESSAGE,
+			"Scene_pick_context::pop_transformation.  Transformation stack is empty");
+	}
+}
+
+bool Scene_pick_context::begin_graphic(int position,
+	enum Cmiss_graphics_coordinate_system coordinate_system)
+{
+	graphic_position = position;
+	switch (coordinate_system)
+	{
+		case CMISS_GRAPHICS_COORDINATE_SYSTEM_LOCAL:
+		{
+			graphic_to_normalised = &(local_to_normalised_stack.back()[0]);
+		} break;
+		case CMISS_GRAPHICS_COORDINATE_SYSTEM_WORLD:
+		{
+			graphic_to_normalised = world_to_normalised;
+		} break;
+		default:
+		{
+			/* window-relative graphics are not picked */
+			graphic_to_normalised = 0;
+		} break;
+	}
+	return (0 != graphic_to_normalised);
+}
+
+int Scene_pick_context::pick_graphics_object(struct GT_object *graphics_object)
+{
+	if (!(graphics_object && graphic_to_normalised))
+	{
+		display_message(ERROR_MESSAGE,
+			"Scene_pick_context::pick_graphics_object.  Invalid argument(s)");
+		return 0;
+	}
+	/* linked objects are named by their number after the graphic position,
+		 as in execute_GT_object */
+	const bool linked = (0 != graphics_object->nextobject);
+	int prefix_names[2];
+	prefix_names[0] = graphic_position;
+	int graphics_object_no = 0;
+	for (GT_object *object = graphics_object; object; object = object->nextobject)
+	{
+		if (0 < object->number_of_times)
+		{
+			const int time_number = GT_object_get_pick_time_number(object, time);
+			if (object->pick_bvh && (object->pick_bvh->get_time_number() != time_number))
+			{
+				Graphics_object_bvh_destroy(&(object->pick_bvh));
+			}
+			if (!object->pick_bvh)
+			{
+				object->pick_bvh = new Graphics_object_bvh(object, time_number);
+			}
+			prefix_names[1] = graphics_object_no;
+			object->pick_bvh->pick(*this, graphic_to_normalised, linked ? 2 : 1,
+				prefix_names, (GRAPHICS_NO_SELECT != object->select_mode));
+		}
+		++graphics_object_no;
+	}
+	return 1;
+}
+
+void Scene_pick_context::add_hit(int number_of_object_names,
+	const int *object_names, double near_z, double far_z)
+{
+	if (nearest_only)
+	{
+		if (near_z >= nearest_depth)
+		{
+			return;
+		}
+		hits.clear();
+		nearest_depth = near_z;
+	}
+	Hit_key key;
+	key.rendition = rendition;
+	key.number_of_names = (number_of_object_names < 4) ? number_of_object_names : 4;
+	for (int i = 0; i < key.number_of_names; ++i)
+	{
+		key.names[i] = object_names[i];
+	}
+	std::map<Hit_key, Hit_range>::iterator iter = hits.find(key);
+	if (iter == hits.end())
+	{
+		Hit_range range = { near_z, far_z };
+		hits.insert(std::make_pair(key, range));
+	}
+	else
+	{
+		if (near_z < iter->second.nearest)
+		{
+			iter->second.nearest = near_z;
+		}
+		if (far_z > iter->second.farthest)
+		{
+			iter->second.farthest = far_z;
+		}
+	}
+}
+
+struct LIST(Scene_picked_object) *Scene_pick_context::create_picked_object_list() const
+{
+	struct LIST(Scene_picked_object) *scene_picked_object_list =
+		CREATE(LIST(Scene_picked_object))();
+	if (!scene_picked_object_list)
+	{
+		display_message(ERROR_MESSAGE,
+			"Scene_pick_context::create_picked_object_list.  Could not create list");
+		return 0;
+	}
+	int hit_no = 0;
+	for (std::map<Hit_key, Hit_range>::const_iterator iter = hits.begin();
+		iter != hits.end(); ++iter)
+	{
+		struct Scene_picked_object *scene_picked_object =
+			CREATE(Scene_picked_object)(hit_no);
+		int return_code = (0 != scene_picked_object);
+		if (return_code)
+		{
+			Scene_picked_object_set_nearest(scene_picked_object,
+				0.5*(iter->second.nearest + 1.0)*select_depth_scale);
+			Scene_picked_object_set_farthest(scene_picked_object,
+				0.5*(iter->second.farthest + 1.0)*select_depth_scale);
+			if (iter->first.rendition)
+			{
+				return_code = Scene_picked_object_add_rendition(scene_picked_object,
+					iter->first.rendition);
+			}
+			for (int i = 0; return_code && (i < iter->first.number_of_names); ++i)
+			{
+				return_code = Scene_picked_object_add_subobject(scene_picked_object,
+					iter->first.names[i]);
+			}
+			if (return_code && !ADD_OBJECT_TO_LIST(Scene_picked_object)(
+				scene_picked_object, scene_picked_object_list))
+			{
+				return_code = 0;
+			}
+			if (!return_code)
+			{
+				DESTROY(Scene_picked_object)(&scene_picked_object);
+			}
+		}
+		if (!return_code)
+		{
+			display_message(ERROR_MESSAGE, "Scene_pick_context::create_picked_object_list.  "
+				"Failed to build Scene_picked_object");
+			break;
+		}
+		++hit_no;
+	}
+	return scene_picked_object_list;
+}
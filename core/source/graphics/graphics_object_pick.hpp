@@ -0,0 +1,181 @@
+/*******************************************************************************
+FILE : graphics_object_pick.hpp
+
+DESCRIPTION :
+Picking of graphics objects on the CPU without OpenGL select mode, using a
+bounding volume hierarchy of the primitives in each GT_object.
+==============================================================================*/
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is cmgui.
+ *
+ * The Initial Developer of the Original Code is
+ * Auckland Uniservices Ltd, Auckland, New Zealand.
+ * Portions created by the Initial Developer are Copyright (C) 2012
+ * the Initial Developer. All Rights Reserved.
+ *
+ * Contributor(s):
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+#if !defined (GRAPHICS_OBJECT_PICK_HPP)
+#define GRAPHICS_OBJECT_PICK_HPP
+
+#include <map>
+#include <vector>
+#include "zinc/zincconfigure.h"
+#include "zinc/types/graphicscoordinatesystem.h"
+#include "graphics/graphics_library.h"
+#include "general/list.h"
+
+struct Cmiss_rendition;
+struct Cmiss_scene;
+struct GT_object;
+struct Interaction_volume;
+struct Scene_picked_object;
+DECLARE_LIST_TYPES(Scene_picked_object);
+
+/**
+ * Bounding volume hierarchy over the triangles, line segments, points and
+ * glyph bounding boxes of a single GT_object at one time. Built on demand
+ * when first picked and discarded by GT_object_changed, so only graphics
+ * objects rebuilt since the last pick are re-indexed.
+ */
+class Graphics_object_bvh;
+
+/**
+ * Destroys the bounding volume hierarchy and clears the pointer to it.
+ */
+void Graphics_object_bvh_destroy(Graphics_object_bvh **bvh_address);
+
+/**
+ * Traversal state for picking the graphics in a scene against the volume of
+ * an Interaction_volume. Each primitive is clipped against the volume in
+ * homogeneous normalised coordinates, matching what OpenGL select mode
+ * reports as a hit, with nearest and farthest depths scaled as OpenGL
+ * returns them. Hits are merged per distinct name path, so each
+ * Scene_picked_object has the same renditions and subobjects as before.
+ */
+class Scene_pick_context
+{
+public:
+	struct Hit_key
+	{
+		struct Cmiss_rendition *rendition;
+		int number_of_names;
+		int names[4];
+
+		bool operator<(const Hit_key& other) const;
+	};
+
+	struct Hit_range
+	{
+		double nearest, farthest;
+	};
+
+private:
+	struct Cmiss_scene *scene;
+	bool nearest_only;
+	double world_to_normalised[16];
+	std::vector<std::vector<double> > local_to_normalised_stack;
+	struct Cmiss_rendition *rendition;
+	ZnReal time;
+	int graphic_position;
+	const double *graphic_to_normalised;
+	std::map<Hit_key, Hit_range> hits;
+	double nearest_depth;
+
+public:
+	/**
+	 * @param scene  The scene being picked, whose filter selects the graphics.
+	 * @param interaction_volume  The volume to pick in.
+	 * @param nearest_only  If true, only the nearest hit is kept and parts of
+	 * the scene further than it are skipped.
+	 */
+	Scene_pick_context(struct Cmiss_scene *scene,
+		struct Interaction_volume *interaction_volume, bool nearest_only);
+
+	struct Cmiss_scene *get_scene() const
+	{
+		return scene;
+	}
+
+	/** Multiplies the current local transformation by a rendition
+	 * transformation, or repeats the current one if NULL. */
+	void push_transformation(gtMatrix *transformation);
+
+	void pop_transformation();
+
+	/** Sets the rendition whose graphics are picked next, and its time */
+	void set_rendition(struct Cmiss_rendition *rendition_in, ZnReal time_in)
+	{
+		rendition = rendition_in;
+		time = time_in;
+	}
+
+	struct Cmiss_rendition *get_rendition() const
+	{
+		return rendition;
+	}
+
+	ZnReal get_time() const
+	{
+		return time;
+	}
+
+	/**
+	 * Sets the graphic whose objects are picked next.
+	 * @return  true if graphics in the coordinate system can be picked.
+	 * Window-relative graphics are skipped, as in OpenGL picking.
+	 */
+	bool begin_graphic(int position,
+		enum Cmiss_graphics_coordinate_system coordinate_system);
+
+	/**
+	 * Adds hits for the primitives of graphics_object and any objects linked
+	 * to it which lie in the interaction volume at the rendition time.
+	 */
+	int pick_graphics_object(struct GT_object *graphics_object);
+
+	/** Records a hit at normalised depths -1 (near) to +1 (far). Used by the
+	 * graphics object bounding volume hierarchies. */
+	void add_hit(int number_of_object_names, const int *object_names,
+		double near_z, double far_z);
+
+	/** @return  true if a primitive nearest at normalised depth near_z could
+	 * contribute a hit. */
+	bool could_hit(double near_z) const
+	{
+		return (!nearest_only) || (near_z < nearest_depth);
+	}
+
+	/**
+	 * @return  New list of Scene_picked_objects for the hits, ordered by
+	 * rendition then names.
+	 */
+	struct LIST(Scene_picked_object) *create_picked_object_list() const;
+};
+
+#endif /* !defined (GRAPHICS_OBJECT_PICK_HPP) */
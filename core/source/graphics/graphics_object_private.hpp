@@ -75,6 +75,7 @@ Used to be gtypes.h
 #define GRAPHICS_OBJECT_PRIVATE_H
 
 
+#include <vector>
 #include "zinc/zincconfigure.h"
 
 #include "general/geometry.h"
@@ -87,6 +88,8 @@ Used to be gtypes.h
 #include "graphics/spectrum.h"
 #include "graphics/graphics_object.hpp"
 #include "graphics/graphics_object_highlight.hpp"
+
+class Graphics_object_bvh;
 /*
 Global types
 ------------
@@ -254,6 +257,18 @@ struct GT_polyline_vertex_buffers
 	int line_width;
 }; /* struct GT_polyline_vertex_buffers */
 
+/***************************************************************************//**
+ * Provides the rendition information for the indexed triangle mesh stored in
+ * the vertex_array. Triangle vertex indices are in the INDEX attribute, and
+ * ELEMENT_INDEX_START/COUNT give the range of indices for each identified
+ * primitive, e.g. the triangles from one element.
+ */
+struct GT_surface_vertex_buffers
+{
+	enum GT_surface_type surface_type;
+	enum Cmiss_graphics_render_type render_type;
+}; /* struct GT_surface_vertex_buffers */
+
 struct GT_surface
 /*******************************************************************************
 LAST MODIFIED : 16 April 1999
@@ -365,6 +380,8 @@ traversed from first to last, and additional primitives added at the end.
 	struct {
 		struct GT_surface *first, *last;
 	} gt_surface;
+	/* Only one object allowed for this type */
+	struct GT_surface_vertex_buffers *gt_surface_vertex_buffers;
 	struct {
 		struct GT_userdef *first, *last;
 	} gt_userdef;
@@ -407,6 +424,15 @@ Graphical object data structure.
 	ZnReal *times;
 
 	Graphics_vertex_array *vertex_array;
+	/* 1 when primitives stored in lists have been packed into the vertex_array,
+		2 when the per-vertex values have since been released after uploading
+		them to the graphics card so only the indices remain; cleared whenever
+		the object changes */
+	int vertex_array_packed;
+
+	/* bounding volume hierarchy for picking, built on demand and destroyed
+		whenever the object changes */
+	Graphics_object_bvh *pick_bvh;
 
 	/* If the graphics object was compiled with respect to a texture
 		tiling then this pointer is set to that tiling. */
@@ -479,4 +505,13 @@ class Render_graphics_compile_members;
 int Graphics_object_compile_members(GT_object *graphics_object_list,
 	Render_graphics_compile_members *renderer);
 
+/**
+ * Appends the triangles making up <surface> to <triangles>, with vertex
+ * indices offset by <first_vertex>. Winding matches that drawn by
+ * draw_surfaceGL and draw_dc_surfaceGL.
+ * @return  1 on success, 0 if the surface layout is not supported.
+ */
+int GT_surface_add_triangle_indices(struct GT_surface *surface,
+	unsigned int first_vertex, std::vector<unsigned int>& triangles);
+
 #endif /* ! defined (GRAPHICS_OBJECT_PRIVATE_H) */
@@ -2319,6 +2319,21 @@ static int Graphics_object_create_colour_buffer_from_data(GT_object *object,
 	return (return_code);
 }
 
+/***************************************************************************//**
+ * Returns the object type used to select how vertex buffers are set up for
+ * <object>. Surfaces packed into contiguous arrays are treated as
+ * g_SURFACE_VERTEX_BUFFERS.
+ */
+static enum GT_object_type Graphics_object_get_vertex_buffers_type(GT_object *object)
+{
+	enum GT_object_type object_type = GT_object_get_type(object);
+	if ((g_SURFACE == object_type) && object->vertex_array_packed)
+	{
+		object_type = g_SURFACE_VERTEX_BUFFERS;
+	}
+	return object_type;
+}
+
 static int Graphics_object_enable_opengl_client_vertex_arrays(GT_object *object,
 	Render_graphics_opengl *renderer,
 	GLfloat **vertex_buffer, GLfloat **colour_buffer, GLfloat **normal_buffer,
@@ -2330,9 +2345,10 @@ static int Graphics_object_enable_opengl_client_vertex_arrays(GT_object *object,
 	if (object && object->vertex_array)
 	{
 		return_code = 1;
-		switch (GT_object_get_type(object))
+		switch (Graphics_object_get_vertex_buffers_type(object))
 		{
 		case g_POLYLINE_VERTEX_BUFFERS:
+		case g_SURFACE_VERTEX_BUFFERS:
 			{
 				if (object->secondary_material)
 				{
@@ -2417,9 +2433,10 @@ static int Graphics_object_disable_opengl_client_vertex_arrays(GT_object *object
 	if (object && object->vertex_array)
 	{
 		return_code = 1;
-		switch (GT_object_get_type(object))
+		switch (Graphics_object_get_vertex_buffers_type(object))
 		{
 		case g_POLYLINE_VERTEX_BUFFERS:
+		case g_SURFACE_VERTEX_BUFFERS:
 			{
 				if (vertex_buffer)
 				{
@@ -2757,10 +2774,16 @@ static int Graphics_object_compile_opengl_vertex_buffer_object(GT_object *object
 	if (object)
 	{
 		return_code = 1;
-		switch (GT_object_get_type(object))
+		/* surfaces are uploaded from contiguous arrays when they can be packed */
+		GT_object_get_packed_surface_vertex_array(object);
+		switch (Graphics_object_get_vertex_buffers_type(object))
 		{
 		case g_POLYLINE_VERTEX_BUFFERS:
+		case g_SURFACE_VERTEX_BUFFERS:
 			{
+				/* multipass vertex position calculation is only implemented for lines */
+				const bool multipass = (0 != object->secondary_material) &&
+					(g_POLYLINE_VERTEX_BUFFERS == GT_object_get_type(object));
 				GLfloat *position_vertex_buffer = NULL;
 				unsigned int position_values_per_vertex, position_vertex_count;
 				if (object->vertex_array->get_float_vertex_buffer(
@@ -2773,7 +2796,7 @@ static int Graphics_object_compile_opengl_vertex_buffer_object(GT_object *object
 						glGenBuffers(1, &object->position_vertex_buffer_object);
 					}
 
-					if (object->secondary_material)
+					if (multipass)
 					{
 						/* Defer to lower in this function as we may want to use the contents of
 						* some of the other buffers in our first pass calculation.
@@ -2881,7 +2904,7 @@ static int Graphics_object_compile_opengl_vertex_buffer_object(GT_object *object
 					}
 				}
 
-				if (position_vertex_buffer && object->secondary_material)
+				if (position_vertex_buffer && multipass)
 				{
 #if defined (GL_VERSION_2_0) && defined (GL_EXT_framebuffer_object)
 					if (Graphics_library_check_extension(GL_ARB_draw_buffers)
@@ -2903,6 +2926,9 @@ static int Graphics_object_compile_opengl_vertex_buffer_object(GT_object *object
 						"Multipass rendering not compiled in this version.");
 #endif /* defined (GL_VERSION_2_0) && defined (GL_EXT_framebuffer_object) */
 				}
+				/* packed surfaces only need their indices once uploaded; the
+					per-vertex values are repacked from the primitives if recompiled */
+				GT_object_release_packed_surface_vertices(object);
 			} break;
 		default:
 			{
@@ -2931,9 +2957,10 @@ static int Graphics_object_enable_opengl_vertex_buffer_object(GT_object *object,
 	if (object && object->vertex_array)
 	{
 		return_code = 1;
-		switch (GT_object_get_type(object))
+		switch (Graphics_object_get_vertex_buffers_type(object))
 		{
 		case g_POLYLINE_VERTEX_BUFFERS:
+		case g_SURFACE_VERTEX_BUFFERS:
 			{
 				if (object->position_vertex_buffer_object)
 				{
@@ -3001,9 +3028,10 @@ static int Graphics_object_disable_opengl_vertex_buffer_object(GT_object *object
 	if (object && object->vertex_array)
 	{
 		return_code = 1;
-		switch (GT_object_get_type(object))
+		switch (Graphics_object_get_vertex_buffers_type(object))
 		{
 		case g_POLYLINE_VERTEX_BUFFERS:
+		case g_SURFACE_VERTEX_BUFFERS:
 			{
 				if (object->position_vertex_buffer_object)
 				{
@@ -3038,6 +3066,188 @@ static int Graphics_object_disable_opengl_vertex_buffer_object(GT_object *object
 	return (return_code);
 } /* Graphics_object_enable_opengl_client_vertex_arrays */
 
+/***************************************************************************//**
+ * Draws the indexed triangles stored in the vertex array of <object>, one range
+ * of triangle indices per object name, as for g_SURFACE_VERTEX_BUFFERS and
+ * g_SURFACE objects packed into contiguous arrays.
+ */
+static int draw_vertex_array_surfacesGL(GT_object *object,
+	enum Cmiss_graphics_render_type render_type, int draw_selected,
+	int picking_names, Render_graphics_opengl *renderer,
+	Graphics_object_rendering_type rendering_type,
+	struct Graphical_material *material, struct Spectrum *spectrum)
+{
+	int name_selected;
+
+	if (picking_names)
+	{
+		glPushName(0);
+	}
+	bool wireframe_flag = (render_type == CMISS_GRAPHICS_RENDER_TYPE_WIREFRAME);
+	if (wireframe_flag)
+	{
+		glPushAttrib(GL_POLYGON_BIT);
+		glPolygonMode(GL_FRONT_AND_BACK,GL_LINE);
+	}
+	unsigned int primitive_index;
+	unsigned int primitive_count =
+		object->vertex_array->get_number_of_vertices(
+		GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_ELEMENT_INDEX_START);
+
+	GLfloat *position_buffer, *data_buffer, *normal_buffer,
+		*texture_coordinate0_buffer;
+	unsigned int *index_buffer = NULL;
+	struct Spectrum_render_data *render_data = NULL;
+	unsigned int position_values_per_vertex, position_vertex_count,
+		data_values_per_vertex, data_vertex_count, normal_values_per_vertex,
+		normal_vertex_count, texture_coordinate0_values_per_vertex,
+		texture_coordinate0_vertex_count, index_values_per_vertex, index_count_total;
+
+	position_buffer = (GLfloat *)NULL;
+	data_buffer = (GLfloat *)NULL;
+	normal_buffer = (GLfloat *)NULL;
+	texture_coordinate0_buffer = (GLfloat *)NULL;
+
+	object->vertex_array->get_unsigned_integer_vertex_buffer(
+		GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_INDEX,
+		&index_buffer, &index_values_per_vertex, &index_count_total);
+	switch (rendering_type)
+	{
+	case GRAPHICS_OBJECT_RENDERING_TYPE_GLBEGINEND:
+		{
+			object->vertex_array->get_float_vertex_buffer(
+				GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_POSITION,
+				&position_buffer, &position_values_per_vertex, &position_vertex_count);
+			object->vertex_array->get_float_vertex_buffer(
+				GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_DATA,
+				&data_buffer, &data_values_per_vertex, &data_vertex_count);
+			if (data_buffer)
+			{
+				render_data=spectrum_start_renderGL
+					(spectrum,material,data_values_per_vertex);
+			}
+			object->vertex_array->get_float_vertex_buffer(
+				GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_NORMAL,
+				&normal_buffer, &normal_values_per_vertex, &normal_vertex_count);
+			object->vertex_array->get_float_vertex_buffer(
+				GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_TEXTURE_COORDINATE_ZERO,
+				&texture_coordinate0_buffer, &texture_coordinate0_values_per_vertex,
+				&texture_coordinate0_vertex_count);
+		} break;
+	case GRAPHICS_OBJECT_RENDERING_TYPE_CLIENT_VERTEX_ARRAYS:
+		{
+			Graphics_object_enable_opengl_client_vertex_arrays(
+				object, renderer,
+				&position_buffer, &data_buffer, &normal_buffer,
+				&texture_coordinate0_buffer);
+		} break;
+	case GRAPHICS_OBJECT_RENDERING_TYPE_VERTEX_BUFFER_OBJECT:
+		{
+			Graphics_object_enable_opengl_vertex_buffer_object(
+				object, renderer);
+		} break;
+	}
+
+	for (primitive_index = 0; index_buffer && (primitive_index < primitive_count); primitive_index++)
+	{
+		int object_name;
+		object->vertex_array->get_integer_attribute(
+			GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_ID,
+			primitive_index, 1, &object_name);
+		/* work out if subobjects selected */
+		if (renderer->highlight_functor)
+		{
+			name_selected=(renderer->highlight_functor)->call(object_name);
+		}
+		else
+		{
+			name_selected = 0;
+		}
+		if ((name_selected&&draw_selected)||
+			((!name_selected)&&(!draw_selected)))
+		{
+			if (picking_names)
+			{
+				/* put out name for picking - cast to GLuint */
+				glLoadName((GLuint)object_name);
+			}
+			unsigned int i, index_start, index_count;
+			object->vertex_array->get_unsigned_integer_attribute(
+				GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_ELEMENT_INDEX_START,
+				primitive_index, 1, &index_start);
+			object->vertex_array->get_unsigned_integer_attribute(
+				GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_ELEMENT_INDEX_COUNT,
+				primitive_index, 1, &index_count);
+			switch (rendering_type)
+			{
+			case GRAPHICS_OBJECT_RENDERING_TYPE_GLBEGINEND:
+				{
+					unsigned int *index = index_buffer + index_start;
+					glBegin(GL_TRIANGLES);
+					for (i = index_count; i > 0; i--)
+					{
+						if (data_buffer)
+						{
+							spectrum_renderGL_value(spectrum,material,render_data,
+								data_buffer + data_values_per_vertex*(*index));
+						}
+						if (normal_buffer)
+						{
+							glNormal3fv(normal_buffer + normal_values_per_vertex*(*index));
+						}
+						if (texture_coordinate0_buffer)
+						{
+							glTexCoord3fv(texture_coordinate0_buffer +
+								texture_coordinate0_values_per_vertex*(*index));
+						}
+						glVertex3fv(position_buffer + position_values_per_vertex*(*index));
+						index++;
+					}
+					glEnd();
+				} break;
+			case GRAPHICS_OBJECT_RENDERING_TYPE_CLIENT_VERTEX_ARRAYS:
+			case GRAPHICS_OBJECT_RENDERING_TYPE_VERTEX_BUFFER_OBJECT:
+				{
+					/* indices are always taken from client memory */
+					glDrawElements(GL_TRIANGLES, index_count, GL_UNSIGNED_INT,
+						index_buffer + index_start);
+				} break;
+			}
+		}
+	}
+	switch (rendering_type)
+	{
+	case GRAPHICS_OBJECT_RENDERING_TYPE_GLBEGINEND:
+		{
+			if (data_buffer)
+			{
+				spectrum_end_renderGL(spectrum, render_data);
+			}
+		} break;
+	case GRAPHICS_OBJECT_RENDERING_TYPE_CLIENT_VERTEX_ARRAYS:
+		{
+			Graphics_object_disable_opengl_client_vertex_arrays(
+				object, renderer,
+				position_buffer, data_buffer, normal_buffer,
+				texture_coordinate0_buffer);
+		} break;
+	case GRAPHICS_OBJECT_RENDERING_TYPE_VERTEX_BUFFER_OBJECT:
+		{
+			Graphics_object_disable_opengl_vertex_buffer_object(
+				object, renderer);
+		} break;
+	}
+	if (wireframe_flag)
+	{
+		glPopAttrib();
+	}
+	if (picking_names)
+	{
+		glPopName();
+	}
+	return 1;
+}
+
 static int render_GT_object_opengl_immediate(gtObject *object,
 	int draw_selected, Render_graphics_opengl *renderer,
 	Graphics_object_rendering_type rendering_type)
@@ -3834,10 +4044,34 @@ static int render_GT_object_opengl_immediate(gtObject *object,
 							return_code=0;
 						}
 					} break;
+				case g_SURFACE_VERTEX_BUFFERS:
+					{
+						GT_surface_vertex_buffers *surface_buffers =
+							primitive_list1->gt_surface_vertex_buffers;
+						if (surface_buffers)
+						{
+							return_code = draw_vertex_array_surfacesGL(object,
+								surface_buffers->render_type, draw_selected, picking_names,
+								renderer, rendering_type, material, spectrum);
+						}
+						else
+						{
+							display_message(ERROR_MESSAGE,"render_GT_object_opengl_immediate.  Missing surface");
+							return_code=0;
+						}
+					} break;
 				case g_SURFACE:
 					{
 						surface = primitive_list1->gt_surface.first;
-						if (surface)
+						if (surface && (GRAPHICS_OBJECT_RENDERING_TYPE_VERTEX_BUFFER_OBJECT == rendering_type) &&
+							object->vertex_array_packed)
+						{
+							/* draw from the packed arrays uploaded when compiled */
+							return_code = draw_vertex_array_surfacesGL(object,
+								surface->render_type, draw_selected, picking_names,
+								renderer, rendering_type, material, spectrum);
+						}
+						else if (surface)
 						{
 #if defined (OPENGL_API)
 							if (picking_names)
@@ -42,8 +42,11 @@ Renders gtObjects to STL stereolithography file.
  *
  * ***** END LICENSE BLOCK ***** */
 
+#include <math.h>
 #include <stack>
 #include <stdio.h>
+#include <string.h>
+#include <vector>
 #include "general/debug.h"
 #include "general/matrix_vector.h"
 #include "general/mystring.h"
@@ -132,38 +135,628 @@ public:
 	}
 };
 
-class Stl_context
+/***************************************************************************//**
+ * Accumulates output in a large memory buffer which is written to file in
+ * blocks, avoiding per-value stdio calls for large exports.
+ */
+class Buffered_file_writer
 {
 private:
-	FILE *stl_file;
+	FILE *file;
+	std::vector<char> buffer;
+	size_t used;
+	bool error;
+
+public:
+	Buffered_file_writer(const char *file_name) :
+		file(fopen(file_name, "wb")),
+		buffer(1 << 20),
+		used(0),
+		error(false)
+	{
+	}
+
+	~Buffered_file_writer()
+	{
+		close();
+	}
+
+	bool is_valid() const
+	{
+		return (file != 0) && (!error);
+	}
+
+	void write(const void *data, size_t size)
+	{
+		if (used + size > buffer.size())
+		{
+			flush();
+			if (size > buffer.size())
+			{
+				if (file && (fwrite(data, 1, size, file) != size))
+					error = true;
+				return;
+			}
+		}
+		memcpy(&(buffer[used]), data, size);
+		used += size;
+	}
+
+	void write_string(const char *text)
+	{
+		write(text, strlen(text));
+	}
+
+	/** Writes value with least significant byte first, as for STL and PLY
+	 * little endian files, independent of host byte order */
+	void write_uint32_le(unsigned int value)
+	{
+		unsigned char bytes[4];
+		bytes[0] = static_cast<unsigned char>(value & 0xFF);
+		bytes[1] = static_cast<unsigned char>((value >> 8) & 0xFF);
+		bytes[2] = static_cast<unsigned char>((value >> 16) & 0xFF);
+		bytes[3] = static_cast<unsigned char>((value >> 24) & 0xFF);
+		write(bytes, 4);
+	}
+
+	void write_float_le(float value)
+	{
+		unsigned int int_value;
+		memcpy(&int_value, &value, 4);
+		write_uint32_le(int_value);
+	}
+
+	/** Writes IEEE double as two little endian 32-bit words, least significant
+	 * word first; assumes host double and integer word orders agree */
+	void write_double_le(double value)
+	{
+		unsigned int int_values[2];
+		memcpy(int_values, &value, 8);
+		const unsigned int test = 1;
+		if (*(reinterpret_cast<const unsigned char *>(&test)))
+		{
+			write_uint32_le(int_values[0]);
+			write_uint32_le(int_values[1]);
+		}
+		else
+		{
+			write_uint32_le(int_values[1]);
+			write_uint32_le(int_values[0]);
+		}
+	}
+
+	void flush()
+	{
+		if (used)
+		{
+			if (file && (fwrite(&(buffer[0]), 1, used, file) != used))
+				error = true;
+			used = 0;
+		}
+	}
+
+	/** Flushes and overwrites bytes at offset from start of file, e.g. to
+	 * patch in counts only known at the end */
+	void overwrite(long offset, const void *data, size_t size)
+	{
+		flush();
+		if (file)
+		{
+			long end = ftell(file);
+			if ((0 != fseek(file, offset, SEEK_SET)) ||
+				(fwrite(data, 1, size, file) != size) ||
+				(0 != fseek(file, end, SEEK_SET)))
+			{
+				error = true;
+			}
+		}
+	}
+
+	/** @return  true if all output was written successfully */
+	bool close()
+	{
+		if (file)
+		{
+			flush();
+			if (0 != fclose(file))
+				error = true;
+			file = 0;
+		}
+		return !error;
+	}
+};
+
+/***************************************************************************//**
+ * Interface for writing triangles with transformed vertex coordinates to a
+ * file of a particular format. Each writer owns its file and output buffer.
+ */
+class Triangle_mesh_writer
+{
+public:
+	virtual ~Triangle_mesh_writer()
+	{
+	}
+
+	virtual bool is_valid() const = 0;
+
+	virtual void write_triangle(const double *v1, const double *v2, const double *v3) = 0;
+
+	/***************************************************************************//**
+	 * Writes triangles indexing an array of vertex coordinates. Override to
+	 * process each vertex once rather than once per triangle using it.
+	 *
+	 * @param positions  Array of x,y,z coordinates for vertex_count vertices.
+	 * @param triangle_count  Number of triangles to write.
+	 * @param indices  3 vertex indices for each triangle.
+	 */
+	virtual void write_triangles(const double *positions, unsigned int vertex_count,
+		unsigned int triangle_count, const unsigned int *indices)
+	{
+		USE_PARAMETER(vertex_count);
+		for (unsigned int i = 0; i < triangle_count; ++i)
+		{
+			write_triangle(positions + 3*indices[0], positions + 3*indices[1],
+				positions + 3*indices[2]);
+			indices += 3;
+		}
+	}
+
+	/** Completes the file.
+	 * @return  true if whole file was written successfully */
+	virtual bool finish() = 0;
+};
+
+/** @return  true if triangle has non-zero area, with unit normal */
+bool get_triangle_normal(const double *v1, const double *v2, const double *v3,
+	double *normal)
+{
+	double tangent1[3], tangent2[3];
+	for (int i = 0; i < 3; ++i)
+	{
+		tangent1[i] = v2[i] - v1[i];
+		tangent2[i] = v3[i] - v1[i];
+	}
+	cross_product3(tangent1, tangent2, normal);
+	return (0.0 < normalize3(normal));
+}
+
+class Stl_ascii_writer : public Triangle_mesh_writer
+{
+private:
+	Buffered_file_writer file;
 	char *solid_name;
-	/* Future: add binary option */
-	std::stack<Transformation_matrix> transformation_stack;
 
 public:
-	Stl_context(const char *file_name, const char *solid_name) :
-		stl_file(fopen(file_name, "w")),
-		solid_name(duplicate_string(solid_name))
+	Stl_ascii_writer(const char *file_name, const char *solid_name_in) :
+		file(file_name),
+		solid_name(duplicate_string(solid_name_in ? solid_name_in : ""))
 	{
 		/* ASCII STL header */
-		fprintf(stl_file,"solid %s\n",solid_name);
+		file.write_string("solid ");
+		file.write_string(solid_name);
+		file.write_string("\n");
 	}
 
-	~Stl_context()
+	~Stl_ascii_writer()
 	{
-		fprintf(stl_file,"endsolid %s\n",solid_name);
 		DEALLOCATE(solid_name);
-		fclose(stl_file);
+	}
+
+	virtual bool is_valid() const
+	{
+		return file.is_valid() && (solid_name != 0);
+	}
+
+	virtual void write_triangle(const double *v1, const double *v2, const double *v3)
+	{
+		double normal[3];
+		if (get_triangle_normal(v1, v2, v3, normal))
+		{
+			char text[400];
+			sprintf(text, "facet normal %.9g %.9g %.9g\n outer loop\n"
+				"  vertex %.17g %.17g %.17g\n  vertex %.17g %.17g %.17g\n  vertex %.17g %.17g %.17g\n"
+				" endloop\nendfacet\n",
+				normal[0], normal[1], normal[2],
+				v1[0], v1[1], v1[2], v2[0], v2[1], v2[2], v3[0], v3[1], v3[2]);
+			file.write_string(text);
+		}
+	}
+
+	virtual bool finish()
+	{
+		file.write_string("endsolid ");
+		file.write_string(solid_name);
+		file.write_string("\n");
+		return file.close();
+	}
+};
+
+/***************************************************************************//**
+ * Writes binary STL: 80 byte header, triangle count then 50 bytes per
+ * triangle. The count is patched in when the file is finished.
+ */
+class Stl_binary_writer : public Triangle_mesh_writer
+{
+private:
+	Buffered_file_writer file;
+	unsigned int triangle_count;
+
+public:
+	Stl_binary_writer(const char *file_name, const char *solid_name) :
+		file(file_name),
+		triangle_count(0)
+	{
+		/* header must not start with "solid" or readers may assume ASCII */
+		char header[80];
+		memset(header, ' ', 80);
+		const char *prefix = "binary STL ";
+		memcpy(header, prefix, strlen(prefix));
+		if (solid_name)
+		{
+			size_t length = strlen(solid_name);
+			if (length > 80 - strlen(prefix))
+				length = 80 - strlen(prefix);
+			memcpy(header + strlen(prefix), solid_name, length);
+		}
+		file.write(header, 80);
+		file.write_uint32_le(0);
+	}
+
+	virtual bool is_valid() const
+	{
+		return file.is_valid();
+	}
+
+	virtual void write_triangle(const double *v1, const double *v2, const double *v3)
+	{
+		double normal[3];
+		if (get_triangle_normal(v1, v2, v3, normal))
+		{
+			for (int i = 0; i < 3; ++i)
+				file.write_float_le(static_cast<float>(normal[i]));
+			for (int i = 0; i < 3; ++i)
+				file.write_float_le(static_cast<float>(v1[i]));
+			for (int i = 0; i < 3; ++i)
+				file.write_float_le(static_cast<float>(v2[i]));
+			for (int i = 0; i < 3; ++i)
+				file.write_float_le(static_cast<float>(v3[i]));
+			const unsigned char attribute_byte_count[2] = { 0, 0 };
+			file.write(attribute_byte_count, 2);
+			++triangle_count;
+		}
+	}
+
+	virtual bool finish()
+	{
+		unsigned char bytes[4];
+		bytes[0] = static_cast<unsigned char>(triangle_count & 0xFF);
+		bytes[1] = static_cast<unsigned char>((triangle_count >> 8) & 0xFF);
+		bytes[2] = static_cast<unsigned char>((triangle_count >> 16) & 0xFF);
+		bytes[3] = static_cast<unsigned char>((triangle_count >> 24) & 0xFF);
+		file.overwrite(80, bytes, 4);
+		return file.close();
+	}
+};
+
+/***************************************************************************//**
+ * Merges coincident vertices using a hash table of spatial grid cells. With
+ * a positive tolerance, vertices within tolerance of an existing vertex in
+ * the same or neighbouring cells are merged; otherwise only vertices with
+ * identical coordinates are merged.
+ */
+class Vertex_hash_grid
+{
+private:
+	double tolerance;
+	std::vector<double> positions;
+	std::vector<int> next_in_bucket;
+	std::vector<int> buckets;
+
+	static unsigned int hash_cell(long long ix, long long iy, long long iz)
+	{
+		return static_cast<unsigned int>(ix*73856093LL) ^
+			static_cast<unsigned int>(iy*19349663LL) ^
+			static_cast<unsigned int>(iz*83492791LL);
+	}
+
+	void get_cell(const double *v, long long *cell) const
+	{
+		for (int i = 0; i < 3; ++i)
+			cell[i] = static_cast<long long>(floor(v[i] / tolerance));
+	}
+
+	unsigned int hash_vertex(const double *v) const
+	{
+		if (0.0 < tolerance)
+		{
+			long long cell[3];
+			get_cell(v, cell);
+			return hash_cell(cell[0], cell[1], cell[2]);
+		}
+		/* -0.0 compares equal to 0.0 so must hash the same */
+		double values[3];
+		for (int i = 0; i < 3; ++i)
+			values[i] = (0.0 == v[i]) ? 0.0 : v[i];
+		unsigned long long bits[3];
+		memcpy(bits, values, 3*sizeof(double));
+		return static_cast<unsigned int>((bits[0] ^ (bits[1]*31) ^ (bits[2]*131)) ^
+			((bits[0] ^ (bits[1]*31) ^ (bits[2]*131)) >> 32));
+	}
+
+	int find_in_bucket(unsigned int hash, const double *v) const
+	{
+		const double tolerance_squared = tolerance*tolerance;
+		for (int index = buckets[hash & (buckets.size() - 1)]; 0 <= index;
+			index = next_in_bucket[index])
+		{
+			const double *position = &(positions[3*index]);
+			const double dx = position[0] - v[0];
+			const double dy = position[1] - v[1];
+			const double dz = position[2] - v[2];
+			if ((0.0 < tolerance) ? ((dx*dx + dy*dy + dz*dz) <= tolerance_squared) :
+				((dx == 0.0) && (dy == 0.0) && (dz == 0.0)))
+				return index;
+		}
+		return -1;
+	}
+
+	void insert_in_bucket(int index)
+	{
+		const unsigned int bucket = hash_vertex(&(positions[3*index])) & (buckets.size() - 1);
+		next_in_bucket[index] = buckets[bucket];
+		buckets[bucket] = index;
+	}
+
+	void rehash(size_t bucket_count)
+	{
+		buckets.assign(bucket_count, -1);
+		const int vertex_count = get_vertex_count();
+		for (int i = 0; i < vertex_count; ++i)
+			insert_in_bucket(i);
+	}
+
+public:
+	Vertex_hash_grid(double tolerance_in) :
+		tolerance(tolerance_in),
+		buckets(1024, -1)
+	{
+	}
+
+	int get_vertex_count() const
+	{
+		return static_cast<int>(next_in_bucket.size());
+	}
+
+	const double *get_position(int index) const
+	{
+		return &(positions[3*index]);
 	}
 
 	/***************************************************************************//**
-	 * Confirms STL file is correctly opened.
-	 * 
-	 * @return true if context is correctly constructed, false if not.
+	 * @param added  Set to true if vertex is new, false if merged.
+	 * @return  Index of merged or new vertex starting at 0.
 	 */
-	bool is_valid() const
+	int find_or_add(const double *v, bool& added)
+	{
+		int index = -1;
+		if (0.0 < tolerance)
+		{
+			long long cell[3];
+			get_cell(v, cell);
+			for (int i = -1; (i <= 1) && (index < 0); ++i)
+				for (int j = -1; (j <= 1) && (index < 0); ++j)
+					for (int k = -1; (k <= 1) && (index < 0); ++k)
+						index = find_in_bucket(hash_cell(cell[0] + i, cell[1] + j, cell[2] + k), v);
+		}
+		else
+		{
+			index = find_in_bucket(hash_vertex(v), v);
+		}
+		added = (index < 0);
+		if (added)
+		{
+			index = get_vertex_count();
+			positions.insert(positions.end(), v, v + 3);
+			next_in_bucket.push_back(-1);
+			if (next_in_bucket.size() > buckets.size())
+				rehash(2*buckets.size());
+			else
+				insert_in_bucket(index);
+		}
+		return index;
+	}
+};
+
+/***************************************************************************//**
+ * Base class for writers of shared vertices and triangles indexing them.
+ */
+class Indexed_triangle_mesh_writer : public Triangle_mesh_writer
+{
+protected:
+	Vertex_hash_grid vertices;
+	std::vector<int> local_to_merged; // reused between calls to write_triangles
+
+	/** Called for each new vertex in order of index */
+	virtual void write_vertex(const double *v) = 0;
+
+	/** Called for each non-degenerate triangle with merged vertex indices */
+	virtual void write_indexed_triangle(int i1, int i2, int i3) = 0;
+
+	int add_vertex(const double *v)
+	{
+		bool added;
+		const int index = vertices.find_or_add(v, added);
+		if (added)
+			write_vertex(v);
+		return index;
+	}
+
+	void add_triangle(int i1, int i2, int i3)
+	{
+		if ((i1 != i2) && (i2 != i3) && (i3 != i1))
+			write_indexed_triangle(i1, i2, i3);
+	}
+
+public:
+	Indexed_triangle_mesh_writer(double merge_tolerance) :
+		vertices(merge_tolerance)
+	{
+	}
+
+	virtual void write_triangle(const double *v1, const double *v2, const double *v3)
+	{
+		const int i1 = add_vertex(v1);
+		const int i2 = add_vertex(v2);
+		const int i3 = add_vertex(v3);
+		add_triangle(i1, i2, i3);
+	}
+
+	virtual void write_triangles(const double *positions, unsigned int vertex_count,
+		unsigned int triangle_count, const unsigned int *indices)
+	{
+		/* merge each vertex once */
+		local_to_merged.resize(vertex_count);
+		for (unsigned int i = 0; i < vertex_count; ++i)
+			local_to_merged[i] = add_vertex(positions + 3*i);
+		for (unsigned int i = 0; i < triangle_count; ++i)
+		{
+			add_triangle(local_to_merged[indices[0]], local_to_merged[indices[1]],
+				local_to_merged[indices[2]]);
+			indices += 3;
+		}
+	}
+};
+
+/***************************************************************************//**
+ * Streams vertices and faces to a Wavefront OBJ file as they are found.
+ * Geometry only: materials are written by render_wavefront.
+ */
+class Obj_writer : public Indexed_triangle_mesh_writer
+{
+private:
+	Buffered_file_writer file;
+
+protected:
+	virtual void write_vertex(const double *v)
+	{
+		char text[100];
+		sprintf(text, "v %.17g %.17g %.17g\n", v[0], v[1], v[2]);
+		file.write_string(text);
+	}
+
+	virtual void write_indexed_triangle(int i1, int i2, int i3)
+	{
+		char text[50];
+		sprintf(text, "f %d %d %d\n", i1 + 1, i2 + 1, i3 + 1);
+		file.write_string(text);
+	}
+
+public:
+	Obj_writer(const char *file_name, const char *object_name, double merge_tolerance) :
+		Indexed_triangle_mesh_writer(merge_tolerance),
+		file(file_name)
+	{
+		file.write_string("# cmgui triangle mesh\n");
+		if (object_name)
+		{
+			file.write_string("o ");
+			file.write_string(object_name);
+			file.write_string("\n");
+		}
+	}
+
+	virtual bool is_valid() const
+	{
+		return file.is_valid();
+	}
+
+	virtual bool finish()
+	{
+		return file.close();
+	}
+};
+
+/***************************************************************************//**
+ * Writes little endian binary PLY. Vertex and face counts must precede the
+ * data, so faces are held until the file is finished; vertices are held by
+ * the hash grid anyway.
+ */
+class Ply_binary_writer : public Indexed_triangle_mesh_writer
+{
+private:
+	Buffered_file_writer file;
+	std::vector<int> faces;
+
+protected:
+	virtual void write_vertex(const double * /*v*/)
+	{
+	}
+
+	virtual void write_indexed_triangle(int i1, int i2, int i3)
+	{
+		faces.push_back(i1);
+		faces.push_back(i2);
+		faces.push_back(i3);
+	}
+
+public:
+	Ply_binary_writer(const char *file_name, const char *object_name, double merge_tolerance) :
+		Indexed_triangle_mesh_writer(merge_tolerance),
+		file(file_name)
+	{
+		USE_PARAMETER(object_name);
+	}
+
+	virtual bool is_valid() const
+	{
+		return file.is_valid();
+	}
+
+	virtual bool finish()
+	{
+		const int vertex_count = vertices.get_vertex_count();
+		const int face_count = static_cast<int>(faces.size()/3);
+		char text[300];
+		sprintf(text, "ply\nformat binary_little_endian 1.0\ncomment cmgui triangle mesh\n"
+			"element vertex %d\nproperty double x\nproperty double y\nproperty double z\n"
+			"element face %d\nproperty list uchar int vertex_indices\nend_header\n",
+			vertex_count, face_count);
+		file.write_string(text);
+		for (int i = 0; i < vertex_count; ++i)
+		{
+			const double *position = vertices.get_position(i);
+			file.write_double_le(position[0]);
+			file.write_double_le(position[1]);
+			file.write_double_le(position[2]);
+		}
+		const unsigned char vertices_per_face = 3;
+		for (int i = 0; i < face_count; ++i)
+		{
+			file.write(&vertices_per_face, 1);
+			file.write_uint32_le(static_cast<unsigned int>(faces[3*i]));
+			file.write_uint32_le(static_cast<unsigned int>(faces[3*i + 1]));
+			file.write_uint32_le(static_cast<unsigned int>(faces[3*i + 2]));
+		}
+		return file.close();
+	}
+};
+
+/***************************************************************************//**
+ * Context for traversing graphics objects, transforming triangles by the
+ * current glyph transformation and passing them to the writer for the chosen
+ * file format.
+ */
+class Stl_context
+{
+private:
+	Triangle_mesh_writer& writer;
+	std::stack<Transformation_matrix> transformation_stack;
+	std::vector<double> transformed_positions; // reused between vertex arrays
+
+public:
+	Stl_context(Triangle_mesh_writer& writer) :
+		writer(writer)
 	{
-		return (stl_file != (FILE *)NULL) && (solid_name != (char *)NULL);
 	}
 
 /***************************************************************************//**
@@ -198,7 +791,7 @@ public:
 		}
 	}
 
-	void transform(const Triple& v, double* tv) const
+	void transform(const GLfloat *v, double* tv) const
 	{
 		tv[0] = static_cast<double>(v[0]);
 		tv[1] = static_cast<double>(v[1]);
@@ -210,7 +803,7 @@ public:
 	}
 
 	/***************************************************************************//**
-	 * Writes a single STL triangle to file.
+	 * Writes a single triangle to file.
 	 * 
 	 * @param v1 coordinates of first vertex
 	 * @param v2 coordinates of second vertex
@@ -219,30 +812,50 @@ public:
 	void write_triangle(
 		const Triple& v1, const Triple& v2, const Triple& v3)
 	{
-		ZnReal tv1[3], tv2[3], tv3[3];
+		double tv1[3], tv2[3], tv3[3];
 		transform(v1, tv1);
 		transform(v2, tv2);
 		transform(v3, tv3);
+		writer.write_triangle(tv1, tv2, tv3);
+	} /* write_triangle_stl */
 
-		ZnReal tangent1[3], tangent2[3], normal[3];
-		tangent1[0] = tv2[0] - tv1[0];
-		tangent1[1] = tv2[1] - tv1[1];
-		tangent1[2] = tv2[2] - tv1[2];
-		tangent2[0] = tv3[0] - tv1[0];
-		tangent2[1] = tv3[1] - tv1[1];
-		tangent2[2] = tv3[2] - tv1[2];
-		cross_product3(tangent1, tangent2, normal);
-		if (0.0 < normalize3(normal))
-		{
-			fprintf(stl_file, "facet normal %f %f %f\n", (ZnReal)normal[0], (ZnReal)normal[1], (ZnReal)normal[2]);
-			fprintf(stl_file, " outer loop\n");		
-			fprintf(stl_file, "  vertex %g %g %g\n", (ZnReal)tv1[0], (ZnReal)tv1[1], (ZnReal)tv1[2]);		
-			fprintf(stl_file, "  vertex %g %g %g\n", (ZnReal)tv2[0], (ZnReal)tv2[1], (ZnReal)tv2[2]);
-			fprintf(stl_file, "  vertex %g %g %g\n", (ZnReal)tv3[0], (ZnReal)tv3[1], (ZnReal)tv3[2]);
-			fprintf(stl_file, " endloop\n");
-		 	fprintf(stl_file, "endfacet\n");
+	/***************************************************************************//**
+	 * Writes the triangles in a surface vertex array, as packed from GT_surface
+	 * primitives or built with shared vertices. Each vertex is transformed once
+	 * and the triangles are passed to the writer as a block.
+	 *
+	 * @param vertex_array  Array with POSITION and triangle INDEX attributes.
+	 * @return  1 on success, 0 if array is missing attributes.
+	 */
+	int write_vertex_array_triangles(Graphics_vertex_array *vertex_array)
+	{
+		GLfloat *position_buffer = 0;
+		unsigned int *index_buffer = 0;
+		unsigned int position_values_per_vertex = 0, position_vertex_count = 0,
+			index_values_per_vertex = 0, index_count = 0;
+		if (!(vertex_array && vertex_array->get_float_vertex_buffer(
+				GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_POSITION, &position_buffer,
+				&position_values_per_vertex, &position_vertex_count) &&
+			(3 <= position_values_per_vertex)))
+		{
+			return 0;
 		}
-	} /* write_triangle_stl */
+		vertex_array->get_unsigned_integer_vertex_buffer(
+			GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_INDEX,
+			&index_buffer, &index_values_per_vertex, &index_count);
+		if (index_buffer && (3 <= index_count))
+		{
+			transformed_positions.resize(3*position_vertex_count);
+			for (unsigned int i = 0; i < position_vertex_count; ++i)
+			{
+				transform(position_buffer + i*position_values_per_vertex,
+					&(transformed_positions[3*i]));
+			}
+			writer.write_triangles(&(transformed_positions[0]), position_vertex_count,
+				index_count/3, index_buffer);
+		}
+		return 1;
+	}
 
 }; /* class Stl_context */
 
@@ -812,18 +1425,25 @@ int makestl(Stl_context& stl_context, gtObject *object, ZnReal time)
 						}
 						else
 						{
-							while (surface)
+							/* pack into a local array so the graphics object is not modified */
+							Graphics_vertex_array *packed_array =
+								GT_object_create_packed_surface_vertex_array(object);
+							if (!stl_context.write_vertex_array_triangles(packed_array))
 							{
-								draw_surface_stl(stl_context,
-									surface->pointlist,surface->normallist,
-									surface->texturelist,
-									surface->n_pts1, surface->n_pts2,
-									surface->surface_type, surface->polygon,
-									surface->n_data_components,
-									surface->data,object->default_material,
-									object->spectrum);
-								surface=surface->ptrnext;
+								while (surface)
+								{
+									draw_surface_stl(stl_context,
+										surface->pointlist,surface->normallist,
+										surface->texturelist,
+										surface->n_pts1, surface->n_pts2,
+										surface->surface_type, surface->polygon,
+										surface->n_data_components,
+										surface->data,object->default_material,
+										object->spectrum);
+									surface=surface->ptrnext;
+								}
 							}
+							delete packed_array;
 						}
 						return_code=1;
 					}
@@ -833,6 +1453,19 @@ int makestl(Stl_context& stl_context, gtObject *object, ZnReal time)
 						return_code=0;
 					}
 				} break;
+				case g_SURFACE_VERTEX_BUFFERS:
+				{
+					if (!stl_context.write_vertex_array_triangles(object->vertex_array))
+					{
+						display_message(ERROR_MESSAGE,"makestl.  Invalid surface vertex array");
+						return_code=0;
+					}
+				} break;
+				case g_POLYLINE_VERTEX_BUFFERS:
+				{
+					/* not relevant to STL: ignore */
+					return_code=1;
+				} break;
 				case g_NURBS:
 				{
 					display_message(WARNING_MESSAGE,"makestl.  nurbs not supported yet");
@@ -975,35 +1608,65 @@ Global functions
 ----------------
 */
 
-int export_to_stl(char *file_name, struct Scene *scene)
+int export_to_triangle_mesh(const char *file_name, struct Scene *scene,
+	enum Triangle_mesh_file_format file_format, double merge_tolerance)
 {
 	int return_code;
 
-	ENTER(export_to_stl);
-	if (file_name && scene)
+	ENTER(export_to_triangle_mesh);
+	if (file_name && scene && (0.0 <= merge_tolerance))
 	{
 		build_Scene(scene);
 		char *solid_name = NULL;
 		GET_NAME(Scene)(scene, &solid_name);
-		Stl_context stl_context(file_name, solid_name);
-		if (stl_context.is_valid())
+		Triangle_mesh_writer *writer = 0;
+		switch (file_format)
 		{
+			case TRIANGLE_MESH_FILE_FORMAT_STL_ASCII:
+				writer = new Stl_ascii_writer(file_name, solid_name);
+				break;
+			case TRIANGLE_MESH_FILE_FORMAT_STL_BINARY:
+				writer = new Stl_binary_writer(file_name, solid_name);
+				break;
+			case TRIANGLE_MESH_FILE_FORMAT_OBJ:
+				writer = new Obj_writer(file_name, solid_name, merge_tolerance);
+				break;
+			case TRIANGLE_MESH_FILE_FORMAT_PLY_BINARY:
+				writer = new Ply_binary_writer(file_name, solid_name, merge_tolerance);
+				break;
+		}
+		if (writer && writer->is_valid())
+		{
+			Stl_context stl_context(*writer);
 			return_code = write_scene_stl(stl_context, scene);
+			if (!writer->finish())
+			{
+				display_message(ERROR_MESSAGE,
+					"export_to_triangle_mesh.  Error writing file %s", file_name);
+				return_code = 0;
+			}
 		}
 		else
 		{
 			display_message(ERROR_MESSAGE,
-				"export_to_stl.  Could not open stl file %s", file_name);
+				"export_to_triangle_mesh.  Could not open file %s", file_name);
 			return_code = 0;
 		}
+		delete writer;
 		DEALLOCATE(solid_name);
 	}
 	else
 	{
-		display_message(ERROR_MESSAGE,"export_to_stl.  Invalid argument(s)");
+		display_message(ERROR_MESSAGE,"export_to_triangle_mesh.  Invalid argument(s)");
 		return_code = 0;
 	}
 	LEAVE;
 
 	return( return_code);
+} /* export_to_triangle_mesh */
+
+int export_to_stl(char *file_name, struct Scene *scene)
+{
+	return export_to_triangle_mesh(file_name, scene,
+		TRIANGLE_MESH_FILE_FORMAT_STL_ASCII, /*merge_tolerance*/0.0);
 } /* export_to_stl */
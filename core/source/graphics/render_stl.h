@@ -48,6 +48,17 @@ struct Cmiss_scene;
 #define Scene Cmiss_scene // GRC temporary
 struct Scene_object;
 
+/**
+ * File formats for triangle mesh export.
+ */
+enum Triangle_mesh_file_format
+{
+	TRIANGLE_MESH_FILE_FORMAT_STL_ASCII, /**< ASCII STL, one facet per triangle */
+	TRIANGLE_MESH_FILE_FORMAT_STL_BINARY, /**< little endian binary STL */
+	TRIANGLE_MESH_FILE_FORMAT_OBJ, /**< Wavefront OBJ with shared vertices, geometry only */
+	TRIANGLE_MESH_FILE_FORMAT_PLY_BINARY /**< little endian binary PLY with shared vertices */
+};
+
 /*
 Global functions
 ----------------
@@ -63,4 +74,19 @@ Global functions
  */
 int export_to_stl(char *file_name, struct Scene *scene);
 
+/**************************************************************************//**
+ * Writes the triangles of the visible surfaces, iso-surfaces and glyphs in the
+ * scene to a file of the given format. Surfaces stored as vertex arrays are
+ * written directly from them. Output is buffered.
+ *
+ * @param file_name  The name of the file to write to.
+ * @param scene  The scene to output.
+ * @param file_format  The format of the file to write.
+ * @param merge_tolerance  For OBJ and PLY formats, vertices within this
+ * distance of each other are merged. 0.0 merges only identical vertices.
+ * @return  1 on success, 0 on failure.
+ */
+int export_to_triangle_mesh(const char *file_name, struct Scene *scene,
+	enum Triangle_mesh_file_format file_format, double merge_tolerance);
+
 #endif /* !defined (RENDERSTL_H) */
@@ -1152,6 +1152,17 @@ DESCRIPTION :
 				return_code = Graphics_object_render_to_finite_elements(gt_object,
 					time, data);
 			} break;
+			case g_SURFACE_VERTEX_BUFFERS:
+			{
+				struct GT_object *surfaces =
+					GT_object_create_surfaces_from_vertex_array(gt_object);
+				if (surfaces)
+				{
+					return_code = Graphics_object_render_to_finite_elements(surfaces,
+						time, data);
+					DESTROY(GT_object)(&surfaces);
+				}
+			} break;
 			case g_POINT:
 			case g_POINTSET:
 			case g_GLYPH_SET:
@@ -511,7 +511,19 @@ static int graphics_object_export_to_triangularisation(struct GT_object *gt_obje
 	if (trimesh_void)
 	{
 		Triangle_mesh& trimesh = *(static_cast<Triangle_mesh*>(trimesh_void));	
-		return_code = maketriangle_mesh(trimesh, gt_object, /*time*/0);
+		if (g_SURFACE_VERTEX_BUFFERS == GT_object_get_type(gt_object))
+		{
+			struct GT_object *surfaces = GT_object_create_surfaces_from_vertex_array(gt_object);
+			if (surfaces)
+			{
+				return_code = maketriangle_mesh(trimesh, surfaces, /*time*/0);
+				DESTROY(GT_object)(&surfaces);
+			}
+		}
+		else
+		{
+			return_code = maketriangle_mesh(trimesh, gt_object, /*time*/0);
+		}
 	}
 
 	return return_code;
@@ -2097,6 +2097,104 @@ DESCRIPTION :
 	return (return_code);
 } /* draw_voltex_vrml */
 
+/**
+ * Writes shared-vertex triangles of a surface vertex array as a single VRML
+ * IndexedFaceSet.
+ * @return  1 on success, 0 if the vertex array has no positions.
+ */
+static int draw_surface_vertex_buffers_vrml(FILE *vrml_file,
+	Graphics_vertex_array *vertex_array,
+	struct Graphical_material *default_material, struct Spectrum *spectrum,
+	struct LIST(VRML_prototype) *vrml_prototype_list)
+{
+	GLfloat *position_buffer = 0, *normal_buffer = 0, *data_buffer = 0;
+	unsigned int *index_buffer = 0;
+	unsigned int i, position_values_per_vertex = 0, position_vertex_count = 0,
+		normal_values_per_vertex = 0, normal_vertex_count = 0,
+		data_values_per_vertex = 0, data_vertex_count = 0,
+		index_values_per_vertex = 0, index_count = 0;
+	if (!(vertex_array && vertex_array->get_float_vertex_buffer(
+			GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_POSITION, &position_buffer,
+			&position_values_per_vertex, &position_vertex_count) &&
+		(3 <= position_values_per_vertex)))
+	{
+		display_message(ERROR_MESSAGE, "draw_surface_vertex_buffers_vrml.  Invalid vertex array");
+		return 0;
+	}
+	vertex_array->get_unsigned_integer_vertex_buffer(
+		GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_INDEX,
+		&index_buffer, &index_values_per_vertex, &index_count);
+	if (!(index_buffer && (3 <= index_count)))
+	{
+		return 1;
+	}
+	vertex_array->get_float_vertex_buffer(
+		GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_NORMAL, &normal_buffer,
+		&normal_values_per_vertex, &normal_vertex_count);
+	vertex_array->get_float_vertex_buffer(
+		GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_DATA, &data_buffer,
+		&data_values_per_vertex, &data_vertex_count);
+	fprintf(vrml_file, "Shape {\n");
+	fprintf(vrml_file, "  appearance\n");
+	if (default_material)
+	{
+		fprintf(vrml_file, "Appearance {\n");
+		fprintf(vrml_file, "  material\n");
+		activate_material_vrml(vrml_file, default_material,
+			vrml_prototype_list, /*no_define*/0, /*emissive_only*/0);
+		fprintf(vrml_file, "} #Appearance\n");
+	}
+	else
+	{
+		fprintf(vrml_file, "IS surface_appearance\n");
+	}
+	fprintf(vrml_file,"  geometry IndexedFaceSet {\n");
+	fprintf(vrml_file,"    solid FALSE\n");
+	fprintf(vrml_file,"    coord Coordinate {\n");
+	fprintf(vrml_file,"      point [\n");
+	for (i = 0; i < position_vertex_count; i++)
+	{
+		const GLfloat *position = position_buffer + i*position_values_per_vertex;
+		fprintf(vrml_file,"        %f %f %f,\n", position[0], position[1], position[2]);
+	}
+	fprintf(vrml_file,"      ]\n");
+	fprintf(vrml_file,"    }\n");
+	if (normal_buffer && (3 <= normal_values_per_vertex) &&
+		(normal_vertex_count == position_vertex_count))
+	{
+		fprintf(vrml_file,"    normal Normal {\n");
+		fprintf(vrml_file,"      vector [\n");
+		for (i = 0; i < normal_vertex_count; i++)
+		{
+			const GLfloat *normal = normal_buffer + i*normal_values_per_vertex;
+			fprintf(vrml_file,"        %f %f %f,\n", normal[0], normal[1], normal[2]);
+		}
+		fprintf(vrml_file,"      ]\n");
+		fprintf(vrml_file,"    }\n");
+	}
+	if (spectrum && data_buffer && (0 < data_values_per_vertex) &&
+		(data_vertex_count == position_vertex_count))
+	{
+		spectrum_start_render_vrml(vrml_file, spectrum, default_material);
+		for (i = 0; i < data_vertex_count; i++)
+		{
+			spectrum_render_vrml_value(vrml_file, spectrum, default_material,
+				data_values_per_vertex, data_buffer + i*data_values_per_vertex);
+		}
+		spectrum_end_render_vrml(vrml_file, spectrum);
+	}
+	fprintf(vrml_file,"    coordIndex [\n");
+	for (i = 0; i + 2 < index_count; i += 3)
+	{
+		fprintf(vrml_file,"      %u,%u,%u,-1\n",
+			index_buffer[i], index_buffer[i + 1], index_buffer[i + 2]);
+	}
+	fprintf(vrml_file,"    ]\n");
+	fprintf(vrml_file,"  } #IndexedFaceSet\n");
+	fprintf(vrml_file,"} #Shape\n");
+	return 1;
+}
+
 int makevrml(FILE *vrml_file,gtObject *object,ZnReal time,
 	struct LIST(VRML_prototype) *vrml_prototype_list)
 /*******************************************************************************
@@ -2533,6 +2631,12 @@ Only writes the geometry field.
 						return_code=0;
 					}
 				} break;
+				case g_SURFACE_VERTEX_BUFFERS:
+				{
+					return_code = draw_surface_vertex_buffers_vrml(vrml_file,
+						object->vertex_array, object->default_material,
+						object->spectrum, vrml_prototype_list);
+				} break;
 				case g_USERDEF:
 				{
 				} break;
@@ -2767,6 +2871,7 @@ graphics_object_tree_iterator_function
 			case g_GLYPH_SET:
 			case g_VOLTEX:
 			case g_SURFACE:
+			case g_SURFACE_VERTEX_BUFFERS:
 			{
 				return_code=write_graphics_object_vrml(vrml_file,gt_object,time,
 					export_to_vrml_data->vrml_prototype_list,
@@ -88,11 +88,19 @@ DESCRIPTION :
 	int access_count;
 }; /* struct Wavefront_vertex */
 
-/*
-Module variables
-----------------
-*/
-static int file_vertex_index, file_normal_vertex_index, file_texture_vertex_index;
+struct Wavefront_object_file
+/*******************************************************************************
+DESCRIPTION :
+Object file being written for one graphics object, with the numbers of
+vertices, normals and texture vertices written to it so far, which faces are
+indexed relative to. Kept per file so concurrent exports do not interfere.
+==============================================================================*/
+{
+	FILE *file;
+	int vertex_index;
+	int normal_vertex_index;
+	int texture_vertex_index;
+}; /* struct Wavefront_object_file */
 
 /*
 Module functions
@@ -287,10 +295,10 @@ Writes Wavefront object file that defines the material
 	return (return_code);
 } /* activate_material_wavefront */
 
-static int makewavefront(FILE *wavefront_file, int full_comments,
+static int makewavefront(struct Wavefront_object_file *object_file, int full_comments,
 	gtObject *object, ZnReal time);
 
-int draw_glyph_set_wavefront(FILE *wavefront_file, int number_of_points,
+int draw_glyph_set_wavefront(struct Wavefront_object_file *object_file, int number_of_points,
 	Triple *point_list,Triple *axis1_list,
 	Triple *axis2_list,Triple *axis3_list,struct GT_object *glyph,char **labels,
 	int number_of_data_components,GLfloat *data,struct Graphical_material *material,
@@ -304,6 +312,7 @@ points  given by the positions in <point_list> and oriented and scaled by
 <axis1_list>, <axis2_list> and <axis3_list>.
 ==============================================================================*/
 {
+	FILE *wavefront_file = object_file->file;
 	ZnReal transformation[16];
 	int i,return_code;
 	struct GT_object *transformed_object;
@@ -368,7 +377,7 @@ points  given by the positions in <point_list> and oriented and scaled by
 					{
 						set_GT_object_default_material(transformed_object,
 							material);
-						makewavefront(wavefront_file, 1, transformed_object, time);
+						makewavefront(object_file, 1, transformed_object, time);
 						DESTROY(GT_object)(&transformed_object);
 					}
 				}
@@ -398,7 +407,7 @@ points  given by the positions in <point_list> and oriented and scaled by
 	return (return_code);
 } /* draw_glyph_set_vrml */
 
-static int draw_surface_wavefront(FILE *file, Triple *surfpts, Triple *normalpts,
+static int draw_surface_wavefront(struct Wavefront_object_file *object_file, Triple *surfpts, Triple *normalpts,
 	Triple *texturepts, int npts1,int npts2, gtPolygonType polygon_type,
 	int number_of_data_components, GLfloat *data,
 	struct Graphical_material *material, struct Spectrum *spectrum,
@@ -410,6 +419,7 @@ LAST MODIFIED : 3 October 2000
 DESCRIPTION :
 ==============================================================================*/
 {
+	FILE *file = object_file->file;
 	int i,j,index,npts12,return_code = 0, *vertex_index_array, *vertex_index;
 	struct Wavefront_vertex *vertex;
 	struct Wavefront_vertex_position position;
@@ -452,9 +462,9 @@ DESCRIPTION :
 									surfpts[i+npts1*j][0],
 									surfpts[i+npts1*j][1],
 									surfpts[i+npts1*j][2]);
-								file_vertex_index++;
-								*vertex_index = file_vertex_index;
-								vertex = CREATE(Wavefront_vertex)(file_vertex_index,
+								object_file->vertex_index++;
+								*vertex_index = object_file->vertex_index;
+								vertex = CREATE(Wavefront_vertex)(object_file->vertex_index,
 									surfpts[i+npts1*j][0], surfpts[i+npts1*j][1],
 									surfpts[i+npts1*j][2]);
 								if (vertex != 0)
@@ -469,8 +479,8 @@ DESCRIPTION :
 								surfpts[i+npts1*j][0],
 								surfpts[i+npts1*j][1],
 								surfpts[i+npts1*j][2]);
-							file_vertex_index++;
-							*vertex_index = file_vertex_index;
+							object_file->vertex_index++;
+							*vertex_index = object_file->vertex_index;
 						}
 						vertex_index++;
 					}
@@ -485,12 +495,12 @@ DESCRIPTION :
 								texturepts[i+npts1*j][0],
 								texturepts[i+npts1*j][1],
 								texturepts[i+npts1*j][2]);
-							file_texture_vertex_index++;
+							object_file->texture_vertex_index++;
 						}
 					}
 				}
 
-				index = file_texture_vertex_index-npts1*npts2+1;
+				index = object_file->texture_vertex_index-npts1*npts2+1;
 				vertex_index = vertex_index_array;
 				for (i=0;i<npts1-1;i++)
 				{
@@ -549,9 +559,9 @@ DESCRIPTION :
 									(*surface_point_1)[0],
 									(*surface_point_1)[1],
 									(*surface_point_1)[2]);
-								file_vertex_index++;
-								*vertex_index = file_vertex_index;
-								vertex = CREATE(Wavefront_vertex)(file_vertex_index,
+								object_file->vertex_index++;
+								*vertex_index = object_file->vertex_index;
+								vertex = CREATE(Wavefront_vertex)(object_file->vertex_index,
 									(*surface_point_1)[0], (*surface_point_1)[1],
 									(*surface_point_1)[2]);
 								if (vertex != 0)
@@ -566,8 +576,8 @@ DESCRIPTION :
 								(*surface_point_1)[0],
 								(*surface_point_1)[1],
 								(*surface_point_1)[2]);
-							file_vertex_index++;
-							*vertex_index = file_vertex_index;
+							object_file->vertex_index++;
+							*vertex_index = object_file->vertex_index;
 						}
 						vertex_index++;
 						surface_point_1++;
@@ -577,12 +587,12 @@ DESCRIPTION :
 								(*texture_point)[0],
 								(*texture_point)[1],
 								(*texture_point)[2]);
-							file_texture_vertex_index++;
+							object_file->texture_vertex_index++;
 							texture_point++;
 						}
 					}
 				}
-				index = file_texture_vertex_index-npts12+1;
+				index = object_file->texture_vertex_index-npts12+1;
 				vertex_index = vertex_index_array;
 				for (i= npts1;i>1;i--)
 				{
@@ -651,7 +661,7 @@ DESCRIPTION :
 	return (return_code);
 } /* draw_surface_wavefront */
 
-static int drawvoltexwavefront(FILE *out_file, int full_comments,
+static int drawvoltexwavefront(struct Wavefront_object_file *object_file, int full_comments,
 	int number_of_vertices, struct VT_iso_vertex **vertex_list,
 	int number_of_triangles, struct VT_iso_triangle **triangle_list,
 	int number_of_data_components,
@@ -662,6 +672,7 @@ LAST MODIFIED : 10 November 2005
 DESCRIPTION :
 ==============================================================================*/
 {
+	FILE *out_file = object_file->file;
 	int i,return_code;
 
 	ENTER(drawvoltexwavefront);
@@ -718,19 +729,19 @@ DESCRIPTION :
 				fprintf(out_file,"# polygon %d\n",i+1);
 			}
 			fprintf(out_file,"f   %d/%d/%d  %d/%d/%d  %d/%d/%d\n",
-				triangle_list[i]->vertices[0]->index+file_vertex_index+1,
-				triangle_list[i]->vertices[0]->index+file_texture_vertex_index+1,
-				triangle_list[i]->vertices[0]->index+file_normal_vertex_index+1,
-				triangle_list[i]->vertices[1]->index+file_vertex_index+1,
-				triangle_list[i]->vertices[1]->index+file_texture_vertex_index+1,
-				triangle_list[i]->vertices[1]->index+file_normal_vertex_index+1,
-				triangle_list[i]->vertices[2]->index+file_vertex_index+1,
-				triangle_list[i]->vertices[2]->index+file_texture_vertex_index+1,
-				triangle_list[i]->vertices[2]->index+file_normal_vertex_index+1);
+				triangle_list[i]->vertices[0]->index+object_file->vertex_index+1,
+				triangle_list[i]->vertices[0]->index+object_file->texture_vertex_index+1,
+				triangle_list[i]->vertices[0]->index+object_file->normal_vertex_index+1,
+				triangle_list[i]->vertices[1]->index+object_file->vertex_index+1,
+				triangle_list[i]->vertices[1]->index+object_file->texture_vertex_index+1,
+				triangle_list[i]->vertices[1]->index+object_file->normal_vertex_index+1,
+				triangle_list[i]->vertices[2]->index+object_file->vertex_index+1,
+				triangle_list[i]->vertices[2]->index+object_file->texture_vertex_index+1,
+				triangle_list[i]->vertices[2]->index+object_file->normal_vertex_index+1);
 		} /* for i */
-		file_vertex_index += number_of_vertices;
-		file_normal_vertex_index += number_of_vertices;
-		file_texture_vertex_index += number_of_vertices;
+		object_file->vertex_index += number_of_vertices;
+		object_file->normal_vertex_index += number_of_vertices;
+		object_file->texture_vertex_index += number_of_vertices;
 	}
 	else
 	{
@@ -742,13 +753,94 @@ DESCRIPTION :
 	return (return_code);
 } /* drawvoltexwavefront */
 
-int drawnurbswavefront(FILE *file, struct GT_nurbs *nurbptr)
+/**
+ * Writes shared-vertex triangles of a surface vertex array, with vertex
+ * normals if present.
+ * @return  1 on success, 0 if the vertex array has no positions.
+ */
+static int draw_surface_vertex_buffers_wavefront(struct Wavefront_object_file *object_file,
+	int full_comments, Graphics_vertex_array *vertex_array)
+{
+	FILE *out_file = object_file->file;
+	GLfloat *position_buffer = 0, *normal_buffer = 0;
+	unsigned int *index_buffer = 0;
+	unsigned int i, position_values_per_vertex = 0, position_vertex_count = 0,
+		normal_values_per_vertex = 0, normal_vertex_count = 0,
+		index_values_per_vertex = 0, index_count = 0;
+	if (!(vertex_array && vertex_array->get_float_vertex_buffer(
+			GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_POSITION, &position_buffer,
+			&position_values_per_vertex, &position_vertex_count) &&
+		(3 <= position_values_per_vertex)))
+	{
+		display_message(ERROR_MESSAGE, "draw_surface_vertex_buffers_wavefront.  Invalid vertex array");
+		return 0;
+	}
+	vertex_array->get_unsigned_integer_vertex_buffer(
+		GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_INDEX,
+		&index_buffer, &index_values_per_vertex, &index_count);
+	if (!(index_buffer && (3 <= index_count)))
+	{
+		return 1;
+	}
+	vertex_array->get_float_vertex_buffer(
+		GRAPHICS_VERTEX_ARRAY_ATTRIBUTE_TYPE_NORMAL, &normal_buffer,
+		&normal_values_per_vertex, &normal_vertex_count);
+	const bool use_normals = (0 != normal_buffer) && (3 <= normal_values_per_vertex) &&
+		(normal_vertex_count == position_vertex_count);
+	if ( full_comments )
+	{
+		fprintf(out_file,"#vertex list\n");
+	}
+	for (i = 0; i < position_vertex_count; i++)
+	{
+		const GLfloat *position = position_buffer + i*position_values_per_vertex;
+		fprintf(out_file,"v %.9g %.9g %.9g\n", position[0], position[1], position[2]);
+	}
+	if (use_normals)
+	{
+		if ( full_comments )
+		{
+			fprintf(out_file,"#normal list\n");
+		}
+		for (i = 0; i < normal_vertex_count; i++)
+		{
+			const GLfloat *normal = normal_buffer + i*normal_values_per_vertex;
+			fprintf(out_file,"vn %.9g %.9g %.9g\n", normal[0], normal[1], normal[2]);
+		}
+	}
+	for (i = 0; i + 2 < index_count; i += 3)
+	{
+		const unsigned int v0 = index_buffer[i] + object_file->vertex_index + 1;
+		const unsigned int v1 = index_buffer[i + 1] + object_file->vertex_index + 1;
+		const unsigned int v2 = index_buffer[i + 2] + object_file->vertex_index + 1;
+		if (use_normals)
+		{
+			const unsigned int n0 = index_buffer[i] + object_file->normal_vertex_index + 1;
+			const unsigned int n1 = index_buffer[i + 1] + object_file->normal_vertex_index + 1;
+			const unsigned int n2 = index_buffer[i + 2] + object_file->normal_vertex_index + 1;
+			fprintf(out_file,"f   %u//%u  %u//%u  %u//%u\n", v0, n0, v1, n1, v2, n2);
+		}
+		else
+		{
+			fprintf(out_file,"f   %u  %u  %u\n", v0, v1, v2);
+		}
+	}
+	object_file->vertex_index += position_vertex_count;
+	if (use_normals)
+	{
+		object_file->normal_vertex_index += normal_vertex_count;
+	}
+	return 1;
+}
+
+int drawnurbswavefront(struct Wavefront_object_file *object_file, struct GT_nurbs *nurbptr)
 /*******************************************************************************
 LAST MODIFIED : 9 March 1999
 
 DESCRIPTION :
 ==============================================================================*/
 {
+	FILE *file = object_file->file;
 	int i, number_of_control_points, return_code;
 
 	ENTER(drawnurbsGL);
@@ -805,15 +897,15 @@ DESCRIPTION :
 		{
 			for( i = 0 ; i < number_of_control_points ; i++)
 			{
-				fprintf(file, " %d", file_vertex_index + i + 1);
+				fprintf(file, " %d", object_file->vertex_index + i + 1);
 			}
 		}
 		else
 		{
 			for( i = 0 ; i < number_of_control_points ; i++)
 			{
-				fprintf(file, " %d/%d", file_vertex_index + i + 1,
-					file_vertex_index + i + 1);
+				fprintf(file, " %d/%d", object_file->vertex_index + i + 1,
+					object_file->vertex_index + i + 1);
 			}
 		}
 		fprintf(file, "\nparm u");
@@ -828,7 +920,7 @@ DESCRIPTION :
 		}
 		fprintf(file, "\nend\n");
 
-		file_vertex_index += number_of_control_points;
+		object_file->vertex_index += number_of_control_points;
 
 		if (nurbptr->cknotcnt>0)
 		{
@@ -846,7 +938,7 @@ DESCRIPTION :
 	return (return_code);
 } /* drawnurbsGL */
 
-static int makewavefront(FILE *wavefront_file, int full_comments,
+static int makewavefront(struct Wavefront_object_file *object_file, int full_comments,
 	gtObject *object, ZnReal time)
 /*******************************************************************************
 LAST MODIFIED : 20 March 2003
@@ -955,7 +1047,7 @@ Convert graphical object into Wavefront object file.
 									glyph_set,glyph_set_2);
 								if (interpolate_glyph_set != 0)
 								{
-									draw_glyph_set_wavefront(wavefront_file,
+									draw_glyph_set_wavefront(object_file,
 										interpolate_glyph_set->number_of_points,
 										interpolate_glyph_set->point_list,
 										interpolate_glyph_set->axis1_list,
@@ -977,7 +1069,7 @@ Convert graphical object into Wavefront object file.
 						{
 							while (glyph_set)
 							{
-								draw_glyph_set_wavefront(wavefront_file,
+								draw_glyph_set_wavefront(object_file,
 									glyph_set->number_of_points,
 									glyph_set->point_list,glyph_set->axis1_list,
 									glyph_set->axis2_list,glyph_set->axis3_list,glyph_set->glyph,
@@ -1002,7 +1094,7 @@ Convert graphical object into Wavefront object file.
 					{
 						while (voltex)
 						{
-							drawvoltexwavefront(wavefront_file, full_comments,
+							drawvoltexwavefront(object_file, full_comments,
 								voltex->number_of_vertices, voltex->vertex_list,
 								voltex->number_of_triangles, voltex->triangle_list,
 								voltex->n_data_components,
@@ -1041,7 +1133,7 @@ Convert graphical object into Wavefront object file.
 										if (interpolate_surface != 0)
 										{
 											draw_surface_wavefront(
-												wavefront_file,
+												object_file,
 												interpolate_surface->pointlist,
 												interpolate_surface->normallist,
 												interpolate_surface->texturelist,
@@ -1063,7 +1155,7 @@ Convert graphical object into Wavefront object file.
 									{
 										while (surface)
 										{
-											draw_surface_wavefront(wavefront_file,
+											draw_surface_wavefront(object_file,
 												surface->pointlist,surface->normallist,
 												surface->texturelist, surface->n_pts1,
 												surface->n_pts2, surface->polygon,
@@ -1166,7 +1258,7 @@ Convert graphical object into Wavefront object file.
 						return_code=1;
 						while(return_code && nurbs)
 						{
-							return_code = drawnurbswavefront(wavefront_file, nurbs);
+							return_code = drawnurbswavefront(object_file, nurbs);
 							nurbs=nurbs->ptrnext;
 						}
 					}
@@ -1176,6 +1268,11 @@ Convert graphical object into Wavefront object file.
 						return_code=0;
 					}
 				} break;
+				case g_SURFACE_VERTEX_BUFFERS:
+				{
+					return_code = draw_surface_vertex_buffers_wavefront(object_file,
+						full_comments, object->vertex_array);
+				} break;
 				case g_USERDEF:
 				{
 				} break;
@@ -1235,6 +1332,7 @@ Write the window object to the <wavefront_file_void>.
 			case g_GLYPH_SET:
 			case g_VOLTEX:
 			case g_SURFACE:
+			case g_SURFACE_VERTEX_BUFFERS:
 			case g_NURBS:
 			{
 				int error = 0;
@@ -1269,10 +1367,12 @@ Write the window object to the <wavefront_file_void>.
 					fprintf(wavefront_object_file,
 						"# CMGUI Wavefront Object file generator\n#%s \n",file_basename);
 					fprintf(wavefront_object_file,"mtllib global.mtl\n\n");
-					file_vertex_index = 0;
-					file_normal_vertex_index = 0;
-					file_texture_vertex_index = 0;
-					return_code=makewavefront(wavefront_object_file,
+					struct Wavefront_object_file object_file;
+					object_file.file = wavefront_object_file;
+					object_file.vertex_index = 0;
+					object_file.normal_vertex_index = 0;
+					object_file.texture_vertex_index = 0;
+					return_code=makewavefront(&object_file,
 						export_to_wavefront_data->full_comments,
 						gt_object, time);
 					fclose(wavefront_object_file);
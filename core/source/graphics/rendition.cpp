@@ -46,6 +46,7 @@ FILE : rendition.cpp
 #include "zinc/graphicsmodule.h"
 #include "zinc/node.h"
 #include "zinc/rendition.h"
+#include "zinc/status.h"
 #include "computed_field/computed_field.h"
 #include "computed_field/computed_field_finite_element.h"
 #include "computed_field/computed_field_group.h"
@@ -56,6 +57,7 @@ FILE : rendition.cpp
 #include "finite_element/finite_element_region.h"
 #include "graphics/graphic.h"
 #include "graphics/graphics_module.h"
+#include "graphics/graphics_object_pick.hpp"
 #include "graphics/scene.h"
 #include "graphics/rendition.h"
 #include "general/any_object_private.h"
@@ -63,6 +65,7 @@ FILE : rendition.cpp
 #include "general/callback_private.h"
 #include "general/debug.h"
 #include "general/mystring.h"
+#include "general/time.h"
 #include "region/cmiss_region_private.h"
 #include "general/object.h"
 #include "graphics/graphics_library.h"
@@ -347,6 +350,15 @@ struct Cmiss_rendition *CREATE(Cmiss_rendition)(struct Cmiss_region *cmiss_regio
 				cmiss_rendition->transformation = (gtMatrix *)NULL;
 				cmiss_rendition->graphics_module =	graphics_module;
 				cmiss_rendition->time_object = NULL;
+				cmiss_rendition->time_cache_memory_limit = 0;
+				cmiss_rendition->rebuild_time_limit = 0.0;
+				cmiss_rendition->rebuild_pending = 0;
+				cmiss_rendition->fill_minimum_time = 0.0;
+				cmiss_rendition->fill_maximum_time = 0.0;
+				cmiss_rendition->fill_number_of_times = 0;
+				cmiss_rendition->fill_time_index = 0;
+				cmiss_rendition->rebuild_callback = NULL;
+				cmiss_rendition->rebuild_callback_user_data = NULL;
 				cmiss_rendition->list_of_scene = NULL;
 				cmiss_rendition->cache = 0;
 				cmiss_rendition->changed = 0;
@@ -1048,52 +1060,197 @@ int Cmiss_rendition_modify_graphic(struct Cmiss_rendition *rendition,
 	return (return_code);
 } /* Cmiss_rendition_modify_graphic */
 
+/***************************************************************************//**
+ * Builds the graphics objects of the rendition's graphics which need it, at
+ * <time>. With a positive <time_limit> from <start_time>, graphics and
+ * elements remaining when it is reached are left for following builds.
+ * @param number_of_deferred_rebuilds  On return, number of graphics whose
+ * rebuild was deferred or left incomplete.
+ * @param build_progress  On return, number of graphics and elements built.
+ */
+static int Cmiss_rendition_build_graphics_objects_private(
+	struct Cmiss_rendition *rendition, struct Cmiss_scene *scene,
+	FE_value time, const char *name_prefix, double time_limit,
+	const struct timeval *start_time, int *number_of_deferred_rebuilds,
+	int *build_progress)
+{
+	int return_code = 1;
+	struct Cmiss_graphic_to_graphics_object_data graphic_to_object_data;
+
+	*number_of_deferred_rebuilds = 0;
+	*build_progress = 0;
+	if (Cmiss_rendition_get_number_of_graphics(rendition) > 0)
+	{
+		// use begin/end cache to avoid field manager messages being sent when
+		// field wrappers are created and destroyed
+		MANAGER_BEGIN_CACHE(Computed_field)(rendition->computed_field_manager);
+		graphic_to_object_data.name_prefix = name_prefix;
+		graphic_to_object_data.rc_coordinate_field = (struct Computed_field *) NULL;
+		graphic_to_object_data.wrapper_orientation_scale_field
+			= (struct Computed_field *) NULL;
+		graphic_to_object_data.wrapper_stream_vector_field = (struct Computed_field *) NULL;
+		graphic_to_object_data.region = rendition->region;
+		graphic_to_object_data.field_module = Cmiss_region_get_field_module(rendition->region);
+		graphic_to_object_data.field_cache = Cmiss_field_module_create_cache(graphic_to_object_data.field_module);
+		graphic_to_object_data.fe_region = rendition->fe_region;
+		graphic_to_object_data.data_fe_region = rendition->data_fe_region;
+		graphic_to_object_data.master_mesh = 0;
+		graphic_to_object_data.iteration_mesh = 0;
+		graphic_to_object_data.scene = scene;
+		graphic_to_object_data.time = time;
+		graphic_to_object_data.selected_element_point_ranges_list
+			= Element_point_ranges_selection_get_element_point_ranges_list(
+				Cmiss_graphics_module_get_element_point_ranges_selection(
+					rendition->graphics_module));
+		graphic_to_object_data.selection_group_field = Cmiss_field_group_base_cast(
+			Cmiss_rendition_get_selection_group(rendition));
+		graphic_to_object_data.iso_surface_specification = NULL;
+		graphic_to_object_data.graphic = NULL;
+		graphic_to_object_data.graphics_object = NULL;
+		graphic_to_object_data.surface_mesh_builder = NULL;
+		graphic_to_object_data.level_of_detail_projection = NULL;
+		graphic_to_object_data.element_levels = NULL;
+		graphic_to_object_data.defer_full_rebuilds = 0;
+		graphic_to_object_data.number_of_deferred_rebuilds = 0;
+		/* with a time limit, graphics and elements left when it is reached
+			are built in following builds */
+		graphic_to_object_data.build_time_limit = time_limit;
+		graphic_to_object_data.build_start_time = *start_time;
+		graphic_to_object_data.build_progress = 0;
+		return_code = FOR_EACH_OBJECT_IN_LIST(Cmiss_graphic)(
+			Cmiss_graphic_to_graphics_object, (void *) &graphic_to_object_data,
+			rendition->list_of_graphics);
+		MANAGER_END_CACHE(Computed_field)(rendition->computed_field_manager);
+		if (graphic_to_object_data.selection_group_field)
+		{
+			Cmiss_field_destroy(&graphic_to_object_data.selection_group_field);
+		}
+		Cmiss_field_cache_destroy(&graphic_to_object_data.field_cache);
+		Cmiss_field_module_destroy(&graphic_to_object_data.field_module);
+		*number_of_deferred_rebuilds = graphic_to_object_data.number_of_deferred_rebuilds;
+		*build_progress = graphic_to_object_data.build_progress;
+	}
+	return (return_code);
+}
+
+static void Cmiss_rendition_graphics_time_change(struct Cmiss_rendition *rendition,
+	double time);
+
+/***************************************************************************//**
+ * Builds and caches the time-dependent graphics of the rendition at <time>,
+ * then restores the graphics for the current time.
+ */
+static int Cmiss_rendition_fill_time_cache_at_time(
+	struct Cmiss_rendition *rendition, struct Cmiss_scene *scene,
+	double time, const char *name_prefix)
+{
+	const double current_time = (rendition->time_object) ?
+		Time_object_get_current_time(rendition->time_object) : 0.0;
+	struct timeval start_time;
+	gettimeofday(&start_time, NULL);
+	int number_of_deferred_rebuilds, build_progress;
+	Cmiss_rendition_begin_change(rendition);
+	Cmiss_rendition_graphics_time_change(rendition, time);
+	/* build every graphic, without deferring any */
+	int return_code = Cmiss_rendition_build_graphics_objects_private(rendition,
+		scene, time, name_prefix, /*time_limit*/0.0, &start_time,
+		&number_of_deferred_rebuilds, &build_progress);
+	/* caches the graphics for this time and restores the current ones */
+	Cmiss_rendition_graphics_time_change(rendition, current_time);
+	Cmiss_rendition_end_change(rendition);
+	return return_code;
+}
+
+/***************************************************************************//**
+ * Builds the graphics for the next times of a time cache fill spread across
+ * builds, until the rebuild time limit from <start_time> is reached. Unless
+ * <build_progress> shows this build has already built something, at least
+ * one time is built.
+ * @return  1 if times remain to be built in following builds, otherwise 0.
+ */
+static int Cmiss_rendition_continue_fill_time_cache(
+	struct Cmiss_rendition *rendition, struct Cmiss_scene *scene,
+	const char *name_prefix, const struct timeval *start_time, int build_progress)
+{
+	while (rendition->fill_time_index < rendition->fill_number_of_times)
+	{
+		if ((0.0 < rendition->rebuild_time_limit) && (0 < build_progress))
+		{
+			struct timeval time;
+			gettimeofday(&time, NULL);
+			const double elapsed_time =
+				static_cast<double>(time.tv_sec - start_time->tv_sec) +
+				1.0E-6*static_cast<double>(time.tv_usec - start_time->tv_usec);
+			if (elapsed_time >= rendition->rebuild_time_limit)
+			{
+				break;
+			}
+		}
+		const int number_of_times = rendition->fill_number_of_times;
+		const double time = (1 < number_of_times) ? rendition->fill_minimum_time +
+			rendition->fill_time_index*(rendition->fill_maximum_time -
+				rendition->fill_minimum_time)/(number_of_times - 1) :
+			rendition->fill_minimum_time;
+		if (!Cmiss_rendition_fill_time_cache_at_time(rendition, scene, time, name_prefix))
+		{
+			display_message(ERROR_MESSAGE,
+				"Cmiss_rendition_fill_time_cache.  Could not build graphics at time %g", time);
+			rendition->fill_number_of_times = 0;
+			break;
+		}
+		++(rendition->fill_time_index);
+		++build_progress;
+	}
+	if (rendition->fill_time_index >= rendition->fill_number_of_times)
+	{
+		rendition->fill_number_of_times = 0;
+		rendition->fill_time_index = 0;
+		return 0;
+	}
+	return 1;
+}
+
 static int Cmiss_rendition_build_graphics_objects(
 	struct Cmiss_rendition *rendition, struct Cmiss_scene *scene,
 	FE_value time, const char *name_prefix)
 {
 	int return_code = 1;
-	struct Cmiss_graphic_to_graphics_object_data graphic_to_object_data;
 
 	ENTER(Cmiss_rendition_build_graphics_objects);
 	if (rendition)
 	{
 		if ((Cmiss_rendition_get_number_of_graphics(rendition) > 0))
 		{
-			// use begin/end cache to avoid field manager messages being sent when
-			// field wrappers are created and destroyed
-			MANAGER_BEGIN_CACHE(Computed_field)(rendition->computed_field_manager);
-			graphic_to_object_data.name_prefix = name_prefix;
-			graphic_to_object_data.rc_coordinate_field = (struct Computed_field *) NULL;
-			graphic_to_object_data.wrapper_orientation_scale_field
-				= (struct Computed_field *) NULL;
-			graphic_to_object_data.wrapper_stream_vector_field = (struct Computed_field *) NULL;
-			graphic_to_object_data.region = rendition->region;
-			graphic_to_object_data.field_module = Cmiss_region_get_field_module(rendition->region);
-			graphic_to_object_data.field_cache = Cmiss_field_module_create_cache(graphic_to_object_data.field_module);
-			graphic_to_object_data.fe_region = rendition->fe_region;
-			graphic_to_object_data.data_fe_region = rendition->data_fe_region;
-			graphic_to_object_data.master_mesh = 0;
-			graphic_to_object_data.iteration_mesh = 0;
-			graphic_to_object_data.scene = scene;
-			graphic_to_object_data.time = time;
-			graphic_to_object_data.selected_element_point_ranges_list
-				= Element_point_ranges_selection_get_element_point_ranges_list(
-					Cmiss_graphics_module_get_element_point_ranges_selection(
-						rendition->graphics_module));
-			graphic_to_object_data.selection_group_field = Cmiss_field_group_base_cast(
-				Cmiss_rendition_get_selection_group(rendition));
-			graphic_to_object_data.iso_surface_specification = NULL;
-			return_code = FOR_EACH_OBJECT_IN_LIST(Cmiss_graphic)(
-				Cmiss_graphic_to_graphics_object, (void *) &graphic_to_object_data,
-				rendition->list_of_graphics);
-			MANAGER_END_CACHE(Computed_field)(rendition->computed_field_manager);
-			if (graphic_to_object_data.selection_group_field)
+			struct timeval start_time;
+			gettimeofday(&start_time, NULL);
+			int number_of_deferred_rebuilds, build_progress;
+			return_code = Cmiss_rendition_build_graphics_objects_private(rendition,
+				scene, time, name_prefix, rendition->rebuild_time_limit, &start_time,
+				&number_of_deferred_rebuilds, &build_progress);
+			/* fill the time cache only once graphics for the current time are
+				complete, as changing time discards incomplete graphics */
+			int fill_pending = (0 < rendition->fill_number_of_times);
+			if (fill_pending && (0 == number_of_deferred_rebuilds))
+			{
+				fill_pending = Cmiss_rendition_continue_fill_time_cache(rendition,
+					scene, name_prefix, &start_time, build_progress);
+			}
+			if ((0 < number_of_deferred_rebuilds) || fill_pending)
+			{
+				/* request another build to continue rebuilding */
+				rendition->rebuild_pending = 1;
+				Cmiss_rendition_changed(rendition);
+			}
+			else if (rendition->rebuild_pending ||
+				((0.0 < rendition->rebuild_time_limit) && (0 < build_progress)))
 			{
-				Cmiss_field_destroy(&graphic_to_object_data.selection_group_field);
+				rendition->rebuild_pending = 0;
+				if (rendition->rebuild_callback)
+				{
+					(rendition->rebuild_callback)(rendition,
+						rendition->rebuild_callback_user_data);
+				}
 			}
-			Cmiss_field_cache_destroy(&graphic_to_object_data.field_cache);
-			Cmiss_field_module_destroy(&graphic_to_object_data.field_module);
 		}
 	}
 	else
@@ -1676,6 +1833,135 @@ int Cmiss_rendition_render_child_rendition(struct Cmiss_rendition *rendition,
 
 }
 
+int Cmiss_rendition_pick_objects(struct Cmiss_rendition *rendition,
+	Scene_pick_context& pick_context)
+{
+	int return_code;
+
+	ENTER(Cmiss_rendition_pick_objects);
+	if (rendition && rendition->region)
+	{
+		return_code = 1;
+		struct Cmiss_rendition *parent_rendition = pick_context.get_rendition();
+		const ZnReal parent_time = pick_context.get_time();
+		pick_context.push_transformation(rendition->transformation);
+		pick_context.set_rendition(rendition, rendition->time_object ?
+			Time_object_get_current_time(rendition->time_object) : 0.0);
+		if (!FOR_EACH_OBJECT_IN_LIST(Cmiss_graphic)(
+			Cmiss_graphic_pick_visible_graphic, static_cast<void *>(&pick_context),
+			rendition->list_of_graphics))
+		{
+			return_code = 0;
+		}
+		struct Cmiss_region *child_region = Cmiss_region_get_first_child(rendition->region);
+		while (child_region)
+		{
+			struct Cmiss_rendition *child_rendition =
+				Cmiss_region_get_rendition_internal(child_region);
+			if (child_rendition)
+			{
+				if (!Cmiss_rendition_pick_objects(child_rendition, pick_context))
+				{
+					return_code = 0;
+				}
+				DEACCESS(Cmiss_rendition)(&child_rendition);
+			}
+			Cmiss_region_reaccess_next_sibling(&child_region);
+		}
+		pick_context.pop_transformation();
+		pick_context.set_rendition(parent_rendition, parent_time);
+	}
+	else
+	{
+		display_message(ERROR_MESSAGE,
+			"Cmiss_rendition_pick_objects.  Invalid argument(s)");
+		return_code = 0;
+	}
+	LEAVE;
+
+	return (return_code);
+}
+
+/***************************************************************************//**
+ * Recursive part of Cmiss_rendition_set_level_of_detail_projection.
+ * @param parent_to_pixel  Projection from the coordinates of the parent
+ * rendition, or world coordinates for the top rendition.
+ */
+static int Cmiss_rendition_set_level_of_detail_projection_recursive(
+	struct Cmiss_rendition *rendition, const double *world_to_pixel,
+	const double *parent_to_pixel)
+{
+	int return_code;
+
+	ENTER(Cmiss_rendition_set_level_of_detail_projection_recursive);
+	if (rendition && rendition->region)
+	{
+		return_code = 1;
+		double local_to_pixel[16];
+		struct Cmiss_graphic_level_of_detail_data level_of_detail_data;
+		level_of_detail_data.world_to_pixel = world_to_pixel;
+		level_of_detail_data.local_to_pixel = parent_to_pixel;
+		if (parent_to_pixel && rendition->transformation)
+		{
+			/* transformation is stored in columns */
+			for (int i = 0; i < 4; i++)
+			{
+				for (int j = 0; j < 4; j++)
+				{
+					double sum = 0.0;
+					for (int k = 0; k < 4; k++)
+					{
+						sum += parent_to_pixel[i*4 + k]*(*(rendition->transformation))[j][k];
+					}
+					local_to_pixel[i*4 + j] = sum;
+				}
+			}
+			level_of_detail_data.local_to_pixel = local_to_pixel;
+		}
+		Cmiss_rendition_begin_change(rendition);
+		if (!FOR_EACH_OBJECT_IN_LIST(Cmiss_graphic)(
+			Cmiss_graphic_set_level_of_detail_projection,
+			world_to_pixel ? static_cast<void *>(&level_of_detail_data) : NULL,
+			rendition->list_of_graphics))
+		{
+			return_code = 0;
+		}
+		Cmiss_rendition_end_change(rendition);
+		struct Cmiss_region *child_region = Cmiss_region_get_first_child(rendition->region);
+		while (child_region)
+		{
+			struct Cmiss_rendition *child_rendition =
+				Cmiss_region_get_rendition_internal(child_region);
+			if (child_rendition)
+			{
+				if (!Cmiss_rendition_set_level_of_detail_projection_recursive(child_rendition,
+					world_to_pixel, level_of_detail_data.local_to_pixel))
+				{
+					return_code = 0;
+				}
+				DEACCESS(Cmiss_rendition)(&child_rendition);
+			}
+			Cmiss_region_reaccess_next_sibling(&child_region);
+		}
+	}
+	else
+	{
+		display_message(ERROR_MESSAGE,
+			"Cmiss_rendition_set_level_of_detail_projection_recursive.  Invalid argument(s)");
+		return_code = 0;
+	}
+	LEAVE;
+
+	return (return_code);
+}
+
+int Cmiss_rendition_set_level_of_detail_projection(
+	struct Cmiss_rendition *rendition, const double *world_to_pixel)
+{
+	return Cmiss_rendition_set_level_of_detail_projection_recursive(rendition,
+		world_to_pixel, world_to_pixel);
+}
+
 int execute_Cmiss_rendition(struct Cmiss_rendition *rendition,
 	Render_graphics_opengl *renderer)
 {
@@ -2780,6 +3066,53 @@ int Cmiss_rendition_set_transformation_with_time_callback(struct Cmiss_rendition
 	 return (return_code);
 }
 
+/***************************************************************************//**
+ * Discards graphics cached for times farthest from <time> until the time
+ * caches of all graphics in the rendition fit in its memory limit.
+ */
+static void Cmiss_rendition_trim_time_cache(struct Cmiss_rendition *rendition,
+	double time)
+{
+	while (true)
+	{
+		struct Cmiss_graphic_time_cache_trim_data trim_data;
+		trim_data.time = time;
+		trim_data.memory_size = 0;
+		trim_data.farthest_graphic = (struct Cmiss_graphic *)NULL;
+		trim_data.farthest_distance = 0.0;
+		FOR_EACH_OBJECT_IN_LIST(Cmiss_graphic)(
+			Cmiss_graphic_time_cache_find_farthest, (void *)&trim_data,
+			rendition->list_of_graphics);
+		if ((trim_data.memory_size <= rendition->time_cache_memory_limit) ||
+			(!trim_data.farthest_graphic) ||
+			(!Cmiss_graphic_time_cache_remove_farthest(trim_data.farthest_graphic, time)))
+		{
+			break;
+		}
+	}
+}
+
+/***************************************************************************//**
+ * Updates the graphics of the rendition for a change to <time>, using and
+ * trimming the time cache if it is enabled.
+ */
+static void Cmiss_rendition_graphics_time_change(struct Cmiss_rendition *rendition,
+	double time)
+{
+	struct Cmiss_graphic_time_change_data time_change_data;
+	time_change_data.time = time;
+	time_change_data.use_time_cache = (0 < rendition->time_cache_memory_limit);
+	Cmiss_rendition_begin_change(rendition);
+	FOR_EACH_OBJECT_IN_LIST(Cmiss_graphic)(
+		Cmiss_graphic_time_change, (void *)&time_change_data,
+		rendition->list_of_graphics);
+	if (time_change_data.use_time_cache)
+	{
+		Cmiss_rendition_trim_time_cache(rendition, time);
+	}
+	Cmiss_rendition_end_change(rendition);
+}
+
 static int Cmiss_rendition_time_update_callback(struct Time_object *time_object,
 	double current_time, void *rendition_void)
 {
@@ -2790,11 +3123,9 @@ static int Cmiss_rendition_time_update_callback(struct Time_object *time_object,
 	USE_PARAMETER(current_time);
 	if (time_object && (rendition=(struct Cmiss_rendition *)rendition_void))
 	{
-		Cmiss_rendition_begin_change(rendition);
-		FOR_EACH_OBJECT_IN_LIST(Cmiss_graphic)(
-			Cmiss_graphic_time_change,NULL,
-			rendition->list_of_graphics);
-		Cmiss_rendition_end_change(rendition);
+		/* graphics are built for the time object's current time */
+		Cmiss_rendition_graphics_time_change(rendition,
+			Time_object_get_current_time(time_object));
 		return_code = 1;
 	}
 	else
@@ -2835,6 +3166,124 @@ int Cmiss_rendition_has_multiple_times(
 	return (return_code);
 } /* Cmiss_rendition_has_multiple_times */
 
+int Cmiss_rendition_set_rebuild_time_limit(struct Cmiss_rendition *rendition,
+	double time_limit)
+{
+	if (rendition && (0.0 <= time_limit))
+	{
+		rendition->rebuild_time_limit = time_limit;
+		return CMISS_OK;
+	}
+	return CMISS_ERROR_ARGUMENT;
+}
+
+int Cmiss_rendition_set_rebuild_callback(struct Cmiss_rendition *rendition,
+	Cmiss_rendition_rebuild_callback function, void *user_data)
+{
+	if (rendition)
+	{
+		rendition->rebuild_callback = function;
+		rendition->rebuild_callback_user_data = (function) ? user_data : NULL;
+		return CMISS_OK;
+	}
+	return CMISS_ERROR_ARGUMENT;
+}
+
+int Cmiss_rendition_defers_rebuilds(struct Cmiss_rendition *rendition)
+{
+	return (rendition && (0.0 < rendition->rebuild_time_limit)) ? 1 : 0;
+}
+
+int Cmiss_rendition_set_time_cache_memory_limit(
+	struct Cmiss_rendition *rendition, int memory_limit_megabytes)
+{
+	if (rendition && (0 <= memory_limit_megabytes))
+	{
+		rendition->time_cache_memory_limit =
+			static_cast<size_t>(memory_limit_megabytes)*1024*1024;
+		if (0 == rendition->time_cache_memory_limit)
+		{
+			/* abandon any fill in progress */
+			rendition->fill_number_of_times = 0;
+			rendition->fill_time_index = 0;
+			FOR_EACH_OBJECT_IN_LIST(Cmiss_graphic)(
+				Cmiss_graphic_clear_time_cache, (void *)NULL,
+				rendition->list_of_graphics);
+		}
+		else
+		{
+			Cmiss_rendition_trim_time_cache(rendition, (rendition->time_object) ?
+				Time_object_get_current_time(rendition->time_object) : 0.0);
+		}
+		return CMISS_OK;
+	}
+	return CMISS_ERROR_ARGUMENT;
+}
+
+int Cmiss_rendition_fill_time_cache(struct Cmiss_rendition *rendition,
+	struct Cmiss_scene *scene, double minimum_time, double maximum_time,
+	int number_of_times)
+{
+	if (!(rendition && scene && (0 < number_of_times) &&
+		(minimum_time <= maximum_time)))
+	{
+		display_message(ERROR_MESSAGE,
+			"Cmiss_rendition_fill_time_cache.  Invalid argument(s)");
+		return CMISS_ERROR_ARGUMENT;
+	}
+	if (0 == rendition->time_cache_memory_limit)
+	{
+		display_message(ERROR_MESSAGE,
+			"Cmiss_rendition_fill_time_cache.  Time cache memory limit is not set");
+		return CMISS_ERROR_ARGUMENT;
+	}
+	/* also updates the time dependence of each graphic */
+	if (!Cmiss_rendition_has_multiple_times(rendition))
+	{
+		return CMISS_OK;
+	}
+	if (0.0 < rendition->rebuild_time_limit)
+	{
+		/* build a few times per build, after any deferred rebuilds, replacing
+			any fill in progress */
+		rendition->fill_minimum_time = minimum_time;
+		rendition->fill_maximum_time = maximum_time;
+		rendition->fill_number_of_times = number_of_times;
+		rendition->fill_time_index = 0;
+		rendition->rebuild_pending = 1;
+		Cmiss_rendition_changed(rendition);
+		return CMISS_OK;
+	}
+	const double current_time = (rendition->time_object) ?
+		Time_object_get_current_time(rendition->time_object) : 0.0;
+	char *name_prefix = Cmiss_region_get_path(rendition->region);
+	int return_code = CMISS_OK;
+	struct timeval start_time;
+	gettimeofday(&start_time, NULL);
+	int number_of_deferred_rebuilds, build_progress;
+	Cmiss_rendition_begin_change(rendition);
+	for (int i = 0; i < number_of_times; ++i)
+	{
+		const double time = (1 < number_of_times) ? minimum_time +
+			i*(maximum_time - minimum_time)/(number_of_times - 1) : minimum_time;
+		Cmiss_rendition_graphics_time_change(rendition, time);
+		/* build every graphic, without deferring any */
+		if (!Cmiss_rendition_build_graphics_objects_private(rendition, scene, time,
+			name_prefix, /*time_limit*/0.0, &start_time, &number_of_deferred_rebuilds,
+			&build_progress))
+		{
+			return_code = CMISS_ERROR_GENERAL;
+			break;
+		}
+	}
+	/* caches the graphics for the last time and restores the current ones */
+	Cmiss_rendition_graphics_time_change(rendition, current_time);
+	Cmiss_rendition_trim_time_cache(rendition, current_time);
+	Cmiss_rendition_end_change(rendition);
+	DEALLOCATE(name_prefix);
+	return return_code;
+}
+
 struct Time_object *Cmiss_rendition_get_time_object(struct Cmiss_rendition *rendition)
 {
 	struct Time_object *return_time;
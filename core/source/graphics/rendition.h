@@ -99,6 +99,20 @@ Structure for maintaining a graphical rendition of region.
 	struct FE_field *native_discretization_field;
 	struct Cmiss_graphics_module *graphics_module;
 	struct Time_object *time_object;
+	/* bytes of graphics built at other times kept for time-dependent
+		graphics; 0 if not caching */
+	size_t time_cache_memory_limit;
+	/* if positive, seconds each build may spend before full rebuilds of
+		further graphics and elements are deferred to the next build */
+	double rebuild_time_limit;
+	/* set while rebuilds of graphics are deferred */
+	int rebuild_pending;
+	/* evenly spaced times of a time cache fill spread across builds: the
+		graphics at fill_time_index onwards are still to be built */
+	double fill_minimum_time, fill_maximum_time;
+	int fill_number_of_times, fill_time_index;
+	Cmiss_rendition_rebuild_callback rebuild_callback;
+	void *rebuild_callback_user_data;
 	/* callback list for transformation changes */
 	struct LIST(CMISS_CALLBACK_ITEM(Cmiss_rendition_transformation)) *transformation_callback_list;
 	struct LIST(CMISS_CALLBACK_ITEM(Cmiss_rendition_scene_region_change)) *scene_region_change_callback_list;
@@ -491,6 +505,12 @@ int Cmiss_region_modify_rendition(struct Cmiss_region *region,
 int Cmiss_rendition_graphic_changed_private(struct Cmiss_rendition *rendition,
 	struct Cmiss_graphic *graphic);
 
+/***************************************************************************//**
+ * @return  1 if graphics of the rendition keep drawing their previous graphics
+ * objects while full rebuilds are deferred, otherwise 0.
+ */
+int Cmiss_rendition_defers_rebuilds(struct Cmiss_rendition *rendition);
+
 int Cmiss_rendition_set_default_coordinate_field(
 	struct Cmiss_rendition *rendition,
 	struct Computed_field *default_coordinate_field);
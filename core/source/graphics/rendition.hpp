@@ -44,6 +44,7 @@
 struct Cmiss_rendition;
 class Render_graphics_compile_members;
 class Render_graphics_opengl;
+class Scene_pick_context;
 
 int Cmiss_rendition_compile_rendition(Cmiss_rendition *cmiss_rendition,
 	Render_graphics_compile_members *renderer);
@@ -60,4 +61,27 @@ int Cmiss_rendition_render_opengl(struct Cmiss_rendition *cmiss_rendition,
 int Cmiss_rendition_render_child_rendition(struct Cmiss_rendition *rendition,
 	Render_graphics_opengl *renderer);
 
+/**
+ * Sets the projection to pixels in the level of detail viewer for the graphics
+ * in the rendition and the renditions of its child regions, applying
+ * rendition transformations. Graphics with adaptive tessellations regenerate
+ * elements whose level of detail changes.
+ * @see Cmiss_graphic_set_level_of_detail_projection
+ * @param world_to_pixel  Row-major projection from world coordinates to
+ * pixels with homogeneous divisor in the last row, or NULL to stop using level
+ * of detail.
+ * @return  1 on success, 0 on failure.
+ */
+int Cmiss_rendition_set_level_of_detail_projection(
+	struct Cmiss_rendition *rendition, const double *world_to_pixel);
+
+/**
+ * Adds hits on the graphics in the rendition and the renditions of its child
+ * regions to the pick context, applying rendition transformations and times
+ * as when rendering.
+ * @return  1 on success, 0 on failure.
+ */
+int Cmiss_rendition_pick_objects(struct Cmiss_rendition *rendition,
+	Scene_pick_context& pick_context);
+
 #endif /* !defined (CMISS_RENDITION_HPP) */
@@ -53,6 +53,7 @@
 #include "zinc/scene.h"
 #include "zinc/graphicsfilter.h"
 #include "zinc/rendition.h"
+#include "zinc/status.h"
 #include "computed_field/computed_field.h"
 #include "computed_field/computed_field_finite_element.h"
 #include "computed_field/computed_field_set.h"
@@ -83,7 +84,10 @@
 #include "general/message.h"
 #include "graphics/scene.hpp"
 #include "graphics/graphics_filter.hpp"
+#include "graphics/graphics_object_pick.hpp"
+#include "graphics/rendition.hpp"
 #include "graphics/render_gl.h"
+#include "graphics/render_stl.h"
 
 #if defined(USE_OPENCASCADE)
 #	include "cad/computed_field_cad_geometry.h"
@@ -98,17 +102,6 @@ Module constants
 ----------------
 */
 
-/*
-Module variables
-----------------
-*/
-
-/* select buffer size grows in increments of SELECT_BUFFER_SIZE_INCREMENT when
-	 select buffer overflows. Hence, always large enough to fit all picked objects
-	 in the scene */
-#define SELECT_BUFFER_SIZE_INCREMENT 10000
-static int select_buffer_size=10000;
-
 /*
 Module types
 ------------
@@ -3382,167 +3375,93 @@ DESCRIPTION :
 Returns a list of all the graphical entities in the <interaction_volume> of
 <scene>. The nearest member of each scene_picked_object will be adjusted as
 understood for the type of <interaction_volume> passed.
+Picking is performed on the CPU; <graphics_buffer> is no longer needed.
 ==============================================================================*/
 {
-	double modelview_matrix[16],projection_matrix[16];
-	GLdouble opengl_modelview_matrix[16],opengl_projection_matrix[16];
-	GLuint *select_buffer,*select_buffer_ptr;
-	int hit_no,i,j,num_hits,number_of_names,return_code, rendition_no;
-	struct LIST(Scene_picked_object) *scene_picked_object_list;
-	struct Scene_picked_object *scene_picked_object;
-	struct Cmiss_rendition *rendition;
-	ENTER(Scene_pick_objects);
-	scene_picked_object_list=(struct LIST(Scene_picked_object) *)NULL;
-	if (scene&&interaction_volume)
+	USE_PARAMETER(graphics_buffer);
+	return Scene_pick_objects_in_volume(scene, interaction_volume, /*nearest_only*/0);
+} /* Scene_pick_objects */
+
+struct LIST(Scene_picked_object) *Scene_pick_objects_in_volume(
+	struct Scene *scene, struct Interaction_volume *interaction_volume,
+	int nearest_only)
+{
+	struct LIST(Scene_picked_object) *scene_picked_object_list = NULL;
+
+	ENTER(Scene_pick_objects_in_volume);
+	if (scene && interaction_volume)
 	{
-		scene_picked_object_list=CREATE(LIST(Scene_picked_object))();
-		if (scene_picked_object_list != 0)
+		if (build_Scene(scene))
 		{
-			Render_graphics_opengl *renderer =
-				Render_graphics_opengl_create_glbeginend_renderer(graphics_buffer);
-			renderer->picking = 1;
-			if (renderer->Scene_compile(scene))
+			Scene_pick_context pick_context(scene, interaction_volume,
+				(0 != nearest_only));
+			int return_code = 1;
+			if (scene->region)
 			{
-				select_buffer=(GLuint *)NULL;
-				num_hits=-1;
-				while (0>num_hits)
+				struct Cmiss_rendition *rendition =
+					Cmiss_region_get_rendition_internal(scene->region);
+				if (rendition)
 				{
-					if (ALLOCATE(select_buffer,GLuint,select_buffer_size))
-					{
-						select_buffer_ptr=select_buffer;
-						Interaction_volume_get_modelview_matrix(interaction_volume,
-							modelview_matrix);
-						Interaction_volume_get_projection_matrix(interaction_volume,
-							projection_matrix);
-						/* transpose projection matrix for OpenGL */
-						for (i=0;i<4;i++)
-						{
-							for (j=0;j<4;j++)
-							{
-								opengl_modelview_matrix[j*4+i] = modelview_matrix[i*4+j];
-								opengl_projection_matrix[j*4+i] = projection_matrix[i*4+j];
-							}
-						}
-						renderer->set_world_view_matrix(opengl_modelview_matrix);
-
-						glSelectBuffer(select_buffer_size,select_buffer);
-						glRenderMode(GL_SELECT);
-						glMatrixMode(GL_PROJECTION);
-						glLoadIdentity();
-						glMultMatrixd(opengl_projection_matrix);
-						glMatrixMode(GL_MODELVIEW);
-						glLoadIdentity();
-						glMultMatrixd(opengl_modelview_matrix);
-						/* set an arbitrary viewport - not really needed
-						   SAB 22 July 2004 This is causing the view frustrums
-						   to not match when picking, so instead I am not changing the
-						   viewport, so presumably the last rendered viewport is OK. */
-						/* glViewport(0,0,1024,1024); */
-						glDepthRange((GLclampd)0,(GLclampd)1);
-						{
-							do
-							{
-								return_code = renderer->Scene_execute(scene);
-							}
-							while (return_code && renderer->next_layer());
-						}
-						glFlush();
-						num_hits=glRenderMode(GL_RENDER);
-						if (0<=num_hits)
-						{
-							return_code=1;
-							for (hit_no=0;(hit_no<num_hits)&&return_code;hit_no++)
-							{
-								scene_picked_object=CREATE(Scene_picked_object)(hit_no);
-								if (scene_picked_object != 0)
-								{
-									number_of_names=(int)(*select_buffer_ptr);
-									select_buffer_ptr++;
-									/* get range of depth of picked object */
-									/*???RC OpenGL Programming Guide p361 says depth values are
-										made into integers from 0 to 2^32-1. Just convert to
-										doubles for now */
-									Scene_picked_object_set_nearest(scene_picked_object,
-										(double)(*select_buffer_ptr));
-									select_buffer_ptr++;
-									Scene_picked_object_set_farthest(scene_picked_object,
-										(double)(*select_buffer_ptr));
-									select_buffer_ptr++;
-									/* first part of names identifies list of scene_objects in
-										 path to picked graphic. Must be at least one; only more
-										 than one if contains child_scene, which then becomes the
-										 parent of the next level of scene objects */
-									rendition_no=(int)(*select_buffer_ptr);
-									select_buffer_ptr++;
-									number_of_names--;
-									if (NULL != (rendition =
-											Scene_get_rendition_of_position(scene, rendition_no)))
-									{
-											return_code = Scene_picked_object_add_rendition(
-												scene_picked_object, rendition);
-									}
-									if (return_code)
-									{
-										for (;0<number_of_names&&return_code;number_of_names--)
-										{
-											return_code=Scene_picked_object_add_subobject(
-												scene_picked_object,(int)(*select_buffer_ptr));
-											select_buffer_ptr++;
-										}
-									}
-									if (return_code)
-									{
-										if (!ADD_OBJECT_TO_LIST(Scene_picked_object)(
-											scene_picked_object,scene_picked_object_list))
-										{
-											return_code=0;
-										}
-									}
-									if (!return_code)
-									{
-										display_message(ERROR_MESSAGE,"Scene_pick_objects.  "
-											"Failed to build Scene_picked_object");
-										DESTROY(Scene_picked_object)(&scene_picked_object);
-									}
-								}
-								else
-								{
-									display_message(ERROR_MESSAGE,"Scene_pick_objects.  "
-										"Could not create Scene_picked_object");
-									return_code=0;
-								}
-							}
-						}
-						else
-						{
-							/* select buffer overflow; enlarge and repeat */
-							select_buffer_size += SELECT_BUFFER_SIZE_INCREMENT;
-						}
-						DEALLOCATE(select_buffer);
-					}
+					return_code = Cmiss_rendition_pick_objects(rendition, pick_context);
+					Cmiss_rendition_destroy(&rendition);
 				}
 			}
+			if (return_code)
+			{
+				scene_picked_object_list = pick_context.create_picked_object_list();
+			}
 			else
 			{
 				display_message(ERROR_MESSAGE,
-					"Scene_pick_objects.  Unable to compile scene.");
+					"Scene_pick_objects_in_volume.  Failed to pick graphics.");
 			}
-			delete renderer;
 		}
 		else
 		{
 			display_message(ERROR_MESSAGE,
-				"Scene_pick_objects.  Could not create picked object list");
+				"Scene_pick_objects_in_volume.  Unable to build scene.");
 		}
 	}
 	else
 	{
-		display_message(ERROR_MESSAGE,"Scene_pick_objects.  Invalid argument(s)");
+		display_message(ERROR_MESSAGE,
+			"Scene_pick_objects_in_volume.  Invalid argument(s)");
 	}
 	LEAVE;
 
 	return (scene_picked_object_list);
-} /* Scene_pick_objects */
+} /* Scene_pick_objects_in_volume */
+
+int Scene_set_level_of_detail_projection(struct Scene *scene,
+	const double *world_to_pixel)
+{
+	int return_code = 0;
+
+	ENTER(Scene_set_level_of_detail_projection);
+	if (scene)
+	{
+		return_code = 1;
+		if (scene->region)
+		{
+			struct Cmiss_rendition *rendition =
+				Cmiss_region_get_rendition_internal(scene->region);
+			if (rendition)
+			{
+				return_code = Cmiss_rendition_set_level_of_detail_projection(
+					rendition, world_to_pixel);
+				Cmiss_rendition_destroy(&rendition);
+			}
+		}
+	}
+	else
+	{
+		display_message(ERROR_MESSAGE,
+			"Scene_set_level_of_detail_projection.  Invalid argument(s)");
+	}
+	LEAVE;
+
+	return (return_code);
+}
 
 int Scene_add_light(struct Scene *scene,struct Light *light)
 /*******************************************************************************
@@ -4460,6 +4379,41 @@ int Cmiss_scene_set_filter(Cmiss_scene_id scene, Cmiss_graphics_filter_id filter
 
 }
 
+int Cmiss_scene_write_triangle_mesh_file(struct Scene *scene,
+	const char *file_name, enum Cmiss_scene_triangle_mesh_format format,
+	double merge_tolerance)
+{
+	if (!(scene && file_name && (0.0 <= merge_tolerance)))
+	{
+		return CMISS_ERROR_ARGUMENT;
+	}
+	enum Triangle_mesh_file_format file_format;
+	switch (format)
+	{
+		case CMISS_SCENE_TRIANGLE_MESH_FORMAT_STL_ASCII:
+			file_format = TRIANGLE_MESH_FILE_FORMAT_STL_ASCII;
+			break;
+		case CMISS_SCENE_TRIANGLE_MESH_FORMAT_STL_BINARY:
+			file_format = TRIANGLE_MESH_FILE_FORMAT_STL_BINARY;
+			break;
+		case CMISS_SCENE_TRIANGLE_MESH_FORMAT_OBJ:
+			file_format = TRIANGLE_MESH_FILE_FORMAT_OBJ;
+			break;
+		case CMISS_SCENE_TRIANGLE_MESH_FORMAT_PLY_BINARY:
+			file_format = TRIANGLE_MESH_FILE_FORMAT_PLY_BINARY;
+			break;
+		default:
+			display_message(ERROR_MESSAGE,
+				"Cmiss_scene_write_triangle_mesh_file.  Invalid format");
+			return CMISS_ERROR_ARGUMENT;
+	}
+	if (!export_to_triangle_mesh(file_name, scene, file_format, merge_tolerance))
+	{
+		return CMISS_ERROR_GENERAL;
+	}
+	return CMISS_OK;
+}
+
 int Cmiss_scene_graphics_filter_change(struct Scene *scene,	void *message_void)
 {
 	int return_code = 1;
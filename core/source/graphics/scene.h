@@ -707,8 +707,39 @@ DESCRIPTION :
 Returns a list of all the graphical entities in the <interaction_volume> of
 <scene>. The nearest member of each scene_picked_object will be adjusted as
 understood for the type of <interaction_volume> passed.
+Picking is performed on the CPU; <graphics_buffer> is no longer needed.
 ==============================================================================*/
 
+/***************************************************************************//**
+ * Picks the graphics in <scene> lying in <interaction_volume> without OpenGL,
+ * by clipping the primitives of each graphics object against the volume. A
+ * bounding volume hierarchy is kept with each graphics object and rebuilt only
+ * when it changes. Points, lines and glyph bounding boxes are picked as well as
+ * surfaces. Window-relative graphics are not picked.
+ *
+ * @param scene  The scene to pick in.
+ * @param interaction_volume  The volume to pick, usually a ray frustum.
+ * @param nearest_only  If non-zero, return only the nearest hit, skipping
+ * graphics beyond it.
+ * @return  List of Scene_picked_objects with the same renditions, subobject
+ * names and depth scale as OpenGL picking, or NULL on error.
+ */
+struct LIST(Scene_picked_object) *Scene_pick_objects_in_volume(
+	struct Scene *scene, struct Interaction_volume *interaction_volume,
+	int nearest_only);
+
+/***************************************************************************//**
+ * Sets the projection from world coordinates to pixels used to choose the
+ * level of detail of graphics with adaptive tessellations in the scene.
+ *
+ * @param scene  The scene to modify.
+ * @param world_to_pixel  Row-major 4x4 projection to window pixel x, y with
+ * homogeneous divisor in the last row, or NULL to stop using level of detail.
+ * @return  1 on success, 0 on failure.
+ */
+int Scene_set_level_of_detail_projection(struct Scene *scene,
+	const double *world_to_pixel);
+
 int Scene_add_light(struct Scene *scene,struct Light *light);
 /*******************************************************************************
 LAST MODIFIED : 12 December 1997
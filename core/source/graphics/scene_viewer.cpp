@@ -58,6 +58,7 @@ November 97 Created from rendering part of Drawing.
 #include "zinc/field.h"
 #include "zinc/fieldmodule.h"
 #include "zinc/sceneviewerinput.h"
+#include "zinc/status.h"
 //#include "zinc/graphic.h"
 //#include "computed_field/computed_field.h"
 //#include "computed_field/computed_field_composite.h"
@@ -1999,7 +2000,8 @@ access this function.
 		/* only redraw if the drawing widget has area and neither it nor any of its
 			 parents are unmanaged */
 		do_render=(0<rendering_data.viewport_width) && (0<rendering_data.viewport_height)
-			&& Graphics_buffer_is_visible(scene_viewer->graphics_buffer);
+			&& Graphics_buffer_is_visible(scene_viewer->graphics_buffer)
+			&& Graphics_buffer_make_current(scene_viewer->graphics_buffer);
 		if (do_render)
 		{
 			/* Calculate the transformations before doing the callback list */
@@ -3460,6 +3462,34 @@ Cmiss_scene_viewer_id Cmiss_scene_viewer_create(
 	return (scene_viewer);
 } /* create_Cmiss_scene_viewer_wx */
 
+Cmiss_scene_viewer_id Cmiss_scene_viewer_create_offscreen(
+	Cmiss_scene_viewer_package_id cmiss_scene_viewer_package,
+	int width, int height)
+{
+	struct Graphics_buffer *graphics_buffer;
+	struct Cmiss_scene_viewer *scene_viewer = 0;
+
+	if (cmiss_scene_viewer_package && (0 < width) && (0 < height))
+	{
+		graphics_buffer = create_Graphics_buffer_osmesa(
+			Cmiss_scene_viewer_package_get_graphics_buffer_package(cmiss_scene_viewer_package),
+			(unsigned int)width, (unsigned int)height);
+		if (graphics_buffer)
+		{
+			scene_viewer = CREATE(Scene_viewer_from_package)(graphics_buffer,
+				cmiss_scene_viewer_package,
+				Cmiss_scene_viewer_package_get_default_scene(cmiss_scene_viewer_package));
+		}
+	}
+	else
+	{
+		display_message(ERROR_MESSAGE, "Cmiss_scene_viewer_create_offscreen.  "
+			"Invalid argument(s)");
+	}
+
+	return (scene_viewer);
+}
+
 int Scene_viewer_input_transform(struct Scene_viewer *scene_viewer,
 	struct Graphics_buffer_input *input)
 /*******************************************************************************
@@ -6756,6 +6786,7 @@ If <force_onscreen> is non zero then the pixels will always be grabbed from the
 scene viewer on screen.
 ==============================================================================*/
 {
+	GLboolean double_buffer;
 	int number_of_components, return_code;
 #if defined (GTK_USER_INTERFACE)
 	struct Graphics_buffer *offscreen_buffer;
@@ -6807,6 +6838,15 @@ scene viewer on screen.
 		else
 		{
 #endif /* defined (GTK_USER_INTERFACE) */
+			/* Headless buffers are resized to the requested size, as they own their
+				pixel memory */
+			if ((GRAPHICS_BUFFER_OSMESA_TYPE ==
+				Graphics_buffer_get_type(scene_viewer->graphics_buffer)) &&
+				(0 < *width) && (0 < *height))
+			{
+				Graphics_buffer_set_width(scene_viewer->graphics_buffer, *width);
+				Graphics_buffer_set_height(scene_viewer->graphics_buffer, *height);
+			}
 			/* Always use the window size if grabbing from screen */
 			*width = Graphics_buffer_get_width(scene_viewer->graphics_buffer);
 			*height = Graphics_buffer_get_height(scene_viewer->graphics_buffer);
@@ -6814,13 +6854,15 @@ scene viewer on screen.
 				/*left*/0, /*bottom*/0, /*right*/*width, /*top*/*height,
 				preferred_antialias, preferred_transparency_layers,
 				/*drawing_offscreen*/0);
+			/* single buffered contexts such as headless buffers have no back buffer */
+			glGetBooleanv(GL_DOUBLEBUFFER, &double_buffer);
 			number_of_components =
 				Texture_storage_type_get_number_of_components(storage);
 			if (ALLOCATE(*frame_data, unsigned char,
 				number_of_components * (*width) * (*height)))
 			{
 				if (!(return_code=Graphics_library_read_pixels(*frame_data, *width,
-					*height, storage, /*front_buffer*/0)))
+					*height, storage, /*front_buffer*/(double_buffer ? 0 : 1))))
 				{
 					DEALLOCATE(*frame_data);
 				}
@@ -8548,6 +8590,41 @@ scene viewer on screen.
 	return (return_code);
 }
 
+int Cmiss_scene_viewer_update_level_of_detail(
+	Cmiss_scene_viewer_id scene_viewer)
+{
+	int return_code = 0;
+	if (scene_viewer && scene_viewer->scene)
+	{
+		double projection[16];
+		if (Scene_viewer_get_transformation_to_window(scene_viewer,
+			CMISS_GRAPHICS_COORDINATE_SYSTEM_WORLD, /*local_transformation_matrix*/0,
+			projection))
+		{
+			// scale normalised device x, y in [-1,+1] to pixels
+			const double half_width =
+				0.5*Graphics_buffer_get_width(scene_viewer->graphics_buffer);
+			const double half_height =
+				0.5*Graphics_buffer_get_height(scene_viewer->graphics_buffer);
+			for (int j = 0; j < 4; j++)
+			{
+				projection[j] = half_width*(projection[j] + projection[12 + j]);
+				projection[4 + j] = half_height*(projection[4 + j] + projection[12 + j]);
+			}
+			if (Scene_set_level_of_detail_projection(scene_viewer->scene, projection))
+			{
+				return_code = CMISS_OK;
+			}
+		}
+	}
+	else
+	{
+		display_message(ERROR_MESSAGE,
+			"Cmiss_scene_viewer_update_level_of_detail.  Invalid argument(s)");
+	}
+	return (return_code);
+}
+
 int Scene_viewer_get_transformation_to_window(struct Scene_viewer *scene_viewer,
 	enum Cmiss_graphics_coordinate_system coordinate_system,
 	gtMatrix *local_transformation_matrix, double *projection)
@@ -39,6 +39,7 @@
  * the terms of any one of the MPL, the GPL or the LGPL.
  *
  * ***** END LICENSE BLOCK ***** */
+#include <cmath>
 #include <cstdlib>
 #include "general/debug.h"
 #include "general/manager_private.h"
@@ -81,6 +82,7 @@ struct Cmiss_tessellation
 	int *minimum_divisions;
 	int refinement_factors_size;
 	int *refinement_factors;
+	double screen_error_tolerance;
 	bool is_managed_flag;
 	int access_count;
 
@@ -92,6 +94,7 @@ struct Cmiss_tessellation
 		minimum_divisions(NULL),
 		refinement_factors_size(1),
 		refinement_factors(NULL),
+		screen_error_tolerance(0.0),
 		is_managed_flag(false),
 		access_count(1)
 	{
@@ -207,6 +210,18 @@ struct Cmiss_tessellation
 		return 1;
 	}
 
+	/** assumes arguments have been checked already */
+	int set_screen_error_tolerance(double in_screen_error_tolerance)
+	{
+		if (in_screen_error_tolerance != screen_error_tolerance)
+		{
+			screen_error_tolerance = in_screen_error_tolerance;
+			MANAGED_OBJECT_CHANGE(Cmiss_tessellation)(this,
+				MANAGER_CHANGE_OBJECT_NOT_IDENTIFIER(Cmiss_tessellation));
+		}
+		return 1;
+	}
+
 	void list()
 	{
 		display_message(INFORMATION_MESSAGE, "gfx define tessellation %s minimum_divisions \"", name);
@@ -227,7 +242,13 @@ struct Cmiss_tessellation
 		{
 			display_message(INFORMATION_MESSAGE, "1");
 		}
-		display_message(INFORMATION_MESSAGE, "\";\n");
+		display_message(INFORMATION_MESSAGE, "\"");
+		if (0.0 < screen_error_tolerance)
+		{
+			display_message(INFORMATION_MESSAGE, " screen_error_tolerance %g",
+				screen_error_tolerance);
+		}
+		display_message(INFORMATION_MESSAGE, ";\n");
 	}
 
 	inline Cmiss_tessellation *access()
@@ -668,6 +689,78 @@ int Cmiss_tessellation_set_refinement_factors(Cmiss_tessellation_id tessellation
 	return return_code;
 }
 
+double Cmiss_tessellation_get_screen_error_tolerance(
+	Cmiss_tessellation_id tessellation)
+{
+	if (tessellation)
+	{
+		return tessellation->screen_error_tolerance;
+	}
+	return 0.0;
+}
+
+int Cmiss_tessellation_set_screen_error_tolerance(
+	Cmiss_tessellation_id tessellation, double screen_error_tolerance)
+{
+	if (tessellation && (0.0 <= screen_error_tolerance))
+	{
+		return tessellation->set_screen_error_tolerance(screen_error_tolerance);
+	}
+	display_message(ERROR_MESSAGE,
+		"Cmiss_tessellation_set_screen_error_tolerance.  Invalid arguments");
+	return 0;
+}
+
+int Cmiss_tessellation_get_level_of_detail(Cmiss_tessellation_id tessellation,
+	int dimensions, const double *screen_errors)
+{
+	int level = 1;
+	if (tessellation && (dimensions > 0) && screen_errors)
+	{
+		int maximum_level = 1;
+		double required_level = 1.0;
+		for (int i = 0; i < dimensions; i++)
+		{
+			const int refinement_factor = tessellation->get_refinement_factors_value(i);
+			if (refinement_factor > maximum_level)
+			{
+				maximum_level = refinement_factor;
+			}
+			if (0.0 < tessellation->screen_error_tolerance)
+			{
+				// chord error falls with the square of the number of divisions
+				const double divisions = sqrt(screen_errors[i] /
+					tessellation->screen_error_tolerance);
+				const double dimension_level = divisions /
+					(double)tessellation->get_minimum_divisions_value(i);
+				if (dimension_level > required_level)
+				{
+					required_level = dimension_level;
+				}
+			}
+		}
+		if (!(0.0 < tessellation->screen_error_tolerance))
+		{
+			required_level = (double)maximum_level;
+		}
+		// powers of 2 so small view changes seldom change the level
+		while ((level < maximum_level) && ((double)level < required_level))
+		{
+			level *= 2;
+		}
+		if (level > maximum_level)
+		{
+			level = maximum_level;
+		}
+	}
+	else
+	{
+		display_message(ERROR_MESSAGE,
+			"Cmiss_tessellation_get_level_of_detail.  Invalid arguments");
+	}
+	return level;
+}
+
 /***************************************************************************//**
  * Internal function returning true if the tessellation has coarse and fine
  * divisions both equal to the fixed divisions supplied.
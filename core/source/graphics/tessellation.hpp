@@ -94,6 +94,25 @@ struct Cmiss_tessellation *Cmiss_tessellation_create_private();
 int Cmiss_tessellation_has_fixed_divisions(Cmiss_tessellation_id tessellation,
 	int dimensions, int *fixed_divisions);
 
+/***************************************************************************//**
+ * Internal function returning the level of detail for an element, being the
+ * multiple of the minimum divisions needed for the chord error of its
+ * tessellation to be within the screen error tolerance. Levels are powers of 2
+ * up to the largest refinement factor, which is returned if the tessellation
+ * has no screen error tolerance. Divisions for each dimension are then the
+ * minimum divisions times the lesser of the level and the refinement factor.
+ *
+ * @param tessellation  The tessellation to query.
+ * @param dimensions  The size of the screen_errors array.
+ * @param screen_errors  Array of estimated chord errors in pixels in each
+ * element dimension for the minimum divisions of 1, i.e. the projected
+ * deviation of the element from the straight line between its ends. Grows with
+ * both curvature and projected size.
+ * @return  Level of detail >= 1.
+ */
+int Cmiss_tessellation_get_level_of_detail(Cmiss_tessellation_id tessellation,
+	int dimensions, const double *screen_errors);
+
 /***************************************************************************//**
  * Function to process the string to be passed into an tessellation object.
  *
@@ -41,6 +41,8 @@ Class used for wrapping itk filters
  * the terms of any one of the MPL, the GPL or the LGPL.
  *
  * ***** END LICENSE BLOCK ***** */
+#include "zinc/fieldimageprocessing.h"
+#include "zinc/status.h"
 #include "computed_field/computed_field.h"
 #include "computed_field/computed_field_private.hpp"
 #include "image_processing/computed_field_image_filter.h"
@@ -55,4 +57,117 @@ int computed_field_image_filter::evaluate(Cmiss_field_cache& cache, FieldValueCa
 	return functor->update_and_evaluate_filter(cache, valueCache);
 }
 
+/***************************************************************************//**
+ * Gets the index of the pixel containing the cache location, clamped to the
+ * image.
+ * @param index  Array of at least dimension to receive pixel index.
+ * @return  1 on success, 0 if location is not in element xi or coordinates.
+ */
+int computed_field_image_filter::get_location_index(Cmiss_field_cache& cache,
+	long int *index)
+{
+	const FE_value* xi = 0;
+	Field_element_xi_location* element_xi_location;
+	Field_coordinate_location* coordinate_location;
+	if ( (element_xi_location =
+		dynamic_cast<Field_element_xi_location*>(cache.getLocation())) )
+	{
+		xi = element_xi_location->get_xi();
+	}
+	else if ( (coordinate_location =
+		dynamic_cast<Field_coordinate_location*>(cache.getLocation())) )
+	{
+		xi = coordinate_location->get_values();
+	}
+	if (!xi)
+	{
+		return 0;
+	}
+	for (int i = 0 ; i < dimension ; i++)
+	{
+		if (xi[i] < 0.0)
+		{
+			index[i] = 0;
+		}
+		else if (xi[i] >= 1.0)
+		{
+			index[i] = sizes[i] - 1;
+		}
+		else
+		{
+			index[i] = (long int)(xi[i] * (FE_value)sizes[i]);
+		}
+	}
+	return 1;
+}
+
 } // namespace CMISS
+
+using namespace CMISS;
+
+int Cmiss_field_image_filter_get_number_of_threads(Cmiss_field_id field)
+{
+	computed_field_image_filter *core = field ?
+		dynamic_cast<computed_field_image_filter *>(field->core) : 0;
+	if (core)
+		return core->number_of_threads;
+	return 0;
+}
+
+int Cmiss_field_image_filter_set_number_of_threads(Cmiss_field_id field,
+	int number_of_threads)
+{
+	computed_field_image_filter *core = field ?
+		dynamic_cast<computed_field_image_filter *>(field->core) : 0;
+	if (core && (0 < number_of_threads))
+	{
+		// only affects speed of evaluation so no change notification needed
+		core->number_of_threads = number_of_threads;
+		return CMISS_OK;
+	}
+	return 0;
+}
+
+int Cmiss_field_image_filter_get_statistics(Cmiss_field_id field,
+	size_t *number_of_pixels_address, size_t *pixels_evaluated_address,
+	double *evaluation_seconds_address, double *filter_seconds_address)
+{
+	computed_field_image_filter *core = field ?
+		dynamic_cast<computed_field_image_filter *>(field->core) : 0;
+	if (core)
+	{
+		if (number_of_pixels_address)
+			*number_of_pixels_address = core->input_statistics.number_of_pixels;
+		if (pixels_evaluated_address)
+			*pixels_evaluated_address = core->input_statistics.pixels_evaluated;
+		if (evaluation_seconds_address)
+			*evaluation_seconds_address = core->input_statistics.evaluation_seconds;
+		if (filter_seconds_address)
+			*filter_seconds_address = core->input_statistics.filter_seconds;
+		return CMISS_OK;
+	}
+	return 0;
+}
+
+double Cmiss_field_image_filter_get_memory_budget(Cmiss_field_id field)
+{
+	computed_field_image_filter *core = field ?
+		dynamic_cast<computed_field_image_filter *>(field->core) : 0;
+	if (core)
+		return core->streaming_memory_budget;
+	return 0.0;
+}
+
+int Cmiss_field_image_filter_set_memory_budget(Cmiss_field_id field,
+	double memory_budget)
+{
+	computed_field_image_filter *core = field ?
+		dynamic_cast<computed_field_image_filter *>(field->core) : 0;
+	if (core && (0.0 <= memory_budget))
+	{
+		// values are unchanged, only how much of the image is held
+		core->set_streaming_memory_budget(memory_budget);
+		return CMISS_OK;
+	}
+	return 0;
+}
@@ -49,12 +49,17 @@ equivalent to the scene_viewer assigned to it.
 #include "computed_field/computed_field.h"
 #include "computed_field/computed_field_private.hpp"
 #include "computed_field/computed_field_set.h"
+#include <list>
+#include <vector>
+#include "general/atomic.h"
 #include "general/debug.h"
 #include "general/mystring.h"
 #include "general/message.h"
+#include "general/time.h"
 #include "itkImage.h"
 #include "itkVector.h"
 #include "itkImageRegionIteratorWithIndex.h"
+#include "itkImageSource.h"
 #include "itkImportImageFilter.h"
 
 #if defined (SGI)
@@ -65,6 +70,14 @@ equivalent to the scene_viewer assigned to it.
 
 namespace CMISS {
 
+/** @return  Wall clock time in seconds for timing image filter updates. */
+inline double get_input_image_wall_time()
+{
+	struct timeval time_value;
+	gettimeofday(&time_value, NULL);
+	return (double)time_value.tv_sec + 1.0E-6*(double)time_value.tv_usec;
+}
+
 class computed_field_image_filter_Functor
 {
 public:
@@ -90,8 +103,32 @@ public:
 
 	computed_field_image_filter_Functor* functor;
 
-	computed_field_image_filter(Computed_field *source_field) : Computed_field_core()
+	/* maximum number of threads used to evaluate the input image */
+	int number_of_threads;
+
+	/* if positive, memory in bytes within which the filter is evaluated in
+		regions containing the pixels requested, otherwise the whole image is
+		filtered at once */
+	double streaming_memory_budget;
+
+	/* counters for the most recent update of the input image and filter */
+	struct Input_statistics
+	{
+		size_t number_of_pixels;
+		/* updated as rows of pixels are evaluated so progress can be polled */
+		volatile size_t pixels_evaluated;
+		double evaluation_seconds;
+		double filter_seconds;
+	} input_statistics;
+
+	computed_field_image_filter(Computed_field *source_field) : Computed_field_core(),
+		number_of_threads(1),
+		streaming_memory_budget(0.0)
 	{
+		input_statistics.number_of_pixels = 0;
+		input_statistics.pixels_evaluated = 0;
+		input_statistics.evaluation_seconds = 0.0;
+		input_statistics.filter_seconds = 0.0;
 		if (Computed_field_get_native_resolution(source_field,
 				&dimension, &sizes, &texture_coordinate_field))
 		{
@@ -149,6 +186,17 @@ public:
 
 	int evaluate(Cmiss_field_cache& cache, FieldValueCache& inValueCache);
 
+	/** Sets the memory budget for streaming evaluation, discarding any
+	 * filtered images held. @see streaming_memory_budget */
+	void set_streaming_memory_budget(double memory_budget)
+	{
+		if (memory_budget != streaming_memory_budget)
+		{
+			streaming_memory_budget = memory_budget;
+			clear_cache();
+		}
+	}
+
 protected:
 
 	int clear_cache()
@@ -180,6 +228,21 @@ protected:
 #endif /* !defined (DONOTUSE_TEMPLATETEMPLATES) */
 
 public:
+	template <class ImageType >
+	int fill_input_image(Cmiss_field_cache& cache,
+		typename ImageType::Pointer &inputImage,
+		const typename ImageType::RegionType &region,
+		FE_element *element, Computed_field *reference_field);
+
+	int get_location_index(Cmiss_field_cache& cache, long int *index);
+
+	template <class ImageType >
+	int get_streaming_region(Cmiss_field_cache& cache,
+		typename ImageType::RegionType &region, ImageType *dummytemplarg);
+
+	template <class ImageType >
+	bool image_contains_location(Cmiss_field_cache& cache, ImageType *image);
+
 	template <class ImageType >
 	int create_input_image(Cmiss_field_cache& cache,
 		typename ImageType::Pointer &inputImage,
@@ -847,38 +910,13 @@ DESCRIPTION :
 Evaluate the templated version of this filter
 ==============================================================================*/
 {
-	Field_element_xi_location* element_xi_location;
-	Field_coordinate_location* coordinate_location = NULL;
-	const FE_value* xi = NULL;
-
-	if ( (element_xi_location =
-		dynamic_cast<Field_element_xi_location*>(cache.getLocation())) )
-	{
-		xi = element_xi_location->get_xi();
-	}
-	else if ( (coordinate_location =
-		dynamic_cast<Field_coordinate_location*>(cache.getLocation())) )
-	{
-		xi = coordinate_location->get_values();
-	}
-
-	if (xi && outputImage)
+	long int location_index[3];
+	if (outputImage && get_location_index(cache, location_index))
 	{
 		typename ImageType::IndexType index;
 		for (int i = 0 ; i < dimension ; i++)
 		{
-			if (xi[i] < 0.0)
-			{
-				index[i] = 0;
-			}
-			else if (xi[i] >= 1.0)
-			{
-				index[i] = sizes[i] - 1;
-			}
-			else
-			{
-				index[i] = (long int)(xi[i] * (FE_value)sizes[i]);
-			}
+			index[i] = location_index[i];
 		}
 		if (dimension > 0)
 		{
@@ -889,6 +927,153 @@ Evaluate the templated version of this filter
 	return 0;
 }
 
+/***************************************************************************//**
+ * @return  True if the pixel at the cache location is in the buffered region
+ * of <image>.
+ */
+template <class ImageType >
+bool computed_field_image_filter::image_contains_location(Cmiss_field_cache& cache,
+	ImageType *image)
+{
+	long int location_index[3];
+	if (image && get_location_index(cache, location_index))
+	{
+		typename ImageType::IndexType index;
+		for (int i = 0 ; i < dimension ; i++)
+		{
+			index[i] = location_index[i];
+		}
+		return image->GetBufferedRegion().IsInside(index);
+	}
+	return false;
+}
+
+/***************************************************************************//**
+ * Gets the region of the image to filter in streaming mode to evaluate the
+ * pixel at the cache location: the slab of whole slices in the last image
+ * dimension containing the pixel, with as many slices as fit the memory
+ * budget allowing for input, output and cached output regions. Slabs are
+ * aligned so repeated requests in the same slab give the same region.
+ */
+template <class ImageType >
+int computed_field_image_filter::get_streaming_region(Cmiss_field_cache& cache,
+	typename ImageType::RegionType &region, ImageType * /*dummytemplarg*/)
+{
+	long int location_index[3];
+	if ((dimension < 1) || !get_location_index(cache, location_index))
+	{
+		return 0;
+	}
+	double slice_bytes = (double)sizeof(typename ImageType::PixelType);
+	for (int i = 0; i < dimension - 1; i++)
+	{
+		slice_bytes *= (double)sizes[i];
+	}
+	const int last = dimension - 1;
+	long int slab_slices = (long int)(streaming_memory_budget / (4.0*slice_bytes));
+	if (slab_slices < 1)
+	{
+		slab_slices = 1;
+	}
+	if (slab_slices > sizes[last])
+	{
+		slab_slices = sizes[last];
+	}
+	typename ImageType::IndexType start;
+	typename ImageType::SizeType size;
+	for (int i = 0; i < last; i++)
+	{
+		start[i] = 0;
+		size[i] = sizes[i];
+	}
+	start[last] = (location_index[last] / slab_slices)*slab_slices;
+	size[last] = slab_slices;
+	if (start[last] + slab_slices > sizes[last])
+	{
+		size[last] = sizes[last] - start[last];
+	}
+	region.SetIndex(start);
+	region.SetSize(size);
+	return 1;
+}
+
+/***************************************************************************//**
+ * ITK image source which evaluates the source field of an image filter field
+ * over the region requested by the downstream filter, so only that region of
+ * the input image is held in memory.
+ */
+template <class ImageType >
+class Computed_field_image_source : public itk::ImageSource< ImageType >
+{
+public:
+	typedef Computed_field_image_source Self;
+	typedef itk::ImageSource< ImageType > Superclass;
+	typedef itk::SmartPointer< Self > Pointer;
+	typedef itk::SmartPointer< const Self > ConstPointer;
+
+	itkNewMacro(Self);
+	itkTypeMacro(Computed_field_image_source, ImageSource);
+
+	void set_source(computed_field_image_filter *image_filter_in,
+		Cmiss_field_cache *cache_in, FE_element *element_in,
+		Computed_field *reference_field_in)
+	{
+		image_filter = image_filter_in;
+		cache = cache_in;
+		element = element_in;
+		reference_field = reference_field_in;
+		this->Modified();
+	}
+
+protected:
+	computed_field_image_filter *image_filter;
+	Cmiss_field_cache *cache;
+	FE_element *element;
+	Computed_field *reference_field;
+
+	Computed_field_image_source() :
+		image_filter(0),
+		cache(0),
+		element(0),
+		reference_field(0)
+	{
+	}
+
+	virtual void GenerateOutputInformation()
+	{
+		typename ImageType::Pointer output = this->GetOutput();
+		typename ImageType::IndexType start;
+		typename ImageType::SizeType size;
+		for (int i = 0; i < image_filter->dimension; i++)
+		{
+			start[i] = 0;
+			size[i] = image_filter->sizes[i];
+		}
+		typename ImageType::RegionType largest_region;
+		largest_region.SetIndex(start);
+		largest_region.SetSize(size);
+		output->SetLargestPossibleRegion(largest_region);
+	}
+
+	virtual void GenerateData()
+	{
+		typename ImageType::Pointer output = this->GetOutput();
+		output->SetBufferedRegion(output->GetRequestedRegion());
+		output->Allocate();
+		if (!image_filter->fill_input_image<ImageType>(*cache, output,
+			output->GetRequestedRegion(), element, reference_field))
+		{
+			display_message(ERROR_MESSAGE,
+				"Computed_field_image_source::GenerateData.  "
+				"Failed to evaluate source field");
+		}
+	}
+
+private:
+	Computed_field_image_source(const Self&); // not implemented
+	void operator=(const Self&); // not implemented
+};
+
 template < class ImageType >
 class computed_field_image_filter_FunctorTmpl :
 	public computed_field_image_filter_Functor
@@ -913,14 +1098,36 @@ LAST MODIFIED : 12 September 2006
 
 DESCRIPTION :
 Updates the outputImage if required and then evaluates the outputImage at the 
-location.
+location. In streaming mode the outputImage holds only a region of the image;
+recently filtered regions are kept up to the memory budget.
 ==============================================================================*/
 	{
 		int return_code;
+		if (outputImage && (0.0 < image_filter->streaming_memory_budget) &&
+			(!image_filter->image_contains_location(cache, outputImage.GetPointer())))
+		{
+			outputImage = NULL;
+			for (typename std::list<typename ImageType::Pointer>::iterator iter =
+				streamedImages.begin(); iter != streamedImages.end(); ++iter)
+			{
+				if (image_filter->image_contains_location(cache, iter->GetPointer()))
+				{
+					outputImage = *iter;
+					// keep most recently used first
+					streamedImages.erase(iter);
+					streamedImages.push_front(outputImage);
+					break;
+				}
+			}
+		}
 		if (!outputImage)
 		{
 			if ( (return_code = set_filter(cache) ) )
 			{
+				if (0.0 < image_filter->streaming_memory_budget)
+				{
+					add_streamed_image();
+				}
 				return_code = image_filter->evaluate_output_image
 					(cache, valueCache, outputImage,
 					 static_cast<ImageType*>(NULL));
@@ -938,9 +1145,39 @@ location.
 	int clear_cache()
 	{
 		outputImage = NULL;
+		streamedImages.clear();
 		return (1);
 	}
 
+protected:
+	/* most recently used first */
+	std::list<typename ImageType::Pointer> streamedImages;
+
+	/** Adds the new outputImage region to the streamed images, discarding
+	 * least recently used regions beyond half the memory budget. */
+	void add_streamed_image()
+	{
+		streamedImages.push_front(outputImage);
+		double total_bytes = 0.0;
+		typename std::list<typename ImageType::Pointer>::iterator iter = streamedImages.begin();
+		while (iter != streamedImages.end())
+		{
+			total_bytes += (double)sizeof(typename ImageType::PixelType)*
+				(double)((*iter)->GetBufferedRegion().GetNumberOfPixels());
+			if ((iter != streamedImages.begin()) &&
+				(total_bytes > 0.5*image_filter->streaming_memory_budget))
+			{
+				iter = streamedImages.erase(iter);
+			}
+			else
+			{
+				++iter;
+			}
+		}
+	}
+
+public:
+
 	typename ImageType::Pointer get_output_image()
 	{
 		return (outputImage);
@@ -978,6 +1215,153 @@ inline void computed_field_image_filter::setPixelValues( itk::Vector< ZnReal, 4
 	pixel[3] = values[3];
 }
 
+/***************************************************************************//**
+ * Evaluates the source field at the centre of every pixel of <inputImage>,
+ * either at xi in <element> or with <reference_field> set to the pixel
+ * coordinates. The image is split into slabs along its last dimension which
+ * are evaluated concurrently with separate field caches, up to the filter's
+ * number_of_threads; concurrent evaluation requires build with USE_OPENMP.
+ * The first pixel is evaluated serially so source fields complete any lazy
+ * updates, e.g. of upstream filters, before concurrent evaluation.
+ */
+template <class ImageType >
+int computed_field_image_filter::fill_input_image(Cmiss_field_cache& cache,
+	typename ImageType::Pointer &inputImage,
+	const typename ImageType::RegionType &region,
+	FE_element *element, Computed_field *reference_field)
+{
+	if (!(element || reference_field) || (dimension < 1))
+	{
+		return 0;
+	}
+	const double start_seconds = get_input_image_wall_time();
+	Cmiss_field_id sourceField = getSourceField(0);
+	input_statistics.number_of_pixels = static_cast<size_t>(region.GetNumberOfPixels());
+	input_statistics.pixels_evaluated = 0;
+	const size_t row_length = static_cast<size_t>(region.GetSize()[0]);
+	const int first_region_slice = static_cast<int>(region.GetIndex()[dimension - 1]);
+	const int number_of_slices = static_cast<int>(region.GetSize()[dimension - 1]);
+	int number_of_tiles = (number_of_threads < number_of_slices) ? number_of_threads : number_of_slices;
+	if (number_of_tiles < 1)
+	{
+		number_of_tiles = 1;
+	}
+	// work with private field caches to avoid stomping current location
+	Cmiss_field_module_id field_module = Cmiss_field_get_field_module(field);
+	std::vector<Cmiss_field_cache_id> tile_caches(number_of_tiles, static_cast<Cmiss_field_cache_id>(0));
+	std::vector<int> tile_return_codes(number_of_tiles, 1);
+	int return_code = 1;
+	for (int tile = 0; tile < number_of_tiles; tile++)
+	{
+		tile_caches[tile] = Cmiss_field_module_create_cache(field_module);
+		if (tile_caches[tile])
+		{
+			tile_caches[tile]->setTime(cache.getTime());
+		}
+		else
+		{
+			return_code = 0;
+		}
+	}
+	if (return_code)
+	{
+		// serial evaluation of first pixel to complete lazy updates of source fields
+		FE_value pixel_xi[3];
+		for (int i = 0; i < 3; i++)
+		{
+			pixel_xi[i] = (i < dimension) ?
+				((FE_value)region.GetIndex()[i] + 0.5) / (FE_value)sizes[i] : 0.0;
+		}
+		if (element)
+		{
+			tile_caches[0]->setMeshLocation(element, pixel_xi);
+		}
+		else
+		{
+			tile_caches[0]->setFieldReal(reference_field, dimension, pixel_xi);
+		}
+		if (!sourceField->evaluate(*(tile_caches[0])))
+		{
+			return_code = 0;
+		}
+	}
+	if (return_code)
+	{
+#if defined (USE_OPENMP)
+#pragma omp parallel for num_threads(number_of_tiles) schedule(static, 1)
+#endif /* defined (USE_OPENMP) */
+		for (int tile = 0; tile < number_of_tiles; tile++)
+		{
+			Cmiss_field_cache_id field_cache = tile_caches[tile];
+			typename ImageType::IndexType tile_start = region.GetIndex();
+			typename ImageType::SizeType tile_size = region.GetSize();
+			const int first_slice = static_cast<int>((static_cast<long>(number_of_slices)*tile) / number_of_tiles);
+			const int limit_slice = static_cast<int>((static_cast<long>(number_of_slices)*(tile + 1)) / number_of_tiles);
+			tile_start[dimension - 1] = first_region_slice + first_slice;
+			tile_size[dimension - 1] = limit_slice - first_slice;
+			typename ImageType::RegionType tile_region;
+			tile_region.SetIndex(tile_start);
+			tile_region.SetSize(tile_size);
+			FE_value tile_pixel_xi[3] = { 0.0, 0.0, 0.0 };
+			size_t row_pixels = 0;
+			itk::ImageRegionIteratorWithIndex< ImageType >
+				generateInput( inputImage, tile_region );
+			for ( generateInput.GoToBegin(); !generateInput.IsAtEnd();
+				++generateInput)
+			{
+				typename ImageType::IndexType idx = generateInput.GetIndex();
+
+				/* Find element xi for idx, assuming xi field for now. */
+				for (int i = 0 ; i < dimension ; i++)
+				{
+					tile_pixel_xi[i] = ((ZnReal)idx[i] + 0.5) / (ZnReal)sizes[i];
+				}
+				if (element)
+				{
+					field_cache->setMeshLocation(element, tile_pixel_xi);
+				}
+				else
+				{
+					field_cache->setFieldReal(reference_field, dimension, tile_pixel_xi);
+				}
+				RealFieldValueCache *valueCache = RealFieldValueCache::cast(sourceField->evaluate(*field_cache));
+				if (valueCache)
+				{
+					generateInput.Set( valueCache->values[0] );
+				}
+				else
+				{
+					tile_return_codes[tile] = 0;
+					break;
+				}
+				if (++row_pixels == row_length)
+				{
+					cmiss_atomic_add_size(&input_statistics.pixels_evaluated, row_pixels);
+					row_pixels = 0;
+				}
+			}
+			if (row_pixels)
+			{
+				cmiss_atomic_add_size(&input_statistics.pixels_evaluated, row_pixels);
+			}
+		}
+	}
+	for (int tile = 0; tile < number_of_tiles; tile++)
+	{
+		if (!tile_return_codes[tile])
+		{
+			return_code = 0;
+		}
+		if (tile_caches[tile])
+		{
+			Cmiss_field_cache_destroy(&(tile_caches[tile]));
+		}
+	}
+	Cmiss_field_module_destroy(&field_module);
+	input_statistics.evaluation_seconds = get_input_image_wall_time() - start_seconds;
+	return (return_code);
+}
+
 template <class ImageType >
 int computed_field_image_filter::create_input_image(Cmiss_field_cache& cache,
 	typename ImageType::Pointer &inputImage,
@@ -1021,6 +1405,9 @@ for subsequent operations.
 				sourceField->evaluate(cache);
 
 				inputImage = input_field_image_functor->get_output_image();
+				input_statistics.number_of_pixels = 0;
+				input_statistics.pixels_evaluated = 0;
+				input_statistics.evaluation_seconds = 0.0;
 			}
 			else
 			{
@@ -1045,82 +1432,10 @@ for subsequent operations.
 				inputImage->SetRegions(region);
 				inputImage->Allocate();
 			
-				FE_value pixel_xi[3];
-				
-				for (i = 0 ; i < 3 ; i++)
-				{
-					pixel_xi[i] = 0.0;
-				}
-
-				// work with a private field cache to avoid stomping current location
-				Cmiss_field_module_id field_module = Cmiss_field_get_field_module(field);
-				Cmiss_field_cache_id field_cache = Cmiss_field_module_create_cache(field_module);
-				field_cache->setTime(cache.getTime());
-				if(element_xi_location)
-				{
-					FE_element* element = element_xi_location->get_element();
-
-					itk::ImageRegionIteratorWithIndex< ImageType >
-						generateInput( inputImage, region );
-					for ( generateInput.GoToBegin(); !generateInput.IsAtEnd();
-						++generateInput)
-					{
-						typename ImageType::IndexType idx = generateInput.GetIndex();
-				
-						/* Find element xi for idx, assuming xi field for now. */
-						for (i = 0 ; i < dimension ; i++)
-						{
-							pixel_xi[i] = ((ZnReal)idx[i] + 0.5) / (ZnReal)sizes[i];
-						}
-
-						field_cache->setMeshLocation(element, pixel_xi);
-						RealFieldValueCache *valueCache = RealFieldValueCache::cast(sourceField->evaluate(*field_cache));
-						if (valueCache)
-						{
-							generateInput.Set( valueCache->values[0] );
-						}
-						else
-						{
-							return_code = 0;
-							break;
-						}
-					}
-				}
-				else if (coordinate_location)
-				{
-					Computed_field* reference_field = 
-						coordinate_location->get_reference_field();
-					FE_value time = coordinate_location->get_time();
-					itk::ImageRegionIteratorWithIndex< ImageType >
-						generateInput( inputImage, region );
-					Field_coordinate_location pixel_location(reference_field, 
-						dimension, pixel_xi, time);
-
-					for ( generateInput.GoToBegin(); !generateInput.IsAtEnd(); ++generateInput)
-					{
-						typename ImageType::IndexType idx = generateInput.GetIndex();
-				
-						/* Find element xi for idx, assuming xi field for now. */
-						for (i = 0 ; i < dimension ; i++)
-						{
-							pixel_xi[i] = ((ZnReal)idx[i] + 0.5) / (ZnReal)sizes[i];
-						}
-
-						field_cache->setFieldReal(reference_field, dimension, pixel_xi);
-						RealFieldValueCache *valueCache = RealFieldValueCache::cast(sourceField->evaluate(*field_cache));
-						if (valueCache)
-						{
-							generateInput.Set( valueCache->values[0] );
-						}
-						else
-						{
-							return_code = 0;
-							break;
-						}
-					}
-				}
-				Cmiss_field_cache_destroy(&field_cache);
-				Cmiss_field_module_destroy(&field_module);
+				FE_element *element = element_xi_location ? element_xi_location->get_element() : 0;
+				Computed_field *reference_field = coordinate_location ?
+					coordinate_location->get_reference_field() : 0;
+				return_code = fill_input_image<ImageType>(cache, inputImage, region, element, reference_field);
 #if defined (NEW_CODE)
 				typedef itk::ImportImageFilter<
 				   typename ImageType::PixelType, ImageType::ImageDimension >
@@ -1286,13 +1601,68 @@ Evaluate the templated version of this filter
 {
 	typename ImageType::Pointer inputImage;
 
+	if (0.0 < streaming_memory_budget)
+	{
+		Field_element_xi_location* element_xi_location =
+			dynamic_cast<Field_element_xi_location*>(cache.getLocation());
+		Field_coordinate_location* coordinate_location = element_xi_location ? 0 :
+			dynamic_cast<Field_coordinate_location*>(cache.getLocation());
+		typename ImageType::RegionType region;
+		if ((element_xi_location || coordinate_location) &&
+			get_streaming_region(cache, region, dummytemplarg1))
+		{
+			typename Computed_field_image_source<ImageType>::Pointer source =
+				Computed_field_image_source<ImageType>::New();
+			source->set_source(this, &cache,
+				element_xi_location ? element_xi_location->get_element() : 0,
+				coordinate_location ? coordinate_location->get_reference_field() : 0);
+			try
+			{
+				filter->SetInput( source->GetOutput() );
+
+				// input statistics are only set if the pipeline regenerates the input
+				input_statistics.number_of_pixels = 0;
+				input_statistics.pixels_evaluated = 0;
+				input_statistics.evaluation_seconds = 0.0;
+				const double start_seconds = get_input_image_wall_time();
+				// drive the pipeline for the requested region only
+				filter->UpdateOutputInformation();
+				filter->GetOutput()->SetRequestedRegion( region );
+				filter->GetOutput()->PropagateRequestedRegion();
+				filter->GetOutput()->UpdateOutputData();
+				// input evaluation is timed within the update; clamp for clock resolution
+				const double filter_seconds = get_input_image_wall_time() - start_seconds -
+					input_statistics.evaluation_seconds;
+				input_statistics.filter_seconds = (filter_seconds > 0.0) ? filter_seconds : 0.0;
+
+				outputImage = filter->GetOutput();
+				outputImage->DisconnectPipeline();
+				// input region is not needed once filtered
+				source->GetOutput()->ReleaseData();
+			} catch ( itk::ExceptionObject & err )
+			{
+				display_message(ERROR_MESSAGE,
+					"ExceptionObject caught!");
+				display_message(ERROR_MESSAGE,
+					(char *)err.GetDescription());
+				outputImage = NULL;
+			}
+			if (outputImage)
+			{
+				return 1;
+			}
+		}
+		return 0;
+	}
 	if (create_input_image(cache, inputImage, dummytemplarg1))
 	{
 		try
 		{
 			filter->SetInput( inputImage );
 
+			const double start_seconds = get_input_image_wall_time();
 			filter->Update();
+			input_statistics.filter_seconds = get_input_image_wall_time() - start_seconds;
 
 			outputImage = filter->GetOutput();
 			
@@ -52,6 +52,7 @@
 #include "computed_field/field_module.hpp"
 #include "general/enumerator_conversion.hpp"
 #include "mesh/cmiss_element_private.hpp"
+#include <algorithm>
 #include <vector>
 #include "computed_field/computed_field_subobject_group_private.hpp"
 #include "computed_field/differential_operator.hpp"
@@ -888,6 +889,29 @@ public:
 		return element;
 	}
 
+	int getAdjacentElementIdentifiers(Cmiss_element_id element, int size,
+		int *identifiers)
+	{
+		std::vector<int> adjacent_identifiers;
+		if (containsElement(element))
+		{
+			int number_of_faces = 0;
+			get_FE_element_number_of_faces(element, &number_of_faces);
+			for (int face_number = 0; face_number < number_of_faces; ++face_number)
+			{
+				int number_of_elements = 0;
+				FE_element **elements = 0;
+				if (FE_region_get_adjacent_FE_elements(fe_region, element, face_number,
+					&number_of_elements, &elements) && elements)
+				{
+					addElementIdentifiers(number_of_elements, elements, adjacent_identifiers);
+					DEALLOCATE(elements);
+				}
+			}
+		}
+		return getIdentifiers(adjacent_identifiers, size, identifiers);
+	}
+
 	int getDimension() const { return dimension; }
 
 	FE_region *getFeRegion() const { return fe_region; }
@@ -936,6 +960,20 @@ public:
 		return 0;
 	}
 
+	int getNodeElementIdentifiers(Cmiss_node_id node, int size, int *identifiers)
+	{
+		std::vector<int> node_identifiers;
+		int number_of_elements = 0;
+		FE_element **elements = 0;
+		if (FE_region_get_FE_elements_using_FE_node(fe_region, dimension, node,
+			&number_of_elements, &elements) && elements)
+		{
+			addElementIdentifiers(number_of_elements, elements, node_identifiers);
+			DEALLOCATE(elements);
+		}
+		return getIdentifiers(node_identifiers, size, identifiers);
+	}
+
 	int getSize() const
 	{
 		if (group)
@@ -943,6 +981,13 @@ public:
 		return FE_region_get_number_of_FE_elements_of_dimension(fe_region, dimension);
 	}
 
+	unsigned int getGroupChangeCounter() const
+	{
+		if (group)
+			return Computed_field_element_group_core_cast(group)->getChangeCounter();
+		return 0;
+	}
+
 	int isGroup()
 	{
 		return (0 != group);
@@ -984,6 +1029,31 @@ protected:
 		return element_list;
 	}
 
+	/** Appends identifiers of those elements in this mesh */
+	void addElementIdentifiers(int number_of_elements, FE_element **elements,
+		std::vector<int>& element_identifiers)
+	{
+		for (int i = 0; i < number_of_elements; ++i)
+		{
+			if ((!group) || containsElement(elements[i]))
+				element_identifiers.push_back(Cmiss_element_get_identifier(elements[i]));
+		}
+	}
+
+	/** Copies up to size of the sorted, distinct element_identifiers.
+	 * @return  Number of distinct identifiers */
+	static int getIdentifiers(std::vector<int>& element_identifiers, int size,
+		int *identifiers)
+	{
+		std::sort(element_identifiers.begin(), element_identifiers.end());
+		element_identifiers.erase(std::unique(element_identifiers.begin(),
+			element_identifiers.end()), element_identifiers.end());
+		const int number_of_identifiers = static_cast<int>(element_identifiers.size());
+		for (int i = 0; (i < number_of_identifiers) && (i < size); ++i)
+			identifiers[i] = element_identifiers[i];
+		return number_of_identifiers;
+	}
+
 };
 
 struct Cmiss_mesh_group : public Cmiss_mesh
@@ -1000,6 +1070,21 @@ public:
 		return Computed_field_element_group_core_cast(group)->addObject(element);
 	}
 
+	int addElementsConditional(Cmiss_field_id conditional_field)
+	{
+		return Computed_field_element_group_core_cast(group)->addElementsConditional(conditional_field);
+	}
+
+	int getNumberOfThreads()
+	{
+		return Computed_field_element_group_core_cast(group)->getNumberOfThreads();
+	}
+
+	int setNumberOfThreads(int number_of_threads)
+	{
+		return Computed_field_element_group_core_cast(group)->setNumberOfThreads(number_of_threads);
+	}
+
 	int removeAllElements()
 	{
 		return Computed_field_element_group_core_cast(group)->clear();
@@ -1181,6 +1266,14 @@ Cmiss_element_id Cmiss_mesh_find_element_by_identifier(Cmiss_mesh_id mesh,
 	return 0;
 }
 
+int Cmiss_mesh_get_adjacent_element_identifiers(Cmiss_mesh_id mesh,
+	Cmiss_element_id element, int size, int *identifiers)
+{
+	if (mesh && element && ((0 == size) || ((0 < size) && identifiers)))
+		return mesh->getAdjacentElementIdentifiers(element, size, identifiers);
+	return 0;
+}
+
 Cmiss_differential_operator_id Cmiss_mesh_get_chart_differential_operator(
 	Cmiss_mesh_id mesh, int order, int term)
 {
@@ -1210,6 +1303,14 @@ char *Cmiss_mesh_get_name(Cmiss_mesh_id mesh)
 	return 0;
 }
 
+int Cmiss_mesh_get_node_element_identifiers(Cmiss_mesh_id mesh,
+	Cmiss_node_id node, int size, int *identifiers)
+{
+	if (mesh && node && ((0 == size) || ((0 < size) && identifiers)))
+		return mesh->getNodeElementIdentifiers(node, size, identifiers);
+	return 0;
+}
+
 int Cmiss_mesh_get_size(Cmiss_mesh_id mesh)
 {
 	if (mesh)
@@ -1243,6 +1344,29 @@ int Cmiss_mesh_group_add_element(Cmiss_mesh_group_id mesh_group, Cmiss_element_i
 	return 0;
 }
 
+int Cmiss_mesh_group_add_elements_conditional(Cmiss_mesh_group_id mesh_group,
+	Cmiss_field_id conditional_field)
+{
+	if (mesh_group && conditional_field)
+		return mesh_group->addElementsConditional(conditional_field);
+	return 0;
+}
+
+int Cmiss_mesh_group_get_number_of_threads(Cmiss_mesh_group_id mesh_group)
+{
+	if (mesh_group)
+		return mesh_group->getNumberOfThreads();
+	return 0;
+}
+
+int Cmiss_mesh_group_set_number_of_threads(Cmiss_mesh_group_id mesh_group,
+	int number_of_threads)
+{
+	if (mesh_group)
+		return mesh_group->setNumberOfThreads(number_of_threads);
+	return 0;
+}
+
 int Cmiss_mesh_group_remove_all_elements(Cmiss_mesh_group_id mesh_group)
 {
 	if (mesh_group)
@@ -1301,6 +1425,13 @@ FE_region *Cmiss_mesh_get_FE_region_internal(Cmiss_mesh_id mesh)
 	return 0;
 }
 
+unsigned int Cmiss_mesh_get_group_change_counter_internal(Cmiss_mesh_id mesh)
+{
+	if (mesh)
+		return mesh->getGroupChangeCounter();
+	return 0;
+}
+
 Cmiss_region_id Cmiss_mesh_get_region_internal(Cmiss_mesh_id mesh)
 {
 	if (!mesh)
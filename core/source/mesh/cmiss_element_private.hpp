@@ -85,6 +85,12 @@ struct LIST(FE_element) *Cmiss_mesh_create_element_list_internal(Cmiss_mesh_id m
  */
 FE_region *Cmiss_mesh_get_FE_region_internal(Cmiss_mesh_id mesh);
 
+/** Internal use only.
+ * @return  Counter incremented whenever a mesh group changes, or 0 for a
+ * master mesh whose changes are notified by its FE_region.
+ */
+unsigned int Cmiss_mesh_get_group_change_counter_internal(Cmiss_mesh_id mesh);
+
 /** Internal use only.
  * @return non-accessed region for this mesh.
  */
@@ -870,6 +870,21 @@ public:
 		return Computed_field_node_group_core_cast(group)->addObject(node);
 	}
 
+	int addNodesConditional(Cmiss_field_id conditional_field)
+	{
+		return Computed_field_node_group_core_cast(group)->addNodesConditional(conditional_field);
+	}
+
+	int getNumberOfThreads()
+	{
+		return Computed_field_node_group_core_cast(group)->getNumberOfThreads();
+	}
+
+	int setNumberOfThreads(int number_of_threads)
+	{
+		return Computed_field_node_group_core_cast(group)->setNumberOfThreads(number_of_threads);
+	}
+
 	int removeAllNodes()
 	{
 		return Computed_field_node_group_core_cast(group)->clear();
@@ -1062,6 +1077,29 @@ int Cmiss_nodeset_group_add_node(Cmiss_nodeset_group_id nodeset_group, Cmiss_nod
 	return 0;
 }
 
+int Cmiss_nodeset_group_add_nodes_conditional(Cmiss_nodeset_group_id nodeset_group,
+	Cmiss_field_id conditional_field)
+{
+	if (nodeset_group && conditional_field)
+		return nodeset_group->addNodesConditional(conditional_field);
+	return 0;
+}
+
+int Cmiss_nodeset_group_get_number_of_threads(Cmiss_nodeset_group_id nodeset_group)
+{
+	if (nodeset_group)
+		return nodeset_group->getNumberOfThreads();
+	return 0;
+}
+
+int Cmiss_nodeset_group_set_number_of_threads(Cmiss_nodeset_group_id nodeset_group,
+	int number_of_threads)
+{
+	if (nodeset_group)
+		return nodeset_group->setNumberOfThreads(number_of_threads);
+	return 0;
+}
+
 int Cmiss_nodeset_group_remove_all_nodes(Cmiss_nodeset_group_id nodeset_group)
 {
 	if (nodeset_group)
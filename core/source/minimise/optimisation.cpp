@@ -81,6 +81,7 @@ using namespace std;
 #include <OptNewton.h>
 
 using NEWMAT::ColumnVector;
+using NEWMAT::Matrix;
 using namespace ::OPTPP;
 
 // global variable needed to pass minimisation object to Opt++ init functions.
@@ -97,6 +98,7 @@ int ObjectiveFieldData::prepareTerms()
 	if (numTerms > 0)
 		bufferSize *= numTerms;
 	buffer = new FE_value[bufferSize];
+	termDerivatives.resize((numTerms > 0) ? numTerms : 1);
 	return (0 != buffer);
 }
 
@@ -128,6 +130,12 @@ int Minimisation::prepareOptimisation()
 	if (optimisation.objectiveFields.size() != objectiveFields.size())
 		return_code = 0;
 	return_code = return_code && construct_dof_arrays();
+	analyticDerivatives = return_code && (!dofMap.isEmpty());
+	for (ObjectiveFieldDataVector::iterator iter = objectiveFields.begin();
+		analyticDerivatives && (iter != objectiveFields.end()); ++iter)
+	{
+		analyticDerivatives = (*iter)->field->supportsDofDerivatives();
+	}
 	if (optimisation.method == CMISS_OPTIMISATION_METHOD_LEAST_SQUARES_QUASI_NEWTON)
 	{
 		totalLeastSquaresTerms = 0;
@@ -210,6 +218,9 @@ int Minimisation::construct_dof_arrays()
 		dof_initial_values = 0;
 	}
 	total_dof = 0;
+	dof_nodes.clear();
+	changed_nodes.clear();
+	changed_non_nodal_dof = true;
 	for (FieldVector::iterator iter = independentFields.begin();
 		iter != independentFields.end(); ++iter)
 	{
@@ -272,6 +283,7 @@ int Minimisation::construct_dof_arrays()
 										dof_initial_values[total_dof] = *dof_storage_array[total_dof];
 										/*cout << dof_storage_array[total_dof - 1] << "   "
 												<< dof_initial_values[total_dof - 1] << endl;*/
+										dof_nodes.push_back(node);
 										total_dof++;
 									}
 									else
@@ -306,6 +318,7 @@ int Minimisation::construct_dof_arrays()
 					dof_initial_values[total_dof] = *dof_storage_array[total_dof];
 					/*cout << dof_storage_array[total_dof] << "   "
 							<< dof_initial_values[total_dof] << endl;*/
+					dof_nodes.push_back(0);
 					total_dof++;
 				}
 			}
@@ -325,6 +338,14 @@ int Minimisation::construct_dof_arrays()
 			return_code = 0;
 		}
 	}
+	dofMap.clear();
+	if (return_code)
+	{
+		for (int i = 0; i < total_dof; i++)
+		{
+			dofMap.addDof(dof_storage_array[i], i);
+		}
+	}
 	return return_code;
 }
 
@@ -342,6 +363,8 @@ void Minimisation::list_dof_values()
 /***************************************************************************//**
  * Must call this function after updating independent field DOFs to ensure
  * dependent field caches are fully recalculated with the DOF changes.
+ * If only nodal DOFs changed, fields may keep cached data for other nodes,
+ * e.g. when finite differencing perturbs one DOF at a time.
  */
 void Minimisation::invalidate_independent_field_caches()
 {
@@ -349,8 +372,18 @@ void Minimisation::invalidate_independent_field_caches()
 		iter != independentFields.end(); ++iter)
 	{
 		Cmiss_field_id independentField = *iter;
-		independentField->clearCaches();
+		if (changed_non_nodal_dof)
+		{
+			independentField->clearCaches();
+		}
+		else
+		{
+			independentField->clearCaches(static_cast<int>(changed_nodes.size()),
+				changed_nodes.empty() ? 0 : &(changed_nodes[0]));
+		}
 	}
+	changed_nodes.clear();
+	changed_non_nodal_dof = false;
 }
 
 /***************************************************************************//**
@@ -383,6 +416,29 @@ int Minimisation::evaluate_objective_function(FE_value *valueAddress)
 	return return_code;
 }
 
+int Minimisation::evaluate_objective_gradient(FE_value *gradient)
+{
+	int return_code = 1;
+	for (int i = 0; i < total_dof; ++i)
+	{
+		gradient[i] = 0.0;
+	}
+	FieldDofDerivatives derivatives;
+	for (ObjectiveFieldDataVector::iterator iter = objectiveFields.begin();
+		iter != objectiveFields.end(); ++iter)
+	{
+		ObjectiveFieldData *objective = *iter;
+		if (!objective->field->evaluateDofDerivatives(*field_cache, dofMap, derivatives))
+		{
+			display_message(ERROR_MESSAGE, "Failed to evaluate derivatives of objective field %s", objective->field->name);
+			return_code = 0;
+			break;
+		}
+		derivatives.accumulateSum(1.0, gradient);
+	}
+	return return_code;
+}
+
 /***************************************************************************//**
  * One time initialisation code required by the Opt++ quasi-Newton and least-
  * squares quasi-Newton minimisation algorithms.
@@ -422,7 +478,48 @@ void objective_function_QN(int ndim, const ColumnVector& x, double& fx,
 }
 
 /***************************************************************************//**
- * Naive wrapper around a quasi-Newton minimisation.
+ * The objective function and analytic gradient for the Opt++ quasi-Newton
+ * minimisation.
+ */
+void objective_function_QN_gradient(int mode, int ndim, const ColumnVector& x,
+	double& fx, ColumnVector& gx, int& result)
+{
+	int i;
+	Minimisation* minimisation = static_cast<Minimisation*> (GlobalVariableMinimisation);
+	// ColumnVector's index'd from 1...
+	for (i = 0; i < ndim; i++)
+	{
+		minimisation->set_dof_value(i, x(i + 1));
+	}
+	result = 0;
+	if (mode & NLPFunction)
+	{
+		FE_value objectiveFunctionValue = 0.0;
+		minimisation->evaluate_objective_function(&objectiveFunctionValue);
+		fx = static_cast<double>(objectiveFunctionValue);
+		result = NLPFunction;
+	}
+	if (mode & NLPGradient)
+	{
+		if (!(mode & NLPFunction))
+		{
+			minimisation->invalidate_independent_field_caches();
+		}
+		std::vector<FE_value> gradient(ndim);
+		if (minimisation->evaluate_objective_gradient(&(gradient[0])))
+		{
+			for (i = 0; i < ndim; i++)
+			{
+				gx(i + 1) = static_cast<double>(gradient[i]);
+			}
+			result |= NLPGradient;
+		}
+	}
+}
+
+/***************************************************************************//**
+ * Naive wrapper around a quasi-Newton minimisation. Uses analytic gradients if
+ * all objective fields support them, otherwise finite differences.
  */
 int Minimisation::minimise_QN()
 {
@@ -431,8 +528,12 @@ int Minimisation::minimise_QN()
 	// FIXME: need to find and use "user data" in the Opt++ methods.
 	GlobalVariableMinimisation = static_cast<void*> (this);
 
-	FDNLF1 nlp(total_dof, objective_function_QN, init_dof_initial_values);
-	OptQNewton objfcn(&nlp);
+	NLP1 *nlp = 0;
+	if (analyticDerivatives)
+		nlp = new NLF1(total_dof, objective_function_QN_gradient, init_dof_initial_values);
+	else
+		nlp = new FDNLF1(total_dof, objective_function_QN, init_dof_initial_values);
+	OptQNewton objfcn(nlp);
 	objfcn.setSearchStrategy(LineSearch);
 	objfcn.setFcnTol(optimisation.functionTolerance);
 	objfcn.setGradTol(optimisation.gradientTolerance);
@@ -454,14 +555,46 @@ int Minimisation::minimise_QN()
 	objfcn.printStatus(message);
 	objfcn.cleanup();
 
-	ColumnVector solution = nlp.getXc();
+	ColumnVector solution = nlp->getXc();
 	int i;
 	for (i = 0; i < total_dof; i++)
 		this->set_dof_value(i, solution(i + 1));
 	//list_dof_values();
+	delete nlp;
 	return 1;
 }
 
+/***************************************************************************//**
+ * Evaluates the least squares terms for the current DOF values.
+ * @return  1 on success, 0 on failure.
+ */
+static int evaluate_LSQ_terms(Minimisation* minimisation, ColumnVector& fx)
+{
+	int i;
+	int return_code = 1;
+	int termIndex = 0;
+	for (ObjectiveFieldDataVector::iterator iter = minimisation->objectiveFields.begin();
+		iter != minimisation->objectiveFields.end(); ++iter)
+	{
+		ObjectiveFieldData *objective = *iter;
+		const int bufferSize = objective->bufferSize;
+		FE_value *buffer = objective->buffer;
+		if (objective->numTerms > 0)
+			return_code = objective->field->evaluate_sum_square_terms(*(minimisation->field_cache), bufferSize, buffer);
+		else
+			return_code = Cmiss_field_evaluate_real(objective->field, minimisation->field_cache, objective->bufferSize, objective->buffer);
+		if (!return_code)
+		{
+			// GRC: should record failure properly
+			display_message(ERROR_MESSAGE, "Failed to evaluate least squares terms for objective field %s", objective->field->name);
+			break;
+		}
+		for (i = 0; i < bufferSize; ++i)
+			fx.element(termIndex++) = buffer[i];
+	}
+	return return_code;
+}
+
 /***************************************************************************//**
  * The objective function for the Opt++ least-squares quasi-Newton minimisation.
  */
@@ -480,29 +613,77 @@ void objective_function_LSQ(int ndim, const ColumnVector& x, ColumnVector& fx,
 	}
 	//minimisation->list_dof_values();
 	minimisation->invalidate_independent_field_caches();
+	evaluate_LSQ_terms(minimisation, fx);
+	result = NLPFunction;
+}
+
+/***************************************************************************//**
+ * Evaluates the sparse Jacobian of the least squares terms with respect to
+ * the DOFs into the dense matrix required by Opt++.
+ * @return  1 on success, 0 on failure.
+ */
+static int evaluate_LSQ_jacobian(Minimisation* minimisation, Matrix& gx)
+{
 	int return_code = 1;
-	Field_time_location location;
+	gx = 0.0;
 	int termIndex = 0;
 	for (ObjectiveFieldDataVector::iterator iter = minimisation->objectiveFields.begin();
 		iter != minimisation->objectiveFields.end(); ++iter)
 	{
 		ObjectiveFieldData *objective = *iter;
-		const int bufferSize = objective->bufferSize;
-		FE_value *buffer = objective->buffer;
+		const int numTerms = (objective->numTerms > 0) ? objective->numTerms : 1;
+		FieldDofDerivatives *termDerivatives = &(objective->termDerivatives[0]);
 		if (objective->numTerms > 0)
-			return_code = objective->field->evaluate_sum_square_terms(*(minimisation->field_cache), bufferSize, buffer);
+			return_code = objective->field->evaluateSumSquareTermsDofDerivatives(*(minimisation->field_cache),
+				minimisation->dofMap, objective->numTerms, termDerivatives);
 		else
-			return_code = Cmiss_field_evaluate_real(objective->field, minimisation->field_cache, objective->bufferSize, objective->buffer);
+			return_code = objective->field->evaluateDofDerivatives(*(minimisation->field_cache),
+				minimisation->dofMap, *termDerivatives);
 		if (!return_code)
 		{
-			// GRC: should record failure properly
-			display_message(ERROR_MESSAGE, "Failed to evaluate least squares terms for objective field %s", objective->field->name);
+			display_message(ERROR_MESSAGE, "Failed to evaluate least squares term derivatives for objective field %s", objective->field->name);
 			break;
 		}
-		for (i = 0; i < bufferSize; ++i)
-			fx.element(termIndex++) = buffer[i];
+		for (int t = 0; t < numTerms; ++t)
+		{
+			const int entryCount = termDerivatives[t].getEntryCount();
+			for (int e = 0; e < entryCount; ++e)
+			{
+				const int dofIndex = termDerivatives[t].getDofIndex(e);
+				const FE_value *derivatives = termDerivatives[t].getDerivatives(e);
+				for (int c = 0; c < objective->numComponents; ++c)
+					gx.element(termIndex + c, dofIndex) += derivatives[c];
+			}
+			termIndex += objective->numComponents;
+		}
+	}
+	return return_code;
+}
+
+/***************************************************************************//**
+ * The objective function and analytic Jacobian for the Opt++ least-squares
+ * minimisation.
+ */
+void objective_function_LSQ_jacobian(int mode, int ndim, const ColumnVector& x,
+	ColumnVector& fx, Matrix& gx, int& result, void* iterationCounterVoid)
+{
+	USE_PARAMETER(iterationCounterVoid);
+	Minimisation* minimisation = static_cast<Minimisation*> (GlobalVariableMinimisation);
+	// ColumnVector's index'd from 1...
+	for (int i = 0; i < ndim; i++)
+	{
+		minimisation->set_dof_value(i, x(i + 1));
+	}
+	minimisation->invalidate_independent_field_caches();
+	result = 0;
+	if ((mode & NLPFunction) && evaluate_LSQ_terms(minimisation, fx))
+	{
+		result = NLPFunction;
+	}
+	if ((mode & NLPGradient) && evaluate_LSQ_jacobian(minimisation, gx))
+	{
+		result |= NLPGradient;
 	}
-	result = NLPFunction;
 }
 
 /***************************************************************************//**
@@ -514,10 +695,16 @@ int Minimisation::minimise_LSQN()
 	char message[] = { "Solution from newton least squares" };
 	// need a handle on this object...
 	GlobalVariableMinimisation = static_cast<void*> (this);
-	LSQNLF nlp(total_dof, totalLeastSquaresTerms,
-		objective_function_LSQ, init_dof_initial_values, (OPTPP::INITCONFCN)NULL,
-		(void*)(&iterationCounter));
-	OptNewton objfcn(&nlp);
+	LSQNLF *nlp = 0;
+	if (analyticDerivatives)
+		nlp = new LSQNLF(total_dof, totalLeastSquaresTerms,
+			objective_function_LSQ_jacobian, init_dof_initial_values, (OPTPP::INITCONFCN)NULL,
+			(void*)(&iterationCounter));
+	else
+		nlp = new LSQNLF(total_dof, totalLeastSquaresTerms,
+			objective_function_LSQ, init_dof_initial_values, (OPTPP::INITCONFCN)NULL,
+			(void*)(&iterationCounter));
+	OptNewton objfcn(nlp);
 	objfcn.setSearchStrategy(LineSearch);
 	// send Opt++ log text to string buffer
 	if (!objfcn.setOutputFile(optppMessageStream))
@@ -538,11 +725,12 @@ int Minimisation::minimise_LSQN()
 	//nlp.setDebug();
 	objfcn.optimize();
 	objfcn.printStatus(message);
-	ColumnVector solution = nlp.getXc();
+	ColumnVector solution = nlp->getXc();
 	int i;
 	for (i = 0; i < total_dof; i++)
 		this->set_dof_value(i, solution(i + 1));
 	//list_dof_values();
+	delete nlp;
 	return 1;
 }
 
@@ -47,6 +47,7 @@
 #define OPTIMISATION_HPP_
 
 #include <vector>
+#include "computed_field/field_dof_derivatives.hpp"
 #include "minimise/cmiss_optimisation_private.hpp"
 
 class ObjectiveFieldData
@@ -57,6 +58,8 @@ public:
 	int numTerms;
 	int bufferSize;
 	FE_value *buffer;
+	// derivatives of each term with respect to DOFs, for analytic Jacobian
+	std::vector<FieldDofDerivatives> termDerivatives;
 
 	ObjectiveFieldData(Cmiss_field_id objectiveField) :
 		field(Cmiss_field_access(objectiveField)),
@@ -90,10 +93,18 @@ public:
 	FE_value current_time;
 	int total_dof;
 	ObjectiveFieldDataVector objectiveFields;
+	FieldDofMap dofMap;
+	// true if all objective fields can evaluate derivatives with respect to DOFs
+	bool analyticDerivatives;
 
 private:
 	FE_value **dof_storage_array;
 	FE_value *dof_initial_values;
+	// node owning each DOF, or 0 if not a nodal DOF
+	std::vector<FE_node *> dof_nodes;
+	// nodes with DOFs changed since caches were last invalidated
+	std::vector<FE_node *> changed_nodes;
+	bool changed_non_nodal_dof;
 	FieldVector independentFields;
 	int totalObjectiveFieldComponents;
 	int totalLeastSquaresTerms;
@@ -107,8 +118,10 @@ public:
 		field_cache(Cmiss_field_module_create_cache(field_module)),
 		current_time(0.0),
 		total_dof(0),
+		analyticDerivatives(false),
 		dof_storage_array(0),
 		dof_initial_values(0),
+		changed_non_nodal_dof(true),
 		optppMessageStream(&optimisation.solution_report)
 	{
 		for (FieldList::iterator iter = optimisation.independentFields.begin();
@@ -147,7 +160,14 @@ public:
 
 	inline void set_dof_value(int dof_index, FE_value new_value)
 	{
-		*dof_storage_array[dof_index] = new_value;
+		if (*dof_storage_array[dof_index] != new_value)
+		{
+			*dof_storage_array[dof_index] = new_value;
+			if (dof_nodes[dof_index])
+				changed_nodes.push_back(dof_nodes[dof_index]);
+			else
+				changed_non_nodal_dof = true;
+		}
 	}
 
 	void list_dof_values();
@@ -157,6 +177,12 @@ public:
 	/** @return  1 on success, 0 on failure */
 	int evaluate_objective_function(FE_value *valueAddress);
 
+	/** Evaluates gradient of objective function with respect to all DOFs from
+	 * analytic derivatives of the objective fields.
+	 * @param gradient  Array of size total_dof to receive gradient.
+	 * @return  1 on success, 0 on failure */
+	int evaluate_objective_gradient(FE_value *gradient);
+
 private:
 
 	int construct_dof_arrays();
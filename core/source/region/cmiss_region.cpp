@@ -87,6 +87,8 @@ struct Cmiss_region
 	int field_cache_size; // 1 more than highest field cache index given out
 	std::list<Cmiss_field_cache_id> *field_caches; // all caches currently in use
 		// for this region, needed to add value caches for new fields
+	volatile int field_caches_lock; // spin lock for field_caches: caches may be
+		// created and destroyed concurrently by separate evaluation threads
 
 	/* list of objects attached to region */
 	struct LIST(Any_object) *any_object_list;
@@ -340,6 +342,7 @@ struct Cmiss_region *CREATE(Cmiss_region)(struct Cmiss_region *base_region)
 		FE_region_add_callback(region->fe_region, Cmiss_region_FE_region_change, (void *)region);
 		region->field_cache_size = 0;
 		region->field_caches = new std::list<Cmiss_field_cache_id>();
+		region->field_caches_lock = 0;
 		region->access_count = 1;
 		if (!(region->any_object_list && region->change_callback_list &&
 			region->field_manager && region->field_manager_callback_id &&
@@ -437,7 +440,7 @@ Global functions
 ----------------
 */
 
-DECLARE_OBJECT_FUNCTIONS(Cmiss_region)
+DECLARE_ATOMIC_OBJECT_FUNCTIONS(Cmiss_region)
 
 int Cmiss_region_add_field_private(Cmiss_region_id region, Cmiss_field_id field)
 {
@@ -469,6 +472,7 @@ int Cmiss_region_add_field_private(Cmiss_region_id region, Cmiss_field_id field)
 		if (Computed_field_add_to_manager_private(field, region->field_manager))
 		{
 			int i = 1;
+			cmiss_spin_lock(&(region->field_caches_lock));
 			for (std::list<Cmiss_field_cache_id>::iterator iter = region->field_caches->begin();
 				iter != region->field_caches->end(); ++iter)
 			{
@@ -476,6 +480,7 @@ int Cmiss_region_add_field_private(Cmiss_region_id region, Cmiss_field_id field)
 				field_cache->setValueCache(cache_index, 0);
 				++i;
 			}
+			cmiss_spin_unlock(&(region->field_caches_lock));
 			Cmiss_field_set_cache_index_private(field, cache_index);
 			return 1;
 		}
@@ -486,6 +491,7 @@ int Cmiss_region_add_field_private(Cmiss_region_id region, Cmiss_field_id field)
 void Cmiss_region_clear_field_value_caches(Cmiss_region_id region, Cmiss_field_id field)
 {
 	int cacheIndex = Cmiss_field_get_cache_index_private(field);
+	cmiss_spin_lock(&(region->field_caches_lock));
 	for (std::list<Cmiss_field_cache_id>::iterator iter = region->field_caches->begin();
 		iter != region->field_caches->end(); ++iter)
 	{
@@ -496,6 +502,7 @@ void Cmiss_region_clear_field_value_caches(Cmiss_region_id region, Cmiss_field_i
 			valueCache->clear();
 		}
 	}
+	cmiss_spin_unlock(&(region->field_caches_lock));
 }
 
 void Cmiss_region_detach_fields_hierarchical(struct Cmiss_region *region)
@@ -618,14 +625,22 @@ int Cmiss_region_get_field_cache_size(Cmiss_region_id region)
 void Cmiss_region_add_field_cache(Cmiss_region_id region, Cmiss_field_cache_id cache)
 {
 	if (region && cache)
+	{
+		cmiss_spin_lock(&(region->field_caches_lock));
 		region->field_caches->push_back(cache);
+		cmiss_spin_unlock(&(region->field_caches_lock));
+	}
 }
 
 void Cmiss_region_remove_field_cache(Cmiss_region_id region,
 	Cmiss_field_cache_id cache)
 {
 	if (region && cache)
+	{
+		cmiss_spin_lock(&(region->field_caches_lock));
 		region->field_caches->remove(cache);
+		cmiss_spin_unlock(&(region->field_caches_lock));
+	}
 }
 
 int Cmiss_field_module_begin_change(Cmiss_field_module_id field_module)
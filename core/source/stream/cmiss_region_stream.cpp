@@ -223,6 +223,7 @@ int Cmiss_region_write(Cmiss_region_id region,
 {
 	int return_code = 0;
 	double time = 0.0, stream_time = 0.0;
+	int binary = 0, stream_binary = 0;
 	Cmiss_stream_information_region_id region_stream_information = NULL;
 	if (stream_information)
 	{
@@ -244,6 +245,12 @@ int Cmiss_region_write(Cmiss_region_id region,
 				time = Cmiss_stream_information_region_get_attribute_real(
 					region_stream_information, CMISS_STREAM_INFORMATION_REGION_ATTRIBUTE_TIME);
 			}
+			if (Cmiss_stream_information_region_has_attribute(region_stream_information,
+				CMISS_STREAM_INFORMATION_REGION_ATTRIBUTE_BINARY))
+			{
+				binary = (0.0 != Cmiss_stream_information_region_get_attribute_real(
+					region_stream_information, CMISS_STREAM_INFORMATION_REGION_ATTRIBUTE_BINARY));
+			}
 			for (iter = streams_list.begin(); iter != streams_list.end(); ++iter)
 			{
 				stream_properties = *iter;
@@ -258,6 +265,18 @@ int Cmiss_region_write(Cmiss_region_id region,
 				{
 					stream_time = time;
 				}
+				if (Cmiss_stream_information_region_has_resource_attribute(
+					region_stream_information, stream, CMISS_STREAM_INFORMATION_REGION_ATTRIBUTE_BINARY))
+				{
+					stream_binary = (0.0 != Cmiss_stream_information_region_get_resource_attribute_real(
+						region_stream_information, stream, CMISS_STREAM_INFORMATION_REGION_ATTRIBUTE_BINARY));
+				}
+				else
+				{
+					stream_binary = binary;
+				}
+				enum FE_write_format write_format =
+					stream_binary ? FE_WRITE_FORMAT_BINARY : FE_WRITE_FORMAT_TEXT;
 				Cmiss_stream_resource_file_id file_resource = Cmiss_stream_resource_cast_file(stream);
 				Cmiss_stream_resource_memory_id memory_resource = NULL;
 				void *memory_block = NULL;
@@ -271,7 +290,7 @@ int Cmiss_region_write(Cmiss_region_id region,
 							Cmiss_stream_information_region_get_root_region(region_stream_information),
 							/* write_elements */1,	/* write_nodes */1, /*write_data*/0,
 							FE_WRITE_ALL_FIELDS, /* number_of_field_names */0, /*field_names*/ NULL,
-							stream_time,	FE_WRITE_COMPLETE_GROUP, FE_WRITE_RECURSIVE))
+							stream_time,	FE_WRITE_COMPLETE_GROUP, FE_WRITE_RECURSIVE, write_format))
 						{
 							return_code = 0;
 							display_message(ERROR_MESSAGE, "Cmiss_region_write. Cannot write file %s", file_name);
@@ -286,7 +305,8 @@ int Cmiss_region_write(Cmiss_region_id region,
 						Cmiss_stream_information_region_get_root_region(region_stream_information),
 						/* write_elements */1,	/* write_nodes */1, /*write_data*/0,
 						FE_WRITE_ALL_FIELDS, /* number_of_field_names */0, /*field_names*/ NULL,
-						stream_time,	FE_WRITE_COMPLETE_GROUP, FE_WRITE_RECURSIVE, &memory_block, &buffer_size))
+						stream_time,	FE_WRITE_COMPLETE_GROUP, FE_WRITE_RECURSIVE, write_format,
+						&memory_block, &buffer_size))
 					{
 						return_code = 0;
 						display_message(ERROR_MESSAGE, "Cmiss_region_write. Cannot write to memory block");
@@ -377,6 +397,10 @@ int Cmiss_stream_information_region_has_attribute(
 			{
 				return_value = stream_information->isTimeEnabled();
 			} break;
+			case CMISS_STREAM_INFORMATION_REGION_ATTRIBUTE_BINARY:
+			{
+				return_value = stream_information->isBinaryEnabled();
+			} break;
 			default:
 			{
 				display_message(ERROR_MESSAGE,
@@ -400,6 +424,10 @@ double Cmiss_stream_information_region_get_attribute_real(
 			{
 				return_value = stream_information->getTime();
 			} break;
+			case CMISS_STREAM_INFORMATION_REGION_ATTRIBUTE_BINARY:
+			{
+				return_value = (double)stream_information->getBinary();
+			} break;
 			default:
 			{
 				display_message(ERROR_MESSAGE,
@@ -424,6 +452,10 @@ int Cmiss_stream_information_region_set_attribute_real(
 			{
 				return_code = stream_information->setTime(value);
 			} break;
+			case CMISS_STREAM_INFORMATION_REGION_ATTRIBUTE_BINARY:
+			{
+				return_code = stream_information->setBinary(0.0 != value);
+			} break;
 			default:
 			{
 				display_message(ERROR_MESSAGE,
@@ -448,6 +480,10 @@ int Cmiss_stream_information_region_has_resource_attribute(
 			{
 				return_value = stream_information->isResourceTimeEnabled(resource);
 			} break;
+			case CMISS_STREAM_INFORMATION_REGION_ATTRIBUTE_BINARY:
+			{
+				return_value = stream_information->isResourceBinaryEnabled(resource);
+			} break;
 			default:
 			{
 				display_message(ERROR_MESSAGE,
@@ -472,6 +508,10 @@ double Cmiss_stream_information_region_get_resource_attribute_real(
 			{
 				return_value = stream_information->getResourceTime(resource);
 			} break;
+			case CMISS_STREAM_INFORMATION_REGION_ATTRIBUTE_BINARY:
+			{
+				return_value = (double)stream_information->getResourceBinary(resource);
+			} break;
 			default:
 			{
 				display_message(ERROR_MESSAGE,
@@ -497,6 +537,10 @@ int Cmiss_stream_information_region_set_resource_attribute_real(
 			{
 				return_code = stream_information->setResourceTime(resource, value);
 			} break;
+			case CMISS_STREAM_INFORMATION_REGION_ATTRIBUTE_BINARY:
+			{
+				return_code = stream_information->setResourceBinary(resource, 0.0 != value);
+			} break;
 			default:
 			{
 				display_message(ERROR_MESSAGE,
@@ -530,8 +574,8 @@ enum Cmiss_stream_information_region_attribute
 		(Cmiss_stream_information_region_attribute)0;
 	if (string)
 	{
-		const char *str[] = {"TIME"};
-		for (unsigned int i = 0; i < 1; i ++)
+		const char *str[] = {"TIME", "BINARY"};
+		for (unsigned int i = 0; i < 2; i ++)
 		{
 			if (!strcmp(str[i], string))
 			{
@@ -547,9 +591,9 @@ char *Cmiss_stream_information_region_attribute_enum_to_string(
 	enum Cmiss_stream_information_region_attribute attribute)
 {
 	char *string = NULL;
-	if (0 < attribute && attribute <= 1)
+	if (0 < attribute && attribute <= 2)
 	{
-		const char *str[] = {"TIME"};
+		const char *str[] = {"TIME", "BINARY"};
 		string = duplicate_string(str[attribute - 1]);
 	}
 	return string;
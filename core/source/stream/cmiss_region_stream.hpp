@@ -57,6 +57,8 @@ public:
 		write_nodes = 0;
 		time_enabled = 0;
 		time = 0.0;
+		binary_enabled = 0;
+		binary = 0;
 	}
 
 	~Cmiss_region_resource_properties()
@@ -80,8 +82,25 @@ public:
 		return 1;
 	}
 
+	int getBinary()
+	{
+		return binary;
+	}
+
+	int isBinaryEnabled()
+	{
+		return binary_enabled;
+	}
+
+	int setBinary(int binary_in)
+	{
+		binary = (0 != binary_in);
+		binary_enabled = 1;
+		return 1;
+	}
+
 private:
-	int time_enabled, write_elements, write_nodes;
+	int time_enabled, write_elements, write_nodes, binary_enabled, binary;
 	double time;
 };
 
@@ -96,6 +115,8 @@ public:
 		write_nodes = 0;
 		time_enabled = 0;
 		time = 0.0;
+		binary_enabled = 0;
+		binary = 0;
 	}
 
 	virtual ~Cmiss_stream_information_region()
@@ -190,6 +211,70 @@ public:
 		return 0;
 	}
 
+	int getBinary()
+	{
+		return binary;
+	}
+
+	int isBinaryEnabled()
+	{
+		return binary_enabled;
+	}
+
+	int setBinary(int binary_in)
+	{
+		binary = (0 != binary_in);
+		binary_enabled = 1;
+		return 1;
+	}
+
+	/** @return  Binary flag for resource if set, otherwise general flag */
+	int getResourceBinary(Cmiss_stream_resource_id resource)
+	{
+		if (resource)
+		{
+			Cmiss_region_resource_properties *resource_properties =
+				(Cmiss_region_resource_properties *)findResourceInList(resource);
+			if (resource_properties)
+			{
+				if (resource_properties->isBinaryEnabled())
+					return resource_properties->getBinary();
+				else
+					return binary;
+			}
+		}
+		return 0;
+	}
+
+	int isResourceBinaryEnabled(Cmiss_stream_resource_id resource)
+	{
+		if (resource)
+		{
+			Cmiss_region_resource_properties *resource_properties =
+				(Cmiss_region_resource_properties *)findResourceInList(resource);
+			if (resource_properties)
+			{
+				return resource_properties->isBinaryEnabled();
+			}
+		}
+		return 0;
+	}
+
+	int setResourceBinary(Cmiss_stream_resource_id resource, int binary_in)
+	{
+		if (resource)
+		{
+			Cmiss_region_resource_properties *resource_properties =
+				(Cmiss_region_resource_properties *)findResourceInList(resource);
+			if (resource_properties)
+			{
+				resource_properties->setBinary(binary_in);
+				return 1;
+			}
+		}
+		return 0;
+	}
+
 	Cmiss_region_id getRegion()
 	{
 		return region;
@@ -225,7 +310,7 @@ public:
 
 private:
 	double time;
-	int write_elements, write_nodes, time_enabled;
+	int write_elements, write_nodes, time_enabled, binary_enabled, binary;
 	struct Cmiss_region *region, *root_region;
 };
 
@@ -131,6 +131,12 @@ struct Graphics_buffer *CREATE(Graphics_buffer)(
 		buffer->multi_depthbuffer = 0;
 #endif
 #endif
+#if defined (USE_OSMESA)
+		buffer->osmesa_context = 0;
+		buffer->osmesa_pixels = 0;
+		buffer->osmesa_pixels_width = 0;
+		buffer->osmesa_pixels_height = 0;
+#endif /* defined (USE_OSMESA) */
 		buffer->origin_x = 0;
 		buffer->origin_y = 0;
 		buffer->package = package;
@@ -162,6 +168,9 @@ it to share graphics contexts.
 	{
 		package->override_visual_id = 0;
 		//-- package->wxSharedContext = (wxGLContext*)NULL;
+#if defined (USE_OSMESA)
+		package->osmesa_share_context = 0;
+#endif /* defined (USE_OSMESA) */
 	}
 	else
 	{
@@ -188,6 +197,12 @@ Closes the Graphics buffer package
 	if (package_ptr && (package = *package_ptr))
 	{
 		return_code=1;
+#if defined (USE_OSMESA)
+		if (package->osmesa_share_context)
+		{
+			OSMesaDestroyContext(package->osmesa_share_context);
+		}
+#endif /* defined (USE_OSMESA) */
 		DEALLOCATE(*package_ptr);
 		*package_ptr = (struct Graphics_buffer_package *)NULL;
 	}
@@ -509,6 +524,7 @@ into unmanaged or invisible widgets.
 		{
 			case GRAPHICS_BUFFER_WX_TYPE:
 			case GRAPHICS_BUFFER_ONSCREEN_TYPE:
+			case GRAPHICS_BUFFER_OSMESA_TYPE:
 			{
 				return_code = 1;
 			} break;
@@ -528,6 +544,107 @@ into unmanaged or invisible widgets.
 	return (return_code);
 } /* Graphics_buffer_is_visible */
 
+struct Graphics_buffer *create_Graphics_buffer_osmesa(
+	struct Graphics_buffer_package *package,
+	unsigned int width, unsigned int height)
+{
+	struct Graphics_buffer *buffer = 0;
+	if (package && (0 < width) && (0 < height))
+	{
+#if defined (USE_OSMESA)
+		/* Create the package context on first use; buffers are created through
+			the scene viewer API so this happens on the client's thread */
+		if (!package->osmesa_share_context)
+		{
+			package->osmesa_share_context = OSMesaCreateContextExt(OSMESA_RGBA,
+				/*depthBits*/24, /*stencilBits*/8, /*accumBits*/0, /*sharelist*/NULL);
+		}
+		if (package->osmesa_share_context)
+		{
+			buffer = CREATE(Graphics_buffer)(package, GRAPHICS_BUFFER_OSMESA_TYPE,
+				GRAPHICS_BUFFER_SINGLE_BUFFERING, GRAPHICS_BUFFER_MONO);
+			if (buffer)
+			{
+				buffer->width = width;
+				buffer->height = height;
+				buffer->osmesa_context = OSMesaCreateContextExt(OSMESA_RGBA,
+					/*depthBits*/24, /*stencilBits*/8, /*accumBits*/0,
+					package->osmesa_share_context);
+				if (!buffer->osmesa_context)
+				{
+					display_message(ERROR_MESSAGE, "create_Graphics_buffer_osmesa.  "
+						"Unable to create OSMesa context");
+					DESTROY(Graphics_buffer)(&buffer);
+				}
+			}
+		}
+		else
+		{
+			display_message(ERROR_MESSAGE, "create_Graphics_buffer_osmesa.  "
+				"Unable to create shared OSMesa context");
+		}
+#else /* defined (USE_OSMESA) */
+		display_message(ERROR_MESSAGE, "create_Graphics_buffer_osmesa.  "
+			"Headless rendering requires zinc to be built with USE_OSMESA");
+#endif /* defined (USE_OSMESA) */
+	}
+	else
+	{
+		display_message(ERROR_MESSAGE,
+			"create_Graphics_buffer_osmesa.  Invalid argument(s)");
+	}
+
+	return (buffer);
+}
+
+int Graphics_buffer_make_current(struct Graphics_buffer *buffer)
+{
+	int return_code = 0;
+
+	if (buffer)
+	{
+		return_code = 1;
+#if defined (USE_OSMESA)
+		if (GRAPHICS_BUFFER_OSMESA_TYPE == buffer->type)
+		{
+			if ((buffer->width != buffer->osmesa_pixels_width) ||
+				(buffer->height != buffer->osmesa_pixels_height))
+			{
+				unsigned char *pixels;
+				if (REALLOCATE(pixels, buffer->osmesa_pixels, unsigned char,
+					4*buffer->width*buffer->height))
+				{
+					buffer->osmesa_pixels = pixels;
+					buffer->osmesa_pixels_width = buffer->width;
+					buffer->osmesa_pixels_height = buffer->height;
+				}
+				else
+				{
+					display_message(ERROR_MESSAGE, "Graphics_buffer_make_current.  "
+						"Unable to allocate %u x %u pixels", buffer->width, buffer->height);
+					return_code = 0;
+				}
+			}
+			if (return_code && !OSMesaMakeCurrent(buffer->osmesa_context,
+				buffer->osmesa_pixels, GL_UNSIGNED_BYTE,
+				buffer->osmesa_pixels_width, buffer->osmesa_pixels_height))
+			{
+				display_message(ERROR_MESSAGE, "Graphics_buffer_make_current.  "
+					"Unable to make OSMesa context current");
+				return_code = 0;
+			}
+		}
+#endif /* defined (USE_OSMESA) */
+	}
+	else
+	{
+		display_message(ERROR_MESSAGE,
+			"Graphics_buffer_make_current.  Invalid buffer");
+	}
+
+	return (return_code);
+}
+
 enum Graphics_buffer_type Graphics_buffer_get_type(struct Graphics_buffer *buffer)
 /*******************************************************************************
 LAST MODIFIED : 27 May 2004
@@ -613,6 +730,20 @@ Closes a Graphics buffer instance
 			 }
 		 }
 #endif /* defined (OPENGL_API) && defined (GL_EXT_framebuffer_object) */
+#if defined (USE_OSMESA)
+		if (buffer->osmesa_context)
+		{
+			if (OSMesaGetCurrentContext() == buffer->osmesa_context)
+			{
+				OSMesaMakeCurrent(NULL, NULL, GL_UNSIGNED_BYTE, 0, 0);
+			}
+			OSMesaDestroyContext(buffer->osmesa_context);
+		}
+		if (buffer->osmesa_pixels)
+		{
+			DEALLOCATE(buffer->osmesa_pixels);
+		}
+#endif /* defined (USE_OSMESA) */
 		DEALLOCATE(*buffer_ptr);
 		*buffer_ptr = 0;
 	}
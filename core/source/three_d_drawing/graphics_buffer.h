@@ -55,6 +55,9 @@ This provides a Cmgui interface to the OpenGL contexts of many types.
 #if defined (USE_GLEW)
 #	include <GL/glew.h>
 #endif
+#if defined (USE_OSMESA)
+#	include <GL/osmesa.h>
+#endif
 
 #include "general/callback.h"
 #include "three_d_drawing/abstract_graphics_buffer.h"
@@ -80,7 +83,8 @@ enum Graphics_buffer_type
 	GRAPHICS_BUFFER_WX_OFFSCREEN_TYPE,
 	GRAPHICS_BUFFER_CARBON_TYPE,
 	GRAPHICS_BUFFER_ONSCREEN_TYPE,
-	GRAPHICS_BUFFER_GL_EXT_FRAMEBUFFER_TYPE
+	GRAPHICS_BUFFER_GL_EXT_FRAMEBUFFER_TYPE,
+	GRAPHICS_BUFFER_OSMESA_TYPE /* Headless software rendering into memory, with its own context */
 };
 
 enum Graphics_buffer_buffering_mode
@@ -108,6 +112,11 @@ DESCRIPTION :
 {
 	int override_visual_id;
 	//-- wxGLContext* wxSharedContext;
+#if defined (USE_OSMESA)
+	/* context which all OSMesa buffers from the package share display lists,
+		textures and vertex buffers with; never made current itself */
+	OSMesaContext osmesa_share_context;
+#endif /* defined (USE_OSMESA) */
 };
 
 
@@ -128,6 +137,11 @@ struct Graphics_buffer
 	GLuint msbuffer, multi_depthbuffer, multi_fbo;
 #endif
 #endif
+#if defined (USE_OSMESA)
+	OSMesaContext osmesa_context;
+	unsigned char *osmesa_pixels;
+	unsigned int osmesa_pixels_width, osmesa_pixels_height;
+#endif /* defined (USE_OSMESA) */
 	Graphics_buffer_package *package;
 
 };
@@ -194,6 +208,32 @@ LAST MODIFIED : 7 December 2006
 DESCRIPTION :
 ==============================================================================*/
 
+struct Graphics_buffer *create_Graphics_buffer_osmesa(
+	struct Graphics_buffer_package *graphics_buffer_package,
+	unsigned int width, unsigned int height);
+/*******************************************************************************
+LAST MODIFIED : 18 October 2026
+
+DESCRIPTION :
+Creates a headless Graphics_buffer of the given size which renders with its own
+OSMesa software context into memory, so no windowing system is needed. The
+context shares display lists with other OSMesa buffers from the same
+<graphics_buffer_package>. As OSMesa contexts are current per thread, separate
+buffers may be rendered on separate threads. Returns NULL with an error if
+zinc was built without USE_OSMESA.
+==============================================================================*/
+
+int Graphics_buffer_make_current(struct Graphics_buffer *buffer);
+/*******************************************************************************
+LAST MODIFIED : 18 October 2026
+
+DESCRIPTION :
+Makes the graphics context of <buffer> current for the calling thread, resizing
+its pixel memory to the current buffer width and height if needed. Buffers
+whose context is owned by the client application are assumed to be current
+already.
+==============================================================================*/
+
 int DESTROY(Graphics_buffer)(struct Graphics_buffer **buffer_ptr);
 
 #endif /* !defined (GRAPHICS_BUFFER_H) */